@@ -0,0 +1,92 @@
+#include <XLib.h>
+#include <XLib.CRC.h>
+#include <XLib.Fmt.h>
+#include <XLib.String.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine::Benchmarks;
+
+// Every algorithm with table and hardware implementation over buffer that fits in L2 (throughput
+// of the inner loop) and over 64 MiB one (what checksumming of large blobs sees), plus short
+// messages where per call overhead and tails dominate.
+
+namespace
+{
+	constexpr const char* GroupName = "CRC";
+
+	constexpr uint32 SmallBufferSize = 256 * 1024;
+	constexpr uint32 SmallBufferPassCount = 64;
+	constexpr uint32 LargeBufferSize = 64 * 1024 * 1024;
+	constexpr uint32 ShortMessageSize = 40;
+	constexpr uint32 ShortMessageCount = 1 << 20;
+	constexpr uint32 RepeatCount = 5;
+
+	uint8 largeBuffer[LargeBufferSize];
+
+	template <typename Body>
+	void MeasureCRC(const char* algorithmName, const char* implementationName, const char* caseName,
+		float64 byteCount, const Body& body)
+	{
+		const float64 time = MeasureBestTime(RepeatCount, body);
+
+		InplaceStringASCIIx64 name;
+		FmtPrintStr(name, algorithmName, ' ', caseName, " (", implementationName, ')');
+		Report(GroupName, name.getCStr(), time, byteCount, "B");
+	}
+
+	template <typename CRCType>
+	void MeasureAlgorithm(const char* algorithmName, const char* implementationName)
+	{
+		uint64 checksum = 0;
+
+		MeasureCRC(algorithmName, implementationName, "256 KiB", float64(SmallBufferSize) * SmallBufferPassCount, [&]
+		{
+			for (uint32 i = 0; i < SmallBufferPassCount; i++)
+				checksum += CRCType::Compute(largeBuffer, SmallBufferSize);
+		});
+		MeasureCRC(algorithmName, implementationName, "64 MiB", float64(LargeBufferSize), [&]
+		{
+			checksum += CRCType::Compute(largeBuffer, LargeBufferSize);
+		});
+		MeasureCRC(algorithmName, implementationName, "40 B messages", float64(ShortMessageSize) * ShortMessageCount, [&]
+		{
+			for (uint32 i = 0; i < ShortMessageCount; i++)
+				checksum += CRCType::Compute(largeBuffer + i * 8, ShortMessageSize);
+		});
+
+		Consume(checksum);
+	}
+}
+
+void XEngine::Benchmarks::RunCRCBenchmarks()
+{
+	for (uint32 i = 0; i < LargeBufferSize; i++)
+		largeBuffer[i] = uint8(i * 2654435761u >> 24);
+
+	struct ImplementationDesc
+	{
+		CRCImplementation implementation;
+		const char* name;
+	};
+
+	const ImplementationDesc implementations[] =
+	{
+		{ CRCImplementation::Table, "Table" },
+		{ CRCImplementation::Hardware, "Hardware" },
+	};
+
+	for (const ImplementationDesc& implementation : implementations)
+	{
+		if (implementation.implementation == CRCImplementation::Hardware && !CRC::IsHardwareImplementationSupported())
+			continue;
+
+		CRC::SetImplementation(implementation.implementation);
+		MeasureAlgorithm<CRC32>("CRC32", implementation.name);
+		MeasureAlgorithm<CRC32C>("CRC32C", implementation.name);
+		MeasureAlgorithm<CRC64>("CRC64", implementation.name);
+	}
+
+	CRC::SetImplementation(CRCImplementation::Default);
+}
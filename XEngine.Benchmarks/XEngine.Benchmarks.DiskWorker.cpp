@@ -0,0 +1,183 @@
+#include <XLib.h>
+#include <XLib.FileSystem.h>
+#include <XLib.Fmt.h>
+#include <XLib.String.h>
+#include <XLib.System.File.h>
+#include <XLib.System.Threading.h>
+#include <XLib.System.Threading.Atomics.h>
+#include <XLib.System.Timer.h>
+
+#include <XEngine.Core.DiskWorker.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine::Core;
+using namespace XEngine::Benchmarks;
+
+// Streams 4096 generated asset files of 4 KiB to 124 KiB through `DiskWorker` with fixed number of
+// requests outstanding, the way loader keeps the queue fed. Callback releases ring slice right away.
+// Latency is time from `readFile` call until the last chunk of that file is delivered.
+// Files are written just before, so they are usually served from OS file cache and the measurement
+// is worker overhead (queue, dispatch, completion port) rather than disk speed.
+
+namespace
+{
+	constexpr const char* GroupName = "DiskWorker";
+	constexpr const char* DirPath = "XEngine.Benchmarks.DiskWorker.tmp";
+
+	constexpr uint32 FileCount = 4096;
+	constexpr uint32 FileSizeGranularity = 4096;
+	constexpr uint32 MaxFileSize = FileSizeGranularity * 31;
+	constexpr uint32 OutstandingRequestCounts[] = { 1, 16, 256 };
+	constexpr uint32 DiskBufferSizeLog2 = 24;
+	constexpr uint32 RepeatCount = 3;
+
+	inline uint32 FileSizeFromIndex(const uint32 fileIndex) { return FileSizeGranularity * (1 + fileIndex * 7 % 31); }
+
+	DiskWorker diskWorker;
+	InplaceStringASCIIx64* filenames = nullptr;
+	DiskOperationContext* contexts = nullptr;
+	TimerRecord* queueRecords = nullptr;
+	float32* latencySamples = nullptr;
+
+	AtomicU32 nextFileIndex = 0;
+	AtomicU32 completedFileCount = 0;
+	volatile uint64 checksum = 0;
+
+	DiskReadContinuationParams ReadFinishedCallback(DiskOperationContext& context, DiskOperationResult result,
+		DiskWorkerBufferHandle dataBufferHandle, const void* data, uint32 dataSize, bool endOfFile);
+
+	void QueueNextFileRead()
+	{
+		const uint32 fileIndex = nextFileIndex.increment() - 1;
+		if (fileIndex >= FileCount)
+			return;
+
+		queueRecords[fileIndex] = Timer::GetRecord();
+		diskWorker.readFile(filenames[fileIndex].getCStr(), 0, MaxFileSize, 0.0f, &ReadFinishedCallback, contexts[fileIndex]);
+	}
+
+	DiskReadContinuationParams ReadFinishedCallback(DiskOperationContext& context, const DiskOperationResult result,
+		const DiskWorkerBufferHandle dataBufferHandle, const void* data, const uint32 dataSize, const bool endOfFile)
+	{
+		XAssert(result == DiskOperationResult::Success);
+
+		if (dataBufferHandle.isValid())
+		{
+			checksum += *(const byte*)data + dataSize;
+			diskWorker.releaseBuffer(dataBufferHandle);
+		}
+
+		if (endOfFile)
+		{
+			const uint32 fileIndex = uint32(&context - contexts);
+			latencySamples[fileIndex] = Timer::GetTimeDelta(queueRecords[fileIndex]);
+
+			// Next read is queued before completion is counted, so main thread does not start next
+			// repeat while this callback still touches shared state.
+			QueueNextFileRead();
+			completedFileCount.increment();
+		}
+
+		return DiskReadContinuationParams { uint64(-1), MaxFileSize };
+	}
+
+	bool CreateFiles()
+	{
+		if (FileSystem::CreateDirSingle(DirPath) != FileSystemOpStatus::Success &&
+			FileSystem::GetEntryType(DirPath).value != FileSystemEntryType::Directory)
+		{
+			return false;
+		}
+
+		byte* content = new byte[MaxFileSize];
+		for (uint32 i = 0; i < MaxFileSize; i++)
+			content[i] = byte(i * 31);
+
+		bool success = true;
+		for (uint32 i = 0; i < FileCount && success; i++)
+		{
+			FmtPrintStr(filenames[i], DirPath, "/asset_", i, ".bin");
+
+			File file;
+			success = file.open(filenames[i].getCStr(), FileAccessMode::Write, FileOpenMode::Override) &&
+				file.write(content, FileSizeFromIndex(i));
+		}
+
+		delete[] content;
+		return success;
+	}
+
+	void RemoveFiles()
+	{
+		for (uint32 i = 0; i < FileCount; i++)
+		{
+			if (!filenames[i].isEmpty())
+				FileSystem::RemoveFile(filenames[i].getCStr());
+		}
+		FileSystem::RemoveDir(DirPath);
+	}
+
+	void MeasureStreaming(const uint32 outstandingRequestCount, const uint64 totalSize)
+	{
+		float64 bestTime = 0.0;
+		for (uint32 repeat = 0; repeat < RepeatCount; repeat++)
+		{
+			nextFileIndex.store(0);
+			completedFileCount.store(0);
+
+			const TimerRecord startRecord = Timer::GetRecord();
+
+			for (uint32 i = 0; i < outstandingRequestCount; i++)
+				QueueNextFileRead();
+			while (completedFileCount.load() < FileCount)
+				Thread::YieldExecution();
+
+			const float64 time = Timer::GetTimeDelta(startRecord);
+			if (repeat == 0 || time < bestTime)
+				bestTime = time;
+		}
+
+		InplaceStringASCIIx64 name;
+		FmtPrintStr(name, FileCount, " files, ", outstandingRequestCount, " outstanding");
+		Report(GroupName, name.getCStr(), bestTime, float64(totalSize), "B");
+
+		// Samples of the last repeat.
+		name.clear();
+		FmtPrintStr(name, FileCount, " files, ", outstandingRequestCount, " outstanding latency");
+		ReportLatency(GroupName, name.getCStr(), latencySamples, FileCount);
+	}
+}
+
+void XEngine::Benchmarks::RunDiskWorkerBenchmarks()
+{
+	filenames = new InplaceStringASCIIx64[FileCount];
+	contexts = new DiskOperationContext[FileCount];
+	queueRecords = new TimerRecord[FileCount];
+	latencySamples = new float32[FileCount];
+
+	uint64 totalSize = 0;
+	for (uint32 i = 0; i < FileCount; i++)
+		totalSize += FileSizeFromIndex(i);
+
+	if (CreateFiles())
+	{
+		diskWorker.startup(DiskBufferSizeLog2);
+		for (const uint32 outstandingRequestCount : OutstandingRequestCounts)
+			MeasureStreaming(outstandingRequestCount, totalSize);
+		diskWorker.shutdown();
+	}
+	RemoveFiles();
+
+	Consume(checksum);
+
+	delete[] filenames;
+	delete[] contexts;
+	delete[] queueRecords;
+	delete[] latencySamples;
+	filenames = nullptr;
+	contexts = nullptr;
+	queueRecords = nullptr;
+	latencySamples = nullptr;
+}
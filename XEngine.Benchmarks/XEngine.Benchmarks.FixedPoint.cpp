@@ -0,0 +1,104 @@
+#include <XLib.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.Fmt.h>
+#include <XLib.String.h>
+
+#include <XEngine.Simulation.FixedPoint.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine::Benchmarks;
+using namespace XEngine::Simulation;
+
+// Batch kernels at every width supported by CPU over columns that fit in L2, so width difference
+// is not hidden behind memory bandwidth. Float loop is a reference point for `Integrate`.
+
+namespace
+{
+	constexpr const char* GroupName = "Simulation.FixedPoint";
+
+	constexpr uint32 ElementCount = 64 * 1024;
+	constexpr uint32 PassCount = 64;
+	constexpr uint32 RepeatCount = 5;
+
+	struct WidthDesc
+	{
+		FixedBatchWidth width;
+		const char* name;
+	};
+
+	const WidthDesc Widths[] =
+	{
+		{ FixedBatchWidth::Scalar, "Scalar" },
+		{ FixedBatchWidth::SSE4, "SSE4" },
+		{ FixedBatchWidth::AVX2, "AVX2" },
+	};
+
+	template <typename Body>
+	void MeasureKernel(const char* kernelName, const char* widthName, const Body& body)
+	{
+		const float64 time = MeasureBestTime(RepeatCount, [&]
+		{
+			for (uint32 i = 0; i < PassCount; i++)
+				body();
+		});
+
+		InplaceStringASCIIx64 name;
+		FmtPrintStr(name, kernelName, " (", widthName, ')');
+		Report(GroupName, name.getCStr(), time, float64(ElementCount) * PassCount, "elements");
+	}
+}
+
+void XEngine::Benchmarks::RunFixedPointBenchmarks()
+{
+	ArrayList<Fixed> x, y, z, vx, result;
+	x.resize(ElementCount);
+	y.resize(ElementCount);
+	z.resize(ElementCount);
+	vx.resize(ElementCount);
+	result.resize(ElementCount);
+
+	for (uint32 i = 0; i < ElementCount; i++)
+	{
+		// Small values, so repeated integration and normalization stay in range.
+		x[i] = Fixed::FromRaw(sint32(i % 1000) * 64 + 1);
+		y[i] = Fixed::FromRaw(sint32(i % 777) * -64 - 1);
+		z[i] = Fixed::FromRaw(sint32(i % 333) * 128);
+		vx[i] = Fixed::FromRaw(sint32(i % 97) - 48);
+	}
+
+	const Fixed dt = Fixed::FromFloat(1.0 / 60.0);
+
+	for (const WidthDesc& width : Widths)
+	{
+		if (uint8(width.width) > uint8(FixedBatch::GetMaxSupportedWidth()))
+			continue;
+
+		FixedBatch::SetWidth(width.width);
+
+		MeasureKernel("Mul", width.name, [&] { FixedBatch::Mul(x, y, result, ElementCount); });
+		MeasureKernel("Dot3", width.name, [&] { FixedBatch::Dot3(x, y, z, z, y, x, result, ElementCount); });
+		MeasureKernel("Integrate", width.name, [&] { FixedBatch::Integrate(result, vx, dt, ElementCount); });
+		MeasureKernel("Normalize3", width.name, [&] { FixedBatch::Normalize3(x, y, z, ElementCount); });
+	}
+
+	FixedBatch::SetWidth(FixedBatchWidth::Default);
+	Consume(uint64(result[ElementCount / 2].raw) + uint64(x[ElementCount / 3].raw));
+
+	ArrayList<float32> positions, velocities;
+	positions.resize(ElementCount);
+	velocities.resize(ElementCount);
+	for (uint32 i = 0; i < ElementCount; i++)
+	{
+		positions[i] = 0.0f;
+		velocities[i] = float32(i % 97) - 48.0f;
+	}
+
+	MeasureKernel("Integrate", "float32 reference", [&]
+	{
+		for (uint32 i = 0; i < ElementCount; i++)
+			positions[i] += velocities[i] * (1.0f / 60.0f);
+	});
+	Consume(uint64(positions[ElementCount / 2]));
+}
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <XLib.h>
+#include <XLib.CharStream.h>
+#include <XLib.FileSystem.h>
+#include <XLib.Fmt.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine::Benchmarks;
+
+// Shortest round trip formatting and correctly rounded parsing against CRT `snprintf` / `strtod`.
+// CRT formats with `%.9g` / `%.17g`, which also round trips but is not shortest. Values are random
+// bit patterns (all magnitudes, many digits) and "typical" values with few significant digits,
+// as the latter take fast paths on both sides.
+// Printing of builder-like progress lines (integers, string and fixed point float) into memory with
+// `FmtPrintF`, `FmtPrint` and `snprintf`, and into file through stream flushed after every line (what
+// `FmtPrintStdOut` does on console) and through stream flushed only when buffer is full (redirected
+// stdout).
+
+namespace
+{
+	constexpr const char* GroupName = "Fmt";
+
+	constexpr uint32 ValueCount = 1 << 18;
+	constexpr uint32 RepeatCount = 5;
+
+	// Each value gets fixed size slot, so parse benchmarks do not measure text scanning.
+	constexpr uint32 TextSlotSize = 32;
+
+	constexpr uint32 PrintLineCount = 1 << 16;
+	constexpr uint32 PrintLineMaxLength = 96;
+	constexpr const char* PrintFilePath = "XEngine.Benchmarks.Fmt.tmp";
+
+	float32 values32[ValueCount];
+	float64 values64[ValueCount];
+	char texts[ValueCount][TextSlotSize];
+	uint8 textLengths[ValueCount];
+	char printBuffer[PrintLineCount * PrintLineMaxLength];
+
+	uint64 NextRandom(uint64& state)
+	{
+		state += 0x9E3779B97F4A7C15ull;
+		uint64 z = state;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	void GenerateValues(bool typical)
+	{
+		uint64 randomState = typical ? 0x7193 : 0xB175;
+		for (uint32 i = 0; i < ValueCount; i++)
+		{
+			const uint64 r = NextRandom(randomState);
+			if (typical)
+			{
+				// Up to 4 fraction digits, like coordinates and config values.
+				values64[i] = float64(sint64(r % 2000000) - 1000000) / 10000.0;
+				values32[i] = float32(values64[i]);
+				continue;
+			}
+
+			// Finite non-NaN values only.
+			const uint64 bits64 = r & ~(uint64(1) << 62);
+			const uint32 bits32 = uint32(r >> 32) & ~(uint32(1) << 30);
+			memoryCopy(&values64[i], &bits64, sizeof(float64));
+			memoryCopy(&values32[i], &bits32, sizeof(float32));
+		}
+	}
+
+	template <typename Body>
+	void Measure(const char* name, const Body& body)
+	{
+		const float64 time = MeasureBestTime(RepeatCount, body);
+		Report(GroupName, name, time, float64(ValueCount), "values");
+	}
+
+	void RunSet(bool typical)
+	{
+		GenerateValues(typical);
+
+		uint64 checksum = 0;
+
+		Measure(typical ? "FmtFormatDecFP32 (typical)" : "FmtFormatDecFP32 (random)", [&]
+		{
+			for (uint32 i = 0; i < ValueCount; i++)
+				textLengths[i] = FmtFormatDecFP32(values32[i], texts[i], TextSlotSize - 1, 0).formattedCharCount;
+		});
+		Measure(typical ? "snprintf %.9g (typical)" : "snprintf %.9g (random)", [&]
+		{
+			for (uint32 i = 0; i < ValueCount; i++)
+				checksum += snprintf(texts[i], TextSlotSize, "%.9g", values32[i]);
+		});
+
+		// Parse texts of the same values produced by each side's own formatting.
+		for (uint32 i = 0; i < ValueCount; i++)
+			texts[i][FmtFormatDecFP32(values32[i], texts[i], TextSlotSize - 1, 0).formattedCharCount] = 0;
+		Measure(typical ? "FmtParseDecFP32 (typical)" : "FmtParseDecFP32 (random)", [&]
+		{
+			for (uint32 i = 0; i < ValueCount; i++)
+			{
+				float32 value = 0.0f;
+				FmtParseDecFP32(texts[i], TextSlotSize, value);
+				checksum += uint64(value != values32[i]);
+			}
+		});
+		Measure(typical ? "strtof (typical)" : "strtof (random)", [&]
+		{
+			for (uint32 i = 0; i < ValueCount; i++)
+				checksum += uint64(strtof(texts[i], nullptr) != values32[i]);
+		});
+
+		Measure(typical ? "FmtFormatDecFP64 (typical)" : "FmtFormatDecFP64 (random)", [&]
+		{
+			for (uint32 i = 0; i < ValueCount; i++)
+				textLengths[i] = FmtFormatDecFP64(values64[i], texts[i], TextSlotSize - 1, 0).formattedCharCount;
+		});
+		Measure(typical ? "snprintf %.17g (typical)" : "snprintf %.17g (random)", [&]
+		{
+			for (uint32 i = 0; i < ValueCount; i++)
+				checksum += snprintf(texts[i], TextSlotSize, "%.17g", values64[i]);
+		});
+
+		for (uint32 i = 0; i < ValueCount; i++)
+			texts[i][FmtFormatDecFP64(values64[i], texts[i], TextSlotSize - 1, 0).formattedCharCount] = 0;
+		Measure(typical ? "FmtParseDecFP64 (typical)" : "FmtParseDecFP64 (random)", [&]
+		{
+			for (uint32 i = 0; i < ValueCount; i++)
+			{
+				float64 value = 0.0;
+				FmtParseDecFP64(texts[i], TextSlotSize, value);
+				checksum += uint64(value != values64[i]);
+			}
+		});
+		Measure(typical ? "strtod (typical)" : "strtod (random)", [&]
+		{
+			for (uint32 i = 0; i < ValueCount; i++)
+				checksum += uint64(strtod(texts[i], nullptr) != values64[i]);
+		});
+
+		Consume(checksum + textLengths[ValueCount / 2]);
+	}
+
+	template <typename Body>
+	void MeasurePrint(const char* name, const Body& body)
+	{
+		const float64 time = MeasureBestTime(RepeatCount, body);
+		Report(GroupName, name, time, float64(PrintLineCount), "lines");
+	}
+
+	void RunPrint()
+	{
+		const StringViewASCII name = StringViewASCII::FromCStr("Materials/Environment/Terrain.PS");
+
+		MemoryCharStreamWriter memoryWriter;
+		MeasurePrint("Print FmtPrintF (memory)", [&]
+		{
+			memoryWriter.open(printBuffer, sizeof(printBuffer));
+			for (uint32 i = 0; i < PrintLineCount; i++)
+				FmtPrintF<" [{}/{}] Compiled shader '{}' in {:.1f} ms\n">(memoryWriter, i + 1, PrintLineCount, name, float32(i) * 0.037f);
+		});
+		MeasurePrint("Print FmtPrint (memory)", [&]
+		{
+			memoryWriter.open(printBuffer, sizeof(printBuffer));
+			for (uint32 i = 0; i < PrintLineCount; i++)
+				FmtPrint(memoryWriter, " [", i + 1, '/', PrintLineCount, "] Compiled shader '", name, "' in ", float32(i) * 0.037f, " ms\n");
+		});
+		uintptr snprintfOffset = 0;
+		MeasurePrint("Print snprintf (memory)", [&]
+		{
+			snprintfOffset = 0;
+			for (uint32 i = 0; i < PrintLineCount; i++)
+			{
+				snprintfOffset += snprintf(printBuffer + snprintfOffset, PrintLineMaxLength, " [%u/%u] Compiled shader '%.*s' in %.1f ms\n",
+					i + 1, PrintLineCount, int(name.getLength()), name.getData(), float32(i) * 0.037f);
+			}
+		});
+		Consume(snprintfOffset);
+
+		for (uint32 pass = 0; pass < 2; pass++)
+		{
+			const bool flushEveryLine = pass == 0;
+			FileCharStreamWriter fileWriter;
+			if (!fileWriter.open(PrintFilePath, true, 0x10000))
+				return;
+
+			MeasurePrint(flushEveryLine ? "Print to file, flush every line" : "Print to file, 64 KiB buffer", [&]
+			{
+				for (uint32 i = 0; i < PrintLineCount; i++)
+				{
+					FmtPrintF<" [{}/{}] Compiled shader '{}' in {:.1f} ms\n">(fileWriter, i + 1, PrintLineCount, name, float32(i) * 0.037f);
+					if (flushEveryLine)
+						fileWriter.flush();
+				}
+				fileWriter.flush();
+			});
+		}
+		FileSystem::RemoveFile(PrintFilePath);
+	}
+}
+
+void XEngine::Benchmarks::RunFmtBenchmarks()
+{
+	RunSet(false);
+	RunSet(true);
+	RunPrint();
+}
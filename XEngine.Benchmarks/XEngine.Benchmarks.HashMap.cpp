@@ -0,0 +1,143 @@
+#include <unordered_map>
+
+#include <XLib.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.Containers.HashMap.h>
+#include <XLib.Fmt.h>
+#include <XLib.String.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine::Benchmarks;
+
+// FlatHashMap against std::unordered_map (what BuildDepsTrace::Writer uses) with uint64 keys from
+// 1K to 10M entries. Hit and miss look up keys in random order, so large maps are bound by cache
+// misses. Churn removes the oldest key and inserts a new one, keeping the size constant, which is
+// where tombstone-free erase shows up. Insert is a single build of the map without reserve.
+
+namespace
+{
+	constexpr const char* GroupName = "HashMap";
+
+	constexpr uint32 MapSizes[] = { 1000, 10000, 100000, 1000000, 10000000 };
+	constexpr uint32 LookupCount = 1 << 22;
+	constexpr uint32 MaxChurnCount = 1 << 20;
+	constexpr uint32 RepeatCount = 3;
+
+	// Inserted keys are `KeyFromIndex(0..size)`, absent ones are taken from the other half of index space.
+	inline uint64 KeyFromIndex(const uint64 index) { return HashMapHashing::MixU64(index); }
+	constexpr uint64 AbsentKeyIndexBase = uint64(1) << 63;
+
+	// Presents both maps through the same interface, so benchmarks are written once.
+	class FlatMapAdapter : public NonCopyable
+	{
+	private:
+		FlatHashMap<uint64, uint64> map;
+
+	public:
+		static constexpr const char* Name = "FlatHashMap";
+
+		inline void insert(uint64 key, uint64 value) { map.insert(key, value); }
+		inline void remove(uint64 key) { map.remove(key); }
+		inline uint64 find(uint64 key) const { const uint64* value = map.find(key); return value ? *value : 0; }
+	};
+
+	class StdMapAdapter : public NonCopyable
+	{
+	private:
+		std::unordered_map<uint64, uint64> map;
+
+	public:
+		static constexpr const char* Name = "std::unordered_map";
+
+		inline void insert(uint64 key, uint64 value) { map.insert({ key, value }); }
+		inline void remove(uint64 key) { map.erase(key); }
+		inline uint64 find(uint64 key) const { auto it = map.find(key); return it != map.end() ? it->second : 0; }
+	};
+
+	void FillLookupKeys(ArrayList<uint64>& keys, const uint32 mapSize, const uint64 keyIndexBase)
+	{
+		keys.resize(LookupCount);
+
+		// LCG picks indices in random order, so lookups do not walk memory the way keys were inserted.
+		uint64 state = 0x2545F4914F6CDD1Dull;
+		for (uint32 i = 0; i < LookupCount; i++)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			keys[i] = KeyFromIndex(keyIndexBase + (state >> 33) % mapSize);
+		}
+	}
+
+	template <typename MapAdapter>
+	void MeasureMap(const uint32 mapSize, const ArrayList<uint64>& hitKeys, const ArrayList<uint64>& missKeys)
+	{
+		InplaceStringASCIIx64 name;
+		uint64 checksum = 0;
+
+		MapAdapter* map = new MapAdapter;
+
+		FmtPrintStr(name, MapAdapter::Name, " insert ", mapSize);
+		const float64 insertTime = MeasureBestTime(1, [&]
+		{
+			for (uint32 i = 0; i < mapSize; i++)
+				map->insert(KeyFromIndex(i), i);
+		});
+		Report(GroupName, name.getCStr(), insertTime, float64(mapSize), "op");
+
+		name.clear();
+		FmtPrintStr(name, MapAdapter::Name, " hit ", mapSize);
+		const float64 hitTime = MeasureBestTime(RepeatCount, [&]
+		{
+			for (uint32 i = 0; i < LookupCount; i++)
+				checksum += map->find(hitKeys[i]);
+		});
+		Report(GroupName, name.getCStr(), hitTime, float64(LookupCount), "op");
+
+		name.clear();
+		FmtPrintStr(name, MapAdapter::Name, " miss ", mapSize);
+		const float64 missTime = MeasureBestTime(RepeatCount, [&]
+		{
+			for (uint32 i = 0; i < LookupCount; i++)
+				checksum += map->find(missKeys[i]);
+		});
+		Report(GroupName, name.getCStr(), missTime, float64(LookupCount), "op");
+
+		// Live keys form sliding window `[oldestKeyIndex, oldestKeyIndex + mapSize)`, so every repeat
+		// continues where the previous one stopped.
+		const uint32 churnCount = min(mapSize, MaxChurnCount);
+		uint64 oldestKeyIndex = 0;
+
+		name.clear();
+		FmtPrintStr(name, MapAdapter::Name, " churn ", mapSize);
+		const float64 churnTime = MeasureBestTime(RepeatCount, [&]
+		{
+			for (uint32 i = 0; i < churnCount; i++)
+			{
+				map->remove(KeyFromIndex(oldestKeyIndex));
+				map->insert(KeyFromIndex(oldestKeyIndex + mapSize), oldestKeyIndex);
+				oldestKeyIndex++;
+			}
+		});
+		Report(GroupName, name.getCStr(), churnTime, float64(churnCount), "op");
+
+		delete map;
+
+		Consume(checksum);
+	}
+}
+
+void XEngine::Benchmarks::RunHashMapBenchmarks()
+{
+	ArrayList<uint64> hitKeys;
+	ArrayList<uint64> missKeys;
+
+	for (uint32 mapSize : MapSizes)
+	{
+		FillLookupKeys(hitKeys, mapSize, 0);
+		FillLookupKeys(missKeys, mapSize, AbsentKeyIndexBase);
+
+		MeasureMap<FlatMapAdapter>(mapSize, hitKeys, missKeys);
+		MeasureMap<StdMapAdapter>(mapSize, hitKeys, missKeys);
+	}
+}
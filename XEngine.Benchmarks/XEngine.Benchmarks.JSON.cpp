@@ -0,0 +1,217 @@
+#include <XLib.h>
+#include <XLib.CharStream.h>
+#include <XLib.Containers.HashMap.h>
+#include <XLib.Fmt.h>
+#include <XLib.JSON.h>
+#include <XLib.String.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine::Benchmarks;
+
+// Reader throughput over generated document that looks like asset manifests: indented objects,
+// short and long plain strings, some escaped strings, integers, fractional numbers, literals and
+// nested arrays. Byte loop that only counts structural chars is a reference point for char-by-char
+// scanning. `JSONDocument` is measured on the same text, then member lookups are measured on
+// records (below member index threshold) and on wide object (above it).
+
+namespace
+{
+	constexpr const char* GroupName = "JSON";
+
+	constexpr uint32 RecordCount = 50000;
+	constexpr uint32 WideObjectMemberCount = 256;
+	constexpr uint32 RepeatCount = 5;
+
+	void GenerateDocument(DynamicStringASCII& text)
+	{
+		VirtualStringWriter writer(text);
+		writer.write("[\n");
+
+		for (uint32 i = 0; i < RecordCount; i++)
+		{
+			FmtPrint(writer,
+				"\t{\n"
+				"\t\t\"name\": \"entity_", i, "\",\n"
+				"\t\t\"path\": \"Content/Models/Environment/Props/prop_", i, ".geometry\",\n"
+				"\t\t\"tags\": [ \"static\", \"shadow_caster\", \"lod", i % 4, "\" ],\n"
+				"\t\t\"id\": ", i * 7919, ",\n"
+				"\t\t\"position\": [ ", float64(i) * 0.125, ", ", -float64(i % 1000) * 1.75, ", ", 1.0 / float64(i + 1), " ],\n"
+				"\t\t\"enabled\": ", (i % 3) ? "true" : "false", ",\n"
+				"\t\t\"parent\": null,\n");
+
+			// Escaped strings take char-by-char path.
+			if (i % 8 == 0)
+				writer.write("\t\t\"comment\": \"\\\"quoted\\\" \\\\ text\\n\",\n");
+
+			FmtPrint(writer,
+				"\t\t\"material\": { \"shader\": \"Lit\", \"textures\": [ \"albedo_", i, "\", \"normal_", i, "\" ] }\n"
+				"\t}", (i + 1 < RecordCount) ? ",\n" : "\n");
+		}
+
+		writer.write("]\n");
+	}
+
+	void GenerateWideObject(DynamicStringASCII& text)
+	{
+		VirtualStringWriter writer(text);
+		writer.put('{');
+		for (uint32 i = 0; i < WideObjectMemberCount; i++)
+			FmtPrint(writer, "\"property_", i, "\": ", i, (i + 1 < WideObjectMemberCount) ? ", " : "");
+		writer.put('}');
+	}
+
+	uint64 HashKey(StringViewASCII key)
+	{
+		return HashMapHashing::ComputeBytes(key.getData(), key.getLength());
+	}
+
+	bool WalkValue(JSONReader& reader, const JSONValue& value, uint64& checksum)
+	{
+		if (value.type == JSONValueType::Object || value.type == JSONValueType::Array)
+		{
+			const bool isObject = value.type == JSONValueType::Object;
+			if (!(isObject ? reader.openObject() : reader.openArray()))
+				return false;
+
+			while (!(isObject ? reader.isEndOfObject() : reader.isEndOfArray()))
+			{
+				if (isObject)
+				{
+					JSONString key = {};
+					if (!reader.readKey(key))
+						return false;
+					checksum += key.string.getLength();
+				}
+
+				JSONValue child = {};
+				if (!reader.readValue(child) || !WalkValue(reader, child, checksum))
+					return false;
+			}
+
+			return isObject ? reader.closeObject() : reader.closeArray();
+		}
+
+		if (value.type == JSONValueType::String)
+			checksum += value.string.unescapedLength;
+		else if (value.type == JSONValueType::Number)
+			checksum += uint64(value.number.floatingPoint);
+		else
+			checksum += uint64(value.type);
+		return true;
+	}
+}
+
+void XEngine::Benchmarks::RunJSONBenchmarks()
+{
+	DynamicStringASCII text;
+	GenerateDocument(text);
+
+	const float64 textSize = float64(text.getLength());
+
+	uint64 checksum = 0;
+	const float64 readTime = MeasureBestTime(RepeatCount, [&]
+	{
+		JSONReader reader;
+		JSONValue root = {};
+		const bool success = reader.openDocument(text.getData(), text.getLength()) &&
+			reader.readValue(root) && WalkValue(reader, root, checksum) && reader.isEndOfDocument();
+		XAssert(success);
+	});
+	Consume(checksum);
+
+	// Error reporting resolves line/column lazily. Worst case is query at the very end.
+	uint32 lineNumber = 0;
+	uint32 columnNumber = 0;
+	const float64 lineColumnTime = MeasureBestTime(RepeatCount, [&]
+	{
+		JSONReader reader;
+		reader.openDocument(text.getData(), text.getLength());
+		reader.getLineColumnNumbers(text.getLength() - 1, lineNumber, columnNumber);
+	});
+	Consume(lineNumber + columnNumber);
+
+	uint64 structuralCharCount = 0;
+	const float64 byteLoopTime = MeasureBestTime(RepeatCount, [&]
+	{
+		const char* chars = text.getData();
+		const uint32 length = text.getLength();
+		for (uint32 i = 0; i < length; i++)
+		{
+			const char c = chars[i];
+			structuralCharCount += c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',' || c == '\"';
+		}
+	});
+	Consume(structuralCharCount);
+
+	JSONDocument document;
+	const float64 documentParseTime = MeasureBestTime(RepeatCount, [&]
+	{
+		const bool success = document.parse(text.getData(), text.getLength(), &HashKey);
+		XAssert(success);
+	});
+
+	// Every record is looked up by four keys, one of them missing.
+	const StringViewASCII recordKeys[] =
+	{
+		StringViewASCII::FromCStr("name"), StringViewASCII::FromCStr("material"),
+		StringViewASCII::FromCStr("position"), StringViewASCII::FromCStr("missing"),
+	};
+	uint64 recordKeyHashes[countOf(recordKeys)] = {};
+	for (uint32 i = 0; i < countOf(recordKeys); i++)
+		recordKeyHashes[i] = HashKey(recordKeys[i]);
+
+	uint64 foundCount = 0;
+	const float64 recordLookupByKeyTime = MeasureBestTime(RepeatCount, [&]
+	{
+		for (JSONDocument::Element record = document.getRoot().getFirstChild(); record.isValid(); record = record.getNextSibling())
+		{
+			for (StringViewASCII key : recordKeys)
+				foundCount += record.findMember(key).isValid();
+		}
+	});
+	const float64 recordLookupByHashTime = MeasureBestTime(RepeatCount, [&]
+	{
+		for (JSONDocument::Element record = document.getRoot().getFirstChild(); record.isValid(); record = record.getNextSibling())
+		{
+			for (uint64 keyHash : recordKeyHashes)
+				foundCount += record.findMember(keyHash).isValid();
+		}
+	});
+	Consume(foundCount);
+
+	DynamicStringASCII wideObjectText;
+	GenerateWideObject(wideObjectText);
+
+	JSONDocument wideObjectDocument;
+	const bool wideObjectParsed = wideObjectDocument.parse(wideObjectText.getData(), wideObjectText.getLength());
+	XAssert(wideObjectParsed);
+
+	InplaceStringASCIIx64 wideObjectKeys[WideObjectMemberCount];
+	for (uint32 i = 0; i < WideObjectMemberCount; i++)
+		FmtPrintStr(wideObjectKeys[i], "property_", i);
+
+	constexpr uint32 WideObjectPassCount = 1000;
+	float64 wideObjectSum = 0.0;
+	const float64 wideObjectLookupTime = MeasureBestTime(RepeatCount, [&]
+	{
+		const JSONDocument::Element root = wideObjectDocument.getRoot();
+		for (uint32 pass = 0; pass < WideObjectPassCount; pass++)
+		{
+			for (const InplaceStringASCIIx64& key : wideObjectKeys)
+				wideObjectSum += root.findMember(key.getView()).getNumber();
+		}
+	});
+	Consume(uint64(wideObjectSum));
+
+	const float64 recordLookupCount = float64(RecordCount) * countOf(recordKeys);
+
+	Report(GroupName, "JSONReader walk", readTime, textSize, "B");
+	Report(GroupName, "Line/column of last char", lineColumnTime, textSize, "B");
+	Report(GroupName, "Reference byte loop", byteLoopTime, textSize, "B");
+	Report(GroupName, "JSONDocument parse", documentParseTime, textSize, "B");
+	Report(GroupName, "findMember by key (record)", recordLookupByKeyTime, recordLookupCount, "lookups");
+	Report(GroupName, "findMember by hash (record)", recordLookupByHashTime, recordLookupCount, "lookups");
+	Report(GroupName, "findMember by key (256 members)", wideObjectLookupTime, float64(WideObjectMemberCount) * WideObjectPassCount, "lookups");
+}
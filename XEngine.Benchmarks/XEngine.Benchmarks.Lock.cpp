@@ -0,0 +1,205 @@
+#include <XLib.h>
+#include <XLib.Fmt.h>
+#include <XLib.NonCopyable.h>
+#include <XLib.String.h>
+#include <XLib.System.Threading.Atomics.h>
+#include <XLib.System.Threading.Lock.h>
+#include <XLib.System.Threading.ReadersWriterLock.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine::Benchmarks;
+
+// `Lock`, `TicketLock` and `ReadersWriterLock` against the spin locks they replaced, all threads
+// hammering one lock with no work outside of it. Reader-heavy mix does 1 write per 16 operations,
+// writer-heavy mix does 15 writes per 16. Exclusive locks take the same lock for reads and writes,
+// so reader-heavy mix shows what readers-writer lock gains over them. Operation count is fixed
+// and split between threads, so time is total throughput under contention.
+
+namespace
+{
+	constexpr const char* GroupName = "Lock";
+
+	constexpr uint32 ThreadCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+	constexpr uint32 OperationCount = 1 << 20;
+	constexpr uint32 RepeatCount = 3;
+
+	struct OperationMix
+	{
+		const char* name;
+		uint32 writesPer16;
+	};
+
+	constexpr OperationMix OperationMixes[] =
+	{
+		{ "reader-heavy", 1 },
+		{ "writer-heavy", 15 },
+	};
+
+	// Previous `Lock` and `ReadersWriterLock`, kept as reference point. Both spin without ever
+	// yielding or parking. Only `compareExchange` argument order is fixed, so they do not spin forever.
+	class LegacyLock : public NonCopyable
+	{
+	private:
+		Atomic<uint32> value;
+
+	public:
+		inline LegacyLock() : value(0) {}
+
+		inline void lock() { while (!value.compareExchange(0, 1)) {} }
+		inline void unlock() { value.store(0); }
+	};
+
+	class LegacyReadersWriterLock : public NonCopyable
+	{
+	private:
+		static constexpr uint32 writerLockMask = 1 << 31;
+
+		Atomic<uint32> lock;
+
+	public:
+		inline LegacyReadersWriterLock() : lock(0) {}
+
+		inline void readerLock()
+		{
+			if (lock.increment() >= writerLockMask)
+				while (lock.load() & writerLockMask) {}
+		}
+		inline void writerLock()
+		{
+			while (!lock.compareExchange(0, writerLockMask)) {}
+		}
+		inline void readerUnlock()
+		{
+			lock.decrement();
+		}
+		inline void writerUnlock()
+		{
+			lock.sub(writerLockMask);
+		}
+	};
+
+	// Data under lock spans one cache line. Readers sum it, writers increment every value, so torn
+	// access would show up as sum that is not a multiple of value count.
+	struct alignas(64) ProtectedData
+	{
+		static constexpr uint32 ValueCount = 8;
+		volatile uint64 values[ValueCount];
+	};
+
+	// Presents every lock through the same interface, so benchmark is written once.
+	template <typename LockType>
+	class ExclusiveLockAdapter : public NonCopyable
+	{
+	private:
+		LockType lock;
+
+	public:
+		template <typename Body>
+		inline void read(const Body& body) { ScopedLock<LockType> scopedLock(lock); body(); }
+		template <typename Body>
+		inline void write(const Body& body) { ScopedLock<LockType> scopedLock(lock); body(); }
+	};
+
+	class ReadersWriterLockAdapter : public NonCopyable
+	{
+	private:
+		ReadersWriterLock lock;
+
+	public:
+		template <typename Body>
+		inline void read(const Body& body) { ScopedReaderLock scopedLock(lock); body(); }
+		template <typename Body>
+		inline void write(const Body& body) { ScopedWriterLock scopedLock(lock); body(); }
+	};
+
+	class LegacyReadersWriterLockAdapter : public NonCopyable
+	{
+	private:
+		LegacyReadersWriterLock lock;
+
+	public:
+		template <typename Body>
+		inline void read(const Body& body) { lock.readerLock(); body(); lock.readerUnlock(); }
+		template <typename Body>
+		inline void write(const Body& body) { lock.writerLock(); body(); lock.writerUnlock(); }
+	};
+
+	template <typename LockAdapter>
+	void MeasureLock(const char* lockName, const OperationMix& mix, const uint32 threadCount)
+	{
+		const uint32 operationsPerThread = OperationCount / threadCount;
+
+		LockAdapter* lock = new LockAdapter;
+		ProtectedData* data = new ProtectedData {};
+		uint64 checksums[MaxMeasuredThreadCount] = {};
+
+		float64 bestTime = 0.0;
+		for (uint32 repeat = 0; repeat < RepeatCount; repeat++)
+		{
+			const float64 time = MeasureOnThreads(threadCount, [&](const uint32 threadIndex)
+			{
+				uint64 checksum = 0;
+
+				// Every thread picks operations from its own LCG, so reads and writes interleave randomly.
+				uint64 state = 0x2545F4914F6CDD1Dull + threadIndex;
+				for (uint32 i = 0; i < operationsPerThread; i++)
+				{
+					state = state * 6364136223846793005ull + 1442695040888963407ull;
+					if ((state >> 60) < mix.writesPer16)
+					{
+						lock->write([&]
+						{
+							for (uint32 j = 0; j < ProtectedData::ValueCount; j++)
+								data->values[j]++;
+						});
+					}
+					else
+					{
+						lock->read([&]
+						{
+							uint64 sum = 0;
+							for (uint32 j = 0; j < ProtectedData::ValueCount; j++)
+								sum += data->values[j];
+							checksum += sum;
+						});
+					}
+				}
+
+				checksums[threadIndex] = checksum;
+			});
+
+			if (repeat == 0 || time < bestTime)
+				bestTime = time;
+		}
+
+		for (uint32 i = 0; i < threadCount; i++)
+		{
+			XAssert(checksums[i] % ProtectedData::ValueCount == 0);
+			Consume(checksums[i]);
+		}
+
+		delete data;
+		delete lock;
+
+		InplaceStringASCIIx64 name;
+		FmtPrintStr(name, lockName, ' ', mix.name, " (", threadCount, " threads)");
+		Report(GroupName, name.getCStr(), bestTime, float64(operationsPerThread * threadCount), "op");
+	}
+}
+
+void XEngine::Benchmarks::RunLockBenchmarks()
+{
+	for (const OperationMix& mix : OperationMixes)
+	{
+		for (const uint32 threadCount : ThreadCounts)
+		{
+			MeasureLock<ExclusiveLockAdapter<Lock>>("Lock", mix, threadCount);
+			MeasureLock<ExclusiveLockAdapter<TicketLock>>("TicketLock", mix, threadCount);
+			MeasureLock<ExclusiveLockAdapter<LegacyLock>>("legacy Lock", mix, threadCount);
+			MeasureLock<ReadersWriterLockAdapter>("ReadersWriterLock", mix, threadCount);
+			MeasureLock<LegacyReadersWriterLockAdapter>("legacy ReadersWriterLock", mix, threadCount);
+		}
+	}
+}
@@ -0,0 +1,264 @@
+#include <emmintrin.h>
+
+#include <XLib.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.Fmt.h>
+#include <XLib.NonCopyable.h>
+#include <XLib.String.h>
+#include <XLib.System.Threading.Atomics.h>
+#include <XLib.System.Threading.Event.h>
+#include <XLib.System.Threading.MTCircularQueue.h>
+#include <XLib.System.Timer.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine::Benchmarks;
+
+// Blocking `MTCircularQueue_MPMC` (Vyukov ring with adaptive spin and parking) and its non-blocking
+// core `MTBoundedQueue_MPMC` (retried with pause) against the queue it replaced, from 1 producer
+// and 1 consumer up to 16 and 16. Every 64th element carries its enqueue time, so consumers also
+// collect enqueue-to-dequeue latency. Latency includes time element waits behind others in a full
+// queue, so it is only comparable between queues at the same producer/consumer count.
+
+namespace
+{
+	constexpr const char* GroupName = "MTCircularQueue";
+
+	constexpr uint32 QueueCapacityLog2 = 10;
+	constexpr uint32 ElementCount = 1 << 18;
+	constexpr uint32 LatencySamplingInterval = 64;
+	constexpr uint32 ThreadPairCounts[] = { 1, 2, 4, 8, 16 };
+	constexpr uint32 RepeatCount = 3;
+
+	// Previous `MTCircularQueue_MPMC`, kept as reference point. Algorithm is unchanged: producers claim
+	// index with CAS and then wait for previous producers to publish in order. Only `compareExchange`
+	// argument order and `const` on spin snapshots are fixed, so it compiles and does not spin forever.
+	template <typename Type, uint32 capacityLog2, uint32 spinCount = 1000>
+	class LegacyMTCircularQueue_MPMC : public NonCopyable
+	{
+	private:
+		static constexpr uint32 size = 1 << capacityLog2;
+
+	private:
+		Type buffer[size];
+		Event frontEvent, backEvent;
+		Atomic<uint32> frontIdx = 0;
+		Atomic<uint32> backIdx = 0;
+		volatile uint32 readyFrontIdx = 0;
+		volatile uint32 readyBackIdx = 0;
+		Atomic<uint16> waitingFrontCount = 0;
+		Atomic<uint16> waitingBackCount = 0;
+
+	public:
+		inline void initialize()
+		{
+			frontEvent.initialize(false);
+			backEvent.initialize(false);
+		}
+
+		inline void enqueue(const Type& value)
+		{
+			for (;;)
+			{
+				uint32 lastLocalReadyBackIdx = readyBackIdx;
+				for (sint32 spin = 0; spin < sint32(spinCount); spin++)
+				{
+					const uint32 localFrontIdx = frontIdx.load();
+					const uint32 localReadyBackIdx = readyBackIdx;
+					if (localFrontIdx - localReadyBackIdx < size)
+					{
+						if (frontIdx.compareExchange(localFrontIdx, localFrontIdx + 1))
+						{
+							buffer[localFrontIdx % size] = value;
+
+							while (readyFrontIdx != localFrontIdx) {}
+							readyFrontIdx++;
+
+							if (waitingBackCount.load())
+								backEvent.set();
+
+							return;
+						}
+						spin = -1;
+					}
+					if (lastLocalReadyBackIdx != localReadyBackIdx)
+					{
+						spin = -1;
+						lastLocalReadyBackIdx = localReadyBackIdx;
+					}
+				}
+
+				frontEvent.reset();
+				waitingFrontCount.increment();
+				if (lastLocalReadyBackIdx != readyBackIdx)
+				{
+					frontEvent.set();
+					waitingFrontCount.decrement();
+					continue;
+				}
+
+				frontEvent.wait();
+				waitingFrontCount.decrement();
+			}
+		}
+
+		inline Type dequeue()
+		{
+			for (;;)
+			{
+				uint32 lastLocalReadyFrontIdx = readyFrontIdx;
+				for (sint32 spin = 0; spin < sint32(spinCount); spin++)
+				{
+					const uint32 localBackIdx = backIdx.load();
+					const uint32 localReadyFrontIdx = readyFrontIdx;
+					if (localReadyFrontIdx - localBackIdx > 0)
+					{
+						if (backIdx.compareExchange(localBackIdx, localBackIdx + 1))
+						{
+							Type result = buffer[localBackIdx % size];
+
+							while (readyBackIdx != localBackIdx) {}
+							readyBackIdx++;
+
+							if (waitingFrontCount.load())
+								frontEvent.set();
+
+							return result;
+						}
+						spin = -1;
+					}
+					if (lastLocalReadyFrontIdx != localReadyFrontIdx)
+					{
+						spin = -1;
+						lastLocalReadyFrontIdx = localReadyFrontIdx;
+					}
+				}
+
+				backEvent.reset();
+				waitingBackCount.increment();
+				if (lastLocalReadyFrontIdx != readyFrontIdx)
+				{
+					backEvent.set();
+					waitingBackCount.decrement();
+					continue;
+				}
+
+				backEvent.wait();
+				waitingBackCount.decrement();
+			}
+		}
+	};
+
+	// Element is enqueue time record or zero if element is not sampled.
+	using Element = uint64;
+
+	class BlockingQueueAdapter : public NonCopyable
+	{
+	private:
+		MTCircularQueue_MPMC<Element, QueueCapacityLog2> queue;
+
+	public:
+		static constexpr const char* Name = "MTCircularQueue_MPMC";
+
+		inline BlockingQueueAdapter() { queue.initialize(); }
+		inline void enqueue(Element element) { queue.enqueue(element); }
+		inline Element dequeue() { return queue.dequeue(); }
+	};
+
+	class NonBlockingQueueAdapter : public NonCopyable
+	{
+	private:
+		MTBoundedQueue_MPMC<Element, QueueCapacityLog2> queue;
+
+	public:
+		static constexpr const char* Name = "MTBoundedQueue_MPMC";
+
+		inline void enqueue(Element element) { while (!queue.tryEnqueue(element)) _mm_pause(); }
+		inline Element dequeue() { Element element; while (!queue.tryDequeue(element)) _mm_pause(); return element; }
+	};
+
+	class LegacyQueueAdapter : public NonCopyable
+	{
+	private:
+		LegacyMTCircularQueue_MPMC<Element, QueueCapacityLog2> queue;
+
+	public:
+		static constexpr const char* Name = "legacy MTCircularQueue_MPMC";
+
+		inline LegacyQueueAdapter() { queue.initialize(); }
+		inline void enqueue(Element element) { queue.enqueue(element); }
+		inline Element dequeue() { return queue.dequeue(); }
+	};
+
+	template <typename QueueAdapter>
+	void MeasureQueue(const uint32 threadPairCount)
+	{
+		static_assert(ElementCount % (ThreadPairCounts[countOf(ThreadPairCounts) - 1] * LatencySamplingInterval) == 0);
+
+		const uint32 elementsPerThread = ElementCount / threadPairCount;
+
+		ArrayList<float32> latencySamples[MaxMeasuredThreadCount / 2];
+		for (uint32 i = 0; i < threadPairCount; i++)
+			latencySamples[i].reserve(elementsPerThread / LatencySamplingInterval);
+
+		float64 bestTime = 0.0;
+		for (uint32 repeat = 0; repeat < RepeatCount; repeat++)
+		{
+			QueueAdapter* queue = new QueueAdapter;
+			for (uint32 i = 0; i < threadPairCount; i++)
+				latencySamples[i].clear();
+
+			// Threads `[0, threadPairCount)` are producers, the rest are consumers.
+			const float64 time = MeasureOnThreads(threadPairCount * 2, [&](const uint32 threadIndex)
+			{
+				if (threadIndex < threadPairCount)
+				{
+					for (uint32 i = 0; i < elementsPerThread; i++)
+						queue->enqueue(i % LatencySamplingInterval ? 0 : Timer::GetRecord());
+				}
+				else
+				{
+					ArrayList<float32>& samples = latencySamples[threadIndex - threadPairCount];
+					for (uint32 i = 0; i < elementsPerThread; i++)
+					{
+						const Element element = queue->dequeue();
+						if (element)
+							samples.pushBack(Timer::GetTimeDelta(element));
+					}
+				}
+			});
+
+			delete queue;
+
+			if (repeat == 0 || time < bestTime)
+				bestTime = time;
+		}
+
+		InplaceStringASCIIx64 name;
+		FmtPrintStr(name, QueueAdapter::Name, ' ', threadPairCount, 'P', threadPairCount, 'C');
+		Report(GroupName, name.getCStr(), bestTime, float64(ElementCount), "elements");
+
+		// Samples of the last repeat.
+		ArrayList<float32> allLatencySamples;
+		for (uint32 i = 0; i < threadPairCount; i++)
+		{
+			for (const float32 sample : latencySamples[i])
+				allLatencySamples.pushBack(sample);
+		}
+
+		name.clear();
+		FmtPrintStr(name, QueueAdapter::Name, ' ', threadPairCount, 'P', threadPairCount, "C latency");
+		ReportLatency(GroupName, name.getCStr(), allLatencySamples.getData(), allLatencySamples.getSize());
+	}
+}
+
+void XEngine::Benchmarks::RunMTCircularQueueBenchmarks()
+{
+	for (const uint32 threadPairCount : ThreadPairCounts)
+	{
+		MeasureQueue<BlockingQueueAdapter>(threadPairCount);
+		MeasureQueue<NonBlockingQueueAdapter>(threadPairCount);
+		MeasureQueue<LegacyQueueAdapter>(threadPairCount);
+	}
+}
@@ -0,0 +1,392 @@
+#include <XLib.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.Fmt.h>
+#include <XLib.String.h>
+#include <XLib.System.VirtualMemory.h>
+
+#include <XEngine.ThreadPool.h>
+#include <XEngine.Simulation.Engine.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine;
+using namespace XEngine::Benchmarks;
+using namespace XEngine::Simulation;
+using namespace XEngine::Simulation::ModelInternals;
+
+// Three archetypes with different component sets and jobs, entities interleaved between them:
+// moving (position, velocity, age; two independent jobs), static (position, health; one job) and
+// projectile (position, velocity, lifetime; gravity job writes velocity that integration reads, so
+// its jobs go in two waves). Moving archetype work is also done over array of structures for all
+// entities as a reference point for SoA page layout.
+// State group measures snapshot machinery over same model at 10K, 100K and 1M entities: capture,
+// copy-on-write tick while previous state is alive, and full and delta serialization round trips.
+
+namespace
+{
+	constexpr const char* GroupName = "Simulation.Engine";
+	constexpr const char* StateGroupName = "Simulation.State";
+
+	constexpr uint32 EntityCount = 1000000;
+	constexpr uint32 StateEntityCounts[] = { 10000, 100000, 1000000 };
+	constexpr uint32 RepeatCount = 5;
+	constexpr uintptr MemoryPoolSize = uintptr(8192) * ModelInternals::PageSize;
+	constexpr uintptr StateMemoryPoolSize = uintptr(16384) * ModelInternals::PageSize; // Room for deserialized copies.
+
+	constexpr uint32 DeltaChangedEntityFraction = 100; // One in this many is changed between delta states. Spans few pages.
+
+	constexpr float32 TimeStep = 1.0f / 60.0f;
+
+	struct Vec3Component
+	{
+		float32 x, y, z;
+	};
+
+	// Archetype component slots. Position is first in every archetype, so it can be accessed
+	// without knowing archetype of entity.
+	enum ComponentSlot : uint32
+	{
+		PositionSlot = 0,
+		VelocitySlot = 1,	// Moving and projectile.
+		AgeSlot = 2,		// Moving.
+		LifetimeSlot = 2,	// Projectile.
+		HealthSlot = 1,		// Static.
+	};
+
+	enum ArchetypeIndex : uint16
+	{
+		MovingArchetype = 0,
+		StaticArchetype,
+		ProjectileArchetype,
+	};
+
+	void IntegrateJob(const JobExecutorContext& context)
+	{
+		Vec3Component* positions = (Vec3Component*)context.columns[PositionSlot];
+		const Vec3Component* velocities = (const Vec3Component*)context.columns[VelocitySlot];
+
+		for (uint32 i = context.entityBeginIndex; i < context.entityEndIndex; i++)
+		{
+			positions[i].x += velocities[i].x * TimeStep;
+			positions[i].y += velocities[i].y * TimeStep;
+			positions[i].z += velocities[i].z * TimeStep;
+		}
+	}
+
+	void AgeJob(const JobExecutorContext& context)
+	{
+		uint32* ages = (uint32*)context.columns[AgeSlot];
+		for (uint32 i = context.entityBeginIndex; i < context.entityEndIndex; i++)
+			ages[i]++;
+	}
+
+	void RegenerateHealthJob(const JobExecutorContext& context)
+	{
+		float32* healths = (float32*)context.columns[HealthSlot];
+		for (uint32 i = context.entityBeginIndex; i < context.entityEndIndex; i++)
+			healths[i] = min(healths[i] + TimeStep, 100.0f);
+	}
+
+	void GravityJob(const JobExecutorContext& context)
+	{
+		Vec3Component* velocities = (Vec3Component*)context.columns[VelocitySlot];
+		for (uint32 i = context.entityBeginIndex; i < context.entityEndIndex; i++)
+			velocities[i].y -= 9.8f * TimeStep;
+	}
+
+	void LifetimeJob(const JobExecutorContext& context)
+	{
+		float32* lifetimes = (float32*)context.columns[LifetimeSlot];
+		for (uint32 i = context.entityBeginIndex; i < context.entityEndIndex; i++)
+			lifetimes[i] -= TimeStep;
+	}
+
+	enum ComponentIndex : uint16
+	{
+		PositionComponent = 0,
+		VelocityComponent,
+		AgeComponent,
+		HealthComponent,
+		LifetimeComponent,
+	};
+
+	const Component Components[] =
+	{
+		{ sizeof(Vec3Component), alignof(Vec3Component) },
+		{ sizeof(Vec3Component), alignof(Vec3Component) },
+		{ sizeof(uint32), alignof(uint32) },
+		{ sizeof(float32), alignof(float32) },
+		{ sizeof(float32), alignof(float32) },
+	};
+
+	const uint16 MovingComponentIndices[] = { PositionComponent, VelocityComponent, AgeComponent };
+	const uint16 StaticComponentIndices[] = { PositionComponent, HealthComponent };
+	const uint16 ProjectileComponentIndices[] = { PositionComponent, VelocityComponent, LifetimeComponent };
+
+	const Job MovingJobs[] =
+	{
+		{ &IntegrateJob, (1 << PositionSlot) | (1 << VelocitySlot), 1 << PositionSlot },
+		{ &AgeJob, 1 << AgeSlot, 1 << AgeSlot },
+	};
+
+	const Job StaticJobs[] =
+	{
+		{ &RegenerateHealthJob, 1 << HealthSlot, 1 << HealthSlot },
+	};
+
+	const Job ProjectileJobs[] =
+	{
+		{ &GravityJob, 1 << VelocitySlot, 1 << VelocitySlot },
+		{ &IntegrateJob, (1 << PositionSlot) | (1 << VelocitySlot), 1 << PositionSlot },
+		{ &LifetimeJob, 1 << LifetimeSlot, 1 << LifetimeSlot },
+	};
+
+	const Archetype Archetypes[] =
+	{
+		{ 1, MovingComponentIndices, uint16(countOf(MovingComponentIndices)), MovingJobs, uint16(countOf(MovingJobs)), nullptr },
+		{ 2, StaticComponentIndices, uint16(countOf(StaticComponentIndices)), StaticJobs, uint16(countOf(StaticJobs)), nullptr },
+		{ 3, ProjectileComponentIndices, uint16(countOf(ProjectileComponentIndices)), ProjectileJobs, uint16(countOf(ProjectileJobs)), nullptr },
+	};
+
+	const Model BenchmarkModel = { Components, uint32(countOf(Components)), Archetypes, uint32(countOf(Archetypes)) };
+
+	struct EntityAoS
+	{
+		uint64 id;
+		Vec3Component position;
+		Vec3Component velocity;
+		uint32 age;
+	};
+
+	inline Vec3Component GetInitialVelocity(const uint32 entityIndex)
+	{
+		const float32 value = float32(entityIndex % 97) * 0.01f;
+		return Vec3Component { value, -value, value * 0.5f };
+	}
+
+	// Half of entities are moving, 30% static and 20% projectiles, interleaved in creation order.
+	inline ArchetypeIndex GetEntityArchetype(const uint32 entityIndex)
+	{
+		const uint32 tenth = entityIndex % 10;
+		return tenth < 5 ? MovingArchetype : (tenth < 8 ? StaticArchetype : ProjectileArchetype);
+	}
+
+	void CreateEntities(Engine& engine, ArrayList<EntityId>& entityIds, const uint32 entityCount = EntityCount)
+	{
+		entityIds.clear();
+		entityIds.reserve(entityCount);
+
+		for (uint32 i = 0; i < entityCount; i++)
+		{
+			const ArchetypeIndex archetype = GetEntityArchetype(i);
+			const EntityId id = engine.createEntity(archetype);
+			if (archetype == StaticArchetype)
+				*(float32*)engine.getEntityComponent(id, HealthSlot) = float32(i % 100);
+			else
+				*(Vec3Component*)engine.getEntityComponent(id, VelocitySlot) = GetInitialVelocity(i);
+			if (archetype == ProjectileArchetype)
+				*(float32*)engine.getEntityComponent(id, LifetimeSlot) = 10.0f;
+			entityIds.pushBack(id);
+		}
+	}
+
+	void BenchmarkCreation(void* memoryPool)
+	{
+		ArrayList<EntityId> entityIds;
+
+		float64 bestTime = 0.0;
+		for (uint32 i = 0; i < RepeatCount; i++)
+		{
+			Engine engine;
+			engine.initialize(BenchmarkModel, memoryPool, MemoryPoolSize);
+
+			const float64 time = MeasureBestTime(1, [&] { CreateEntities(engine, entityIds); });
+			if (i == 0 || time < bestTime)
+				bestTime = time;
+
+			engine.dropOperativeState();
+			engine.destroy();
+		}
+
+		Report(GroupName, "CreateEntity", bestTime, EntityCount, "entities");
+	}
+
+	void BenchmarkTick(void* memoryPool)
+	{
+		Engine engine;
+		engine.initialize(BenchmarkModel, memoryPool, MemoryPoolSize);
+
+		ArrayList<EntityId> entityIds;
+		CreateEntities(engine, entityIds);
+
+		// Warm up, so pages are touched and captured state machinery is allocated.
+		engine.releaseState(engine.tick());
+
+		const uint32 threadCount = ThreadPool::GetThreadCount();
+		const float64 tickTime = MeasureBestTime(RepeatCount, [&] { engine.releaseState(engine.tick()); });
+
+		ThreadPool::SetThreadCount(1);
+		const float64 singleThreadTickTime = MeasureBestTime(RepeatCount, [&] { engine.releaseState(engine.tick()); });
+		ThreadPool::SetThreadCount(threadCount);
+
+		Report(GroupName, "Tick", tickTime, EntityCount, "entities");
+		Report(GroupName, "Tick (single thread)", singleThreadTickTime, EntityCount, "entities");
+
+		// Random access through entity records, as gameplay code does.
+		uint32 state = 1;
+		for (uint32 i = EntityCount - 1; i > 0; i--)
+		{
+			state = state * 1664525 + 1013904223;
+			const uint32 j = state % (i + 1);
+			const EntityId tmp = entityIds[i];
+			entityIds[i] = entityIds[j];
+			entityIds[j] = tmp;
+		}
+
+		float64 positionSum = 0.0;
+		const float64 lookupTime = MeasureBestTime(RepeatCount, [&]
+		{
+			for (const EntityId id : entityIds)
+				positionSum += ((const Vec3Component*)engine.getEntityComponent(id, PositionSlot))->x;
+		});
+		Consume(uint64(positionSum));
+
+		Report(GroupName, "GetEntityComponent (random order)", lookupTime, EntityCount, "entities");
+
+		engine.dropOperativeState();
+		engine.destroy();
+	}
+
+	void BenchmarkReferenceAoS()
+	{
+		ArrayList<EntityAoS> entities;
+		entities.resize(EntityCount);
+		for (uint32 i = 0; i < EntityCount; i++)
+		{
+			EntityAoS& entity = entities[i];
+			entity = {};
+			entity.id = i;
+			entity.velocity = GetInitialVelocity(i);
+		}
+
+		const float64 time = MeasureBestTime(RepeatCount, [&]
+		{
+			for (EntityAoS& entity : entities)
+			{
+				entity.position.x += entity.velocity.x * TimeStep;
+				entity.position.y += entity.velocity.y * TimeStep;
+				entity.position.z += entity.velocity.z * TimeStep;
+				entity.age++;
+			}
+		});
+		Consume(entities[EntityCount / 2].age);
+
+		Report(GroupName, "Reference AoS loop (single thread)", time, EntityCount, "entities");
+	}
+
+	void ReportState(const char* operationName, const uint32 entityCount,
+		const float64 seconds, const float64 itemCount, const char* itemName)
+	{
+		InplaceStringASCIIx64 name;
+		FmtPrintStr(name, operationName, ", ", entityCount, " entities");
+		Report(StateGroupName, name.getCStr(), seconds, itemCount, itemName);
+	}
+
+	void BenchmarkStateSnapshots(void* memoryPool, const uint32 entityCount)
+	{
+		Engine engine;
+		engine.initialize(BenchmarkModel, memoryPool, StateMemoryPoolSize);
+
+		ArrayList<EntityId> entityIds;
+		CreateEntities(engine, entityIds, entityCount);
+		engine.releaseState(engine.tick());
+
+		// Capture only shares pages, so it costs page list copy.
+		const float64 captureTime = MeasureBestTime(RepeatCount, [&] { engine.releaseState(engine.captureOperativeState()); });
+		ReportState("CaptureOperativeState", entityCount, captureTime, entityCount, "entities");
+
+		// Previous state is kept alive, so every written page is copied before tick writes it.
+		StateHandle previousState = engine.tick();
+		const float64 tickTime = MeasureBestTime(RepeatCount, [&]
+		{
+			const StateHandle state = engine.tick();
+			engine.releaseState(previousState);
+			previousState = state;
+		});
+		engine.releaseState(previousState);
+		ReportState("Tick (previous state alive)", entityCount, tickTime, entityCount, "entities");
+
+		// Delta between two states that differ in small fraction of entities.
+		const uint32 deltaChangedEntityCount = entityCount / DeltaChangedEntityFraction;
+		const StateHandle baseState = engine.captureOperativeState();
+		for (uint32 i = 0; i < deltaChangedEntityCount; i++)
+			((Vec3Component*)engine.getEntityComponent(entityIds[i], PositionSlot))->x += 1.0f;
+		const StateHandle state = engine.captureOperativeState();
+
+		const uintptr fullSize = engine.getSerializedStateSize(state);
+		const uintptr deltaSize = engine.getSerializedStateSize(state, baseState);
+
+		ArrayList<byte> fullData;
+		ArrayList<byte> deltaData;
+		fullData.resize(uint32(fullSize));
+		deltaData.resize(uint32(deltaSize));
+
+		const float64 fullSerializeTime = MeasureBestTime(RepeatCount, [&]
+		{
+			engine.serializeState(state, StateHandle::Zero, fullData.getData(), fullSize);
+		});
+		const float64 deltaSerializeTime = MeasureBestTime(RepeatCount, [&]
+		{
+			engine.serializeState(state, baseState, deltaData.getData(), deltaSize);
+		});
+
+		const float64 fullDeserializeTime = MeasureBestTime(RepeatCount, [&]
+		{
+			const StateHandle deserializedState = engine.deserializeState(fullData.getData(), fullSize);
+			XAssert(deserializedState != StateHandle::Zero);
+			engine.releaseState(deserializedState);
+		});
+		const float64 deltaDeserializeTime = MeasureBestTime(RepeatCount, [&]
+		{
+			const StateHandle deserializedState = engine.deserializeState(deltaData.getData(), deltaSize, baseState);
+			XAssert(deserializedState != StateHandle::Zero);
+			engine.releaseState(deserializedState);
+		});
+
+		ReportState("SerializeState (full)", entityCount, fullSerializeTime, float64(fullSize), "B");
+		ReportState("SerializeState (delta)", entityCount, deltaSerializeTime, float64(deltaSize), "B");
+		ReportState("DeserializeState (full)", entityCount, fullDeserializeTime, float64(fullSize), "B");
+		ReportState("DeserializeState (delta)", entityCount, deltaDeserializeTime, float64(deltaSize), "B");
+		FmtPrintStdOut(StateGroupName, "/Serialized size, ", entityCount, " entities: full ", fullSize / 1024,
+			" KiB, delta ", deltaSize / 1024, " KiB (", deltaChangedEntityCount, " entities changed)\n");
+
+		engine.releaseState(state);
+		engine.releaseState(baseState);
+		engine.dropOperativeState();
+		engine.destroy();
+	}
+}
+
+void XEngine::Benchmarks::RunSimulationEngineBenchmarks()
+{
+	void* memoryPool = VirtualMemory::Allocate(MemoryPoolSize);
+	XAssert(memoryPool);
+
+	BenchmarkCreation(memoryPool);
+	BenchmarkTick(memoryPool);
+	BenchmarkReferenceAoS();
+
+	VirtualMemory::Release(memoryPool, MemoryPoolSize);
+}
+
+void XEngine::Benchmarks::RunSimulationStateBenchmarks()
+{
+	void* memoryPool = VirtualMemory::Allocate(StateMemoryPoolSize);
+	XAssert(memoryPool);
+
+	for (const uint32 entityCount : StateEntityCounts)
+		BenchmarkStateSnapshots(memoryPool, entityCount);
+
+	VirtualMemory::Release(memoryPool, StateMemoryPoolSize);
+}
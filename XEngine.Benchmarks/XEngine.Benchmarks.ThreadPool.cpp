@@ -0,0 +1,161 @@
+#include <emmintrin.h>
+
+#include <XLib.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.Fmt.h>
+#include <XLib.String.h>
+#include <XLib.System.Threading.Atomics.h>
+#include <XLib.System.Timer.h>
+
+#include <XEngine.ThreadPool.h>
+#include <XEngine.ThreadPoolUtils.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine;
+using namespace XEngine::Benchmarks;
+
+// Task spawn throughput and latency with pool resized from 1 to 64 threads (benchmark main routine is
+// an occupant, so thread count includes it, and there is always at least one worker).
+// Fan-out: every task spawns two children from a worker, so deque push/pop and stealing dominate.
+// Injection: all tasks are queued from occupant thread through shared injection queue.
+// Latency: time from `QueueTask` on occupant thread until task starts on a worker, back to back
+// (workers are spinning) and after idle period (workers are parked and have to be woken).
+// Occupant waits without running tasks, so only workers are measured.
+
+namespace
+{
+	constexpr const char* GroupName = "ThreadPool";
+
+	constexpr uint32 ThreadCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+	constexpr uint32 FanOutTreeDepth = 19;
+	constexpr uint32 FanOutTaskCount = (2u << FanOutTreeDepth) - 1;
+	constexpr uint32 InjectionTaskCount = 1 << 18;
+	constexpr uint32 HotLatencySampleCount = 10000;
+	constexpr uint32 IdleLatencySampleCount = 500;
+	constexpr uint32 IdlePeriodMicroseconds = 1000;
+	constexpr uint32 RepeatCount = 5;
+
+	struct CountedTask : ThreadPool::Task
+	{
+		uint32 index = 0;
+	};
+
+	struct LatencyTask : ThreadPool::Task
+	{
+		TimerRecord startRecord = 0;
+		AtomicU32 started = 0;
+	};
+
+	// Tasks of fan-out tree are laid out as binary heap: children of task `i` are `2i + 1` and `2i + 2`.
+	CountedTask* tasks = nullptr;
+	TaskCounter taskCounter;
+
+	void CountedTaskRoutine(CountedTask& task)
+	{
+		taskCounter.decrement();
+	}
+
+	void FanOutTaskRoutine(CountedTask& task)
+	{
+		const uint32 firstChildIndex = task.index * 2 + 1;
+		if (firstChildIndex + 1 < FanOutTaskCount)
+		{
+			ThreadPool::QueueTask(tasks[firstChildIndex], &FanOutTaskRoutine);
+			ThreadPool::QueueTask(tasks[firstChildIndex + 1], &FanOutTaskRoutine);
+		}
+		taskCounter.decrement();
+	}
+
+	void LatencyTaskRoutine(LatencyTask& task)
+	{
+		task.startRecord = Timer::GetRecord();
+		task.started.store(1);
+	}
+
+	void WaitForTaskCounter()
+	{
+		while (!taskCounter.isDone())
+			_mm_pause();
+	}
+
+	float32 MeasureSpawnLatency(LatencyTask& task)
+	{
+		task.started.store(0);
+		const TimerRecord queueRecord = Timer::GetRecord();
+		ThreadPool::QueueTask(task, &LatencyTaskRoutine);
+
+		while (!task.started.load())
+			_mm_pause();
+
+		return Timer::GetTimeDelta(queueRecord, task.startRecord);
+	}
+
+	void RunForThreadCount(const uint32 threadCount)
+	{
+		ThreadPool::SetThreadCount(threadCount);
+
+		InplaceStringASCIIx64 name;
+
+		FmtPrintStr(name, "fan-out (", threadCount, " threads)");
+		const float64 fanOutTime = MeasureBestTime(RepeatCount, [&]
+		{
+			for (uint32 i = 0; i < FanOutTaskCount; i++)
+				tasks[i].index = i;
+
+			taskCounter.initialize(FanOutTaskCount);
+			ThreadPool::QueueTask(tasks[0], &FanOutTaskRoutine);
+			WaitForTaskCounter();
+		});
+		Report(GroupName, name.getCStr(), fanOutTime, float64(FanOutTaskCount), "tasks");
+
+		name.clear();
+		FmtPrintStr(name, "injection (", threadCount, " threads)");
+		const float64 injectionTime = MeasureBestTime(RepeatCount, [&]
+		{
+			taskCounter.initialize(InjectionTaskCount);
+			for (uint32 i = 0; i < InjectionTaskCount; i++)
+				ThreadPool::QueueTask(tasks[i], &CountedTaskRoutine);
+			WaitForTaskCounter();
+		});
+		Report(GroupName, name.getCStr(), injectionTime, float64(InjectionTaskCount), "tasks");
+
+		LatencyTask latencyTask;
+		ArrayList<float32> samples;
+
+		samples.resize(HotLatencySampleCount);
+		for (uint32 i = 0; i < HotLatencySampleCount; i++)
+			samples[i] = MeasureSpawnLatency(latencyTask);
+
+		name.clear();
+		FmtPrintStr(name, "spawn latency hot (", threadCount, " threads)");
+		ReportLatency(GroupName, name.getCStr(), samples.getData(), samples.getSize());
+
+		samples.resize(IdleLatencySampleCount);
+		for (uint32 i = 0; i < IdleLatencySampleCount; i++)
+		{
+			ThreadPool::OccupantSleepPrecise(IdlePeriodMicroseconds);
+			samples[i] = MeasureSpawnLatency(latencyTask);
+		}
+
+		name.clear();
+		FmtPrintStr(name, "spawn latency idle (", threadCount, " threads)");
+		ReportLatency(GroupName, name.getCStr(), samples.getData(), samples.getSize());
+	}
+}
+
+void XEngine::Benchmarks::RunThreadPoolBenchmarks()
+{
+	static_assert(InjectionTaskCount <= FanOutTaskCount);
+
+	tasks = new CountedTask[FanOutTaskCount];
+
+	const uint32 initialThreadCount = ThreadPool::GetThreadCount();
+	for (const uint32 threadCount : ThreadCounts)
+		RunForThreadCount(threadCount);
+	ThreadPool::SetThreadCount(initialThreadCount);
+
+	delete[] tasks;
+	tasks = nullptr;
+}
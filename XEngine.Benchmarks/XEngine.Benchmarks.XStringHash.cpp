@@ -0,0 +1,100 @@
+#include <XLib.h>
+#include <XLib.CRC.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.Containers.HashMap.h>
+#include <XLib.Fmt.h>
+#include <XLib.String.h>
+
+#include <XEngine.XStringHash.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine;
+using namespace XEngine::Benchmarks;
+
+// Runtime XSH of names like ones shader library manifests declare (short to medium, mixed lengths,
+// so tails and alignment prologues are taken often) and of long paths. C strings end with NUL
+// search, views with known length. CRC64 and HashMap hashing of the same bytes are reference points.
+
+namespace
+{
+	constexpr const char* GroupName = "XStringHash";
+
+	constexpr uint32 NameCount = 4096;
+	constexpr uint32 PassCount = 64;
+	constexpr uint32 RepeatCount = 5;
+
+	template <typename Body>
+	void Measure(const char* name, float64 byteCount, const Body& body)
+	{
+		const float64 time = MeasureBestTime(RepeatCount, [&]
+		{
+			for (uint32 i = 0; i < PassCount; i++)
+				body();
+		});
+		Report(GroupName, name, time, byteCount * PassCount, "B");
+	}
+
+	void RunSet(const char* setName, const ArrayList<DynamicStringASCII>& strings)
+	{
+		uint64 totalLength = 0;
+		for (const DynamicStringASCII& string : strings)
+			totalLength += string.getLength();
+		const float64 byteCount = float64(totalLength);
+
+		uint64 checksum = 0;
+		InplaceStringASCIIx64 name;
+
+		FmtPrintStr(name, "XSH C string (", setName, ')');
+		Measure(name.getCStr(), byteCount, [&]
+		{
+			for (const DynamicStringASCII& string : strings)
+				checksum += XSH::Compute(string.getCStr());
+		});
+
+		name.clear();
+		FmtPrintStr(name, "XSH view (", setName, ')');
+		Measure(name.getCStr(), byteCount, [&]
+		{
+			for (const DynamicStringASCII& string : strings)
+				checksum += XSH::Compute(string.getView());
+		});
+
+		name.clear();
+		FmtPrintStr(name, "CRC64 (", setName, ')');
+		Measure(name.getCStr(), byteCount, [&]
+		{
+			for (const DynamicStringASCII& string : strings)
+				checksum += CRC64::Compute(string.getView().getData(), string.getLength());
+		});
+
+		name.clear();
+		FmtPrintStr(name, "HashMap bytes hash (", setName, ')');
+		Measure(name.getCStr(), byteCount, [&]
+		{
+			for (const DynamicStringASCII& string : strings)
+				checksum += HashMapHashing::ComputeBytes(string.getView().getData(), string.getLength());
+		});
+
+		Consume(checksum);
+	}
+}
+
+void XEngine::Benchmarks::RunXStringHashBenchmarks()
+{
+	static const char* const NameParts[] = { "Albedo", "NormalMap", "Roughness", "ShadowCaster", "Terrain", "GBuffer", "PostProcess.ToneMap", "UI" };
+	constexpr uint32 NamePartCount = countOf(NameParts);
+
+	ArrayList<DynamicStringASCII> names;
+	ArrayList<DynamicStringASCII> paths;
+	for (uint32 i = 0; i < NameCount; i++)
+	{
+		FmtPrintStr(names.emplaceBack(), NameParts[i % NamePartCount], '.', NameParts[(i / NamePartCount) % NamePartCount], i % 7 ? ".PS" : ".VS");
+		FmtPrintStr(paths.emplaceBack(), "Content/Shaders/", NameParts[i % NamePartCount], '/',
+			NameParts[(i / NamePartCount) % NamePartCount], "/Permutations/Variant_", i, ".hlsl");
+	}
+
+	RunSet("names", names);
+	RunSet("paths", paths);
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+
+#include <XLib.h>
+#include <XLib.Fmt.h>
+#include <XLib.String.h>
+#include <XLib.System.Threading.h>
+
+#include <XEngine.ThreadPool.h>
+
+#include "XEngine.Benchmarks.h"
+
+using namespace XLib;
+using namespace XEngine;
+using namespace XEngine::Benchmarks;
+
+namespace
+{
+	struct BenchmarkGroup
+	{
+		const char* name;
+		void(*runFunc)();
+	};
+
+	const BenchmarkGroup BenchmarkGroups[] =
+	{
+		{ "Simulation.Engine", &RunSimulationEngineBenchmarks },
+		{ "Simulation.State", &RunSimulationStateBenchmarks },
+		{ "Simulation.FixedPoint", &RunFixedPointBenchmarks },
+		{ "CRC", &RunCRCBenchmarks },
+		{ "Fmt", &RunFmtBenchmarks },
+		{ "JSON", &RunJSONBenchmarks },
+		{ "XStringHash", &RunXStringHashBenchmarks },
+		{ "HashMap", &RunHashMapBenchmarks },
+		{ "ThreadPool", &RunThreadPoolBenchmarks },
+		{ "MTCircularQueue", &RunMTCircularQueueBenchmarks },
+		{ "Lock", &RunLockBenchmarks },
+		{ "DiskWorker", &RunDiskWorkerBenchmarks },
+	};
+
+	struct BenchmarksMainArgs
+	{
+		int argc;
+		char** argv;
+	};
+
+	volatile uint64 consumedValue = 0;
+
+	// Rounds to two decimal places, so shortest float output stays short.
+	inline float64 RoundForReport(const float64 value) { return float64(uint64(value * 100.0 + 0.5)) / 100.0; }
+
+	bool IsGroupSelected(const BenchmarkGroup& group, const BenchmarksMainArgs& args)
+	{
+		if (args.argc <= 1)
+			return true;
+
+		const StringViewASCII groupName = StringViewASCII::FromCStr(group.name);
+		for (int i = 1; i < args.argc; i++)
+		{
+			if (groupName.startsWith(StringViewASCII::FromCStr(args.argv[i])))
+				return true;
+		}
+		return false;
+	}
+
+	void BenchmarksMain(void* argsPtr)
+	{
+		const BenchmarksMainArgs& args = *(const BenchmarksMainArgs*)argsPtr;
+
+		for (const BenchmarkGroup& group : BenchmarkGroups)
+		{
+			if (IsGroupSelected(group, args))
+				group.runFunc();
+		}
+	}
+}
+
+void XEngine::Benchmarks::Report(const char* groupName, const char* name,
+	const float64 seconds, const float64 itemCount, const char* itemName)
+{
+	const float64 milliseconds = seconds * 1000.0;
+	const float64 millionsPerSecond = seconds > 0.0 ? itemCount / seconds / 1000000.0 : 0.0;
+
+	FmtPrintStdOut(groupName, "/", name, ": ",
+		RoundForReport(milliseconds), " ms, ", RoundForReport(millionsPerSecond), " M", itemName, "/s\n");
+}
+
+void XEngine::Benchmarks::ReportLatency(const char* groupName, const char* name,
+	float32* samples, const uint32 sampleCount)
+{
+	XAssert(sampleCount > 0);
+	std::sort(samples, samples + sampleCount);
+
+	const float64 p50Microseconds = float64(samples[sampleCount / 2]) * 1000000.0;
+	const float64 p99Microseconds = float64(samples[min<uint32>(sampleCount * 99 / 100, sampleCount - 1)]) * 1000000.0;
+
+	FmtPrintStdOut(groupName, "/", name, ": p50 ",
+		RoundForReport(p50Microseconds), " us, p99 ", RoundForReport(p99Microseconds), " us\n");
+}
+
+void XEngine::Benchmarks::Consume(const uint64 value)
+{
+	consumedValue = consumedValue + value;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarksMainArgs args = { argc, argv };
+	ThreadPool::Run(Thread::GetLogicalCoreCount(), &BenchmarksMain, &args);
+	return 0;
+}
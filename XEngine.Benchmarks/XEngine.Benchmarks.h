@@ -0,0 +1,122 @@
+#pragma once
+
+#include <XLib.h>
+#include <XLib.System.Threading.h>
+#include <XLib.System.Threading.Atomics.h>
+#include <XLib.System.Timer.h>
+
+// Benchmarks are plain functions grouped by area. Every group is run from `main` inside thread pool,
+// so engine code that relies on the pool can be measured as is. Results are printed to stdout as
+// `<group>/<name>: <best time> ms, <throughput>`, one line per measurement. Latency measurements
+// are printed as `<group>/<name>: p50 <time> us, p99 <time> us`.
+//
+// Usage: XEngine.Benchmarks [group name prefix ...]
+// With no arguments all groups are run.
+
+namespace XEngine::Benchmarks
+{
+	// Runs `body` `repeatCount` times and returns best time in seconds. Best run is the least
+	// affected by scheduler and cache noise, so it is what is compared between changes.
+	template <typename Body>
+	inline float64 MeasureBestTime(uint32 repeatCount, const Body& body);
+
+	static constexpr uint32 MaxMeasuredThreadCount = 64;
+
+	// Runs `body(threadIndex)` on `threadCount` dedicated threads (not pool workers) that are released
+	// at the same time. Returns time from release until the last thread finishes in seconds.
+	// Used where measured code blocks or spins, so it can not share threads with the pool.
+	template <typename Body>
+	inline float64 MeasureOnThreads(uint32 threadCount, const Body& body);
+
+	// `itemCount` items were processed in `seconds`. Throughput is printed in millions per second.
+	void Report(const char* groupName, const char* name, float64 seconds, float64 itemCount, const char* itemName);
+
+	// Prints median and 99th percentile of latency samples (in seconds). Sorts samples in place.
+	void ReportLatency(const char* groupName, const char* name, float32* samples, uint32 sampleCount);
+
+	// Result that should not be optimized out.
+	void Consume(uint64 value);
+
+	void RunSimulationEngineBenchmarks();
+	void RunSimulationStateBenchmarks();
+	void RunFixedPointBenchmarks();
+	void RunCRCBenchmarks();
+	void RunFmtBenchmarks();
+	void RunJSONBenchmarks();
+	void RunXStringHashBenchmarks();
+	void RunHashMapBenchmarks();
+	void RunThreadPoolBenchmarks();
+	void RunMTCircularQueueBenchmarks();
+	void RunLockBenchmarks();
+	void RunDiskWorkerBenchmarks();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Body>
+inline float64 XEngine::Benchmarks::MeasureBestTime(const uint32 repeatCount, const Body& body)
+{
+	float64 bestTime = 0.0;
+	for (uint32 i = 0; i < repeatCount; i++)
+	{
+		const XLib::TimerRecord startRecord = XLib::Timer::GetRecord();
+		body();
+		const float64 time = XLib::Timer::GetTimeDelta(startRecord);
+
+		if (i == 0 || time < bestTime)
+			bestTime = time;
+	}
+	return bestTime;
+}
+
+template <typename Body>
+inline float64 XEngine::Benchmarks::MeasureOnThreads(const uint32 threadCount, const Body& body)
+{
+	XAssert(threadCount > 0 && threadCount <= MaxMeasuredThreadCount);
+
+	struct ThreadContext
+	{
+		const Body* body;
+		uint32 threadIndex;
+		XLib::AtomicU32* readyThreadCount;
+		volatile bool* released;
+
+		static uint32 __stdcall Entry(ThreadContext* context)
+		{
+			context->readyThreadCount->increment();
+			while (!*context->released)
+				XLib::Thread::YieldExecution();
+
+			(*context->body)(context->threadIndex);
+			return 0;
+		}
+	};
+
+	XLib::AtomicU32 readyThreadCount = 0;
+	volatile bool released = false;
+
+	XLib::Thread threads[MaxMeasuredThreadCount];
+	ThreadContext contexts[MaxMeasuredThreadCount];
+	for (uint32 i = 0; i < threadCount; i++)
+	{
+		contexts[i] = ThreadContext { &body, i, &readyThreadCount, &released };
+		threads[i].create(&ThreadContext::Entry, &contexts[i]);
+	}
+
+	while (readyThreadCount.load() < threadCount)
+		XLib::Thread::YieldExecution();
+
+	const XLib::TimerRecord startRecord = XLib::Timer::GetRecord();
+	released = true;
+
+	for (uint32 i = 0; i < threadCount; i++)
+		threads[i].wait();
+	const float64 time = XLib::Timer::GetTimeDelta(startRecord);
+
+	for (uint32 i = 0; i < threadCount; i++)
+		threads[i].destroy();
+
+	return time;
+}
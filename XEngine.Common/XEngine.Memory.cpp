@@ -0,0 +1,255 @@
+#include <Windows.h>
+
+#include <XLib.Allocation.h>
+#include <XLib.Fmt.h>
+
+#include "XEngine.Memory.h"
+
+#undef min
+#undef max
+
+using namespace XLib;
+using namespace XEngine::Memory;
+
+namespace
+{
+	// Placed right before every user pointer. 16 bytes to keep default 16 byte alignment.
+	struct AllocationHeader
+	{
+		Heap* heap;
+		uint64 size : 48;
+		uint64 baseOffset : 16; // From system allocation start to user pointer.
+	};
+	static_assert(sizeof(AllocationHeader) == 16);
+
+	constexpr uint32 DefaultAlignment = 16;
+	constexpr uint32 MaxAlignment = 0x8000;
+
+	inline AllocationHeader* GetAllocationHeader(void* ptr) { return (AllocationHeader*)ptr - 1; }
+	inline HANDLE GetSystemHeap(const Heap& heap) { XAssert(heap.getSystemHeap()); return HANDLE(heap.getSystemHeap()); }
+	inline void* GetAllocationBase(void* ptr) { return (byte*)ptr - GetAllocationHeader(ptr)->baseOffset; }
+
+	Heap defaultHeap;
+	Heap* registeredHeaps[Manager::MaxHeapCount] = {};
+	uint32 registeredHeapCount = 0;
+
+	thread_local Heap* currentThreadHeap = nullptr;
+	thread_local uint32 currentThreadHeapsBlockDepth = 0;
+}
+
+// Heap ////////////////////////////////////////////////////////////////////////////////////////////
+
+void* Heap::getOrCreateSystemHeap()
+{
+	if (systemHeap)
+		return systemHeap;
+
+	// Heap that was never registered is first used by allocation. Several threads can race here.
+	// Growable system heap has low fragmentation heap enabled by default.
+	HANDLE newSystemHeap = HeapCreate(0, 0, 0);
+	XAssert(newSystemHeap);
+
+	void* prevSystemHeap = InterlockedCompareExchangePointer(&systemHeap, newSystemHeap, nullptr);
+	if (!prevSystemHeap)
+		return newSystemHeap;
+
+	HeapDestroy(newSystemHeap);
+	return prevSystemHeap;
+}
+
+void Heap::onAllocate(const uintptr size)
+{
+	allocationCount.increment();
+	const uint64 newAllocatedSize = allocatedSize.add(size);
+
+	uint64 currentHighWaterMark = highWaterMark.value;
+	while (newAllocatedSize > currentHighWaterMark)
+	{
+		if (highWaterMark.compareExchange(currentHighWaterMark, newAllocatedSize))
+			break;
+		currentHighWaterMark = highWaterMark.value;
+	}
+
+	// Report only first budget overflow to keep output readable under load.
+	if (budgetSize && newAllocatedSize > budgetSize && budgetExceededReported.compareExchange(0, 1))
+	{
+		FmtPrintDbgOut("XEngine::Memory: heap '", nameCStr ? nameCStr : "<unnamed>", "' exceeded budget (",
+			newAllocatedSize, " of ", budgetSize, " bytes)\n");
+	}
+}
+
+void Heap::onRelease(const uintptr size)
+{
+	allocationCount.decrement();
+	allocatedSize.sub(size);
+}
+
+void* Heap::allocate(const uintptr size, uint32 alignment)
+{
+	if (!size)
+		return nullptr;
+
+	alignment = max<uint32>(alignment, DefaultAlignment);
+	XAssert((alignment & (alignment - 1)) == 0);
+	XAssert(alignment <= MaxAlignment);
+
+	const uintptr systemAllocationSize = size + sizeof(AllocationHeader) + (alignment - DefaultAlignment);
+	byte* base = (byte*)HeapAlloc(getOrCreateSystemHeap(), 0, systemAllocationSize);
+	if (!base)
+		return nullptr;
+
+	byte* ptr = (byte*)alignUp<uintptr>(uintptr(base) + sizeof(AllocationHeader), alignment);
+
+	AllocationHeader& header = *GetAllocationHeader(ptr);
+	header.heap = this;
+	header.size = size;
+	header.baseOffset = uintptr(ptr - base);
+
+	onAllocate(size);
+	return ptr;
+}
+
+void* Heap::reallocate(void* ptr, const uintptr newSize, const uint32 newAlignment)
+{
+	if (!ptr)
+		return allocate(newSize, newAlignment);
+	if (!newSize)
+	{
+		release(ptr);
+		return nullptr;
+	}
+
+	AllocationHeader& header = *GetAllocationHeader(ptr);
+	Heap& ownerHeap = *header.heap;
+	const uintptr oldSize = header.size;
+
+	// Default aligned allocations can be grown by system heap directly. Memory stays in owner heap.
+	if (header.baseOffset == sizeof(AllocationHeader) && newAlignment <= DefaultAlignment)
+	{
+		byte* newBase = (byte*)HeapReAlloc(GetSystemHeap(ownerHeap), 0, GetAllocationBase(ptr), newSize + sizeof(AllocationHeader));
+		if (!newBase)
+			return nullptr;
+
+		AllocationHeader& newHeader = *(AllocationHeader*)newBase;
+		newHeader.size = newSize;
+
+		ownerHeap.onRelease(oldSize);
+		ownerHeap.onAllocate(newSize);
+		return newBase + sizeof(AllocationHeader);
+	}
+
+	void* newPtr = allocate(newSize, newAlignment);
+	if (!newPtr)
+		return nullptr;
+
+	memoryCopy(newPtr, ptr, min<uintptr>(oldSize, newSize));
+	release(ptr);
+	return newPtr;
+}
+
+void Heap::release(void* ptr)
+{
+	if (!ptr)
+		return;
+
+	// Memory can be released while other heap is current. It is always accounted to owner heap.
+	AllocationHeader& header = *GetAllocationHeader(ptr);
+	Heap& ownerHeap = *header.heap;
+	ownerHeap.onRelease(header.size);
+	HeapFree(GetSystemHeap(ownerHeap), 0, GetAllocationBase(ptr));
+}
+
+
+// Manager /////////////////////////////////////////////////////////////////////////////////////////
+
+void Manager::Initialize()
+{
+	XAssert(registeredHeapCount == 0);
+	RegisterHeap(defaultHeap, 0, "Default");
+
+	DefaultAllocator::Override<Manager>();
+}
+
+void Manager::RegisterHeap(Heap& heap, const uint32 sizeMib, const char* nameCStr)
+{
+	// Registration is expected to happen during startup, so it is not synchronized.
+	XAssert(registeredHeapCount < MaxHeapCount);
+	XAssert(!heap.nameCStr);
+
+	heap.nameCStr = nameCStr;
+	heap.budgetSize = uint64(sizeMib) << 20;
+
+	// Every heap has its own system heap, so subsystems do not contend on process heap lock.
+	heap.getOrCreateSystemHeap();
+
+	registeredHeaps[registeredHeapCount] = &heap;
+	registeredHeapCount++;
+}
+
+Heap& Manager::GetDefaultHeap() { return defaultHeap; }
+uint32 Manager::GetRegisteredHeapCount() { return registeredHeapCount; }
+
+Heap& Manager::GetRegisteredHeap(const uint32 index)
+{
+	XAssert(index < registeredHeapCount);
+	return *registeredHeaps[index];
+}
+
+Heap* Manager::GetCurrentThreadHeap() { return currentThreadHeap; }
+void Manager::SetCurrentThreadHeap(Heap* heap) { currentThreadHeap = heap; }
+
+void Manager::BlockCurrentThreadHeaps() { currentThreadHeapsBlockDepth++; }
+
+void Manager::UnblockCurrentThreadHeaps()
+{
+	XAssert(currentThreadHeapsBlockDepth > 0);
+	currentThreadHeapsBlockDepth--;
+}
+
+void Manager::PrintHeapStats()
+{
+	FmtPrintStdOut("heap                             allocated (KiB)  high-water (KiB)  budget (KiB)  allocations\n");
+	for (uint32 i = 0; i < registeredHeapCount; i++)
+	{
+		const Heap& heap = *registeredHeaps[i];
+		FmtPrintStdOut(heap.getName(), "\t",
+			heap.getAllocatedSize() >> 10, "\t", heap.getHighWaterMark() >> 10, "\t", heap.getBudgetSize() >> 10, "\t",
+			heap.getAllocationCount(), heap.isOverBudget() ? "\tOVER BUDGET\n" : "\n");
+	}
+}
+
+void* Manager::Allocate(const uintptr size, const uint32 alignment)
+{
+	XAssert(currentThreadHeapsBlockDepth == 0);
+	Heap& heap = currentThreadHeap ? *currentThreadHeap : defaultHeap;
+	return heap.allocate(size, alignment);
+}
+
+void Manager::Release(void* ptr)
+{
+	if (ptr)
+		GetAllocationHeader(ptr)->heap->release(ptr);
+}
+
+void* Manager::Reallocate(void* ptr, const uintptr newSize, const uint32 newAlignment)
+{
+	XAssert(currentThreadHeapsBlockDepth == 0);
+	Heap& heap = currentThreadHeap ? *currentThreadHeap : defaultHeap;
+	return heap.reallocate(ptr, newSize, newAlignment);
+}
+
+bool Manager::TryReallocateInplace(void* ptr, const uintptr newSize)
+{
+	XAssert(ptr);
+	XAssert(newSize);
+
+	AllocationHeader& header = *GetAllocationHeader(ptr);
+	const uintptr oldSize = header.size;
+	if (!HeapReAlloc(GetSystemHeap(*header.heap), HEAP_REALLOC_IN_PLACE_ONLY, GetAllocationBase(ptr), header.baseOffset + newSize))
+		return false;
+
+	header.size = newSize;
+	header.heap->onRelease(oldSize);
+	header.heap->onAllocate(newSize);
+	return true;
+}
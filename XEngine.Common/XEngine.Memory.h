@@ -1,35 +1,113 @@
 #pragma once
 
 #include <XLib.h>
+#include <XLib.NonCopyable.h>
+#include <XLib.System.Threading.Atomics.h>
+
+// Every allocation made through `XLib::DefaultAllocator` (default allocator of all XLib containers and
+// dynamic strings) is accounted to current thread heap (or to default heap if none is set).
+// Switching heaps is just a thread-local pointer write and heap selection does not take locks.
+// Each heap is backed by its own system heap (created on registration or first use), so the only lock
+// taken is the one inside that system heap, and it is not shared with other heaps or with the process heap.
 
 namespace XEngine::Memory
 {
 	enum class HeapToken : uint32 { Zero = 0, };
 
-	class Heap
+	class Heap : public XLib::NonCopyable
 	{
+		friend class Manager;
+
+	private:
+		const char* nameCStr = nullptr;
+		void* systemHeap = nullptr;
+		uint64 budgetSize = 0;
+
+		XLib::AtomicU64 allocatedSize = 0;
+		XLib::AtomicU64 highWaterMark = 0;
+		XLib::AtomicU64 allocationCount = 0;
+		XLib::AtomicU32 budgetExceededReported = 0;
+
+	private:
+		void* getOrCreateSystemHeap();
+		void onAllocate(uintptr size);
+		void onRelease(uintptr size);
 
+	public:
+		Heap() = default;
+		~Heap() = default;
+
+		void* allocate(uintptr size, uint32 alignment = 0);
+		void* reallocate(void* ptr, uintptr newSize, uint32 newAlignment = 0);
+		void release(void* ptr);
+
+		inline void resetHighWaterMark() { highWaterMark.store(allocatedSize.load()); }
+
+		inline const char* getName() const { return nameCStr; }
+		inline void* getSystemHeap() const { return systemHeap; } // Null until heap is registered or used.
+		inline uint64 getBudgetSize() const { return budgetSize; }
+		inline uint64 getAllocatedSize() const { return allocatedSize.value; }
+		inline uint64 getHighWaterMark() const { return highWaterMark.value; }
+		inline uint64 getAllocationCount() const { return allocationCount.value; }
+		inline bool isOverBudget() const { return budgetSize && highWaterMark.value > budgetSize; }
 	};
 
-	class Manager
+	class Manager abstract final
 	{
 	public:
+		static constexpr uint32 MaxHeapCount = 64;
+
+	public:
+		// Routes `XLib::DefaultAllocator` through heaps. Memory allocated before that (static initialization)
+		// stays in `DefaultAllocator` bootstrap arena and is not accounted to any heap.
 		static void Initialize();
+
+		// `sizeMib == 0` means no budget.
 		static void RegisterHeap(Heap& heap, uint32 sizeMib, const char* nameCStr);
-		static void GetCurrentThreadHeap();
-		static void SetCurrentThreadHeap();
+
+		static Heap& GetDefaultHeap();
+		static uint32 GetRegisteredHeapCount();
+		static Heap& GetRegisteredHeap(uint32 index);
+
+		// Returns null if thread uses default heap.
+		static Heap* GetCurrentThreadHeap();
+		static void SetCurrentThreadHeap(Heap* heap);
+
+		static void BlockCurrentThreadHeaps();
+		static void UnblockCurrentThreadHeaps();
+
+		// Prints allocated size, high-water mark and budget for every registered heap.
+		static void PrintHeapStats();
+
+		static void* Allocate(uintptr size, uint32 alignment = 0);
+		static void Release(void* ptr);
+		static void* Reallocate(void* ptr, uintptr newSize, uint32 newAlignment = 0);
+		static bool TryReallocateInplace(void* ptr, uintptr newSize);
 	};
 
-	class ScopedHeapSetter
+	class ScopedHeapSetter : public XLib::NonCopyable
 	{
 	private:
+		Heap* prevHeap = nullptr;
 
 	public:
-		inline ScopedHeapSetter(const Heap& heap) {}
-		inline ~ScopedHeapSetter() {}
+		inline ScopedHeapSetter(Heap* heap) : prevHeap(Manager::GetCurrentThreadHeap()) { Manager::SetCurrentThreadHeap(heap); }
+		inline ScopedHeapSetter(Heap& heap) : ScopedHeapSetter(&heap) {}
+		inline ~ScopedHeapSetter() { Manager::SetCurrentThreadHeap(prevHeap); }
+	};
+
+	// Any allocation on current thread while in scope fails assertion.
+	class ScopedHeapBlocker : public XLib::NonCopyable
+	{
+	public:
+		inline ScopedHeapBlocker() { Manager::BlockCurrentThreadHeaps(); }
+		inline ~ScopedHeapBlocker() { Manager::UnblockCurrentThreadHeaps(); }
 	};
 }
 
-#define XEMemScopeSetHeap(heap)
-#define XEMemScopeResetHeap
-#define XEMemScopeBlockHeaps
+#define XEMemScopeConcatHelper(a, b) a##b
+#define XEMemScopeConcat(a, b) XEMemScopeConcatHelper(a, b)
+
+#define XEMemScopeSetHeap(heap) XEngine::Memory::ScopedHeapSetter XEMemScopeConcat(xeMemScopedHeapSetter, __LINE__)(heap)
+#define XEMemScopeResetHeap XEngine::Memory::ScopedHeapSetter XEMemScopeConcat(xeMemScopedHeapSetter, __LINE__)(nullptr)
+#define XEMemScopeBlockHeaps XEngine::Memory::ScopedHeapBlocker XEMemScopeConcat(xeMemScopedHeapBlocker, __LINE__)
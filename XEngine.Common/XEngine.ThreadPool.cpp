@@ -1,71 +1,456 @@
+#include <intrin.h>
+
 #include "XEngine.ThreadPool.h"
 
 #include <XLib.System.Threading.h>
+#include <XLib.System.Threading.Atomics.h>
+#include <XLib.System.Threading.Event.h>
+#include <XLib.System.Threading.Lock.h>
+#include <XLib.System.Timer.h>
 
 using namespace XEngine;
 using namespace XLib;
 
-#if 0
-
 namespace
 {
-	static constexpr uint32 MaxThreadCount = 64;
+	using Task = ThreadPool::Task;
+
+	constexpr uint32 WorkerDequeCapacity = 4096;
+	constexpr sint64 WorkerDequeIndexMask = WorkerDequeCapacity - 1;
+	constexpr uint32 WorkerSpinCountBeforePark = 64;
+	constexpr uint32 InvalidWorkerIndex = uint32(-1);
+
+	// Chase-Lev deque of fixed capacity. `push` and `pop` are owner only. `steal` can be called
+	// from any thread. Top and bottom live on separate cache lines.
+	struct WorkerDeque
+	{
+		__declspec(align(64)) AtomicS64 top;
+		__declspec(align(64)) AtomicS64 bottom;
+		__declspec(align(64)) Task* volatile slots[WorkerDequeCapacity];
+
+		inline bool push(Task* task);
+		inline Task* pop();
+		inline Task* steal();
+	};
+
+	inline bool WorkerDeque::push(Task* task)
+	{
+		const sint64 b = bottom.value;
+		const sint64 t = top.value;
+		if (b - t >= sint64(WorkerDequeCapacity))
+			return false;
+
+		slots[b & WorkerDequeIndexMask] = task;
+		bottom.storeRelease(b + 1);
+		return true;
+	}
+
+	inline Task* WorkerDeque::pop()
+	{
+		const sint64 b = bottom.value - 1;
+		bottom.exchange(b); // Full barrier: bottom store should be visible before top load.
+		sint64 t = top.value;
+
+		if (t > b)
+		{
+			bottom.store(b + 1);
+			return nullptr;
+		}
+
+		Task* task = slots[b & WorkerDequeIndexMask];
+		if (t == b)
+		{
+			// Last element. Race against stealers.
+			if (!top.compareExchange(t, t + 1))
+				task = nullptr;
+			bottom.store(b + 1);
+		}
+		return task;
+	}
 
-	struct ThreadRecord
+	inline Task* WorkerDeque::steal()
 	{
-		XLib::Thread thread;
+		const sint64 t = top.loadAcquire();
+		const sint64 b = bottom.loadAcquire();
+		if (t >= b)
+			return nullptr;
+
+		Task* task = slots[t & WorkerDequeIndexMask];
+		if (!top.compareExchange(t, t + 1))
+			return nullptr;
+		return task;
+	}
+
+	struct WorkerRecord
+	{
+		WorkerDeque deque;
+		Event parkEvent;
+		Thread thread;
 	};
 
-	bool intitialized = false;
-	ThreadRecord threads[MaxThreadCount];
+	struct OccupantRecord
+	{
+		Thread thread;
+		ThreadPool::OccupantRoutine routine;
+		void* routineArg;
+		const char* name;
+		volatile bool isRunning;
+	};
+
+	WorkerRecord workers[ThreadPool::MaxThreadCount];
+	OccupantRecord occupants[ThreadPool::MaxOccupantCount];
+
+	bool initialized = false;
+	AtomicU32 shuttingDown = 0;
+
+	Lock controlLock; // Guards thread count and occupants.
+	uint32 requestedThreadCount = 0;
+	uint32 runningOccupantCount = 0;
+	AtomicU32 createdWorkerCount = 0;
+	AtomicU32 activeWorkerCount = 0;
+	volatile uint64 parkedWorkersMask = 0;
+
+	Lock injectionQueueLock;
+	Task* injectionQueueHead = nullptr;
+	Task* injectionQueueTail = nullptr;
+	AtomicU32 injectionQueueLength = 0;
+
+	thread_local uint32 currentWorkerIndex = InvalidWorkerIndex;
+	thread_local uint64 stealRandomState = 0;
+
+	inline uint32 GetStealRandom()
+	{
+		// Seeded with thread-local variable address, so every thread gets different sequence.
+		uint64 x = stealRandomState ? stealRandomState : (uint64(uintptr(&stealRandomState)) | 1);
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		stealRandomState = x;
+		return uint32(x >> 32);
+	}
+}
+
+uint32 __stdcall ThreadPool::WorkerThreadEntry(void* workerIndexAsPtr)
+{
+	WorkerThreadMain(uint32(uintptr(workerIndexAsPtr)));
+	return 0;
+}
+
+uint32 __stdcall ThreadPool::OccupantThreadEntry(void* occupantRecord)
+{
+	OccupantRecord& occupant = *(OccupantRecord*)occupantRecord;
+	occupant.routine(occupant.routineArg);
+
+	ScopedLock lock(controlLock);
+	occupant.isRunning = false;
+	runningOccupantCount--;
+	UpdateActiveWorkerCount();
+	return 0;
 }
 
 void ThreadPool::WorkerThreadMain(const uint32 threadIndex)
 {
+	currentWorkerIndex = threadIndex;
+
+	WorkerRecord& self = workers[threadIndex];
+	const uint64 selfParkedBit = uint64(1) << threadIndex;
+
+	while (!shuttingDown.load())
+	{
+		if (threadIndex >= activeWorkerCount.load())
+		{
+			// Retired by `SetThreadCount`. Drain own deque so nothing gets stuck in it, then wait
+			// until reactivated.
+			while (Task* task = self.deque.pop())
+				task->routine(*task);
+
+			self.parkEvent.wait();
+			continue;
+		}
+
+		Task* task = TryGetTask(threadIndex);
+		for (uint32 i = 0; !task && i < WorkerSpinCountBeforePark; i++)
+		{
+			_mm_pause();
+			task = TryGetTask(threadIndex);
+		}
+
+		if (task)
+		{
+			task->routine(*task);
+			continue;
+		}
+
+		// Publish parked state and check queues once more. Otherwise wake for task queued between
+		// last check and `Or` can be lost.
+		Atomics::Or(parkedWorkersMask, selfParkedBit);
+
+		task = TryGetTask(threadIndex);
+		if (task)
+		{
+			Atomics::And(parkedWorkersMask, ~selfParkedBit);
+			task->routine(*task);
+			continue;
+		}
+
+		self.parkEvent.wait();
+		Atomics::And(parkedWorkersMask, ~selfParkedBit);
+	}
+}
+
+auto ThreadPool::TryGetTask(const uint32 selfWorkerIndex) -> Task*
+{
+	if (selfWorkerIndex != InvalidWorkerIndex)
+	{
+		if (Task* task = workers[selfWorkerIndex].deque.pop())
+			return task;
+	}
+
+	if (injectionQueueLength.load())
+	{
+		ScopedLock lock(injectionQueueLock);
+
+		if (Task* task = injectionQueueHead)
+		{
+			injectionQueueHead = task->next;
+			if (!injectionQueueHead)
+				injectionQueueTail = nullptr;
+			injectionQueueLength.decrement();
+			return task;
+		}
+	}
+
+	const uint32 workerCount = createdWorkerCount.load();
+	if (!workerCount)
+		return nullptr;
+
+	const uint32 firstVictimIndex = GetStealRandom() % workerCount;
+	for (uint32 i = 0; i < workerCount; i++)
+	{
+		uint32 victimIndex = firstVictimIndex + i;
+		if (victimIndex >= workerCount)
+			victimIndex -= workerCount;
+		if (victimIndex == selfWorkerIndex)
+			continue;
+
+		if (Task* task = workers[victimIndex].deque.steal())
+			return task;
+	}
+
+	return nullptr;
+}
+
+void ThreadPool::WakeWorker()
+{
+	// Task publication should be visible before parked mask is read (pairs with `Or` in worker).
+	Atomics::FenceFull();
+
 	for (;;)
 	{
-		Task* task = ;//queue.dequeue(task);
-		task->routine(*task);
+		const uint64 mask = parkedWorkersMask;
+		if (!mask)
+			return;
+
+		const uint32 workerIndex = countTrailingZeros64(mask);
+		const uint64 newMask = mask & ~(uint64(1) << workerIndex);
+		if (Atomics::CompareExchange(parkedWorkersMask, mask, newMask))
+		{
+			workers[workerIndex].parkEvent.set();
+			return;
+		}
+	}
+}
+
+void ThreadPool::UpdateActiveWorkerCount()
+{
+	// Should be called under `controlLock`.
+
+	const uint32 workerCount =
+		requestedThreadCount > runningOccupantCount ? requestedThreadCount - runningOccupantCount : 1;
+	XAssert(workerCount <= MaxThreadCount);
+
+	while (createdWorkerCount.load() < workerCount)
+	{
+		const uint32 workerIndex = createdWorkerCount.load();
+		WorkerRecord& worker = workers[workerIndex];
+		worker.deque.top.store(0);
+		worker.deque.bottom.store(0);
+		worker.parkEvent.initialize(false, false);
+		worker.thread.create<void>(&WorkerThreadEntry, (void*)uintptr(workerIndex));
+
+		createdWorkerCount.increment();
 	}
+
+	activeWorkerCount.store(workerCount);
+
+	// Let retired workers go to sleep and reactivated ones pick up work.
+	const uint32 createdCount = createdWorkerCount.load();
+	for (uint32 i = 0; i < createdCount; i++)
+		workers[i].parkEvent.set();
 }
 
 void ThreadPool::QueueTaskInternal(Task& task, TaskRoutine<Task> routine)
 {
-	// ASSERT(initialized);
+	XAssert(initialized);
+	XAssert(routine);
+
+	task.routine = routine;
+	task.next = nullptr;
 
-	//tasksQueue.enqueue(task);
+	const uint32 workerIndex = currentWorkerIndex;
+	const bool pushedToLocalDeque =
+		workerIndex != InvalidWorkerIndex && workers[workerIndex].deque.push(&task);
+
+	if (!pushedToLocalDeque)
+	{
+		ScopedLock lock(injectionQueueLock);
+
+		if (injectionQueueTail)
+			injectionQueueTail->next = &task;
+		else
+			injectionQueueHead = &task;
+		injectionQueueTail = &task;
+		injectionQueueLength.increment();
+	}
+
+	WakeWorker();
 }
 
-void ThreadPool::Run(uint32 initialThreadCount, ThreadOccupantRoutine mainRoutine, void* mainRoutineArg)
+void ThreadPool::Run(const uint32 initialThreadCount, OccupantRoutine mainRoutine, void* mainRoutineArg)
 {
-	// ASSERT(!intitialized); // This should be done thread safe using CAS
-	// ASSERT(threadCount > maxThreadCount);
+	XAssert(!initialized);
+	XAssert(initialThreadCount > 0 && initialThreadCount <= MaxThreadCount);
+	XAssert(mainRoutine);
+
+	initialized = true;
+	shuttingDown.store(0);
 
-	//tasksQueue.initialize();
+	{
+		ScopedLock lock(controlLock);
+		requestedThreadCount = initialThreadCount;
+		runningOccupantCount = 1; // Main routine occupies calling thread.
+		UpdateActiveWorkerCount();
+	}
 
+	mainRoutine(mainRoutineArg);
 
+	// Shutdown. Tasks that are still pending are dropped. Occupants are expected to check
+	// `IsShuttingDown` and return.
+	shuttingDown.store(1);
 
-	if (userManagedThreadCount < totalThreadCount)
+	for (OccupantRecord& occupant : occupants)
 	{
-		const uint32 internalThreadCount = totalThreadCount - userManagedThreadCount;
-		for (uint32 i = 0; i < internalThreadCount; i++)
+		if (occupant.thread.isInitialized())
 		{
-			internalThreads[i].create(InternalThreadMain, i);
+			occupant.thread.wait();
+			occupant.thread.destroy();
 		}
 	}
-	else
+
+	const uint32 workerCount = createdWorkerCount.load();
+	for (uint32 i = 0; i < workerCount; i++)
+		workers[i].parkEvent.set();
+	for (uint32 i = 0; i < workerCount; i++)
 	{
-		// TODO: Warning
+		workers[i].thread.wait();
+		workers[i].thread.destroy();
+		workers[i].parkEvent.destroy();
 	}
 
-	intitialized = true;
+	createdWorkerCount.store(0);
+	activeWorkerCount.store(0);
+	parkedWorkersMask = 0;
+	requestedThreadCount = 0;
+	runningOccupantCount = 0;
+	injectionQueueHead = nullptr;
+	injectionQueueTail = nullptr;
+	injectionQueueLength.store(0);
+
+	initialized = false;
 }
 
-void ThreadPool::Shutdown()
+void ThreadPool::SetThreadCount(const uint32 threadCount)
 {
-	// TODO: Wait for all threads and destroy them
+	XAssert(initialized);
+	XAssert(threadCount > 0 && threadCount <= MaxThreadCount);
 
-	intitialized = false;
+	ScopedLock lock(controlLock);
+	requestedThreadCount = threadCount;
+	UpdateActiveWorkerCount();
 }
 
-#endif
\ No newline at end of file
+uint32 ThreadPool::GetThreadCount() { return requestedThreadCount; }
+bool ThreadPool::IsShuttingDown() { return shuttingDown.load() != 0; }
+
+void ThreadPool::OccupyThread(OccupantRoutine routine, void* routineArg, const char* occupantName)
+{
+	XAssert(initialized);
+	XAssert(routine);
+
+	ScopedLock lock(controlLock);
+
+	OccupantRecord* occupant = nullptr;
+	for (OccupantRecord& i : occupants)
+	{
+		if (!i.isRunning)
+		{
+			occupant = &i;
+			break;
+		}
+	}
+	XAssert(occupant); // Too many occupants.
+
+	// Slot could be used by occupant that already returned.
+	if (occupant->thread.isInitialized())
+	{
+		occupant->thread.wait();
+		occupant->thread.destroy();
+	}
+
+	occupant->routine = routine;
+	occupant->routineArg = routineArg;
+	occupant->name = occupantName;
+	occupant->isRunning = true;
+
+	runningOccupantCount++;
+	UpdateActiveWorkerCount();
+
+	occupant->thread.create<void>(&OccupantThreadEntry, occupant);
+}
+
+bool ThreadPool::TryRunPendingTask()
+{
+	Task* task = TryGetTask(currentWorkerIndex);
+	if (!task)
+		return false;
+
+	task->routine(*task);
+	return true;
+}
+
+void ThreadPool::OccupantWaitForConditionBusyLoop()
+{
+	if (!TryRunPendingTask())
+		_mm_pause();
+}
+
+void ThreadPool::OccupantWaitForConditionExternalWake(ExternalWakeToken& externalWakeToken)
+{
+	externalWakeToken.event.wait();
+}
+
+void ThreadPool::OccupantSleepPrecise(const uint32 microseconds)
+{
+	// OS sleep is only about millisecond precise (and much worse with default timer resolution),
+	// so couple of last milliseconds are spent spinning.
+	static constexpr uint32 spinMicroseconds = 2000;
+
+	const TimerRecord startRecord = Timer::GetRecord();
+	const float32 duration = float32(microseconds) * 1.0e-6f;
+
+	if (microseconds > spinMicroseconds)
+		Thread::Sleep((microseconds - spinMicroseconds) / 1000);
+
+	while (Timer::GetTimeDelta(startRecord) < duration)
+		_mm_pause();
+}
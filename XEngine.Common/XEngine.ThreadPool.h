@@ -1,6 +1,15 @@
 #pragma once
 
 #include <XLib.h>
+#include <XLib.NonCopyable.h>
+#include <XLib.System.Threading.Event.h>
+
+// Work-stealing pool. Every worker owns Chase-Lev deque: owner pushes/pops at the bottom, idle
+// workers steal from the top of random victims. Tasks queued from non-worker threads go to shared
+// injection queue. Workers with nothing to do park on their events.
+//
+// Occupants are long-lived routines (main loop, IO dispatch, etc.) that get dedicated thread.
+// Each occupant takes the place of one worker, so total number of running threads stays the same.
 
 namespace XEngine
 {
@@ -9,9 +18,18 @@ namespace XEngine
 	public:
 		using OccupantRoutine = void(*)(void*);
 
-		class ExternalWakeToken
+		class ExternalWakeToken : public XLib::NonCopyable
 		{
-			void signal();
+			friend ThreadPool;
+
+		private:
+			XLib::Event event;
+
+		public:
+			inline ExternalWakeToken() : event(false, false) {}
+			~ExternalWakeToken() = default;
+
+			inline void signal() { event.set(); }
 		};
 
 		template <typename ConcreteTask>
@@ -23,25 +41,47 @@ namespace XEngine
 
 		private:
 			TaskRoutine<Task> routine = nullptr;
+			Task* next = nullptr; // Injection queue link.
 
 		public:
 			Task() = default;
 			~Task() = default;
 		};
 
+	public:
+		static constexpr uint32 MaxThreadCount = 64;
+		static constexpr uint32 MaxOccupantCount = 16;
+
 	private:
+		static uint32 __stdcall WorkerThreadEntry(void* workerIndexAsPtr);
+		static uint32 __stdcall OccupantThreadEntry(void* occupantRecord);
 		static void WorkerThreadMain(uint32 threadIndex);
 		static void QueueTaskInternal(Task& task, TaskRoutine<Task> routine);
 
+		static Task* TryGetTask(uint32 selfWorkerIndex);
+		static void WakeWorker();
+		static void UpdateActiveWorkerCount();
+
 	public:
+		// Runs `mainRoutine` as occupant on calling thread. Pool is shut down when it returns.
 		static void Run(uint32 initialThreadCount, OccupantRoutine mainRoutine, void* mainRoutineArg);
 
+		// Total number of threads (workers and occupants). Can be changed at any time.
 		static void SetThreadCount(uint32 threadCount);
+		static uint32 GetThreadCount();
+		static bool IsShuttingDown();
 
 		static void OccupyThread(OccupantRoutine routine, void* routineArg, const char* occupantName);
+
+		// Runs one pending task on calling thread. Returns false if there was nothing to run.
+		// Used by wait points to help instead of blocking.
+		static bool TryRunPendingTask();
+
+		// Single iteration of occupant busy wait. Runs one pending task if there is any.
 		static void OccupantWaitForConditionBusyLoop();
 		static void OccupantWaitForConditionExternalWake(ExternalWakeToken& externalWakeToken);
-		static void OccupantSleepPrecise();
+		// Sleeps most of the interval and spins the rest.
+		static void OccupantSleepPrecise(uint32 microseconds);
 
 		template <typename ConcreteTask>
 		static inline void QueueTask(ConcreteTask& task, TaskRoutine<ConcreteTask> routine)
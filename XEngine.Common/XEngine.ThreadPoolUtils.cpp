@@ -1,3 +1,5 @@
+#include <intrin.h>
+
 #include "XEngine.ThreadPoolUtils.h"
 
 #include "XEngine.ThreadPool.h"
@@ -7,49 +9,167 @@ using namespace XEngine;
 
 static constexpr uintptr asyncMemoryCopyBytesPerTaskRun = 0x40000;
 
+// TaskCounter /////////////////////////////////////////////////////////////////////////////////////
+
+void TaskCounter::wait()
+{
+	while (!isDone())
+	{
+		if (!ThreadPool::TryRunPendingTask())
+			_mm_pause();
+	}
+}
+
+
+// ParallelFor /////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// Pieces are never smaller than half of grain, so there are less than `2 * range / grain` pieces.
+	// Grain is raised if needed to keep task storage on caller stack.
+	constexpr uint32 ParallelForMaxTaskCount = 256;
+
+	struct ParallelForState;
+
+	struct ParallelForTask : public ThreadPool::Task
+	{
+		ParallelForState* state;
+		uint32 begin;
+		uint32 end;
+	};
+
+	struct ParallelForState
+	{
+		ParallelForRoutine routine;
+		void* context;
+		uint32 grainSize;
+		AtomicU32 allocatedTaskCount;
+		TaskCounter pendingRangeCounter;
+		ParallelForTask tasks[ParallelForMaxTaskCount];
+	};
+
+	void ParallelForRunRange(ParallelForState& state, uint32 begin, uint32 end);
+
+	void ParallelForTaskRoutine(ParallelForTask& task)
+	{
+		ParallelForRunRange(*task.state, task.begin, task.end);
+	}
+
+	void ParallelForRunRange(ParallelForState& state, const uint32 begin, uint32 end)
+	{
+		// Keep left half, give right half away. Stealers take oldest (biggest) halves first.
+		while (end - begin > state.grainSize)
+		{
+			const uint32 middle = begin + (end - begin) / 2;
+
+			const uint32 taskIndex = state.allocatedTaskCount.increment() - 1;
+			XAssert(taskIndex < ParallelForMaxTaskCount);
+
+			ParallelForTask& task = state.tasks[taskIndex];
+			task.state = &state;
+			task.begin = middle;
+			task.end = end;
+
+			state.pendingRangeCounter.add();
+			ThreadPool::QueueTask(task, &ParallelForTaskRoutine);
+
+			end = middle;
+		}
+
+		state.routine(state.context, begin, end);
+		state.pendingRangeCounter.decrement();
+	}
+}
+
+void XEngine::ParallelFor(const uint32 begin, const uint32 end, const uint32 grainSize,
+	ParallelForRoutine routine, void* context)
+{
+	XAssert(begin <= end);
+	XAssert(routine);
+
+	const uint32 rangeSize = end - begin;
+	if (!rangeSize)
+		return;
+
+	const uint32 minGrainSize = uint32((uint64(rangeSize) + ParallelForMaxTaskCount / 2 - 1) / (ParallelForMaxTaskCount / 2));
+
+	ParallelForState state;
+	state.routine = routine;
+	state.context = context;
+	state.grainSize = max<uint32>(max<uint32>(grainSize, minGrainSize), 1);
+	state.allocatedTaskCount.store(0);
+	state.pendingRangeCounter.initialize(1);
+
+	ParallelForRunRange(state, begin, end);
+
+	// Tasks reference `state` on this stack frame, so all of them should be finished before return.
+	state.pendingRangeCounter.wait();
+}
+
+
+// AsyncMemoryCopy /////////////////////////////////////////////////////////////////////////////////
+
 void XEngine::AsyncMemoryCopy(void* destination, const void* source, uintptr size,
 	AsyncMemoryCopyCompletionCallback completionCallback, AsyncMemoryCopyContext& context)
 {
+	XAssert(destination);
+	XAssert(source);
+	XAssert(size);
+	XAssert(completionCallback);
+	XAssert(!context.completionCallback); // Context is busy.
+
 	context.destination = destination;
 	context.source = source;
 	context.size = size;
+	context.pieceCount = (size + asyncMemoryCopyBytesPerTaskRun - 1) / asyncMemoryCopyBytesPerTaskRun;
+	context.nextPieceIndex.store(0);
 	context.completionCallback = completionCallback;
 
-	ThreadPool::QueueTask(context.task, &AsyncMemoryCopyContext::TaskRoutine);
+	// Copy tasks pull pieces until there is none left. No point to have more of them than threads.
+	const uint32 copyTaskCount = uint32(min<uintptr>(context.pieceCount,
+		clamp<uintptr>(ThreadPool::GetThreadCount(), 1, AsyncMemoryCopyContext::MaxCopyTaskCount)));
+
+	context.completionTask.context = &context;
+	context.copyTaskCounter.initialize(copyTaskCount);
+	context.copyTaskCounter.setContinuation(context.completionTask, &AsyncMemoryCopyContext::CompletionTaskRoutine);
+
+	for (uint32 i = 0; i < copyTaskCount; i++)
+	{
+		context.copyTasks[i].context = &context;
+		ThreadPool::QueueTask(context.copyTasks[i], &AsyncMemoryCopyContext::CopyTaskRoutine);
+	}
 }
 
-void AsyncMemoryCopyContext::TaskRoutine(AsyncMemoryCopyContext::Task& task)
+void AsyncMemoryCopyContext::CopyTaskRoutine(AsyncMemoryCopyContext::Task& task)
 {
-	AsyncMemoryCopyContext& context =
-		*(AsyncMemoryCopyContext*)(uintptr(&task) - offsetOf(AsyncMemoryCopyContext, task));
+	AsyncMemoryCopyContext& context = *task.context;
 
-	// ASSERT(context.destination);
-	// ASSERT(context.source);
-	// ASSERT(context.size);
-	// ASSERT(context.completionCallback);
+	for (;;)
+	{
+		const uint64 pieceIndex = context.nextPieceIndex.increment() - 1;
+		if (pieceIndex >= context.pieceCount)
+			break;
 
-	const bool isFinalPiece = context.size <= asyncMemoryCopyBytesPerTaskRun;
-	const uintptr pieceSize = isFinalPiece ? context.size : asyncMemoryCopyBytesPerTaskRun;
+		const uintptr pieceOffset = uintptr(pieceIndex) * asyncMemoryCopyBytesPerTaskRun;
+		const uintptr pieceSize = min<uintptr>(context.size - pieceOffset, asyncMemoryCopyBytesPerTaskRun);
 
-	memoryCopy(context.destination, context.source, pieceSize);
+		memoryCopy((byte*)context.destination + pieceOffset, (const byte*)context.source + pieceOffset, pieceSize);
+	}
 
-	if (isFinalPiece)
-	{
-		const AsyncMemoryCopyCompletionCallback localCompletionCallback = context.completionCallback;
+	context.copyTaskCounter.decrement();
+}
 
-		context.destination = nullptr;
-		context.source = nullptr;
-		context.size = 0;
-		context.completionCallback = nullptr;
+void AsyncMemoryCopyContext::CompletionTaskRoutine(AsyncMemoryCopyContext::Task& task)
+{
+	AsyncMemoryCopyContext& context = *task.context;
 
-		localCompletionCallback(context);
-	}
-	else
-	{
-		(uintptr&)context.destination += pieceSize;
-		(uintptr&)context.source += pieceSize;
-		context.size -= pieceSize;
+	const AsyncMemoryCopyCompletionCallback localCompletionCallback = context.completionCallback;
 
-		ThreadPool::QueueTask(context.task, &AsyncMemoryCopyContext::TaskRoutine);
-	}
+	context.destination = nullptr;
+	context.source = nullptr;
+	context.size = 0;
+	context.pieceCount = 0;
+	context.completionCallback = nullptr;
+
+	localCompletionCallback(context);
 }
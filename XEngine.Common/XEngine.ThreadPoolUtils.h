@@ -2,6 +2,7 @@
 
 #include <XLib.h>
 #include <XLib.NonCopyable.h>
+#include <XLib.System.Threading.Atomics.h>
 
 #include "XEngine.ThreadPool.h"
 
@@ -9,28 +10,89 @@ namespace XEngine { class AsyncMemoryCopyContext; }
 
 namespace XEngine
 {
+	// TaskCounter /////////////////////////////////////////////////////////////////////////////////
+
+	// Dependency counter. When it reaches zero, continuation task (if set) is queued.
+	class TaskCounter : public XLib::NonCopyable
+	{
+	private:
+		XLib::AtomicU32 counter = 0;
+		ThreadPool::Task* continuationTask = nullptr;
+		ThreadPool::TaskRoutine<ThreadPool::Task> continuationRoutine = nullptr;
+
+	public:
+		TaskCounter() = default;
+		inline ~TaskCounter() { XAssert(counter.value == 0); }
+
+		inline void initialize(uint32 count) { XAssert(counter.value == 0); counter.store(count); }
+
+		// Should be set before counter can reach zero.
+		template <typename ConcreteTask>
+		inline void setContinuation(ConcreteTask& task, ThreadPool::TaskRoutine<ConcreteTask> routine);
+
+		inline void add(uint32 count = 1) { counter.add(count); }
+		inline void decrement();
+
+		inline bool isDone() const { return counter.value == 0; }
+
+		// Runs pending pool tasks on calling thread until counter reaches zero.
+		void wait();
+	};
+
+
+	// ParallelFor /////////////////////////////////////////////////////////////////////////////////
+
+	using ParallelForRoutine = void(*)(void* context, uint32 begin, uint32 end);
+
+	// Splits [begin, end) in halves until pieces are not bigger than `grainSize` and runs pieces on
+	// pool. Calling thread takes part in execution and returns when whole range is processed.
+	void ParallelFor(uint32 begin, uint32 end, uint32 grainSize, ParallelForRoutine routine, void* context);
+
+	template <typename Functor>
+	inline void ParallelFor(uint32 begin, uint32 end, uint32 grainSize, const Functor& functor)
+	{
+		ParallelFor(begin, end, grainSize,
+			[](void* context, uint32 pieceBegin, uint32 pieceEnd) -> void { (*(const Functor*)context)(pieceBegin, pieceEnd); },
+			(void*)&functor);
+	}
+
+
+	// AsyncMemoryCopy /////////////////////////////////////////////////////////////////////////////
+
 	using AsyncMemoryCopyCompletionCallback = void(*)(AsyncMemoryCopyContext&);
 
 	void AsyncMemoryCopy(void* destination, const void* source, uintptr size,
 		AsyncMemoryCopyCompletionCallback completionCallback, AsyncMemoryCopyContext& context);
 
-	class AsyncMemoryCopyContext
+	class AsyncMemoryCopyContext : public XLib::NonCopyable
 	{
 		friend void XEngine::AsyncMemoryCopy(void* destination, const void* source, uintptr size,
 			AsyncMemoryCopyCompletionCallback completionCallback, AsyncMemoryCopyContext& context);
 
+	public:
+		static constexpr uint32 MaxCopyTaskCount = 16;
+
 	private:
-		struct Task : public ThreadPool::Task {};
+		struct Task : public ThreadPool::Task
+		{
+			AsyncMemoryCopyContext* context;
+		};
 
 	private:
-		Task task;
+		Task copyTasks[MaxCopyTaskCount];
+		Task completionTask;
+		TaskCounter copyTaskCounter;
+
 		void* destination = nullptr;
 		const void* source = nullptr;
 		uintptr size = 0;
+		uintptr pieceCount = 0;
+		XLib::AtomicU64 nextPieceIndex = 0;
 		AsyncMemoryCopyCompletionCallback completionCallback = nullptr;
 
 	private:
-		static void TaskRoutine(Task& task);
+		static void CopyTaskRoutine(Task& task);
+		static void CompletionTaskRoutine(Task& task);
 
 	public:
 		AsyncMemoryCopyContext() = default;
@@ -40,3 +102,29 @@ namespace XEngine
 
 // AsyncMemoryCopy is guaranteed to be asynchronous. All "small synchronous copy" optimizations should
 // be done on user side. Callback is guaranteed to be called on ThreadPool.
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+
+namespace XEngine
+{
+	template <typename ConcreteTask>
+	inline void TaskCounter::setContinuation(ConcreteTask& task, ThreadPool::TaskRoutine<ConcreteTask> routine)
+	{
+		continuationTask = &task;
+		continuationRoutine = ThreadPool::TaskRoutine<ThreadPool::Task>(routine);
+	}
+
+	inline void TaskCounter::decrement()
+	{
+		XAssert(counter.value > 0);
+
+		// Counter owner can destroy it as soon as it reaches zero, so nothing should be read after.
+		ThreadPool::Task* task = continuationTask;
+		const ThreadPool::TaskRoutine<ThreadPool::Task> routine = continuationRoutine;
+
+		if (counter.decrement() == 0 && task)
+			ThreadPool::QueueTask(*task, routine);
+	}
+}
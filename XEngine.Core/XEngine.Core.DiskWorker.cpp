@@ -1,259 +1,694 @@
-#if 0
+#include <Windows.h>
 
-#include <XLib.System.File.h>
+#include <XLib.System.VirtualMemory.h>
 
 #include "XEngine.Core.DiskWorker.h"
 
 using namespace XLib;
 using namespace XEngine::Core;
 
-static constexpr uint32 minReadChunkSize = 256;
+static_assert(sizeof(OVERLAPPED) <= 32, "invalid overlapped size");
 
 enum class DiskOperationContext::Type : uint8
 {
 	None = 0,
 	OpenPersistentFile,
-	ReadPersistenFile,
+	ReadPersistentFile,
 	ReadFile,
 };
 
-DiskWorker::~DiskWorker()
+enum class DiskOperationContext::State : uint8
 {
+	Idle = 0,
+	Queued,
+	InFlight,
+	Completed, // Final callback was issued. Worker does not touch the context anymore.
+};
+
+namespace
+{
+	// Reads are cut to fit free ring space, but not below this size.
+	constexpr uint32 minReadChunkSize = 0x10000;
+	constexpr uint32 bufferBlockAlignment = 64;
+	constexpr uint32 maxCompletionEntriesPerWait = 16;
+	constexpr ULONG_PTR wakeCompletionKey = 1;
+
+	bool OpenFileForOverlappedRead(const char* filename, HANDLE hIOCP, void*& outHandle, uint64& outSize)
+	{
+		const HANDLE hFile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size = {};
+		if (!GetFileSizeEx(hFile, &size) || !CreateIoCompletionPort(hFile, hIOCP, 0, 0))
+		{
+			CloseHandle(hFile);
+			return false;
+		}
 
+		outHandle = hFile;
+		outSize = uint64(size.QuadPart);
+		return true;
+	}
 }
 
-void DiskWorker::startup(uint32 diskBufferSizeLog2)
+// Operations queue ////////////////////////////////////////////////////////////////////////////////
+
+inline bool DiskWorker::IsQueuedBefore(const DiskOperationContext* a, const DiskOperationContext* b)
 {
-	XASSERT(diskBufferSizeLog2 > 30, "invalid disk buffer size");
-	XASSERT(!dispatchThread.isInitialized(), "already running");
+	return a->priority > b->priority || (a->priority == b->priority && a->queueOrder < b->queueOrder);
+}
 
-	operationsWaitEvent.initialize(false, false);
-	dispatchThread.create(&DispatchThreadMain, this);
+void DiskWorker::operationsQueueSiftUp(uint32 index)
+{
+	DiskOperationContext* context = operationsQueue[index];
+	while (index > 0)
+	{
+		const uint32 parentIndex = (index - 1) / 2;
+		DiskOperationContext* parent = operationsQueue[parentIndex];
+		if (!IsQueuedBefore(context, parent))
+			break;
+
+		operationsQueue[index] = parent;
+		parent->queueHeapIndex = index;
+		index = parentIndex;
+	}
 
-	this->diskBufferSizeLog2 = diskBufferSizeLog2;
+	operationsQueue[index] = context;
+	context->queueHeapIndex = index;
+}
 
-	// Estimation. For 16 Mib disk buffer queue size will be 64.
-	const uint16 diskBufferBlocksTrackingQueueCapacityLog2 = max<uint16>(diskBufferSizeLog2 - 18, 32);
-	const uint16 diskBufferBlocksTrackingQueueCapacity = (1 << diskBufferBlocksTrackingQueueCapacityLog2);
+void DiskWorker::operationsQueueSiftDown(uint32 index)
+{
+	const uint32 size = operationsQueue.getSize();
+	DiskOperationContext* context = operationsQueue[index];
+	for (;;)
+	{
+		uint32 childIndex = index * 2 + 1;
+		if (childIndex >= size)
+			break;
+		if (childIndex + 1 < size && IsQueuedBefore(operationsQueue[childIndex + 1], operationsQueue[childIndex]))
+			childIndex++;
+
+		DiskOperationContext* child = operationsQueue[childIndex];
+		if (!IsQueuedBefore(child, context))
+			break;
+
+		operationsQueue[index] = child;
+		child->queueHeapIndex = index;
+		index = childIndex;
+	}
 
-	const uint32 diskBufferSize = (1 << diskBufferSizeLog2);
-	const uint32 diskBufferBlocksTrackingQueueStorageSize =
-		diskBufferBlocksTrackingQueueCapacity * sizeof(DiskBufferBlocksTrackingQueue::ElementType);
+	operationsQueue[index] = context;
+	context->queueHeapIndex = index;
+}
 
-	const uint32 heapBufferSize = diskBufferSize + diskBufferBlocksTrackingQueueStorageSize;
-	heapBuffer.resize(heapBufferSize);
+void DiskWorker::operationsQueueRemove(const uint32 index)
+{
+	XAssert(index < operationsQueue.getSize());
 
-	diskBufferBlocksTrackingQueue.initialize(
-		to<uint32*>(heapBuffer + diskBufferSize), diskBufferBlocksTrackingQueueCapacity);
+	operationsQueue[index]->queueHeapIndex = uint32(-1);
 
-	diskBufferUsedDataBackIndex = 0;
+	DiskOperationContext* last = operationsQueue.popBack();
+	if (index < operationsQueue.getSize())
+	{
+		operationsQueue[index] = last;
+		operationsQueueSiftUp(index);
+		operationsQueueSiftDown(last->queueHeapIndex);
+	}
 }
 
-void DiskWorker::shutdown()
+bool DiskWorker::pushToOperationsQueue(DiskOperationContext& context, const bool keepQueueOrder)
+{
+	ScopedLock lock(operationsQueueLock);
+
+	if (context.cancellationRequested)
+		return false;
+
+	if (!keepQueueOrder)
+		context.queueOrder = operationsQueueOrderCounter++;
+	context.state = DiskOperationContext::State::Queued;
+
+	operationsQueue.pushBack(&context);
+	operationsQueueSiftUp(operationsQueue.getSize() - 1);
+	return true;
+}
+
+void DiskWorker::queueOperation(DiskOperationContext& context)
 {
+	XAssert(isRunning());
+
+	context.cancellationRequested = false;
+	pushToOperationsQueue(context, false);
+	wakeDispatchThread();
+}
 
+void DiskWorker::wakeDispatchThread()
+{
+	// Single wake packet is enough. Dispatch thread clears the flag before looking at the queue.
+	if (dispatchThreadWakePending.exchange(1) == 0)
+		PostQueuedCompletionStatus(HANDLE(hIOCP), 0, wakeCompletionKey, nullptr);
 }
 
-DiskOperationHandle DiskWorker::readFileAsync(const char* filename,
-	uint64 filePosition, uint32 expectedReadSize, DiskReadHandler handler, void* context)
+
+// Ring buffer /////////////////////////////////////////////////////////////////////////////////////
+
+bool DiskWorker::reclaimReleasedBufferBlocks()
 {
-	if (!filename)
-		return 0;
-	if (!expectedReadSize)
-		return 0;
-	if (!handler.isInitialized())
-		return 0;
-
-	Operation* operation = nullptr;
+	const uint32 initialFrontSequenceIndex = bufferBlocksFrontSequenceIndex;
+	while (bufferBlocksFrontSequenceIndex != bufferBlocksBackSequenceIndex &&
+		bufferBlocks[bufferBlocksFrontSequenceIndex % MaxBufferBlockCount].released.value)
 	{
-		ScopedLock lock(operationsAllocatorLock);
-		operation = operationsAllocator.allocate();
+		bufferBlocksFrontSequenceIndex++;
 	}
+	return bufferBlocksFrontSequenceIndex != initialFrontSequenceIndex;
+}
 
-	// TODO: implement proper handling (wait cycle)
-	XASSERT(operation, "operations allocator overflow");
+bool DiskWorker::allocateBufferBlock(const uint32 minSize, const uint32 maxSize, uint32& outSequenceIndex)
+{
+	XAssert(minSize && minSize <= maxSize);
+
+	if (bufferBlocksBackSequenceIndex - bufferBlocksFrontSequenceIndex == MaxBufferBlockCount)
+		return false;
 
-	operation->handler = handler.toRaw();
-	operation->handlerContext = context;
-	operation->filename = filename;
-	operation->filePosition = filePosition;
-	operation->expectedReadSize = expectedReadSize;
-	operation->type = OperationType::ReadFile;
+	uint32 offset = 0;
+	uint32 availableSize = 0;
 
+	if (bufferBlocksFrontSequenceIndex == bufferBlocksBackSequenceIndex)
 	{
-		ScopedLock lock(operationsQueueLock);
-		operationsQueue.pushBack(operation);
+		// Everything is released. Start from the beginning to get biggest contiguous space.
+		offset = 0;
+		availableSize = diskBufferSize;
+	}
+	else
+	{
+		const uint32 usedDataFrontOffset = bufferBlocks[bufferBlocksFrontSequenceIndex % MaxBufferBlockCount].offset;
+		if (diskBufferUsedDataBackOffset > usedDataFrontOffset)
+		{
+			// Used data does not cross buffer end. Take the tail if it is big enough, wrap otherwise.
+			const uint32 tailSize = diskBufferSize - diskBufferUsedDataBackOffset;
+			offset = tailSize >= minSize ? diskBufferUsedDataBackOffset : 0;
+			availableSize = tailSize >= minSize ? tailSize : usedDataFrontOffset;
+		}
+		else
+		{
+			// Equal offsets here mean buffer is full.
+			offset = diskBufferUsedDataBackOffset;
+			availableSize = usedDataFrontOffset - diskBufferUsedDataBackOffset;
+		}
 	}
 
-	operationsWaitEvent.set();
+	if (availableSize < minSize)
+		return false;
 
-	return 0;
+	const uint32 size = min(availableSize, maxSize);
+
+	BufferBlock& block = bufferBlocks[bufferBlocksBackSequenceIndex % MaxBufferBlockCount];
+	block.offset = offset;
+	block.size = size;
+	block.released.store(0);
+
+	outSequenceIndex = bufferBlocksBackSequenceIndex;
+	bufferBlocksBackSequenceIndex++;
+	diskBufferUsedDataBackOffset = min(alignUp(offset + size, bufferBlockAlignment), diskBufferSize);
+
+	return true;
 }
 
-uint32 __stdcall DiskWorker::DispatchThreadMain(DiskWorker* self)
+void DiskWorker::releaseBuffer(DiskWorkerBufferHandle handle)
 {
-	self->dispatchThreadMain();
-	return 0;
+	XAssert(handle.isValid());
+
+	BufferBlock& block = bufferBlocks[handle.bufferBlockSequenceIndex % MaxBufferBlockCount];
+
+	// Full barrier between release and flag check. Dispatch thread does the opposite.
+	const uint32 wasReleased = block.released.exchange(1);
+	XAssert(!wasReleased);
+
+	if (dispatchThreadWaitsForBuffer.value && dispatchThreadWaitsForBuffer.exchange(0))
+		wakeDispatchThread();
+}
+
+
+// Dispatch ////////////////////////////////////////////////////////////////////////////////////////
+
+void DiskWorker::closeOperationFile(DiskOperationContext& context)
+{
+	if (context.type == DiskOperationContext::Type::ReadFile && context.fileHandle)
+	{
+		CloseHandle(HANDLE(context.fileHandle));
+		context.fileHandle = nullptr;
+	}
 }
 
-inline void DiskWorker::dispatchOperation_readFile(Operation& operation)
+bool DiskWorker::tryCompleteOperation(DiskOperationContext& context)
 {
-	DiskReadHandler handler(operation.handler);
+	ScopedLock lock(operationsQueueLock);
 
-	File file;
-	if (!file.open(operation.filename, FileAccessMode::Read, FileOpenMode::OpenExisting))
+	if (context.cancellationRequested)
+		return false;
+
+	context.state = DiskOperationContext::State::Completed;
+	return true;
+}
+
+void DiskWorker::failOperation(DiskOperationContext& context, DiskOperationResult result)
+{
+	XAssert(result != DiskOperationResult::Success);
+
+	closeOperationFile(context);
 	{
-		handler.call(DiskAccessResult::FileNotFound,
-			DiskWorkerBufferReleaseToken(), nullptr, 0, false, operation.handlerContext);
-		return;
+		ScopedLock lock(operationsQueueLock);
+
+		// Cancellation requested while operation was in flight promises `Cancelled` result.
+		if (context.cancellationRequested)
+			result = DiskOperationResult::Cancelled;
+		context.state = DiskOperationContext::State::Completed;
 	}
 
-	const uint64 fileSize = file.getSize();
-	const uint32 diskBufferSize = 1 << diskBufferSizeLog2;
+	if (context.type == DiskOperationContext::Type::OpenPersistentFile)
+		context.persistentFileOpenedCallback(context, result, 0);
+	else
+		context.readFinishedCallback(context, result, DiskWorkerBufferHandle(), nullptr, 0, false);
+}
 
-	uint32 expectedReadSize = operation.expectedReadSize;
-	uint64 nextFilePosition = operation.filePosition;
-	uint64 currentFilePosition = 0;
+bool DiskWorker::trySubmitNextOperation()
+{
+	DiskOperationContext* context = nullptr;
+	{
+		ScopedLock lock(operationsQueueLock);
 
-	for (;;)
+		if (operationsQueue.isEmpty())
+			return false;
+
+		context = operationsQueue[0];
+		operationsQueueRemove(0);
+		context->state = DiskOperationContext::State::InFlight;
+	}
+
+	if (shutdownRequested)
 	{
-		if (nextFilePosition != uint64(-1))
-		{
-			if (nextFilePosition >= fileSize)
-			{
-				handler.call(DiskAccessResult::InvalidFilePosition,
-					DiskWorkerBufferReleaseToken(), nullptr, 0, false, operation.handlerContext);
-				return;
-			}
+		failOperation(*context, DiskOperationResult::Cancelled);
+		return true;
+	}
+
+	if (context->type == DiskOperationContext::Type::OpenPersistentFile)
+	{
+		dispatchOperation_openPersistentFile(*context);
+		return true;
+	}
 
-			if (currentFilePosition != nextFilePosition)
+	if (dispatchOperation_read(*context))
+		return true;
+
+	// Ring buffer is full. Whoever releases a block next will wake us.
+	dispatchThreadWaitsForBuffer.exchange(1);
+	return reclaimReleasedBufferBlocks();
+}
+
+void DiskWorker::dispatchOperation_openPersistentFile(DiskOperationContext& context)
+{
+	void* fileHandle = nullptr;
+	uint64 fileSize = 0;
+	if (!OpenFileForOverlappedRead(context.filename, HANDLE(hIOCP), fileHandle, fileSize))
+	{
+		failOperation(context, DiskOperationResult::FileNotFound);
+		return;
+	}
+
+	DiskPersistentFileHandle handle = 0;
+	{
+		ScopedLock lock(persistentFilesLock);
+
+		for (uint32 i = 0; i < MaxPersistentFileCount; i++)
+		{
+			if (!persistentFiles[i].handle)
 			{
-				currentFilePosition = nextFilePosition;
-				file.setPosition(currentFilePosition);
+				persistentFiles[i].handle = fileHandle;
+				persistentFiles[i].size = fileSize;
+				handle = i + 1;
+				break;
 			}
 		}
+	}
 
-		// Skip all released blocks.
-		while (!diskBufferBlocksTrackingQueue.isEmpty() &&
-			(diskBufferBlocksTrackingQueue.front() & 0x8000'0000) == 0)
-		{
-			diskBufferBlocksTrackingQueue.dropFront();
-		}
+	XAssert(handle); // Too many persistent files.
+	if (!handle)
+	{
+		CloseHandle(HANDLE(fileHandle));
+		failOperation(context, DiskOperationResult::FileNotFound);
+		return;
+	}
+
+	// Cancellation could be requested while file was being opened.
+	if (!tryCompleteOperation(context))
+	{
+		closePersistentFile(handle);
+		failOperation(context, DiskOperationResult::Cancelled);
+		return;
+	}
 
-		uint32 currentBufferBlockStartIndex = 0;
-		uint32 currentBufferBlockSizeLimit = 0;
+	context.persistentFileOpenedCallback(context, DiskOperationResult::Success, handle);
+}
 
-		if (diskBufferBlocksTrackingQueue.isEmpty())
+bool DiskWorker::dispatchOperation_read(DiskOperationContext& context)
+{
+	if (!context.fileHandle)
+	{
+		XAssert(context.type == DiskOperationContext::Type::ReadFile);
+		if (!OpenFileForOverlappedRead(context.filename, HANDLE(hIOCP), context.fileHandle, context.fileSize))
 		{
-			// Use half of the buffer and reset cyclic index.
-			currentBufferBlockStartIndex = 0;
-			currentBufferBlockSizeLimit = diskBufferSize / 2;
+			failOperation(context, DiskOperationResult::FileNotFound);
+			return true;
 		}
-		else
-		{
-			const uint32 diskBufferUsedDataFrontIndex = diskBufferBlocksTrackingQueue.front() & 0x7FFF'FFFF;
+	}
 
-			if (diskBufferUsedDataFrontIndex < diskBufferUsedDataBackIndex)
-			{
-				// Used data does not cross buffer bounds. We can use space to the end of the buffer.
-				currentBufferBlockStartIndex = diskBufferUsedDataBackIndex;
-				currentBufferBlockSizeLimit = diskBufferSize - diskBufferUsedDataBackIndex;
-			}
-			else
-			{
-				const uint32 freeSpaceSize = diskBufferUsedDataFrontIndex - diskBufferUsedDataBackIndex;
-
-				if (freeSpaceSize < minReadChunkSize)
-				{
-					// Wait for new blocks to release.
-
-					continue;
-				}
-				else
-				{
-					currentBufferBlockStartIndex = diskBufferUsedDataBackIndex;
-					currentBufferBlockSizeLimit = freeSpaceSize;
-				}
-			}
+	if (!context.fileSize && !context.filePosition)
+	{
+		// Empty file has nothing to read. It is end of file right away, so no buffer is allocated.
+		closeOperationFile(context);
+		if (!tryCompleteOperation(context))
+		{
+			failOperation(context, DiskOperationResult::Cancelled);
+			return true;
 		}
+		context.readFinishedCallback(context, DiskOperationResult::Success, DiskWorkerBufferHandle(), nullptr, 0, true);
+		return true;
+	}
 
-		const uint32 expectedReadSizeFitInBuffer = min(expectedReadSize, currentBufferBlockSizeLimit);
-		const uint64 fileBytesLeft = fileSize - currentFilePosition;
-		const bool endOfFile = uint64(expectedReadSizeFitInBuffer) >= fileBytesLeft;
+	if (context.filePosition >= context.fileSize)
+	{
+		failOperation(context, DiskOperationResult::InvalidFilePosition);
+		return true;
+	}
 
-		const uint32 readSize = endOfFile ? uint32(fileBytesLeft) : expectedReadSizeFitInBuffer;
+	const uint32 readSize = uint32(min<uint64>(min(context.expectedReadSize, maxReadChunkSize),
+		context.fileSize - context.filePosition));
 
-		if (!file.read(heapBuffer + currentBufferBlockStartIndex, readSize))
-		{
-			handler.call(DiskAccessResult::FileReadError, DiskWorkerBufferReleaseToken(),
-				nullptr, 0, false, operation.handlerContext);
-			return;
-		}
+	uint32 bufferBlockSequenceIndex = 0;
+	if (!allocateBufferBlock(min(readSize, minReadChunkSize), readSize, bufferBlockSequenceIndex))
+	{
+		// Goes back to the queue keeping its place.
+		if (!pushToOperationsQueue(context, true))
+			failOperation(context, DiskOperationResult::Cancelled);
+		return false;
+	}
 
-		diskBufferBlocksTrackingQueue.pushBack(0x8000'0000 | currentBufferBlockStartIndex);
-		diskBufferUsedDataBackIndex = currentBufferBlockStartIndex + readSize;
+	const BufferBlock& block = bufferBlocks[bufferBlockSequenceIndex % MaxBufferBlockCount];
 
-		if (diskBufferUsedDataBackIndex > diskBufferSize - minReadChunkSize)
-			diskBufferUsedDataBackIndex = 0;
+	XAssert(freeReadRequestsList);
+	ReadRequest& request = *freeReadRequestsList;
+	freeReadRequestsList = request.nextFree;
+	inFlightReadCount++;
+
+	memorySet(request.overlapped, 0, sizeof(request.overlapped));
+	OVERLAPPED& overlapped = *(OVERLAPPED*)request.overlapped;
+	overlapped.Offset = DWORD(context.filePosition);
+	overlapped.OffsetHigh = DWORD(context.filePosition >> 32);
+	request.context = &context;
+	request.nextFree = nullptr;
+	request.bufferBlockSequenceIndex = bufferBlockSequenceIndex;
+
+	// Completion packet is queued even if read finishes synchronously.
+	if (!ReadFile(HANDLE(context.fileHandle), diskBuffer + block.offset, block.size, nullptr, &overlapped) &&
+		GetLastError() != ERROR_IO_PENDING)
+	{
+		request.nextFree = freeReadRequestsList;
+		freeReadRequestsList = &request;
+		inFlightReadCount--;
 
-		const DiskReadContinuationParams continuationParams =
-			handler.call(DiskAccessResult::Success, DiskWorkerBufferReleaseToken(...),
-				heapBuffer, readSize, endOfFile, operation.handlerContext);
+		bufferBlocks[bufferBlockSequenceIndex % MaxBufferBlockCount].released.store(1);
+		failOperation(context, DiskOperationResult::FileReadError);
+	}
+
+	return true;
+}
+
+void DiskWorker::onReadCompleted(ReadRequest& request, const bool success, const uint32 bytesRead)
+{
+	DiskOperationContext& context = *request.context;
+	const uint32 bufferBlockSequenceIndex = request.bufferBlockSequenceIndex;
+	BufferBlock& block = bufferBlocks[bufferBlockSequenceIndex % MaxBufferBlockCount];
+
+	request.context = nullptr;
+	request.nextFree = freeReadRequestsList;
+	freeReadRequestsList = &request;
+	inFlightReadCount--;
+
+	if (!success || !bytesRead)
+	{
+		block.released.store(1);
+		failOperation(context, DiskOperationResult::FileReadError);
+		return;
+	}
+
+	context.filePosition += bytesRead;
+	const bool endOfFile = context.filePosition >= context.fileSize;
+
+	// Last chunk completes the operation before callback, so cancellation racing with it is rejected.
+	if (endOfFile)
+		closeOperationFile(context);
+	if (endOfFile ? !tryCompleteOperation(context) : context.cancellationRequested)
+	{
+		block.released.store(1);
+		failOperation(context, DiskOperationResult::Cancelled);
+		return;
+	}
 
-		if (endOfFile)
-			return;
-		if (!continuationParams.expectedReadSize)
-			return;
+	const DiskReadContinuationParams continuationParams =
+		context.readFinishedCallback(context, DiskOperationResult::Success,
+			DiskWorkerBufferHandle(bufferBlockSequenceIndex), diskBuffer + block.offset, bytesRead, endOfFile);
 
-		currentFilePosition += readSize;
+	if (endOfFile)
+		return;
 
-		nextFilePosition = continuationParams.filePosition;
-		expectedReadSize = continuationParams.expectedReadSize;
+	if (!continuationParams.expectedReadSize)
+	{
+		closeOperationFile(context);
+		if (!tryCompleteOperation(context))
+			failOperation(context, DiskOperationResult::Cancelled);
+		return;
 	}
+
+	if (continuationParams.filePosition != uint64(-1))
+		context.filePosition = continuationParams.filePosition;
+	context.expectedReadSize = continuationParams.expectedReadSize;
+
+	if (!pushToOperationsQueue(context, false))
+		failOperation(context, DiskOperationResult::Cancelled);
 }
 
 void DiskWorker::dispatchThreadMain()
 {
 	for (;;)
 	{
-		operationsWaitEvent.wait();
+		reclaimReleasedBufferBlocks();
+		while (inFlightReadCount < MaxInFlightReadCount && trySubmitNextOperation()) {}
 
-		for (;;)
-		{
-			operationsWaitEvent.reset();
+		if (shutdownRequested && inFlightReadCount == 0)
+			break;
+
+		OVERLAPPED_ENTRY entries[maxCompletionEntriesPerWait];
+		ULONG entryCount = 0;
+		if (!GetQueuedCompletionStatusEx(HANDLE(hIOCP), entries, countOf(entries), &entryCount, INFINITE, FALSE))
+			continue;
 
-			Operation* operation = nullptr;
+		for (ULONG i = 0; i < entryCount; i++)
+		{
+			const OVERLAPPED_ENTRY& entry = entries[i];
+			if (!entry.lpOverlapped)
 			{
-				ScopedLock lock(operationsQueueLock);
-				if (operationsQueue.isEmpty())
-					break;
-				operation = operationsQueue.popFront();
+				XAssert(entry.lpCompletionKey == wakeCompletionKey);
+				dispatchThreadWakePending.store(0);
+				continue;
 			}
 
-			switch (operation->type)
-			{
-			case OperationType::OpenPersistentFile:
-				//dispatchOperation_openPersistentFile(*operation);
-				break;
+			// `Internal` holds NTSTATUS of the read.
+			ReadRequest& request = *(ReadRequest*)entry.lpOverlapped;
+			onReadCompleted(request, entry.lpOverlapped->Internal == 0, entry.dwNumberOfBytesTransferred);
+		}
+	}
+}
 
-			case OperationType::ReadPersistenFile:
-				//dispatchOperation_readPersistenFile(*operation);
-				break;
+uint32 __stdcall DiskWorker::DispatchThreadMain(DiskWorker* self)
+{
+	self->dispatchThreadMain();
+	return 0;
+}
 
-			case OperationType::ReadFile:
-				dispatchOperation_readFile(*operation);
-				break;
 
-			default:
-				// TODO: UNREACHABLE_CODE
-				break;
-			}
+// Public API //////////////////////////////////////////////////////////////////////////////////////
 
-			{
-				ScopedLock lock(operationsAllocatorLock);
-				operationsAllocator.release(operation);
-			}
+void DiskWorker::startup(const uint32 diskBufferSizeLog2)
+{
+	XAssert(diskBufferSizeLog2 >= 16 && diskBufferSizeLog2 <= 30); // Invalid disk buffer size.
+	XAssert(!isRunning());
+
+	diskBufferSize = uint32(1) << diskBufferSizeLog2;
+	diskBuffer = (byte*)VirtualMemory::Allocate(diskBufferSize);
+	maxReadChunkSize = diskBufferSize / 4;
+	diskBufferUsedDataBackOffset = 0;
+
+	bufferBlocksFrontSequenceIndex = 0;
+	bufferBlocksBackSequenceIndex = 0;
+
+	freeReadRequestsList = nullptr;
+	for (uint32 i = 0; i < MaxInFlightReadCount; i++)
+	{
+		readRequests[i].nextFree = freeReadRequestsList;
+		freeReadRequestsList = &readRequests[i];
+	}
+	inFlightReadCount = 0;
+
+	memorySet(persistentFiles, 0, sizeof(persistentFiles));
+
+	shutdownRequested = false;
+	dispatchThreadWakePending.store(0);
+	dispatchThreadWaitsForBuffer.store(0);
+
+	hIOCP = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+	XAssert(hIOCP);
+
+	dispatchThread.create(&DispatchThreadMain, this);
+}
+
+void DiskWorker::shutdown()
+{
+	if (!isRunning())
+		return;
+
+	shutdownRequested = true;
+	PostQueuedCompletionStatus(HANDLE(hIOCP), 0, wakeCompletionKey, nullptr);
+
+	dispatchThread.wait();
+	dispatchThread.destroy();
+
+	for (PersistentFile& persistentFile : persistentFiles)
+	{
+		if (persistentFile.handle)
+			CloseHandle(HANDLE(persistentFile.handle));
+	}
+	memorySet(persistentFiles, 0, sizeof(persistentFiles));
+
+	CloseHandle(HANDLE(hIOCP));
+	hIOCP = nullptr;
+
+	VirtualMemory::Release(diskBuffer, diskBufferSize);
+	diskBuffer = nullptr;
+	diskBufferSize = 0;
+}
+
+void DiskWorker::openPersistentFile(const char* filename, const float32 priority,
+	DiskPersistentFileOpenedCallback callback, DiskOperationContext& context)
+{
+	XAssert(filename && callback);
+	XAssert(context.state == DiskOperationContext::State::Idle || context.state == DiskOperationContext::State::Completed);
+
+	context.persistentFileOpenedCallback = callback;
+	context.filename = filename;
+	context.priority = priority;
+	context.type = DiskOperationContext::Type::OpenPersistentFile;
+
+	queueOperation(context);
+}
+
+void DiskWorker::closePersistentFile(const DiskPersistentFileHandle handle)
+{
+	XAssert(handle && handle <= MaxPersistentFileCount);
+
+	ScopedLock lock(persistentFilesLock);
+
+	PersistentFile& persistentFile = persistentFiles[handle - 1];
+	XAssert(persistentFile.handle);
+	CloseHandle(HANDLE(persistentFile.handle));
+	persistentFile.handle = nullptr;
+	persistentFile.size = 0;
+}
+
+void DiskWorker::readFile(const DiskPersistentFileHandle handle, const uint64 filePosition,
+	const uint32 expectedReadSize, const float32 priority, DiskReadFinishedCallback callback,
+	DiskOperationContext& context)
+{
+	XAssert(handle && handle <= MaxPersistentFileCount);
+	XAssert(expectedReadSize && callback);
+	XAssert(context.state == DiskOperationContext::State::Idle || context.state == DiskOperationContext::State::Completed);
+
+	{
+		ScopedLock lock(persistentFilesLock);
+		context.fileHandle = persistentFiles[handle - 1].handle;
+		context.fileSize = persistentFiles[handle - 1].size;
+	}
+	XAssert(context.fileHandle);
+
+	context.readFinishedCallback = callback;
+	context.filename = nullptr;
+	context.persistentFileHandle = handle;
+	context.filePosition = filePosition;
+	context.expectedReadSize = expectedReadSize;
+	context.priority = priority;
+	context.type = DiskOperationContext::Type::ReadPersistentFile;
+
+	queueOperation(context);
+}
+
+void DiskWorker::readFile(const char* filename, const uint64 filePosition,
+	const uint32 expectedReadSize, const float32 priority, DiskReadFinishedCallback callback,
+	DiskOperationContext& context)
+{
+	XAssert(filename);
+	XAssert(expectedReadSize && callback);
+	XAssert(context.state == DiskOperationContext::State::Idle || context.state == DiskOperationContext::State::Completed);
+
+	context.readFinishedCallback = callback;
+	context.filename = filename;
+	context.persistentFileHandle = 0;
+	context.fileHandle = nullptr;
+	context.fileSize = 0;
+	context.filePosition = filePosition;
+	context.expectedReadSize = expectedReadSize;
+	context.priority = priority;
+	context.type = DiskOperationContext::Type::ReadFile;
+
+	queueOperation(context);
+}
+
+void DiskWorker::setOperationPriority(DiskOperationContext& context, const float32 priority)
+{
+	ScopedLock lock(operationsQueueLock);
+
+	context.priority = priority;
+	if (context.queueHeapIndex != uint32(-1))
+	{
+		operationsQueueSiftUp(context.queueHeapIndex);
+		operationsQueueSiftDown(context.queueHeapIndex);
+	}
+}
+
+bool DiskWorker::cancelOperation(DiskOperationContext& context)
+{
+	{
+		ScopedLock lock(operationsQueueLock);
+
+		if (context.state == DiskOperationContext::State::Idle)
+			return true;
+
+		// Final callback was already issued (it may still be running).
+		if (context.state == DiskOperationContext::State::Completed)
+			return false;
+
+		if (context.queueHeapIndex == uint32(-1))
+		{
+			// Dispatch thread owns it now.
+			context.cancellationRequested = true;
+			return false;
 		}
+
+		operationsQueueRemove(context.queueHeapIndex);
+		context.state = DiskOperationContext::State::Idle;
 	}
+
+	// Continuation of file read can already have file opened.
+	closeOperationFile(context);
+	return true;
 }
-#endif
\ No newline at end of file
@@ -2,19 +2,30 @@
 
 #include <XLib.h>
 #include <XLib.NonCopyable.h>
-#include <XLib.Containers.IntrusiveDoublyLinkedList.h>
-#include <XLib.Containers.CyclicQueue.h>
+#include <XLib.Containers.ArrayList.h>
 #include <XLib.System.Threading.h>
+#include <XLib.System.Threading.Atomics.h>
 #include <XLib.System.Threading.Lock.h>
-#include <XLib.System.Threading.Event.h>
+
+// Streaming read engine. Operations are queued with priority and dispatched in priority order by
+// dedicated thread, which keeps up to `MaxInFlightReadCount` overlapped reads in flight.
+//
+// Data is read directly into internal ring buffer and handed to callback without copying.
+// Callback gets `DiskWorkerBufferHandle` for its slice, which should be passed to `releaseBuffer`
+// once data is not needed anymore (from any thread). Ring space is reclaimed in allocation order,
+// so holding a slice for a long time stalls all following reads. Reading empty file succeeds at once
+// with no data, `endOfFile` set and invalid buffer handle, which should not be released.
+//
+// All callbacks are called on dispatch thread. Read callback returns continuation params: read
+// continues from `filePosition` (or where previous chunk ended if it is `uint64(-1)`) until
+// `expectedReadSize` is zero or end of file is reached. Continuation goes through the queue again,
+// so higher priority operations can get in between chunks.
 
 namespace XEngine::Core { class DiskOperationContext; }
 namespace XEngine::Core { class DiskWorker; }
 
 namespace XEngine::Core
 {
-#if 0
-
 	using DiskPersistentFileHandle = uint32;
 
 	enum class DiskOperationResult : uint8
@@ -23,6 +34,7 @@ namespace XEngine::Core
 		FileNotFound,
 		InvalidFilePosition,
 		FileReadError,
+		Cancelled,
 	};
 
 	struct DiskReadContinuationParams
@@ -36,14 +48,16 @@ namespace XEngine::Core
 		friend DiskWorker;
 
 	private:
-		uint32 diskBufferBlocksTrackingQueueCyclicIndex = 0;
+		uint32 bufferBlockSequenceIndex = uint32(-1);
 
-		inline DiskWorkerBufferHandle(uint32 diskBufferBlocksTrackingQueueCyclicIndex)
-			: diskBufferBlocksTrackingQueueCyclicIndex(diskBufferBlocksTrackingQueueCyclicIndex) {}
+		inline DiskWorkerBufferHandle(uint32 bufferBlockSequenceIndex)
+			: bufferBlockSequenceIndex(bufferBlockSequenceIndex) {}
 
 	public:
 		DiskWorkerBufferHandle() = default;
 		~DiskWorkerBufferHandle() = default;
+
+		inline bool isValid() const { return bufferBlockSequenceIndex != uint32(-1); }
 	};
 
 	using DiskReadFinishedCallback =
@@ -55,31 +69,39 @@ namespace XEngine::Core
 	using DiskPersistentFileOpenedCallback =
 		void(*)(DiskOperationContext& context, DiskOperationResult result, DiskPersistentFileHandle handle);
 
+	// Owned by user. Should stay alive until final callback is called or operation is cancelled.
 	class DiskOperationContext : public XLib::NonCopyable
 	{
 		friend DiskWorker;
 
 	private:
 		enum class Type : uint8;
+		enum class State : uint8;
 
 	private:
-		XLib::IntrusiveDoublyLinkedListItemHook operationsQueueItemHook;
-
 		union
 		{
 			DiskReadFinishedCallback readFinishedCallback = nullptr;
 			DiskPersistentFileOpenedCallback persistentFileOpenedCallback;
 		};
 
-		union
-		{
-			const char* filename = nullptr;
-			DiskPersistentFileHandle persistentFileHandle;
-		};
+		const char* filename = nullptr;
+		DiskPersistentFileHandle persistentFileHandle = 0;
+
+		void* fileHandle = nullptr;
+		uint64 fileSize = 0;
 
 		uint64 filePosition = 0;
 		uint32 expectedReadSize = 0;
+
+		// Priority queue key. Higher priority goes first, equal priorities go in FIFO order.
+		float32 priority = 0.0f;
+		uint64 queueOrder = 0;
+		uint32 queueHeapIndex = uint32(-1);
+
 		Type type = Type(0);
+		State state = State(0);
+		bool cancellationRequested = false;
 
 	public:
 		DiskOperationContext() = default;
@@ -89,54 +111,121 @@ namespace XEngine::Core
 
 	class DiskWorker : public XLib::NonCopyable
 	{
+	public:
+		static constexpr uint32 MaxInFlightReadCount = 32;
+		static constexpr uint32 MaxBufferBlockCount = 1024;
+		static constexpr uint32 MaxPersistentFileCount = 256;
+
 	private:
-		using OperationsQueue = XLib::IntrusiveDoublyLinkedList<
-			DiskOperationContext, &DiskOperationContext::operationsQueueItemHook>;
+		static constexpr uint32 overlappedSize = sizeof(void*) == 4 ? 20 : 32;
 
-		using DiskBufferBlocksTrackingQueue =
-			XLib::CyclicQueue<uint32, XLib::CyclicQueueStoragePolicy::External, uint16>;
+		struct ReadRequest
+		{
+			byte overlapped[overlappedSize];	// must be first
+			DiskOperationContext* context;
+			ReadRequest* nextFree;
+			uint32 bufferBlockSequenceIndex;
+		};
+
+		struct BufferBlock
+		{
+			uint32 offset;
+			uint32 size;
+			XLib::AtomicU32 released;
+		};
+
+		struct PersistentFile
+		{
+			void* handle;
+			uint64 size;
+		};
+
+		using OperationsQueue = XLib::ArrayList<DiskOperationContext*>;
 
 	private:
-		OperationsQueue operationsQueue;
+		OperationsQueue operationsQueue; // Binary max-heap.
+		uint64 operationsQueueOrderCounter = 0;
 		XLib::Lock operationsQueueLock;
 
 		XLib::Thread dispatchThread;
-		XLib::Event operationsWaitEvent;
+		void* hIOCP = nullptr;
+		XLib::AtomicU32 dispatchThreadWakePending = 0;
+		XLib::AtomicU32 dispatchThreadWaitsForBuffer = 0;
+		volatile bool shutdownRequested = false;
+
+		byte* diskBuffer = nullptr;
+		uint32 diskBufferSize = 0;
+		uint32 maxReadChunkSize = 0;
+		uint32 diskBufferUsedDataBackOffset = 0;
 
-		XLib::HeapPtr<byte> heapBuffer; // disk buffer + disk buffer blocks tracking queue storage
-		uint16 diskBufferSizeLog2 = 0;
+		// Indices are not wrapped. Slot is `sequenceIndex % MaxBufferBlockCount`.
+		BufferBlock bufferBlocks[MaxBufferBlockCount];
+		uint32 bufferBlocksFrontSequenceIndex = 0;
+		uint32 bufferBlocksBackSequenceIndex = 0;
 
-		DiskBufferBlocksTrackingQueue diskBufferBlocksTrackingQueue;
-		uint32 diskBufferUsedDataBackIndex = 0;
+		ReadRequest readRequests[MaxInFlightReadCount];
+		ReadRequest* freeReadRequestsList = nullptr;
+		uint32 inFlightReadCount = 0;
+
+		PersistentFile persistentFiles[MaxPersistentFileCount];
+		XLib::Lock persistentFilesLock;
 
 	private:
-		//inline void dispatchOperation_openPersistentFile(Operation& operation);
-		//inline void dispatchOperation_readPersistenFile(Operation& operation);
-		inline void dispatchOperation_readFile(Operation& operation);
+		static inline bool IsQueuedBefore(const DiskOperationContext* a, const DiskOperationContext* b);
+
+		void operationsQueueSiftUp(uint32 index);
+		void operationsQueueSiftDown(uint32 index);
+		void operationsQueueRemove(uint32 index);
+		bool pushToOperationsQueue(DiskOperationContext& context, bool keepQueueOrder);
+
+		void queueOperation(DiskOperationContext& context);
+		void wakeDispatchThread();
+
+		bool reclaimReleasedBufferBlocks();
+		bool allocateBufferBlock(uint32 minSize, uint32 maxSize, uint32& outSequenceIndex);
+
+		void closeOperationFile(DiskOperationContext& context);
+		// Publish `Completed` state before final callback. `tryCompleteOperation` fails if cancellation was requested.
+		bool tryCompleteOperation(DiskOperationContext& context);
+		void failOperation(DiskOperationContext& context, DiskOperationResult result);
+
+		bool trySubmitNextOperation();
+		void dispatchOperation_openPersistentFile(DiskOperationContext& context);
+		bool dispatchOperation_read(DiskOperationContext& context);
+		void onReadCompleted(ReadRequest& request, bool success, uint32 bytesRead);
 
 		void dispatchThreadMain();
 		static uint32 __stdcall DispatchThreadMain(DiskWorker* self);
 
 	public:
 		DiskWorker() = default;
-		~DiskWorker();
+		inline ~DiskWorker() { shutdown(); }
 
 		void startup(uint32 diskBufferSizeLog2);
+		// Waits for in-flight reads. Queued operations get `Cancelled`.
 		void shutdown();
 
-		void openPersistentFile(const char* filename,
+		void openPersistentFile(const char* filename, float32 priority,
 			DiskPersistentFileOpenedCallback callback, DiskOperationContext& context);
+		// There should be no operations on this file queued or in flight.
 		void closePersistentFile(DiskPersistentFileHandle handle);
 
 		void readFile(DiskPersistentFileHandle handle, uint64 filePosition, uint32 expectedReadSize,
-			DiskReadFinishedCallback callback, DiskOperationContext& context);
+			float32 priority, DiskReadFinishedCallback callback, DiskOperationContext& context);
+		// `filename` should stay valid until operation is finished.
 		void readFile(const char* filename, uint64 filePosition, uint32 expectedReadSize,
-			DiskReadFinishedCallback callback, DiskOperationContext& context);
+			float32 priority, DiskReadFinishedCallback callback, DiskOperationContext& context);
 
 		void releaseBuffer(DiskWorkerBufferHandle handle);
 
-		void cancelOperation(DiskOperationContext& context);
-	};
+		// Takes effect for next chunk if operation is in flight.
+		void setOperationPriority(DiskOperationContext& context, float32 priority);
+
+		// Returns true if operation was removed from the queue (or was never started) and no callbacks will follow.
+		// Returns false if operation is in flight, so callback will be called once more with `Cancelled`,
+		// or if final callback was already issued.
+		bool cancelOperation(DiskOperationContext& context);
 
-#endif
+		inline bool isRunning() const { return hIOCP != nullptr; }
+	};
 }
@@ -1,9 +1,11 @@
+#include <XEngine.Memory.h>
 #include <XEngine.Render.Device.h>
 #include <XEngine.Render.Target.h>
 #include <XEngine.ThreadPool.h>
 
 #include "XEngine.Core.Engine.h"
 
+#include "XEngine.Core.DiskWorker.h"
 #include "XEngine.Core.Input.h"
 #include "XEngine.Core.Output.h"
 
@@ -12,11 +14,16 @@ using namespace XEngine;
 using namespace XEngine::Core;
 
 static bool running = false;
+static DiskWorker diskWorker;
 static Render::Device renderDevice;
 static Render::Output imageOutput;
 
 void Engine::Run(GameBase* game)
 {
+	Memory::Manager::Initialize();
+
+	diskWorker.startup(24);
+
 	running = true;
 
 	//XEngine::ThreadPool::Run(...);
@@ -40,6 +47,8 @@ void Engine::Run(GameBase* game)
 	}
 
 	Output::Destroy();
+
+	diskWorker.shutdown();
 }
 
 void Engine::Shutdown()
@@ -47,6 +56,7 @@ void Engine::Shutdown()
 	running = false;
 }
 
+DiskWorker& Engine::GetDiskWorker() { return diskWorker; }
 Render::Device& Engine::GetRenderDevice() { return renderDevice; }
 
 uint32 Engine::GetOutputViewCount() { return 1; }
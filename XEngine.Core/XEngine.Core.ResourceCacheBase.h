@@ -2,17 +2,36 @@
 
 #include <XLib.h>
 #include <XLib.NonCopyable.h>
-#include <XLib.PoolAllocator.h>
-#include <XLib.Containers.FlatHashMap.h>
-#include <XLib.Delegate.h>
+#include <XLib.Allocation.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.Containers.HashMap.h>
 
-// TODO: replace set with hash-set
+// Generic resource cache. Concrete cache derives from `ResourceCacheBase<Resource, ConcreteCache>`
+// and implements loading hooks (can be private if base is friend):
+//
+//	void startLoading(Resource& resource, ResourceUID uid, float32 priority, ResourceHandle loadingHandle);
+//	void setLoadingPriority(Resource& resource, ResourceHandle loadingHandle, float32 priority);
+//	void cancelLoading(Resource& resource, ResourceHandle loadingHandle);
+//	void unload(Resource& resource);
+//
+// Every `startLoading` should be answered by exactly one `onLoadingComplete` with same loading
+// handle. `cancelLoading` is only a hint: loader may still complete successfully.
+//
+// Query that misses starts loading. All queries for the same UID share single load; load priority
+// is the highest priority among its pending queries. Each successful query (immediate or deferred)
+// holds one reference. Resources without references are kept in LRU order and evicted when
+// resident size exceeds memory budget.
+//
+// Cache is not thread-safe. Loaders that complete on other threads should marshal completion to
+// the thread that owns the cache.
 
 namespace XEngine::Core
 {
 	using ResourceUID = uint64;
 
+	// Zero is invalid handle.
 	using ResourceHandle = uint32;
+	using ResourceQueryHandle = uint32;
 
 	enum class QueryResourceResultType : uint8
 	{
@@ -32,56 +51,136 @@ namespace XEngine::Core
 		QueryResourceResultType type;
 	};
 
+	// Called when pending query is resolved. `handle` holds a reference if `type` is `ResourceReady`.
+	using ResourceQueryCallback = void(*)(void* context, ResourceQueryHandle queryHandle,
+		QueryResourceResultType type, ResourceHandle handle);
+
 	template <typename Resource, typename ConcreteCache>
 	class ResourceCacheBase abstract : public XLib::NonCopyable
 	{
+	protected:
+		enum class LoadingResult : uint8
+		{
+			Success = 0,
+			Failure,
+			Cancelled,
+		};
+
 	private:
+		static constexpr uint32 HandleIndexBits = 20;
+		static constexpr uint32 HandleIndexMask = (1 << HandleIndexBits) - 1;
+		static constexpr uint32 HandleGenerationMask = (1 << (32 - HandleIndexBits)) - 1;
+		static constexpr uint32 InvalidIndex = uint32(-1);
+
+		static constexpr uint32 EntriesChunkSizeLog2 = 8;
+		static constexpr uint32 EntriesChunkSize = 1 << EntriesChunkSizeLog2;
+
+		enum class EntryState : uint8
+		{
+			Free = 0,
+			Loading,
+			Ready,
+		};
+
 		struct Entry
 		{
 			Resource resource;
+			ResourceUID uid;
+			uint64 byteSize;
 
-			uint16 referenceCount = 0;
-			uint16 handleGeneration = 0;
-		};
+			uint32 referenceCount;
+			uint32 firstQueryIndex;
+			uint32 lruPrevIndex; // Also used as free list link.
+			uint32 lruNextIndex;
 
-		using EntriesAllocator = XLib::PoolAllocator<Entry,
-			XLib::PoolAllocatorHeapUsagePolicy::MultipleStaticChunks<4, 14>>;
+			float32 loadingPriority;
+			uint16 handleGeneration;
+			EntryState state;
+			bool loadingCancellationRequested;
+		};
 
-		using UIDMap = XLib::FlatHashMap<ResourceUID, uint32 /*resource handle OR resource loading context handle*/>;
+		struct Query
+		{
+			ResourceQueryCallback callback;
+			void* callbackContext;
+			float32 priority;
+			uint32 entryIndex; // `InvalidIndex` if query slot is free or query is detached from failed entry.
+			uint32 prevIndex;
+			uint32 nextIndex; // Also used as free list link.
+			uint16 handleGeneration;
+		};
 
-	protected:
-		enum class LoadingResult;
+		using UIDMap = XLib::FlatHashMap<ResourceUID, uint32 /*entry index*/>;
 
 	private:
 		UIDMap uidMap;
-		EntriesAllocator entriesAllocator;
 
-	protected:
-		inline void concreteCache_prepareLoading(Resource& resource, ResourceUID uid);
-		inline void concreteCache_startLoading(Resource& resource, ResourceUID uid, float32 priority, void* asyncContext);
-		inline void concreteCache_setLoadingPriority(float32 priority, void* asyncContext);
-		inline void concreteCache_cancelLoading(void* asyncContext);
-		inline void concreteCache_unload(Resource& resource);
-		inline void concreteCache_cache(Resource& resource);
-		inline void concreteCache_startReloadingFromCache(Resource& resource, /*asyncContext*/);
+		// Entries are allocated in chunks so their addresses are stable (loaders write into them).
+		XLib::ArrayList<Entry*> entryChunks;
+		uint32 entryCount = 0;
+		uint32 freeEntriesListHead = InvalidIndex;
+
+		XLib::ArrayList<Query> queries;
+		uint32 freeQueriesListHead = InvalidIndex;
+
+		uint32 lruHeadIndex = InvalidIndex; // Least recently used.
+		uint32 lruTailIndex = InvalidIndex;
+
+		uint64 residentByteSize = 0;
+		uint64 memoryBudget = uint64(-1);
+
+	private:
+		static inline ResourceHandle ComposeHandle(uint32 index, uint16 generation) { return (uint32(generation) << HandleIndexBits) | index; }
+		static inline uint32 GetHandleIndex(uint32 handle) { return handle & HandleIndexMask; }
+		static inline uint16 GetHandleGeneration(uint32 handle) { return uint16(handle >> HandleIndexBits); }
+		static inline uint16 NextGeneration(uint16 generation) { generation = (generation + 1) & HandleGenerationMask; return generation ? generation : 1; }
+
+		inline ConcreteCache& concreteCache() { return *static_cast<ConcreteCache*>(this); }
+
+		inline Entry& getEntry(uint32 index) { return entryChunks[index >> EntriesChunkSizeLog2][index & (EntriesChunkSize - 1)]; }
+		inline const Entry& getEntry(uint32 index) const { return entryChunks[index >> EntriesChunkSizeLog2][index & (EntriesChunkSize - 1)]; }
+		inline Entry* resolveHandle(ResourceHandle handle);
 
-		void onLoadingComplete(LoadingResult loadingResult, void* asyncContext, Resource& resource);
+		inline uint32 allocateEntry();
+		inline void releaseEntry(uint32 index);
 
-		const Resource& get(ResourceHandle handle);
+		inline uint32 allocateQuery();
+		inline void releaseQuery(uint32 index);
+		inline void linkQuery(uint32 queryIndex, Entry& entry);
+		inline void unlinkQuery(uint32 queryIndex, Entry& entry);
+
+		inline void lruPushBack(uint32 index);
+		inline void lruRemove(uint32 index);
+		inline void evictOverBudget();
+
+		inline float32 getPendingQueriesMaxPriority(const Entry& entry) const;
+		inline void updateLoadingPriority(uint32 entryIndex);
+
+	protected:
+		// Should be called exactly once per `startLoading`. `resourceByteSize` counts towards budget.
+		void onLoadingComplete(ResourceHandle loadingHandle, LoadingResult loadingResult, uint64 resourceByteSize);
 
 	public:
-		ResourceCache() = default;
-		~ResourceCache() = default;
+		ResourceCacheBase() = default;
+		~ResourceCacheBase();
 
-		QueryResourceResult query(ResourceUID uid, float32 priority, callback);
+		QueryResourceResult query(ResourceUID uid, float32 priority, ResourceQueryCallback callback, void* callbackContext);
+		// Load is cancelled if it was the last query waiting for it.
 		void cancelQuery(ResourceQueryHandle handle);
 		void setQueryPriority(ResourceQueryHandle handle, float32 priority);
 
+		// Returns zero if resource is not loaded.
 		ResourceHandle find(ResourceUID uid, bool addReference = true);
 
 		void addReference(ResourceHandle handle);
 		void removeReference(ResourceHandle handle);
-		bool isValidHandle(ResourceHandle handle);
+		bool isValidHandle(ResourceHandle handle) const;
+
+		const Resource& get(ResourceHandle handle) const;
+
+		void setMemoryBudget(uint64 byteSize);
+		inline uint64 getMemoryBudget() const { return memoryBudget; }
+		inline uint64 getResidentByteSize() const { return residentByteSize; }
 	};
 }
 
@@ -91,8 +190,485 @@ namespace XEngine::Core
 namespace XEngine::Core
 {
 	template <typename Resource, typename ConcreteCache>
-	QueryResourceResult ResourceCacheBase<Resource, ConcreteCache>::query(ResourceUID uid, float32 priority, callback)
+	inline auto ResourceCacheBase<Resource, ConcreteCache>::resolveHandle(const ResourceHandle handle) -> Entry*
 	{
+		const uint32 index = GetHandleIndex(handle);
+		if (!handle || index >= entryCount)
+			return nullptr;
+
+		Entry& entry = getEntry(index);
+		if (entry.state == EntryState::Free || entry.handleGeneration != GetHandleGeneration(handle))
+			return nullptr;
+		return &entry;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	inline uint32 ResourceCacheBase<Resource, ConcreteCache>::allocateEntry()
+	{
+		uint32 index = freeEntriesListHead;
+		if (index != InvalidIndex)
+		{
+			freeEntriesListHead = getEntry(index).lruPrevIndex;
+		}
+		else
+		{
+			XAssert(entryCount < HandleIndexMask);
+			if ((entryCount & (EntriesChunkSize - 1)) == 0)
+				entryChunks.pushBack((Entry*)XLib::SystemHeapAllocator::Allocate(sizeof(Entry) * EntriesChunkSize));
+
+			index = entryCount;
+			entryCount++;
+
+			getEntry(index).handleGeneration = 0;
+		}
+
+		Entry& entry = getEntry(index);
+		XConstruct(entry.resource);
+		entry.uid = 0;
+		entry.byteSize = 0;
+		entry.referenceCount = 0;
+		entry.firstQueryIndex = InvalidIndex;
+		entry.lruPrevIndex = InvalidIndex;
+		entry.lruNextIndex = InvalidIndex;
+		entry.loadingPriority = 0.0f;
+		entry.handleGeneration = NextGeneration(entry.handleGeneration);
+		entry.state = EntryState::Loading;
+		entry.loadingCancellationRequested = false;
+		return index;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	inline void ResourceCacheBase<Resource, ConcreteCache>::releaseEntry(const uint32 index)
+	{
+		Entry& entry = getEntry(index);
+		XAssert(entry.state != EntryState::Free);
+		XAssert(entry.firstQueryIndex == InvalidIndex);
+
+		uidMap.remove(entry.uid);
+		XDestruct(entry.resource);
+
+		entry.state = EntryState::Free;
+		entry.lruPrevIndex = freeEntriesListHead;
+		freeEntriesListHead = index;
+	}
 
+	template <typename Resource, typename ConcreteCache>
+	inline uint32 ResourceCacheBase<Resource, ConcreteCache>::allocateQuery()
+	{
+		uint32 index = freeQueriesListHead;
+		if (index != InvalidIndex)
+		{
+			freeQueriesListHead = queries[index].nextIndex;
+		}
+		else
+		{
+			XAssert(queries.getSize() < HandleIndexMask);
+			index = queries.getSize();
+			queries.pushBack(Query {}).handleGeneration = 0;
+		}
+
+		Query& query = queries[index];
+		query.handleGeneration = NextGeneration(query.handleGeneration);
+		return index;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	inline void ResourceCacheBase<Resource, ConcreteCache>::releaseQuery(const uint32 index)
+	{
+		Query& query = queries[index];
+		query.entryIndex = InvalidIndex;
+		query.callback = nullptr;
+		query.callbackContext = nullptr;
+		query.nextIndex = freeQueriesListHead;
+		freeQueriesListHead = index;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	inline void ResourceCacheBase<Resource, ConcreteCache>::linkQuery(const uint32 queryIndex, Entry& entry)
+	{
+		Query& query = queries[queryIndex];
+		query.prevIndex = InvalidIndex;
+		query.nextIndex = entry.firstQueryIndex;
+		if (entry.firstQueryIndex != InvalidIndex)
+			queries[entry.firstQueryIndex].prevIndex = queryIndex;
+		entry.firstQueryIndex = queryIndex;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	inline void ResourceCacheBase<Resource, ConcreteCache>::unlinkQuery(const uint32 queryIndex, Entry& entry)
+	{
+		Query& query = queries[queryIndex];
+		if (query.prevIndex != InvalidIndex)
+			queries[query.prevIndex].nextIndex = query.nextIndex;
+		else
+			entry.firstQueryIndex = query.nextIndex;
+		if (query.nextIndex != InvalidIndex)
+			queries[query.nextIndex].prevIndex = query.prevIndex;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	inline void ResourceCacheBase<Resource, ConcreteCache>::lruPushBack(const uint32 index)
+	{
+		Entry& entry = getEntry(index);
+		entry.lruPrevIndex = lruTailIndex;
+		entry.lruNextIndex = InvalidIndex;
+		if (lruTailIndex != InvalidIndex)
+			getEntry(lruTailIndex).lruNextIndex = index;
+		else
+			lruHeadIndex = index;
+		lruTailIndex = index;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	inline void ResourceCacheBase<Resource, ConcreteCache>::lruRemove(const uint32 index)
+	{
+		Entry& entry = getEntry(index);
+		if (entry.lruPrevIndex != InvalidIndex)
+			getEntry(entry.lruPrevIndex).lruNextIndex = entry.lruNextIndex;
+		else
+			lruHeadIndex = entry.lruNextIndex;
+		if (entry.lruNextIndex != InvalidIndex)
+			getEntry(entry.lruNextIndex).lruPrevIndex = entry.lruPrevIndex;
+		else
+			lruTailIndex = entry.lruPrevIndex;
+
+		entry.lruPrevIndex = InvalidIndex;
+		entry.lruNextIndex = InvalidIndex;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	inline void ResourceCacheBase<Resource, ConcreteCache>::evictOverBudget()
+	{
+		// Only unreferenced resources are in LRU list. Referenced ones can keep us over budget.
+		while (residentByteSize > memoryBudget && lruHeadIndex != InvalidIndex)
+		{
+			const uint32 index = lruHeadIndex;
+			Entry& entry = getEntry(index);
+			XAssert(entry.state == EntryState::Ready && entry.referenceCount == 0);
+
+			lruRemove(index);
+			residentByteSize -= entry.byteSize;
+			concreteCache().unload(entry.resource);
+			releaseEntry(index);
+		}
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	inline float32 ResourceCacheBase<Resource, ConcreteCache>::getPendingQueriesMaxPriority(const Entry& entry) const
+	{
+		XAssert(entry.firstQueryIndex != InvalidIndex);
+
+		float32 priority = queries[entry.firstQueryIndex].priority;
+		for (uint32 i = queries[entry.firstQueryIndex].nextIndex; i != InvalidIndex; i = queries[i].nextIndex)
+			priority = max(priority, queries[i].priority);
+		return priority;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	inline void ResourceCacheBase<Resource, ConcreteCache>::updateLoadingPriority(const uint32 entryIndex)
+	{
+		Entry& entry = getEntry(entryIndex);
+		XAssert(entry.state == EntryState::Loading);
+
+		if (entry.firstQueryIndex == InvalidIndex)
+			return;
+
+		const float32 priority = getPendingQueriesMaxPriority(entry);
+		if (priority != entry.loadingPriority)
+		{
+			entry.loadingPriority = priority;
+			concreteCache().setLoadingPriority(entry.resource, ComposeHandle(entryIndex, entry.handleGeneration), priority);
+		}
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	void ResourceCacheBase<Resource, ConcreteCache>::onLoadingComplete(const ResourceHandle loadingHandle,
+		const LoadingResult loadingResult, const uint64 resourceByteSize)
+	{
+		Entry* entryPtr = resolveHandle(loadingHandle);
+		XAssert(entryPtr && entryPtr->state == EntryState::Loading);
+		Entry& entry = *entryPtr;
+		const uint32 entryIndex = GetHandleIndex(loadingHandle);
+
+		if (loadingResult != LoadingResult::Success)
+		{
+			if (loadingResult == LoadingResult::Cancelled && entry.firstQueryIndex != InvalidIndex)
+			{
+				// Cancellation raced with new query. Start over.
+				entry.loadingCancellationRequested = false;
+				entry.loadingPriority = getPendingQueriesMaxPriority(entry);
+				concreteCache().startLoading(entry.resource, entry.uid, entry.loadingPriority, loadingHandle);
+				return;
+			}
+
+			// Entry is dropped before callbacks, so failed UID can be queried again from them.
+			// Whole chain is detached first, so nothing can reach released entry through pending queries.
+			const uint32 firstQueryIndex = entry.firstQueryIndex;
+			entry.firstQueryIndex = InvalidIndex;
+			for (uint32 queryIndex = firstQueryIndex; queryIndex != InvalidIndex; queryIndex = queries[queryIndex].nextIndex)
+				queries[queryIndex].entryIndex = InvalidIndex;
+			releaseEntry(entryIndex);
+
+			for (uint32 queryIndex = firstQueryIndex; queryIndex != InvalidIndex; )
+			{
+				Query& query = queries[queryIndex];
+				const uint32 nextQueryIndex = query.nextIndex;
+				const ResourceQueryCallback callback = query.callback;
+				void* callbackContext = query.callbackContext;
+				const ResourceQueryHandle queryHandle = ComposeHandle(queryIndex, query.handleGeneration);
+
+				releaseQuery(queryIndex);
+
+				// Null callback means query was cancelled by one of previous callbacks.
+				if (callback)
+					callback(callbackContext, queryHandle, QueryResourceResultType::InvalidResource, 0);
+
+				queryIndex = nextQueryIndex;
+			}
+			return;
+		}
+
+		entry.state = EntryState::Ready;
+		entry.byteSize = resourceByteSize;
+		entry.loadingCancellationRequested = false;
+		residentByteSize += resourceByteSize;
+
+		// Temporary reference keeps entry off LRU list while callbacks run. Otherwise callback that
+		// releases its handle could evict entry that remaining queries are still linked to.
+		entry.referenceCount++;
+
+		// Callbacks can cancel other pending queries, so list head is taken every time.
+		while (entry.firstQueryIndex != InvalidIndex)
+		{
+			const uint32 queryIndex = entry.firstQueryIndex;
+			Query& query = queries[queryIndex];
+			const ResourceQueryCallback callback = query.callback;
+			void* callbackContext = query.callbackContext;
+			const ResourceQueryHandle queryHandle = ComposeHandle(queryIndex, query.handleGeneration);
+
+			unlinkQuery(queryIndex, entry);
+			releaseQuery(queryIndex);
+			entry.referenceCount++;
+
+			callback(callbackContext, queryHandle, QueryResourceResultType::ResourceReady, loadingHandle);
+		}
+
+		// Resident size grew, so other resources may have to go even if this one is still referenced.
+		removeReference(loadingHandle);
+		evictOverBudget();
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	ResourceCacheBase<Resource, ConcreteCache>::~ResourceCacheBase()
+	{
+		for (uint32 i = 0; i < entryCount; i++)
+		{
+			Entry& entry = getEntry(i);
+			XAssert(entry.state != EntryState::Loading); // Loads should be finished before destruction.
+			if (entry.state == EntryState::Ready)
+			{
+				concreteCache().unload(entry.resource);
+				XDestruct(entry.resource);
+			}
+		}
+
+		for (Entry* chunk : entryChunks)
+			XLib::SystemHeapAllocator::Release(chunk);
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	QueryResourceResult ResourceCacheBase<Resource, ConcreteCache>::query(const ResourceUID uid,
+		const float32 priority, ResourceQueryCallback callback, void* callbackContext)
+	{
+		XAssert(callback);
+
+		QueryResourceResult result = {};
+
+		bool inserted = false;
+		uint32& entryIndexRef = uidMap.findOrInsert(uid, &inserted);
+
+		uint32 entryIndex = entryIndexRef;
+		if (!inserted)
+		{
+			Entry& entry = getEntry(entryIndex);
+			if (entry.state == EntryState::Ready)
+			{
+				if (entry.referenceCount == 0)
+					lruRemove(entryIndex);
+				entry.referenceCount++;
+
+				result.readyResourceHandle = ComposeHandle(entryIndex, entry.handleGeneration);
+				result.type = QueryResourceResultType::ResourceReady;
+				return result;
+			}
+		}
+		else
+		{
+			entryIndex = allocateEntry();
+			entryIndexRef = entryIndex;
+			getEntry(entryIndex).uid = uid;
+		}
+
+		Entry& entry = getEntry(entryIndex);
+		XAssert(entry.state == EntryState::Loading);
+
+		const uint32 queryIndex = allocateQuery();
+		Query& query = queries[queryIndex];
+		query.callback = callback;
+		query.callbackContext = callbackContext;
+		query.priority = priority;
+		query.entryIndex = entryIndex;
+		linkQuery(queryIndex, entry);
+
+		const ResourceHandle loadingHandle = ComposeHandle(entryIndex, entry.handleGeneration);
+		if (inserted)
+		{
+			entry.loadingPriority = priority;
+			concreteCache().startLoading(entry.resource, uid, priority, loadingHandle);
+		}
+		else if (priority > entry.loadingPriority)
+		{
+			entry.loadingPriority = priority;
+			concreteCache().setLoadingPriority(entry.resource, loadingHandle, priority);
+		}
+
+		result.pendingResourceQueryHandle = ComposeHandle(queryIndex, query.handleGeneration);
+		result.type = QueryResourceResultType::ResourceQueryPending;
+		return result;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	void ResourceCacheBase<Resource, ConcreteCache>::cancelQuery(const ResourceQueryHandle handle)
+	{
+		const uint32 queryIndex = GetHandleIndex(handle);
+		if (!handle || queryIndex >= queries.getSize())
+			return;
+
+		Query& query = queries[queryIndex];
+		if (query.handleGeneration != GetHandleGeneration(handle))
+			return; // Already resolved.
+
+		if (query.entryIndex == InvalidIndex)
+		{
+			// Either slot is free or query is detached from failed entry and waits for its callback.
+			// Detached query is released by `onLoadingComplete`, here it is only silenced.
+			query.callback = nullptr;
+			query.callbackContext = nullptr;
+			return;
+		}
+
+		const uint32 entryIndex = query.entryIndex;
+		Entry& entry = getEntry(entryIndex);
+		unlinkQuery(queryIndex, entry);
+		releaseQuery(queryIndex);
+
+		// Query is cancelled from callback of another query of the same entry, which has just loaded.
+		if (entry.state != EntryState::Loading)
+			return;
+
+		if (entry.firstQueryIndex != InvalidIndex)
+		{
+			updateLoadingPriority(entryIndex);
+		}
+		else if (!entry.loadingCancellationRequested)
+		{
+			// Entry stays until loader reports back. If load completes anyway, resource goes to LRU.
+			entry.loadingCancellationRequested = true;
+			concreteCache().cancelLoading(entry.resource, ComposeHandle(entryIndex, entry.handleGeneration));
+		}
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	void ResourceCacheBase<Resource, ConcreteCache>::setQueryPriority(const ResourceQueryHandle handle, const float32 priority)
+	{
+		const uint32 queryIndex = GetHandleIndex(handle);
+		if (!handle || queryIndex >= queries.getSize())
+			return;
+
+		Query& query = queries[queryIndex];
+		if (query.entryIndex == InvalidIndex || query.handleGeneration != GetHandleGeneration(handle))
+			return;
+
+		query.priority = priority;
+		if (getEntry(query.entryIndex).state == EntryState::Loading)
+			updateLoadingPriority(query.entryIndex);
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	ResourceHandle ResourceCacheBase<Resource, ConcreteCache>::find(const ResourceUID uid, const bool addReference)
+	{
+		const uint32* entryIndex = uidMap.find(uid);
+		if (!entryIndex)
+			return 0;
+
+		Entry& entry = getEntry(*entryIndex);
+		if (entry.state != EntryState::Ready)
+			return 0;
+
+		if (addReference)
+		{
+			if (entry.referenceCount == 0)
+				lruRemove(*entryIndex);
+			entry.referenceCount++;
+		}
+		else if (entry.referenceCount == 0)
+		{
+			// Touch.
+			lruRemove(*entryIndex);
+			lruPushBack(*entryIndex);
+		}
+
+		return ComposeHandle(*entryIndex, entry.handleGeneration);
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	void ResourceCacheBase<Resource, ConcreteCache>::addReference(const ResourceHandle handle)
+	{
+		Entry* entry = resolveHandle(handle);
+		XAssert(entry && entry->state == EntryState::Ready);
+
+		if (entry->referenceCount == 0)
+			lruRemove(GetHandleIndex(handle));
+		entry->referenceCount++;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	void ResourceCacheBase<Resource, ConcreteCache>::removeReference(const ResourceHandle handle)
+	{
+		Entry* entry = resolveHandle(handle);
+		XAssert(entry && entry->state == EntryState::Ready);
+		XAssert(entry->referenceCount > 0);
+
+		entry->referenceCount--;
+		if (entry->referenceCount == 0)
+		{
+			lruPushBack(GetHandleIndex(handle));
+			evictOverBudget();
+		}
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	bool ResourceCacheBase<Resource, ConcreteCache>::isValidHandle(const ResourceHandle handle) const
+	{
+		const uint32 index = GetHandleIndex(handle);
+		if (!handle || index >= entryCount)
+			return false;
+
+		const Entry& entry = getEntry(index);
+		return entry.state == EntryState::Ready && entry.handleGeneration == GetHandleGeneration(handle);
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	const Resource& ResourceCacheBase<Resource, ConcreteCache>::get(const ResourceHandle handle) const
+	{
+		XAssert(isValidHandle(handle));
+		return getEntry(GetHandleIndex(handle)).resource;
+	}
+
+	template <typename Resource, typename ConcreteCache>
+	void ResourceCacheBase<Resource, ConcreteCache>::setMemoryBudget(const uint64 byteSize)
+	{
+		memoryBudget = byteSize;
+		evictOverBudget();
 	}
 }
@@ -922,9 +922,13 @@ ShaderCompilationResultRef ShaderCompiler::CompileShader(
 	MultiByteToWideChar(CP_ACP, 0, mainSourceFilePath.getData(), uint32(mainSourceFilePath.getLength()), mainSourceFilePathW, countOf(mainSourceFilePathW));
 	MultiByteToWideChar(CP_ACP, 0, args.entryPointName.getData(), uint32(args.entryPointName.getLength()), entryPointNameW, countOf(entryPointNameW));
 
-	static Microsoft::WRL::ComPtr<IDxcUtils> dxcUtils;
-	if (!dxcUtils)
-		DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&dxcUtils));
+	// Function can be called concurrently from several threads. `IDxcUtils` is shared, compiler instance is not.
+	static const Microsoft::WRL::ComPtr<IDxcUtils> dxcUtils = []() -> Microsoft::WRL::ComPtr<IDxcUtils>
+	{
+		Microsoft::WRL::ComPtr<IDxcUtils> result;
+		DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&result));
+		return result;
+	}();
 
 	Microsoft::WRL::ComPtr<IDxcCompiler3> dxcCompiler;
 	DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&dxcCompiler));
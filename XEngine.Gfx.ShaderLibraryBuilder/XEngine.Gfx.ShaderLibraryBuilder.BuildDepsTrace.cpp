@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <XLib.Allocation.h>
 #include <XLib.CRC.h>
 #include <XLib.System.Timer.h>
@@ -9,50 +11,146 @@ using namespace XEngine::Gfx::ShaderLibraryBuilder::BuildDepsTrace;
 
 static inline uint64 U64From2xU32(uint32 lo, uint32 hi) { return uint64(lo) | (uint64(hi) << 32); }
 
-// BuildDepsTrace::Reader //////////////////////////////////////////////////////////////////////////
-
-Reader::~Reader()
+static inline bool IsRecordPathValid(const char* pathString, uint16 pathLength, const void* recordEnd)
 {
-	if (fileData)
-		SystemHeapAllocator::Release((void*)fileData);
+	if (pathString > recordEnd)
+		return false;
 
-	fileData = nullptr;
-	manifestFileRecord = nullptr;
-	builtLibraryFileRecord = nullptr;
+	const byte* pathStringEnd = (byte*)(pathString + pathLength + 1);
+	if (pathStringEnd > recordEnd)
+		return false;
+	if (pathStringEnd + Format::RecordAlignment <= recordEnd)
+		return false;
+	if (pathString[pathLength] != 0)
+		return false;
+
+	return true;
 }
 
-bool Reader::load(const char* pathCStr, uint32 expectedMagic)
+// Returns record body if there is a record of specified type at specified offset. Record hash is not checked.
+static const void* GetRecordBody(const byte* fileData, uint32 recordsEndOffset, uint32 recordOffset,
+	Format::RecordType type, uintptr bodySize, const void*& resultRecordEnd)
 {
-	XTODO(__FUNCTION__ ": Release memory on failure");
+	if (recordOffset % Format::RecordAlignment != 0)
+		return nullptr;
+	if (recordOffset < sizeof(Format::Header))
+		return nullptr;
+	if (uint64(recordOffset) + sizeof(Format::RecordHeader) + bodySize > recordsEndOffset)
+		return nullptr;
+
+	const Format::RecordHeader* recordHeader = (Format::RecordHeader*)(fileData + recordOffset);
+	if (recordHeader->type != type)
+		return nullptr;
+	if (recordHeader->size < sizeof(Format::RecordHeader) + bodySize)
+		return nullptr;
+	if (uint64(recordOffset) + recordHeader->size > recordsEndOffset)
+		return nullptr;
+
+	resultRecordEnd = fileData + recordOffset + recordHeader->size;
+	return recordHeader + 1;
+}
 
-	XAssert(!fileData);
+// BuildDepsTrace::Reader //////////////////////////////////////////////////////////////////////////
 
-	File file;
-	file.open(pathCStr, FileAccessMode::Read, FileOpenMode::OpenExisting);
-	if (!file.isOpen())
+bool Reader::loadIndex()
+{
+	if (fileSize < sizeof(Format::Header) + sizeof(Format::IndexFooter))
 		return false;
 
-	const uint64 fileSize = file.getSize();
-	if (fileSize == uint64(-1))
+	const uint32 footerOffset = fileSize - sizeof(Format::IndexFooter);
+	if (footerOffset % Format::RecordAlignment != 0)
 		return false;
-	byte* fileData = (byte*) SystemHeapAllocator::Allocate(fileSize);
-	if (!file.read(fileData, fileSize))
+
+	const Format::IndexFooter& footer = *(Format::IndexFooter*)(fileData + footerOffset);
+	if (footer.signature != Format::IndexFooterSignature)
 		return false;
-	file.close();
+	if (footer.fileHash != CRC32C::Compute(fileData, footerOffset))
+		return false;
+
+	// File content is verified by hash at this point. Checks below only guard against out of bounds reads.
 
-	if (fileSize < sizeof(Format::Header))
+	const uint32 shaderIndexSize = footer.shaderCount * sizeof(Format::ShaderIndexEntry);
+	const uint32 sourceFileTableSize = footer.sourceFileCount * sizeof(Format::SourceFileTableEntry);
+	if (uint64(footer.shaderIndexOffset) + shaderIndexSize != footer.sourceFileTableOffset)
+		return false;
+	if (uint64(footer.sourceFileTableOffset) + sourceFileTableSize != footerOffset)
 		return false;
 
-	const Format::Header* header = (Format::Header*)fileData;
-	if (header->magic != expectedMagic)
+	const uint32 recordsEndOffset = footer.shaderIndexOffset;
+	const void* recordEnd = nullptr;
+
+	const Format::ManifestFileRecordBody* manifestFileRecordBody = (const Format::ManifestFileRecordBody*)GetRecordBody(fileData, recordsEndOffset,
+		sizeof(Format::Header), Format::RecordType::ManifestFile, sizeof(Format::ManifestFileRecordBody), recordEnd);
+	if (!manifestFileRecordBody)
+		return false;
+	if (!IsRecordPathValid((char*)(manifestFileRecordBody + 1), manifestFileRecordBody->pathLength, recordEnd))
 		return false;
 
+	// BuiltLibraryFileRecord should be the last record.
+	const Format::BuiltLibraryFileRecordBody* builtLibraryFileRecordBody = (const Format::BuiltLibraryFileRecordBody*)GetRecordBody(fileData, recordsEndOffset,
+		footer.builtLibraryFileRecordOffset, Format::RecordType::BuiltLibraryFile, sizeof(Format::BuiltLibraryFileRecordBody), recordEnd);
+	if (!builtLibraryFileRecordBody)
+		return false;
+	if (recordEnd != fileData + recordsEndOffset)
+		return false;
+	if (!IsRecordPathValid((char*)(builtLibraryFileRecordBody + 1), builtLibraryFileRecordBody->pathLength, recordEnd))
+		return false;
+
+	const Format::SourceFileTableEntry* sourceFileTableEntries = (Format::SourceFileTableEntry*)(fileData + footer.sourceFileTableOffset);
+	for (uint16 i = 0; i < footer.sourceFileCount; i++)
+	{
+		const uint32 recordOffset = sourceFileTableEntries[i].recordOffset;
+		const Format::SourceFileRecordBody* sourceFileRecordBody = (const Format::SourceFileRecordBody*)GetRecordBody(fileData, recordsEndOffset,
+			recordOffset, Format::RecordType::SourceFile, sizeof(Format::SourceFileRecordBody), recordEnd);
+		if (!sourceFileRecordBody)
+			return false;
+		if (sourceFileRecordBody->index != i)
+			return false;
+		if (!IsRecordPathValid((char*)(sourceFileRecordBody + 1), sourceFileRecordBody->pathLength, recordEnd))
+			return false;
+	}
+
+	const Format::ShaderIndexEntry* shaderIndexEntries = (Format::ShaderIndexEntry*)(fileData + footer.shaderIndexOffset);
+	for (uint16 i = 0; i < footer.shaderCount; i++)
+	{
+		const Format::ShaderIndexEntry& entry = shaderIndexEntries[i];
+		if (i > 0 && U64From2xU32(shaderIndexEntries[i - 1].nameXSH0, shaderIndexEntries[i - 1].nameXSH1) >= U64From2xU32(entry.nameXSH0, entry.nameXSH1))
+			return false;
+
+		const Format::ShaderRecordBody* shaderRecordBody = (const Format::ShaderRecordBody*)GetRecordBody(fileData, recordsEndOffset,
+			entry.recordOffset, Format::RecordType::Shader, sizeof(Format::ShaderRecordBody), recordEnd);
+		if (!shaderRecordBody)
+			return false;
+		if (shaderRecordBody->nameXSH0 != entry.nameXSH0 || shaderRecordBody->nameXSH1 != entry.nameXSH1)
+			return false;
+
+		const uint16* shaderSourceFileIndices = (uint16*)(shaderRecordBody + 1);
+		if ((byte*)(shaderSourceFileIndices + shaderRecordBody->sourceFileCount) > recordEnd)
+			return false;
+		for (uint16 j = 0; j < shaderRecordBody->sourceFileCount; j++)
+		{
+			if (shaderSourceFileIndices[j] >= footer.sourceFileCount)
+				return false;
+		}
+	}
+
+	this->manifestFileRecord = manifestFileRecordBody;
+	this->builtLibraryFileRecord = builtLibraryFileRecordBody;
+	this->shaderIndexEntries = shaderIndexEntries;
+	this->sourceFileTableEntries = sourceFileTableEntries;
+	this->shaderCount = footer.shaderCount;
+	this->sourceFileCount = footer.sourceFileCount;
+	return true;
+}
+
+bool Reader::scanRecords()
+{
 	struct
 	{
 		const Format::ManifestFileRecordBody* manifestFileRecord = nullptr;
 		const Format::BuiltLibraryFileRecordBody* builtLibraryFileRecord = nullptr;
-		ArrayList<const Format::SourceFileRecordBody*> sourceFiles;
-		ArrayList<Shader> shaders;
+		ArrayList<Format::SourceFileTableEntry> sourceFiles;
+		ArrayList<Format::ShaderIndexEntry> shaders;
 	} tmp;
 
 	uint32 recordOffset = sizeof(Format::Header);
@@ -69,6 +167,8 @@ bool Reader::load(const char* pathCStr, uint32 expectedMagic)
 			break;
 		if (recordOffset + recordHeader->size > fileSize)
 			break;
+		if (recordHeader->size < sizeof(Format::RecordHeader))
+			break;
 		if (recordHeader->size % Format::RecordAlignment != 0)
 			break;
 		if (recordHeader->size > Format::MaxRecordSize)
@@ -100,16 +200,7 @@ bool Reader::load(const char* pathCStr, uint32 expectedMagic)
 		if (recordHeader->type == Format::RecordType::ManifestFile)
 		{
 			const Format::ManifestFileRecordBody* manifestFileRecordBody = (Format::ManifestFileRecordBody*)recordBody;
-			const char* manifestFilePathString = (char*)(manifestFileRecordBody + 1);
-			if (manifestFilePathString > recordEnd)
-				return false;
-
-			const byte* manifestFilePathStringEnd = (byte*)(manifestFilePathString + manifestFileRecordBody->pathLength + 1);
-			if (manifestFilePathStringEnd > recordEnd)
-				return false;
-			if (manifestFilePathStringEnd + Format::RecordAlignment <= recordEnd)
-				return false;
-			if (manifestFilePathString[manifestFileRecordBody->pathLength] != 0)
+			if (!IsRecordPathValid((char*)(manifestFileRecordBody + 1), manifestFileRecordBody->pathLength, recordEnd))
 				return false;
 
 			tmp.manifestFileRecord = manifestFileRecordBody;
@@ -117,16 +208,7 @@ bool Reader::load(const char* pathCStr, uint32 expectedMagic)
 		else if (recordHeader->type == Format::RecordType::SourceFile)
 		{
 			const Format::SourceFileRecordBody* sourceFileRecordBody = (Format::SourceFileRecordBody*)recordBody;
-			const char* sourceFilePathString = (char*)(sourceFileRecordBody + 1);
-			if (sourceFilePathString > recordEnd)
-				return false;
-
-			const byte* sourceFilePathStringEnd = (byte*)(sourceFilePathString + sourceFileRecordBody->pathLength + 1);
-			if (sourceFilePathStringEnd > recordEnd)
-				return false;
-			if (sourceFilePathStringEnd + Format::RecordAlignment <= recordEnd)
-				return false;
-			if (sourceFilePathString[sourceFileRecordBody->pathLength] != 0)
+			if (!IsRecordPathValid((char*)(sourceFileRecordBody + 1), sourceFileRecordBody->pathLength, recordEnd))
 				return false;
 
 			if (tmp.sourceFiles.getSize() >= uint16(-1))
@@ -136,7 +218,7 @@ bool Reader::load(const char* pathCStr, uint32 expectedMagic)
 			if (sourceFileRecordBody->index != expectedSourceFileIndex)
 				return false;
 
-			tmp.sourceFiles.pushBack(sourceFileRecordBody);
+			tmp.sourceFiles.pushBack(Format::SourceFileTableEntry { .recordOffset = recordOffset });
 		}
 		else if (recordHeader->type == Format::RecordType::Shader)
 		{
@@ -160,28 +242,20 @@ bool Reader::load(const char* pathCStr, uint32 expectedMagic)
 					return false;
 			}
 
-			const uint64 nameXSH = U64From2xU32(shaderRecordBody->nameXSH0, shaderRecordBody->nameXSH1);
-			tmp.shaders.pushBack(Shader { .nameXSH = nameXSH, .record = shaderRecordBody });
+			tmp.shaders.pushBack(Format::ShaderIndexEntry {
+				.nameXSH0 = shaderRecordBody->nameXSH0,
+				.nameXSH1 = shaderRecordBody->nameXSH1,
+				.recordOffset = recordOffset,
+			});
 		}
 		else if (recordHeader->type == Format::RecordType::BuiltLibraryFile)
 		{
 			const Format::BuiltLibraryFileRecordBody* builtLibraryFileRecordBody = (Format::BuiltLibraryFileRecordBody*)recordBody;
-			const char* builtLibraryFilePathString = (char*)(builtLibraryFileRecordBody + 1);
-			if (builtLibraryFilePathString > recordEnd)
-				return false;
-
-			const byte* builtLibraryFilePathStringEnd = (byte*)(builtLibraryFilePathString + builtLibraryFileRecordBody->pathLength + 1);
-			if (builtLibraryFilePathStringEnd > recordEnd)
-				return false;
-			if (builtLibraryFilePathStringEnd + Format::RecordAlignment <= recordEnd)
-				return false;
-			if (builtLibraryFilePathString[builtLibraryFileRecordBody->pathLength] != 0)
+			if (!IsRecordPathValid((char*)(builtLibraryFileRecordBody + 1), builtLibraryFileRecordBody->pathLength, recordEnd))
 				return false;
 
+			// Index may follow this record. It is ignored here.
 			tmp.builtLibraryFileRecord = builtLibraryFileRecordBody;
-
-			if (recordOffset + recordHeader->size != fileSize)
-				return false;
 			break;
 		}
 		else
@@ -191,14 +265,106 @@ bool Reader::load(const char* pathCStr, uint32 expectedMagic)
 		recordIndex++;
 	}
 
-	this->fileData = fileData;
+	if (!tmp.manifestFileRecord)
+		return false;
+
+	std::sort(tmp.shaders.begin(), tmp.shaders.end(),
+		[](const Format::ShaderIndexEntry& a, const Format::ShaderIndexEntry& b) -> bool
+		{
+			return U64From2xU32(a.nameXSH0, a.nameXSH1) < U64From2xU32(b.nameXSH0, b.nameXSH1);
+		});
+
 	this->manifestFileRecord = tmp.manifestFileRecord;
 	this->builtLibraryFileRecord = tmp.builtLibraryFileRecord;
-	this->sourceFiles = AsRValue(tmp.sourceFiles);
-	this->shaders = AsRValue(tmp.shaders);
+	this->scannedSourceFileTable = AsRValue(tmp.sourceFiles);
+	this->scannedShaderIndex = AsRValue(tmp.shaders);
+	this->sourceFileTableEntries = scannedSourceFileTable.getData();
+	this->shaderIndexEntries = scannedShaderIndex.getData();
+	this->sourceFileCount = uint16(scannedSourceFileTable.getSize());
+	this->shaderCount = uint16(scannedShaderIndex.getSize());
+	return true;
+}
+
+bool Reader::load(const char* pathCStr, uint32 expectedMagic)
+{
+	close();
+
+	if (!file.open(pathCStr))
+		return false;
+
+	if (file.getSize() < sizeof(Format::Header) || file.getSize() > uint32(-1))
+	{
+		close();
+		return false;
+	}
+
+	fileData = (const byte*)file.getData();
+	fileSize = uint32(file.getSize());
+
+	const Format::Header* header = (Format::Header*)fileData;
+	if (header->magic != expectedMagic || header->version != Format::CurrentVersion)
+	{
+		close();
+		return false;
+	}
+
+	// Index is written only after a successful build. Otherwise records have to be scanned.
+	if (!loadIndex() && !scanRecords())
+	{
+		close();
+		return false;
+	}
+
 	return true;
 }
 
+void Reader::close()
+{
+	file.close();
+
+	if (fileDataCopy)
+		SystemHeapAllocator::Release(fileDataCopy);
+
+	fileDataCopy = nullptr;
+	fileData = nullptr;
+	fileSize = 0;
+	manifestFileRecord = nullptr;
+	builtLibraryFileRecord = nullptr;
+	shaderIndexEntries = nullptr;
+	sourceFileTableEntries = nullptr;
+	shaderCount = 0;
+	sourceFileCount = 0;
+	scannedShaderIndex.clear();
+	scannedSourceFileTable.clear();
+}
+
+void Reader::unmapFile()
+{
+	if (!file.isOpen())
+		return;
+
+	fileDataCopy = (byte*)SystemHeapAllocator::Allocate(fileSize);
+	memoryCopy(fileDataCopy, fileData, fileSize);
+
+	// Rebase pointers that refer to the mapped file. Scanned lists are already in memory.
+	const byte* mappedData = fileData;
+	const byte* mappedDataEnd = fileData + fileSize;
+	auto rebase = [mappedData, mappedDataEnd, this](const void* ptr) -> const void*
+		{
+			if (ptr < mappedData || ptr >= mappedDataEnd)
+				return ptr;
+			return fileDataCopy + ((const byte*)ptr - mappedData);
+		};
+
+	manifestFileRecord = (const Format::ManifestFileRecordBody*)rebase(manifestFileRecord);
+	builtLibraryFileRecord = (const Format::BuiltLibraryFileRecordBody*)rebase(builtLibraryFileRecord);
+	shaderIndexEntries = (const Format::ShaderIndexEntry*)rebase(shaderIndexEntries);
+	sourceFileTableEntries = (const Format::SourceFileTableEntry*)rebase(sourceFileTableEntries);
+	fileData = fileDataCopy;
+
+	file.close();
+}
+
 StringViewASCII Reader::getManifestFilePath() const
 {
 	XAssert(manifestFileRecord);
@@ -227,27 +393,25 @@ uint64 Reader::getBuiltLibraryFileModTime() const
 
 StringViewASCII Reader::getSourceFilePath(uint16 sourceFileIndex) const
 {
-	XAssert(sourceFileIndex < sourceFiles.getSize());
-	const char* path = (char*)(sourceFiles[sourceFileIndex] + 1);
-	return StringViewASCII(path, sourceFiles[sourceFileIndex]->pathLength);
+	const Format::SourceFileRecordBody* sourceFileRecord = getSourceFileRecord(sourceFileIndex);
+	const char* path = (char*)(sourceFileRecord + 1);
+	return StringViewASCII(path, sourceFileRecord->pathLength);
 }
 
 uint64 Reader::getSourceFileModTime(uint16 sourceFileIndex) const
 {
-	XAssert(sourceFileIndex < sourceFiles.getSize());
-	return U64From2xU32(sourceFiles[sourceFileIndex]->modTime0, sourceFiles[sourceFileIndex]->modTime1);
+	const Format::SourceFileRecordBody* sourceFileRecord = getSourceFileRecord(sourceFileIndex);
+	return U64From2xU32(sourceFileRecord->modTime0, sourceFileRecord->modTime1);
 }
 
 uint16 Reader::getShaderSourceFileCount(uint16 shaderIndex) const
 {
-	XAssert(shaderIndex < shaders.getSize());
-	return shaders[shaderIndex].record->sourceFileCount;
+	return getShaderRecord(shaderIndex)->sourceFileCount;
 }
 
 uint16 Reader::getShaderSourceFileIndex(uint16 shaderIndex, uint16 localSourceFileIndex) const
 {
-	XAssert(shaderIndex < shaders.getSize());
-	const Format::ShaderRecordBody* shaderRecord = shaders[shaderIndex].record;
+	const Format::ShaderRecordBody* shaderRecord = getShaderRecord(shaderIndex);
 	const uint16* shaderSourceFileIndices = (uint16*)(shaderRecord + 1);
 	XAssert(localSourceFileIndex < shaderRecord->sourceFileCount);
 	return shaderSourceFileIndices[localSourceFileIndex];
@@ -255,18 +419,24 @@ uint16 Reader::getShaderSourceFileIndex(uint16 shaderIndex, uint16 localSourceFi
 
 uint64 Reader::getShaderCompiledBlobModTime(uint16 shaderIndex) const
 {
-	XAssert(shaderIndex < shaders.getSize());
-	const Format::ShaderRecordBody& shaderRecord = *shaders[shaderIndex].record;
+	const Format::ShaderRecordBody& shaderRecord = *getShaderRecord(shaderIndex);
 	return U64From2xU32(shaderRecord.compiledBlobFileModTime0, shaderRecord.compiledBlobFileModTime1);
 }
 
 uint16 Reader::findShader(uint64 shaderNameXSH) const
 {
-	XTODO(__FUNCTION__ ": Sort shaders and use binary search here");
-	for (uint16 i = 0; i < shaders.getSize(); i++)
+	uint32 begin = 0;
+	uint32 end = shaderCount;
+	while (begin < end)
 	{
-		if (shaders[i].nameXSH == shaderNameXSH)
-			return i;
+		const uint32 middle = (begin + end) / 2;
+		const uint64 middleNameXSH = U64From2xU32(shaderIndexEntries[middle].nameXSH0, shaderIndexEntries[middle].nameXSH1);
+		if (middleNameXSH == shaderNameXSH)
+			return uint16(middle);
+		if (middleNameXSH < shaderNameXSH)
+			begin = middle + 1;
+		else
+			end = middle;
 	}
 	return uint16(-1);
 }
@@ -275,8 +445,7 @@ bool Reader::doShaderDetailsMatch(uint16 shaderIndex,
 	uint64 pipelineLayoutNameXSH, uint64 pipelineLayoutHash,
 	const HAL::ShaderCompiler::ShaderCompilationArgs& compilationArgs) const
 {
-	XAssert(shaderIndex < shaders.getSize());
-	const Format::ShaderRecordBody& shaderRecord = *shaders[shaderIndex].record;
+	const Format::ShaderRecordBody& shaderRecord = *getShaderRecord(shaderIndex);
 
 	if (shaderRecord.pipelineLayoutNameXSH != uint32(pipelineLayoutNameXSH))
 		return false;
@@ -298,7 +467,7 @@ bool Reader::doShaderDetailsMatch(uint16 shaderIndex,
 
 // BuildDepsTrace::Writer //////////////////////////////////////////////////////////////////////////
 
-void Writer::putRecord(Format::RecordType type,
+uint32 Writer::putRecord(Format::RecordType type,
 	const void* bodyData, uintptr bodySize,
 	const void* payloadData, uintptr payloadSize,
 	bool nullTerminatePayload)
@@ -313,6 +482,8 @@ void Writer::putRecord(Format::RecordType type,
 		flush();
 
 	XAssert(bufferUsedSize % Format::RecordAlignment == 0);
+	XAssert(uint64(writtenSize) + bufferUsedSize + recordSize <= uint32(-1));
+	const uint32 recordOffset = writtenSize + bufferUsedSize;
 	byte* recordData = buffer + bufferUsedSize;
 	bufferUsedSize += recordSize;
 	memorySet(recordData + recordSize - Format::RecordAlignment, 0, Format::RecordAlignment);
@@ -326,6 +497,19 @@ void Writer::putRecord(Format::RecordType type,
 
 	const uint16 recordHash = CRC16::Compute(recordData, recordSize);
 	recordHeader->hash = recordHash;
+
+	return recordOffset;
+}
+
+void Writer::write(const void* data, uintptr size)
+{
+	XAssert(uint64(writtenSize) + size <= uint32(-1));
+	if (!size)
+		return;
+
+	file.write(data, size);
+	writtenDataHash.process(data, size);
+	writtenSize += uint32(size);
 }
 
 void Writer::flush()
@@ -337,7 +521,7 @@ void Writer::flush()
 	XAssert(bufferUsedSize <= BufferSize);
 	XAssert(bufferUsedSize % Format::RecordAlignment == 0);
 
-	file.write(buffer, bufferUsedSize);
+	write(buffer, bufferUsedSize);
 	bufferUsedSize = 0;
 
 	lastFlushTimestamp = Timer::GetRecord();
@@ -358,6 +542,11 @@ void Writer::cleanup()
 	shaderCount = 0;
 
 	lastFlushTimestamp = 0;
+
+	writtenSize = 0;
+	writtenDataHash.reset();
+	shaderIndexEntries.clear();
+	sourceFileTableEntries.clear();
 }
 
 void Writer::openForWriting(const char* pathCStr, uint32 magic,
@@ -380,6 +569,8 @@ void Writer::openForWriting(const char* pathCStr, uint32 magic,
 	{
 		Format::Header* header = (Format::Header*)buffer;
 		header->magic = magic;
+		header->version = Format::CurrentVersion;
+		header->_padding = 0;
 		bufferUsedSize = sizeof(Format::Header);
 	}
 
@@ -455,10 +646,13 @@ void Writer::addShader(uint64 nameXSH,
 			sourceFileRecordBody.index = sourceFileIndex;
 			sourceFileRecordBody.pathLength = XCheckedCastU16(sourceFilePath.getLength());
 
-			putRecord(Format::RecordType::SourceFile,
+			const uint32 recordOffset = putRecord(Format::RecordType::SourceFile,
 				&sourceFileRecordBody, sizeof(sourceFileRecordBody),
 				sourceFilePath.getData(), sourceFilePath.getLength(),
 				true);
+
+			XAssert(sourceFileTableEntries.getSize() == sourceFileIndex);
+			sourceFileTableEntries.pushBack(Format::SourceFileTableEntry { .recordOffset = recordOffset });
 		}
 	}
 
@@ -480,9 +674,15 @@ void Writer::addShader(uint64 nameXSH,
 		shaderRecordBody.sourceFileCount = shaderSourceFileIndices.getSize();
 		shaderRecordBody.type = compilationArgs.shaderType;
 
-		putRecord(Format::RecordType::Shader,
+		const uint32 recordOffset = putRecord(Format::RecordType::Shader,
 			&shaderRecordBody, sizeof(shaderRecordBody),
 			shaderSourceFileIndices.getData(), shaderSourceFileIndices.getByteSize());
+
+		shaderIndexEntries.pushBack(Format::ShaderIndexEntry {
+			.nameXSH0 = shaderRecordBody.nameXSH0,
+			.nameXSH1 = shaderRecordBody.nameXSH1,
+			.recordOffset = recordOffset,
+		});
 	}
 
 	// Flush time threshold is reached.
@@ -498,19 +698,43 @@ void Writer::closeAfterSuccessfulBuild(StringViewASCII builtLibraryFilePath, uin
 		return;
 
 	// Put BuiltLibraryFileRecord.
+	uint32 builtLibraryFileRecordOffset = 0;
 	{
 		Format::BuiltLibraryFileRecordBody builtLibraryFileRecordBody = {};
 		builtLibraryFileRecordBody.modTime0 = uint32(builtLibraryFileModTime);
 		builtLibraryFileRecordBody.modTime1 = uint32(builtLibraryFileModTime >> 32);
 		builtLibraryFileRecordBody.pathLength = XCheckedCastU16(builtLibraryFilePath.getLength());
 
-		putRecord(Format::RecordType::BuiltLibraryFile,
+		builtLibraryFileRecordOffset = putRecord(Format::RecordType::BuiltLibraryFile,
 			&builtLibraryFileRecordBody, sizeof(builtLibraryFileRecordBody),
 			builtLibraryFilePath.getData(), builtLibraryFilePath.getLength(),
 			true);
 	}
 
 	flush();
+
+	// Put index.
+	// Successful build can not contain shaders with colliding names, so entries are unique.
+	std::sort(shaderIndexEntries.begin(), shaderIndexEntries.end(),
+		[](const Format::ShaderIndexEntry& a, const Format::ShaderIndexEntry& b) -> bool
+		{
+			return U64From2xU32(a.nameXSH0, a.nameXSH1) < U64From2xU32(b.nameXSH0, b.nameXSH1);
+		});
+
+	Format::IndexFooter footer = {};
+	footer.builtLibraryFileRecordOffset = builtLibraryFileRecordOffset;
+	footer.shaderCount = XCheckedCastU16(shaderIndexEntries.getSize());
+	footer.sourceFileCount = XCheckedCastU16(sourceFileTableEntries.getSize());
+
+	footer.shaderIndexOffset = writtenSize;
+	write(shaderIndexEntries.getData(), shaderIndexEntries.getByteSize());
+	footer.sourceFileTableOffset = writtenSize;
+	write(sourceFileTableEntries.getData(), sourceFileTableEntries.getByteSize());
+
+	footer.fileHash = writtenDataHash.getValue();
+	footer.signature = Format::IndexFooterSignature;
+	write(&footer, sizeof(footer));
+
 	cleanup();
 }
 
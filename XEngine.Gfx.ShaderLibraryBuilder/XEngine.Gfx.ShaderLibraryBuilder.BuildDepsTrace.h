@@ -2,6 +2,7 @@
 
 #include <XLib.h>
 #include <XLib.Containers.ArrayList.h>
+#include <XLib.CRC.h>
 #include <XLib.NonCopyable.h>
 #include <XLib.String.h>
 #include <XLib.System.File.h>
@@ -31,6 +32,20 @@ namespace XEngine::Gfx::ShaderLibraryBuilder::BuildDepsTrace
 		//
 		// Shader can exceed source file count limit. In this case, no source files will be saved,
 		// and shader will be considred invalidated.
+		//
+		// On a successful build, BuiltLibraryFileRecord is followed by the index:
+		//   ShaderIndexEntry[shaderCount] - sorted by shader name XSH.
+		//   SourceFileTableEntry[sourceFileCount] - in source file index order.
+		//   IndexFooter - always at the very end of the file.
+		// Footer contains CRC32C of everything before it. If the footer is valid, the reader uses the index
+		// directly from the mapped file. Otherwise it falls back to scanning the record stream.
+		//
+		// File is written in place and flushed periodically, so a crashed build leaves a truncated trace
+		// with everything compiled up to the last flush.
+
+		// Version 3: record hash is CRC-16/ARC.
+		static constexpr uint16 CurrentVersion = 3;
+		static constexpr uint32 IndexFooterSignature = 0x58444958; // "XIDX"
 
 		static constexpr uint16 RecordAlignment = 4;
 		static constexpr uint16 MaxRecordSize = 2048;
@@ -48,9 +63,11 @@ namespace XEngine::Gfx::ShaderLibraryBuilder::BuildDepsTrace
 			ValueCount,
 		};
 
-		struct Header // 4 bytes
+		struct Header // 8 bytes
 		{
 			uint32 magic;
+			uint16 version;
+			uint16 _padding;
 		};
 
 		struct RecordHeader // 4 bytes
@@ -99,38 +116,81 @@ namespace XEngine::Gfx::ShaderLibraryBuilder::BuildDepsTrace
 			uint16 _padding;
 		};
 
+		struct ShaderIndexEntry // 12 bytes
+		{
+			uint32 nameXSH0;
+			uint32 nameXSH1;
+			uint32 recordOffset;
+		};
+
+		struct SourceFileTableEntry // 4 bytes
+		{
+			uint32 recordOffset;
+		};
+
+		struct IndexFooter // 24 bytes
+		{
+			uint32 builtLibraryFileRecordOffset;
+			uint32 shaderIndexOffset;
+			uint32 sourceFileTableOffset;
+			uint16 shaderCount;
+			uint16 sourceFileCount;
+			uint32 fileHash;
+			uint32 signature;
+		};
+
 		static_assert(MaxRecordSize < (1 << RecordSizeHeaderFieldBitCount));
 		static_assert(uint16(RecordType::ValueCount) <= (1 << RecordTypeHeaderFieldBitCount));
 		static_assert(sizeof(Format::Header) % Format::RecordAlignment == 0);
 		static_assert(sizeof(Format::RecordHeader) == 4);
+		static_assert(sizeof(Format::ShaderIndexEntry) % Format::RecordAlignment == 0);
+		static_assert(sizeof(Format::SourceFileTableEntry) % Format::RecordAlignment == 0);
+		static_assert(sizeof(Format::IndexFooter) % Format::RecordAlignment == 0);
 	}
 
+	// Reader maps the file. It should be closed or unmapped before the trace is overwritten.
 	class Reader : public XLib::NonCopyable
 	{
 	private:
-		struct Shader
-		{
-			uint64 nameXSH;
-			const Format::ShaderRecordBody* record;
-		};
+		XLib::MappedFile file;
+		byte* fileDataCopy = nullptr; // Set after `unmapFile`.
+		const byte* fileData = nullptr;
+		uint32 fileSize = 0;
 
-	private:
-		const void* fileData = nullptr;
 		const Format::ManifestFileRecordBody* manifestFileRecord = nullptr;
 		const Format::BuiltLibraryFileRecordBody* builtLibraryFileRecord = nullptr;
-		XLib::ArrayList<const Format::SourceFileRecordBody*> sourceFiles;
-		XLib::ArrayList<Shader> shaders;
+
+		// Point either into the mapped file or into the scanned lists below.
+		const Format::ShaderIndexEntry* shaderIndexEntries = nullptr;
+		const Format::SourceFileTableEntry* sourceFileTableEntries = nullptr;
+		uint16 shaderCount = 0;
+		uint16 sourceFileCount = 0;
+
+		// Only used if the file has no valid index (failed or interrupted build).
+		XLib::ArrayList<Format::ShaderIndexEntry> scannedShaderIndex;
+		XLib::ArrayList<Format::SourceFileTableEntry> scannedSourceFileTable;
+
+	private:
+		bool loadIndex();
+		bool scanRecords();
+
+		inline const Format::SourceFileRecordBody* getSourceFileRecord(uint16 sourceFileIndex) const;
+		inline const Format::ShaderRecordBody* getShaderRecord(uint16 shaderIndex) const;
 
 	public:
 		Reader() = default;
-		~Reader();
+		inline ~Reader() { close(); }
 
 		bool load(const char* pathCStr, uint32 expectedMagic);
+		void close();
 
-		inline bool isLoaded() const { return fileData != nullptr; }
+		// Copies file contents to memory and unmaps the file, so it can be overwritten while reader is in use.
+		void unmapFile();
+
+		inline bool isLoaded() const { return manifestFileRecord != nullptr; }
 		inline bool wasBuildSuccessful() const { return builtLibraryFileRecord != nullptr; }
-		inline uint16 getSourceFileCount() const { return uint16(sourceFiles.getSize()); }
-		inline uint16 getShaderCount() const { return uint16(shaders.getSize()); }
+		inline uint16 getSourceFileCount() const { return sourceFileCount; }
+		inline uint16 getShaderCount() const { return shaderCount; }
 
 		XLib::StringViewASCII getManifestFilePath() const;
 		uint64 getManifestFileModTime() const;
@@ -145,7 +205,7 @@ namespace XEngine::Gfx::ShaderLibraryBuilder::BuildDepsTrace
 		uint16 getShaderSourceFileIndex(uint16 shaderIndex, uint16 localSourceFileIndex) const;
 		uint64 getShaderCompiledBlobModTime(uint16 shaderIndex) const;
 
-		uint16 findShader(uint64 shaderNameXSH) const; // returns -1 if shader not found.
+		uint16 findShader(uint64 shaderNameXSH) const; // Binary search. Returns -1 if shader not found.
 
 		bool doShaderDetailsMatch(uint16 shaderIndex,
 			uint64 pipelineLayoutNameXSH, uint64 pipelineLayoutHash,
@@ -177,12 +237,19 @@ namespace XEngine::Gfx::ShaderLibraryBuilder::BuildDepsTrace
 
 		uint64 lastFlushTimestamp = 0;
 
+		uint32 writtenSize = 0;
+		XLib::CRC32C writtenDataHash;
+
+		XLib::ArrayList<Format::ShaderIndexEntry> shaderIndexEntries;
+		XLib::ArrayList<Format::SourceFileTableEntry> sourceFileTableEntries;
+
 	private:
-		void putRecord(Format::RecordType type,
+		uint32 putRecord(Format::RecordType type,
 			const void* bodyData, uintptr bodySize,
 			const void* payloadData, uintptr payloadSize,
-			bool nullTerminatePayload = false);
+			bool nullTerminatePayload = false); // Returns record offset.
 
+		void write(const void* data, uintptr size);
 		void flush();
 		void cleanup();
 
@@ -202,3 +269,20 @@ namespace XEngine::Gfx::ShaderLibraryBuilder::BuildDepsTrace
 		void closeAfterFailedBuild();
 	};
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline auto XEngine::Gfx::ShaderLibraryBuilder::BuildDepsTrace::Reader::getSourceFileRecord(uint16 sourceFileIndex) const -> const Format::SourceFileRecordBody*
+{
+	XAssert(sourceFileIndex < sourceFileCount);
+	return (const Format::SourceFileRecordBody*)(fileData + sourceFileTableEntries[sourceFileIndex].recordOffset + sizeof(Format::RecordHeader));
+}
+
+inline auto XEngine::Gfx::ShaderLibraryBuilder::BuildDepsTrace::Reader::getShaderRecord(uint16 shaderIndex) const -> const Format::ShaderRecordBody*
+{
+	XAssert(shaderIndex < shaderCount);
+	return (const Format::ShaderRecordBody*)(fileData + shaderIndexEntries[shaderIndex].recordOffset + sizeof(Format::RecordHeader));
+}
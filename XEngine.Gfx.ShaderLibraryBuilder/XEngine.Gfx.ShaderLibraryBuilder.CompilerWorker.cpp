@@ -0,0 +1,658 @@
+#include <stdlib.h>
+
+#include <XLib.Fmt.h>
+#include <XLib.FileSystem.h>
+#include <XLib.System.File.h>
+#include <XLib.System.Threading.h>
+#include <XLib.System.Threading.Lock.h>
+#include <XLib.System.Timer.h>
+
+#include "XEngine.Gfx.ShaderLibraryBuilder.CompilerWorker.h"
+#include "XEngine.Gfx.ShaderLibraryBuilder.Library.h"
+#include "XEngine.Gfx.ShaderLibraryBuilder.LibraryManifestLoader.h"
+
+using namespace XLib;
+using namespace XEngine::Gfx;
+using namespace XEngine::Gfx::ShaderLibraryBuilder;
+
+namespace
+{
+	constexpr uint32 WorkerConnectionTimeoutMs = 10'000;
+	constexpr uint32 WorkerShutdownTimeoutMs = 2'000;
+	constexpr uint32 PipeBufferSize = 64 * 1024;
+	constexpr uint32 NoTimeout = uint32(-1);
+
+	void ComposePipePath(VirtualStringRefASCII result, StringViewASCII pipeName, const char* suffix)
+	{
+		FmtPrintStr(result, "\\\\.\\pipe\\", pipeName, suffix);
+	}
+
+	class MessageWriter
+	{
+	private:
+		ArrayList<byte>& buffer;
+
+	public:
+		inline MessageWriter(ArrayList<byte>& buffer, CompilerWorkerMessageType type) : buffer(buffer)
+		{
+			buffer.resize(sizeof(CompilerWorkerMessageHeader));
+			CompilerWorkerMessageHeader& header = *(CompilerWorkerMessageHeader*)buffer.getData();
+			header.type = type;
+			header.payloadSize = 0;
+		}
+
+		inline void writeBytes(const void* data, uint32 size)
+		{
+			const uint32 offset = buffer.getSize();
+			buffer.resize(offset + size);
+			memoryCopy(buffer.getData() + offset, data, size);
+		}
+
+		template <typename T>
+		inline void write(const T& value) { writeBytes(&value, sizeof(T)); }
+
+		inline void writeString(StringViewASCII string)
+		{
+			write(XCheckedCastU32(string.getLength()));
+			writeBytes(string.getData(), uint32(string.getLength()));
+		}
+
+		// Null blob and empty blob are not distinguished.
+		inline void writeBlob(const HAL::ShaderCompiler::Blob* blob)
+		{
+			const uint32 size = blob ? blob->getSize() : 0;
+			write(size);
+			if (size)
+				writeBytes(blob->getData(), size);
+		}
+
+		inline bool send(NamedPipe& pipe)
+		{
+			CompilerWorkerMessageHeader& header = *(CompilerWorkerMessageHeader*)buffer.getData();
+			header.payloadSize = buffer.getSize() - sizeof(CompilerWorkerMessageHeader);
+			XAssert(header.payloadSize <= CompilerWorker::MaxMessagePayloadSize);
+			return pipe.write(buffer.getData(), buffer.getSize());
+		}
+	};
+
+	class MessageReader
+	{
+	private:
+		const byte* current;
+		const byte* end;
+		bool failed = false;
+
+	public:
+		inline MessageReader(const ArrayList<byte>& payload) : current(payload.getData()), end(payload.getData() + payload.getSize()) {}
+
+		inline const void* readBytes(uint32 size)
+		{
+			if (failed || uintptr(end - current) < size)
+			{
+				failed = true;
+				return nullptr;
+			}
+			const void* result = current;
+			current += size;
+			return result;
+		}
+
+		template <typename T>
+		inline T read()
+		{
+			T result = {};
+			if (const void* data = readBytes(sizeof(T)))
+				memoryCopy(&result, data, sizeof(T));
+			return result;
+		}
+
+		inline StringViewASCII readString()
+		{
+			const uint32 length = read<uint32>();
+			const char* data = (const char*)readBytes(length);
+			return data ? StringViewASCII(data, length) : StringViewASCII();
+		}
+
+		inline HAL::ShaderCompiler::BlobRef readBlob()
+		{
+			const uint32 size = read<uint32>();
+			const void* data = readBytes(size);
+			if (!data || !size)
+				return nullptr;
+			HAL::ShaderCompiler::BlobRef blob = HAL::ShaderCompiler::Blob::Create(size);
+			memoryCopy((void*)blob->getData(), data, size);
+			return blob;
+		}
+
+		// All payload should be consumed by well-formed message.
+		inline bool isValid() const { return !failed && current == end; }
+	};
+
+	// Host response pipe is overlapped and is always read with timeout. Worker pipes are blocking.
+	inline bool ReadPipe(NamedPipe& pipe, void* buffer, uint32 size, uint32 timeoutMs)
+	{
+		return timeoutMs == NoTimeout ? pipe.read(buffer, size) : pipe.read(buffer, size, timeoutMs);
+	}
+
+	bool ReceiveMessage(NamedPipe& pipe, CompilerWorkerMessageType& resultType, ArrayList<byte>& resultPayload, uint32 timeoutMs = NoTimeout)
+	{
+		CompilerWorkerMessageHeader header = {};
+		if (!ReadPipe(pipe, &header, sizeof(header), timeoutMs))
+			return false;
+		if (header.payloadSize > CompilerWorker::MaxMessagePayloadSize)
+			return false;
+
+		resultType = header.type;
+		resultPayload.resize(header.payloadSize);
+		return header.payloadSize == 0 || ReadPipe(pipe, resultPayload.getData(), header.payloadSize, timeoutMs);
+	}
+}
+
+
+// CompilerWorkerConnection ////////////////////////////////////////////////////////////////////////
+
+bool CompilerWorkerConnection::launch(StringViewASCII executablePath, StringViewASCII libraryManifestFilePath, StringViewASCII pipeName,
+	bool useStubCompiler)
+{
+	XAssert(!isLaunched());
+
+	InplaceStringASCIIx4096 commandLine;
+	FmtPrintStr(commandLine, '"', executablePath, "\" --compiler-worker=", pipeName, " --manifest=\"", libraryManifestFilePath, '"');
+	if (useStubCompiler)
+		commandLine.append(" --compiler-worker-stub");
+	if (commandLine.isFull())
+		return false;
+
+	if (!process.create(commandLine.getCStr(), true))
+		return false;
+
+	InplaceStringASCIIx256 requestPipePath;
+	InplaceStringASCIIx256 responsePipePath;
+	ComposePipePath(requestPipePath, pipeName, ".Requests");
+	ComposePipePath(responsePipePath, pipeName, ".Responses");
+
+	// Worker creates pipes. Poll until it does or dies.
+	const uint32 startTimeMs = Timer::GetCurrentTimeMs();
+	while (!requestPipe.open(requestPipePath.getCStr()))
+	{
+		if (!process.isRunning() || Timer::GetCurrentTimeMs() - startTimeMs > WorkerConnectionTimeoutMs)
+		{
+			kill();
+			return false;
+		}
+		Thread::Sleep(1);
+	}
+	while (!responsePipe.open(responsePipePath.getCStr(), true))
+	{
+		if (!process.isRunning() || Timer::GetCurrentTimeMs() - startTimeMs > WorkerConnectionTimeoutMs)
+		{
+			kill();
+			return false;
+		}
+		Thread::Sleep(1);
+	}
+
+	CompilerWorkerMessageType messageType = CompilerWorkerMessageType::None;
+	if (!ReceiveMessage(responsePipe, messageType, receiveBuffer, WorkerConnectionTimeoutMs) || messageType != CompilerWorkerMessageType::Hello)
+	{
+		kill();
+		return false;
+	}
+
+	MessageReader reader(receiveBuffer);
+	const uint32 magic = reader.read<uint32>();
+	if (!reader.isValid() || magic != CompilerWorker::ProtocolMagic)
+	{
+		kill();
+		return false;
+	}
+
+	return true;
+}
+
+void CompilerWorkerConnection::shutdown()
+{
+	if (!process.isInitialized())
+		return;
+
+	// Worker exits when request pipe is closed.
+	requestPipe.destroy();
+	if (!process.wait(WorkerShutdownTimeoutMs))
+		process.terminate();
+
+	responsePipe.destroy();
+	process.destroy();
+}
+
+void CompilerWorkerConnection::kill()
+{
+	if (process.isInitialized())
+	{
+		process.terminate();
+		process.wait();
+		process.destroy();
+	}
+	requestPipe.destroy();
+	responsePipe.destroy();
+}
+
+bool CompilerWorkerConnection::sendCompileRequest(const CompilerWorkerCompileRequest& request)
+{
+	MessageWriter writer(sendBuffer, CompilerWorkerMessageType::CompileRequest);
+	writer.write(request.requestId);
+	writer.writeString(request.mainSourceFilePath);
+	writer.writeString(request.mainSourceFileText);
+	writer.writeString(request.compilationArgs.entryPointName);
+	writer.write(request.compilationArgs.shaderType);
+	writer.write(request.pipelineLayoutNameXSH);
+	writer.write(request.pipelineLayoutSourceHash);
+	return writer.send(requestPipe);
+}
+
+bool CompilerWorkerConnection::sendIncludeResponse(bool status, StringViewASCII includeFileText)
+{
+	MessageWriter writer(sendBuffer, CompilerWorkerMessageType::IncludeResponse);
+	writer.write(uint8(status));
+	writer.writeString(includeFileText);
+	return writer.send(requestPipe);
+}
+
+bool CompilerWorkerConnection::receive(CompilerWorkerReceivedMessage& message, uint32 timeoutMs)
+{
+	message = {};
+
+	if (!ReceiveMessage(responsePipe, message.type, receiveBuffer, timeoutMs))
+		return false;
+
+	MessageReader reader(receiveBuffer);
+	message.requestId = reader.read<uint32>();
+
+	if (message.type == CompilerWorkerMessageType::IncludeRequest)
+	{
+		message.includeFilePath = reader.readString();
+	}
+	else if (message.type == CompilerWorkerMessageType::CompileResponse)
+	{
+		HAL::ShaderCompiler::ShaderCompilationResult::ComposerSource composerSrc = {};
+		composerSrc.status = reader.read<HAL::ShaderCompiler::ShaderCompilationStatus>();
+		composerSrc.preprocessorStdOut = reader.readString();
+		composerSrc.compilerStdOut = reader.readString();
+		const HAL::ShaderCompiler::BlobRef preprocessedSourceBlob = reader.readBlob();
+		const HAL::ShaderCompiler::BlobRef bytecodeBlob = reader.readBlob();
+		composerSrc.preprocessedSourceBlob = preprocessedSourceBlob.get();
+		composerSrc.bytecodeBlob = bytecodeBlob.get();
+		message.compilationTime = reader.read<float32>();
+
+		if (reader.isValid())
+			message.compilationResult = HAL::ShaderCompiler::ShaderCompilationResult::Compose(composerSrc);
+	}
+	else
+		return false;
+
+	return reader.isValid();
+}
+
+
+// CompilerWorker //////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// Requests are received on separate thread, so host never blocks writing to request pipe.
+	class WorkerInbox : public NonCopyable
+	{
+	private:
+		Lock lock;
+		volatile uint32 version = 0; // Incremented on every change. Waiters park on it.
+
+		ArrayList<ArrayList<byte>> compileRequests;
+		uint32 compileRequestsReadIndex = 0;
+
+		// Only one include request is in flight at any time.
+		ArrayList<byte> includeResponse;
+		bool includeResponseReceived = false;
+
+		bool closed = false;
+
+	private:
+		inline void notify()
+		{
+			version = version + 1;
+			lock.unlock();
+			AddressWait::WakeAll(&version);
+		}
+
+		template <typename Predicate>
+		inline bool waitUntil(Predicate predicate)
+		{
+			for (;;)
+			{
+				lock.lock();
+				if (predicate())
+					return true; // Locked.
+				if (closed)
+				{
+					lock.unlock();
+					return false;
+				}
+				const uint32 observedVersion = version;
+				lock.unlock();
+				AddressWait::Wait(&version, observedVersion);
+			}
+		}
+
+	public:
+		WorkerInbox() = default;
+		~WorkerInbox() = default;
+
+		inline void pushCompileRequest(ArrayList<byte>&& payload)
+		{
+			lock.lock();
+			compileRequests.emplaceBack(AsRValue(payload));
+			notify();
+		}
+
+		inline void pushIncludeResponse(ArrayList<byte>&& payload)
+		{
+			lock.lock();
+			XAssert(!includeResponseReceived);
+			includeResponse = AsRValue(payload);
+			includeResponseReceived = true;
+			notify();
+		}
+
+		inline void close()
+		{
+			lock.lock();
+			closed = true;
+			notify();
+		}
+
+		// Returns false if host closed connection.
+		inline bool popCompileRequest(ArrayList<byte>& resultPayload)
+		{
+			if (!waitUntil([this]() { return compileRequestsReadIndex < compileRequests.getSize(); }))
+				return false;
+
+			resultPayload = AsRValue(compileRequests[compileRequestsReadIndex]);
+			compileRequestsReadIndex++;
+			if (compileRequestsReadIndex == compileRequests.getSize())
+			{
+				compileRequests.clear();
+				compileRequestsReadIndex = 0;
+			}
+			lock.unlock();
+			return true;
+		}
+
+		inline bool popIncludeResponse(ArrayList<byte>& resultPayload)
+		{
+			if (!waitUntil([this]() { return includeResponseReceived; }))
+				return false;
+
+			resultPayload = AsRValue(includeResponse);
+			includeResponseReceived = false;
+			lock.unlock();
+			return true;
+		}
+	};
+
+	struct WorkerContext
+	{
+		NamedPipe requestPipe;
+		NamedPipe responsePipe;
+		WorkerInbox inbox;
+		Library library;
+
+		ArrayList<byte> responseBuffer;
+		ArrayList<byte> includeResponsePayload;
+		uint32 currentRequestId;
+		bool useStubCompiler;
+	};
+
+	uint32 __stdcall WorkerReceiverThreadMain(WorkerContext* context)
+	{
+		for (;;)
+		{
+			CompilerWorkerMessageType type = CompilerWorkerMessageType::None;
+			ArrayList<byte> payload;
+			if (!ReceiveMessage(context->requestPipe, type, payload))
+				break;
+
+			if (type == CompilerWorkerMessageType::CompileRequest)
+				context->inbox.pushCompileRequest(AsRValue(payload));
+			else if (type == CompilerWorkerMessageType::IncludeResponse)
+				context->inbox.pushIncludeResponse(AsRValue(payload));
+			else
+				break;
+		}
+
+		context->inbox.close();
+		return 0;
+	}
+
+	HAL::ShaderCompiler::IncludeResolutionResult ResolveIncludeViaHost(void* voidContext, StringViewASCII includeFilePath)
+	{
+		WorkerContext& context = *(WorkerContext*)voidContext;
+
+		MessageWriter writer(context.responseBuffer, CompilerWorkerMessageType::IncludeRequest);
+		writer.write(context.currentRequestId);
+		writer.writeString(includeFilePath);
+		if (!writer.send(context.responsePipe))
+			return HAL::ShaderCompiler::IncludeResolutionResult{ .status = false, };
+
+		if (!context.inbox.popIncludeResponse(context.includeResponsePayload))
+			return HAL::ShaderCompiler::IncludeResolutionResult{ .status = false, };
+
+		// Text stays in `includeResponsePayload` until next include is requested.
+		// DXC copies include text into its own blob before that happens.
+		MessageReader reader(context.includeResponsePayload);
+		const bool status = reader.read<uint8>() != 0;
+		const StringViewASCII text = reader.readString();
+		if (!reader.isValid() || !status)
+			return HAL::ShaderCompiler::IncludeResolutionResult{ .status = false, };
+
+		return HAL::ShaderCompiler::IncludeResolutionResult{ .text = text, .status = true, };
+	}
+
+	const HAL::ShaderCompiler::PipelineLayout* FindPipelineLayout(const Library& library, uint64 nameXSH, uint32 sourceHash)
+	{
+		for (const Library::PipelineLayout& pipelineLayout : library.pipelineLayouts)
+		{
+			if (pipelineLayout.nameXSH == nameXSH)
+				return pipelineLayout.ref->getSourceHash() == sourceHash ? pipelineLayout.ref.get() : nullptr;
+		}
+		return nullptr;
+	}
+
+	// Stub compiler. See `CompilerWorker.h` for supported source lines.
+
+	constexpr uint8 StubCompilerMaxIncludeDepth = 16;
+	constexpr uint32 StubCompilerHangSleepTimeMs = 60'000;
+	constexpr int StubCompilerCrashExitCode = 3;
+
+	bool StubCompilerProcessText(WorkerContext& context, StringViewASCII text, uint8 includeDepth,
+		ArrayList<byte>& resultBytecode, DynamicStringASCII& resultStdOut)
+	{
+		static constexpr StringViewASCII IncludePrefix = StringViewASCII::FromCStr("#include \"");
+		static constexpr StringViewASCII CrashOncePrefix = StringViewASCII::FromCStr("#crash-once ");
+
+		const char* lineBegin = text.begin();
+		while (lineBegin != text.end())
+		{
+			const char* lineEnd = lineBegin;
+			while (lineEnd != text.end() && *lineEnd != '\n')
+				lineEnd++;
+
+			StringViewASCII line(lineBegin, lineEnd);
+			if (line.endsWith('\r'))
+				line = line.getSubString(0, line.getLength() - 1);
+			lineBegin = lineEnd == text.end() ? lineEnd : lineEnd + 1;
+
+			if (line.startsWith(IncludePrefix) && line.endsWith('"') && line.getLength() > IncludePrefix.getLength())
+			{
+				const StringViewASCII includeFilePath = line.getSubString(IncludePrefix.getLength(), line.getLength() - IncludePrefix.getLength() - 1);
+				if (includeDepth >= StubCompilerMaxIncludeDepth)
+				{
+					FmtPrintStr(resultStdOut, "error: stub compiler: include depth limit exceeded at '", includeFilePath, "'\n");
+					return false;
+				}
+
+				const HAL::ShaderCompiler::IncludeResolutionResult include = ResolveIncludeViaHost(&context, includeFilePath);
+				if (!include.status)
+				{
+					FmtPrintStr(resultStdOut, "error: stub compiler: cannot open include file '", includeFilePath, "'\n");
+					return false;
+				}
+
+				// Include text is valid only until next include is requested.
+				const DynamicStringASCII includeText = include.text;
+				const uint32 offset = resultBytecode.getSize();
+				resultBytecode.resize(offset + includeText.getLength());
+				memoryCopy(resultBytecode.getData() + offset, includeText.getView().getData(), includeText.getLength());
+
+				if (!StubCompilerProcessText(context, includeText.getView(), includeDepth + 1, resultBytecode, resultStdOut))
+					return false;
+			}
+			else if (line == "#crash")
+			{
+				_Exit(StubCompilerCrashExitCode);
+			}
+			else if (line.startsWith(CrashOncePrefix))
+			{
+				InplaceStringASCIIx1024 markerFilePath = line.getSubString(CrashOncePrefix.getLength());
+				if (FileSystem::GetEntryType(markerFilePath.getCStr()).value != FileSystemEntryType::File)
+				{
+					File markerFile;
+					markerFile.open(markerFilePath.getCStr(), FileAccessMode::Write, FileOpenMode::Override);
+					markerFile.close();
+					_Exit(StubCompilerCrashExitCode);
+				}
+			}
+			else if (line == "#hang")
+			{
+				for (;;)
+					Thread::Sleep(StubCompilerHangSleepTimeMs);
+			}
+		}
+
+		return true;
+	}
+
+	HAL::ShaderCompiler::ShaderCompilationResultRef StubCompileShader(WorkerContext& context, StringViewASCII mainSourceFileText)
+	{
+		ArrayList<byte> bytecode;
+		bytecode.resize(XCheckedCastU32(mainSourceFileText.getLength()));
+		memoryCopy(bytecode.getData(), mainSourceFileText.getData(), mainSourceFileText.getLength());
+
+		DynamicStringASCII stdOut;
+		const bool status = StubCompilerProcessText(context, mainSourceFileText, 0, bytecode, stdOut);
+
+		HAL::ShaderCompiler::BlobRef bytecodeBlob = nullptr;
+		if (status && bytecode.getSize())
+		{
+			bytecodeBlob = HAL::ShaderCompiler::Blob::Create(bytecode.getSize());
+			memoryCopy((void*)bytecodeBlob->getData(), bytecode.getData(), bytecode.getSize());
+		}
+
+		HAL::ShaderCompiler::ShaderCompilationResult::ComposerSource composerSrc = {};
+		composerSrc.status = status ? HAL::ShaderCompiler::ShaderCompilationStatus::Success : HAL::ShaderCompiler::ShaderCompilationStatus::PreprocessingError;
+		composerSrc.preprocessorStdOut = stdOut.getView();
+		composerSrc.bytecodeBlob = bytecodeBlob.get();
+		return HAL::ShaderCompiler::ShaderCompilationResult::Compose(composerSrc);
+	}
+
+	bool ProcessCompileRequest(WorkerContext& context, const ArrayList<byte>& requestPayload)
+	{
+		MessageReader reader(requestPayload);
+		CompilerWorkerCompileRequest request = {};
+		request.requestId = reader.read<uint32>();
+		request.mainSourceFilePath = reader.readString();
+		request.mainSourceFileText = reader.readString();
+		request.compilationArgs.entryPointName = reader.readString();
+		request.compilationArgs.shaderType = reader.read<HAL::ShaderType>();
+		request.pipelineLayoutNameXSH = reader.read<uint64>();
+		request.pipelineLayoutSourceHash = reader.read<uint32>();
+		if (!reader.isValid())
+			return false;
+
+		context.currentRequestId = request.requestId;
+
+		const TimerRecord startTime = Timer::GetRecord();
+
+		HAL::ShaderCompiler::ShaderCompilationResultRef result = nullptr;
+		if (context.useStubCompiler)
+		{
+			result = StubCompileShader(context, request.mainSourceFileText);
+		}
+		else if (const HAL::ShaderCompiler::PipelineLayout* pipelineLayout =
+			FindPipelineLayout(context.library, request.pipelineLayoutNameXSH, request.pipelineLayoutSourceHash))
+		{
+			result = HAL::ShaderCompiler::CompileShader(request.mainSourceFilePath, request.mainSourceFileText,
+				request.compilationArgs, *pipelineLayout, ResolveIncludeViaHost, &context);
+		}
+		else
+		{
+			HAL::ShaderCompiler::ShaderCompilationResult::ComposerSource composerSrc = {};
+			composerSrc.status = HAL::ShaderCompiler::ShaderCompilationStatus::CompilerCallFailed;
+			composerSrc.compilerStdOut = StringViewASCII::FromCStr("error: compiler worker: pipeline layout does not match the one in library manifest");
+			result = HAL::ShaderCompiler::ShaderCompilationResult::Compose(composerSrc);
+		}
+
+		const float32 compilationTime = Timer::GetTimeDelta(startTime);
+
+		MessageWriter writer(context.responseBuffer, CompilerWorkerMessageType::CompileResponse);
+		writer.write(request.requestId);
+		writer.write(result->getStatus());
+		writer.writeString(result->getPreprocessorStdOut());
+		writer.writeString(result->getCompilerStdOut());
+		writer.writeBlob(result->getPreprocessedSourceBlob());
+		writer.writeBlob(result->getBytecodeBlob());
+		writer.write(compilationTime);
+		return writer.send(context.responsePipe);
+	}
+}
+
+int CompilerWorker::Run(StringViewASCII pipeName, const char* libraryManifestFilePathCStr, bool useStubCompiler)
+{
+	WorkerContext context;
+	context.useStubCompiler = useStubCompiler;
+
+	if (!useStubCompiler && !LibraryManifestLoader::Load(context.library, libraryManifestFilePathCStr))
+		return 1;
+
+	InplaceStringASCIIx256 requestPipePath;
+	InplaceStringASCIIx256 responsePipePath;
+	ComposePipePath(requestPipePath, pipeName, ".Requests");
+	ComposePipePath(responsePipePath, pipeName, ".Responses");
+
+	// Blocking pipes. Request pipe is read only by receiver thread, response pipe is written only by main thread.
+	if (!context.requestPipe.create(requestPipePath.getCStr(), PipeBufferSize, PipeBufferSize, false) ||
+		!context.responsePipe.create(responsePipePath.getCStr(), PipeBufferSize, PipeBufferSize, false))
+		return 1;
+	if (!context.requestPipe.connect() || !context.responsePipe.connect())
+		return 1;
+
+	{
+		MessageWriter writer(context.responseBuffer, CompilerWorkerMessageType::Hello);
+		writer.write(ProtocolMagic);
+		if (!writer.send(context.responsePipe))
+			return 1;
+	}
+
+	Thread receiverThread;
+	receiverThread.create(&WorkerReceiverThreadMain, &context);
+
+	ArrayList<byte> requestPayload;
+	while (context.inbox.popCompileRequest(requestPayload))
+	{
+		if (!ProcessCompileRequest(context, requestPayload))
+			break;
+	}
+
+	// Host closed request pipe or something went wrong. In latter case host sees closed response pipe,
+	// treats worker as crashed and closes request pipe, which stops receiver thread.
+	context.responsePipe.destroy();
+	receiverThread.wait();
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <XLib.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.NonCopyable.h>
+#include <XLib.String.h>
+#include <XLib.System.NamedPipe.h>
+#include <XLib.System.Process.h>
+
+#include <XEngine.Gfx.HAL.ShaderCompiler.h>
+
+// Out-of-process shader compilation. Compiler crash or leak affects only worker process, which is
+// restarted by host. Worker is builder executable itself started with `--compiler-worker=<pipe name>`.
+//
+// Host and worker are connected by two byte mode named pipes, one per direction. Worker reads
+// requests on separate thread into local queue, so host can send next request while current one is
+// still being compiled and neither side blocks on write while the other one is also writing.
+//
+// Every message is `MessageHeader` followed by payload:
+//   worker -> host: Hello (once, right after connection), IncludeRequest, CompileResponse
+//   host -> worker: CompileRequest, IncludeResponse
+// Worker processes compile requests strictly in order they were sent. While compiling, it sends
+// IncludeRequest for every include and waits for corresponding IncludeResponse, so include
+// resolution (and dependency tracking) stays on host side.
+//
+// Host does not wait for worker forever. Worker that does not send anything for response timeout
+// is treated as crashed. Request that crashes worker `MaxCompileAttemptCount` times is failed.
+//
+// With `--compiler-worker-stub` worker does not load manifest and runs stub compiler instead of DXC,
+// so protocol can be tested without real shaders. Stub bytecode is main source text followed by
+// texts of all includes in resolution order. Stub understands these source lines:
+//   #include "<path>"    resolved via host, included text is processed the same way
+//   #crash               worker exits without responding
+//   #crash-once <path>   same, unless file at <path> exists (it is created before exiting)
+//   #hang                worker stops responding
+// `--compiler-worker-test=<temp dir path>` runs host side against stub workers and reports what fails.
+
+namespace XEngine::Gfx::ShaderLibraryBuilder
+{
+	enum class CompilerWorkerMessageType : uint32
+	{
+		None = 0,
+		Hello,
+		CompileRequest,
+		CompileResponse,
+		IncludeRequest,
+		IncludeResponse,
+	};
+
+	struct CompilerWorkerMessageHeader
+	{
+		CompilerWorkerMessageType type;
+		uint32 payloadSize;
+	};
+
+	struct CompilerWorkerCompileRequest
+	{
+		uint32 requestId;
+		XLib::StringViewASCII mainSourceFilePath;
+		XLib::StringViewASCII mainSourceFileText;
+		HAL::ShaderCompiler::ShaderCompilationArgs compilationArgs;
+
+		// Worker loads the same library manifest and looks pipeline layout up by name.
+		// Source hash is used to check that both sides see the same layout.
+		uint64 pipelineLayoutNameXSH;
+		uint32 pipelineLayoutSourceHash;
+	};
+
+	struct CompilerWorkerReceivedMessage
+	{
+		CompilerWorkerMessageType type;
+		uint32 requestId;
+
+		// IncludeRequest. Valid until next `receive`.
+		XLib::StringViewASCII includeFilePath;
+
+		// CompileResponse.
+		HAL::ShaderCompiler::ShaderCompilationResultRef compilationResult;
+		float32 compilationTime;
+	};
+
+	// Host side of connection to single worker process. Not thread safe.
+	class CompilerWorkerConnection : public XLib::NonCopyable
+	{
+	private:
+		XLib::Process process;
+		XLib::NamedPipe requestPipe;
+		XLib::NamedPipe responsePipe;
+		XLib::ArrayList<byte> sendBuffer;
+		XLib::ArrayList<byte> receiveBuffer;
+
+	public:
+		CompilerWorkerConnection() = default;
+		inline ~CompilerWorkerConnection() { shutdown(); }
+
+		// Starts worker process and waits until it connects. Pipe name should be unique on machine.
+		bool launch(XLib::StringViewASCII executablePath, XLib::StringViewASCII libraryManifestFilePath, XLib::StringViewASCII pipeName,
+			bool useStubCompiler = false);
+
+		// Lets worker exit gracefully. Terminates it if it does not.
+		void shutdown();
+		void kill();
+
+		bool sendCompileRequest(const CompilerWorkerCompileRequest& request);
+		bool sendIncludeResponse(bool status, XLib::StringViewASCII includeFileText);
+
+		// Blocks until worker sends something. Returns false if connection is lost (worker crashed)
+		// or nothing is received in `timeoutMs` (worker hung). Connection should be killed after that.
+		bool receive(CompilerWorkerReceivedMessage& message, uint32 timeoutMs);
+
+		inline bool isLaunched() { return requestPipe.isInitialized(); }
+	};
+
+	class CompilerWorker abstract final
+	{
+	public:
+		static constexpr uint32 ProtocolMagic = 0x5C3A91E7; // Change this number after changing the protocol.
+		static constexpr uint32 MaxMessagePayloadSize = 256 * 1024 * 1024;
+		static constexpr uint32 DefaultResponseTimeoutMs = 5 * 60'000; // Single message, not whole compilation.
+		static constexpr uint8 MaxCompileAttemptCount = 2;
+
+		// Worker process entry point. Returns process exit code.
+		static int Run(XLib::StringViewASCII pipeName, const char* libraryManifestFilePathCStr, bool useStubCompiler);
+	};
+}
@@ -170,8 +170,12 @@ bool LoadTextFile(const char* pathCStr, DynamicStringASCII& text)
 
 void LibraryManifestLoader::reportError(const char* message, Cursor jsonCursor)
 {
+	uint32 lineNumber = 0;
+	uint32 columnNumber = 0;
+	jsonReader.getLineColumnNumbers(jsonCursor.offset, lineNumber, columnNumber);
+
 	// TODO: Print absolute path.
-	FmtPrintStdOut(jsonPathCStr, ':', jsonCursor.lineNumber, ':', jsonCursor.columnNumber,
+	FmtPrintStdOut(jsonPathCStr, ':', lineNumber, ':', columnNumber,
 		": error: ", message, '\n');
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <XLib.h>
+#include <XLib.Allocation.h>
 #include <XLib.Containers.ArrayList.h>
 #include <XLib.JSON.h>
 #include <XLib.NonCopyable.h>
@@ -16,8 +17,7 @@ namespace XEngine::Gfx::ShaderLibraryBuilder
 	private:
 		struct Cursor
 		{
-			uint32 lineNumber;
-			uint32 columnNumber;
+			uintptr offset; // Line/column are resolved only when error is reported.
 		};
 
 		struct StaticSamplerDesc
@@ -32,7 +32,9 @@ namespace XEngine::Gfx::ShaderLibraryBuilder
 		XLib::JSONReader jsonReader;
 		const char* jsonPathCStr = nullptr;
 
-		XLib::ArrayList<StaticSamplerDesc> staticSamplers;	// TODO: Replace with FlatHashMap.
+		// All manifest scratch data lives only during `load`, so arena is released in one go.
+		XLib::MultiBlockLinearAllocator scratchAllocator;
+		XLib::ArrayList<StaticSamplerDesc, uint32, true, XLib::MultiBlockLinearAllocator> staticSamplers;	// TODO: Replace with FlatHashMap.
 
 	private:
 		void reportError(const char* message, Cursor jsonCursor);
@@ -48,10 +50,10 @@ namespace XEngine::Gfx::ShaderLibraryBuilder
 		bool readPipelineLayout(XLib::StringViewASCII pipelineLayoutName, Cursor jsonPipelineLayoutNameCursor);
 		bool readShader(XLib::StringViewASCII shaderName, Cursor jsonShaderNameCursor, HAL::ShaderType shaderType);
 
-		inline Cursor getJSONCursor() const { return Cursor { jsonReader.getLineNumer(), jsonReader.getColumnNumer() }; };
+		inline Cursor getJSONCursor() const { return Cursor { jsonReader.getOffset() }; };
 
 	private:
-		inline LibraryManifestLoader(Library& library) : library(library) {}
+		inline LibraryManifestLoader(Library& library) : library(library), staticSamplers(scratchAllocator) {}
 		~LibraryManifestLoader() = default;
 
 		bool load(const char* jsonPathCStr);
@@ -0,0 +1,523 @@
+#include <algorithm>
+
+#include <XLib.CharStream.h>
+#include <XLib.FileSystem.h>
+#include <XLib.Fmt.h>
+#include <XLib.Path.h>
+#include <XLib.System.File.h>
+#include <XLib.System.Process.h>
+
+#include "XEngine.Gfx.ShaderLibraryBuilder.ShaderCache.h"
+
+using namespace XLib;
+using namespace XEngine::Gfx;
+using namespace XEngine::Gfx::ShaderLibraryBuilder;
+
+namespace
+{
+	static constexpr uint32 ManifestFileSignature = 0x7A1C52E5;
+	static constexpr uint32 ObjectFileSignature = 0x3B96D0C1;
+
+	static constexpr const char* ManifestsDirName = "Manifests";
+	static constexpr const char* ObjectsDirName = "Objects";
+
+	struct ManifestFileHeader // 16 bytes
+	{
+		uint32 signature;
+		uint32 compilerMagic;
+		uint32 closureCount;
+		uint32 bodyCRC32C; // Closures one after another, most recently stored first.
+	};
+
+	struct ManifestClosureHeader // 24 bytes. Followed by source file records and paths data padded to 8 bytes.
+	{
+		uint64 objectKeyHash0;
+		uint64 objectKeyHash1;
+		uint32 sourceFileCount;
+		uint32 pathsDataSize;
+	};
+
+	struct ManifestSourceFileRecord // 24 bytes
+	{
+		uint64 textHash0;
+		uint64 textHash1;
+		uint32 pathOffset;
+		uint16 pathLength;
+		uint8 isRelativeToLibraryRoot;
+		uint8 _padding;
+	};
+
+	struct ObjectFileHeader // 16 bytes
+	{
+		uint32 signature;
+		uint32 compilerMagic;
+		uint32 blobSize;
+		uint32 blobCRC32C;
+	};
+
+	static_assert(sizeof(ManifestFileHeader) == 16);
+	static_assert(sizeof(ManifestClosureHeader) == 24);
+	static_assert(sizeof(ManifestSourceFileRecord) == 24);
+	static_assert(sizeof(ObjectFileHeader) == 16);
+
+	bool ReadWholeFile(const char* pathCStr, ArrayList<byte>& resultData)
+	{
+		File file;
+		if (!file.open(pathCStr, FileAccessMode::Read, FileOpenMode::OpenExisting))
+			return false;
+
+		const uint64 fileSize = file.getSize();
+		if (fileSize == uint64(-1) || fileSize >= uint64(uint32(-1)))
+			return false;
+
+		resultData.resize(uint32(fileSize));
+		return file.read(resultData.getData(), uintptr(fileSize));
+	}
+
+	inline uint64 GetManifestClosureSize(uint32 sourceFileCount, uint32 pathsDataSize)
+	{
+		return sizeof(ManifestClosureHeader) + uint64(sourceFileCount) * sizeof(ManifestSourceFileRecord) + alignUp<uint64>(pathsDataSize, 8);
+	}
+
+	// Returns null if manifest is missing or corrupted. Otherwise returns the first closure.
+	const byte* ReadManifestFile(const char* pathCStr, uint32 compilerMagic, ArrayList<byte>& resultData)
+	{
+		if (!ReadWholeFile(pathCStr, resultData))
+			return nullptr;
+		if (resultData.getSize() < sizeof(ManifestFileHeader))
+			return nullptr;
+
+		const ManifestFileHeader& header = *(const ManifestFileHeader*)resultData.getData();
+		if (header.signature != ManifestFileSignature ||
+			header.compilerMagic != compilerMagic ||
+			header.closureCount == 0)
+		{
+			return nullptr;
+		}
+
+		const byte* body = resultData.getData() + sizeof(ManifestFileHeader);
+		if (CRC32C::Compute(body, resultData.getSize() - sizeof(ManifestFileHeader)) != header.bodyCRC32C)
+			return nullptr;
+
+		return body;
+	}
+}
+
+struct ShaderCache::ManifestClosure
+{
+	const ManifestClosureHeader* header;
+	const ManifestSourceFileRecord* sourceFileRecords;
+	const char* pathsData;
+	uint32 size;
+
+	// Returns false if closure does not fit into the rest of manifest body.
+	inline bool read(const byte* data, const byte* dataEnd)
+	{
+		if (uintptr(dataEnd - data) < sizeof(ManifestClosureHeader))
+			return false;
+
+		header = (const ManifestClosureHeader*)data;
+		const uint64 closureSize = GetManifestClosureSize(header->sourceFileCount, header->pathsDataSize);
+		if (header->sourceFileCount == 0 || closureSize > uint64(dataEnd - data))
+			return false;
+
+		sourceFileRecords = (const ManifestSourceFileRecord*)(header + 1);
+		pathsData = (const char*)(sourceFileRecords + header->sourceFileCount);
+		size = uint32(closureSize);
+		return true;
+	}
+};
+
+bool ShaderCache::getSourceFileTextHash(SourceFileHandle sourceFile, ShaderCacheKey& resultHash)
+{
+	if (const ShaderCacheKey* existingHash = sourceFileTextHashes.find(sourceFile))
+	{
+		resultHash = *existingHash;
+		return true;
+	}
+
+	StringViewASCII text;
+	if (!sourceFileCache->getFileText(sourceFile, text))
+		return false;
+
+	ShaderCacheKeyBuilder keyBuilder;
+	keyBuilder.process(text.getData(), text.getLength());
+	resultHash = keyBuilder.getKey();
+
+	sourceFileTextHashes.insert(sourceFile, resultHash);
+	return true;
+}
+
+bool ShaderCache::checkManifestClosure(const Shader& shader, const ManifestClosure& closure,
+	ArrayList<SourceFileHandle>& resultSourceFiles, ShaderCacheKey& resultObjectKey)
+{
+	resultSourceFiles.clear();
+
+	// Object key is derived from text hashes, so it is not trusted from manifest.
+	ShaderCacheKeyBuilder objectKeyBuilder;
+	processShaderDetails(objectKeyBuilder, shader);
+
+	for (uint32 i = 0; i < closure.header->sourceFileCount; i++)
+	{
+		const ManifestSourceFileRecord& record = closure.sourceFileRecords[i];
+		if (uint64(record.pathOffset) + record.pathLength > closure.header->pathsDataSize)
+			return false;
+
+		InplaceStringASCIIx1024 sourceFilePath;
+		if (record.isRelativeToLibraryRoot)
+			sourceFilePath.append(libraryRootPath);
+		if (sourceFilePath.getLength() + record.pathLength >= sourceFilePath.GetMaxLength())
+			return false;
+		sourceFilePath.append(closure.pathsData + record.pathOffset, record.pathLength);
+
+		if (!Path::IsAbsolute(sourceFilePath))
+			return false;
+
+		const SourceFileHandle sourceFile = sourceFileCache->openFile(sourceFilePath);
+		if (sourceFile == SourceFileHandle(0))
+			return false;
+
+		ShaderCacheKey textHash = {};
+		if (!getSourceFileTextHash(sourceFile, textHash))
+			return false;
+		if (textHash != ShaderCacheKey { record.textHash0, record.textHash1 })
+			return false;
+
+		objectKeyBuilder.process(textHash);
+		resultSourceFiles.pushBack(sourceFile);
+	}
+
+	resultObjectKey = objectKeyBuilder.getKey();
+	return true;
+}
+
+void ShaderCache::processShaderDetails(ShaderCacheKeyBuilder& keyBuilder, const Shader& shader) const
+{
+	// Every field of `ShaderCompilationArgs` that affects compiled blob should be hashed here.
+	const HAL::ShaderCompiler::ShaderCompilationArgs& compilationArgs = shader.getCompilationArgs();
+
+	keyBuilder.process(compilerMagic);
+	keyBuilder.process(compilationArgs.entryPointName);
+	keyBuilder.process(compilationArgs.shaderType);
+	keyBuilder.process(shader.getPipelineLayout().getSourceHash());
+}
+
+void ShaderCache::composeEntryFilePath(VirtualStringRefASCII result, const char* kindDirName, ShaderCacheKey key, const char* filenameSuffix) const
+{
+	VirtualStringWriter resultWriter(result);
+	FmtPrint(resultWriter, storeDirPath, kindDirName, '/', FmtArgHex8(uint8(key.hash0 >> 56)), '/',
+		FmtArgHex64(key.hash0), FmtArgHex64(key.hash1), filenameSuffix);
+}
+
+bool ShaderCache::writeEntryFile(const char* pathCStr, const void* headerData, uint32 headerSize, const void* payloadData, uint32 payloadSize)
+{
+	FileSystem::CreateDirRecursive(Path::GetParent(pathCStr));
+
+	// Entry becomes visible to other builders only after it is completely written.
+	InplaceStringASCIIx1024 tmpPath;
+	FmtPrintStr(tmpPath, pathCStr, '.', Process::GetCurrentId(), ".tmp");
+	if (tmpPath.isFull())
+		return false;
+
+	File file;
+	if (!file.open(tmpPath.getCStr(), FileAccessMode::Write, FileOpenMode::Override))
+		return false;
+
+	const bool writeResult = file.write(headerData, headerSize) && file.write(payloadData, payloadSize);
+	file.close();
+
+	if (!writeResult || FileSystem::RenameFile(tmpPath.getCStr(), pathCStr, true) != FileSystemOpStatus::Success)
+	{
+		FileSystem::RemoveFile(tmpPath.getCStr());
+		return false;
+	}
+
+	storedByteCount += headerSize + payloadSize;
+	return true;
+}
+
+bool ShaderCache::open(StringViewASCII storeDirPath, uint64 maxStoreSize, uint32 compilerMagic,
+	StringViewASCII libraryRootPath, SourceFileCache& sourceFileCache)
+{
+	XAssert(!isOpen());
+
+	Path::MakeAbsolute(storeDirPath, this->storeDirPath);
+	Path::AddTrailingDirectorySeparator(this->storeDirPath);
+	if (this->storeDirPath.isFull())
+		return false;
+
+	Path::Normalize(libraryRootPath, this->libraryRootPath);
+	Path::AddTrailingDirectorySeparator(this->libraryRootPath);
+	if (this->libraryRootPath.isFull())
+		return false;
+
+	// TODO: Do propper uppercasing.
+	for (uint16 i = 0; i < this->libraryRootPath.getLength(); i++)
+		this->libraryRootPath[i] = Char::ToUpper(this->libraryRootPath[i]);
+
+	FileSystem::CreateDirRecursive(this->storeDirPath);
+
+	this->sourceFileCache = &sourceFileCache;
+	this->maxStoreSize = maxStoreSize;
+	this->compilerMagic = compilerMagic;
+	return true;
+}
+
+HAL::ShaderCompiler::BlobRef ShaderCache::lookup(const Shader& shader, ArrayList<SourceFileHandle>& resultSourceFiles)
+{
+	XAssert(isOpen());
+	resultSourceFiles.clear();
+
+	ShaderCacheKeyBuilder manifestKeyBuilder;
+	processShaderDetails(manifestKeyBuilder, shader);
+	manifestKeyBuilder.process(shader.getMainSourceFilePath());
+
+	InplaceStringASCIIx1024 manifestFilePath;
+	composeEntryFilePath(manifestFilePath, ManifestsDirName, manifestKeyBuilder.getKey(), "");
+
+	// Find the first closure whose source files still have the same text.
+	const byte* closureData = ReadManifestFile(manifestFilePath.getCStr(), compilerMagic, buffer);
+	if (!closureData)
+		return nullptr;
+
+	const ManifestFileHeader& manifestHeader = *(const ManifestFileHeader*)buffer.getData();
+	const byte* manifestEnd = buffer.getData() + buffer.getSize();
+
+	ShaderCacheKey objectKey = {};
+	bool closureFound = false;
+	for (uint32 i = 0; i < manifestHeader.closureCount && !closureFound; i++)
+	{
+		ManifestClosure closure = {};
+		if (!closure.read(closureData, manifestEnd))
+			break;
+		closureData += closure.size;
+
+		closureFound = checkManifestClosure(shader, closure, resultSourceFiles, objectKey);
+	}
+
+	if (!closureFound)
+	{
+		resultSourceFiles.clear();
+		return nullptr;
+	}
+
+	// Load and validate object.
+	InplaceStringASCIIx1024 objectFilePath;
+	composeEntryFilePath(objectFilePath, ObjectsDirName, objectKey, ".bin");
+
+	HAL::ShaderCompiler::BlobRef blob = nullptr;
+	{
+		File file;
+		if (!file.open(objectFilePath.getCStr(), FileAccessMode::Read, FileOpenMode::OpenExisting))
+			return nullptr;
+
+		ObjectFileHeader objectHeader = {};
+		if (!file.read(&objectHeader, sizeof(objectHeader)))
+			return nullptr;
+		if (objectHeader.signature != ObjectFileSignature ||
+			objectHeader.compilerMagic != compilerMagic ||
+			file.getSize() != sizeof(ObjectFileHeader) + uint64(objectHeader.blobSize))
+		{
+			return nullptr;
+		}
+
+		blob = HAL::ShaderCompiler::Blob::Create(objectHeader.blobSize);
+		if (!file.read((void*)blob->getData(), blob->getSize()))
+			return nullptr;
+		if (CRC32C::Compute(blob->getData(), blob->getSize()) != objectHeader.blobCRC32C)
+		{
+			file.close();
+			FileSystem::RemoveFile(objectFilePath.getCStr());
+			return nullptr;
+		}
+	}
+
+	// Update LRU timestamps.
+	FileSystem::TouchFile(manifestFilePath.getCStr());
+	FileSystem::TouchFile(objectFilePath.getCStr());
+
+	return blob;
+}
+
+void ShaderCache::store(const Shader& shader, const SourceFileHandle* sourceFiles, uint16 sourceFileCount, const HAL::ShaderCompiler::Blob& compiledBlob)
+{
+	XAssert(isOpen());
+	XAssert(sourceFileCount > 0);
+
+	ShaderCacheKeyBuilder manifestKeyBuilder;
+	processShaderDetails(manifestKeyBuilder, shader);
+	manifestKeyBuilder.process(shader.getMainSourceFilePath());
+
+	ShaderCacheKeyBuilder objectKeyBuilder;
+	processShaderDetails(objectKeyBuilder, shader);
+
+	// Compose new closure: header, source file records, paths data. Paths can only get shorter.
+	uint32 pathsDataSize = 0;
+	for (uint16 i = 0; i < sourceFileCount; i++)
+		pathsDataSize += uint32(sourceFileCache->getFilePath(sourceFiles[i]).getLength());
+
+	buffer.resize(uint32(GetManifestClosureSize(sourceFileCount, pathsDataSize)));
+	memorySet(buffer.getData(), 0, buffer.getSize());
+
+	ManifestClosureHeader* closureHeader = (ManifestClosureHeader*)buffer.getData();
+	ManifestSourceFileRecord* sourceFileRecords = (ManifestSourceFileRecord*)(closureHeader + 1);
+	char* pathsData = (char*)(sourceFileRecords + sourceFileCount);
+	uint32 pathsDataOffset = 0;
+
+	for (uint16 i = 0; i < sourceFileCount; i++)
+	{
+		ShaderCacheKey textHash = {};
+		if (!getSourceFileTextHash(sourceFiles[i], textHash))
+			return;
+		objectKeyBuilder.process(textHash);
+
+		// Paths relative to library root make manifest valid for every checkout.
+		StringViewASCII path = sourceFileCache->getFilePath(sourceFiles[i]);
+		const bool isRelativeToLibraryRoot = path.startsWith(libraryRootPath.getView());
+		if (isRelativeToLibraryRoot)
+			path = path.getSubString(libraryRootPath.getLength());
+
+		ManifestSourceFileRecord& record = sourceFileRecords[i];
+		record = {};
+		record.textHash0 = textHash.hash0;
+		record.textHash1 = textHash.hash1;
+		record.pathOffset = pathsDataOffset;
+		record.pathLength = XCheckedCastU16(path.getLength());
+		record.isRelativeToLibraryRoot = isRelativeToLibraryRoot ? 1 : 0;
+
+		memoryCopy(pathsData + pathsDataOffset, path.getData(), path.getLength());
+		pathsDataOffset += uint32(path.getLength());
+	}
+
+	const ShaderCacheKey objectKey = objectKeyBuilder.getKey();
+	closureHeader->objectKeyHash0 = objectKey.hash0;
+	closureHeader->objectKeyHash1 = objectKey.hash1;
+	closureHeader->sourceFileCount = sourceFileCount;
+	closureHeader->pathsDataSize = pathsDataOffset;
+	buffer.resize(uint32(GetManifestClosureSize(sourceFileCount, pathsDataOffset)));
+
+	// Object first, so manifest never points to missing object (unless GC removes it).
+	InplaceStringASCIIx1024 objectFilePath;
+	composeEntryFilePath(objectFilePath, ObjectsDirName, objectKey, ".bin");
+
+	if (FileSystem::GetFileModificationTime(objectFilePath.getCStr()) != InvalidTimePoint)
+	{
+		// The same source closure was already compiled (e.g. by another checkout).
+		FileSystem::TouchFile(objectFilePath.getCStr());
+	}
+	else
+	{
+		ObjectFileHeader objectHeader = {};
+		objectHeader.signature = ObjectFileSignature;
+		objectHeader.compilerMagic = compilerMagic;
+		objectHeader.blobSize = compiledBlob.getSize();
+		objectHeader.blobCRC32C = CRC32C::Compute(compiledBlob.getData(), compiledBlob.getSize());
+
+		if (!writeEntryFile(objectFilePath.getCStr(), &objectHeader, sizeof(objectHeader), compiledBlob.getData(), compiledBlob.getSize()))
+		{
+			FmtPrintStdOut("warning: failed to store shader cache entry '", objectFilePath, "'\n");
+			return;
+		}
+	}
+
+	InplaceStringASCIIx1024 manifestFilePath;
+	composeEntryFilePath(manifestFilePath, ManifestsDirName, manifestKeyBuilder.getKey(), "");
+
+	// New closure goes first, followed by closures already in manifest except the one with the same object.
+	// Closure stored concurrently by another builder can be lost, which only costs a recompilation.
+	uint32 closureCount = 1;
+	ArrayList<byte> prevManifestData;
+	if (const byte* prevClosureData = ReadManifestFile(manifestFilePath.getCStr(), compilerMagic, prevManifestData))
+	{
+		const ManifestFileHeader& prevManifestHeader = *(const ManifestFileHeader*)prevManifestData.getData();
+		const byte* prevManifestEnd = prevManifestData.getData() + prevManifestData.getSize();
+
+		for (uint32 i = 0; i < prevManifestHeader.closureCount && closureCount < MaxManifestClosureCount; i++)
+		{
+			ManifestClosure closure = {};
+			if (!closure.read(prevClosureData, prevManifestEnd))
+				break;
+
+			if (ShaderCacheKey { closure.header->objectKeyHash0, closure.header->objectKeyHash1 } != objectKey)
+			{
+				const uint32 offset = buffer.getSize();
+				buffer.resize(offset + closure.size);
+				memoryCopy(buffer.getData() + offset, prevClosureData, closure.size);
+				closureCount++;
+			}
+			prevClosureData += closure.size;
+		}
+	}
+
+	ManifestFileHeader manifestHeader = {};
+	manifestHeader.signature = ManifestFileSignature;
+	manifestHeader.compilerMagic = compilerMagic;
+	manifestHeader.closureCount = closureCount;
+	manifestHeader.bodyCRC32C = CRC32C::Compute(buffer.getData(), buffer.getSize());
+
+	if (!writeEntryFile(manifestFilePath.getCStr(), &manifestHeader, sizeof(manifestHeader), buffer.getData(), buffer.getSize()))
+		FmtPrintStdOut("warning: failed to store shader cache entry '", manifestFilePath, "'\n");
+}
+
+void ShaderCache::collectGarbage()
+{
+	// Store is shrunk below the limit, so GC does not have to run on every build.
+	static constexpr uint64 SizeAfterCollectionNumerator = 3;
+	static constexpr uint64 SizeAfterCollectionDenominator = 4;
+
+	if (!isOpen() || storedByteCount == 0)
+		return;
+
+	struct EntryFile
+	{
+		uint32 pathOffset;
+		TimePoint modTime;
+		uint64 size;
+	};
+
+	struct EnumerationContext
+	{
+		ArrayList<EntryFile> files;
+		DynamicStringASCII paths; // Zero terminated paths one after another.
+		uint64 totalSize;
+	};
+
+	EnumerationContext context;
+	context.totalSize = 0;
+
+	auto enumerationCallback = [](void* voidContext, const FileSystemEnumeratedFile& file) -> void
+	{
+		EnumerationContext& context = *(EnumerationContext*)voidContext;
+		context.files.pushBack(EntryFile { context.paths.getLength(), file.modificationTime, file.size });
+		context.paths.append(file.path);
+		context.paths.append('\0');
+		context.totalSize += file.size;
+	};
+
+	FileSystem::EnumerateFilesRecursive(storeDirPath.getCStr(), enumerationCallback, &context);
+	if (context.totalSize <= maxStoreSize)
+		return;
+
+	std::sort(context.files.begin(), context.files.end(),
+		[](const EntryFile& left, const EntryFile& right) -> bool { return left.modTime < right.modTime; });
+
+	const uint64 targetSize = maxStoreSize / SizeAfterCollectionDenominator * SizeAfterCollectionNumerator;
+	uint64 currentSize = context.totalSize;
+	uint32 removedFileCount = 0;
+
+	for (const EntryFile& file : context.files)
+	{
+		if (currentSize <= targetSize)
+			break;
+
+		// File may be in use by another builder. It will be removed next time.
+		if (FileSystem::RemoveFile(context.paths.getData() + file.pathOffset) == FileSystemOpStatus::Success)
+		{
+			currentSize -= file.size;
+			removedFileCount++;
+		}
+	}
+
+	FmtPrintStdOut("Shader cache: removed ", removedFileCount, " least recently used files (",
+		(context.totalSize - currentSize) >> 20, " MiB). Cache size is ", currentSize >> 20, " MiB\n");
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <XLib.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.Containers.HashMap.h>
+#include <XLib.CRC.h>
+#include <XLib.NonCopyable.h>
+#include <XLib.String.h>
+
+#include <XEngine.Gfx.HAL.ShaderCompiler.h>
+
+#include "XEngine.Gfx.ShaderLibraryBuilder.Shader.h"
+#include "XEngine.Gfx.ShaderLibraryBuilder.SourceFileCache.h"
+
+// ShaderCache is content-addressed store of compiled shaders. Unlike BuildDepsTrace, it does not
+// care about file modification times, so touching files or switching branches back and forth does
+// not cause recompilation. Store directory can be shared by several checkouts on the same machine.
+//
+// Store consists of two kinds of files, sharded into subdirectories by first byte of the key:
+//   Manifests/XX/<key> - keyed by compiler magic, main source file path (relative to library root),
+//     compilation args and pipeline layout hash. Lists up to `MaxManifestClosureCount` most recently
+//     stored include closures of the shader. Closure is list of all source files (main source file
+//     first, then includes in resolution order) with hashes of their text and key of the object.
+//   Objects/XX/<key>.bin - compiled blob keyed by compiler magic, compilation args, pipeline
+//     layout hash and text hashes of all source files in the order they were included.
+// Lookup reads the manifest and loads object of the first closure whose source files still have the
+// same text. Several closures per manifest make switching back and forth between versions that
+// include different files (A -> B -> A) hit the cache.
+// Files are written to temporary file and renamed, so concurrently running builders never see
+// partially written entries. File modification time is used as LRU timestamp.
+//
+// Keys are CRCs, which are linear and not cryptographic. They are good against accidental collisions
+// of real sources, but colliding sources can be constructed deliberately, so store should not be
+// shared with untrusted parties.
+
+namespace XEngine::Gfx::ShaderLibraryBuilder
+{
+	struct ShaderCacheKey
+	{
+		uint64 hash0;
+		uint64 hash1;
+
+		inline bool operator == (const ShaderCacheKey& that) const { return hash0 == that.hash0 && hash1 == that.hash1; }
+		inline bool operator != (const ShaderCacheKey& that) const { return !(*this == that); }
+	};
+
+	// CRC64 and CRC32C are hardware accelerated. Together with data size they give 128-bit key.
+	// Not a cryptographic hash (see above).
+	class ShaderCacheKeyBuilder
+	{
+	private:
+		XLib::CRC64 crc64;
+		XLib::CRC32C crc32c;
+		uint64 size = 0;
+
+	public:
+		inline void process(const void* data, uintptr dataSize) { crc64.process(data, dataSize); crc32c.process(data, dataSize); size += dataSize; }
+		inline void process(XLib::StringViewASCII string);
+		template <typename Type>
+		inline void process(const Type& data) { process(&data, sizeof(data)); }
+
+		inline ShaderCacheKey getKey() { return ShaderCacheKey { crc64.getValue(), (uint64(crc32c.getValue()) << 32) | uint32(size) }; }
+	};
+
+	// Not thread safe. Source file text hashes are computed once per run.
+	class ShaderCache : public XLib::NonCopyable
+	{
+	private:
+		XLib::InplaceStringASCIIx1024 storeDirPath;
+		XLib::InplaceStringASCIIx1024 libraryRootPath; // Normalized and uppercased, the same way `SourceFileCache` does.
+		SourceFileCache* sourceFileCache = nullptr;
+		uint64 maxStoreSize = 0;
+		uint32 compilerMagic = 0;
+
+		XLib::FlatHashMap<SourceFileHandle, ShaderCacheKey> sourceFileTextHashes;
+		XLib::ArrayList<byte> buffer;
+		uint64 storedByteCount = 0;
+
+	private:
+		struct ManifestClosure;
+
+	private:
+		bool getSourceFileTextHash(SourceFileHandle sourceFile, ShaderCacheKey& resultHash);
+		bool checkManifestClosure(const Shader& shader, const ManifestClosure& closure,
+			XLib::ArrayList<SourceFileHandle>& resultSourceFiles, ShaderCacheKey& resultObjectKey);
+
+		void processShaderDetails(ShaderCacheKeyBuilder& keyBuilder, const Shader& shader) const;
+		void composeEntryFilePath(XLib::VirtualStringRefASCII result, const char* kindDirName, ShaderCacheKey key, const char* filenameSuffix) const;
+		bool writeEntryFile(const char* pathCStr, const void* headerData, uint32 headerSize, const void* payloadData, uint32 payloadSize);
+
+	public:
+		static constexpr uint32 MaxManifestClosureCount = 16;
+
+	public:
+		ShaderCache() = default;
+		~ShaderCache() = default;
+
+		bool open(XLib::StringViewASCII storeDirPath, uint64 maxStoreSize, uint32 compilerMagic,
+			XLib::StringViewASCII libraryRootPath, SourceFileCache& sourceFileCache);
+
+		inline bool isOpen() const { return sourceFileCache != nullptr; }
+
+		// Returns null on miss. On hit also returns source files of the shader (main source file first).
+		HAL::ShaderCompiler::BlobRef lookup(const Shader& shader, XLib::ArrayList<SourceFileHandle>& resultSourceFiles);
+
+		void store(const Shader& shader, const SourceFileHandle* sourceFiles, uint16 sourceFileCount, const HAL::ShaderCompiler::Blob& compiledBlob);
+
+		// Removes least recently used entries if store exceeds size limit.
+		// Does nothing if nothing was stored during this run.
+		void collectGarbage();
+	};
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline void XEngine::Gfx::ShaderLibraryBuilder::ShaderCacheKeyBuilder::process(XLib::StringViewASCII string)
+{
+	const uint32 length = uint32(string.getLength());
+	process(length);
+	process(string.getData(), string.getLength());
+}
@@ -1,7 +1,9 @@
+#include <XLib.Containers.ArrayList.h>
 #include <XLib.FileSystem.h>
 #include <XLib.Fmt.h>
 #include <XLib.Path.h>
 #include <XLib.System.File.h>
+#include <XLib.System.Threading.Lock.h>
 
 #include "XEngine.Gfx.ShaderLibraryBuilder.SourceFileCache.h"
 
@@ -10,9 +12,10 @@ using namespace XEngine::Gfx::ShaderLibraryBuilder;
 
 XTODO("Implement proper SourceFileHandle. For now it is just pointer to binary tree node");
 
-enum class SourceFileCache::EntryTextState : uint8
+enum class SourceFileCache::EntryTextState : uint32
 {
 	NotLoaded = 0,
+	Loading,
 	Loaded,
 	LoadingFailed,
 };
@@ -38,6 +41,51 @@ static inline ordering CompareStringsOrderedCaseInsensitive(const StringViewASCI
 	return leftLength == rightLength ? ordering::equivalent : ordering::less;
 }
 
+// Returns true if `Path::Normalize` followed by uppercasing would not change the path.
+// Paths stored in the cache (and in BuildDepsTrace) always pass, which saves a round trip through `std::filesystem`.
+static bool IsPathNormalizedAndUppercase(const StringViewASCII& path)
+{
+	const uintptr length = path.getLength();
+	uintptr elementStart = 0;
+
+	for (uintptr i = 0; i <= length; i++)
+	{
+		const char c = i < length ? path[i] : '/';
+		if (c == '\\' || Char::ToUpper(c) != c)
+			return false;
+		if (c != '/')
+			continue;
+
+		// Empty (except root), "." and ".." elements are collapsed by normalization.
+		const uintptr elementLength = i - elementStart;
+		if (elementLength == 0 && i > 0 && i < length)
+			return false;
+		if (elementLength == 1 && path[elementStart] == '.')
+			return false;
+		if (elementLength == 2 && path[elementStart] == '.' && path[elementStart + 1] == '.')
+			return false;
+
+		elementStart = i + 1;
+	}
+
+	return true;
+}
+
+static void NormalizeAndUppercasePath(const StringViewASCII& path, InplaceStringASCIIx1024& result)
+{
+	if (IsPathNormalizedAndUppercase(path))
+	{
+		result.append(path);
+		return;
+	}
+
+	Path::Normalize(path, result);
+
+	// TODO: Do propper uppercasing.
+	for (uint16 i = 0; i < result.getLength(); i++)
+		result[i] = Char::ToUpper(result[i]);
+}
+
 static bool ReadTextFile(const char* path, DynamicStringASCII& resultText)
 {
 	resultText = {};
@@ -73,6 +121,29 @@ inline ordering SourceFileCache::EntriesSearchTreeComparator::Compare(const Entr
 	return CompareStringsOrderedCaseInsensitive(left.path, right);
 }
 
+auto SourceFileCache::AllocateEntry(StringViewASCII normalizedPath) -> Entry*
+{
+	const uintptr memoryBlockSize = sizeof(Entry) + normalizedPath.getLength() + 1;
+	void* memoryBlock = SystemHeapAllocator::Allocate(memoryBlockSize);
+	memorySet(memoryBlock, 0, memoryBlockSize);
+
+	memoryCopy((char*)memoryBlock + sizeof(Entry), normalizedPath.getData(), normalizedPath.getLength());
+
+	Entry& newEntry = *(Entry*)memoryBlock;
+	XConstruct(newEntry);
+	newEntry.path = StringViewASCII((char*)memoryBlock + sizeof(Entry), normalizedPath.getLength());
+	newEntry.modTime = InvalidTimePoint;
+	newEntry.textState.store(uint32(EntryTextState::NotLoaded));
+
+	return &newEntry;
+}
+
+void SourceFileCache::ReleaseEntry(Entry* entry)
+{
+	entry->~Entry();
+	SystemHeapAllocator::Release(entry);
+}
+
 SourceFileHandle SourceFileCache::openFile(StringViewASCII path)
 {
 	XAssert(Path::IsAbsolute(path));
@@ -80,34 +151,107 @@ SourceFileHandle SourceFileCache::openFile(StringViewASCII path)
 		return SourceFileHandle(0);
 
 	InplaceStringASCIIx1024 normalizedPath;
-	Path::Normalize(path, normalizedPath);
+	NormalizeAndUppercasePath(path, normalizedPath);
 
-	// TODO: Do propper uppercasing.
-	for (uint16 i = 0; i < normalizedPath.getLength(); i++)
-		normalizedPath[i] = Char::ToUpper(normalizedPath[i]);
+	lock.lock();
+	Entry* existingEntry = entrySearchTree.find(normalizedPath.getView());
+	lock.unlock();
 
-	if (Entry* existingEntry = entrySearchTree.find(normalizedPath.getView()))
+	if (existingEntry)
 		return SourceFileHandle(uint64(existingEntry));
 
 	const uint64 modTime = FileSystem::GetFileModificationTime(normalizedPath.getCStr());
 	if (modTime == InvalidTimePoint)
 		return SourceFileHandle(0);
 
-	const uintptr memoryBlockSize = sizeof(Entry) + normalizedPath.getLength() + 1;
-	void* memoryBlock = SystemHeapAllocator::Allocate(memoryBlockSize);
-	memorySet(memoryBlock, 0, memoryBlockSize);
+	Entry* newEntry = AllocateEntry(normalizedPath);
+	newEntry->modTime = modTime;
 
-	memoryCopy((char*)memoryBlock + sizeof(Entry), normalizedPath.getData(), normalizedPath.getLength());
+	lock.lock();
 
-	Entry& newEntry = *(Entry*)memoryBlock;
-	XConstruct(newEntry);
-	newEntry.path = StringViewASCII((char*)memoryBlock + sizeof(Entry), normalizedPath.getLength());
-	newEntry.modTime = modTime;
-	newEntry.textState = EntryTextState::NotLoaded;
+	// The same file may have been opened concurrently while lock was not held.
+	existingEntry = entrySearchTree.find(newEntry->path);
+	if (!existingEntry)
+		entrySearchTree.insert(*newEntry);
 
-	entrySearchTree.insert(newEntry);
+	lock.unlock();
 
-	return SourceFileHandle(uint64(memoryBlock));
+	if (existingEntry)
+	{
+		ReleaseEntry(newEntry);
+		return SourceFileHandle(uint64(existingEntry));
+	}
+	return SourceFileHandle(uint64(newEntry));
+}
+
+void SourceFileCache::openFiles(const StringViewASCII* paths, uint32 pathCount, SourceFileHandle* resultFileHandles)
+{
+	// Entries for files that are not in the cache yet are allocated upfront. Their zero terminated paths are used for the batch query.
+	ArrayList<Entry*> newEntries;
+	ArrayList<const char*> newEntryPathCStrs;
+	ArrayList<uint32> newEntryResultIndices;
+
+	for (uint32 i = 0; i < pathCount; i++)
+	{
+		resultFileHandles[i] = SourceFileHandle(0);
+
+		XAssert(Path::IsAbsolute(paths[i]));
+		if (!Path::HasFileName(paths[i]))
+			continue;
+
+		InplaceStringASCIIx1024 normalizedPath;
+		NormalizeAndUppercasePath(paths[i], normalizedPath);
+
+		lock.lock();
+		Entry* existingEntry = entrySearchTree.find(normalizedPath.getView());
+		lock.unlock();
+
+		if (existingEntry)
+		{
+			resultFileHandles[i] = SourceFileHandle(uint64(existingEntry));
+			continue;
+		}
+
+		Entry* newEntry = AllocateEntry(normalizedPath);
+		newEntries.pushBack(newEntry);
+		newEntryPathCStrs.pushBack(newEntry->path.getData());
+		newEntryResultIndices.pushBack(i);
+	}
+
+	if (newEntries.isEmpty())
+		return;
+
+	ArrayList<TimePoint> newEntryModTimes;
+	newEntryModTimes.resize(newEntries.getSize());
+	FileSystem::GetFileModificationTimes(newEntryPathCStrs.getData(), newEntryModTimes.getData(), newEntries.getSize());
+
+	lock.lock();
+
+	for (uint32 i = 0; i < newEntries.getSize(); i++)
+	{
+		Entry* newEntry = newEntries[i];
+		SourceFileHandle& resultFileHandle = resultFileHandles[newEntryResultIndices[i]];
+
+		if (newEntryModTimes[i] == InvalidTimePoint)
+		{
+			ReleaseEntry(newEntry);
+			continue;
+		}
+
+		// The same file may appear in the batch several times or be opened concurrently.
+		if (Entry* existingEntry = entrySearchTree.find(newEntry->path))
+		{
+			ReleaseEntry(newEntry);
+			resultFileHandle = SourceFileHandle(uint64(existingEntry));
+			continue;
+		}
+
+		newEntry->modTime = newEntryModTimes[i];
+		entrySearchTree.insert(*newEntry);
+		resultFileHandle = SourceFileHandle(uint64(newEntry));
+	}
+
+	lock.unlock();
 }
 
 StringViewASCII SourceFileCache::getFilePath(SourceFileHandle fileHandle) const
@@ -126,17 +270,36 @@ uint64 SourceFileCache::getFileModTime(SourceFileHandle fileHandle) const
 
 bool SourceFileCache::getFileText(SourceFileHandle fileHandle, XLib::StringViewASCII& resultText)
 {
+	XAssert(fileHandle != SourceFileHandle(0));
 	Entry* entry = (Entry*)uint64(fileHandle);
 
-	if (entry->textState == EntryTextState::NotLoaded)
+	// First requesting thread moves entry to `Loading` state and reads the file. Others wait for
+	// final state, which is stored after text.
+	uint32 textState = entry->textState.loadAcquire();
+	if (textState == uint32(EntryTextState::NotLoaded))
 	{
-		const bool readTextResult = ReadTextFile(entry->path.getData(), entry->text);
-		if (!readTextResult)
-			FmtPrintStdOut("error: failed to read contents of a file '", entry->path, "' (but the file seems to exist)\n");	
+		if (entry->textState.compareExchange(uint32(EntryTextState::NotLoaded), uint32(EntryTextState::Loading)))
+		{
+			DynamicStringASCII text;
+			const bool readTextResult = ReadTextFile(entry->path.getData(), text);
+			if (!readTextResult)
+				FmtPrintStdOut("error: failed to read contents of a file '", entry->path, "' (but the file seems to exist)\n");
+
+			entry->text = AsRValue(text);
+			textState = uint32(readTextResult ? EntryTextState::Loaded : EntryTextState::LoadingFailed);
+			entry->textState.storeRelease(textState);
+			AddressWait::WakeAll(&entry->textState.value);
+		}
+		else
+			textState = entry->textState.loadAcquire();
+	}
 
-		entry->textState = readTextResult ? EntryTextState::Loaded : EntryTextState::LoadingFailed;
+	while (textState == uint32(EntryTextState::Loading))
+	{
+		AddressWait::Wait(&entry->textState.value, uint32(EntryTextState::Loading));
+		textState = entry->textState.loadAcquire();
 	}
 
 	resultText = entry->text;
-	return entry->textState == EntryTextState::Loaded;
+	return textState == uint32(EntryTextState::Loaded);
 }
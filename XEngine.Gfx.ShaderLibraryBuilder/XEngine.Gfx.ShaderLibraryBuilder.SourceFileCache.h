@@ -4,15 +4,20 @@
 #include <XLib.Containers.BinaryTree.h>
 #include <XLib.NonCopyable.h>
 #include <XLib.String.h>
+#include <XLib.System.Threading.Atomics.h>
+#include <XLib.System.Threading.Lock.h>
 
 namespace XEngine::Gfx::ShaderLibraryBuilder
 {
 	enum class SourceFileHandle : uint64 {};
 
+	// Thread safe. Entries are never removed and file text is never changed after it was loaded,
+	// so returned paths and texts stay valid for the whole lifetime of the cache.
+	// Lock guards only entry search tree. File system queries and reads are done outside of it.
 	class SourceFileCache : public XLib::NonCopyable
 	{
 	private:
-		enum class EntryTextState : uint8;
+		enum class EntryTextState : uint32;
 
 		struct Entry
 		{
@@ -20,7 +25,7 @@ namespace XEngine::Gfx::ShaderLibraryBuilder
 			XLib::DynamicStringASCII text;
 			XLib::StringViewASCII path; // Zero terminated. Stored after `Entry` itself.
 			uint64 modTime;
-			EntryTextState textState = EntryTextState(0);
+			XLib::Atomic<uint32> textState; // `EntryTextState`. Text is published by release store.
 		};
 
 		struct EntriesSearchTreeComparator abstract final
@@ -33,6 +38,11 @@ namespace XEngine::Gfx::ShaderLibraryBuilder
 
 	private:
 		EntrySearchTree entrySearchTree;
+		XLib::Lock lock;
+
+	private:
+		static Entry* AllocateEntry(XLib::StringViewASCII normalizedPath);
+		static void ReleaseEntry(Entry* entry);
 
 	public:
 		SourceFileCache() = default;
@@ -40,8 +50,14 @@ namespace XEngine::Gfx::ShaderLibraryBuilder
 
 		SourceFileHandle openFile(XLib::StringViewASCII path);
 
+		// Same as calling `openFile` for every path, but modification times of files that are not
+		// in the cache yet are queried concurrently. Null handle is returned for files that do not exist.
+		void openFiles(const XLib::StringViewASCII* paths, uint32 pathCount, SourceFileHandle* resultFileHandles);
+
 		XLib::StringViewASCII getFilePath(SourceFileHandle fileHandle) const;
 		uint64 getFileModTime(SourceFileHandle fileHandle) const;
+
+		// Text is loaded on first request. Concurrent requests for the same file wait for it.
 		bool getFileText(SourceFileHandle fileHandle, XLib::StringViewASCII& resultText);
 	};
 }
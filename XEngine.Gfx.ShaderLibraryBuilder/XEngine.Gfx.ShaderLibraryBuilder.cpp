@@ -10,12 +10,20 @@
 #include <XLib.String.h>
 #include <XLib.System.Environment.h>
 #include <XLib.System.File.h>
+#include <XLib.System.Process.h>
+#include <XLib.System.Threading.h>
+#include <XLib.System.Threading.Atomics.h>
+#include <XLib.System.Threading.Lock.h>
+#include <XLib.System.Timer.h>
 
 #include <XEngine.Gfx.ShaderLibraryFormat.h>
+#include <XEngine.XStringHash.h>
 
 #include "XEngine.Gfx.ShaderLibraryBuilder.BuildDepsTrace.h"
+#include "XEngine.Gfx.ShaderLibraryBuilder.CompilerWorker.h"
 #include "XEngine.Gfx.ShaderLibraryBuilder.Library.h"
 #include "XEngine.Gfx.ShaderLibraryBuilder.LibraryManifestLoader.h"
+#include "XEngine.Gfx.ShaderLibraryBuilder.ShaderCache.h"
 #include "XEngine.Gfx.ShaderLibraryBuilder.SourceFileCache.h"
 #include "XEngine.Utils.CmdLineArgsParser.h"
 
@@ -32,6 +40,13 @@ private:
 		InplaceStringASCIIx1024 libraryManifestFilePath;
 		InplaceStringASCIIx1024 libraryFilePath;
 		InplaceStringASCIIx1024 buildCacheDirPath;
+		InplaceStringASCIIx1024 shaderCacheDirPath; // Empty if shader cache is disabled.
+		uint64 shaderCacheMaxSize;
+		uint16 compilationJobCount;
+		uint16 compilerWorkerProcessCount; // Zero means shaders are compiled in builder process.
+		InplaceStringASCIIx256 compilerWorkerPipeName; // Not empty if this process is compiler worker itself.
+		bool useStubCompilerWorker; // Compiler worker runs stub compiler. See `CompilerWorker.h`.
+		InplaceStringASCIIx1024 compilerWorkerTestDirPath; // Not empty if this process runs compiler worker test.
 	};
 
 	enum class PrevBuildStatus : uint8
@@ -42,6 +57,45 @@ private:
 
 	static constexpr StringViewASCII BuildDepsTraceFileName = StringViewASCII::FromCStr("_BuildDepsTrace");
 	static constexpr uint32 BuildDepsTraceFileMagic = 0x50E3D6BD; // Change this number to invalidate build cache after changing the compiler.
+	static constexpr uint32 ShaderCompilerVersionMagic = BuildDepsTraceFileMagic; // Shader cache entries are invalidated together with build cache.
+	static constexpr uint16 MaxCompilationJobCount = 64; // Limited by `Thread::WaitAll`.
+	static constexpr uint32 DefaultShaderCacheMaxSizeMiB = 4096;
+
+	// Compilation happens on worker threads. Everything that has observable side effects (console output,
+	// build cache writes, BuildDepsTrace records) is done later on main thread in shader order.
+	struct ShaderCompilationTask
+	{
+		Shader* shader;
+		InplaceStringASCIIx1024 mainSourceFilePath;
+		ArrayList<SourceFileHandle> sourceFiles; // Main source file goes first, then includes in resolution order.
+		HAL::ShaderCompiler::ShaderCompilationResultRef result; // Null if main source file failed to load.
+		float32 compilationTime;
+		uint8 attemptCount;
+		Atomic<uint32> isDone;
+	};
+
+	struct ShaderCompilationQueue
+	{
+		ShaderCompilationTask* tasks;
+		uint32 taskCount;
+		SourceFileCache* sourceFileCache;
+		Atomic<uint32> nextTaskIndex;
+		Atomic<uint32> isCancelled;
+
+		// Out-of-process compilation only.
+		StringViewASCII compilerWorkerExecutablePath;
+		StringViewASCII libraryManifestFilePath;
+		uint32 compilerWorkerResponseTimeoutMs;
+		bool useStubCompilerWorker;
+		Atomic<uint32> compilerWorkerLaunchFailureCount;
+		Atomic<uint32> compilerWorkerRestartCount;
+	};
+
+	struct ShaderCompilationWorkerContext
+	{
+		ShaderCompilationQueue* queue;
+		uint16 index;
+	};
 
 private:
 	CmdArgs cmdArgs;
@@ -55,11 +109,15 @@ private:
 
 	BuildDepsTrace::Writer currentBuildDepsTrace;
 
+	ShaderCache shaderCache;
+
 private:
 	bool parseCmdArgs();
 	PrevBuildStatus loadPrevBuildInfo();
 	void startWritingBuildDepsTrace();
 	void loadCachedShaders();
+	bool loadShaderFromPrevBuild(Shader& shader, ArrayList<SourceFileHandle>& shaderSourceFiles);
+	bool loadShaderFromShaderCache(Shader& shader, ArrayList<SourceFileHandle>& shaderSourceFiles);
 	bool compileShaders();
 	bool storeShaderLibrary();
 	void finishWritingBuildDepsTrace(bool isBuildSuccessful);
@@ -70,6 +128,15 @@ private:
 
 	static HAL::ShaderCompiler::BlobRef LoadShaderCompilerBlobFromFile(const char* pathCStr);
 
+	static bool LoadShaderMainSourceFile(ShaderCompilationTask& task, SourceFileCache& sourceFileCache, StringViewASCII& resultText);
+	static void RunShaderCompilationTask(ShaderCompilationTask& task, SourceFileCache& sourceFileCache);
+	static void CompleteShaderCompilationTask(ShaderCompilationTask& task);
+	static uint32 __stdcall ShaderCompilationWorkerMain(ShaderCompilationWorkerContext* context);
+	static uint32 __stdcall RemoteShaderCompilationWorkerMain(ShaderCompilationWorkerContext* context);
+	static void PrintShaderCompilationTimings(const ShaderCompilationTask* tasks, uint32 taskCount, uint16 jobCount, float32 wallClockTime);
+
+	bool runCompilerWorkerTest();
+
 public:
 	Program() = default;
 	~Program() = default;
@@ -85,10 +152,24 @@ bool Program::parseCmdArgs()
 	static constexpr StringViewASCII LibraryManifestFilePathArgKey = StringViewASCII::FromCStr("--manifest");
 	static constexpr StringViewASCII LibraryFilePathArgKey = StringViewASCII::FromCStr("--out");
 	static constexpr StringViewASCII BuildCacheDirPathArgKey = StringViewASCII::FromCStr("--cache");
+	static constexpr StringViewASCII ShaderCacheDirPathArgKey = StringViewASCII::FromCStr("--shader-cache");
+	static constexpr StringViewASCII ShaderCacheMaxSizeArgKey = StringViewASCII::FromCStr("--shader-cache-size-mb");
+	static constexpr StringViewASCII CompilationJobCountArgKey = StringViewASCII::FromCStr("--jobs");
+	static constexpr StringViewASCII CompilerWorkerProcessCountArgKey = StringViewASCII::FromCStr("--workers");
+	static constexpr StringViewASCII CompilerWorkerPipeNameArgKey = StringViewASCII::FromCStr("--compiler-worker");
+	static constexpr StringViewASCII CompilerWorkerStubArgKey = StringViewASCII::FromCStr("--compiler-worker-stub");
+	static constexpr StringViewASCII CompilerWorkerTestDirPathArgKey = StringViewASCII::FromCStr("--compiler-worker-test");
 
 	StringViewASCII libraryManifestFilePathArgValue;
 	StringViewASCII libraryFilePathArgValue;
 	StringViewASCII buildCacheDirPathArgValue;
+	StringViewASCII shaderCacheDirPathArgValue;
+	StringViewASCII shaderCacheMaxSizeArgValue;
+	StringViewASCII compilationJobCountArgValue;
+	StringViewASCII compilerWorkerProcessCountArgValue;
+	StringViewASCII compilerWorkerPipeNameArgValue;
+	StringViewASCII compilerWorkerTestDirPathArgValue;
+	cmdArgs.useStubCompilerWorker = false;
 
 	const char* cmdLine = Environment::GetCommandLineCStr();
 	CmdLineArgsParser parser(cmdLine);
@@ -114,6 +195,25 @@ bool Program::parseCmdArgs()
 				libraryFilePathArgValue = parser.getCurrentArgValue();
 			else if (parser.getCurrentArgKey() == BuildCacheDirPathArgKey)
 				buildCacheDirPathArgValue = parser.getCurrentArgValue();
+			else if (parser.getCurrentArgKey() == ShaderCacheDirPathArgKey)
+				shaderCacheDirPathArgValue = parser.getCurrentArgValue();
+			else if (parser.getCurrentArgKey() == ShaderCacheMaxSizeArgKey)
+				shaderCacheMaxSizeArgValue = parser.getCurrentArgValue();
+			else if (parser.getCurrentArgKey() == CompilationJobCountArgKey)
+				compilationJobCountArgValue = parser.getCurrentArgValue();
+			else if (parser.getCurrentArgKey() == CompilerWorkerProcessCountArgKey)
+				compilerWorkerProcessCountArgValue = parser.getCurrentArgValue();
+			else if (parser.getCurrentArgKey() == CompilerWorkerPipeNameArgKey)
+				compilerWorkerPipeNameArgValue = parser.getCurrentArgValue();
+			else if (parser.getCurrentArgKey() == CompilerWorkerTestDirPathArgKey)
+				compilerWorkerTestDirPathArgValue = parser.getCurrentArgValue();
+			else
+				invalidArg = true;
+		}
+		else if (parser.getCurrentArgType() == CmdLineArgType::Key)
+		{
+			if (parser.getCurrentArgKey() == CompilerWorkerStubArgKey)
+				cmdArgs.useStubCompilerWorker = true;
 			else
 				invalidArg = true;
 		}
@@ -132,11 +232,38 @@ bool Program::parseCmdArgs()
 
 	// TODO: Check that all pathes are valid.
 
+	// Compiler worker test launches stub workers only and needs nothing else.
+	if (!compilerWorkerTestDirPathArgValue.isEmpty())
+	{
+		Path::MakeAbsolute(compilerWorkerTestDirPathArgValue, cmdArgs.compilerWorkerTestDirPath);
+		Path::AddTrailingDirectorySeparator(cmdArgs.compilerWorkerTestDirPath);
+		XAssert(!cmdArgs.compilerWorkerTestDirPath.isFull());
+		return true;
+	}
+
+	// Compiler worker process needs only the manifest (to resolve pipeline layouts). Stub does not need it at all.
+	if (!compilerWorkerPipeNameArgValue.isEmpty() && cmdArgs.useStubCompilerWorker)
+	{
+		cmdArgs.compilerWorkerPipeName.append(compilerWorkerPipeNameArgValue);
+		XAssert(!cmdArgs.compilerWorkerPipeName.isFull());
+		return true;
+	}
+
 	if (libraryManifestFilePathArgValue.isEmpty())
 	{
 		FmtPrintStdOut("error: missing library manifest file path. Use '", LibraryManifestFilePathArgKey, "=XXX'\n");
 		return false;
 	}
+
+	if (!compilerWorkerPipeNameArgValue.isEmpty())
+	{
+		cmdArgs.compilerWorkerPipeName.append(compilerWorkerPipeNameArgValue);
+		Path::MakeAbsolute(libraryManifestFilePathArgValue, cmdArgs.libraryManifestFilePath);
+		XAssert(!cmdArgs.compilerWorkerPipeName.isFull());
+		XAssert(!cmdArgs.libraryManifestFilePath.isFull());
+		return true;
+	}
+
 	if (libraryFilePathArgValue.isEmpty())
 	{
 		FmtPrintStdOut("error: missing output library file path. Use '", LibraryFilePathArgKey, "=XXX'\n");
@@ -147,14 +274,78 @@ bool Program::parseCmdArgs()
 		FmtPrintStdOut("warning: missing build cache dir path. Use '", BuildCacheDirPathArgKey, "=XXX'. Incremental building is disabled\n");
 	}
 
+	// Shader cache is shared between checkouts, so it is never implied by build cache dir.
+	cmdArgs.shaderCacheMaxSize = uint64(DefaultShaderCacheMaxSizeMiB) << 20;
+	if (!shaderCacheMaxSizeArgValue.isEmpty())
+	{
+		uint32 shaderCacheMaxSizeMiB = 0;
+		const FmtParseResult parseResult = FmtParseDecU32(shaderCacheMaxSizeArgValue.getData(),
+			shaderCacheMaxSizeArgValue.getLength(), shaderCacheMaxSizeMiB);
+		if (parseResult.status != FmtParseStatus::Success || parseResult.parsedCharCount != shaderCacheMaxSizeArgValue.getLength())
+		{
+			FmtPrintStdOut("error: invalid shader cache size '", shaderCacheMaxSizeArgValue, "'\n");
+			return false;
+		}
+		cmdArgs.shaderCacheMaxSize = uint64(shaderCacheMaxSizeMiB) << 20;
+	}
+
+	// No value means single job (shaders are compiled on main thread). Zero means one job per logical core.
+	cmdArgs.compilationJobCount = 1;
+	if (!compilationJobCountArgValue.isEmpty())
+	{
+		const FmtParseResult parseResult = FmtParseDecU16(compilationJobCountArgValue.getData(),
+			compilationJobCountArgValue.getLength(), cmdArgs.compilationJobCount);
+		if (parseResult.status != FmtParseStatus::Success || parseResult.parsedCharCount != compilationJobCountArgValue.getLength())
+		{
+			FmtPrintStdOut("error: invalid compilation job count '", compilationJobCountArgValue, "'\n");
+			return false;
+		}
+
+		if (cmdArgs.compilationJobCount == 0)
+			cmdArgs.compilationJobCount = uint16(min<uint32>(Thread::GetLogicalCoreCount(), MaxCompilationJobCount));
+		if (cmdArgs.compilationJobCount > MaxCompilationJobCount)
+		{
+			FmtPrintStdOut("warning: compilation job count is limited to ", MaxCompilationJobCount, "\n");
+			cmdArgs.compilationJobCount = MaxCompilationJobCount;
+		}
+	}
+
+	// Each worker process is served by its own builder thread, so `--workers` overrides `--jobs`.
+	cmdArgs.compilerWorkerProcessCount = 0;
+	if (!compilerWorkerProcessCountArgValue.isEmpty())
+	{
+		const FmtParseResult parseResult = FmtParseDecU16(compilerWorkerProcessCountArgValue.getData(),
+			compilerWorkerProcessCountArgValue.getLength(), cmdArgs.compilerWorkerProcessCount);
+		if (parseResult.status != FmtParseStatus::Success || parseResult.parsedCharCount != compilerWorkerProcessCountArgValue.getLength())
+		{
+			FmtPrintStdOut("error: invalid compiler worker process count '", compilerWorkerProcessCountArgValue, "'\n");
+			return false;
+		}
+
+		if (cmdArgs.compilerWorkerProcessCount == 0)
+			cmdArgs.compilerWorkerProcessCount = uint16(min<uint32>(Thread::GetLogicalCoreCount(), MaxCompilationJobCount));
+		if (cmdArgs.compilerWorkerProcessCount > MaxCompilationJobCount)
+		{
+			FmtPrintStdOut("warning: compiler worker process count is limited to ", MaxCompilationJobCount, "\n");
+			cmdArgs.compilerWorkerProcessCount = MaxCompilationJobCount;
+		}
+		cmdArgs.compilationJobCount = cmdArgs.compilerWorkerProcessCount;
+	}
+
 	Path::MakeAbsolute(libraryManifestFilePathArgValue, cmdArgs.libraryManifestFilePath);
 	Path::MakeAbsolute(libraryFilePathArgValue, cmdArgs.libraryFilePath);
 	Path::MakeAbsolute(buildCacheDirPathArgValue, cmdArgs.buildCacheDirPath);
 	Path::AddTrailingDirectorySeparator(cmdArgs.buildCacheDirPath);
+	if (!shaderCacheDirPathArgValue.isEmpty())
+	{
+		Path::MakeAbsolute(shaderCacheDirPathArgValue, cmdArgs.shaderCacheDirPath);
+		Path::AddTrailingDirectorySeparator(cmdArgs.shaderCacheDirPath);
+	}
 
 	XAssert(!cmdArgs.libraryManifestFilePath.isFull());
 	XAssert(!cmdArgs.libraryFilePath.isFull());
 	XAssert(!cmdArgs.buildCacheDirPath.isFull());
+	XAssert(!cmdArgs.shaderCacheDirPath.isFull());
 
 	if (!Path::HasFileName(cmdArgs.libraryManifestFilePath))
 	{
@@ -195,12 +386,20 @@ auto Program::loadPrevBuildInfo() -> PrevBuildStatus
 		manifestFileModTime != prevBuildDepsTrace.getManifestFileModTime() ||
 		manifestFileModTime == InvalidTimePoint;
 
-	bool someSourceFilesAreOutdated = false;
+	// All source files are resolved in one batch, so their mod times are queried concurrently.
+	// Paths in trace are already normalized by `SourceFileCache`.
+	ArrayList<StringViewASCII> prevBuildSourceFilePaths;
+	prevBuildSourceFilePaths.resize(prevBuildDepsTrace.getSourceFileCount());
+	for (uint16 i = 0; i < prevBuildDepsTrace.getSourceFileCount(); i++)
+		prevBuildSourceFilePaths[i] = prevBuildDepsTrace.getSourceFilePath(i);
+
 	prevBuildSourceFiles.resize(prevBuildDepsTrace.getSourceFileCount());
+	sourceFileCache.openFiles(prevBuildSourceFilePaths.getData(), prevBuildSourceFilePaths.getSize(), prevBuildSourceFiles.getData());
+
+	bool someSourceFilesAreOutdated = false;
 	for (uint16 i = 0; i < prevBuildDepsTrace.getSourceFileCount(); i++)
 	{
-		const SourceFileHandle sourceFile = sourceFileCache.openFile(prevBuildDepsTrace.getSourceFilePath(i));
-		prevBuildSourceFiles[i] = sourceFile;
+		const SourceFileHandle sourceFile = prevBuildSourceFiles[i];
 
 		bool fileIsOutdated = false;
 		if (sourceFile == SourceFileHandle(0))
@@ -250,95 +449,133 @@ void Program::startWritingBuildDepsTrace()
 
 void Program::loadCachedShaders()
 {
-	if (!prevBuildDepsTrace.isLoaded())
-		return;
-
-	XAssert(prevBuildDepsTrace.getSourceFileCount() == prevBuildSourceFiles.getSize());
+	XAssert(!prevBuildDepsTrace.isLoaded() || prevBuildDepsTrace.getSourceFileCount() == prevBuildSourceFiles.getSize());
 
-	uint32 cachedShaderCount = 0;
+	uint32 prevBuildShaderCount = 0;
+	uint32 shaderCacheShaderCount = 0;
 	ArrayList<SourceFileHandle> shaderSourceFiles;
 
 	for (uint32 libraryShaderIndex = 0; libraryShaderIndex < library.shaders.getSize(); libraryShaderIndex++)
 	{
-		// Check if the compilation parameters match and all files are up-to-date
-		// If so, attempt to load the compiled shader from the build cache.
-
 		Shader& shader = *library.shaders[libraryShaderIndex].get();
 
-		const uint16 bdtShaderIndex = prevBuildDepsTrace.findShader(shader.getNameXSH());
-		if (bdtShaderIndex == uint16(-1))
-			continue;
+		// Cheap mod time based check goes first. Shader cache has to hash all source files.
+		if (loadShaderFromPrevBuild(shader, shaderSourceFiles))
+			prevBuildShaderCount++;
+		else if (loadShaderFromShaderCache(shader, shaderSourceFiles))
+			shaderCacheShaderCount++;
+	}
 
-		const bool shaderDetailsMatch = prevBuildDepsTrace.doShaderDetailsMatch(bdtShaderIndex,
-			shader.getPipelineLayoutNameXSH(), shader.getPipelineLayout().getSourceHash(), shader.getCompilationArgs());
-		if (!shaderDetailsMatch)
-			continue;
+	FmtPrintFStdOut<"Loaded {}/{} shaders from build cache ({} from shader cache)\n">(
+		prevBuildShaderCount + shaderCacheShaderCount, library.shaders.getSize(), shaderCacheShaderCount);
+}
 
-		// Check if main source file matches.
-		bool mainSourceFileMatches = false;
-		{
-			const uint32 bdtShaderMainSourceFileIndex = prevBuildDepsTrace.getShaderSourceFileIndex(bdtShaderIndex, 0);
-			const SourceFileHandle bdtShaderMainSourceFile = prevBuildSourceFiles[bdtShaderMainSourceFileIndex];
+bool Program::loadShaderFromPrevBuild(Shader& shader, ArrayList<SourceFileHandle>& shaderSourceFiles)
+{
+	if (!prevBuildDepsTrace.isLoaded())
+		return false;
 
-			InplaceStringASCIIx1024 mainSourceFilePath;
-			mainSourceFilePath.append(libraryRootPath);
-			mainSourceFilePath.append(shader.getMainSourceFilePath());
-			const SourceFileHandle shaderMainSourceFile = sourceFileCache.openFile(mainSourceFilePath);
+	// Check if the compilation parameters match and all files are up-to-date
+	// If so, attempt to load the compiled shader from the build cache.
 
-			mainSourceFileMatches = (shaderMainSourceFile == bdtShaderMainSourceFile);
-		}
-		if (!mainSourceFileMatches)
-			continue;
+	const uint16 bdtShaderIndex = prevBuildDepsTrace.findShader(shader.getNameXSH());
+	if (bdtShaderIndex == uint16(-1))
+		return false;
 
-		// Check if some source files are outdated.
-		bool sourceFilesAreUpToDate = true;
-		if (prevBuildDepsTrace.getShaderSourceFileCount(bdtShaderIndex) == 0)
-			sourceFilesAreUpToDate = false;
-		else
+	const bool shaderDetailsMatch = prevBuildDepsTrace.doShaderDetailsMatch(bdtShaderIndex,
+		shader.getPipelineLayoutNameXSH(), shader.getPipelineLayout().getSourceHash(), shader.getCompilationArgs());
+	if (!shaderDetailsMatch)
+		return false;
+
+	// Check if main source file matches.
+	bool mainSourceFileMatches = false;
+	{
+		const uint32 bdtShaderMainSourceFileIndex = prevBuildDepsTrace.getShaderSourceFileIndex(bdtShaderIndex, 0);
+		const SourceFileHandle bdtShaderMainSourceFile = prevBuildSourceFiles[bdtShaderMainSourceFileIndex];
+
+		InplaceStringASCIIx1024 mainSourceFilePath;
+		mainSourceFilePath.append(libraryRootPath);
+		mainSourceFilePath.append(shader.getMainSourceFilePath());
+		const SourceFileHandle shaderMainSourceFile = sourceFileCache.openFile(mainSourceFilePath);
+
+		mainSourceFileMatches = (shaderMainSourceFile == bdtShaderMainSourceFile);
+	}
+	if (!mainSourceFileMatches)
+		return false;
+
+	// Check if some source files are outdated.
+	bool sourceFilesAreUpToDate = true;
+	if (prevBuildDepsTrace.getShaderSourceFileCount(bdtShaderIndex) == 0)
+		sourceFilesAreUpToDate = false;
+	else
+	{
+		shaderSourceFiles.clear();
+		for (uint16 i = 0; i < prevBuildDepsTrace.getShaderSourceFileCount(bdtShaderIndex); i++)
 		{
-			shaderSourceFiles.clear();
-			for (uint16 i = 0; i < prevBuildDepsTrace.getShaderSourceFileCount(bdtShaderIndex); i++)
-			{
-				const uint16 bdtSourceFileIndex = prevBuildDepsTrace.getShaderSourceFileIndex(bdtShaderIndex, i);
-				XAssert(bdtSourceFileIndex < prevBuildSourceFiles.getSize());
-				const SourceFileHandle sourceFile = prevBuildSourceFiles[bdtSourceFileIndex];
-				shaderSourceFiles.pushBack(sourceFile);
+			const uint16 bdtSourceFileIndex = prevBuildDepsTrace.getShaderSourceFileIndex(bdtShaderIndex, i);
+			XAssert(bdtSourceFileIndex < prevBuildSourceFiles.getSize());
+			const SourceFileHandle sourceFile = prevBuildSourceFiles[bdtSourceFileIndex];
+			shaderSourceFiles.pushBack(sourceFile);
 
-				if (sourceFile == SourceFileHandle(0) ||
-					sourceFileCache.getFileModTime(sourceFile) != prevBuildDepsTrace.getSourceFileModTime(bdtSourceFileIndex))
-				{
-					sourceFilesAreUpToDate = false;
-					break;
-				}
+			if (sourceFile == SourceFileHandle(0) ||
+				sourceFileCache.getFileModTime(sourceFile) != prevBuildDepsTrace.getSourceFileModTime(bdtSourceFileIndex))
+			{
+				sourceFilesAreUpToDate = false;
+				break;
 			}
 		}
-		if (!sourceFilesAreUpToDate)
-			continue;
+	}
+	if (!sourceFilesAreUpToDate)
+		return false;
 
-		InplaceStringASCIIx1024 compiledBlobFilePath;
-		composeShaderCompilationArtifactFilePath(compiledBlobFilePath, shader, ".bin");
+	InplaceStringASCIIx1024 compiledBlobFilePath;
+	composeShaderCompilationArtifactFilePath(compiledBlobFilePath, shader, ".bin");
 
-		// Check if compiled blob modification time matches.
-		const uint64 compiledBlobModTime = FileSystem::GetFileModificationTime(compiledBlobFilePath.getCStr());
-		const bool compiledBlobModTimeMatches =
-			compiledBlobModTime != InvalidTimePoint &&
-			compiledBlobModTime == prevBuildDepsTrace.getShaderCompiledBlobModTime(bdtShaderIndex);
-		if (!compiledBlobModTimeMatches)
-			continue;
+	// Check if compiled blob modification time matches.
+	const uint64 compiledBlobModTime = FileSystem::GetFileModificationTime(compiledBlobFilePath.getCStr());
+	const bool compiledBlobModTimeMatches =
+		compiledBlobModTime != InvalidTimePoint &&
+		compiledBlobModTime == prevBuildDepsTrace.getShaderCompiledBlobModTime(bdtShaderIndex);
+	if (!compiledBlobModTimeMatches)
+		return false;
 
-		// Shader fully matches the one stored in build cache. Try load compiled blob from build cache.
-		const HAL::ShaderCompiler::BlobRef blob = LoadShaderCompilerBlobFromFile(compiledBlobFilePath.getCStr());
-		if (!blob)
-			continue;
-		shader.setCompiledBlob(blob.get());
+	// Shader fully matches the one stored in build cache. Try load compiled blob from build cache.
+	const HAL::ShaderCompiler::BlobRef blob = LoadShaderCompilerBlobFromFile(compiledBlobFilePath.getCStr());
+	if (!blob)
+		return false;
+	shader.setCompiledBlob(blob.get());
 
-		currentBuildDepsTrace.addShader(shader.getNameXSH(),
-			shader.getPipelineLayoutNameXSH(), shader.getPipelineLayout().getSourceHash(), shader.getCompilationArgs(),
-			shaderSourceFiles, XCheckedCastU16(shaderSourceFiles.getSize()), compiledBlobModTime);
-		cachedShaderCount++;
+	currentBuildDepsTrace.addShader(shader.getNameXSH(),
+		shader.getPipelineLayoutNameXSH(), shader.getPipelineLayout().getSourceHash(), shader.getCompilationArgs(),
+		shaderSourceFiles, XCheckedCastU16(shaderSourceFiles.getSize()), compiledBlobModTime);
+	return true;
+}
+
+bool Program::loadShaderFromShaderCache(Shader& shader, ArrayList<SourceFileHandle>& shaderSourceFiles)
+{
+	if (!shaderCache.isOpen())
+		return false;
+
+	const HAL::ShaderCompiler::BlobRef blob = shaderCache.lookup(shader, shaderSourceFiles);
+	if (!blob)
+		return false;
+	shader.setCompiledBlob(blob.get());
+
+	// Put compiled blob to build cache as well, so next build can take it via BuildDepsTrace.
+	uint64 compiledBlobModTime = InvalidTimePoint;
+	if (!cmdArgs.buildCacheDirPath.isEmpty())
+	{
+		storeShaderCompilationArtifactToBuildCache(shader, *blob, ".bin");
+
+		InplaceStringASCIIx1024 compiledBlobFilePath;
+		composeShaderCompilationArtifactFilePath(compiledBlobFilePath, shader, ".bin");
+		compiledBlobModTime = FileSystem::GetFileModificationTime(compiledBlobFilePath.getCStr());
 	}
 
-	FmtPrintStdOut("Loaded ", cachedShaderCount, '/', library.shaders.getSize(), " shaders from build cache\n");
+	currentBuildDepsTrace.addShader(shader.getNameXSH(),
+		shader.getPipelineLayoutNameXSH(), shader.getPipelineLayout().getSourceHash(), shader.getCompilationArgs(),
+		shaderSourceFiles, XCheckedCastU16(shaderSourceFiles.getSize()), compiledBlobModTime);
+	return true;
 }
 
 bool Program::compileShaders()
@@ -353,91 +590,119 @@ bool Program::compileShaders()
 	if (!shadersToCompile.getSize())
 		return true;
 
-	FmtPrintStdOut("Compiling ", shadersToCompile.getSize(), " shaders\n");
+	FmtPrintFStdOut<"Compiling {} shaders\n">(shadersToCompile.getSize());
 
 	// Sort shaders by name to make the log look nice :sparkles:
 	std::sort(shadersToCompile.begin(), shadersToCompile.end(),
 		[](const Shader* left, const Shader* right) -> bool { return String::IsLess(left->getName(), right->getName()); });
 
-	struct IncludeResolverContext
+	ArrayList<ShaderCompilationTask> tasks;
+	tasks.resize(shadersToCompile.getSize());
+	for (uint32 i = 0; i < shadersToCompile.getSize(); i++)
 	{
-		SourceFileCache& sourceFileCache;
-		ArrayList<SourceFileHandle>& shaderSourceFiles;
-	};
+		ShaderCompilationTask& task = tasks[i];
+		task.shader = shadersToCompile[i];
+		task.mainSourceFilePath.append(libraryRootPath);
+		task.mainSourceFilePath.append(task.shader->getMainSourceFilePath());
+		XAssert(!task.mainSourceFilePath.isFull());
+		task.compilationTime = 0.0f;
+		task.attemptCount = 0;
+		task.isDone.store(0);
+	}
 
-	auto resolveInclude = [](void* voidContext, StringViewASCII includeFilePath) -> HAL::ShaderCompiler::IncludeResolutionResult
+	ShaderCompilationQueue queue = {};
+	queue.tasks = tasks.getData();
+	queue.taskCount = tasks.getSize();
+	queue.sourceFileCache = &sourceFileCache;
+	queue.nextTaskIndex.store(0);
+	queue.isCancelled.store(0);
+	queue.compilerWorkerResponseTimeoutMs = CompilerWorker::DefaultResponseTimeoutMs;
+	queue.useStubCompilerWorker = false;
+	queue.compilerWorkerLaunchFailureCount.store(0);
+	queue.compilerWorkerRestartCount.store(0);
+
+	const uint16 workerCount = uint16(min<uint32>(cmdArgs.compilationJobCount, tasks.getSize()));
+	const bool useCompilerWorkerProcesses = cmdArgs.compilerWorkerProcessCount > 0;
+	const bool useWorkers = workerCount > 1 || useCompilerWorkerProcesses;
+
+	InplaceStringASCIIx1024 executablePath;
+	if (useCompilerWorkerProcesses)
 	{
-		IncludeResolverContext* context = (IncludeResolverContext*)voidContext;
+		Environment::GetExecutableFilePath(executablePath);
+		queue.compilerWorkerExecutablePath = executablePath;
+		queue.libraryManifestFilePath = cmdArgs.libraryManifestFilePath;
+		FmtPrintFStdOut<"Using {} shader compiler worker process(es)\n">(workerCount);
+	}
 
-		const SourceFileHandle includeFile = context->sourceFileCache.openFile(includeFilePath);
-		if (includeFile == SourceFileHandle(0))
-			return HAL::ShaderCompiler::IncludeResolutionResult{ .status = false, };
-		StringViewASCII includeFileText;
-		if (!context->sourceFileCache.getFileText(includeFile, includeFileText))
-			return HAL::ShaderCompiler::IncludeResolutionResult{ .status = false, };
+	const TimerRecord compilationStartTime = Timer::GetRecord();
 
-		context->shaderSourceFiles.pushBack(includeFile);
-		return HAL::ShaderCompiler::IncludeResolutionResult{ .text = includeFileText, .status = true, };
-	};
+	Thread workerThreads[MaxCompilationJobCount];
+	ShaderCompilationWorkerContext workerContexts[MaxCompilationJobCount];
+	if (useWorkers)
+	{
+		for (uint16 i = 0; i < workerCount; i++)
+		{
+			workerContexts[i].queue = &queue;
+			workerContexts[i].index = i;
+			if (useCompilerWorkerProcesses)
+				workerThreads[i].create(&RemoteShaderCompilationWorkerMain, &workerContexts[i]);
+			else
+				workerThreads[i].create(&ShaderCompilationWorkerMain, &workerContexts[i]);
+		}
+	}
 
 	bool compilationSuccessful = true;
-	ArrayList<SourceFileHandle> shaderSourceFiles;
+	uint32 processedTaskCount = 0;
 
-	for (uint32 i = 0; i < shadersToCompile.getSize(); i++)
+	for (uint32 i = 0; i < tasks.getSize(); i++)
 	{
-		Shader& shader = *shadersToCompile[i];
-
-		InplaceStringASCIIx256 messageHeader;
-		FmtPrintStr(messageHeader, " [", i + 1, "/", shadersToCompile.getSize(), "] Compiling shader '", shader.getName(), '\'');
-		FmtPrintStdOut(messageHeader, "\n");
+		ShaderCompilationTask& task = tasks[i];
+		Shader& shader = *task.shader;
 
-		InplaceStringASCIIx1024 mainSourceFilePath;
-		mainSourceFilePath.append(libraryRootPath);
-		mainSourceFilePath.append(shader.getMainSourceFilePath());
-		XAssert(!mainSourceFilePath.isFull());
+		FmtPrintFStdOut<" [{}/{}] Compiling shader '{}'\n">(i + 1, tasks.getSize(), shader.getName());
 
-		StringViewASCII mainSourceFileText;
-		bool mainSourceFileTextLoaded = false;
-		const SourceFileHandle mainSourceFile = sourceFileCache.openFile(mainSourceFilePath);
-		if (mainSourceFile != SourceFileHandle(0))
+		if (useWorkers)
 		{
-			if (sourceFileCache.getFileText(mainSourceFile, mainSourceFileText))
-				mainSourceFileTextLoaded = true;
+			while (!task.isDone.loadAcquire())
+				AddressWait::Wait(&task.isDone.value, 0);
 		}
+		else
+			RunShaderCompilationTask(task, sourceFileCache);
+
+		processedTaskCount++;
 
-		if (!mainSourceFileTextLoaded)
+		if (!task.result)
 		{
-			FmtPrintStdOut(messageHeader, ": error: failed to open file '", mainSourceFilePath, "'\n");
+			FmtPrintFStdOut<" [{}/{}] Compiling shader '{}': error: failed to open file '{}'\n">(
+				i + 1, tasks.getSize(), shader.getName(), task.mainSourceFilePath);
 			compilationSuccessful = false;
 			break;
 		}
 
-		shaderSourceFiles.clear();
-		shaderSourceFiles.pushBack(mainSourceFile);
+		const HAL::ShaderCompiler::ShaderCompilationResult& compilationResult = *task.result;
 
-		IncludeResolverContext includeResolverContext = { .sourceFileCache = sourceFileCache, .shaderSourceFiles = shaderSourceFiles };
-
-		const HAL::ShaderCompiler::ShaderCompilationResultRef compilationResult =
-			HAL::ShaderCompiler::CompileShader(mainSourceFilePath, mainSourceFileText,
-				shader.getCompilationArgs(), shader.getPipelineLayout(),
-				resolveInclude, &includeResolverContext);
-
-		compilationSuccessful = (compilationResult->getStatus() == HAL::ShaderCompiler::ShaderCompilationStatus::Success);
+		compilationSuccessful = (compilationResult.getStatus() == HAL::ShaderCompiler::ShaderCompilationStatus::Success);
 
 		if (!compilationSuccessful)
-			FmtPrintStdOut(messageHeader, ": compilation failed\n");
+			FmtPrintFStdOut<" [{}/{}] Compiling shader '{}': compilation failed\n">(i + 1, tasks.getSize(), shader.getName());
 
-		if (compilationResult->getPreprocessorStdOut().getLength() > 0)
-			FmtPrintStdOut(compilationResult->getPreprocessorStdOut(), "\n");
-		if (compilationResult->getCompilerStdOut().getLength() > 0)
-			FmtPrintStdOut(compilationResult->getCompilerStdOut(), "\n");
+		if (compilationResult.getPreprocessorStdOut().getLength() > 0)
+			FmtPrintFStdOut<"{}\n">(compilationResult.getPreprocessorStdOut());
+		if (compilationResult.getCompilerStdOut().getLength() > 0)
+			FmtPrintFStdOut<"{}\n">(compilationResult.getCompilerStdOut());
 
-		storeShaderCompilationArtifactsToBuildCache(shader, *compilationResult);
+		storeShaderCompilationArtifactsToBuildCache(shader, compilationResult);
 
 		if (!compilationSuccessful)
 			break;
 
-		shader.setCompiledBlob(compilationResult->getBytecodeBlob());
+		shader.setCompiledBlob(compilationResult.getBytecodeBlob());
+
+		if (shaderCache.isOpen())
+		{
+			shaderCache.store(shader, task.sourceFiles.getData(), XCheckedCastU16(task.sourceFiles.getSize()),
+				*compilationResult.getBytecodeBlob());
+		}
 
 		uint64 compiledBlobModTime = InvalidTimePoint;
 		{
@@ -451,9 +716,32 @@ bool Program::compileShaders()
 
 		currentBuildDepsTrace.addShader(shader.getNameXSH(),
 			shader.getPipelineLayoutNameXSH(), shader.getPipelineLayout().getSourceHash(), shader.getCompilationArgs(),
-			shaderSourceFiles, XCheckedCastU16(shaderSourceFiles.getSize()), compiledBlobModTime);
+			task.sourceFiles, XCheckedCastU16(task.sourceFiles.getSize()), compiledBlobModTime);
+
+		// Compiled blob is referenced by shader now. Everything else can be released early.
+		task.result = nullptr;
+	}
+
+	if (useWorkers)
+	{
+		// Workers finish tasks that are already started and do not pick up new ones.
+		queue.isCancelled.store(1);
+		Thread::WaitAll(workerThreads, workerCount);
+	}
+
+	if (useCompilerWorkerProcesses)
+	{
+		const uint32 restartCount = queue.compilerWorkerRestartCount.load();
+		const uint32 launchFailureCount = queue.compilerWorkerLaunchFailureCount.load();
+		if (restartCount > 0)
+			FmtPrintFStdOut<"warning: shader compiler worker processes were restarted {} time(s)\n">(restartCount);
+		if (launchFailureCount > 0)
+			FmtPrintFStdOut<"warning: failed to launch {} shader compiler worker process(es). Shaders were compiled in builder process\n">(launchFailureCount);
 	}
 
+	const float32 compilationWallClockTime = Timer::GetTimeDelta(compilationStartTime);
+	PrintShaderCompilationTimings(tasks.getData(), processedTaskCount, workerCount, compilationWallClockTime);
+
 	return compilationSuccessful;
 }
 
@@ -656,11 +944,554 @@ HAL::ShaderCompiler::BlobRef Program::LoadShaderCompilerBlobFromFile(const char*
 	return blob;
 }
 
+bool Program::LoadShaderMainSourceFile(ShaderCompilationTask& task, SourceFileCache& sourceFileCache, StringViewASCII& resultText)
+{
+	const SourceFileHandle mainSourceFile = sourceFileCache.openFile(task.mainSourceFilePath);
+	if (mainSourceFile == SourceFileHandle(0) || !sourceFileCache.getFileText(mainSourceFile, resultText))
+		return false;
+
+	task.sourceFiles.clear();
+	task.sourceFiles.pushBack(mainSourceFile);
+	return true;
+}
+
+void Program::RunShaderCompilationTask(ShaderCompilationTask& task, SourceFileCache& sourceFileCache)
+{
+	struct IncludeResolverContext
+	{
+		SourceFileCache& sourceFileCache;
+		ArrayList<SourceFileHandle>& shaderSourceFiles;
+	};
+
+	auto resolveInclude = [](void* voidContext, StringViewASCII includeFilePath) -> HAL::ShaderCompiler::IncludeResolutionResult
+	{
+		IncludeResolverContext* context = (IncludeResolverContext*)voidContext;
+
+		const SourceFileHandle includeFile = context->sourceFileCache.openFile(includeFilePath);
+		if (includeFile == SourceFileHandle(0))
+			return HAL::ShaderCompiler::IncludeResolutionResult{ .status = false, };
+		StringViewASCII includeFileText;
+		if (!context->sourceFileCache.getFileText(includeFile, includeFileText))
+			return HAL::ShaderCompiler::IncludeResolutionResult{ .status = false, };
+
+		context->shaderSourceFiles.pushBack(includeFile);
+		return HAL::ShaderCompiler::IncludeResolutionResult{ .text = includeFileText, .status = true, };
+	};
+
+	const TimerRecord startTime = Timer::GetRecord();
+
+	StringViewASCII mainSourceFileText;
+	if (LoadShaderMainSourceFile(task, sourceFileCache, mainSourceFileText))
+	{
+		IncludeResolverContext includeResolverContext = { .sourceFileCache = sourceFileCache, .shaderSourceFiles = task.sourceFiles };
+
+		task.result = HAL::ShaderCompiler::CompileShader(task.mainSourceFilePath, mainSourceFileText,
+			task.shader->getCompilationArgs(), task.shader->getPipelineLayout(),
+			resolveInclude, &includeResolverContext);
+	}
+
+	task.compilationTime = Timer::GetTimeDelta(startTime);
+}
+
+void Program::CompleteShaderCompilationTask(ShaderCompilationTask& task)
+{
+	task.isDone.storeRelease(1);
+	AddressWait::WakeAll(&task.isDone.value);
+}
+
+uint32 __stdcall Program::ShaderCompilationWorkerMain(ShaderCompilationWorkerContext* context)
+{
+	ShaderCompilationQueue& queue = *context->queue;
+
+	for (;;)
+	{
+		if (queue.isCancelled.load())
+			break;
+
+		const uint32 taskIndex = queue.nextTaskIndex.increment() - 1;
+		if (taskIndex >= queue.taskCount)
+			break;
+
+		ShaderCompilationTask& task = queue.tasks[taskIndex];
+		RunShaderCompilationTask(task, *queue.sourceFileCache);
+		CompleteShaderCompilationTask(task);
+	}
+	return 0;
+}
+
+uint32 __stdcall Program::RemoteShaderCompilationWorkerMain(ShaderCompilationWorkerContext* context)
+{
+	// Next request is already queued in worker process while current one is being compiled.
+	static constexpr uint32 MaxInFlightTaskCount = 2;
+
+	ShaderCompilationQueue& queue = *context->queue;
+	SourceFileCache& sourceFileCache = *queue.sourceFileCache;
+
+	CompilerWorkerConnection connection;
+	uint32 launchCount = 0;
+	bool launchFailed = false;
+
+	// Task indices in order they were sent to worker. Worker responds in the same order,
+	// so the first one is always the task being compiled right now.
+	InplaceArrayList<uint32, MaxInFlightTaskCount> inFlightTaskIndices;
+
+	auto sendCompileRequest = [&](uint32 taskIndex) -> bool
+	{
+		ShaderCompilationTask& task = queue.tasks[taskIndex];
+		const Shader& shader = *task.shader;
+
+		// Worker reports all includes again if request is resent.
+		task.sourceFiles.resize(1);
+		StringViewASCII mainSourceFileText;
+		sourceFileCache.getFileText(task.sourceFiles[0], mainSourceFileText);
+
+		CompilerWorkerCompileRequest request = {};
+		request.requestId = taskIndex;
+		request.mainSourceFilePath = task.mainSourceFilePath;
+		request.mainSourceFileText = mainSourceFileText;
+		request.compilationArgs = shader.getCompilationArgs();
+		request.pipelineLayoutNameXSH = shader.getPipelineLayoutNameXSH();
+		request.pipelineLayoutSourceHash = shader.getPipelineLayout().getSourceHash();
+		return connection.sendCompileRequest(request);
+	};
+
+	auto popInFlightTask = [&]()
+	{
+		for (uint32 i = 1; i < inFlightTaskIndices.getSize(); i++)
+			inFlightTaskIndices[i - 1] = inFlightTaskIndices[i];
+		inFlightTaskIndices.popBack();
+	};
+
+	for (;;)
+	{
+		bool connectionIsAlive = true;
+
+		while (!inFlightTaskIndices.isFull() && !queue.isCancelled.load())
+		{
+			const uint32 taskIndex = queue.nextTaskIndex.increment() - 1;
+			if (taskIndex >= queue.taskCount)
+				break;
+
+			ShaderCompilationTask& task = queue.tasks[taskIndex];
+			task.attemptCount = 0;
+
+			StringViewASCII mainSourceFileText;
+			if (!LoadShaderMainSourceFile(task, sourceFileCache, mainSourceFileText))
+			{
+				// Null result is reported as failure to open file.
+				CompleteShaderCompilationTask(task);
+				continue;
+			}
+
+			inFlightTaskIndices.pushBack(taskIndex);
+			if (connection.isLaunched())
+				connectionIsAlive = sendCompileRequest(taskIndex) && connectionIsAlive;
+		}
+
+		if (inFlightTaskIndices.isEmpty())
+			break;
+
+		if (!connection.isLaunched())
+		{
+			InplaceStringASCIIx256 pipeName;
+			FmtPrintStr(pipeName, "XEngine.ShaderLibraryBuilder.", Process::GetCurrentId(), '.', context->index, '.', launchCount);
+			launchCount++;
+
+			if (!connection.launch(queue.compilerWorkerExecutablePath, queue.libraryManifestFilePath, pipeName, queue.useStubCompilerWorker))
+			{
+				launchFailed = true;
+				break;
+			}
+			if (launchCount > 1)
+				queue.compilerWorkerRestartCount.increment();
+
+			for (uint32 taskIndex : inFlightTaskIndices)
+				connectionIsAlive = sendCompileRequest(taskIndex) && connectionIsAlive;
+		}
+
+		ShaderCompilationTask& task = queue.tasks[inFlightTaskIndices[0]];
+
+		CompilerWorkerReceivedMessage message;
+		if (connectionIsAlive)
+			connectionIsAlive = connection.receive(message, queue.compilerWorkerResponseTimeoutMs) && message.requestId == inFlightTaskIndices[0];
+
+		if (connectionIsAlive && message.type == CompilerWorkerMessageType::IncludeRequest)
+		{
+			const SourceFileHandle includeFile = sourceFileCache.openFile(message.includeFilePath);
+			StringViewASCII includeFileText;
+			const bool includeResolved =
+				includeFile != SourceFileHandle(0) && sourceFileCache.getFileText(includeFile, includeFileText);
+			if (includeResolved)
+				task.sourceFiles.pushBack(includeFile);
+
+			connectionIsAlive = connection.sendIncludeResponse(includeResolved, includeFileText);
+		}
+		else if (connectionIsAlive && message.type == CompilerWorkerMessageType::CompileResponse)
+		{
+			task.result = AsRValue(message.compilationResult);
+			task.compilationTime = message.compilationTime;
+			popInFlightTask();
+			CompleteShaderCompilationTask(task);
+		}
+
+		if (!connectionIsAlive)
+		{
+			// Worker crashed, hung (or misbehaved) while compiling the first in-flight task.
+			connection.kill();
+
+			task.attemptCount++;
+			if (task.attemptCount >= CompilerWorker::MaxCompileAttemptCount)
+			{
+				HAL::ShaderCompiler::ShaderCompilationResult::ComposerSource composerSrc = {};
+				composerSrc.status = HAL::ShaderCompiler::ShaderCompilationStatus::CompilerCallFailed;
+				composerSrc.compilerStdOut = StringViewASCII::FromCStr("error: shader compiler worker process crashed or stopped responding");
+				task.result = HAL::ShaderCompiler::ShaderCompilationResult::Compose(composerSrc);
+				popInFlightTask();
+				CompleteShaderCompilationTask(task);
+			}
+		}
+	}
+
+	connection.shutdown();
+
+	if (launchFailed)
+	{
+		// Worker process can not be started. Compile in builder process instead.
+		queue.compilerWorkerLaunchFailureCount.increment();
+
+		for (uint32 taskIndex : inFlightTaskIndices)
+		{
+			ShaderCompilationTask& task = queue.tasks[taskIndex];
+			RunShaderCompilationTask(task, sourceFileCache);
+			CompleteShaderCompilationTask(task);
+		}
+		ShaderCompilationWorkerMain(context);
+	}
+
+	return 0;
+}
+
+void Program::PrintShaderCompilationTimings(const ShaderCompilationTask* tasks, uint32 taskCount, uint16 jobCount, float32 wallClockTime)
+{
+	static constexpr uint32 SlowestShaderReportCount = 8;
+
+	if (!taskCount)
+		return;
+
+	float32 totalCompilationTime = 0.0f;
+	InplaceArrayList<uint32, SlowestShaderReportCount> slowestTasks;
+
+	for (uint32 i = 0; i < taskCount; i++)
+	{
+		totalCompilationTime += tasks[i].compilationTime;
+
+		// Insertion into short list sorted by decreasing compilation time.
+		uint32 insertPosition = slowestTasks.getSize();
+		while (insertPosition > 0 && tasks[slowestTasks[insertPosition - 1]].compilationTime < tasks[i].compilationTime)
+			insertPosition--;
+		if (insertPosition >= SlowestShaderReportCount)
+			continue;
+
+		if (!slowestTasks.isFull())
+			slowestTasks.pushBack(i);
+		for (uint32 j = slowestTasks.getSize() - 1; j > insertPosition; j--)
+			slowestTasks[j] = slowestTasks[j - 1];
+		slowestTasks[insertPosition] = i;
+	}
+
+	auto toMs = [](float32 seconds) -> float32 { return seconds * 1000.0f; };
+
+	FmtPrintFStdOut<"Compiled {} shaders in {:.1f} ms using {} job(s). Total shader compilation time {:.1f} ms, average {:.1f} ms per shader\n">(
+		taskCount, toMs(wallClockTime), jobCount, toMs(totalCompilationTime), toMs(totalCompilationTime / float32(taskCount)));
+
+	FmtPrintFStdOut<"Slowest shaders:\n">();
+	for (uint32 taskIndex : slowestTasks)
+		FmtPrintFStdOut<"  {:8.1f} ms '{}'\n">(toMs(tasks[taskIndex].compilationTime), tasks[taskIndex].shader->getName());
+}
+
+// Runs host side of out-of-process compilation against stub compiler workers (see `CompilerWorker.h`).
+// Checks message framing, include round trips, resending of requests after worker crash and failing
+// of requests that keep crashing or hanging worker. Source files are written to test dir.
+bool Program::runCompilerWorkerTest()
+{
+	static constexpr uint32 LargeSourceTextLength = 1024 * 1024; // Much larger than pipe buffer.
+	static constexpr uint32 HangResponseTimeoutMs = 2'000;
+
+	const StringViewASCII testDirPath = cmdArgs.compilerWorkerTestDirPath;
+	FmtPrintStdOut("Running compiler worker test in '", testDirPath, "'\n");
+	FileSystem::CreateDirRecursive(testDirPath);
+
+	InplaceStringASCIIx1024 executablePath;
+	Environment::GetExecutableFilePath(executablePath);
+
+	bool testPassed = true;
+	auto check = [&testPassed](bool condition, const char* description)
+	{
+		if (!condition)
+		{
+			FmtPrintStdOut("error: compiler worker test: ", description, "\n");
+			testPassed = false;
+		}
+	};
+
+	auto hasBytecode = [](const HAL::ShaderCompiler::ShaderCompilationResult* result, StringViewASCII expectedBytecode) -> bool
+	{
+		const HAL::ShaderCompiler::Blob* blob = result ? result->getBytecodeBlob() : nullptr;
+		return blob && StringViewASCII((const char*)blob->getData(), blob->getSize()) == expectedBytecode;
+	};
+
+	// Framing and include round trips. Requests are sent all at once, so worker queues them.
+	{
+		static constexpr StringViewASCII MainText = StringViewASCII::FromCStr("main\n#include \"A\"\n");
+		static constexpr StringViewASCII IncludeAText = StringViewASCII::FromCStr("A\n#include \"B\"\n");
+		static constexpr StringViewASCII IncludeBText = StringViewASCII::FromCStr("B\n");
+		static constexpr StringViewASCII MissingIncludeText = StringViewASCII::FromCStr("#include \"Missing\"\n");
+		static constexpr StringViewASCII ExpectedIncludes = StringViewASCII::FromCStr("1:A 1:B 2:Missing ");
+
+		InplaceStringASCIIx256 pipeName;
+		FmtPrintStr(pipeName, "XEngine.ShaderLibraryBuilder.Test.", Process::GetCurrentId());
+
+		CompilerWorkerConnection connection;
+		if (!connection.launch(executablePath, StringViewASCII(), pipeName, true))
+		{
+			FmtPrintStdOut("error: compiler worker test: failed to launch worker\n");
+			return false;
+		}
+
+		DynamicStringASCII largeText;
+		for (uint32 i = 0; largeText.getLength() < LargeSourceTextLength; i++)
+			FmtPrintStr(largeText, "// Line ", i, '\n');
+
+		DynamicStringASCII expectedMainBytecode;
+		FmtPrintStr(expectedMainBytecode, MainText, IncludeAText, IncludeBText);
+
+		static constexpr uint32 RequestCount = 3;
+		const StringViewASCII requestTexts[RequestCount] = { largeText.getView(), MainText, MissingIncludeText };
+
+		CompilerWorkerCompileRequest request = {};
+		request.mainSourceFilePath = StringViewASCII::FromCStr("Test.hlsl");
+		request.compilationArgs.entryPointName = StringViewASCII::FromCStr("main");
+		request.compilationArgs.shaderType = HAL::ShaderType::Compute;
+		for (uint32 i = 0; i < RequestCount; i++)
+		{
+			request.requestId = i;
+			request.mainSourceFileText = requestTexts[i];
+			check(connection.sendCompileRequest(request), "failed to send compile request");
+		}
+
+		DynamicStringASCII requestedIncludes;
+		HAL::ShaderCompiler::ShaderCompilationResultRef results[RequestCount];
+		uint32 resultCount = 0;
+		while (resultCount < RequestCount)
+		{
+			CompilerWorkerReceivedMessage message;
+			if (!connection.receive(message, CompilerWorker::DefaultResponseTimeoutMs))
+			{
+				check(false, "connection to worker is lost");
+				break;
+			}
+
+			if (message.type == CompilerWorkerMessageType::IncludeRequest)
+			{
+				FmtPrintStr(requestedIncludes, message.requestId, ':', message.includeFilePath, ' ');
+				StringViewASCII includeText;
+				if (message.includeFilePath == "A")
+					includeText = IncludeAText;
+				else if (message.includeFilePath == "B")
+					includeText = IncludeBText;
+				check(connection.sendIncludeResponse(!includeText.isEmpty(), includeText), "failed to send include response");
+			}
+			else
+			{
+				if (message.requestId != resultCount)
+				{
+					check(false, "compile responses are out of order");
+					break;
+				}
+				results[resultCount] = AsRValue(message.compilationResult);
+				resultCount++;
+			}
+		}
+		connection.shutdown();
+
+		check(requestedIncludes.getView() == ExpectedIncludes, "unexpected include requests");
+		check(hasBytecode(results[0].get(), largeText.getView()), "large request is not transferred intact");
+		check(hasBytecode(results[1].get(), expectedMainBytecode.getView()), "include texts are not transferred intact");
+		check(results[2] && results[2]->getStatus() == HAL::ShaderCompiler::ShaderCompilationStatus::PreprocessingError,
+			"failed include resolution is not reported");
+	}
+
+	// Same path as in normal build, including retries. Every crash or hang is followed by worker restart,
+	// and the task queued behind crashed one is resent to new worker.
+	{
+		static constexpr StringViewASCII IncludeText = StringViewASCII::FromCStr("include\n");
+		static constexpr StringViewASCII CrashText = StringViewASCII::FromCStr("#crash\n");
+		static constexpr StringViewASCII HangText = StringViewASCII::FromCStr("#hang\n");
+		// CrashOnce crashes worker once, Crash and Hang on every attempt.
+		static constexpr uint32 ExpectedRestartCount = 1 + CompilerWorker::MaxCompileAttemptCount * 2;
+
+		InplaceStringASCIIx1024 includePath;
+		InplaceStringASCIIx1024 plainPath;
+		InplaceStringASCIIx1024 crashOncePath;
+		InplaceStringASCIIx1024 crashOnceMarkerPath;
+		InplaceStringASCIIx1024 crashPath;
+		InplaceStringASCIIx1024 hangPath;
+		FmtPrintStr(includePath, testDirPath, "Include.hlsli");
+		FmtPrintStr(plainPath, testDirPath, "Plain.hlsl");
+		FmtPrintStr(crashOncePath, testDirPath, "CrashOnce.hlsl");
+		FmtPrintStr(crashOnceMarkerPath, testDirPath, "CrashOnce.marker");
+		FmtPrintStr(crashPath, testDirPath, "Crash.hlsl");
+		FmtPrintStr(hangPath, testDirPath, "Hang.hlsl");
+		FileSystem::RemoveFile(crashOnceMarkerPath.getCStr());
+
+		DynamicStringASCII plainText;
+		DynamicStringASCII expectedPlainBytecode;
+		DynamicStringASCII crashOnceText;
+		FmtPrintStr(plainText, "plain\n#include \"", includePath, "\"\n");
+		FmtPrintStr(expectedPlainBytecode, plainText.getView(), IncludeText);
+		FmtPrintStr(crashOnceText, "#crash-once ", crashOnceMarkerPath, "\ncrash once\n");
+
+		auto writeFile = [](const InplaceStringASCIIx1024& path, StringViewASCII text) -> bool
+		{
+			File file;
+			return file.open(path.getCStr(), FileAccessMode::Write, FileOpenMode::Override) && file.write(text.getData(), text.getLength());
+		};
+
+		if (!writeFile(includePath, IncludeText) || !writeFile(plainPath, plainText.getView()) ||
+			!writeFile(crashOncePath, crashOnceText.getView()) || !writeFile(crashPath, CrashText) || !writeFile(hangPath, HangText))
+		{
+			FmtPrintStdOut("error: compiler worker test: failed to write source files\n");
+			return false;
+		}
+
+		// Stub does not use pipeline layout, but shader needs one.
+		HAL::ShaderCompiler::GenericErrorMessage pipelineLayoutErrorMessage;
+		const HAL::ShaderCompiler::PipelineLayoutRef pipelineLayout = HAL::ShaderCompiler::PipelineLayout::Create(nullptr, 0, nullptr, 0, pipelineLayoutErrorMessage);
+		if (!pipelineLayout)
+		{
+			FmtPrintStdOut("error: compiler worker test: failed to create pipeline layout\n");
+			return false;
+		}
+
+		struct TestTaskDesc
+		{
+			const char* name;
+			StringViewASCII mainSourceFilePath;
+			StringViewASCII expectedBytecode; // Empty if task should fail.
+		};
+
+		const TestTaskDesc taskDescs[] =
+		{
+			{ "Plain", plainPath, expectedPlainBytecode.getView() },
+			{ "CrashOnce", crashOncePath, crashOnceText.getView() },
+			{ "Crash", crashPath, StringViewASCII() },
+			{ "Hang", hangPath, StringViewASCII() },
+			{ "PlainAfterHang", plainPath, expectedPlainBytecode.getView() },
+		};
+		const uint32 taskCount = countOf(taskDescs);
+
+		HAL::ShaderCompiler::ShaderCompilationArgs compilationArgs = {};
+		compilationArgs.entryPointName = StringViewASCII::FromCStr("main");
+		compilationArgs.shaderType = HAL::ShaderType::Compute;
+
+		ArrayList<ShaderRef> shaders;
+		ArrayList<ShaderCompilationTask> tasks;
+		tasks.resize(taskCount);
+		for (uint32 i = 0; i < taskCount; i++)
+		{
+			const StringViewASCII name = StringViewASCII::FromCStr(taskDescs[i].name);
+			shaders.pushBack(Shader::Create(name, XSH::Compute(name), pipelineLayout.get(),
+				StringViewASCII::FromCStr("TestPipelineLayout"), XSH::Compute("TestPipelineLayout"),
+				taskDescs[i].mainSourceFilePath, compilationArgs));
+
+			ShaderCompilationTask& task = tasks[i];
+			task.shader = shaders[i].get();
+			task.mainSourceFilePath.append(taskDescs[i].mainSourceFilePath);
+			task.compilationTime = 0.0f;
+			task.attemptCount = 0;
+			task.isDone.store(0);
+		}
+
+		ShaderCompilationQueue queue = {};
+		queue.tasks = tasks.getData();
+		queue.taskCount = tasks.getSize();
+		queue.sourceFileCache = &sourceFileCache;
+		queue.nextTaskIndex.store(0);
+		queue.isCancelled.store(0);
+		queue.compilerWorkerExecutablePath = executablePath;
+		queue.compilerWorkerResponseTimeoutMs = HangResponseTimeoutMs;
+		queue.useStubCompilerWorker = true;
+		queue.compilerWorkerLaunchFailureCount.store(0);
+		queue.compilerWorkerRestartCount.store(0);
+
+		ShaderCompilationWorkerContext workerContext = {};
+		workerContext.queue = &queue;
+		workerContext.index = 0;
+		RemoteShaderCompilationWorkerMain(&workerContext);
+
+		check(queue.compilerWorkerLaunchFailureCount.load() == 0, "failed to launch worker");
+		check(queue.compilerWorkerRestartCount.load() == ExpectedRestartCount, "unexpected worker restart count");
+		check(tasks[0].sourceFiles.getSize() == 2, "include is not recorded as shader source file");
+
+		for (uint32 i = 0; i < taskCount; i++)
+		{
+			const ShaderCompilationTask& task = tasks[i];
+			const TestTaskDesc& desc = taskDescs[i];
+
+			bool taskPassed = false;
+			if (!desc.expectedBytecode.isEmpty())
+			{
+				taskPassed = task.result && task.result->getStatus() == HAL::ShaderCompiler::ShaderCompilationStatus::Success &&
+					hasBytecode(task.result.get(), desc.expectedBytecode);
+			}
+			else
+			{
+				taskPassed = task.result && task.result->getStatus() == HAL::ShaderCompiler::ShaderCompilationStatus::CompilerCallFailed &&
+					task.attemptCount == CompilerWorker::MaxCompileAttemptCount;
+			}
+
+			if (!taskPassed)
+			{
+				FmtPrintStdOut("error: compiler worker test: unexpected result of '", desc.name, "'\n");
+				testPassed = false;
+			}
+		}
+	}
+
+	FmtPrintStdOut(testPassed ? "Compiler worker test passed\n" : "Compiler worker test failed\n");
+	return testPassed;
+}
+
+// Names hashed while loading manifest and compiling shaders are recorded by XSH registry (debug builds).
+static bool CheckXSHCollisions()
+{
+#ifdef XENGINE_XSH_REGISTRY
+	using XEngine::XStringHashRegistry;
+
+	const uint32 collisionCount = XStringHashRegistry::GetCollisionCount();
+	for (uint32 i = 0; i < collisionCount; i++)
+	{
+		const XStringHashRegistry::Collision& collision = XStringHashRegistry::GetCollision(i);
+		FmtPrintStdOut("error: XSH collision: '", collision.stringA.getView(), "' and '", collision.stringB.getView(),
+			"' have the same hash ", FmtArgHex64(collision.hash, 16), "\n");
+	}
+	return collisionCount == 0;
+#else
+	return true;
+#endif
+}
+
 int Program::main()
 {
 	if (!parseCmdArgs())
 		return 1;
 
+	if (!cmdArgs.compilerWorkerTestDirPath.isEmpty())
+		return runCompilerWorkerTest() ? 0 : 1;
+
+	if (!cmdArgs.compilerWorkerPipeName.isEmpty())
+		return CompilerWorker::Run(cmdArgs.compilerWorkerPipeName, cmdArgs.libraryManifestFilePath.getCStr(), cmdArgs.useStubCompilerWorker);
+
 	libraryRootPath = Path::GetParent(cmdArgs.libraryManifestFilePath);
 	XAssert(Path::HasTrailingDirectorySeparator(libraryRootPath));
 	FileSystem::CreateDirRecursive(cmdArgs.buildCacheDirPath);
@@ -679,22 +1510,32 @@ int Program::main()
 		return 1;
 	}
 
-	FmtPrintStdOut("Shader library manifest declares ",
-		library.shaders.getSize(), " shaders, ",
-		library.pipelineLayouts.getSize(), " pipeline layouts, ",
-		library.descriptorSetLayouts.getSize(), " descriptor set layouts\n");
+	FmtPrintFStdOut<"Shader library manifest declares {} shaders, {} pipeline layouts, {} descriptor set layouts\n">(
+		library.shaders.getSize(), library.pipelineLayouts.getSize(), library.descriptorSetLayouts.getSize());
 
+	if (!cmdArgs.shaderCacheDirPath.isEmpty())
+	{
+		if (!shaderCache.open(cmdArgs.shaderCacheDirPath, cmdArgs.shaderCacheMaxSize, ShaderCompilerVersionMagic, libraryRootPath, sourceFileCache))
+			FmtPrintStdOut("warning: failed to open shader cache '", cmdArgs.shaderCacheDirPath, "'. Shader cache is disabled\n");
+	}
+
+	// New trace is written in place of the previous one, so the previous one should not stay mapped.
+	prevBuildDepsTrace.unmapFile();
 	startWritingBuildDepsTrace();
 
 	loadCachedShaders();
 
+	prevBuildDepsTrace.close();
+
 	bool isBuildSuccessful = false;
-	if (compileShaders())
+	if (compileShaders() && CheckXSHCollisions())
 		if (storeShaderLibrary())
 			isBuildSuccessful = true;
 
 	finishWritingBuildDepsTrace(isBuildSuccessful);
 
+	shaderCache.collectGarbage();
+
 	if (isBuildSuccessful)
 		FmtPrintStdOut("Shader library '", cmdArgs.libraryFilePath, "' was built succesfully\n");
 	else
@@ -439,9 +439,10 @@ void TaskGraph::initialize()
 	this->taskPoolSize = MaxTaskCount;
 	this->dependencyPoolSize = MaxDenendencyCount;
 	this->barrierPoolSize = MaxDenendencyCount * 2;
-	this->userDataPoolSize = 16 * 1024; // TODO: ????
 
 	{
+		const uint32 userDataPoolSize = 16 * 1024; // TODO: ????
+
 		uintptr poolsMemorySizeAccum = 0;
 
 		const uintptr resourcePoolMemOffset = poolsMemorySizeAccum;
@@ -468,7 +469,7 @@ void TaskGraph::initialize()
 		tasks = (Task*)(poolsMemory + passPoolMemOffset);
 		dependencies = (Dependency*)(poolsMemory + dependencyPoolMemOffset);
 		barriers = (Barrier*)(poolsMemory + barrierPoolMemoryOffset);
-		userDataPool = poolsMemory + userDataPoolMemOffset;
+		userDataAllocator.initialize(poolsMemory + userDataPoolMemOffset, userDataPoolSize);
 	}
 }
 
@@ -584,12 +585,9 @@ void* TaskGraph::allocateUserData(uint32 size)
 {
 	XEAssert(hwDevice);
 
-	userDataAllocatedSize = alignUp<uint32>(userDataAllocatedSize, 16);
-	const uint32 userDataOffset = userDataAllocatedSize;
-	userDataAllocatedSize += size;
-	XEMasterAssert(userDataAllocatedSize <= userDataPoolSize);
-
-	return (void*)(uintptr(userDataPool) + userDataOffset);
+	void* userData = userDataAllocator.allocate(size);
+	XEMasterAssert(userData);
+	return userData;
 }
 
 HAL::DescriptorSet TaskGraph::allocateTransientDescriptorSet(HAL::DescriptorSetLayoutHandle descriptorSetLayout)
@@ -1202,13 +1200,13 @@ void TaskGraph::execute()
 		memorySet(tasks, 0, sizeof(Task) * taskCount);
 		memorySet(dependencies, 0, sizeof(Dependency) * dependencyCount);
 		memorySet(barriers, 0, sizeof(Barrier) * barrierCount);
-		memorySet(userDataPool, 0, userDataAllocatedSize);
+		memorySet(userDataAllocator.getBlock(), 0, userDataAllocator.getAllocatedSize());
 
 		resourceCount = 0;
 		taskCount = 0;
 		dependencyCount = 0;
 		barrierCount = 0;
-		userDataAllocatedSize = 0;
+		userDataAllocator.reset();
 
 		XEAssert(!issuedTaskDependencyCollector);
 		postExecutionLocalBarrierChainHeadIdx = 0;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <XLib.h>
+#include <XLib.Allocation.h>
 #include <XLib.NonCopyable.h>
 #include <XLib.Containers.CircularQueue.h>
 
@@ -204,7 +205,7 @@ namespace XEngine::Gfx::Scheduler
 		Task* tasks = nullptr;
 		Dependency* dependencies = nullptr;
 		Barrier* barriers = nullptr;
-		void* userDataPool = nullptr;
+		XLib::FixedBlockLinearAllocator userDataAllocator;
 
 		HAL::Device* hwDevice = nullptr;
 		HAL::CommandAllocatorHandle hwCommandAllocator = {};
@@ -222,9 +223,6 @@ namespace XEngine::Gfx::Scheduler
 		uint16 dependencyCount = 0;
 		uint16 barrierCount = 0;
 
-		uint32 userDataPoolSize = 0;
-		uint32 userDataAllocatedSize = 0;
-
 		TaskDependencyCollector* issuedTaskDependencyCollector = nullptr;
 		uint16 postExecutionLocalBarrierChainHeadIdx = 0;
 
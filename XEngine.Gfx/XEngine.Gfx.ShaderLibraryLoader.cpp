@@ -7,7 +7,6 @@
 using namespace XLib;
 using namespace XEngine::Gfx;
 
-XTODO("Use hash maps instead of linear search");
 XTODO("Remove `GShaderLibraryLoader` bullshit")
 
 ShaderLibraryLoader XEngine::Gfx::GShaderLibraryLoader;
@@ -38,6 +37,9 @@ ShaderLibraryLoader::~ShaderLibraryLoader()
 	{
 		// TODO: Do this properly.
 		SystemHeapAllocator::Release(memoryBlock);
+		descriptorSetLayoutIndexMap.destroy();
+		pipelineLayoutIndexMap.destroy();
+		shaderIndexMap.destroy();
 		memorySet(this, 0, sizeof(*this));
 	}
 }
@@ -102,6 +104,10 @@ void ShaderLibraryLoader::load(const char* libraryFilePath, HAL::Device& halDevi
 		void* memoryBlock = SystemHeapAllocator::Allocate(memoryBlockSize);
 		memorySet(memoryBlock, 0, memoryBlockSize);
 
+		descriptorSetLayoutIndexMap.reserve(descriptorSetLayoutCount);
+		pipelineLayoutIndexMap.reserve(pipelineLayoutCount);
+		shaderIndexMap.reserve(shaderCount);
+
 		descriptorSetLayoutTable =	(DescriptorSetLayout*)	(uintptr(memoryBlock) + descriptorSetLayoutTableOffset);
 		pipelineLayoutTable =		(PipelineLayout*)		(uintptr(memoryBlock) + pipelineLayoutTableOffset);
 		shaderTable =				(Shader*)				(uintptr(memoryBlock) + shaderTableOffset);
@@ -131,6 +137,8 @@ void ShaderLibraryLoader::load(const char* libraryFilePath, HAL::Device& halDevi
 		descriptorSetLayout.nameXSH = U64From2xU32(descriptorSetLayoutRecord.nameXSH0, descriptorSetLayoutRecord.nameXSH1);
 
 		XEMasterAssert(descriptorSetLayout.nameXSH);
+		const bool descriptorSetLayoutIsUnique = descriptorSetLayoutIndexMap.insert(descriptorSetLayout.nameXSH, descriptorSetLayoutIndex);
+		XEMasterAssert(descriptorSetLayoutIsUnique);
 		// TODO: Uncomment when proper objects ordering is implemented.
 		//XEMasterAssert(prevNameXSH < descriptorSetLayout.nameXSH); // Check order.
 		prevNameXSH = descriptorSetLayout.nameXSH;
@@ -150,6 +158,8 @@ void ShaderLibraryLoader::load(const char* libraryFilePath, HAL::Device& halDevi
 		pipelineLayout.nameXSH = U64From2xU32(pipelineLayoutRecord.nameXSH0, pipelineLayoutRecord.nameXSH1);
 
 		XEMasterAssert(pipelineLayout.nameXSH);
+		const bool pipelineLayoutIsUnique = pipelineLayoutIndexMap.insert(pipelineLayout.nameXSH, pipelineLayoutIndex);
+		XEMasterAssert(pipelineLayoutIsUnique);
 		// TODO: Uncomment when proper objects ordering is implemented.
 		//XEMasterAssert(prevNameXSH < pipelineLayout.nameXSH); // Check order.
 		prevNameXSH = pipelineLayout.nameXSH;
@@ -163,17 +173,9 @@ void ShaderLibraryLoader::load(const char* libraryFilePath, HAL::Device& halDevi
 		Shader& shader = shaderTable[shaderIndex];
 
 		const uint64 pipelineLayoutNameXSH = U64From2xU32(shaderRecord.pipelineLayoutNameXSH0, shaderRecord.pipelineLayoutNameXSH1);
-		const PipelineLayout* pipelineLayout = nullptr;
-		XTODO("Use fast search here too");
-		for (uint32 i = 0; i < pipelineLayoutCount; i++)
-		{
-			if (pipelineLayoutTable[i].nameXSH == pipelineLayoutNameXSH)
-			{
-				pipelineLayout = &pipelineLayoutTable[i];
-				break;
-			}
-		}
-		XEMasterAssert(pipelineLayout);
+		const uint32* pipelineLayoutIndex = pipelineLayoutIndexMap.find(pipelineLayoutNameXSH);
+		XEMasterAssert(pipelineLayoutIndex);
+		const PipelineLayout* pipelineLayout = &pipelineLayoutTable[*pipelineLayoutIndex];
 
 		const void* blobData = blobsDataBegin + shaderRecord.blobOffset;
 		const uint32 blobSize = shaderRecord.blobSize;
@@ -182,6 +184,8 @@ void ShaderLibraryLoader::load(const char* libraryFilePath, HAL::Device& halDevi
 		shader.nameXSH = U64From2xU32(shaderRecord.nameXSH0, shaderRecord.nameXSH1);
 
 		XEMasterAssert(shader.nameXSH);
+		const bool shaderIsUnique = shaderIndexMap.insert(shader.nameXSH, shaderIndex);
+		XEMasterAssert(shaderIsUnique);
 		// TODO: Uncomment when proper objects ordering is implemented.
 		//XEMasterAssert(prevNameXSH < pipeline.nameXSH); // Check order.
 		prevNameXSH = shader.nameXSH;
@@ -192,11 +196,9 @@ void ShaderLibraryLoader::load(const char* libraryFilePath, HAL::Device& halDevi
 
 HAL::DescriptorSetLayoutHandle ShaderLibraryLoader::getDescriptorSetLayout(uint64 nameXSH) const
 {
-	for (uint32 i = 0; i < descriptorSetLayoutCount; i++)
-	{
-		if (descriptorSetLayoutTable[i].nameXSH == nameXSH)
-			return descriptorSetLayoutTable[i].halDescriptorSetLayout;
-	}
+	const uint32* index = descriptorSetLayoutIndexMap.find(nameXSH);
+	if (index)
+		return descriptorSetLayoutTable[*index].halDescriptorSetLayout;
 
 	XEMasterAssertUnreachableCode();
 	return HAL::DescriptorSetLayoutHandle(0);
@@ -204,11 +206,9 @@ HAL::DescriptorSetLayoutHandle ShaderLibraryLoader::getDescriptorSetLayout(uint6
 
 HAL::PipelineLayoutHandle ShaderLibraryLoader::getPipelineLayout(uint64 nameXSH) const
 {
-	for (uint32 i = 0; i < pipelineLayoutCount; i++)
-	{
-		if (pipelineLayoutTable[i].nameXSH == nameXSH)
-			return pipelineLayoutTable[i].halPipelineLayout;
-	}
+	const uint32* index = pipelineLayoutIndexMap.find(nameXSH);
+	if (index)
+		return pipelineLayoutTable[*index].halPipelineLayout;
 
 	XEMasterAssertUnreachableCode();
 	return HAL::PipelineLayoutHandle(0);
@@ -216,11 +216,9 @@ HAL::PipelineLayoutHandle ShaderLibraryLoader::getPipelineLayout(uint64 nameXSH)
 
 HAL::ShaderHandle ShaderLibraryLoader::getShader(uint64 nameXSH) const
 {
-	for (uint32 i = 0; i < shaderCount; i++)
-	{
-		if (shaderTable[i].nameXSH == nameXSH)
-			return shaderTable[i].halShader;
-	}
+	const uint32* index = shaderIndexMap.find(nameXSH);
+	if (index)
+		return shaderTable[*index].halShader;
 
 	XEMasterAssertUnreachableCode();
 	return HAL::ShaderHandle(0);
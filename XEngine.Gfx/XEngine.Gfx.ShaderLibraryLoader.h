@@ -2,6 +2,7 @@
 
 #include <XLib.h>
 #include <XLib.NonCopyable.h>
+#include <XLib.Containers.HashMap.h>
 #include <XEngine.Gfx.HAL.D3D12.h>
 
 // TODO: Remove `GlobalShaderLibraryLoader` bullshit.
@@ -25,6 +26,10 @@ namespace XEngine::Gfx
 		uint32 pipelineLayoutCount = 0;
 		uint32 shaderCount = 0;
 
+		XLib::FlatHashMap<uint64, uint32> descriptorSetLayoutIndexMap;
+		XLib::FlatHashMap<uint64, uint32> pipelineLayoutIndexMap;
+		XLib::FlatHashMap<uint64, uint32> shaderIndexMap;
+
 	public:
 		ShaderLibraryLoader() = default;
 		~ShaderLibraryLoader();
@@ -1,29 +1,917 @@
-#include "XEngine.Simulation.Engine.h"
+#include <XLib.ByteStream.h>
+#include <XEngine.ThreadPoolUtils.h>
 
-#include <XEngine.Simulation.Model.h>
+#include "XEngine.Simulation.Engine.h"
 
+using namespace XLib;
+using namespace XEngine;
 using namespace XEngine::Simulation;
 using namespace XEngine::Simulation::ModelInternals;
 
-void Engine::tickWave(Wave& wave)
+static_assert(sizeof(ModelInternals::PageHeader) <= ModelInternals::PageHeaderSize);
+
+namespace
+{
+	constexpr uint32 SerializedStateSignature = 0x7E51A7E5;
+	constexpr uint16 SerializedStateVersion = 1;
+
+	// Header is followed by page list records, then by emitted page records, then by page data.
+	struct SerializedStateHeader // 24 bytes
+	{
+		uint32 signature;
+		uint16 version;
+		uint16 pageListCount;
+		uint32 freeEntityRecordsHead;
+		uint32 emittedPageCount;
+		uint8 isDelta;
+		uint8 _padding0[7];
+	};
+	static_assert(sizeof(SerializedStateHeader) == 24);
+
+	struct SerializedPageListRecord // 8 bytes
+	{
+		uint32 elementCount;
+		uint32 pageCount;
+	};
+
+	struct SerializedPageRecord // 8 bytes
+	{
+		uint32 listIndex;
+		uint32 pageIndex;
+	};
+}
+
+Engine::Page* Engine::allocatePage()
+{
+	Page* page = freePagesList;
+	XAssert(page); // Memory pool exhausted.
+
+	freePagesList = *(Page**)page;
+	freePageCount--;
+
+	const uint32 pageIndex = uint32(((byte*)page - pagePool) / PageSize);
+	pageReferenceCounts[pageIndex] = 1;
+
+	page->header.entityCount = 0;
+	return page;
+}
+
+inline void Engine::addPageReference(Page* page)
+{
+	const uint32 pageIndex = uint32(((byte*)page - pagePool) / PageSize);
+	pageReferenceCounts[pageIndex]++;
+}
+
+void Engine::releasePageReference(Page* page)
+{
+	const uint32 pageIndex = uint32(((byte*)page - pagePool) / PageSize);
+	XAssert(pageReferenceCounts[pageIndex] > 0);
+
+	pageReferenceCounts[pageIndex]--;
+	if (pageReferenceCounts[pageIndex] > 0)
+		return;
+
+	*(Page**)page = freePagesList;
+	freePagesList = page;
+	freePageCount++;
+}
+
+inline void Engine::makePageWritable(Page*& page)
+{
+	const uint32 pageIndex = uint32(((byte*)page - pagePool) / PageSize);
+	if (pageReferenceCounts[pageIndex] == 1)
+		return;
+
+	// Page is shared with some captured state. Operative state gets its own copy.
+	Page* pageCopy = allocatePage();
+	memoryCopy(pageCopy, page, PageSize);
+	pageReferenceCounts[pageIndex]--;
+	page = pageCopy;
+}
+
+inline uint32 Engine::getPageListCount() const
+{
+	return archetypeStorages.getSize() + 1;
+}
+
+inline ArrayList<Engine::Page*>& Engine::getOperativePageList(const uint32 listIndex)
+{
+	return listIndex < archetypeStorages.getSize() ? archetypeStorages[listIndex].pages : entityRecordPages;
+}
+
+inline uint32& Engine::getOperativePageListElementCount(const uint32 listIndex)
+{
+	return listIndex < archetypeStorages.getSize() ? archetypeStorages[listIndex].entityCount : entityRecordCount;
+}
+
+Engine::State& Engine::allocateState(StateHandle& outHandle)
+{
+	uint32 stateIndex = freeStatesHead;
+	if (stateIndex != uint32(-1))
+		freeStatesHead = states[stateIndex].nextFreeStateIndex;
+	else
+	{
+		XAssert(states.getSize() < uint16(-1));
+		stateIndex = states.getSize();
+		states.emplaceBack();
+	}
+
+	State& state = states[stateIndex];
+	XAssert(!state.isAllocated);
+	state.isAllocated = true;
+	state.pages.clear();
+	state.pageLists.clear();
+	state.freeEntityRecordsHead = uint32(-1);
+
+	outHandle = StateHandle(stateIndex + 1);
+	return state;
+}
+
+inline Engine::State* Engine::resolveStateHandle(const StateHandle handle)
+{
+	const uint32 stateIndex = uint32(handle) - 1;
+	if (handle == StateHandle::Zero || stateIndex >= states.getSize() || !states[stateIndex].isAllocated)
+		return nullptr;
+	return &states[stateIndex];
+}
+
+inline const Engine::State* Engine::resolveStateHandle(const StateHandle handle) const
+{
+	return const_cast<Engine*>(this)->resolveStateHandle(handle);
+}
+
+inline bool Engine::IsStatePageChanged(const State& state, const State* baseState,
+	const uint32 listIndex, const uint32 pageIndex)
+{
+	if (!baseState)
+		return true;
+
+	// Pages are never modified in place once shared, so same page means same content.
+	const StatePageList& baseList = baseState->pageLists[listIndex];
+	if (pageIndex >= baseList.pageCount)
+		return true;
+
+	const StatePageList& list = state.pageLists[listIndex];
+	return state.pages[list.pageBeginIndex + pageIndex] != baseState->pages[baseList.pageBeginIndex + pageIndex];
+}
+
+inline const Engine::EntityRecord* Engine::resolveEntityId(const EntityId id) const
+{
+	const uint32 recordIndex = uint32(uint64(id));
+	const uint32 generation = uint32(uint64(id) >> 32);
+
+	if (recordIndex >= entityRecordCount)
+		return nullptr;
+
+	const EntityRecord* records = (const EntityRecord*)entityRecordPages[recordIndex / EntityRecordsPerPage];
+	const EntityRecord& record = records[recordIndex % EntityRecordsPerPage];
+	if (record.generation != generation || record.archetypeIndex == uint16(-1))
+		return nullptr;
+
+	return &record;
+}
+
+inline Engine::EntityRecord& Engine::getWritableEntityRecord(const uint32 recordIndex)
+{
+	Page*& page = entityRecordPages[recordIndex / EntityRecordsPerPage];
+	makePageWritable(page);
+	return ((EntityRecord*)page)[recordIndex % EntityRecordsPerPage];
+}
+
+inline byte* Engine::getWritableComponentPointer(ArchetypeStorage& storage,
+	const uint32 rowIndex, const uint16 componentIndex)
+{
+	const uint32 entitiesPerPage = storage.layout.entitiesPerPage;
+	Page*& page = storage.pages[rowIndex / entitiesPerPage];
+	makePageWritable(page);
+
+	const uint32 pageRowIndex = rowIndex % entitiesPerPage;
+	return (byte*)page + storage.layout.columnOffsets[componentIndex] +
+		pageRowIndex * storage.componentSizes[componentIndex];
+}
+
+void Engine::buildJobGroups(ArchetypeStorage& storage, const Archetype& archetype)
+{
+	// Jobs conflict if one of them writes component that other one reads or writes. Groups are
+	// connected components of conflict graph. Job count is small, so simple quadratic union-find.
+	ArrayList<uint16> jobRoots;
+	jobRoots.resize(archetype.jobCount);
+
+	for (uint16 i = 0; i < archetype.jobCount; i++)
+	{
+		jobRoots[i] = i;
+
+		const Job& job = archetype.jobs[i];
+		for (uint16 j = 0; j < i; j++)
+		{
+			const Job& previousJob = archetype.jobs[j];
+			const bool conflict =
+				(job.writeComponentsMask & (previousJob.readComponentsMask | previousJob.writeComponentsMask)) ||
+				(previousJob.writeComponentsMask & job.readComponentsMask);
+			if (!conflict)
+				continue;
+
+			uint16 root = j;
+			while (jobRoots[root] != root)
+				root = jobRoots[root];
+
+			// Lower index wins, so each root is the first job of its group.
+			uint16 selfRoot = i;
+			while (jobRoots[selfRoot] != selfRoot)
+				selfRoot = jobRoots[selfRoot];
+
+			if (root < selfRoot)
+				jobRoots[selfRoot] = root;
+			else
+				jobRoots[root] = selfRoot;
+		}
+	}
+
+	storage.jobGroupBeginIndex = XCheckedCastU16(jobGroups.getSize());
+	storage.jobGroupCount = 0;
+	storage.hasWritingJobs = false;
+
+	// Groups go in order of their first jobs, jobs inside group go in model order.
+	for (uint16 i = 0; i < archetype.jobCount; i++)
+	{
+		storage.hasWritingJobs |= archetype.jobs[i].writeComponentsMask != 0;
+
+		if (jobRoots[i] != i)
+			continue;
+
+		JobGroup& group = jobGroups.emplaceBack();
+		group.jobIndicesBeginIndex = XCheckedCastU16(jobGroupJobIndices.getSize());
+		group.jobCount = 0;
+
+		for (uint16 j = i; j < archetype.jobCount; j++)
+		{
+			uint16 root = j;
+			while (jobRoots[root] != root)
+				root = jobRoots[root];
+
+			if (root == i)
+			{
+				jobGroupJobIndices.pushBack(j);
+				group.jobCount++;
+			}
+		}
+
+		storage.jobGroupCount++;
+	}
+}
+
+void Engine::tickWave(const Wave& wave) const
 {
 	const Archetype& archetype = model->archetypes[wave.archetypeIndex];
+	const ArchetypeStorage& storage = archetypeStorages[wave.archetypeIndex];
+	const JobGroup& jobGroup = jobGroups[wave.jobGroupIndex];
+	const uint16* jobIndices = jobGroupJobIndices.getData() + jobGroup.jobIndicesBeginIndex;
+
+	void* columns[MaxArchetypeComponentCount];
+
+	JobExecutorContext context = {};
+	context.columns = columns;
+	context.entityBeginIndex = 0;
+
+	// All jobs of group run over page before moving to the next one, so page stays in cache.
+	for (uint32 pageIndex = wave.pageBeginIndex; pageIndex < wave.pageEndIndex; pageIndex++)
+	{
+		Page* page = storage.pages[pageIndex];
+		byte* pageBytes = (byte*)page;
+
+		for (uint16 i = 0; i < storage.componentCount; i++)
+			columns[i] = pageBytes + storage.layout.columnOffsets[i];
+
+		context.page = page;
+		context.entityIds = (const uint64*)(pageBytes + storage.layout.entityIdsColumnOffset);
+		context.entityEndIndex = page->header.entityCount;
+
+		for (uint16 i = 0; i < jobGroup.jobCount; i++)
+			archetype.jobs[jobIndices[i]].executorFunc(context);
+	}
+}
+
+void Engine::initialize(const Model& model, void* memoryPool, uintptr memoryPoolSize)
+{
+	XAssert(!this->model);
+	XAssert((uintptr(memoryPool) & (PageSize - 1)) == 0);
+
+	this->model = &model;
+
+	pagePool = (byte*)memoryPool;
+	pagePoolPageCount = XCheckedCastU32(memoryPoolSize / PageSize);
+	pageReferenceCounts.resize(pagePoolPageCount);
+
+	// Build free list so that pages are handed out in address order.
+	freePagesList = nullptr;
+	for (uint32 i = pagePoolPageCount; i > 0; i--)
+	{
+		Page* page = (Page*)(pagePool + uintptr(i - 1) * PageSize);
+		*(Page**)page = freePagesList;
+		freePagesList = page;
+	}
+	freePageCount = pagePoolPageCount;
+
+	archetypeStorages.reserve(model.archetypeCount);
+	for (uint32 archetypeIndex = 0; archetypeIndex < model.archetypeCount; archetypeIndex++)
+	{
+		const Archetype& archetype = model.archetypes[archetypeIndex];
+		ArchetypeStorage& storage = archetypeStorages.emplaceBack();
+
+		storage.layout = ComputeArchetypePageLayout(model.components,
+			archetype.componentIndices, archetype.componentCount);
+
+		if (const ArchetypePageLayout* precomputedLayout = archetype.pageLayout)
+		{
+			// Model was compiled against different layout rules.
+			XAssert(precomputedLayout->entitiesPerPage == storage.layout.entitiesPerPage);
+			XAssert(precomputedLayout->entityIdsColumnOffset == storage.layout.entityIdsColumnOffset);
+			for (uint16 i = 0; i < archetype.componentCount; i++)
+				XAssert(precomputedLayout->columnOffsets[i] == storage.layout.columnOffsets[i]);
+		}
+		storage.componentCount = archetype.componentCount;
+		for (uint16 i = 0; i < archetype.componentCount; i++)
+			storage.componentSizes[i] = model.components[archetype.componentIndices[i]].size;
 
-	for (uint8 jobIndex = 0; jobIndex < archetype.jobCount; jobIndex++)
+		storage.entityCount = 0;
+
+		buildJobGroups(storage, archetype);
+	}
+}
+
+void Engine::destroy()
+{
+	archetypeStorages.destroy();
+	entityRecordPages.destroy();
+	entityRecordCount = 0;
+	freeEntityRecordsHead = uint32(-1);
+
+	states.destroy();
+	freeStatesHead = uint32(-1);
+
+	jobGroups.destroy();
+	jobGroupJobIndices.destroy();
+	waves.destroy();
+	pendingPageCopies.destroy();
+
+	pagePool = nullptr;
+	pagePoolPageCount = 0;
+	freePagesList = nullptr;
+	freePageCount = 0;
+	pageReferenceCounts.destroy();
+
+	model = nullptr;
+}
+
+EntityId Engine::createEntity(const uint16 archetypeIndex)
+{
+	XAssert(archetypeIndex < model->archetypeCount);
+	ArchetypeStorage& storage = archetypeStorages[archetypeIndex];
+
+	const uint32 entitiesPerPage = storage.layout.entitiesPerPage;
+	const uint32 rowIndex = storage.entityCount;
+	if (rowIndex == storage.pages.getSize() * entitiesPerPage)
+		storage.pages.pushBack(allocatePage());
+
+	storage.entityCount++;
+
+	uint32 recordIndex = freeEntityRecordsHead;
+	if (recordIndex != uint32(-1))
+		freeEntityRecordsHead = getWritableEntityRecord(recordIndex).rowIndex;
+	else
 	{
-		const Job& job = archetype.jobs[jobIndex];
+		recordIndex = entityRecordCount;
+		if (recordIndex == entityRecordPages.getSize() * EntityRecordsPerPage)
+			entityRecordPages.pushBack(allocatePage());
+
+		entityRecordCount++;
+		getWritableEntityRecord(recordIndex).generation = 0;
+	}
+
+	EntityRecord& record = getWritableEntityRecord(recordIndex);
+	record.rowIndex = rowIndex;
+	record.archetypeIndex = archetypeIndex;
+
+	const EntityId id = EntityId(uint64(record.generation) << 32 | recordIndex);
 
-		for (uint8 waveEntityIndex = 0; waveEntityIndex < wave.entityCount; waveEntityIndex++)
+	Page*& page = storage.pages[rowIndex / entitiesPerPage];
+	makePageWritable(page);
+
+	const uint32 pageRowIndex = rowIndex % entitiesPerPage;
+	page->header.entityCount++;
+
+	uint64* entityIds = (uint64*)((byte*)page + storage.layout.entityIdsColumnOffset);
+	entityIds[pageRowIndex] = uint64(id);
+
+	for (uint16 i = 0; i < storage.componentCount; i++)
+		memorySet(getWritableComponentPointer(storage, rowIndex, i), 0, storage.componentSizes[i]);
+
+	return id;
+}
+
+void Engine::destroyEntity(const EntityId id)
+{
+	const EntityRecord* record = resolveEntityId(id);
+	XAssert(record);
+
+	const uint16 archetypeIndex = record->archetypeIndex;
+	const uint32 rowIndex = record->rowIndex;
+
+	ArchetypeStorage& storage = archetypeStorages[archetypeIndex];
+	const uint32 entitiesPerPage = storage.layout.entitiesPerPage;
+	const uint32 lastRowIndex = storage.entityCount - 1;
+
+	Page*& lastPage = storage.pages[lastRowIndex / entitiesPerPage];
+	makePageWritable(lastPage);
+
+	if (rowIndex != lastRowIndex)
+	{
+		for (uint16 i = 0; i < storage.componentCount; i++)
 		{
-			job.executorFunc();
+			memoryCopy(getWritableComponentPointer(storage, rowIndex, i),
+				getWritableComponentPointer(storage, lastRowIndex, i), storage.componentSizes[i]);
 		}
+
+		const uint64* lastPageEntityIds = (const uint64*)((byte*)lastPage + storage.layout.entityIdsColumnOffset);
+		const uint64 movedEntityId = lastPageEntityIds[lastRowIndex % entitiesPerPage];
+
+		Page* page = storage.pages[rowIndex / entitiesPerPage]; // Made writable by component copy.
+		uint64* entityIds = (uint64*)((byte*)page + storage.layout.entityIdsColumnOffset);
+		entityIds[rowIndex % entitiesPerPage] = movedEntityId;
+
+		getWritableEntityRecord(uint32(movedEntityId)).rowIndex = rowIndex;
 	}
+
+	storage.entityCount--;
+	lastPage->header.entityCount--;
+	if (lastPage->header.entityCount == 0)
+	{
+		releasePageReference(lastPage);
+		storage.pages.popBack();
+	}
+
+	const uint32 recordIndex = uint32(uint64(id));
+	EntityRecord& writableRecord = getWritableEntityRecord(recordIndex);
+	writableRecord.generation++;
+	writableRecord.archetypeIndex = uint16(-1);
+	writableRecord.rowIndex = freeEntityRecordsHead;
+	freeEntityRecordsHead = recordIndex;
+}
+
+void* Engine::getEntityComponent(const EntityId id, const uint16 archetypeComponentIndex)
+{
+	const EntityRecord* record = resolveEntityId(id);
+	XAssert(record);
+
+	ArchetypeStorage& storage = archetypeStorages[record->archetypeIndex];
+	XAssert(archetypeComponentIndex < storage.componentCount);
+
+	return getWritableComponentPointer(storage, record->rowIndex, archetypeComponentIndex);
+}
+
+uint32 Engine::getArchetypeEntityCount(const uint16 archetypeIndex) const
+{
+	return archetypeStorages[archetypeIndex].entityCount;
 }
 
 StateHandle Engine::tick()
 {
-	for (uint32 waveIndex = 0; waveIndex < waveCount; waveIndex++)
+	// Page pool and page lists are not thread-safe, so all shared pages that are going to be
+	// written are replaced with fresh copies upfront. Actual copying is done in parallel.
+	waves.clear();
+	pendingPageCopies.clear();
+
+	for (uint16 archetypeIndex = 0; archetypeIndex < archetypeStorages.getSize(); archetypeIndex++)
+	{
+		ArchetypeStorage& storage = archetypeStorages[archetypeIndex];
+		if (storage.entityCount == 0)
+			continue;
+
+		const uint32 pageCount = storage.pages.getSize();
+
+		if (storage.hasWritingJobs)
+		{
+			for (Page*& page : storage.pages)
+			{
+				const uint32 poolPageIndex = uint32(((byte*)page - pagePool) / PageSize);
+				if (pageReferenceCounts[poolPageIndex] == 1)
+					continue;
+
+				PageCopy& pageCopy = pendingPageCopies.emplaceBack();
+				pageCopy.source = page;
+				pageCopy.destination = allocatePage();
+
+				// Source page stays alive, as it is still referenced by some state.
+				pageReferenceCounts[poolPageIndex]--;
+				page = pageCopy.destination;
+			}
+		}
+
+		for (uint16 i = 0; i < storage.jobGroupCount; i++)
+		{
+			for (uint32 pageBeginIndex = 0; pageBeginIndex < pageCount; pageBeginIndex += WavePageCount)
+			{
+				Wave& wave = waves.emplaceBack();
+				wave.archetypeIndex = archetypeIndex;
+				wave.jobGroupIndex = storage.jobGroupBeginIndex + i;
+				wave.pageBeginIndex = pageBeginIndex;
+				wave.pageEndIndex = min(pageBeginIndex + WavePageCount, pageCount);
+			}
+		}
+	}
+
+	ParallelFor(0, pendingPageCopies.getSize(), 8,
+		[this](uint32 begin, uint32 end) -> void
+		{
+			for (uint32 i = begin; i < end; i++)
+				memoryCopy(pendingPageCopies[i].destination, pendingPageCopies[i].source, PageSize);
+		});
+
+	ParallelFor(0, waves.getSize(), 1,
+		[this](uint32 begin, uint32 end) -> void
+		{
+			for (uint32 i = begin; i < end; i++)
+				tickWave(waves[i]);
+		});
+
+	return captureOperativeState();
+}
+
+StateHandle Engine::captureOperativeState()
+{
+	StateHandle handle = StateHandle::Zero;
+	State& state = allocateState(handle);
+
+	const uint32 pageListCount = getPageListCount();
+	state.pageLists.resize(pageListCount);
+
+	for (uint32 listIndex = 0; listIndex < pageListCount; listIndex++)
+	{
+		const ArrayList<Page*>& pages = getOperativePageList(listIndex);
+
+		StatePageList& list = state.pageLists[listIndex];
+		list.pageBeginIndex = state.pages.getSize();
+		list.pageCount = pages.getSize();
+		list.elementCount = getOperativePageListElementCount(listIndex);
+
+		for (Page* page : pages)
+		{
+			addPageReference(page);
+			state.pages.pushBack(page);
+		}
+	}
+
+	state.freeEntityRecordsHead = freeEntityRecordsHead;
+
+	return handle;
+}
+
+void Engine::resetOperativeState(const StateHandle stateHandle)
+{
+	const State* state = resolveStateHandle(stateHandle);
+	XAssert(state);
+
+	dropOperativeState();
+
+	for (uint32 listIndex = 0; listIndex < getPageListCount(); listIndex++)
+	{
+		const StatePageList& list = state->pageLists[listIndex];
+		ArrayList<Page*>& pages = getOperativePageList(listIndex);
+
+		for (uint32 i = 0; i < list.pageCount; i++)
+		{
+			Page* page = state->pages[list.pageBeginIndex + i];
+			addPageReference(page);
+			pages.pushBack(page);
+		}
+
+		getOperativePageListElementCount(listIndex) = list.elementCount;
+	}
+
+	freeEntityRecordsHead = state->freeEntityRecordsHead;
+}
+
+void Engine::dropOperativeState()
+{
+	for (uint32 listIndex = 0; listIndex < getPageListCount(); listIndex++)
+	{
+		ArrayList<Page*>& pages = getOperativePageList(listIndex);
+		for (Page* page : pages)
+			releasePageReference(page);
+
+		pages.clear();
+		getOperativePageListElementCount(listIndex) = 0;
+	}
+
+	freeEntityRecordsHead = uint32(-1);
+}
+
+void Engine::releaseState(const StateHandle stateHandle)
+{
+	State* state = resolveStateHandle(stateHandle);
+	XAssert(state);
+
+	for (Page* page : state->pages)
+		releasePageReference(page);
+
+	state->pages.clear();
+	state->pageLists.clear();
+	state->isAllocated = false;
+
+	const uint32 stateIndex = uint32(stateHandle) - 1;
+	state->nextFreeStateIndex = freeStatesHead;
+	freeStatesHead = stateIndex;
+}
+
+uintptr Engine::getSerializedStateSize(const StateHandle stateHandle, const StateHandle baseStateHandle) const
+{
+	const State* state = resolveStateHandle(stateHandle);
+	const State* baseState = resolveStateHandle(baseStateHandle);
+	XAssert(state);
+	XAssert(baseState || baseStateHandle == StateHandle::Zero);
+
+	uint32 emittedPageCount = 0;
+	for (uint32 listIndex = 0; listIndex < state->pageLists.getSize(); listIndex++)
+	{
+		for (uint32 i = 0; i < state->pageLists[listIndex].pageCount; i++)
+		{
+			if (IsStatePageChanged(*state, baseState, listIndex, i))
+				emittedPageCount++;
+		}
+	}
+
+	return sizeof(SerializedStateHeader) +
+		sizeof(SerializedPageListRecord) * state->pageLists.getSize() +
+		(sizeof(SerializedPageRecord) + PageSize) * uintptr(emittedPageCount);
+}
+
+void Engine::serializeState(const StateHandle stateHandle, const StateHandle baseStateHandle,
+	void* buffer, uintptr bufferSize) const
+{
+	const State* state = resolveStateHandle(stateHandle);
+	const State* baseState = resolveStateHandle(baseStateHandle);
+	XAssert(state);
+	XAssert(baseState || baseStateHandle == StateHandle::Zero);
+
+	const uint32 pageListCount = state->pageLists.getSize();
+
+	ByteStreamWriter writer(buffer, bufferSize);
+
+	SerializedStateHeader* header = writer.advance<SerializedStateHeader>();
+	XAssert(header);
+	memorySet(header, 0, sizeof(SerializedStateHeader));
+	header->signature = SerializedStateSignature;
+	header->version = SerializedStateVersion;
+	header->pageListCount = uint16(pageListCount);
+	header->freeEntityRecordsHead = state->freeEntityRecordsHead;
+	header->isDelta = baseState ? 1 : 0;
+
+	for (const StatePageList& list : state->pageLists)
+	{
+		SerializedPageListRecord listRecord = {};
+		listRecord.elementCount = list.elementCount;
+		listRecord.pageCount = list.pageCount;
+		writer.write(listRecord);
+	}
+
+	uint32 emittedPageCount = 0;
+	for (uint32 listIndex = 0; listIndex < pageListCount; listIndex++)
+	{
+		for (uint32 i = 0; i < state->pageLists[listIndex].pageCount; i++)
+		{
+			if (!IsStatePageChanged(*state, baseState, listIndex, i))
+				continue;
+
+			SerializedPageRecord pageRecord = {};
+			pageRecord.listIndex = listIndex;
+			pageRecord.pageIndex = i;
+			writer.write(pageRecord);
+			emittedPageCount++;
+		}
+	}
+	header->emittedPageCount = emittedPageCount;
+
+	for (uint32 listIndex = 0; listIndex < pageListCount; listIndex++)
+	{
+		const StatePageList& list = state->pageLists[listIndex];
+		for (uint32 i = 0; i < list.pageCount; i++)
+		{
+			if (IsStatePageChanged(*state, baseState, listIndex, i))
+				writer.write(state->pages[list.pageBeginIndex + i], PageSize);
+		}
+	}
+
+	XAssert(!writer.isOverflowed());
+}
+
+bool Engine::validateSerializedState(const ArrayList<const Page*>& pages,
+	const ArrayList<uint32>& pageListElementCounts, const uint32 freeEntityRecordsHead) const
+{
+	// Page list sizes are already checked against element counts. Here page contents are checked
+	// against each other, so that no later access through entity ids can go out of bounds.
+	const uint32 archetypeCount = archetypeStorages.getSize();
+
+	uint32 listPageBeginIndex = 0;
+	uint32 liveEntityCount = 0;
+	for (uint32 archetypeIndex = 0; archetypeIndex < archetypeCount; archetypeIndex++)
+	{
+		const uint32 entitiesPerPage = archetypeStorages[archetypeIndex].layout.entitiesPerPage;
+		const uint32 entityCount = pageListElementCounts[archetypeIndex];
+		const uint32 pageCount = divRoundUp(entityCount, entitiesPerPage);
+
+		// Pages are densely packed, so only last one can be partially filled.
+		for (uint32 i = 0; i < pageCount; i++)
+		{
+			const uint32 expectedEntityCount = min(entityCount - i * entitiesPerPage, entitiesPerPage);
+			if (pages[listPageBeginIndex + i]->header.entityCount != expectedEntityCount)
+				return false;
+		}
+
+		listPageBeginIndex += pageCount;
+		liveEntityCount += entityCount;
+	}
+
+	const Page* const* recordPages = pages.getData() + listPageBeginIndex;
+	const uint32 recordCount = pageListElementCounts[archetypeCount];
+	const auto getRecord = [recordPages](const uint32 recordIndex) -> const EntityRecord&
+	{
+		return ((const EntityRecord*)recordPages[recordIndex / EntityRecordsPerPage])[recordIndex % EntityRecordsPerPage];
+	};
+
+	// Every live record should point to row that holds its own id. As row holds single id, this
+	// also makes records and rows one-to-one, given that counts match.
+	uint32 liveRecordCount = 0;
+	for (uint32 recordIndex = 0; recordIndex < recordCount; recordIndex++)
+	{
+		const EntityRecord& record = getRecord(recordIndex);
+		if (record.archetypeIndex == uint16(-1))
+			continue;
+
+		if (record.archetypeIndex >= archetypeCount)
+			return false;
+		if (record.rowIndex >= pageListElementCounts[record.archetypeIndex])
+			return false;
+
+		const ArchetypeStorage& storage = archetypeStorages[record.archetypeIndex];
+		uint32 archetypePageBeginIndex = 0;
+		for (uint32 i = 0; i < record.archetypeIndex; i++)
+			archetypePageBeginIndex += divRoundUp(pageListElementCounts[i], uint32(archetypeStorages[i].layout.entitiesPerPage));
+
+		const uint32 entitiesPerPage = storage.layout.entitiesPerPage;
+		const byte* pageBytes = (const byte*)pages[archetypePageBeginIndex + record.rowIndex / entitiesPerPage];
+		const uint64* entityIds = (const uint64*)(pageBytes + storage.layout.entityIdsColumnOffset);
+		if (entityIds[record.rowIndex % entitiesPerPage] != (uint64(record.generation) << 32 | recordIndex))
+			return false;
+
+		liveRecordCount++;
+	}
+
+	if (liveRecordCount != liveEntityCount)
+		return false;
+
+	// Free list should visit every free record exactly once. Cycle would make it longer.
+	const uint32 freeRecordCount = recordCount - liveRecordCount;
+	uint32 freeListLength = 0;
+	for (uint32 recordIndex = freeEntityRecordsHead; recordIndex != uint32(-1); )
+	{
+		if (recordIndex >= recordCount || freeListLength == freeRecordCount)
+			return false;
+
+		const EntityRecord& record = getRecord(recordIndex);
+		if (record.archetypeIndex != uint16(-1))
+			return false;
+
+		freeListLength++;
+		recordIndex = record.rowIndex;
+	}
+
+	return freeListLength == freeRecordCount;
+}
+
+StateHandle Engine::deserializeState(const void* data, uintptr size, const StateHandle baseStateHandle)
+{
+	const State* baseState = resolveStateHandle(baseStateHandle);
+	if (!baseState && baseStateHandle != StateHandle::Zero)
+		return StateHandle::Zero;
+
+	const byte* dataBytes = (const byte*)data;
+
+	if (size < sizeof(SerializedStateHeader))
+		return StateHandle::Zero;
+
+	const SerializedStateHeader& header = *(const SerializedStateHeader*)dataBytes;
+	if (header.signature != SerializedStateSignature ||
+		header.version != SerializedStateVersion ||
+		header.pageListCount != getPageListCount() ||
+		bool(header.isDelta) != (baseState != nullptr))
+	{
+		return StateHandle::Zero;
+	}
+
+	const uintptr expectedSize = sizeof(SerializedStateHeader) +
+		sizeof(SerializedPageListRecord) * header.pageListCount +
+		(sizeof(SerializedPageRecord) + PageSize) * uintptr(header.emittedPageCount);
+	if (size != expectedSize)
+		return StateHandle::Zero;
+
+	const SerializedPageListRecord* listRecords =
+		(const SerializedPageListRecord*)(dataBytes + sizeof(SerializedStateHeader));
+	const SerializedPageRecord* pageRecords =
+		(const SerializedPageRecord*)(listRecords + header.pageListCount);
+	const byte* pagesData = (const byte*)(pageRecords + header.emittedPageCount);
+
+	// Validate everything before touching the page pool.
+	for (uint32 listIndex = 0; listIndex < header.pageListCount; listIndex++)
+	{
+		const uint32 elementsPerPage = listIndex < archetypeStorages.getSize() ?
+			archetypeStorages[listIndex].layout.entitiesPerPage : EntityRecordsPerPage;
+		const SerializedPageListRecord& listRecord = listRecords[listIndex];
+
+		if (listRecord.pageCount != (uint64(listRecord.elementCount) + elementsPerPage - 1) / elementsPerPage)
+			return StateHandle::Zero;
+	}
+
+	// Emitted pages should go in list order. Skipped pages should be present in base state.
+	// Page count is bounded by emitted and base pages here, as any other page fails the check.
+	ArrayList<const Page*> sourcePages;
+	uint32 nextEmittedPageIndex = 0;
+	for (uint32 listIndex = 0; listIndex < header.pageListCount; listIndex++)
 	{
-		tickWave(waves[waveIndex]);
+		for (uint32 i = 0; i < listRecords[listIndex].pageCount; i++)
+		{
+			const bool emitted = nextEmittedPageIndex < header.emittedPageCount &&
+				pageRecords[nextEmittedPageIndex].listIndex == listIndex &&
+				pageRecords[nextEmittedPageIndex].pageIndex == i;
+
+			if (emitted)
+			{
+				sourcePages.pushBack((const Page*)(pagesData + uintptr(nextEmittedPageIndex) * PageSize));
+				nextEmittedPageIndex++;
+			}
+			else if (baseState && i < baseState->pageLists[listIndex].pageCount)
+				sourcePages.pushBack(baseState->pages[baseState->pageLists[listIndex].pageBeginIndex + i]);
+			else
+				return StateHandle::Zero;
+		}
 	}
+	if (nextEmittedPageIndex != header.emittedPageCount)
+		return StateHandle::Zero;
+
+	// Pool and state handles running out is reported same way as malformed input, not asserted,
+	// as serialized data comes from outside.
+	if (header.emittedPageCount > freePageCount)
+		return StateHandle::Zero;
+	if (freeStatesHead == uint32(-1) && states.getSize() >= uint16(-1))
+		return StateHandle::Zero;
+
+	ArrayList<uint32> pageListElementCounts;
+	pageListElementCounts.resize(header.pageListCount);
+	for (uint32 listIndex = 0; listIndex < header.pageListCount; listIndex++)
+		pageListElementCounts[listIndex] = listRecords[listIndex].elementCount;
+
+	if (!validateSerializedState(sourcePages, pageListElementCounts, header.freeEntityRecordsHead))
+		return StateHandle::Zero;
+
+	const uint32 totalPageCount = sourcePages.getSize();
+
+	StateHandle handle = StateHandle::Zero;
+	State& state = allocateState(handle);
+	baseState = resolveStateHandle(baseStateHandle); // States storage might have been reallocated.
+
+	state.pages.reserve(totalPageCount);
+	state.pageLists.resize(header.pageListCount);
+	state.freeEntityRecordsHead = header.freeEntityRecordsHead;
+
+	uint32 emittedPageIndex = 0;
+	for (uint32 listIndex = 0; listIndex < header.pageListCount; listIndex++)
+	{
+		StatePageList& list = state.pageLists[listIndex];
+		list.pageBeginIndex = state.pages.getSize();
+		list.pageCount = listRecords[listIndex].pageCount;
+		list.elementCount = listRecords[listIndex].elementCount;
+
+		for (uint32 i = 0; i < list.pageCount; i++)
+		{
+			const bool emitted = emittedPageIndex < header.emittedPageCount &&
+				pageRecords[emittedPageIndex].listIndex == listIndex &&
+				pageRecords[emittedPageIndex].pageIndex == i;
+
+			Page* page = nullptr;
+			if (emitted)
+			{
+				page = allocatePage();
+				memoryCopy(page, pagesData + uintptr(emittedPageIndex) * PageSize, PageSize);
+				emittedPageIndex++;
+			}
+			else
+			{
+				page = baseState->pages[baseState->pageLists[listIndex].pageBeginIndex + i];
+				addPageReference(page);
+			}
+
+			state.pages.pushBack(page);
+		}
+	}
+
+	return handle;
 }
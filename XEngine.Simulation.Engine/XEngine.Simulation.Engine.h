@@ -2,67 +2,195 @@
 
 #include <XLib.h>
 #include <XLib.NonCopyable.h>
+#include <XLib.Containers.ArrayList.h>
+
+#include <XEngine.Simulation.Model.h>
 
 namespace XEngine::Simulation
 {
-	class Model;
-
 	// class ViewOperativeState;
 	// class ViewOperativeStateDelta;
 
+	// State slot index plus one. `Zero` is null handle.
 	enum class StateHandle : uint16 { Zero = 0, };
 
+	// Low 32 bits are entity record index, high 32 bits are record generation.
+	enum class EntityId : uint64 { Invalid = uint64(-1), };
+
+	// Engine mutates single operative state. Every `tick` (or explicit capture) produces immutable
+	// state, that can be used to reset operative state later (rollback/replay) or serialized.
+	//
+	// States share pages copy-on-write: capture just references all pages of operative state, and
+	// page is copied only when operative state is about to write to page that is also referenced by
+	// some state. So many live states cost about one state worth of memory plus pages that were
+	// changed in between.
+	//
+	// Tick runs on thread pool. Jobs of each archetype are split into groups that do not share
+	// written components (based on job access masks). Work is cut into waves of fixed page ranges
+	// per job group, so results do not depend on thread count. Archetypes never share pages, so
+	// waves of different archetypes are always independent.
+
 	class Engine : public XLib::NonCopyable
 	{
 	private:
-		static constexpr uint32 PageSize = 1024 * 16;
+		static constexpr uint32 PageSize = ModelInternals::PageSize;
+		static constexpr uint32 WavePageCount = 4;
 
 	private:
-		struct WaveEntityRecord
+		struct Page
 		{
-			uint64 entityId;
+			ModelInternals::PageHeader header;
+			byte _data[PageSize - sizeof(ModelInternals::PageHeader)];
 		};
 
-		struct Page
+		// Archetype entities are densely packed: row `i` is in page `i / entitiesPerPage`, so only
+		// last page can be partially filled.
+		struct ArchetypeStorage
 		{
+			ModelInternals::ArchetypePageLayout layout;
+			uint16 componentSizes[ModelInternals::MaxArchetypeComponentCount];
+			uint16 componentCount;
 
+			uint16 jobGroupBeginIndex;
+			uint16 jobGroupCount;
+			bool hasWritingJobs;
+
+			XLib::ArrayList<Page*> pages;
+			uint32 entityCount;
 		};
 
-		struct Wave
+		// Jobs in group run sequentially in model order. Different groups can run concurrently.
+		struct JobGroup
+		{
+			uint16 jobIndicesBeginIndex;
+			uint16 jobCount;
+		};
+
+		// Entity records are stored in pages as well, so they are captured with the rest of state.
+		struct EntityRecord
 		{
+			uint32 rowIndex; // Next free record index, if record is free.
+			uint32 generation;
 			uint16 archetypeIndex;
+		};
+
+		static constexpr uint32 EntityRecordsPerPage = PageSize / sizeof(EntityRecord);
+
+		// State consists of page lists: one per archetype followed by entity records list.
+		struct StatePageList
+		{
+			uint32 pageBeginIndex;
+			uint32 pageCount;
+			uint32 elementCount; // Entities for archetype list, records for entity records list.
+		};
+
+		struct State
+		{
+			XLib::ArrayList<Page*> pages;
+			XLib::ArrayList<StatePageList> pageLists;
+			uint32 freeEntityRecordsHead;
+			uint32 nextFreeStateIndex;
+			bool isAllocated;
+		};
 
-			WaveEntityRecord* entityRecords;
-			uint8 entityCount;
+		struct Wave
+		{
+			uint16 archetypeIndex;
+			uint16 jobGroupIndex;
+			uint32 pageBeginIndex;
+			uint32 pageEndIndex;
+		};
 
+		struct PageCopy
+		{
+			const Page* source;
+			Page* destination;
 		};
 
 	private:
 		const Model* model = nullptr;
 
-		Wave* waves = nullptr;
-		uint32 waveCount = 0;
+		byte* pagePool = nullptr;
+		uint32 pagePoolPageCount = 0;
+		Page* freePagesList = nullptr;
+		uint32 freePageCount = 0;
+		XLib::ArrayList<uint32> pageReferenceCounts;
+
+		// Operative state.
+		XLib::ArrayList<ArchetypeStorage> archetypeStorages;
+		XLib::ArrayList<Page*> entityRecordPages;
+		uint32 entityRecordCount = 0;
+		uint32 freeEntityRecordsHead = uint32(-1);
+
+		XLib::ArrayList<State> states;
+		uint32 freeStatesHead = uint32(-1);
+
+		XLib::ArrayList<JobGroup> jobGroups;
+		XLib::ArrayList<uint16> jobGroupJobIndices;
+
+		XLib::ArrayList<Wave> waves;
+		XLib::ArrayList<PageCopy> pendingPageCopies;
 
 	private:
-		void tickWave(Wave& wave);
+		Page* allocatePage();
+		inline void addPageReference(Page* page);
+		void releasePageReference(Page* page);
+		inline void makePageWritable(Page*& page);
+
+		inline uint32 getPageListCount() const;
+		inline XLib::ArrayList<Page*>& getOperativePageList(uint32 listIndex);
+		inline uint32& getOperativePageListElementCount(uint32 listIndex);
+
+		State& allocateState(StateHandle& outHandle);
+		inline State* resolveStateHandle(StateHandle handle);
+		inline const State* resolveStateHandle(StateHandle handle) const;
+		static inline bool IsStatePageChanged(const State& state, const State* baseState, uint32 listIndex, uint32 pageIndex);
+		bool validateSerializedState(const XLib::ArrayList<const Page*>& pages,
+			const XLib::ArrayList<uint32>& pageListElementCounts, uint32 freeEntityRecordsHead) const;
+
+		inline const EntityRecord* resolveEntityId(EntityId id) const;
+		inline EntityRecord& getWritableEntityRecord(uint32 recordIndex);
+		inline byte* getWritableComponentPointer(ArchetypeStorage& storage, uint32 rowIndex, uint16 componentIndex);
+
+	private:
+		void buildJobGroups(ArchetypeStorage& storage, const ModelInternals::Archetype& archetype);
+		void tickWave(const Wave& wave) const;
 
 	public:
 		Engine() = default;
 		~Engine() = default;
 
-		void initialize(const Model& model, const void* memoryPool, uintptr memoryPoolSize);
+		// Memory pool should be `PageSize` aligned. All entity pages of operative state and all
+		// captured states are allocated from it.
+		void initialize(const Model& model, void* memoryPool, uintptr memoryPoolSize);
 		void destroy();
 
-		StateHandle deserializeState(const void* data, uintptr size);
-		void serializeState(StateHandle state);
+		// New entity components are zeroed.
+		EntityId createEntity(uint16 archetypeIndex);
+		// Last entity of archetype is moved into the hole, so component pointers are invalidated.
+		void destroyEntity(EntityId id);
 
-		void dropOperativeState();
-		void resetOperativeState(StateHandle state);
+		// Pointer is valid until next entity creation or destruction, tick or operative state reset.
+		void* getEntityComponent(EntityId id, uint16 archetypeComponentIndex);
+		uint32 getArchetypeEntityCount(uint16 archetypeIndex) const;
 
+		// Advances operative state and captures result.
 		StateHandle tick();
 
+		StateHandle captureOperativeState();
+		void resetOperativeState(StateHandle state);
+		void dropOperativeState();
+
 		void releaseState(StateHandle state);
 
+		// If `baseState` is not `StateHandle::Zero`, only pages that differ from base state are
+		// written. Same base state should be passed to `deserializeState` on the other side.
+		uintptr getSerializedStateSize(StateHandle state, StateHandle baseState = StateHandle::Zero) const;
+		void serializeState(StateHandle state, StateHandle baseState, void* buffer, uintptr bufferSize) const;
+
+		// Returns `StateHandle::Zero` if data is malformed or does not match base state.
+		StateHandle deserializeState(const void* data, uintptr size, StateHandle baseState = StateHandle::Zero);
+
 		//void createView();
 		//void destroyView();
 
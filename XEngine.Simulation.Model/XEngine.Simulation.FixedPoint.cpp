@@ -0,0 +1,375 @@
+#include <intrin.h>
+#include <immintrin.h>
+
+#include <XLib.System.Threading.Atomics.h>
+
+#include "XEngine.Simulation.FixedPoint.h"
+
+using namespace XLib;
+using namespace XEngine::Simulation;
+
+// Q16.16 product is bits [16, 48) of 64-bit integer product. SSE/AVX2 can multiply only even 32-bit
+// lanes into 64-bit results (`pmuldq`), so odd lanes are shifted down, multiplied separately and
+// merged back. 64-bit sums wrap same way as `uint64` sums in scalar code, and logical shift keeps
+// same low 32 bits as arithmetic one, so every width gives bit-identical results.
+
+namespace
+{
+	struct ScalarISA
+	{
+		static constexpr uint32 Width = 1;
+	};
+
+	struct SSE4ISA
+	{
+		using Vec = __m128i;
+		static constexpr uint32 Width = 4;
+
+		static inline Vec Load(const Fixed* ptr) { return _mm_loadu_si128((const __m128i*)ptr); }
+		static inline void Store(Fixed* ptr, Vec v) { _mm_storeu_si128((__m128i*)ptr, v); }
+		static inline Vec Broadcast(Fixed value) { return _mm_set1_epi32(value.raw); }
+
+		static inline Vec Add32(Vec a, Vec b) { return _mm_add_epi32(a, b); }
+		static inline Vec Sub32(Vec a, Vec b) { return _mm_sub_epi32(a, b); }
+		static inline Vec Add64(Vec a, Vec b) { return _mm_add_epi64(a, b); }
+		static inline Vec MulEven(Vec a, Vec b) { return _mm_mul_epi32(a, b); }
+		static inline Vec MulOdd(Vec a, Vec b) { return _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32)); }
+
+		// Takes bits [16, 48) of 64-bit even and odd lane values.
+		static inline Vec MergeProducts(Vec even, Vec odd)
+		{
+			return _mm_blend_epi16(_mm_srli_epi64(even, Fixed::FractionBitCount), _mm_slli_epi64(odd, 32 - Fixed::FractionBitCount), 0xCC);
+		}
+
+		static inline void StoreEven64(uint64* ptr, Vec even, Vec odd)
+		{
+			// Lane order: 0, 2 from even, 1, 3 from odd.
+			_mm_storeu_si128((__m128i*)ptr, _mm_unpacklo_epi64(even, odd));
+			_mm_storeu_si128((__m128i*)(ptr + 2), _mm_unpackhi_epi64(even, odd));
+		}
+	};
+
+	struct AVX2ISA
+	{
+		using Vec = __m256i;
+		static constexpr uint32 Width = 8;
+
+		static inline Vec Load(const Fixed* ptr) { return _mm256_loadu_si256((const __m256i*)ptr); }
+		static inline void Store(Fixed* ptr, Vec v) { _mm256_storeu_si256((__m256i*)ptr, v); }
+		static inline Vec Broadcast(Fixed value) { return _mm256_set1_epi32(value.raw); }
+
+		static inline Vec Add32(Vec a, Vec b) { return _mm256_add_epi32(a, b); }
+		static inline Vec Sub32(Vec a, Vec b) { return _mm256_sub_epi32(a, b); }
+		static inline Vec Add64(Vec a, Vec b) { return _mm256_add_epi64(a, b); }
+		static inline Vec MulEven(Vec a, Vec b) { return _mm256_mul_epi32(a, b); }
+		static inline Vec MulOdd(Vec a, Vec b) { return _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)); }
+
+		static inline Vec MergeProducts(Vec even, Vec odd)
+		{
+			return _mm256_blend_epi32(_mm256_srli_epi64(even, Fixed::FractionBitCount), _mm256_slli_epi64(odd, 32 - Fixed::FractionBitCount), 0xAA);
+		}
+
+		static inline void StoreEven64(uint64* ptr, Vec even, Vec odd)
+		{
+			// Unpack works within 128-bit halves: low half gives lanes 0-3, high half gives 4-7.
+			const __m256i lo = _mm256_unpacklo_epi64(even, odd); // 0, 1, 4, 5
+			const __m256i hi = _mm256_unpackhi_epi64(even, odd); // 2, 3, 6, 7
+			_mm256_storeu_si256((__m256i*)ptr, _mm256_permute2x128_si256(lo, hi, 0x20));
+			_mm256_storeu_si256((__m256i*)(ptr + 4), _mm256_permute2x128_si256(lo, hi, 0x31));
+		}
+	};
+
+	inline uint64 Product64(Fixed a, Fixed b) { return uint64(sint64(a.raw) * sint64(b.raw)); }
+
+	inline void NormalizeLane(Fixed* x, Fixed* y, Fixed* z, uint64 lengthSq)
+	{
+		const Fixed length = Fixed::FromRaw(sint32(FixedMath::ISqrt64(lengthSq)));
+		if (length.raw == 0)
+			return;
+		*x = *x / length;
+		*y = *y / length;
+		if (z)
+			*z = *z / length;
+	}
+
+	// Every kernel processes full vectors first and then finishes tail with scalar code. Scalar
+	// width is just empty vector part.
+
+	template <typename ISA>
+	void AddImpl(const Fixed* a, const Fixed* b, Fixed* result, uint32 count)
+	{
+		uint32 i = 0;
+		if constexpr (ISA::Width > 1)
+		{
+			for (; i + ISA::Width <= count; i += ISA::Width)
+				ISA::Store(result + i, ISA::Add32(ISA::Load(a + i), ISA::Load(b + i)));
+		}
+		for (; i < count; i++)
+			result[i] = a[i] + b[i];
+	}
+
+	template <typename ISA>
+	void SubImpl(const Fixed* a, const Fixed* b, Fixed* result, uint32 count)
+	{
+		uint32 i = 0;
+		if constexpr (ISA::Width > 1)
+		{
+			for (; i + ISA::Width <= count; i += ISA::Width)
+				ISA::Store(result + i, ISA::Sub32(ISA::Load(a + i), ISA::Load(b + i)));
+		}
+		for (; i < count; i++)
+			result[i] = a[i] - b[i];
+	}
+
+	template <typename ISA>
+	void MulImpl(const Fixed* a, const Fixed* b, Fixed* result, uint32 count)
+	{
+		uint32 i = 0;
+		if constexpr (ISA::Width > 1)
+		{
+			for (; i + ISA::Width <= count; i += ISA::Width)
+			{
+				const typename ISA::Vec va = ISA::Load(a + i);
+				const typename ISA::Vec vb = ISA::Load(b + i);
+				ISA::Store(result + i, ISA::MergeProducts(ISA::MulEven(va, vb), ISA::MulOdd(va, vb)));
+			}
+		}
+		for (; i < count; i++)
+			result[i] = a[i] * b[i];
+	}
+
+	template <typename ISA>
+	void MulScalarImpl(const Fixed* a, Fixed b, Fixed* result, uint32 count)
+	{
+		uint32 i = 0;
+		if constexpr (ISA::Width > 1)
+		{
+			const typename ISA::Vec vb = ISA::Broadcast(b);
+			for (; i + ISA::Width <= count; i += ISA::Width)
+			{
+				const typename ISA::Vec va = ISA::Load(a + i);
+				ISA::Store(result + i, ISA::MergeProducts(ISA::MulEven(va, vb), ISA::MulOdd(va, vb)));
+			}
+		}
+		for (; i < count; i++)
+			result[i] = a[i] * b;
+	}
+
+	template <typename ISA>
+	void Dot2Impl(const Fixed* ax, const Fixed* ay, const Fixed* bx, const Fixed* by, Fixed* result, uint32 count)
+	{
+		uint32 i = 0;
+		if constexpr (ISA::Width > 1)
+		{
+			for (; i + ISA::Width <= count; i += ISA::Width)
+			{
+				const typename ISA::Vec vax = ISA::Load(ax + i), vay = ISA::Load(ay + i);
+				const typename ISA::Vec vbx = ISA::Load(bx + i), vby = ISA::Load(by + i);
+				const typename ISA::Vec even = ISA::Add64(ISA::MulEven(vax, vbx), ISA::MulEven(vay, vby));
+				const typename ISA::Vec odd = ISA::Add64(ISA::MulOdd(vax, vbx), ISA::MulOdd(vay, vby));
+				ISA::Store(result + i, ISA::MergeProducts(even, odd));
+			}
+		}
+		for (; i < count; i++)
+			result[i] = FixedMath::Dot(FixedVec2(ax[i], ay[i]), FixedVec2(bx[i], by[i]));
+	}
+
+	template <typename ISA>
+	void Dot3Impl(const Fixed* ax, const Fixed* ay, const Fixed* az,
+		const Fixed* bx, const Fixed* by, const Fixed* bz, Fixed* result, uint32 count)
+	{
+		uint32 i = 0;
+		if constexpr (ISA::Width > 1)
+		{
+			for (; i + ISA::Width <= count; i += ISA::Width)
+			{
+				const typename ISA::Vec vax = ISA::Load(ax + i), vay = ISA::Load(ay + i), vaz = ISA::Load(az + i);
+				const typename ISA::Vec vbx = ISA::Load(bx + i), vby = ISA::Load(by + i), vbz = ISA::Load(bz + i);
+				const typename ISA::Vec even = ISA::Add64(ISA::Add64(ISA::MulEven(vax, vbx), ISA::MulEven(vay, vby)), ISA::MulEven(vaz, vbz));
+				const typename ISA::Vec odd = ISA::Add64(ISA::Add64(ISA::MulOdd(vax, vbx), ISA::MulOdd(vay, vby)), ISA::MulOdd(vaz, vbz));
+				ISA::Store(result + i, ISA::MergeProducts(even, odd));
+			}
+		}
+		for (; i < count; i++)
+			result[i] = FixedMath::Dot(FixedVec3(ax[i], ay[i], az[i]), FixedVec3(bx[i], by[i], bz[i]));
+	}
+
+	// Squared lengths are computed with vectors. Square root and division have no exact SIMD
+	// integer form, so they are done per lane with same code scalar `FixedMath::Normalize` uses.
+	template <typename ISA>
+	void NormalizeImpl(Fixed* x, Fixed* y, Fixed* z, uint32 count)
+	{
+		uint32 i = 0;
+		if constexpr (ISA::Width > 1)
+		{
+			uint64 lengthsSq[ISA::Width];
+			for (; i + ISA::Width <= count; i += ISA::Width)
+			{
+				const typename ISA::Vec vx = ISA::Load(x + i), vy = ISA::Load(y + i);
+				typename ISA::Vec even = ISA::Add64(ISA::MulEven(vx, vx), ISA::MulEven(vy, vy));
+				typename ISA::Vec odd = ISA::Add64(ISA::MulOdd(vx, vx), ISA::MulOdd(vy, vy));
+				if (z)
+				{
+					const typename ISA::Vec vz = ISA::Load(z + i);
+					even = ISA::Add64(even, ISA::MulEven(vz, vz));
+					odd = ISA::Add64(odd, ISA::MulOdd(vz, vz));
+				}
+				ISA::StoreEven64(lengthsSq, even, odd);
+
+				for (uint32 j = 0; j < ISA::Width; j++)
+					NormalizeLane(x + i + j, y + i + j, z ? z + i + j : nullptr, lengthsSq[j]);
+			}
+		}
+		for (; i < count; i++)
+		{
+			uint64 lengthSq = Product64(x[i], x[i]) + Product64(y[i], y[i]);
+			if (z)
+				lengthSq += Product64(z[i], z[i]);
+			NormalizeLane(x + i, y + i, z ? z + i : nullptr, lengthSq);
+		}
+	}
+
+	template <typename ISA>
+	void Normalize2Impl(Fixed* x, Fixed* y, uint32 count) { NormalizeImpl<ISA>(x, y, nullptr, count); }
+
+	template <typename ISA>
+	void Normalize3Impl(Fixed* x, Fixed* y, Fixed* z, uint32 count) { NormalizeImpl<ISA>(x, y, z, count); }
+
+	template <typename ISA>
+	void IntegrateImpl(Fixed* position, const Fixed* velocity, Fixed dt, uint32 count)
+	{
+		uint32 i = 0;
+		if constexpr (ISA::Width > 1)
+		{
+			const typename ISA::Vec vdt = ISA::Broadcast(dt);
+			for (; i + ISA::Width <= count; i += ISA::Width)
+			{
+				const typename ISA::Vec vv = ISA::Load(velocity + i);
+				const typename ISA::Vec delta = ISA::MergeProducts(ISA::MulEven(vv, vdt), ISA::MulOdd(vv, vdt));
+				ISA::Store(position + i, ISA::Add32(ISA::Load(position + i), delta));
+			}
+		}
+		for (; i < count; i++)
+			position[i] += velocity[i] * dt;
+	}
+
+	struct Kernels
+	{
+		FixedBatchWidth width;
+		decltype(&AddImpl<ScalarISA>) add;
+		decltype(&SubImpl<ScalarISA>) sub;
+		decltype(&MulImpl<ScalarISA>) mul;
+		decltype(&MulScalarImpl<ScalarISA>) mulScalar;
+		decltype(&Dot2Impl<ScalarISA>) dot2;
+		decltype(&Dot3Impl<ScalarISA>) dot3;
+		decltype(&Normalize2Impl<ScalarISA>) normalize2;
+		decltype(&Normalize3Impl<ScalarISA>) normalize3;
+		decltype(&IntegrateImpl<ScalarISA>) integrate;
+	};
+
+	template <typename ISA>
+	constexpr Kernels ComposeKernels(FixedBatchWidth width)
+	{
+		return Kernels { width,
+			AddImpl<ISA>, SubImpl<ISA>, MulImpl<ISA>, MulScalarImpl<ISA>, Dot2Impl<ISA>, Dot3Impl<ISA>,
+			Normalize2Impl<ISA>, Normalize3Impl<ISA>, IntegrateImpl<ISA> };
+	}
+
+	constexpr Kernels ScalarKernels = ComposeKernels<ScalarISA>(FixedBatchWidth::Scalar);
+	constexpr Kernels SSE4Kernels = ComposeKernels<SSE4ISA>(FixedBatchWidth::SSE4);
+	constexpr Kernels AVX2Kernels = ComposeKernels<AVX2ISA>(FixedBatchWidth::AVX2);
+
+	FixedBatchWidth DetectMaxSupportedWidth()
+	{
+		int cpuInfo[4] = {};
+		__cpuid(cpuInfo, 0);
+		const int maxLeaf = cpuInfo[0];
+
+		__cpuid(cpuInfo, 1);
+		const bool sse41 = (cpuInfo[2] & (1 << 19)) != 0;
+		const bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+		const bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+		if (!sse41)
+			return FixedBatchWidth::Scalar;
+
+		// AVX state should also be enabled by OS.
+		if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+		{
+			__cpuidex(cpuInfo, 7, 0);
+			if (cpuInfo[1] & (1 << 5))
+				return FixedBatchWidth::AVX2;
+		}
+
+		return FixedBatchWidth::SSE4;
+	}
+
+	const Kernels* SelectKernels(FixedBatchWidth width)
+	{
+		switch (width)
+		{
+			case FixedBatchWidth::Scalar:	return &ScalarKernels;
+			case FixedBatchWidth::SSE4:		return &SSE4Kernels;
+			case FixedBatchWidth::AVX2:		return &AVX2Kernels;
+		}
+		XAssertUnreachableCode();
+		return nullptr;
+	}
+
+	// Zero-initialized, so it is valid before any dynamic initialization. Default table is only
+	// installed if nothing is set yet, so racing first call can not override `SetWidth`.
+	Atomic<const Kernels*> currentKernels;
+
+	inline const Kernels& GetKernels()
+	{
+		const Kernels* kernels = currentKernels.loadAcquire();
+		if (!kernels)
+		{
+			currentKernels.compareExchange(nullptr, SelectKernels(FixedBatch::GetMaxSupportedWidth()));
+			kernels = currentKernels.loadAcquire();
+		}
+		return *kernels;
+	}
+}
+
+void FixedBatch::Add(const Fixed* a, const Fixed* b, Fixed* result, uint32 count) { GetKernels().add(a, b, result, count); }
+void FixedBatch::Sub(const Fixed* a, const Fixed* b, Fixed* result, uint32 count) { GetKernels().sub(a, b, result, count); }
+void FixedBatch::Mul(const Fixed* a, const Fixed* b, Fixed* result, uint32 count) { GetKernels().mul(a, b, result, count); }
+void FixedBatch::MulScalar(const Fixed* a, Fixed b, Fixed* result, uint32 count) { GetKernels().mulScalar(a, b, result, count); }
+
+void FixedBatch::Dot2(const Fixed* ax, const Fixed* ay, const Fixed* bx, const Fixed* by, Fixed* result, uint32 count)
+{
+	GetKernels().dot2(ax, ay, bx, by, result, count);
+}
+
+void FixedBatch::Dot3(const Fixed* ax, const Fixed* ay, const Fixed* az,
+	const Fixed* bx, const Fixed* by, const Fixed* bz, Fixed* result, uint32 count)
+{
+	GetKernels().dot3(ax, ay, az, bx, by, bz, result, count);
+}
+
+void FixedBatch::Normalize2(Fixed* x, Fixed* y, uint32 count) { GetKernels().normalize2(x, y, count); }
+void FixedBatch::Normalize3(Fixed* x, Fixed* y, Fixed* z, uint32 count) { GetKernels().normalize3(x, y, z, count); }
+
+void FixedBatch::Integrate(Fixed* position, const Fixed* velocity, Fixed dt, uint32 count)
+{
+	GetKernels().integrate(position, velocity, dt, count);
+}
+
+void FixedBatch::SetWidth(FixedBatchWidth width)
+{
+	if (width == FixedBatchWidth::Default)
+		width = GetMaxSupportedWidth();
+	XAssert(uint8(width) <= uint8(GetMaxSupportedWidth()));
+	currentKernels.storeRelease(SelectKernels(width));
+}
+
+FixedBatchWidth FixedBatch::GetWidth()
+{
+	return GetKernels().width;
+}
+
+FixedBatchWidth FixedBatch::GetMaxSupportedWidth()
+{
+	static const FixedBatchWidth maxSupportedWidth = DetectMaxSupportedWidth();
+	return maxSupportedWidth;
+}
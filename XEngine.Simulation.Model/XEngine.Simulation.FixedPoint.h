@@ -0,0 +1,200 @@
+#pragma once
+
+#include <XLib.h>
+#include <XLib.Vectors.h>
+#include <XLib.Vectors.Arithmetics.h>
+
+// Deterministic math for simulation jobs. Everything here is integer arithmetic with defined
+// wrap-around on overflow, so results are bit-exact across machines, compilers and SIMD widths.
+// Floats are only allowed to produce constants (`Fixed::FromFloat`) and for presentation.
+
+namespace XEngine::Simulation
+{
+	// Signed Q16.16 fixed-point number.
+	struct Fixed
+	{
+		static constexpr uint32 FractionBitCount = 16;
+		static constexpr sint32 OneRaw = sint32(1) << FractionBitCount;
+
+		sint32 raw;
+
+		Fixed() = default;
+
+		static constexpr Fixed FromRaw(sint32 raw) { Fixed result = {}; result.raw = raw; return result; }
+		static constexpr Fixed FromInt(sint32 value) { return FromRaw(sint32(uint32(value) << FractionBitCount)); }
+		static constexpr Fixed FromFloat(float64 value) { return FromRaw(sint32(value * float64(OneRaw) + (value < 0.0 ? -0.5 : 0.5))); }
+
+		constexpr sint32 toIntFloor() const { return raw >> FractionBitCount; }
+		constexpr float64 toFloat() const { return float64(raw) / float64(OneRaw); }
+	};
+
+	static_assert(sizeof(Fixed) == sizeof(sint32));
+
+	using FixedVec2 = vec2<Fixed>;
+	using FixedVec3 = vec3<Fixed>;
+
+	constexpr Fixed operator + (Fixed a, Fixed b) { return Fixed::FromRaw(sint32(uint32(a.raw) + uint32(b.raw))); }
+	constexpr Fixed operator - (Fixed a, Fixed b) { return Fixed::FromRaw(sint32(uint32(a.raw) - uint32(b.raw))); }
+	constexpr Fixed operator - (Fixed a) { return Fixed::FromRaw(sint32(0 - uint32(a.raw))); }
+
+	// Product is rounded towards negative infinity.
+	constexpr Fixed operator * (Fixed a, Fixed b) { return Fixed::FromRaw(sint32(uint64(sint64(a.raw) * sint64(b.raw)) >> Fixed::FractionBitCount)); }
+
+	// Quotient is rounded towards zero. Divisor should not be zero.
+	constexpr Fixed operator / (Fixed a, Fixed b);
+
+	constexpr Fixed& operator += (Fixed& a, Fixed b) { a = a + b; return a; }
+	constexpr Fixed& operator -= (Fixed& a, Fixed b) { a = a - b; return a; }
+	constexpr Fixed& operator *= (Fixed& a, Fixed b) { a = a * b; return a; }
+	constexpr Fixed& operator /= (Fixed& a, Fixed b) { a = a / b; return a; }
+
+	constexpr bool operator == (Fixed a, Fixed b) { return a.raw == b.raw; }
+	constexpr bool operator != (Fixed a, Fixed b) { return a.raw != b.raw; }
+	constexpr bool operator < (Fixed a, Fixed b) { return a.raw < b.raw; }
+	constexpr bool operator > (Fixed a, Fixed b) { return a.raw > b.raw; }
+	constexpr bool operator <= (Fixed a, Fixed b) { return a.raw <= b.raw; }
+	constexpr bool operator >= (Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+	class FixedMath abstract final
+	{
+	public:
+		static constexpr Fixed Abs(Fixed value) { return value.raw < 0 ? -value : value; }
+		static constexpr Fixed Min(Fixed a, Fixed b) { return a.raw < b.raw ? a : b; }
+		static constexpr Fixed Max(Fixed a, Fixed b) { return a.raw > b.raw ? a : b; }
+		static constexpr Fixed Clamp(Fixed value, Fixed lo, Fixed hi) { return Min(Max(value, lo), hi); }
+
+		// Rounded down. Negative argument gives zero.
+		static constexpr Fixed Sqrt(Fixed value);
+
+		// Integer square root of 64-bit value, rounded down.
+		static constexpr uint32 ISqrt64(uint64 value);
+
+		// Products are summed exactly in 64 bits and rounded once.
+		static constexpr Fixed Dot(const FixedVec2& a, const FixedVec2& b);
+		static constexpr Fixed Dot(const FixedVec3& a, const FixedVec3& b);
+
+		static constexpr Fixed Length(const FixedVec2& v);
+		static constexpr Fixed Length(const FixedVec3& v);
+
+		// Zero vector stays zero. Components should not exceed 2^14 in magnitude.
+		static constexpr FixedVec2 Normalize(const FixedVec2& v);
+		static constexpr FixedVec3 Normalize(const FixedVec3& v);
+	};
+
+	// Batch kernels over structure-of-arrays columns (for example page columns given to jobs).
+	// Every kernel has scalar, 4-wide (SSE4.1) and 8-wide (AVX2) implementation, and all of them
+	// produce exactly the same result as corresponding `Fixed` / `FixedMath` scalar operation.
+	// Widest width supported by CPU is selected on first use. Output may alias any input.
+
+	enum class FixedBatchWidth : uint8
+	{
+		Default = 0,
+		Scalar = 1,
+		SSE4 = 4,
+		AVX2 = 8,
+	};
+
+	class FixedBatch abstract final
+	{
+	public:
+		static void Add(const Fixed* a, const Fixed* b, Fixed* result, uint32 count);
+		static void Sub(const Fixed* a, const Fixed* b, Fixed* result, uint32 count);
+		static void Mul(const Fixed* a, const Fixed* b, Fixed* result, uint32 count);
+		static void MulScalar(const Fixed* a, Fixed b, Fixed* result, uint32 count);
+
+		static void Dot2(const Fixed* ax, const Fixed* ay, const Fixed* bx, const Fixed* by, Fixed* result, uint32 count);
+		static void Dot3(const Fixed* ax, const Fixed* ay, const Fixed* az,
+			const Fixed* bx, const Fixed* by, const Fixed* bz, Fixed* result, uint32 count);
+
+		// In place.
+		static void Normalize2(Fixed* x, Fixed* y, uint32 count);
+		static void Normalize3(Fixed* x, Fixed* y, Fixed* z, uint32 count);
+
+		// `position += velocity * dt`.
+		static void Integrate(Fixed* position, const Fixed* velocity, Fixed dt, uint32 count);
+
+		// Meant for determinism tests and benchmarks. Width should be supported by CPU.
+		static void SetWidth(FixedBatchWidth width);
+		static FixedBatchWidth GetWidth();
+		static FixedBatchWidth GetMaxSupportedWidth();
+	};
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+
+constexpr XEngine::Simulation::Fixed XEngine::Simulation::operator / (Fixed a, Fixed b)
+{
+	XAssert(b.raw != 0);
+	return Fixed::FromRaw(sint32(uint64((sint64(a.raw) * Fixed::OneRaw) / b.raw)));
+}
+
+constexpr XEngine::Simulation::Fixed XEngine::Simulation::FixedMath::Sqrt(Fixed value)
+{
+	if (value.raw <= 0)
+		return Fixed::FromRaw(0);
+	return Fixed::FromRaw(sint32(ISqrt64(uint64(value.raw) << Fixed::FractionBitCount)));
+}
+
+constexpr uint32 XEngine::Simulation::FixedMath::ISqrt64(uint64 value)
+{
+	// Digit-by-digit method. Fixed number of iterations, no floats.
+	uint64 result = 0;
+	uint64 bit = uint64(1) << 62;
+	while (bit > value)
+		bit >>= 2;
+
+	while (bit != 0)
+	{
+		if (value >= result + bit)
+		{
+			value -= result + bit;
+			result = (result >> 1) + bit;
+		}
+		else
+			result >>= 1;
+		bit >>= 2;
+	}
+	return uint32(result);
+}
+
+constexpr XEngine::Simulation::Fixed XEngine::Simulation::FixedMath::Dot(const FixedVec2& a, const FixedVec2& b)
+{
+	const uint64 sum = uint64(sint64(a.x.raw) * b.x.raw) + uint64(sint64(a.y.raw) * b.y.raw);
+	return Fixed::FromRaw(sint32(sum >> Fixed::FractionBitCount));
+}
+
+constexpr XEngine::Simulation::Fixed XEngine::Simulation::FixedMath::Dot(const FixedVec3& a, const FixedVec3& b)
+{
+	const uint64 sum = uint64(sint64(a.x.raw) * b.x.raw) + uint64(sint64(a.y.raw) * b.y.raw) + uint64(sint64(a.z.raw) * b.z.raw);
+	return Fixed::FromRaw(sint32(sum >> Fixed::FractionBitCount));
+}
+
+constexpr XEngine::Simulation::Fixed XEngine::Simulation::FixedMath::Length(const FixedVec2& v)
+{
+	const uint64 lengthSq = uint64(sint64(v.x.raw) * v.x.raw) + uint64(sint64(v.y.raw) * v.y.raw);
+	return Fixed::FromRaw(sint32(ISqrt64(lengthSq)));
+}
+
+constexpr XEngine::Simulation::Fixed XEngine::Simulation::FixedMath::Length(const FixedVec3& v)
+{
+	const uint64 lengthSq = uint64(sint64(v.x.raw) * v.x.raw) + uint64(sint64(v.y.raw) * v.y.raw) + uint64(sint64(v.z.raw) * v.z.raw);
+	return Fixed::FromRaw(sint32(ISqrt64(lengthSq)));
+}
+
+constexpr XEngine::Simulation::FixedVec2 XEngine::Simulation::FixedMath::Normalize(const FixedVec2& v)
+{
+	const Fixed length = Length(v);
+	if (length.raw == 0)
+		return v;
+	return FixedVec2(v.x / length, v.y / length);
+}
+
+constexpr XEngine::Simulation::FixedVec3 XEngine::Simulation::FixedMath::Normalize(const FixedVec3& v)
+{
+	const Fixed length = Length(v);
+	if (length.raw == 0)
+		return v;
+	return FixedVec3(v.x / length, v.y / length, v.z / length);
+}
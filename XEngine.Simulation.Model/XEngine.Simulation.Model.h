@@ -1,33 +1,143 @@
+#pragma once
+
 #include <XLib.h>
 
+// Entities of each archetype are stored in fixed size pages. Page starts with `PageHeader` followed
+// by structure-of-arrays columns: entity ids and then one column per archetype component. Every
+// column starts at `PageColumnAlignment` boundary, so jobs can process whole page with aligned
+// vector loads. Same layout is computed by model compiler, so it can be baked into job kernels.
+
 namespace XEngine::Simulation
 {
 	namespace ModelInternals
 	{
+		static constexpr uint32 PageSize = 1024 * 16;
+		static constexpr uint32 PageHeaderSize = 64;
+		static constexpr uint32 PageColumnAlignment = 64;
+		static constexpr uint16 MaxArchetypeComponentCount = 32; // Access masks are 32-bit.
+
+		struct PageHeader
+		{
+			uint32 entityCount;
+		};
+
+		struct Component
+		{
+			uint16 size;
+			uint16 alignment; // Should not exceed `PageColumnAlignment`.
+		};
+
+		struct ArchetypePageLayout
+		{
+			uint16 columnOffsets[MaxArchetypeComponentCount]; // From page start.
+			uint16 entityIdsColumnOffset;
+			uint16 entitiesPerPage;
+		};
+
 		struct JobExecutorContext
 		{
+			// Compiled kernels address columns directly by page offsets baked into them.
+			void* page;
 
+			// Column base pointers in archetype component order.
+			// Component of entity `i` is at `columns[c] + i * componentSize`.
+			void* const* columns;
+			const uint64* entityIds;
+
+			uint32 entityBeginIndex;
+			uint32 entityEndIndex;
 		};
 
-		using JobExecutorFunc = void(*)(JobExecutorContext& context);
+		using JobExecutorFunc = void(*)(const JobExecutorContext& context);
 
+		// Access masks are bitsets of archetype component slots (same order as `columns`). Engine
+		// uses them to find jobs that can run concurrently and pages that need to be copied.
 		struct Job
 		{
 			JobExecutorFunc executorFunc;
+			uint32 readComponentsMask;
+			uint32 writeComponentsMask;
 		};
 
 		struct Archetype
 		{
 			uint32 id;
 
+			const uint16* componentIndices; // Into `Model::components`.
+			uint16 componentCount;
+
 			const Job* jobs;
 			uint16 jobCount;
+
+			// Optional. Set by model compiler, which bakes these offsets into job kernels.
+			const ArchetypePageLayout* pageLayout;
 		};
+
+		constexpr ArchetypePageLayout ComputeArchetypePageLayout(const Component* components,
+			const uint16* componentIndices, uint16 componentCount);
 	}
 
 	struct Model
 	{
+		const ModelInternals::Component* components;
+		uint32 componentCount;
+
 		const ModelInternals::Archetype* archetypes;
 		uint32 archetypeCount;
 	};
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+
+namespace XEngine::Simulation::ModelInternals
+{
+	constexpr ArchetypePageLayout ComputeArchetypePageLayout(const Component* components,
+		const uint16* componentIndices, const uint16 componentCount)
+	{
+		XAssert(componentCount <= MaxArchetypeComponentCount);
+
+		uint32 entityByteSize = sizeof(uint64);
+		for (uint16 i = 0; i < componentCount; i++)
+		{
+			const Component& component = components[componentIndices[i]];
+			XAssert(component.size > 0 && component.alignment <= PageColumnAlignment);
+			entityByteSize += component.size;
+		}
+
+		// Start from upper estimate and go down until aligned columns fit. Each column loses less
+		// than `PageColumnAlignment` bytes to padding, so this takes just a few iterations.
+		uint32 entitiesPerPage = (PageSize - PageHeaderSize) / entityByteSize;
+		for (;;)
+		{
+			uint32 pageByteSize = PageHeaderSize + alignUp<uint32>(entitiesPerPage * sizeof(uint64), PageColumnAlignment);
+			for (uint16 i = 0; i < componentCount; i++)
+				pageByteSize += alignUp<uint32>(entitiesPerPage * components[componentIndices[i]].size, PageColumnAlignment);
+
+			if (pageByteSize <= PageSize)
+				break;
+			entitiesPerPage--;
+		}
+
+		// Keep page capacity multiple of widest vector, so full pages do not need scalar tail.
+		if (entitiesPerPage >= 16)
+			entitiesPerPage &= ~uint32(15);
+		XAssert(entitiesPerPage > 0);
+
+		ArchetypePageLayout layout = {};
+		layout.entitiesPerPage = uint16(entitiesPerPage);
+
+		uint32 offset = PageHeaderSize;
+		layout.entityIdsColumnOffset = uint16(offset);
+		offset += alignUp<uint32>(entitiesPerPage * sizeof(uint64), PageColumnAlignment);
+
+		for (uint16 i = 0; i < componentCount; i++)
+		{
+			layout.columnOffsets[i] = uint16(offset);
+			offset += alignUp<uint32>(entitiesPerPage * components[componentIndices[i]].size, PageColumnAlignment);
+		}
+
+		return layout;
+	}
+}
@@ -0,0 +1,530 @@
+#include <XLib.CharStream.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.Fmt.h>
+
+#include <XEngine.Simulation.Model.h>
+
+#include "XEngine.Simulation.ModelCompiler.CodeGenerator.h"
+
+using namespace XLib;
+using namespace XEngine::Simulation;
+using namespace XEngine::Simulation::ModelCompiler;
+
+namespace
+{
+	// Archetype as engine sees it: every component field becomes separate column.
+	struct ArchetypeColumns
+	{
+		ArrayList<uint16> fieldIndices;
+		ModelInternals::ArchetypePageLayout pageLayout;
+	};
+
+	inline bool IsIdentifierChar(char c) { return Char::IsLetterOrDigit(c) || c == '_'; }
+
+	sint32 FindArchetypeColumn(const ModelDesc& model, const Archetype& archetype, uint16 componentIndex, uint16 fieldIndexInComponent)
+	{
+		uint16 columnIndex = 0;
+		for (uint16 archetypeComponentIndex : archetype.componentIndices)
+		{
+			if (archetypeComponentIndex == componentIndex)
+				return columnIndex + fieldIndexInComponent;
+			columnIndex += model.components[archetypeComponentIndex].fieldCount;
+		}
+		return -1;
+	}
+
+	class SystemCodeRewriter : public NonCopyable
+	{
+	private:
+		const ModelDesc& model;
+		const System& system;
+		const char* modelPathCStr;
+		VirtualStringWriter& writer;
+
+		const char* codeIt = nullptr;
+		const char* codeEnd = nullptr;
+		char prevSignificantChars[2] = {}; // Last and one before last.
+		bool atLineStart = true;
+
+	private:
+		void reportError(const char* message, StringViewASCII subject)
+		{
+			FmtPrintStdOut(modelPathCStr, ": error: system '", system.name, "': ", message, " '", subject, "'\n");
+		}
+
+		void put(char c)
+		{
+			if (atLineStart && c != '\n')
+				writer.write("\t\t\t");
+			atLineStart = c == '\n';
+			writer.put(c);
+
+			if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+			{
+				prevSignificantChars[1] = prevSignificantChars[0];
+				prevSignificantChars[0] = c;
+			}
+		}
+
+		void putRange(const char* begin, const char* end)
+		{
+			for (const char* i = begin; i < end; i++)
+				put(*i);
+		}
+
+		void skipWhitespaces()
+		{
+			while (codeIt < codeEnd && (*codeIt == ' ' || *codeIt == '\t'))
+				codeIt++;
+		}
+
+		StringViewASCII readIdentifier()
+		{
+			const char* begin = codeIt;
+			while (codeIt < codeEnd && IsIdentifierChar(*codeIt))
+				codeIt++;
+			return StringViewASCII(begin, codeIt);
+		}
+
+		bool isComponentAccessible(uint16 componentIndex) const
+		{
+			for (uint16 i : system.readComponentIndices)
+			{
+				if (i == componentIndex)
+					return true;
+			}
+			for (uint16 i : system.writeComponentIndices)
+			{
+				if (i == componentIndex)
+					return true;
+			}
+			return false;
+		}
+
+		bool rewriteIdentifier()
+		{
+			const char* identifierBegin = codeIt;
+			const StringViewASCII identifier = readIdentifier();
+
+			// Member access or qualified name.
+			const bool isQualified = prevSignificantChars[0] == '.' ||
+				(prevSignificantChars[0] == '>' && prevSignificantChars[1] == '-') ||
+				(prevSignificantChars[0] == ':' && prevSignificantChars[1] == ':');
+
+			sint32 componentIndex = -1;
+			for (uint16 i = 0; i < model.components.getSize(); i++)
+			{
+				if (model.components[i].name == identifier)
+					componentIndex = i;
+			}
+
+			if (isQualified || componentIndex < 0)
+			{
+				putRange(identifierBegin, codeIt);
+				return true;
+			}
+
+			if (!isComponentAccessible(uint16(componentIndex)))
+			{
+				reportError("component is not listed in 'read' or 'write'", identifier);
+				return false;
+			}
+
+			skipWhitespaces();
+			if (codeIt >= codeEnd || *codeIt != '.')
+			{
+				reportError("component field access expected after", identifier);
+				return false;
+			}
+			codeIt++;
+			skipWhitespaces();
+
+			const StringViewASCII fieldName = readIdentifier();
+			const Component& component = model.components[componentIndex];
+
+			bool fieldFound = false;
+			for (uint16 i = 0; i < component.fieldCount; i++)
+				fieldFound |= model.fields[component.fieldsBeginIndex + i].name == fieldName;
+
+			if (!fieldFound)
+			{
+				reportError("undefined field of component", identifier);
+				return false;
+			}
+
+			// Column pointer for every accessed field is declared by kernel prologue.
+			for (char c : identifier)
+				put(c);
+			put('_');
+			for (char c : fieldName)
+				put(c);
+			for (const char* c = "[entityIndex]"; *c; c++)
+				put(*c);
+
+			return true;
+		}
+
+	public:
+		inline SystemCodeRewriter(const ModelDesc& model, const System& system, const char* modelPathCStr, VirtualStringWriter& writer) :
+			model(model), system(system), modelPathCStr(modelPathCStr), writer(writer) {}
+		~SystemCodeRewriter() = default;
+
+		// Replaces `Component.field` with element of corresponding column. Comments, string and
+		// character literals and numbers are copied verbatim.
+		bool rewrite()
+		{
+			codeIt = system.code.getData();
+			codeEnd = codeIt + system.code.getLength();
+
+			while (codeIt < codeEnd)
+			{
+				const char c = *codeIt;
+				const char nextC = codeIt + 1 < codeEnd ? codeIt[1] : 0;
+
+				if (c == '/' && nextC == '/')
+				{
+					const char* begin = codeIt;
+					while (codeIt < codeEnd && *codeIt != '\n')
+						codeIt++;
+					putRange(begin, codeIt);
+				}
+				else if (c == '/' && nextC == '*')
+				{
+					const char* begin = codeIt;
+					codeIt += 2;
+					while (codeIt < codeEnd && !(codeIt[0] == '*' && codeIt + 1 < codeEnd && codeIt[1] == '/'))
+						codeIt++;
+					if (codeIt >= codeEnd)
+					{
+						reportError("unterminated comment", StringViewASCII(begin, min<uintptr>(codeEnd - begin, 16)));
+						return false;
+					}
+					codeIt += 2;
+					putRange(begin, codeIt);
+				}
+				else if (c == '"' || c == '\'')
+				{
+					const char* begin = codeIt;
+					codeIt++;
+					while (codeIt < codeEnd && *codeIt != c && *codeIt != '\n')
+					{
+						if (*codeIt == '\\' && codeIt + 1 < codeEnd)
+							codeIt++;
+						codeIt++;
+					}
+					if (codeIt >= codeEnd || *codeIt != c)
+					{
+						reportError("unterminated literal", StringViewASCII(begin, codeIt));
+						return false;
+					}
+					codeIt++;
+					putRange(begin, codeIt);
+				}
+				else if (Char::IsDigit(c))
+				{
+					// Number suffixes and exponents should not be taken for identifiers.
+					const char* begin = codeIt;
+					while (codeIt < codeEnd && (IsIdentifierChar(*codeIt) || *codeIt == '.' || *codeIt == '\''))
+						codeIt++;
+					putRange(begin, codeIt);
+				}
+				else if (Char::IsLetter(c) || c == '_')
+				{
+					if (!rewriteIdentifier())
+						return false;
+				}
+				else
+				{
+					put(c);
+					codeIt++;
+				}
+			}
+
+			if (!atLineStart)
+				put('\n');
+
+			return true;
+		}
+	};
+
+	void GenerateHeader(const ModelDesc& model, const ArrayList<ArchetypeColumns>& archetypesColumns, VirtualStringWriter& writer)
+	{
+		FmtPrint(writer,
+			"// Generated by XEngine.Simulation.ModelCompiler. Do not edit.\n"
+			"\n"
+			"#pragma once\n"
+			"\n"
+			"#include <XEngine.Simulation.Model.h>\n"
+			"\n"
+			"namespace XEngine::Simulation::Generated::", model.name, "\n"
+			"{\n"
+			"\textern const Model Definition;\n");
+
+		for (uint16 archetypeIndex = 0; archetypeIndex < model.archetypes.getSize(); archetypeIndex++)
+		{
+			const Archetype& archetype = model.archetypes[archetypeIndex];
+			const ArchetypeColumns& columns = archetypesColumns[archetypeIndex];
+
+			FmtPrint(writer,
+				"\n"
+				"\tnamespace ", archetype.name, "\n"
+				"\t{\n"
+				"\t\tstatic constexpr uint16 ArchetypeIndex = ", archetypeIndex, ";\n"
+				"\t\tstatic constexpr uint16 EntitiesPerPage = ", columns.pageLayout.entitiesPerPage, ";\n"
+				"\n"
+				"\t\t// Archetype component slots.\n");
+
+			uint16 columnIndex = 0;
+			for (uint16 componentIndex : archetype.componentIndices)
+			{
+				const Component& component = model.components[componentIndex];
+				for (uint16 i = 0; i < component.fieldCount; i++)
+				{
+					FmtPrint(writer, "\t\tstatic constexpr uint16 ", component.name, '_',
+						model.fields[component.fieldsBeginIndex + i].name, " = ", columnIndex, ";\n");
+					columnIndex++;
+				}
+			}
+
+			writer.write("\t}\n");
+		}
+
+		writer.write("}\n");
+	}
+
+	bool GenerateSource(const ModelDesc& model, const char* modelPathCStr,
+		const ArrayList<ArchetypeColumns>& archetypesColumns, VirtualStringWriter& writer)
+	{
+		FmtPrint(writer,
+			"// Generated by XEngine.Simulation.ModelCompiler. Do not edit.\n"
+			"\n"
+			"#include <XEngine.Simulation.FixedPoint.h>\n"
+			"#include <XEngine.Simulation.Model.h>\n"
+			"\n"
+			"#include \"", model.name, ".Model.h\"\n"
+			"\n"
+			"using namespace XEngine::Simulation;\n"
+			"using namespace XEngine::Simulation::ModelInternals;\n"
+			"\n"
+			"namespace\n"
+			"{\n"
+			"\tconstexpr Component Components[] =\n"
+			"\t{\n");
+
+		for (const Component& component : model.components)
+		{
+			for (uint16 i = 0; i < component.fieldCount; i++)
+			{
+				const ComponentField& field = model.fields[component.fieldsBeginIndex + i];
+				const uint16 fieldSize = GetFieldTypeSize(field.type);
+				FmtPrint(writer, "\t\t{ ", fieldSize, ", ", fieldSize, " }, // ", component.name, '.', field.name, "\n");
+			}
+		}
+
+		writer.write(
+			"\t};\n"
+			"\n"
+			"\tconstexpr bool IsSamePageLayout(const ArchetypePageLayout& a, const ArchetypePageLayout& b, uint16 componentCount)\n"
+			"\t{\n"
+			"\t\tbool result = a.entityIdsColumnOffset == b.entityIdsColumnOffset && a.entitiesPerPage == b.entitiesPerPage;\n"
+			"\t\tfor (uint16 i = 0; i < componentCount; i++)\n"
+			"\t\t\tresult &= a.columnOffsets[i] == b.columnOffsets[i];\n"
+			"\t\treturn result;\n"
+			"\t}\n");
+
+		for (uint16 archetypeIndex = 0; archetypeIndex < model.archetypes.getSize(); archetypeIndex++)
+		{
+			const Archetype& archetype = model.archetypes[archetypeIndex];
+			const ArchetypeColumns& columns = archetypesColumns[archetypeIndex];
+			const ModelInternals::ArchetypePageLayout& pageLayout = columns.pageLayout;
+
+			FmtPrint(writer,
+				"\n"
+				"\n"
+				"\t// Archetype '", archetype.name, "'\n"
+				"\n"
+				"\tconstexpr uint16 ", archetype.name, "_ComponentIndices[] = {");
+
+			for (uint16 i = 0; i < columns.fieldIndices.getSize(); i++)
+				FmtPrint(writer, i ? ", " : " ", columns.fieldIndices[i]);
+
+			FmtPrint(writer,
+				" };\n"
+				"\n"
+				"\tconstexpr ArchetypePageLayout ", archetype.name, "_PageLayout =\n"
+				"\t{\n"
+				"\t\t{");
+
+			for (uint16 i = 0; i < columns.fieldIndices.getSize(); i++)
+				FmtPrint(writer, i ? ", " : " ", pageLayout.columnOffsets[i]);
+
+			FmtPrint(writer,
+				" },\n"
+				"\t\t", pageLayout.entityIdsColumnOffset, ",\n"
+				"\t\t", pageLayout.entitiesPerPage, ",\n"
+				"\t};\n"
+				"\n"
+				"\tstatic_assert(IsSamePageLayout(", archetype.name, "_PageLayout,\n"
+				"\t\tComputeArchetypePageLayout(Components, ", archetype.name, "_ComponentIndices, ", archetype.columnCount, "), ", archetype.columnCount, "),\n"
+				"\t\t\"Page layout does not match engine one. Model should be recompiled\");\n");
+
+			for (uint16 systemIndex : archetype.systemIndices)
+			{
+				const System& system = model.systems[systemIndex];
+
+				FmtPrint(writer,
+					"\n"
+					"\tvoid ", archetype.name, "_", system.name, "(const JobExecutorContext& context)\n"
+					"\t{\n"
+					"\t\tbyte* const page = (byte*)context.page;\n");
+
+				// Columns are declared for all fields of accessed components. Unused ones are
+				// dropped by compiler.
+				for (uint16 accessIndex = 0; accessIndex < 2; accessIndex++)
+				{
+					const bool isWrite = accessIndex == 1;
+					const ArrayList<uint16>& componentIndices = isWrite ? system.writeComponentIndices : system.readComponentIndices;
+
+					for (uint16 componentIndex : componentIndices)
+					{
+						const Component& component = model.components[componentIndex];
+						for (uint16 i = 0; i < component.fieldCount; i++)
+						{
+							const ComponentField& field = model.fields[component.fieldsBeginIndex + i];
+							const sint32 columnIndex = FindArchetypeColumn(model, archetype, componentIndex, i);
+							XAssert(columnIndex >= 0);
+
+							const char* constQualifier = isWrite ? "" : "const ";
+							const char* cppTypeName = GetFieldTypeCppName(field.type);
+							FmtPrint(writer,
+								"\t\t", constQualifier, cppTypeName, "* __restrict const ", component.name, '_', field.name,
+								" = (", constQualifier, cppTypeName, "*)(page + ", pageLayout.columnOffsets[columnIndex], ");\n");
+						}
+					}
+				}
+
+				writer.write(
+					"\n"
+					"\t\tfor (uint32 entityIndex = context.entityBeginIndex; entityIndex < context.entityEndIndex; entityIndex++)\n"
+					"\t\t{\n");
+
+				SystemCodeRewriter rewriter(model, system, modelPathCStr, writer);
+				if (!rewriter.rewrite())
+					return false;
+
+				writer.write(
+					"\t\t}\n"
+					"\t}\n");
+			}
+
+			if (archetype.systemIndices.getSize() > 0)
+			{
+				FmtPrint(writer,
+					"\n"
+					"\tconstexpr Job ", archetype.name, "_Jobs[] =\n"
+					"\t{\n");
+
+				for (uint16 systemIndex : archetype.systemIndices)
+				{
+					const System& system = model.systems[systemIndex];
+
+					uint32 accessMasks[2] = {};
+					for (uint16 accessIndex = 0; accessIndex < 2; accessIndex++)
+					{
+						const ArrayList<uint16>& componentIndices = accessIndex ? system.writeComponentIndices : system.readComponentIndices;
+						for (uint16 componentIndex : componentIndices)
+						{
+							for (uint16 i = 0; i < model.components[componentIndex].fieldCount; i++)
+								accessMasks[accessIndex] |= uint32(1) << FindArchetypeColumn(model, archetype, componentIndex, i);
+						}
+					}
+
+					FmtPrint(writer, "\t\t{ ", archetype.name, "_", system.name,
+						", 0x", FmtArgHex32(accessMasks[0]), ", 0x", FmtArgHex32(accessMasks[1]), " },\n");
+				}
+
+				writer.write("\t};\n");
+			}
+		}
+
+		writer.write(
+			"\n"
+			"\n"
+			"\t////////////////////////////////////////////////////////////////////////////////////////////////\n"
+			"\n"
+			"\tconstexpr Archetype Archetypes[] =\n"
+			"\t{\n");
+
+		for (uint16 archetypeIndex = 0; archetypeIndex < model.archetypes.getSize(); archetypeIndex++)
+		{
+			const Archetype& archetype = model.archetypes[archetypeIndex];
+
+			FmtPrint(writer, "\t\t{ ", archetypeIndex, ", ",
+				archetype.name, "_ComponentIndices, ", archetype.columnCount, ", ");
+
+			if (archetype.systemIndices.getSize() > 0)
+				FmtPrint(writer, archetype.name, "_Jobs, ", uint16(archetype.systemIndices.getSize()), ", ");
+			else
+				writer.write("nullptr, 0, ");
+
+			FmtPrint(writer, '&', archetype.name, "_PageLayout },\n");
+		}
+
+		FmtPrint(writer,
+			"\t};\n"
+			"}\n"
+			"\n"
+			"const Model XEngine::Simulation::Generated::", model.name, "::Definition =\n"
+			"{\n"
+			"\tComponents, countOf(Components),\n"
+			"\tArchetypes, countOf(Archetypes),\n"
+			"};\n");
+
+		return true;
+	}
+}
+
+bool CodeGenerator::Generate(const ModelDesc& model, const char* modelPathCStr,
+	DynamicStringASCII& resultHeader, DynamicStringASCII& resultSource)
+{
+	// Compute page layouts same way engine does.
+	ArrayList<ModelInternals::Component> runtimeComponents;
+	for (const ComponentField& field : model.fields)
+	{
+		const uint16 fieldSize = GetFieldTypeSize(field.type);
+		runtimeComponents.pushBack(ModelInternals::Component { fieldSize, fieldSize });
+	}
+
+	ArrayList<ArchetypeColumns> archetypesColumns;
+	for (const Archetype& archetype : model.archetypes)
+	{
+		ArchetypeColumns& columns = archetypesColumns.emplaceBack();
+		for (uint16 componentIndex : archetype.componentIndices)
+		{
+			const Component& component = model.components[componentIndex];
+			for (uint16 i = 0; i < component.fieldCount; i++)
+				columns.fieldIndices.pushBack(component.fieldsBeginIndex + i);
+		}
+
+		XAssert(columns.fieldIndices.getSize() == archetype.columnCount);
+		columns.pageLayout = ModelInternals::ComputeArchetypePageLayout(runtimeComponents.getData(),
+			columns.fieldIndices.getData(), archetype.columnCount);
+	}
+
+	resultHeader.clear();
+	resultSource.clear();
+	resultHeader.growBufferToFitLength(4 * 1024);
+	resultSource.growBufferToFitLength(64 * 1024);
+
+	{
+		VirtualStringWriter headerWriter(resultHeader);
+		GenerateHeader(model, archetypesColumns, headerWriter);
+	}
+	{
+		VirtualStringWriter sourceWriter(resultSource);
+		if (!GenerateSource(model, modelPathCStr, archetypesColumns, sourceWriter))
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <XLib.h>
+#include <XLib.String.h>
+
+#include "XEngine.Simulation.ModelCompiler.h"
+
+// Generates C++ header and source that define `XEngine::Simulation::Model` for model description.
+// Each system is specialized for each archetype that uses it into separate job kernel. Kernel
+// addresses page columns by offsets baked into code, so field accesses compile to plain loads and
+// stores over non-aliasing aligned arrays, which compiler is free to vectorize.
+
+namespace XEngine::Simulation::ModelCompiler
+{
+	class CodeGenerator abstract final
+	{
+	public:
+		// Header should be saved as `<model name>.Model.h` next to source, as source includes it.
+		static bool Generate(const ModelDesc& model, const char* modelPathCStr,
+			XLib::DynamicStringASCII& resultHeader, XLib::DynamicStringASCII& resultSource);
+	};
+}
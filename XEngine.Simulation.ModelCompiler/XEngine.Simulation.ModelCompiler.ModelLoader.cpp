@@ -0,0 +1,616 @@
+#include <XLib.Fmt.h>
+
+#include <XEngine.Simulation.Model.h>
+
+#include "XEngine.Simulation.ModelCompiler.ModelLoader.h"
+
+#define IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader) \
+	do { if ((jsonReader).getErrorCode() != JSONErrorCode::Success) { this->reportJSONError(); return false; } } while (false)
+#define IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(condition, message, jsonCursor) \
+	do { if (!(condition)) { this->reportError(message, jsonCursor); return false; } } while (false)
+#define IF_FALSE_RETURN_FALSE(condition) \
+	do { if (!(condition)) return false; } while (false)
+
+using namespace XLib;
+using namespace XEngine::Simulation::ModelCompiler;
+
+
+// Value parsers ///////////////////////////////////////////////////////////////////////////////////
+
+static FieldType ParseFieldTypeString(StringViewASCII string)
+{
+	if (string == "uint8")		return FieldType::UInt8;
+	if (string == "uint16")		return FieldType::UInt16;
+	if (string == "uint32")		return FieldType::UInt32;
+	if (string == "uint64")		return FieldType::UInt64;
+	if (string == "sint8")		return FieldType::SInt8;
+	if (string == "sint16")		return FieldType::SInt16;
+	if (string == "sint32")		return FieldType::SInt32;
+	if (string == "sint64")		return FieldType::SInt64;
+	if (string == "float32")	return FieldType::Float32;
+	if (string == "float64")	return FieldType::Float64;
+	if (string == "fixed32")	return FieldType::Fixed32;
+	return FieldType::Undefined;
+}
+
+
+// JSON string validators //////////////////////////////////////////////////////////////////////////
+
+// C++ keywords, and names generated code relies on being unshadowed in model namespace.
+static const char* const ReservedNames[] =
+{
+	"alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+	"case", "catch", "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept", "const",
+	"consteval", "constexpr", "constinit", "const_cast", "continue", "co_await", "co_return", "co_yield",
+	"decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export",
+	"extern", "false", "float", "for", "friend", "goto", "if", "import", "inline", "int", "long", "module",
+	"mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq",
+	"private", "protected", "public", "register", "reinterpret_cast", "requires", "return", "short",
+	"signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch", "template", "this",
+	"thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using",
+	"virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq", "abstract", "final", "override",
+
+	"uint8", "uint16", "uint32", "uint64", "sint8", "sint16", "sint32", "sint64", "float32", "float64",
+	"byte", "uintptr", "sintptr", "countOf", "Model", "Components", "Archetypes", "Definition",
+};
+
+// Names end up in generated code as parts of C++ identifiers. Double underscore is reserved in C++,
+// and names are joined with underscore, so neither trailing nor double underscores are allowed.
+static bool ValidateName(StringViewASCII name)
+{
+	if (name.isEmpty() || name.getLength() > 64)
+		return false;
+	if (!Char::IsLetter(name[0]) || name[name.getLength() - 1] == '_')
+		return false;
+
+	for (uintptr i = 1; i < name.getLength(); i++)
+	{
+		const char c = name[i];
+		if (!Char::IsLetterOrDigit(c) && c != '_')
+			return false;
+		if (c == '_' && name[i - 1] == '_')
+			return false;
+	}
+
+	for (const char* reservedName : ReservedNames)
+	{
+		if (name == reservedName)
+			return false;
+	}
+	return true;
+}
+
+// Generated identifiers like `Component_field` are joined with underscore, so different pairs can
+// end up as same identifier (`A_b` + `c` and `A` + `b_c`). Compared without building strings.
+static bool IsSameJoinedName(StringViewASCII aPrefix, StringViewASCII aSuffix, StringViewASCII bPrefix, StringViewASCII bSuffix)
+{
+	const uintptr length = aPrefix.getLength() + 1 + aSuffix.getLength();
+	if (length != bPrefix.getLength() + 1 + bSuffix.getLength())
+		return false;
+
+	const auto getJoinedChar = [](StringViewASCII prefix, StringViewASCII suffix, uintptr i) -> char
+	{
+		if (i < prefix.getLength())
+			return prefix[i];
+		if (i == prefix.getLength())
+			return '_';
+		return suffix[i - prefix.getLength() - 1];
+	};
+
+	for (uintptr i = 0; i < length; i++)
+	{
+		if (getJoinedChar(aPrefix, aSuffix, i) != getJoinedChar(bPrefix, bSuffix, i))
+			return false;
+	}
+	return true;
+}
+
+
+// ModelLoader /////////////////////////////////////////////////////////////////////////////////////
+
+void ModelLoader::reportError(const char* message, Cursor jsonCursor)
+{
+	uint32 lineNumber = 0;
+	uint32 columnNumber = 0;
+	jsonReader.getLineColumnNumbers(jsonCursor.offset, lineNumber, columnNumber);
+
+	FmtPrintStdOut(jsonPathCStr, ':', lineNumber, ':', columnNumber,
+		": error: ", message, '\n');
+}
+
+void ModelLoader::reportJSONError()
+{
+	const JSONErrorCode jsonError = jsonReader.getErrorCode();
+	XAssert(jsonError != JSONErrorCode::Success);
+
+	FmtPrintStdOut(jsonPathCStr, ':', jsonReader.getLineNumer(), ':', jsonReader.getColumnNumer(),
+		": error: JSON: ", JSONErrorCodeToString(jsonError), '\n');
+}
+
+bool ModelLoader::consumeKeyWithObjectValue(StringViewASCII& resultKey)
+{
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(!jsonReader.isEndOfObject(), "property expected", getJSONCursor());
+
+	JSONString jsonKey = {};
+	jsonReader.readKey(jsonKey);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	JSONValue jsonValue = {};
+	const Cursor jsonValueCursor = getJSONCursor();
+	jsonReader.readValue(jsonValue);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonValue.type == JSONValueType::Object, "object expected", jsonValueCursor);
+
+	resultKey = jsonKey.string;
+	return true;
+}
+
+bool ModelLoader::consumeSpecificKeyWithStringValue(const char* expectedKey, StringViewASCII& resultStringValue)
+{
+	InplaceStringASCIIx128 propertyExpectedErrorMessage;
+	FmtPrintStr(propertyExpectedErrorMessage, '\'', expectedKey, "' property expected");
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(!jsonReader.isEndOfObject(), propertyExpectedErrorMessage.getCStr(), getJSONCursor());
+
+	JSONString jsonKey = {};
+	const Cursor jsonKeyCursor = getJSONCursor();
+	jsonReader.readKey(jsonKey);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	JSONValue jsonValue = {};
+	const Cursor jsonValueCursor = getJSONCursor();
+	jsonReader.readValue(jsonValue);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonKey.string == expectedKey, propertyExpectedErrorMessage.getCStr(), jsonKeyCursor);
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonValue.type == JSONValueType::String, "string expected", jsonValueCursor);
+
+	resultStringValue = jsonValue.string.string;
+	return true;
+}
+
+bool ModelLoader::consumeSpecificKeyWithObjectValue(const char* expectedKey)
+{
+	InplaceStringASCIIx128 propertyExpectedErrorMessage;
+	FmtPrintStr(propertyExpectedErrorMessage, '\'', expectedKey, "' property expected");
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(!jsonReader.isEndOfObject(), propertyExpectedErrorMessage.getCStr(), getJSONCursor());
+
+	JSONString jsonKey = {};
+	const Cursor jsonKeyCursor = getJSONCursor();
+	jsonReader.readKey(jsonKey);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	JSONValue jsonValue = {};
+	const Cursor jsonValueCursor = getJSONCursor();
+	jsonReader.readValue(jsonValue);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonKey.string == expectedKey, propertyExpectedErrorMessage.getCStr(), jsonKeyCursor);
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonValue.type == JSONValueType::Object, "object expected", jsonValueCursor);
+
+	return true;
+}
+
+bool ModelLoader::consumeSpecificKeyWithArrayValue(const char* expectedKey)
+{
+	InplaceStringASCIIx128 propertyExpectedErrorMessage;
+	FmtPrintStr(propertyExpectedErrorMessage, '\'', expectedKey, "' property expected");
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(!jsonReader.isEndOfObject(), propertyExpectedErrorMessage.getCStr(), getJSONCursor());
+
+	JSONString jsonKey = {};
+	const Cursor jsonKeyCursor = getJSONCursor();
+	jsonReader.readKey(jsonKey);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	JSONValue jsonValue = {};
+	const Cursor jsonValueCursor = getJSONCursor();
+	jsonReader.readValue(jsonValue);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonKey.string == expectedKey, propertyExpectedErrorMessage.getCStr(), jsonKeyCursor);
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonValue.type == JSONValueType::Array, "array expected", jsonValueCursor);
+
+	return true;
+}
+
+bool ModelLoader::readComponentNamesArray(ArrayList<uint16>& resultComponentIndices)
+{
+	jsonReader.openArray();
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	while (!jsonReader.isEndOfArray())
+	{
+		JSONValue jsonValue = {};
+		const Cursor jsonValueCursor = getJSONCursor();
+		jsonReader.readValue(jsonValue);
+		IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+		IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonValue.type == JSONValueType::String, "component name expected", jsonValueCursor);
+
+		const sint32 componentIndex = findComponent(jsonValue.string.string);
+		IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(componentIndex >= 0, "undefined component", jsonValueCursor);
+
+		for (uint16 i : resultComponentIndices)
+			IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(i != uint16(componentIndex), "component is already listed", jsonValueCursor);
+
+		resultComponentIndices.pushBack(uint16(componentIndex));
+	}
+
+	jsonReader.closeArray();
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	return true;
+}
+
+bool ModelLoader::readSystemNamesArray(ArrayList<uint16>& resultSystemIndices)
+{
+	jsonReader.openArray();
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	while (!jsonReader.isEndOfArray())
+	{
+		JSONValue jsonValue = {};
+		const Cursor jsonValueCursor = getJSONCursor();
+		jsonReader.readValue(jsonValue);
+		IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+		IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonValue.type == JSONValueType::String, "system name expected", jsonValueCursor);
+
+		const sint32 systemIndex = findSystem(jsonValue.string.string);
+		IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(systemIndex >= 0, "undefined system", jsonValueCursor);
+
+		for (uint16 i : resultSystemIndices)
+			IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(i != uint16(systemIndex), "system is already listed", jsonValueCursor);
+
+		resultSystemIndices.pushBack(uint16(systemIndex));
+	}
+
+	jsonReader.closeArray();
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	return true;
+}
+
+bool ModelLoader::readComponent(StringViewASCII componentName, Cursor jsonComponentNameCursor)
+{
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(ValidateName(componentName), "invalid component name", jsonComponentNameCursor);
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(findComponent(componentName) < 0, "component redefinition", jsonComponentNameCursor);
+
+	Component component = {};
+	component.name = componentName;
+	component.fieldsBeginIndex = XCheckedCastU16(model.fields.getSize());
+
+	while (!jsonReader.isEndOfObject())
+	{
+		JSONString jsonKey = {};
+		const Cursor jsonKeyCursor = getJSONCursor();
+		jsonReader.readKey(jsonKey);
+		IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+		JSONValue jsonValue = {};
+		const Cursor jsonValueCursor = getJSONCursor();
+		jsonReader.readValue(jsonValue);
+		IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+		IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(ValidateName(jsonKey.string), "invalid field name", jsonKeyCursor);
+		for (uint16 i = 0; i < component.fieldCount; i++)
+		{
+			IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(!(model.fields[component.fieldsBeginIndex + i].name == jsonKey.string),
+				"field redefinition", jsonKeyCursor);
+		}
+
+		// Field of component that is not defined yet can only clash with previous components.
+		for (const Component& otherComponent : model.components)
+		{
+			for (uint16 i = 0; i < otherComponent.fieldCount; i++)
+			{
+				const ComponentField& otherField = model.fields[otherComponent.fieldsBeginIndex + i];
+				if (IsSameJoinedName(componentName, jsonKey.string, otherComponent.name, otherField.name))
+				{
+					InplaceStringASCIIx256 message;
+					FmtPrintStr(message, "generated identifier '", componentName, '_', jsonKey.string,
+						"' clashes with identifier of component '", otherComponent.name, "' field '", otherField.name, "'");
+					reportError(message.getCStr(), jsonKeyCursor);
+					return false;
+				}
+			}
+		}
+
+		IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonValue.type == JSONValueType::String, "string expected", jsonValueCursor);
+
+		ComponentField field = {};
+		field.name = jsonKey.string;
+		field.type = ParseFieldTypeString(jsonValue.string.string);
+		IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(field.type != FieldType::Undefined, "invalid field type", jsonValueCursor);
+
+		model.fields.pushBack(field);
+		component.fieldCount++;
+	}
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(component.fieldCount > 0, "component has no fields", jsonComponentNameCursor);
+
+	model.components.pushBack(component);
+	return true;
+}
+
+bool ModelLoader::readSystem(StringViewASCII systemName, Cursor jsonSystemNameCursor)
+{
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(ValidateName(systemName), "invalid system name", jsonSystemNameCursor);
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(findSystem(systemName) < 0, "system redefinition", jsonSystemNameCursor);
+
+	System& system = model.systems.emplaceBack();
+	system.name = systemName;
+
+	IF_FALSE_RETURN_FALSE(consumeSpecificKeyWithArrayValue("read"));
+	IF_FALSE_RETURN_FALSE(readComponentNamesArray(system.readComponentIndices));
+
+	const Cursor jsonWriteComponentsCursor = getJSONCursor();
+	IF_FALSE_RETURN_FALSE(consumeSpecificKeyWithArrayValue("write"));
+	IF_FALSE_RETURN_FALSE(readComponentNamesArray(system.writeComponentIndices));
+
+	for (uint16 writeComponentIndex : system.writeComponentIndices)
+	{
+		for (uint16 readComponentIndex : system.readComponentIndices)
+		{
+			IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(readComponentIndex != writeComponentIndex,
+				"component is listed both in 'read' and 'write'", jsonWriteComponentsCursor);
+		}
+	}
+
+	// Code is either single string or array of lines.
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(!jsonReader.isEndOfObject(), "'code' property expected", getJSONCursor());
+
+	JSONString jsonKey = {};
+	const Cursor jsonKeyCursor = getJSONCursor();
+	jsonReader.readKey(jsonKey);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonKey.string == "code", "'code' property expected", jsonKeyCursor);
+
+	JSONValue jsonValue = {};
+	const Cursor jsonValueCursor = getJSONCursor();
+	jsonReader.readValue(jsonValue);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	const bool codeIsArray = jsonValue.type == JSONValueType::Array;
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(codeIsArray || jsonValue.type == JSONValueType::String,
+		"string or array of strings expected", jsonValueCursor);
+
+	if (codeIsArray)
+	{
+		jsonReader.openArray();
+		IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+	}
+
+	for (;;)
+	{
+		if (codeIsArray)
+		{
+			if (jsonReader.isEndOfArray())
+				break;
+
+			const Cursor jsonLineCursor = getJSONCursor();
+			jsonReader.readValue(jsonValue);
+			IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+			IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonValue.type == JSONValueType::String, "string expected", jsonLineCursor);
+		}
+
+		const JSONString& codeLine = jsonValue.string;
+		if (codeLine.isEscaped)
+		{
+			const uint32 codeLength = system.code.getLength();
+			system.code.growBufferToFitLength(codeLength + uint32(codeLine.unescapedLength));
+			system.code.setLength(codeLength + uint32(codeLine.unescapedLength));
+			codeLine.unescape(system.code.getData() + codeLength);
+		}
+		else
+			system.code.append(codeLine.string);
+		system.code.append('\n');
+
+		if (!codeIsArray)
+			break;
+	}
+
+	if (codeIsArray)
+	{
+		jsonReader.closeArray();
+		IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+	}
+
+	return true;
+}
+
+bool ModelLoader::readArchetype(StringViewASCII archetypeName, Cursor jsonArchetypeNameCursor)
+{
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(ValidateName(archetypeName), "invalid archetype name", jsonArchetypeNameCursor);
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(findArchetype(archetypeName) < 0, "archetype redefinition", jsonArchetypeNameCursor);
+
+	Archetype& archetype = model.archetypes.emplaceBack();
+	archetype.name = archetypeName;
+
+	const Cursor jsonComponentsCursor = getJSONCursor();
+	IF_FALSE_RETURN_FALSE(consumeSpecificKeyWithArrayValue("components"));
+	IF_FALSE_RETURN_FALSE(readComponentNamesArray(archetype.componentIndices));
+
+	archetype.columnCount = 0;
+	for (uint16 componentIndex : archetype.componentIndices)
+		archetype.columnCount += model.components[componentIndex].fieldCount;
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(archetype.columnCount <= ModelInternals::MaxArchetypeComponentCount,
+		"archetype has too many component fields", jsonComponentsCursor);
+
+	const Cursor jsonSystemsCursor = getJSONCursor();
+	IF_FALSE_RETURN_FALSE(consumeSpecificKeyWithArrayValue("systems"));
+	IF_FALSE_RETURN_FALSE(readSystemNamesArray(archetype.systemIndices));
+
+	// Archetype scope identifiers in generated source are `Archetype_<suffix>`, where suffix is one
+	// of fixed ones or system name. They should be unique across all archetypes.
+	{
+		static const char* const fixedSuffixes[] = { "ComponentIndices", "PageLayout", "Jobs" };
+		static constexpr uint16 fixedSuffixCount = countOf(fixedSuffixes);
+
+		const auto getSuffix = [this](const Archetype& archetype, uint16 suffixIndex) -> StringViewASCII
+		{
+			if (suffixIndex < fixedSuffixCount)
+				return StringViewASCII::FromCStr(fixedSuffixes[suffixIndex]);
+			return model.systems[archetype.systemIndices[suffixIndex - fixedSuffixCount]].name;
+		};
+
+		const uint16 suffixCount = fixedSuffixCount + uint16(archetype.systemIndices.getSize());
+		for (uint16 suffixIndex = 0; suffixIndex < suffixCount; suffixIndex++)
+		{
+			const StringViewASCII suffix = getSuffix(archetype, suffixIndex);
+
+			for (const Archetype& otherArchetype : model.archetypes)
+			{
+				const uint16 otherSuffixCount = fixedSuffixCount + uint16(otherArchetype.systemIndices.getSize());
+				for (uint16 otherSuffixIndex = 0; otherSuffixIndex < otherSuffixCount; otherSuffixIndex++)
+				{
+					if (&otherArchetype == &archetype && otherSuffixIndex == suffixIndex)
+						continue;
+
+					const StringViewASCII otherSuffix = getSuffix(otherArchetype, otherSuffixIndex);
+					if (IsSameJoinedName(archetype.name, suffix, otherArchetype.name, otherSuffix))
+					{
+						InplaceStringASCIIx256 message;
+						FmtPrintStr(message, "generated identifier '", archetype.name, '_', suffix, "' is not unique");
+						reportError(message.getCStr(), jsonArchetypeNameCursor);
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	// Every component accessed by system should be present in archetype.
+	for (uint16 systemIndex : archetype.systemIndices)
+	{
+		const System& system = model.systems[systemIndex];
+		for (uint16 accessIndex = 0; accessIndex < 2; accessIndex++)
+		{
+			const ArrayList<uint16>& accessedComponentIndices = accessIndex ? system.writeComponentIndices : system.readComponentIndices;
+			for (uint16 accessedComponentIndex : accessedComponentIndices)
+			{
+				bool found = false;
+				for (uint16 componentIndex : archetype.componentIndices)
+					found |= componentIndex == accessedComponentIndex;
+
+				if (!found)
+				{
+					InplaceStringASCIIx256 message;
+					FmtPrintStr(message, "system '", system.name, "' accesses component '",
+						model.components[accessedComponentIndex].name, "' that archetype does not have");
+					reportError(message.getCStr(), jsonSystemsCursor);
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+sint32 ModelLoader::findComponent(StringViewASCII name) const
+{
+	for (uint16 i = 0; i < model.components.getSize(); i++)
+	{
+		if (model.components[i].name == name)
+			return i;
+	}
+	return -1;
+}
+
+sint32 ModelLoader::findSystem(StringViewASCII name) const
+{
+	for (uint16 i = 0; i < model.systems.getSize(); i++)
+	{
+		if (model.systems[i].name == name)
+			return i;
+	}
+	return -1;
+}
+
+sint32 ModelLoader::findArchetype(StringViewASCII name) const
+{
+	for (uint16 i = 0; i < model.archetypes.getSize(); i++)
+	{
+		if (model.archetypes[i].name == name)
+			return i;
+	}
+	return -1;
+}
+
+bool ModelLoader::load(const char* jsonPathCStr, const char* jsonText, uintptr jsonTextLength)
+{
+	this->jsonPathCStr = jsonPathCStr;
+
+	jsonReader.openDocument(jsonText, jsonTextLength);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	JSONValue jsonDocumentRootValue = {};
+	jsonReader.readValue(jsonDocumentRootValue);
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonDocumentRootValue.type == JSONValueType::Object, "object expected", getJSONCursor());
+
+	jsonReader.openObject();
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	const Cursor jsonModelNameCursor = getJSONCursor();
+	IF_FALSE_RETURN_FALSE(consumeSpecificKeyWithStringValue("name", model.name));
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(ValidateName(model.name), "invalid model name", jsonModelNameCursor);
+
+	// Sections go in fixed order, so everything is declared before it is referenced.
+	const char* sectionKeys[] = { "components", "systems", "archetypes" };
+	for (const char* sectionKey : sectionKeys)
+	{
+		IF_FALSE_RETURN_FALSE(consumeSpecificKeyWithObjectValue(sectionKey));
+
+		jsonReader.openObject();
+		IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+		while (!jsonReader.isEndOfObject())
+		{
+			StringViewASCII entryName = {};
+			const Cursor jsonEntryNameCursor = getJSONCursor();
+			IF_FALSE_RETURN_FALSE(consumeKeyWithObjectValue(entryName));
+
+			jsonReader.openObject();
+			IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+			bool readEntryStatus = false;
+			if (sectionKey == sectionKeys[0])
+				readEntryStatus = readComponent(entryName, jsonEntryNameCursor);
+			else if (sectionKey == sectionKeys[1])
+				readEntryStatus = readSystem(entryName, jsonEntryNameCursor);
+			else
+				readEntryStatus = readArchetype(entryName, jsonEntryNameCursor);
+
+			if (!readEntryStatus)
+				return false;
+
+			IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonReader.isEndOfObject(), "unexpected property", getJSONCursor());
+
+			jsonReader.closeObject();
+			IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+		}
+
+		jsonReader.closeObject();
+		IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+	}
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(jsonReader.isEndOfObject(), "unexpected property", getJSONCursor());
+
+	jsonReader.closeObject();
+	IF_JSON_ERROR_REPORT_AND_RETURN_FALSE(jsonReader);
+
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(model.archetypes.getSize() > 0, "model has no archetypes", jsonModelNameCursor);
+	IF_FALSE_REPORT_MESSAGE_AND_RETURN_FALSE(model.archetypes.getSize() < uint16(-1), "model has too many archetypes", jsonModelNameCursor);
+
+	return true;
+}
+
+bool ModelLoader::Load(ModelDesc& model, const char* jsonPathCStr, const char* jsonText, uintptr jsonTextLength)
+{
+	ModelLoader loader(model);
+	return loader.load(jsonPathCStr, jsonText, jsonTextLength);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <XLib.h>
+#include <XLib.JSON.h>
+#include <XLib.NonCopyable.h>
+#include <XLib.String.h>
+
+#include "XEngine.Simulation.ModelCompiler.h"
+
+// Model JSON file format:
+//
+//	{
+//		"name": "Particles",
+//		"components": {
+//			"Position": { "x": "float32", "y": "float32" },
+//			"Velocity": { "x": "float32", "y": "float32" }
+//		},
+//		"systems": {
+//			"Integrate": {
+//				"read": [ "Velocity" ],
+//				"write": [ "Position" ],
+//				"code": [ "Position.x += Velocity.x;", "Position.y += Velocity.y;" ]
+//			}
+//		},
+//		"archetypes": {
+//			"Particle": { "components": [ "Position", "Velocity" ], "systems": [ "Integrate" ] }
+//		}
+//	}
+//
+// System code is C++ body of per-entity loop. `Component.field` refers to field of current entity.
+// Only components listed in `read` / `write` are accessible, and `read` ones are const.
+
+namespace XEngine::Simulation::ModelCompiler
+{
+	class ModelLoader : public XLib::NonCopyable
+	{
+	private:
+		struct Cursor
+		{
+			uintptr offset; // Line/column are resolved only when error is reported.
+		};
+
+	private:
+		ModelDesc& model;
+
+		XLib::JSONReader jsonReader;
+		const char* jsonPathCStr = nullptr;
+
+	private:
+		void reportError(const char* message, Cursor jsonCursor);
+		void reportJSONError();
+
+		bool consumeKeyWithObjectValue(XLib::StringViewASCII& resultKey);
+		bool consumeSpecificKeyWithStringValue(const char* expectedKey, XLib::StringViewASCII& resultStringValue);
+		bool consumeSpecificKeyWithObjectValue(const char* expectedKey);
+		bool consumeSpecificKeyWithArrayValue(const char* expectedKey);
+
+		// Reads array of component (or system) names, that was already opened, and closes it.
+		bool readComponentNamesArray(XLib::ArrayList<uint16>& resultComponentIndices);
+		bool readSystemNamesArray(XLib::ArrayList<uint16>& resultSystemIndices);
+
+		bool readComponent(XLib::StringViewASCII componentName, Cursor jsonComponentNameCursor);
+		bool readSystem(XLib::StringViewASCII systemName, Cursor jsonSystemNameCursor);
+		bool readArchetype(XLib::StringViewASCII archetypeName, Cursor jsonArchetypeNameCursor);
+
+		sint32 findComponent(XLib::StringViewASCII name) const;
+		sint32 findSystem(XLib::StringViewASCII name) const;
+		sint32 findArchetype(XLib::StringViewASCII name) const;
+
+		inline Cursor getJSONCursor() const { return Cursor { jsonReader.getOffset() }; };
+
+	private:
+		inline ModelLoader(ModelDesc& model) : model(model) {}
+		~ModelLoader() = default;
+
+		bool load(const char* jsonPathCStr, const char* jsonText, uintptr jsonTextLength);
+
+	public:
+		// JSON text should outlive model description.
+		static bool Load(ModelDesc& model, const char* jsonPathCStr, const char* jsonText, uintptr jsonTextLength);
+	};
+}
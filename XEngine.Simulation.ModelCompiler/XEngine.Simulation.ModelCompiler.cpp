@@ -1,6 +1,170 @@
+#include <XLib.h>
+#include <XLib.Fmt.h>
+#include <XLib.Path.h>
+#include <XLib.String.h>
+#include <XLib.System.File.h>
+
 #include "XEngine.Simulation.ModelCompiler.h"
+#include "XEngine.Simulation.ModelCompiler.CodeGenerator.h"
+#include "XEngine.Simulation.ModelCompiler.ModelLoader.h"
+
+using namespace XLib;
+using namespace XEngine::Simulation::ModelCompiler;
+
+// Usage: XEngine.Simulation.ModelCompiler --model=<model JSON path> --out=<output directory>
+// Writes `<model name>.Model.h` and `<model name>.Model.cpp` to output directory. Files are not
+// touched when their content did not change, so dependent code is not rebuilt needlessly.
+
+uint16 XEngine::Simulation::ModelCompiler::GetFieldTypeSize(FieldType type)
+{
+	switch (type)
+	{
+		case FieldType::UInt8:		return 1;
+		case FieldType::UInt16:		return 2;
+		case FieldType::UInt32:		return 4;
+		case FieldType::UInt64:		return 8;
+		case FieldType::SInt8:		return 1;
+		case FieldType::SInt16:		return 2;
+		case FieldType::SInt32:		return 4;
+		case FieldType::SInt64:		return 8;
+		case FieldType::Float32:	return 4;
+		case FieldType::Float64:	return 8;
+		case FieldType::Fixed32:	return 4;
+	}
+	XAssertUnreachableCode();
+	return 0;
+}
+
+const char* XEngine::Simulation::ModelCompiler::GetFieldTypeCppName(FieldType type)
+{
+	switch (type)
+	{
+		case FieldType::UInt8:		return "uint8";
+		case FieldType::UInt16:		return "uint16";
+		case FieldType::UInt32:		return "uint32";
+		case FieldType::UInt64:		return "uint64";
+		case FieldType::SInt8:		return "sint8";
+		case FieldType::SInt16:		return "sint16";
+		case FieldType::SInt32:		return "sint32";
+		case FieldType::SInt64:		return "sint64";
+		case FieldType::Float32:	return "float32";
+		case FieldType::Float64:	return "float64";
+		case FieldType::Fixed32:	return "Fixed";
+	}
+	XAssertUnreachableCode();
+	return nullptr;
+}
+
+static bool LoadTextFile(const char* pathCStr, DynamicStringASCII& text)
+{
+	text = {};
+
+	File file;
+	file.open(pathCStr, FileAccessMode::Read, FileOpenMode::OpenExisting);
+	if (!file.isOpen())
+		return false;
+
+	const uint64 fileSize = file.getSize();
+	if (fileSize == uint64(-1))
+		return false;
+	if (fileSize > uint64(uint32(-1)))
+		return false;
+	const uint32 fileSizeU32 = uint32(fileSize);
+
+	text.growBufferToFitLength(fileSizeU32);
+	text.setLength(fileSizeU32);
+	if (!file.read(text.getData(), fileSizeU32))
+		return false;
+
+	return true;
+}
+
+static bool StoreTextFileIfChanged(const char* pathCStr, const DynamicStringASCII& text)
+{
+	DynamicStringASCII prevText;
+	if (LoadTextFile(pathCStr, prevText) && prevText == StringViewASCII(text.getData(), text.getLength()))
+		return true;
+
+	FmtPrintStdOut("Writing '", pathCStr, "'\n");
+
+	File file;
+	file.open(pathCStr, FileAccessMode::Write, FileOpenMode::Override);
+	if (!file.isOpen())
+	{
+		FmtPrintStdOut("error: failed to open file '", pathCStr, "' for writing\n");
+		return false;
+	}
+
+	file.write(text.getData(), text.getLength());
+	file.close();
+
+	return true;
+}
 
 int main(int argc, char* argv[])
 {
+	static constexpr StringViewASCII ModelFilePathArgKey = StringViewASCII::FromCStr("--model=");
+	static constexpr StringViewASCII OutputDirPathArgKey = StringViewASCII::FromCStr("--out=");
+
+	StringViewASCII modelFilePathArgValue;
+	StringViewASCII outputDirPathArgValue;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const StringViewASCII arg = StringViewASCII::FromCStr(argv[i]);
+		if (arg.startsWith(ModelFilePathArgKey))
+			modelFilePathArgValue = arg.getSubString(ModelFilePathArgKey.getLength());
+		else if (arg.startsWith(OutputDirPathArgKey))
+			outputDirPathArgValue = arg.getSubString(OutputDirPathArgKey.getLength());
+		else
+		{
+			FmtPrintStdOut("error: invalid command line argument '", arg, "'\n");
+			return 1;
+		}
+	}
+
+	if (modelFilePathArgValue.isEmpty())
+	{
+		FmtPrintStdOut("error: missing model file path. Use '", ModelFilePathArgKey, "XXX'\n");
+		return 1;
+	}
+	if (outputDirPathArgValue.isEmpty())
+	{
+		FmtPrintStdOut("error: missing output directory path. Use '", OutputDirPathArgKey, "XXX'\n");
+		return 1;
+	}
+
+	InplaceStringASCIIx1024 modelFilePath;
+	InplaceStringASCIIx1024 outputDirPath;
+	Path::MakeAbsolute(modelFilePathArgValue, modelFilePath);
+	Path::MakeAbsolute(outputDirPathArgValue, outputDirPath);
+	Path::AddTrailingDirectorySeparator(outputDirPath);
+
+	DynamicStringASCII modelText;
+	if (!LoadTextFile(modelFilePath.getCStr(), modelText))
+	{
+		FmtPrintStdOut("error: failed to load model file '", modelFilePath, "'\n");
+		return 1;
+	}
+
+	ModelDesc model;
+	if (!ModelLoader::Load(model, modelFilePath.getCStr(), modelText.getData(), modelText.getLength()))
+		return 1;
+
+	DynamicStringASCII headerText;
+	DynamicStringASCII sourceText;
+	if (!CodeGenerator::Generate(model, modelFilePath.getCStr(), headerText, sourceText))
+		return 1;
+
+	InplaceStringASCIIx1024 headerFilePath;
+	InplaceStringASCIIx1024 sourceFilePath;
+	FmtPrintStr(headerFilePath, outputDirPath, model.name, ".Model.h");
+	FmtPrintStr(sourceFilePath, outputDirPath, model.name, ".Model.cpp");
+
+	if (!StoreTextFileIfChanged(headerFilePath.getCStr(), headerText))
+		return 1;
+	if (!StoreTextFileIfChanged(sourceFilePath.getCStr(), sourceText))
+		return 1;
+
 	return 0;
 }
@@ -1,4 +1,70 @@
+#pragma once
+
+#include <XLib.h>
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.String.h>
+
+// Model description as declared in model JSON file. Names are views into JSON text, so text should
+// outlive description.
+
 namespace XEngine::Simulation::ModelCompiler
 {
+	enum class FieldType : uint8
+	{
+		Undefined = 0,
+		UInt8,
+		UInt16,
+		UInt32,
+		UInt64,
+		SInt8,
+		SInt16,
+		SInt32,
+		SInt64,
+		Float32,
+		Float64,
+		Fixed32, // `Simulation::Fixed`. Should be used for everything that needs deterministic math.
+	};
+
+	// Every field is stored in its own page column.
+	struct ComponentField
+	{
+		XLib::StringViewASCII name;
+		FieldType type;
+	};
+
+	struct Component
+	{
+		XLib::StringViewASCII name;
+		uint16 fieldsBeginIndex;
+		uint16 fieldCount;
+	};
+
+	// System is piece of per-entity code that is specialized for each archetype it is used in.
+	struct System
+	{
+		XLib::StringViewASCII name;
+		XLib::ArrayList<uint16> readComponentIndices;
+		XLib::ArrayList<uint16> writeComponentIndices;
+		XLib::DynamicStringASCII code;
+	};
+
+	struct Archetype
+	{
+		XLib::StringViewASCII name;
+		XLib::ArrayList<uint16> componentIndices;
+		XLib::ArrayList<uint16> systemIndices;
+		uint16 columnCount;
+	};
+
+	struct ModelDesc
+	{
+		XLib::StringViewASCII name;
+		XLib::ArrayList<ComponentField> fields;
+		XLib::ArrayList<Component> components;
+		XLib::ArrayList<System> systems;
+		XLib::ArrayList<Archetype> archetypes;
+	};
 
+	uint16 GetFieldTypeSize(FieldType type);
+	const char* GetFieldTypeCppName(FieldType type);
 }
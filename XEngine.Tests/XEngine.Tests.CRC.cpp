@@ -0,0 +1,129 @@
+#include <XLib.h>
+#include <XLib.CRC.h>
+
+#include "XEngine.Tests.h"
+
+using namespace XLib;
+using namespace XEngine::Tests;
+
+// Check values of every algorithm, then table and hardware implementations against bitwise reference
+// on random sizes and misaligned starts (short inputs below PCLMULQDQ threshold and long ones with
+// every tail length), `Combine` at random split points and seed chaining, which `process` relies on.
+
+namespace
+{
+	constexpr uint32 DataSize = 70000;
+	constexpr uint32 IterationCount = 2000;
+
+	uint8 data[DataSize + 64];
+
+	uint32 ReferenceCRC32(const uint8* bytes, uintptr size, uint32 reflectedPoly)
+	{
+		uint32 crc = 0xFFFF'FFFF;
+		for (uintptr i = 0; i < size; i++)
+		{
+			crc ^= bytes[i];
+			for (uint32 j = 0; j < 8; j++)
+				crc = (crc & 1) ? (crc >> 1) ^ reflectedPoly : crc >> 1;
+		}
+		return ~crc;
+	}
+
+	uint64 ReferenceCRC64(const uint8* bytes, uintptr size)
+	{
+		uint64 crc = 0xFFFF'FFFF'FFFF'FFFF;
+		for (uintptr i = 0; i < size; i++)
+		{
+			crc ^= bytes[i];
+			for (uint32 j = 0; j < 8; j++)
+				crc = (crc & 1) ? (crc >> 1) ^ 0xC96C'5795'D787'0F42 : crc >> 1;
+		}
+		return ~crc;
+	}
+
+	void TestCheckValues()
+	{
+		const char text[] = "123456789";
+		XTestCheck(CRC8::Compute(text, 9) == 0xF4);
+		XTestCheck(CRC16::Compute(text, 9) == 0xBB3D);
+		XTestCheck(CRC32::Compute(text, 9) == 0xCBF4'3926);
+		XTestCheck(CRC32C::Compute(text, 9) == 0xE306'9283);
+		XTestCheck(CRC64::Compute(text, 9) == 0x995D'C9BB'DF19'39FA);
+
+		XTestCheck(CRC8::Compute(text, 0) == 0);
+		XTestCheck(CRC16::Compute(text, 0) == 0);
+		XTestCheck(CRC32::Compute(text, 0) == 0);
+		XTestCheck(CRC32C::Compute(text, 0) == 0);
+		XTestCheck(CRC64::Compute(text, 0) == 0);
+
+		// Small CRCs are only chained through seed.
+		XTestCheck(CRC8::Compute(text + 4, 5, CRC8::Compute(text, 4)) == 0xF4);
+		XTestCheck(CRC16::Compute(text + 4, 5, CRC16::Compute(text, 4)) == 0xBB3D);
+	}
+
+	void TestAgainstReference()
+	{
+		Random random(0xC3C);
+
+		bool allMatch = true;
+		bool allCombined = true;
+		bool allChained = true;
+
+		for (uint32 i = 0; i < IterationCount; i++)
+		{
+			const uint32 offset = random.next32() % 64;
+			const uint32 size = random.next32() % (i < IterationCount / 2 ? 300 : DataSize);
+			const uint8* bytes = data + offset;
+
+			const uint32 crc32 = CRC32::Compute(bytes, size);
+			const uint32 crc32c = CRC32C::Compute(bytes, size);
+			const uint64 crc64 = CRC64::Compute(bytes, size);
+
+			allMatch &= crc32 == ReferenceCRC32(bytes, size, 0xEDB8'8320);
+			allMatch &= crc32c == ReferenceCRC32(bytes, size, 0x82F6'3B78);
+			allMatch &= crc64 == ReferenceCRC64(bytes, size);
+
+			const uint32 sizeA = random.next32() % (size + 1);
+			const uint32 sizeB = size - sizeA;
+			const uint8* bytesB = bytes + sizeA;
+
+			allCombined &= CRC32::Combine(CRC32::Compute(bytes, sizeA), CRC32::Compute(bytesB, sizeB), sizeB) == crc32;
+			allCombined &= CRC32C::Combine(CRC32C::Compute(bytes, sizeA), CRC32C::Compute(bytesB, sizeB), sizeB) == crc32c;
+			allCombined &= CRC64::Combine(CRC64::Compute(bytes, sizeA), CRC64::Compute(bytesB, sizeB), sizeB) == crc64;
+
+			allChained &= CRC32::Compute(bytesB, sizeB, CRC32::Compute(bytes, sizeA)) == crc32;
+			allChained &= CRC32C::Compute(bytesB, sizeB, CRC32C::Compute(bytes, sizeA)) == crc32c;
+			allChained &= CRC64::Compute(bytesB, sizeB, CRC64::Compute(bytes, sizeA)) == crc64;
+
+			CRC64 stream;
+			stream.process(bytes, sizeA);
+			stream.process(bytesB, sizeB);
+			allChained &= stream.getValue() == crc64;
+		}
+
+		XTestCheck(allMatch);
+		XTestCheck(allCombined);
+		XTestCheck(allChained);
+	}
+}
+
+void XEngine::Tests::RunCRCTests()
+{
+	Random random(0xDA7A);
+	for (uint8& byte : data)
+		byte = uint8(random.next32());
+
+	const CRCImplementation implementations[] = { CRCImplementation::Table, CRCImplementation::Hardware };
+	for (CRCImplementation implementation : implementations)
+	{
+		if (implementation == CRCImplementation::Hardware && !CRC::IsHardwareImplementationSupported())
+			continue;
+
+		CRC::SetImplementation(implementation);
+		TestCheckValues();
+		TestAgainstReference();
+	}
+
+	CRC::SetImplementation(CRCImplementation::Default);
+	TestCheckValues();
+}
@@ -0,0 +1,151 @@
+#include <XLib.h>
+
+#include <XEngine.Simulation.FixedPoint.h>
+
+#include "XEngine.Tests.h"
+
+using namespace XLib;
+using namespace XEngine::Tests;
+using namespace XEngine::Simulation;
+
+// Every batch kernel is run at every width supported by CPU and compared element by element with
+// scalar `Fixed` / `FixedMath` operation. Counts cover empty input, partial vectors and long runs,
+// and inputs include values that overflow 32-bit and 64-bit intermediates.
+
+namespace
+{
+	constexpr uint32 MaxCount = 1003;
+
+	constexpr sint32 EdgeValues[] =
+	{
+		0, 1, -1, Fixed::OneRaw, -Fixed::OneRaw, Fixed::OneRaw / 2, sint32(0x7FFFFFFF), sint32(0x80000000), 0x7FFF, -0x8000,
+	};
+
+	// Components of normalized vectors should not exceed 2^14 in magnitude.
+	constexpr sint32 NormalizeRangeMask = (sint32(1) << 30) - 1;
+
+	struct Columns
+	{
+		Fixed values[6][MaxCount];
+	};
+
+	Columns inputs;
+	Columns normalizeInputs;
+	Columns normalized;
+	Fixed result[MaxCount];
+	Fixed expected[MaxCount];
+
+	void FillColumns(Columns& columns, Random& random, sint32 rangeMask)
+	{
+		for (Fixed* column : columns.values)
+		{
+			for (uint32 i = 0; i < MaxCount; i++)
+			{
+				// Every 16th value is edge one.
+				const uint32 r = random.next32();
+				sint32 raw = (r & 15) == 0 ? EdgeValues[(r >> 4) % countOf(EdgeValues)] : sint32(random.next32());
+				if (rangeMask != -1)
+					raw = (raw & rangeMask) * ((r & 16) ? -1 : 1);
+				column[i] = Fixed::FromRaw(raw);
+			}
+		}
+	}
+
+	bool IsEqual(const Fixed* a, const Fixed* b, uint32 count)
+	{
+		for (uint32 i = 0; i < count; i++)
+		{
+			if (a[i] != b[i])
+				return false;
+		}
+		return true;
+	}
+
+	void TestKernels(FixedBatchWidth width, uint32 count)
+	{
+		FixedBatch::SetWidth(width);
+		XTestCheck(FixedBatch::GetWidth() == width);
+
+		const Fixed (&in)[6][MaxCount] = inputs.values;
+		const Fixed dt = in[5][0];
+
+		FixedBatch::Add(in[0], in[1], result, count);
+		for (uint32 i = 0; i < count; i++)
+			expected[i] = in[0][i] + in[1][i];
+		XTestCheck(IsEqual(result, expected, count));
+
+		FixedBatch::Sub(in[0], in[1], result, count);
+		for (uint32 i = 0; i < count; i++)
+			expected[i] = in[0][i] - in[1][i];
+		XTestCheck(IsEqual(result, expected, count));
+
+		FixedBatch::Mul(in[0], in[1], result, count);
+		for (uint32 i = 0; i < count; i++)
+			expected[i] = in[0][i] * in[1][i];
+		XTestCheck(IsEqual(result, expected, count));
+
+		FixedBatch::MulScalar(in[0], dt, result, count);
+		for (uint32 i = 0; i < count; i++)
+			expected[i] = in[0][i] * dt;
+		XTestCheck(IsEqual(result, expected, count));
+
+		FixedBatch::Dot2(in[0], in[1], in[2], in[3], result, count);
+		for (uint32 i = 0; i < count; i++)
+			expected[i] = FixedMath::Dot(FixedVec2(in[0][i], in[1][i]), FixedVec2(in[2][i], in[3][i]));
+		XTestCheck(IsEqual(result, expected, count));
+
+		FixedBatch::Dot3(in[0], in[1], in[2], in[3], in[4], in[5], result, count);
+		for (uint32 i = 0; i < count; i++)
+			expected[i] = FixedMath::Dot(FixedVec3(in[0][i], in[1][i], in[2][i]), FixedVec3(in[3][i], in[4][i], in[5][i]));
+		XTestCheck(IsEqual(result, expected, count));
+
+		// In place kernels. Output aliasing input is also covered this way.
+		{
+			memoryCopy(result, in[0], sizeof(result));
+			FixedBatch::Integrate(result, in[1], dt, count);
+			for (uint32 i = 0; i < count; i++)
+				expected[i] = in[0][i] + in[1][i] * dt;
+			XTestCheck(IsEqual(result, expected, count));
+		}
+
+		{
+			normalized = normalizeInputs;
+			Fixed (&n)[6][MaxCount] = normalized.values;
+			const Fixed (&src)[6][MaxCount] = normalizeInputs.values;
+
+			FixedBatch::Normalize2(n[0], n[1], count);
+			FixedBatch::Normalize3(n[2], n[3], n[4], count);
+
+			bool match = true;
+			for (uint32 i = 0; i < count; i++)
+			{
+				const FixedVec2 v2 = FixedMath::Normalize(FixedVec2(src[0][i], src[1][i]));
+				const FixedVec3 v3 = FixedMath::Normalize(FixedVec3(src[2][i], src[3][i], src[4][i]));
+				match &= n[0][i] == v2.x && n[1][i] == v2.y;
+				match &= n[2][i] == v3.x && n[3][i] == v3.y && n[4][i] == v3.z;
+			}
+			XTestCheck(match);
+		}
+	}
+}
+
+void XEngine::Tests::RunFixedPointTests()
+{
+	Random random(0x5EED);
+	FillColumns(inputs, random, -1);
+	FillColumns(normalizeInputs, random, NormalizeRangeMask);
+
+	const FixedBatchWidth widths[] = { FixedBatchWidth::Scalar, FixedBatchWidth::SSE4, FixedBatchWidth::AVX2 };
+	for (FixedBatchWidth width : widths)
+	{
+		if (uint8(width) > uint8(FixedBatch::GetMaxSupportedWidth()))
+			continue;
+
+		for (uint32 count = 0; count <= 17; count++)
+			TestKernels(width, count);
+		TestKernels(width, MaxCount);
+	}
+
+	FixedBatch::SetWidth(FixedBatchWidth::Default);
+	XTestCheck(FixedBatch::GetWidth() == FixedBatch::GetMaxSupportedWidth());
+}
@@ -0,0 +1,325 @@
+#include <stdlib.h>
+
+#include <XLib.h>
+#include <XLib.CharStream.h>
+#include <XLib.Fmt.h>
+#include <XLib.String.h>
+
+#include "XEngine.Tests.h"
+
+using namespace XLib;
+using namespace XEngine::Tests;
+
+// Integer parsing at type limits, one past them, with signs and trailing chars.
+// Format string specs for floating point: width is total field width (sign included, zeros after
+// sign), `f` precision is fraction digit count (padded with trailing zeros). Same output is expected
+// from span path and from put path used by writers that can not reserve span.
+// Floating point round trip: shortest text of every tested value should parse back to the same bits
+// with both `FmtParseDecFP*` and CRT `strtof`/`strtod` (so text is not only self-consistent, but
+// also means the right value), and `FmtParseDecFP*` should agree with CRT on texts with more digits
+// than needed, which exercise rounding of long inputs. Default run samples float32 space with prime
+// stride plus edge values. `Fmt.FP32Exhaustive` covers all 2^32 bit patterns and is run only when
+// asked by full name, as it takes minutes.
+
+namespace
+{
+	template <typename T, typename ParseFunc>
+	bool Parse(const ParseFunc& parseFunc, const char* text, T expectedValue, FmtParseStatus expectedStatus, uint8 expectedCharCount)
+	{
+		T value = T(0x5A);
+		const FmtParseResult result = parseFunc(text, StringViewASCII::FromCStr(text).getLength(), value);
+		if (result.status != expectedStatus || result.parsedCharCount != expectedCharCount)
+			return false;
+		return expectedStatus != FmtParseStatus::Success || value == expectedValue;
+	}
+
+	void TestIntegerParsing()
+	{
+		const auto u8 = [](const char* c, uintptr n, uint8& v) { return FmtParseDecU8(c, n, v); };
+		const auto u64 = [](const char* c, uintptr n, uint64& v) { return FmtParseDecU64(c, n, v); };
+		const auto s8 = [](const char* c, uintptr n, sint8& v) { return FmtParseDecS8(c, n, v); };
+		const auto s8Plus = [](const char* c, uintptr n, sint8& v) { return FmtParseDecS8(c, n, v, true); };
+		const auto s64 = [](const char* c, uintptr n, sint64& v) { return FmtParseDecS64(c, n, v); };
+		const auto h16 = [](const char* c, uintptr n, uint16& v) { return FmtParseHex16(c, n, v); };
+		const auto h64 = [](const char* c, uintptr n, uint64& v) { return FmtParseHex64(c, n, v); };
+
+		XTestCheck(Parse<uint8>(u8, "0", 0, FmtParseStatus::Success, 1));
+		XTestCheck(Parse<uint8>(u8, "255", 255, FmtParseStatus::Success, 3));
+		XTestCheck(Parse<uint8>(u8, "0255", 255, FmtParseStatus::Success, 4));
+		XTestCheck(Parse<uint8>(u8, "256", 0, FmtParseStatus::OutOfRange, 3));
+		XTestCheck(Parse<uint8>(u8, "12x", 12, FmtParseStatus::Success, 2));
+		XTestCheck(Parse<uint8>(u8, "", 0, FmtParseStatus::InvalidFormat, 0));
+		XTestCheck(Parse<uint8>(u8, "-1", 0, FmtParseStatus::InvalidFormat, 0));
+		XTestCheck(Parse<uint64>(u64, "18446744073709551615", uint64(-1), FmtParseStatus::Success, 20));
+		XTestCheck(Parse<uint64>(u64, "18446744073709551616", 0, FmtParseStatus::OutOfRange, 20));
+
+		XTestCheck(Parse<sint8>(s8, "-128", -128, FmtParseStatus::Success, 4));
+		XTestCheck(Parse<sint8>(s8, "127", 127, FmtParseStatus::Success, 3));
+		XTestCheck(Parse<sint8>(s8, "128", 0, FmtParseStatus::OutOfRange, 3));
+		XTestCheck(Parse<sint8>(s8, "-129", 0, FmtParseStatus::OutOfRange, 4));
+		XTestCheck(Parse<sint8>(s8, "+1", 0, FmtParseStatus::InvalidFormat, 0));
+		XTestCheck(Parse<sint8>(s8Plus, "+1", 1, FmtParseStatus::Success, 2));
+		XTestCheck(Parse<sint8>(s8, "-", 0, FmtParseStatus::InvalidFormat, 0));
+		XTestCheck(Parse<sint64>(s64, "-9223372036854775808", sint64(0x8000000000000000), FmtParseStatus::Success, 20));
+		XTestCheck(Parse<sint64>(s64, "9223372036854775807", sint64(0x7FFFFFFFFFFFFFFF), FmtParseStatus::Success, 19));
+		XTestCheck(Parse<sint64>(s64, "9223372036854775808", 0, FmtParseStatus::OutOfRange, 19));
+
+		XTestCheck(Parse<uint16>(h16, "fFaA", 0xFFAA, FmtParseStatus::Success, 4));
+		XTestCheck(Parse<uint16>(h16, "10000", 0, FmtParseStatus::OutOfRange, 5));
+		XTestCheck(Parse<uint16>(h16, "0x1", 0, FmtParseStatus::Success, 1));
+		XTestCheck(Parse<uint16>(h16, "g", 0, FmtParseStatus::InvalidFormat, 0));
+		XTestCheck(Parse<uint64>(h64, "0123456789ABCDEF", 0x0123456789ABCDEFull, FmtParseStatus::Success, 16));
+	}
+
+	template <typename FloatT, typename BitsT>
+	inline BitsT ToBits(FloatT value)
+	{
+		BitsT bits = 0;
+		memoryCopy(&bits, &value, sizeof(value));
+		return bits;
+	}
+
+	inline bool IsNaNBits32(uint32 bits) { return (bits & 0x7F800000) == 0x7F800000 && (bits & 0x007FFFFF) != 0; }
+	inline bool IsNaNBits64(uint64 bits) { return (bits & 0x7FF0000000000000ull) == 0x7FF0000000000000ull && (bits & 0x000FFFFFFFFFFFFFull) != 0; }
+
+	// Returns false on first mismatch, so caller can report bits.
+	bool CheckFP32RoundTrip(uint32 bits)
+	{
+		if (IsNaNBits32(bits))
+			return true;
+
+		float32 value = 0.0f;
+		memoryCopy(&value, &bits, sizeof(value));
+
+		char buffer[32];
+		const FmtFormatResult formatResult = FmtFormatDecFP32(value, buffer, sizeof(buffer) - 1, 0);
+		if (formatResult.status != FmtFormatStatus::Success)
+			return false;
+		buffer[formatResult.formattedCharCount] = 0;
+
+		float32 parsedValue = 0.0f;
+		const FmtParseResult parseResult = FmtParseDecFP32(buffer, formatResult.formattedCharCount, parsedValue);
+		if (parseResult.parsedCharCount != formatResult.formattedCharCount || ToBits<float32, uint32>(parsedValue) != bits)
+			return false;
+		if (parseResult.status != FmtParseStatus::Success && !(parseResult.status == FmtParseStatus::OutOfRange && (bits & 0x7FFFFFFF) == 0x7F800000))
+			return false;
+
+		return ToBits<float32, uint32>(strtof(buffer, nullptr)) == bits;
+	}
+
+	void TestFP32RoundTrip(uint64 stride)
+	{
+		uint64 mismatchCount = 0;
+		uint32 firstMismatchBits = 0;
+		const auto check = [&](uint32 bits)
+		{
+			if (!CheckFP32RoundTrip(bits))
+			{
+				if (!mismatchCount)
+					firstMismatchBits = bits;
+				mismatchCount++;
+			}
+		};
+
+		for (uint64 bits = 0; bits <= 0xFFFFFFFFull; bits += stride)
+			check(uint32(bits));
+
+		if (stride > 1)
+		{
+			// Neighbourhoods of zero, smallest normal, one, largest finite and infinity, for both signs.
+			const uint32 edgeBits[] = { 0x00000000, 0x00800000, 0x3F800000, 0x7F7FFFFF, 0x7F800000 };
+			for (uint32 edge : edgeBits)
+			{
+				for (uint32 delta = 0; delta < 64; delta++)
+				{
+					check((edge + delta) & 0x7FFFFFFF);
+					check((edge - delta) & 0x7FFFFFFF);
+					check(((edge + delta) & 0x7FFFFFFF) | 0x80000000);
+				}
+			}
+
+			// Every power of two.
+			for (uint32 exponent = 0; exponent < 255; exponent++)
+				check(exponent << 23);
+		}
+
+		if (mismatchCount)
+			FmtPrintStdOut("float32 round trip mismatch count: ", mismatchCount, ", first bits: ", FmtArgHex32(firstMismatchBits), '\n');
+		XTestCheck(mismatchCount == 0);
+	}
+
+	void TestFP64RoundTrip()
+	{
+		Random random(0xF10A7);
+
+		uint64 mismatchCount = 0;
+		uint64 firstMismatchBits = 0;
+		for (uint32 i = 0; i < 1000000; i++)
+		{
+			const uint64 bits = random.next64();
+			if (IsNaNBits64(bits) || (bits & 0x7FF0000000000000ull) == 0x7FF0000000000000ull)
+				continue;
+
+			float64 value = 0.0;
+			memoryCopy(&value, &bits, sizeof(value));
+
+			char buffer[40];
+			const FmtFormatResult formatResult = FmtFormatDecFP64(value, buffer, sizeof(buffer) - 1, 0);
+			bool match = formatResult.status == FmtFormatStatus::Success;
+			if (match)
+			{
+				buffer[formatResult.formattedCharCount] = 0;
+
+				float64 parsedValue = 0.0;
+				const FmtParseResult parseResult = FmtParseDecFP64(buffer, formatResult.formattedCharCount, parsedValue);
+				match = parseResult.status == FmtParseStatus::Success && parseResult.parsedCharCount == formatResult.formattedCharCount &&
+					ToBits<float64, uint64>(parsedValue) == bits && ToBits<float64, uint64>(strtod(buffer, nullptr)) == bits;
+			}
+
+			if (!match)
+			{
+				if (!mismatchCount)
+					firstMismatchBits = bits;
+				mismatchCount++;
+			}
+		}
+
+		if (mismatchCount)
+			FmtPrintStdOut("float64 round trip mismatch count: ", mismatchCount, ", first bits: ", FmtArgHex64(firstMismatchBits), '\n');
+		XTestCheck(mismatchCount == 0);
+	}
+
+	void TestLongInputParsing()
+	{
+		// Random 17..40 digit mantissas with random exponents.
+		Random random(0x10C6);
+
+		uint64 mismatchCount = 0;
+		for (uint32 i = 0; i < 100000; i++)
+		{
+			char buffer[64];
+			uint32 length = 0;
+			if (random.next32() & 1)
+				buffer[length++] = '-';
+
+			const uint32 digitCount = 17 + random.next32() % 24;
+			for (uint32 j = 0; j < digitCount; j++)
+			{
+				buffer[length++] = char('0' + random.next32() % 10);
+				if (j == 0)
+					buffer[length++] = '.';
+			}
+
+			buffer[length++] = 'e';
+			const sint32 exponent = sint32(random.next32() % 700) - 350;
+			const FmtFormatResult exponentFormatResult = FmtFormatDecS32(exponent, buffer + length, uint8(sizeof(buffer) - 1 - length));
+			length += exponentFormatResult.formattedCharCount;
+			buffer[length] = 0;
+
+			float64 value = 0.0;
+			const FmtParseResult parseResult = FmtParseDecFP64(buffer, length, value);
+			const float64 expectedValue = strtod(buffer, nullptr);
+			if (parseResult.parsedCharCount != length || ToBits<float64, uint64>(value) != ToBits<float64, uint64>(expectedValue))
+				mismatchCount++;
+
+			float32 value32 = 0.0f;
+			const FmtParseResult parseResult32 = FmtParseDecFP32(buffer, length, value32);
+			if (parseResult32.parsedCharCount != length || ToBits<float32, uint32>(value32) != ToBits<float32, uint32>(strtof(buffer, nullptr)))
+				mismatchCount++;
+		}
+
+		// Ties and near-ties between adjacent values, where any error in long input handling flips result.
+		const char* const halfwayTexts[] =
+		{
+			"9007199254740993",						// 2^53 + 1, ties to even (down).
+			"9007199254740995",						// 2^53 + 3, ties to even (up).
+			"9007199254740993.0000000000000000001",	// Just above tie.
+			"2.4703282292062327e-324",				// Just below half of smallest denormal.
+			"2.4703282292062328e-324",				// Just above half of smallest denormal.
+			"1.7976931348623158e308",				// Rounds down to largest finite.
+			"1.7976931348623159e308",				// Rounds up to infinity.
+			"16777217",								// 2^24 + 1, float32 tie.
+			"16777217.000000000000000000000001",	// Just above float32 tie.
+		};
+		for (const char* text : halfwayTexts)
+		{
+			const uintptr length = StringViewASCII::FromCStr(text).getLength();
+
+			float64 value = 0.0;
+			FmtParseDecFP64(text, length, value);
+			if (ToBits<float64, uint64>(value) != ToBits<float64, uint64>(strtod(text, nullptr)))
+				mismatchCount++;
+
+			float32 value32 = 0.0f;
+			FmtParseDecFP32(text, length, value32);
+			if (ToBits<float32, uint32>(value32) != ToBits<float32, uint32>(strtof(text, nullptr)))
+				mismatchCount++;
+		}
+
+		XTestCheck(mismatchCount == 0);
+	}
+
+	template <FmtFormatString Format, typename ... FmtArgs>
+	bool FormatsTo(const char* expectedText, const FmtArgs& ... args)
+	{
+		InplaceStringASCIIx256 spanText;
+		FmtPrintFStr<Format>(spanText, args ...);
+
+		// Buffer is smaller than any FP arg max length, so `reserve` fails and put path is taken.
+		char buffer[64];
+		MemoryCharStreamWriter putWriter(buffer, sizeof(buffer) - 1);
+		FmtPrintF<Format>(putWriter, args ...);
+		putWriter.nullTerminate();
+
+		const StringViewASCII expected = StringViewASCII::FromCStr(expectedText);
+		return spanText.getView() == expected && StringViewASCII::FromCStr(buffer) == expected;
+	}
+
+	void TestFormatSpecs()
+	{
+		XTestCheck(FormatsTo<"{:08.3f}">("0003.142", 3.14159));
+		XTestCheck(FormatsTo<"{:08.3f}">("-003.142", -3.14159));
+		XTestCheck(FormatsTo<"{:8.3f}">("   3.142", 3.14159));
+		XTestCheck(FormatsTo<"{:08.3f}">("12345.679", 12345.6789));
+		XTestCheck(FormatsTo<"{:.2f}">("2.00", 2.0));
+		XTestCheck(FormatsTo<"{:.2f}">("2.00", 2.0f));
+		XTestCheck(FormatsTo<"{:.3f}">("0.000", 0.0));
+		XTestCheck(FormatsTo<"{:.2f}">("-0.00", -0.001));
+		XTestCheck(FormatsTo<"{:.2f}">("0.01", 0.005));
+		XTestCheck(FormatsTo<"{:.2f}">("0.00", 0.004));
+		XTestCheck(FormatsTo<"{:.1f}">("1.0", 0.96));
+		XTestCheck(FormatsTo<"{:.1f}">("0.2", 0.25));
+		XTestCheck(FormatsTo<"{:.1f}">("0.3", 0.35));
+		XTestCheck(FormatsTo<"{:.1f}">("0.0", 0.04));
+		XTestCheck(FormatsTo<"{:.2f}">("100.00", 99.999));
+		XTestCheck(FormatsTo<"{:.1f}">("1234567.0", 1234567.0));
+		XTestCheck(FormatsTo<"{:.2f} ms">("12.50 ms", 12.5f));
+		XTestCheck(FormatsTo<"[{:6}]">("[   1.5]", 1.5));
+		XTestCheck(FormatsTo<"[{:06}]">("[-001.5]", -1.5));
+		XTestCheck(FormatsTo<"{}">("0.1", 0.1));
+
+		// Explicit argument structs ignore spec and take default shortest notation on both paths.
+		XTestCheck(FormatsTo<"{}">("0.1", FmtArgFP32 { 0.1f }));
+		XTestCheck(FormatsTo<"{}">("-2.5", FmtArgFP64 { -2.5 }));
+
+		char buffer[8];
+		MemoryCharStreamWriter writer(buffer, sizeof(buffer) - 1);
+		FmtPrint(writer, FmtArgFP32 { 0.25f });
+		writer.nullTerminate();
+		XTestCheck(StringViewASCII::FromCStr(buffer) == StringViewASCII::FromCStr("0.25"));
+	}
+}
+
+void XEngine::Tests::RunFmtTests()
+{
+	TestIntegerParsing();
+	TestFormatSpecs();
+	TestFP32RoundTrip(65521);
+	TestFP64RoundTrip();
+	TestLongInputParsing();
+}
+
+void XEngine::Tests::RunFmtFP32ExhaustiveTests()
+{
+	TestFP32RoundTrip(1);
+}
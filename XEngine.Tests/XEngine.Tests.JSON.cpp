@@ -0,0 +1,174 @@
+#include <XLib.h>
+#include <XLib.CharStream.h>
+#include <XLib.Containers.HashMap.h>
+#include <XLib.Fmt.h>
+#include <XLib.JSON.h>
+#include <XLib.String.h>
+
+#include "XEngine.Tests.h"
+
+using namespace XLib;
+using namespace XEngine::Tests;
+
+// Number values read by `JSONReader` (valid and malformed tokens, integer detection) and member
+// lookup in `JSONDocument` on objects below and above member index threshold, by key and by hash,
+// including members with nested subtrees between them.
+
+namespace
+{
+	bool ReadSingleNumber(const char* text, JSONNumber& result)
+	{
+		JSONReader reader;
+		JSONValue value = {};
+		if (!reader.openDocument(text, StringViewASCII::FromCStr(text).getLength()) || !reader.readValue(value))
+			return false;
+		if (value.type != JSONValueType::Number || !reader.isEndOfDocument())
+			return false;
+		result = value.number;
+		return true;
+	}
+
+	void TestNumbers()
+	{
+		JSONNumber number = {};
+
+		XTestCheck(ReadSingleNumber("0", number) && number.isInteger && number.integer == 0 && number.floatingPoint == 0.0);
+		XTestCheck(ReadSingleNumber("-42", number) && number.isInteger && number.integer == -42 && number.floatingPoint == -42.0);
+		XTestCheck(ReadSingleNumber("+7", number) && number.isInteger && number.integer == 7);
+		XTestCheck(ReadSingleNumber("9223372036854775807", number) && number.isInteger && number.integer == sint64(0x7FFFFFFFFFFFFFFF));
+		XTestCheck(ReadSingleNumber("-9223372036854775808", number) && number.isInteger && number.integer == sint64(0x8000000000000000));
+		XTestCheck(ReadSingleNumber("9223372036854775808", number) && !number.isInteger && number.floatingPoint == 9223372036854775808.0);
+		XTestCheck(ReadSingleNumber("0.1", number) && !number.isInteger && number.floatingPoint == 0.1);
+		XTestCheck(ReadSingleNumber("-2.5e-3", number) && !number.isInteger && number.floatingPoint == -2.5e-3);
+		XTestCheck(ReadSingleNumber("1E10", number) && !number.isInteger && number.floatingPoint == 1e10);
+		XTestCheck(ReadSingleNumber("1.7976931348623157e308", number) && number.floatingPoint == 1.7976931348623157e308);
+		XTestCheck(ReadSingleNumber("4.9406564584124654e-324", number) && number.floatingPoint == 4.9406564584124654e-324);
+
+		XTestCheck(!ReadSingleNumber("1.2.3", number));
+		XTestCheck(!ReadSingleNumber("1e", number));
+		XTestCheck(!ReadSingleNumber("--1", number));
+		XTestCheck(!ReadSingleNumber("-", number));
+		XTestCheck(!ReadSingleNumber("1e400", number));
+
+		// Number is terminated by structural chars and whitespace.
+		JSONDocument document;
+		const char text[] = "[1,-2.5 ,3e2]";
+		XTestCheck(document.parse(text, sizeof(text) - 1));
+		const JSONDocument::Element root = document.getRoot();
+		XTestCheck(root.isArray() && root.getChildCount() == 3);
+
+		sint64 integer = 0;
+		const JSONDocument::Element first = root.getFirstChild();
+		const JSONDocument::Element second = first.getNextSibling();
+		const JSONDocument::Element third = second.getNextSibling();
+		XTestCheck(first.isNumber() && first.getInteger(integer) && integer == 1 && first.getNumber() == 1.0);
+		XTestCheck(second.isNumber() && !second.getInteger(integer) && second.getNumber() == -2.5);
+		XTestCheck(third.isNumber() && !third.getInteger(integer) && third.getNumber() == 300.0);
+
+		JSONReader reader;
+		JSONValue value = {};
+		const char malformedText[] = "[1, 2x]";
+		XTestCheck(reader.openDocument(malformedText, sizeof(malformedText) - 1) && reader.readValue(value) && reader.openArray());
+		XTestCheck(reader.readValue(value) && value.type == JSONValueType::Number && value.number.integer == 1);
+		XTestCheck(!reader.readValue(value));
+	}
+
+	uint64 HashKey(StringViewASCII key)
+	{
+		return HashMapHashing::ComputeBytes(key.getData(), key.getLength());
+	}
+
+	void TestMemberLookup(uint32 memberCount, JSONDocument::KeyHashFunc keyHashFunc)
+	{
+		// Every third member is nested object, so children are not adjacent nodes. Every fifth key is
+		// escaped, so it is decoded into tape.
+		DynamicStringASCII text;
+		{
+			VirtualStringWriter writer(text);
+			writer.put('{');
+			for (uint32 i = 0; i < memberCount; i++)
+			{
+				if (i % 5 == 0)
+					FmtPrint(writer, "\"key\\t", i, "\": ");
+				else
+					FmtPrint(writer, "\"key_", i, "\": ");
+
+				if (i % 3 == 0)
+					FmtPrint(writer, "{ \"value\": ", i, ", \"list\": [ 1, 2, { \"x\": 3 } ] }");
+				else
+					FmtPrint(writer, i);
+
+				writer.write(i + 1 < memberCount ? ", " : "");
+			}
+			writer.put('}');
+		}
+
+		JSONDocument document;
+		XTestCheck(document.parse(text.getData(), text.getLength(), keyHashFunc));
+
+		const JSONDocument::Element root = document.getRoot();
+		XTestCheck(root.isObject() && root.getChildCount() == memberCount);
+
+		bool allFound = true;
+		for (uint32 i = 0; i < memberCount; i++)
+		{
+			InplaceStringASCIIx64 key;
+			if (i % 5 == 0)
+				FmtPrintStr(key, "key\t", i);
+			else
+				FmtPrintStr(key, "key_", i);
+
+			JSONDocument::Element member = root.findMember(key);
+			allFound &= member.isValid() && member.getKey() == key;
+
+			if (keyHashFunc)
+			{
+				const JSONDocument::Element memberByHash = root.findMember(keyHashFunc(key));
+				allFound &= memberByHash.isValid() && memberByHash.getKey() == key;
+			}
+
+			if (member.isValid() && member.isObject())
+				member = member.findMember(StringViewASCII::FromCStr("value"));
+
+			sint64 value = -1;
+			allFound &= member.isValid() && member.isNumber() && member.getInteger(value) && value == sint64(i);
+		}
+		XTestCheck(allFound);
+
+		XTestCheck(!root.findMember(StringViewASCII::FromCStr("key_")).isValid());
+		XTestCheck(!root.findMember(StringViewASCII::FromCStr("")).isValid());
+		if (keyHashFunc)
+			XTestCheck(!root.findMember(keyHashFunc(StringViewASCII::FromCStr("missing"))).isValid());
+
+		// Child iteration does not run into member index.
+		uint32 childCount = 0;
+		for (JSONDocument::Element member = root.getFirstChild(); member.isValid(); member = member.getNextSibling())
+			childCount++;
+		XTestCheck(childCount == memberCount);
+	}
+}
+
+void XEngine::Tests::RunJSONTests()
+{
+	TestNumbers();
+
+	const uint32 memberCounts[] = { 0, 1, 15, 16, 17, 100, 1000 };
+	for (uint32 memberCount : memberCounts)
+	{
+		TestMemberLookup(memberCount, nullptr);
+		TestMemberLookup(memberCount, &HashKey);
+	}
+
+	// Member index inside array inside object, so sibling skipping over indexed subtrees is covered.
+	const char text[] =
+		"{ \"a\": [ { \"m0\":0,\"m1\":1,\"m2\":2,\"m3\":3,\"m4\":4,\"m5\":5,\"m6\":6,\"m7\":7,\"m8\":8,\"m9\":9,"
+		"\"m10\":10,\"m11\":11,\"m12\":12,\"m13\":13,\"m14\":14,\"m15\":15,\"m16\":16 }, 5 ], \"b\": true }";
+	JSONDocument document;
+	XTestCheck(document.parse(text, sizeof(text) - 1));
+	const JSONDocument::Element root = document.getRoot();
+	const JSONDocument::Element a = root.findMember(StringViewASCII::FromCStr("a"));
+	XTestCheck(a.isArray() && a.getChildCount() == 2);
+	XTestCheck(a.getFirstChild().getNextSibling().isNumber() && a.getFirstChild().getNextSibling().getNumber() == 5.0);
+	XTestCheck(a.getFirstChild().findMember(StringViewASCII::FromCStr("m16")).getNumber() == 16.0);
+	XTestCheck(root.findMember(StringViewASCII::FromCStr("b")).isBoolean() && root.findMember(StringViewASCII::FromCStr("b")).getBoolean());
+}
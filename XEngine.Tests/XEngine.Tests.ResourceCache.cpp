@@ -0,0 +1,245 @@
+#include <XLib.h>
+
+#include <XEngine.Core.ResourceCacheBase.h>
+
+#include "XEngine.Tests.h"
+
+using namespace XLib;
+using namespace XEngine::Core;
+using namespace XEngine::Tests;
+
+// Cache with loader that completes only when test says so. Covers load sharing between queries,
+// failure, LRU eviction and callbacks that reenter cache while other queries of the same resource
+// are still pending. Memory budget of zero makes every unreferenced resource evicted at once,
+// so premature eviction shows up as unload or invalid handle.
+
+namespace
+{
+	constexpr uint64 ResourceByteSize = 100;
+
+	struct TestResource
+	{
+		ResourceUID uid;
+		bool loaded;
+	};
+
+	class TestCache : public ResourceCacheBase<TestResource, TestCache>
+	{
+		friend ResourceCacheBase<TestResource, TestCache>;
+
+	public:
+		ResourceHandle lastLoadingHandle = 0;
+		float32 lastLoadingPriority = 0.0f;
+		uint32 startedLoadCount = 0;
+		uint32 cancelledLoadCount = 0;
+		uint32 unloadCount = 0;
+
+	private:
+		inline void startLoading(TestResource& resource, ResourceUID uid, float32 priority, ResourceHandle loadingHandle)
+		{
+			resource.uid = uid;
+			resource.loaded = false;
+			lastLoadingHandle = loadingHandle;
+			lastLoadingPriority = priority;
+			startedLoadCount++;
+		}
+		inline void setLoadingPriority(TestResource& resource, ResourceHandle loadingHandle, float32 priority) { lastLoadingPriority = priority; }
+		inline void cancelLoading(TestResource& resource, ResourceHandle loadingHandle) { cancelledLoadCount++; }
+		inline void unload(TestResource& resource) { XTestCheck(resource.loaded); resource.loaded = false; unloadCount++; }
+
+	public:
+		inline void completeLoading(ResourceHandle loadingHandle, bool success)
+		{
+			onLoadingComplete(loadingHandle, success ? LoadingResult::Success : LoadingResult::Failure, ResourceByteSize);
+		}
+	};
+
+	struct QueryContext
+	{
+		TestCache* cache;
+		ResourceHandle handle;
+		uint32 readyCount;
+		uint32 invalidCount;
+		bool releaseOnReady;
+		ResourceQueryHandle queryToCancel;
+	};
+
+	void QueryCallback(void* contextPtr, ResourceQueryHandle queryHandle, QueryResourceResultType type, ResourceHandle handle)
+	{
+		QueryContext& context = *(QueryContext*)contextPtr;
+
+		if (type != QueryResourceResultType::ResourceReady)
+		{
+			context.invalidCount++;
+			return;
+		}
+
+		XTestCheck(context.cache->isValidHandle(handle));
+		context.readyCount++;
+		context.handle = handle;
+
+		// Loader fills resource before completion. Test does it on first callback instead.
+		((TestResource&)context.cache->get(handle)).loaded = true;
+
+		if (context.queryToCancel)
+			context.cache->cancelQuery(context.queryToCancel);
+		if (context.releaseOnReady)
+			context.cache->removeReference(handle);
+	}
+
+	void TestSharedLoad()
+	{
+		TestCache cache;
+
+		QueryContext a = { &cache };
+		QueryContext b = { &cache };
+		const QueryResourceResult resultA = cache.query(1, 1.0f, &QueryCallback, &a);
+		const QueryResourceResult resultB = cache.query(1, 5.0f, &QueryCallback, &b);
+		XTestCheck(resultA.type == QueryResourceResultType::ResourceQueryPending);
+		XTestCheck(resultB.type == QueryResourceResultType::ResourceQueryPending);
+		XTestCheck(cache.startedLoadCount == 1);
+		XTestCheck(cache.lastLoadingPriority == 5.0f);
+
+		cache.cancelQuery(resultB.pendingResourceQueryHandle);
+		XTestCheck(cache.lastLoadingPriority == 1.0f);
+		XTestCheck(cache.cancelledLoadCount == 0);
+
+		cache.completeLoading(cache.lastLoadingHandle, true);
+		XTestCheck(a.readyCount == 1 && b.readyCount == 0);
+		XTestCheck(cache.getResidentByteSize() == ResourceByteSize);
+
+		// Loaded resource is returned right away with its own reference.
+		const QueryResourceResult resultC = cache.query(1, 1.0f, &QueryCallback, nullptr);
+		XTestCheck(resultC.type == QueryResourceResultType::ResourceReady);
+		XTestCheck(resultC.readyResourceHandle == a.handle);
+
+		cache.removeReference(a.handle);
+		cache.removeReference(resultC.readyResourceHandle);
+	}
+
+	void TestFailedLoad()
+	{
+		TestCache cache;
+
+		QueryContext a = { &cache };
+		QueryContext b = { &cache };
+		cache.query(1, 1.0f, &QueryCallback, &a);
+		cache.query(1, 1.0f, &QueryCallback, &b);
+		cache.completeLoading(cache.lastLoadingHandle, false);
+		XTestCheck(a.invalidCount == 1 && b.invalidCount == 1);
+		XTestCheck(cache.getResidentByteSize() == 0);
+
+		// Failed UID is not remembered.
+		cache.query(1, 1.0f, &QueryCallback, &a);
+		XTestCheck(cache.startedLoadCount == 2);
+		cache.completeLoading(cache.lastLoadingHandle, true);
+		XTestCheck(a.readyCount == 1);
+
+		cache.removeReference(a.handle);
+	}
+
+	void TestLRUEviction()
+	{
+		TestCache cache;
+		cache.setMemoryBudget(ResourceByteSize * 2);
+
+		QueryContext contexts[3] = {};
+		for (uint32 i = 0; i < 3; i++)
+		{
+			contexts[i].cache = &cache;
+			cache.query(i + 1, 1.0f, &QueryCallback, &contexts[i]);
+			cache.completeLoading(cache.lastLoadingHandle, true);
+		}
+		XTestCheck(cache.getResidentByteSize() == ResourceByteSize * 3);
+
+		// Referenced resources are kept over budget. Released ones go in LRU order.
+		cache.removeReference(contexts[1].handle);
+		cache.removeReference(contexts[0].handle);
+		XTestCheck(cache.unloadCount == 1);
+		XTestCheck(!cache.isValidHandle(contexts[1].handle));
+		XTestCheck(cache.isValidHandle(contexts[0].handle));
+
+		// Touch moves resource to the end of LRU.
+		cache.removeReference(contexts[2].handle);
+		XTestCheck(cache.find(1, false) == contexts[0].handle);
+		cache.setMemoryBudget(ResourceByteSize);
+		XTestCheck(cache.isValidHandle(contexts[0].handle));
+		XTestCheck(!cache.isValidHandle(contexts[2].handle));
+		XTestCheck(cache.unloadCount == 2);
+	}
+
+	void TestReleaseFromReadyCallback()
+	{
+		// Queries are resolved in unspecified order, so both orders are run.
+		for (uint32 releasingQueryFirst = 0; releasingQueryFirst < 2; releasingQueryFirst++)
+		{
+			TestCache cache;
+			cache.setMemoryBudget(0);
+
+			QueryContext releasing = { &cache };
+			releasing.releaseOnReady = true;
+			QueryContext holding = { &cache };
+
+			QueryContext& first = releasingQueryFirst ? releasing : holding;
+			QueryContext& second = releasingQueryFirst ? holding : releasing;
+			cache.query(1, 1.0f, &QueryCallback, &first);
+			cache.query(1, 1.0f, &QueryCallback, &second);
+
+			cache.completeLoading(cache.lastLoadingHandle, true);
+			XTestCheck(releasing.readyCount == 1 && holding.readyCount == 1);
+			XTestCheck(cache.unloadCount == 0);
+			XTestCheck(cache.isValidHandle(holding.handle));
+			XTestCheck(cache.getResidentByteSize() == ResourceByteSize);
+
+			cache.removeReference(holding.handle);
+			XTestCheck(cache.unloadCount == 1);
+			XTestCheck(!cache.isValidHandle(holding.handle));
+			XTestCheck(cache.getResidentByteSize() == 0);
+		}
+	}
+
+	void TestCancelFromReadyCallback()
+	{
+		for (uint32 cancellingQueryFirst = 0; cancellingQueryFirst < 2; cancellingQueryFirst++)
+		{
+			TestCache cache;
+			cache.setMemoryBudget(0);
+
+			QueryContext cancelling = { &cache };
+			QueryContext cancelled = { &cache };
+
+			QueryResourceResult cancelledResult = {};
+			if (cancellingQueryFirst)
+			{
+				cache.query(1, 1.0f, &QueryCallback, &cancelling);
+				cancelledResult = cache.query(1, 1.0f, &QueryCallback, &cancelled);
+			}
+			else
+			{
+				cancelledResult = cache.query(1, 1.0f, &QueryCallback, &cancelled);
+				cache.query(1, 1.0f, &QueryCallback, &cancelling);
+			}
+			cancelling.queryToCancel = cancelledResult.pendingResourceQueryHandle;
+
+			cache.completeLoading(cache.lastLoadingHandle, true);
+			XTestCheck(cancelling.readyCount == 1);
+			XTestCheck(cancelled.readyCount <= 1);
+			XTestCheck(cache.cancelledLoadCount == 0);
+			XTestCheck(cache.unloadCount == 0);
+
+			cache.removeReference(cancelling.handle);
+			if (cancelled.readyCount)
+				cache.removeReference(cancelled.handle);
+			XTestCheck(cache.unloadCount == 1);
+		}
+	}
+}
+
+void XEngine::Tests::RunResourceCacheTests()
+{
+	TestSharedLoad();
+	TestFailedLoad();
+	TestLRUEviction();
+	TestReleaseFromReadyCallback();
+	TestCancelFromReadyCallback();
+}
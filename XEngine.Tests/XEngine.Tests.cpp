@@ -0,0 +1,71 @@
+#include <XLib.h>
+#include <XLib.Fmt.h>
+#include <XLib.String.h>
+
+#include "XEngine.Tests.h"
+
+using namespace XLib;
+using namespace XEngine::Tests;
+
+namespace
+{
+	struct TestGroup
+	{
+		const char* name;
+		void(*runFunc)();
+		bool isLong; // Run only when named in full.
+	};
+
+	const TestGroup TestGroups[] =
+	{
+		{ "Simulation.FixedPoint", &RunFixedPointTests },
+		{ "CRC", &RunCRCTests },
+		{ "Fmt", &RunFmtTests },
+		{ "Fmt.FP32Exhaustive", &RunFmtFP32ExhaustiveTests, true },
+		{ "JSON", &RunJSONTests },
+		{ "ResourceCache", &RunResourceCacheTests },
+	};
+
+	uint32 failureCount = 0;
+
+	bool IsGroupSelected(const TestGroup& group, int argc, char* argv[])
+	{
+		if (argc <= 1)
+			return !group.isLong;
+
+		const StringViewASCII groupName = StringViewASCII::FromCStr(group.name);
+		for (int i = 1; i < argc; i++)
+		{
+			const StringViewASCII arg = StringViewASCII::FromCStr(argv[i]);
+			if (group.isLong ? groupName == arg : groupName.startsWith(arg))
+				return true;
+		}
+		return false;
+	}
+}
+
+void XEngine::Tests::ReportFailure(const char* file, const uint32 line, const char* expression)
+{
+	FmtPrintStdOut(file, '(', line, "): check failed: ", expression, '\n');
+	failureCount++;
+}
+
+int main(int argc, char* argv[])
+{
+	for (const TestGroup& group : TestGroups)
+	{
+		if (!IsGroupSelected(group, argc, argv))
+			continue;
+
+		const uint32 groupBeginFailureCount = failureCount;
+		group.runFunc();
+
+		const uint32 groupFailureCount = failureCount - groupBeginFailureCount;
+		if (groupFailureCount)
+			FmtPrintStdOut(group.name, ": FAILED (", groupFailureCount, " checks)\n");
+		else
+			FmtPrintStdOut(group.name, ": OK\n");
+	}
+
+	return int(min<uint32>(failureCount, 255));
+}
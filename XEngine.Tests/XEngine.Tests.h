@@ -0,0 +1,46 @@
+#pragma once
+
+#include <XLib.h>
+
+// Tests are plain functions grouped by area, same as benchmarks. Failed checks are printed to stdout
+// as `<file>(<line>): check failed: <expression>` and test keeps running, so single run reports
+// every mismatch. Process exit code is number of failed checks, clamped to 255.
+//
+// Usage: XEngine.Tests [group name prefix ...]
+// With no arguments all groups are run, except long ones. Long groups are run only when named in full.
+
+#define XTestCheck(expression) \
+	do { if (!(expression)) XEngine::Tests::ReportFailure(__FILE__, __LINE__, #expression); } while (false)
+
+namespace XEngine::Tests
+{
+	void ReportFailure(const char* file, uint32 line, const char* expression);
+
+	// Deterministic pseudo-random sequence, so failures reproduce.
+	class Random
+	{
+	private:
+		uint64 state;
+
+	public:
+		inline explicit Random(uint64 seed) : state(seed) {}
+
+		inline uint64 next64()
+		{
+			// SplitMix64.
+			state += 0x9E3779B97F4A7C15ull;
+			uint64 z = state;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+		inline uint32 next32() { return uint32(next64() >> 32); }
+	};
+
+	void RunFixedPointTests();
+	void RunCRCTests();
+	void RunFmtTests();
+	void RunFmtFP32ExhaustiveTests();
+	void RunJSONTests();
+	void RunResourceCacheTests();
+}
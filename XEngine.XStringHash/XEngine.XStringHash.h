@@ -3,8 +3,45 @@
 #include <XLib.h>
 #include <XLib.String.h>
 
+#ifdef XENGINE_XSH_REGISTRY
+#include <XLib.Containers.ArrayList.h>
+#include <XLib.Containers.HashMap.h>
+#include <XLib.System.Threading.Lock.h>
+#endif
+
+// `XENGINE_XSH_REGISTRY` (defined in debug builds of projects that opt in, see `XEngine.ProjectDefaults.props`)
+// enables `XStringHashRegistry`: every string hashed at runtime is recorded, and different strings
+// with the same 64-bit hash are reported as collisions. Strings hashed during constant evaluation
+// (`_xsh` literals) are not recorded.
+
 namespace XEngine
 {
+#ifdef XENGINE_XSH_REGISTRY
+	class XStringHashRegistry abstract final
+	{
+	public:
+		struct Collision
+		{
+			uint64 hash;
+			XLib::DynamicStringASCII stringA;
+			XLib::DynamicStringASCII stringB;
+		};
+
+	private:
+		static inline XLib::Lock lock;
+		static inline XLib::FlatHashMap<uint64, XLib::DynamicStringASCII> strings;
+		static inline XLib::ArrayList<Collision> collisions;
+
+	public:
+		static inline void Record(XLib::StringViewASCII string, uint64 hash);
+		static inline void Reset();
+
+		// Should not be called concurrently with `Record`.
+		static inline uint32 GetCollisionCount() { return collisions.getSize(); }
+		static inline const Collision& GetCollision(uint32 index) { return collisions[index]; }
+	};
+#endif
+
 	// Just some variation of CRC64
 
 	class XStringHash abstract final
@@ -46,20 +83,42 @@ namespace XEngine
 			0xDCD7181E300F9E5E, 0x6FF954A033A8C131, 0x28532E49984F3E05, 0x9B7D62F79BE8616A, 0xA707DB9ACF80C06D, 0x14299724CC279F02, 0x5383EDCD67C06036, 0xE0ADA17364673F59,
 		};
 
-	public:
-		static constexpr uint64 Compute(const char* string, uint64 initialValue = 0, uintptr lengthLimit = uintptr(-1))
+		static constexpr uint64 GenerateSliceTable(uint32 sliceIndex, uint32 byteValue)
 		{
-			uint64 crc = initialValue;
+			uint64 crc = CRC64Table[byteValue];
+			for (uint32 i = 0; i < sliceIndex; i++)
+				crc = (crc >> 8) ^ CRC64Table[uint8(crc)];
+			return crc;
+		}
 
-			for (uintptr i = 0; i < lengthLimit; i++)
+		// `SliceBy8Tables[k][b]` is hash of byte `b` followed by `k` zero bytes.
+		struct SliceBy8TablesStorage
+		{
+			uint64 tables[8][256];
+
+			constexpr SliceBy8TablesStorage() : tables()
 			{
-				if (!string[i])
-					break;
-				crc = (crc >> 8) ^ CRC64Table[uint8(crc) ^ uint8(string[i])];
+				for (uint32 k = 0; k < 8; k++)
+				{
+					for (uint32 b = 0; b < 256; b++)
+						tables[k][b] = GenerateSliceTable(k, b);
+				}
 			}
+		};
 
-			return crc;
-		}
+		static const SliceBy8TablesStorage SliceBy8Tables;
+
+		static constexpr uint64 UpdateByte(uint64 crc, char c) { return (crc >> 8) ^ CRC64Table[uint8(crc) ^ uint8(c)]; }
+		static constexpr uint64 UpdateWord(uint64 crc, uint64 word);
+
+		static inline bool HasZeroByte(uint64 word) { return ((word - 0x0101'0101'0101'0101) & ~word & 0x8080'8080'8080'8080) != 0; }
+
+	public:
+		// Hashes chars until NUL or `lengthLimit`. Eight chars are processed at a time.
+		// At runtime NUL is searched by whole aligned 8-byte words, so up to 7 bytes past NUL (but not
+		// past `lengthLimit`) may be read. Aligned word never crosses page boundary, so this can not
+		// fault, but it is reported by address sanitizer. Sanitizer builds find NUL byte by byte first.
+		static constexpr uint64 Compute(const char* string, uint64 initialValue = 0, uintptr lengthLimit = uintptr(-1));
 
 		static constexpr uint64 Compute(const XLib::StringViewASCII string, uint64 initialValue = 0)
 		{
@@ -70,6 +129,106 @@ namespace XEngine
 	using XSH = XStringHash;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef XENGINE_XSH_REGISTRY
+
+inline void XEngine::XStringHashRegistry::Record(XLib::StringViewASCII string, uint64 hash)
+{
+	lock.lock();
+
+	bool inserted = false;
+	XLib::DynamicStringASCII& registeredString = strings.findOrInsert(hash, &inserted);
+	if (inserted)
+		registeredString.append(string);
+	else if (!XLib::String::IsEqual(registeredString.getView(), string))
+	{
+		Collision& collision = collisions.emplaceBack();
+		collision.hash = hash;
+		collision.stringA.append(registeredString.getView());
+		collision.stringB.append(string);
+	}
+
+	lock.unlock();
+}
+
+inline void XEngine::XStringHashRegistry::Reset()
+{
+	lock.lock();
+	strings.clear();
+	collisions.clear();
+	lock.unlock();
+}
+
+#endif
+
+inline constexpr XEngine::XStringHash::SliceBy8TablesStorage XEngine::XStringHash::SliceBy8Tables = {};
+
+constexpr uint64 XEngine::XStringHash::UpdateWord(uint64 crc, uint64 word)
+{
+	const uint64 (&t)[8][256] = SliceBy8Tables.tables;
+	const uint64 x = crc ^ word;
+	return
+		t[7][uint8(x >>  0)] ^ t[6][uint8(x >>  8)] ^ t[5][uint8(x >> 16)] ^ t[4][uint8(x >> 24)] ^
+		t[3][uint8(x >> 32)] ^ t[2][uint8(x >> 40)] ^ t[1][uint8(x >> 48)] ^ t[0][uint8(x >> 56)];
+}
+
+constexpr uint64 XEngine::XStringHash::Compute(const char* string, uint64 initialValue, uintptr lengthLimit)
+{
+	uint64 crc = initialValue;
+	uintptr i = 0;
+
+	if (__builtin_is_constant_evaluated())
+	{
+		// Chars after NUL can not be read during constant evaluation.
+		for (; lengthLimit - i >= 8; i += 8)
+		{
+			uint64 word = 0;
+			uint32 j = 0;
+			for (; j < 8 && string[i + j]; j++)
+				word |= uint64(uint8(string[i + j])) << (j * 8);
+			if (j < 8)
+				break;
+			crc = UpdateWord(crc, word);
+		}
+	}
+	else
+	{
+#ifdef __SANITIZE_ADDRESS__
+		uintptr length = 0;
+		while (length < lengthLimit && string[length])
+			length++;
+		lengthLimit = length;
+#endif
+
+		for (; i < lengthLimit && (uintptr(string + i) & 7) != 0 && string[i]; i++)
+			crc = UpdateByte(crc, string[i]);
+
+		if ((uintptr(string + i) & 7) == 0)
+		{
+			for (; lengthLimit - i >= 8; i += 8)
+			{
+				const uint64 word = *(const uint64*)(string + i);
+				if (HasZeroByte(word))
+					break;
+				crc = UpdateWord(crc, word);
+			}
+		}
+	}
+
+	for (; i < lengthLimit && string[i]; i++)
+		crc = UpdateByte(crc, string[i]);
+
+#ifdef XENGINE_XSH_REGISTRY
+	if (!__builtin_is_constant_evaluated() && initialValue == 0)
+		XStringHashRegistry::Record(XLib::StringViewASCII(string, i), crc);
+#endif
+
+	return crc;
+}
+
 consteval uint64 operator ""_xsh(const char* string, uintptr length)
 {
 	return XEngine::XStringHash::Compute(string, 0, length);
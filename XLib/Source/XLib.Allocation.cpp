@@ -1,6 +1,8 @@
 #include <Windows.h>
 
 #include "XLib.Allocation.h"
+#include "XLib.System.Threading.Atomics.h"
+#include "XLib.System.VirtualMemory.h"
 
 using namespace XLib;
 
@@ -41,3 +43,498 @@ bool SystemHeapAllocator::TryReallocateInplace(void* ptr, uintptr size)
 	XAssert(size);
 	return HeapReAlloc(GetProcessHeap(), HEAP_REALLOC_IN_PLACE_ONLY, ptr, size) != nullptr;
 }
+
+
+// DefaultAllocator ////////////////////////////////////////////////////////////////////////////////
+
+// System heap guarantees 16 byte alignment on x64.
+static constexpr uint32 SystemHeapAlignment = 16;
+
+namespace
+{
+	// Placed right before every bootstrap arena allocation. Keeps 16 byte alignment.
+	struct BootstrapArenaBlockHeader
+	{
+		uint64 size;
+		uint64 _padding;
+	};
+	static_assert(sizeof(BootstrapArenaBlockHeader) == 16);
+
+	inline BootstrapArenaBlockHeader* GetBootstrapArenaBlockHeader(void* ptr) { return (BootstrapArenaBlockHeader*)ptr - 1; }
+}
+
+void* DefaultAllocator::BootstrapArenaAllocate(const uintptr size, const uint32 alignment)
+{
+	XAssert(alignment <= BootstrapArenaAlignment);
+
+	const uint64 blockSize = sizeof(BootstrapArenaBlockHeader) + alignUp<uint64>(size, BootstrapArenaAlignment);
+
+	uint64 offset = bootstrapArenaUsedSize;
+	for (;;)
+	{
+		if (offset + blockSize > BootstrapArenaSize)
+			return nullptr;
+		if (Atomics::CompareExchange<uint64>(bootstrapArenaUsedSize, offset, offset + blockSize))
+			break;
+		offset = bootstrapArenaUsedSize;
+	}
+
+	BootstrapArenaBlockHeader* header = (BootstrapArenaBlockHeader*)(bootstrapArena + offset);
+	header->size = size;
+	return header + 1;
+}
+
+void DefaultAllocator::BootstrapArenaRelease(void* ptr)
+{
+	// Only the last block is given back. Bootstrap allocations are mostly made during static
+	// initialization and live until exit, so anything else is not worth tracking.
+	const BootstrapArenaBlockHeader* header = GetBootstrapArenaBlockHeader(ptr);
+	const uint64 offset = uint64((byte*)header - bootstrapArena);
+	const uint64 blockSize = sizeof(BootstrapArenaBlockHeader) + alignUp<uint64>(header->size, BootstrapArenaAlignment);
+	Atomics::CompareExchange<uint64>(bootstrapArenaUsedSize, offset + blockSize, offset);
+}
+
+bool DefaultAllocator::BootstrapArenaTryReallocateInplace(void* ptr, const uintptr newSize)
+{
+	XAssert(newSize);
+
+	BootstrapArenaBlockHeader* header = GetBootstrapArenaBlockHeader(ptr);
+	const uint64 offset = uint64((byte*)header - bootstrapArena);
+	const uint64 oldBlockSize = sizeof(BootstrapArenaBlockHeader) + alignUp<uint64>(header->size, BootstrapArenaAlignment);
+	const uint64 newBlockSize = sizeof(BootstrapArenaBlockHeader) + alignUp<uint64>(newSize, BootstrapArenaAlignment);
+
+	if (newBlockSize > oldBlockSize)
+	{
+		// Last block can grow into free part of arena.
+		if (offset + newBlockSize > BootstrapArenaSize)
+			return false;
+		if (!Atomics::CompareExchange<uint64>(bootstrapArenaUsedSize, offset + oldBlockSize, offset + newBlockSize))
+			return false;
+	}
+
+	header->size = newSize;
+	return true;
+}
+
+void* DefaultAllocator::BootstrapArenaReallocate(void* ptr, const uintptr newSize, const uint32 newAlignment)
+{
+	if (!newSize)
+	{
+		BootstrapArenaRelease(ptr);
+		return nullptr;
+	}
+
+	if (newAlignment <= BootstrapArenaAlignment && BootstrapArenaTryReallocateInplace(ptr, newSize))
+		return ptr;
+
+	// Memory moves to whatever allocator is current. After override it leaves the arena for good.
+	void* newPtr = allocateRoutine(newSize, newAlignment);
+	if (!newPtr)
+		return nullptr;
+
+	memoryCopy(newPtr, ptr, min<uintptr>(GetBootstrapArenaBlockHeader(ptr)->size, newSize));
+	BootstrapArenaRelease(ptr);
+	return newPtr;
+}
+
+void* DefaultAllocator::BootstrapAllocate(const uintptr size, const uint32 alignment)
+{
+	if (!size)
+		return nullptr;
+
+	if (void* ptr = BootstrapArenaAllocate(size, alignment))
+		return ptr;
+
+	XAssert(alignment <= SystemHeapAlignment);
+	wasSystemHeapUsedBeforeOverride = true;
+	return SystemHeapAllocator::Allocate(size);
+}
+
+void* DefaultAllocator::BootstrapReallocate(void* ptr, const uintptr newSize, const uint32 newAlignment)
+{
+	// Arena pointers are handled by `DefaultAllocator::Reallocate`, so non-null pointer came from system heap.
+	if (!ptr)
+		return BootstrapAllocate(newSize, newAlignment);
+
+	XAssert(newAlignment <= SystemHeapAlignment);
+	return SystemHeapAllocator::Reallocate(ptr, newSize);
+}
+
+alignas(DefaultAllocator::BootstrapArenaAlignment) byte DefaultAllocator::bootstrapArena[DefaultAllocator::BootstrapArenaSize];
+volatile uint64 DefaultAllocator::bootstrapArenaUsedSize = 0;
+bool DefaultAllocator::wasSystemHeapUsedBeforeOverride = false;
+
+DefaultAllocator::AllocateRoutine DefaultAllocator::allocateRoutine = &DefaultAllocator::BootstrapAllocate;
+DefaultAllocator::ReleaseRoutine DefaultAllocator::releaseRoutine = &SystemHeapAllocator::Release;
+DefaultAllocator::ReallocateRoutine DefaultAllocator::reallocateRoutine = &DefaultAllocator::BootstrapReallocate;
+DefaultAllocator::TryReallocateInplaceRoutine DefaultAllocator::tryReallocateInplaceRoutine = &SystemHeapAllocator::TryReallocateInplace;
+
+
+// FixedBlockLinearAllocator ///////////////////////////////////////////////////////////////////////
+
+void FixedBlockLinearAllocator::initialize(void* block, uintptr blockSize)
+{
+	this->block = (byte*)block;
+	this->blockSize = blockSize;
+	allocatedSize = 0;
+	lastAllocationOffset = uintptr(-1);
+}
+
+void* FixedBlockLinearAllocator::reallocate(void* ptr, uintptr size)
+{
+	if (!ptr)
+		return allocate(size);
+	if (!size)
+	{
+		release(ptr);
+		return nullptr;
+	}
+	if (tryReallocateInplace(ptr, size))
+		return ptr;
+
+	const uintptr offset = uintptr((byte*)ptr - block);
+	XAssert(offset < allocatedSize);
+	const uintptr sizeToCopy = min<uintptr>(size, allocatedSize - offset);
+
+	void* result = allocate(size);
+	if (result)
+		memoryCopy(result, ptr, sizeToCopy);
+	return result;
+}
+
+bool FixedBlockLinearAllocator::tryReallocateInplace(void* ptr, uintptr size)
+{
+	XAssert(ptr);
+	const uintptr offset = uintptr((byte*)ptr - block);
+	if (offset != lastAllocationOffset || offset + size > blockSize)
+		return false;
+
+	allocatedSize = offset + size;
+	return true;
+}
+
+void FixedBlockLinearAllocator::release(void* ptr)
+{
+	XAssert(ptr);
+	const uintptr offset = uintptr((byte*)ptr - block);
+	XAssert(offset < blockSize);
+	if (offset == lastAllocationOffset)
+	{
+		allocatedSize = offset;
+		lastAllocationOffset = uintptr(-1);
+	}
+}
+
+void FixedBlockLinearAllocator::reset()
+{
+	allocatedSize = 0;
+	lastAllocationOffset = uintptr(-1);
+}
+
+
+// MultiBlockLinearAllocator ///////////////////////////////////////////////////////////////////////
+
+struct MultiBlockLinearAllocator::BlockHeader
+{
+	BlockHeader* prev;
+	uintptr size; // Including header.
+};
+
+static constexpr uintptr MultiBlockLinearAllocatorBlockHeaderSize = 16;
+
+void* MultiBlockLinearAllocator::allocateSlowPath(uintptr size, uint32 alignment)
+{
+	static_assert(sizeof(BlockHeader) <= MultiBlockLinearAllocatorBlockHeaderSize);
+
+	const uintptr effectiveAlignment = alignment ? alignment : DefaultAlignment;
+	const uintptr requiredBlockSize = MultiBlockLinearAllocatorBlockHeaderSize + size + effectiveAlignment;
+
+	// Large allocations get dedicated block that is linked behind current one, so current block space is not wasted.
+	const bool useDedicatedBlock = currentBlock && requiredBlockSize > minBlockSize / 4;
+	const uintptr blockSize = useDedicatedBlock ? requiredBlockSize : max<uintptr>(minBlockSize, requiredBlockSize);
+
+	BlockHeader* block = (BlockHeader*)SystemHeapAllocator::Allocate(blockSize);
+	XAssert(block);
+	block->size = blockSize;
+
+	byte* blockDataBegin = (byte*)block + MultiBlockLinearAllocatorBlockHeaderSize;
+	byte* result = (byte*)alignUp<uintptr>(uintptr(blockDataBegin), effectiveAlignment);
+
+	if (useDedicatedBlock)
+	{
+		block->prev = currentBlock->prev;
+		currentBlock->prev = block;
+		return result;
+	}
+
+	block->prev = currentBlock;
+	currentBlock = block;
+	currentBlockEnd = (byte*)block + blockSize;
+	current = result + size;
+	lastAllocation = result;
+	return result;
+}
+
+auto MultiBlockLinearAllocator::findBlock(const void* ptr) const -> const BlockHeader*
+{
+	for (const BlockHeader* block = currentBlock; block; block = block->prev)
+	{
+		if (uintptr(ptr) >= uintptr(block) && uintptr(ptr) < uintptr(block) + block->size)
+			return block;
+	}
+	return nullptr;
+}
+
+void MultiBlockLinearAllocator::destroy()
+{
+	BlockHeader* block = currentBlock;
+	while (block)
+	{
+		BlockHeader* prevBlock = block->prev;
+		SystemHeapAllocator::Release(block);
+		block = prevBlock;
+	}
+
+	currentBlock = nullptr;
+	current = nullptr;
+	currentBlockEnd = nullptr;
+	lastAllocation = nullptr;
+}
+
+void* MultiBlockLinearAllocator::reallocate(void* ptr, uintptr size)
+{
+	if (!ptr)
+		return allocate(size);
+	if (!size)
+	{
+		release(ptr);
+		return nullptr;
+	}
+	if (tryReallocateInplace(ptr, size))
+		return ptr;
+
+	const BlockHeader* block = findBlock(ptr);
+	XAssert(block);
+	const byte* blockUsedEnd = block == currentBlock ? current : (const byte*)block + block->size;
+	const uintptr sizeToCopy = min<uintptr>(size, uintptr(blockUsedEnd - (const byte*)ptr));
+
+	void* result = allocate(size);
+	memoryCopy(result, ptr, sizeToCopy);
+	return result;
+}
+
+bool MultiBlockLinearAllocator::tryReallocateInplace(void* ptr, uintptr size)
+{
+	XAssert(ptr);
+	if (ptr != lastAllocation || (byte*)ptr + size > currentBlockEnd)
+		return false;
+
+	current = (byte*)ptr + size;
+	return true;
+}
+
+void MultiBlockLinearAllocator::release(void* ptr)
+{
+	XAssert(ptr);
+	if (ptr == lastAllocation)
+	{
+		current = lastAllocation;
+		lastAllocation = nullptr;
+	}
+}
+
+void MultiBlockLinearAllocator::reset()
+{
+	if (!currentBlock)
+		return;
+
+	BlockHeader* block = currentBlock->prev;
+	while (block)
+	{
+		BlockHeader* prevBlock = block->prev;
+		SystemHeapAllocator::Release(block);
+		block = prevBlock;
+	}
+
+	currentBlock->prev = nullptr;
+	current = (byte*)currentBlock + MultiBlockLinearAllocatorBlockHeaderSize;
+	lastAllocation = nullptr;
+}
+
+
+// MultiBlockPoolAllocator /////////////////////////////////////////////////////////////////////////
+
+struct MultiBlockPoolAllocator::BlockHeader
+{
+	BlockHeader* prev;
+};
+
+static constexpr uintptr MultiBlockPoolAllocatorBlockHeaderSize = 16;
+
+void MultiBlockPoolAllocator::initialize(uint32 elementSize, uint32 elementsPerBlock)
+{
+	XAssert(!currentBlock);
+	XAssert(elementSize > 0 && elementsPerBlock > 0);
+
+	const uint32 elementAlignment = elementSize >= 16 ? 16 : sizeof(FreeElement);
+	this->elementSize = alignUp<uint32>(max<uint32>(elementSize, sizeof(FreeElement)), elementAlignment);
+	this->elementsPerBlock = elementsPerBlock;
+}
+
+void* MultiBlockPoolAllocator::allocateSlowPath()
+{
+	static_assert(sizeof(BlockHeader) <= MultiBlockPoolAllocatorBlockHeaderSize);
+	XAssert(elementSize > 0);
+
+	const uintptr blockSize = MultiBlockPoolAllocatorBlockHeaderSize + uintptr(elementSize) * elementsPerBlock;
+	BlockHeader* block = (BlockHeader*)SystemHeapAllocator::Allocate(blockSize);
+	XAssert(block);
+	block->prev = currentBlock;
+
+	currentBlock = block;
+	current = (byte*)block + MultiBlockPoolAllocatorBlockHeaderSize;
+	currentBlockEnd = (byte*)block + blockSize;
+
+	void* result = current;
+	current += elementSize;
+	return result;
+}
+
+void MultiBlockPoolAllocator::destroy()
+{
+	BlockHeader* block = currentBlock;
+	while (block)
+	{
+		BlockHeader* prevBlock = block->prev;
+		SystemHeapAllocator::Release(block);
+		block = prevBlock;
+	}
+
+	currentBlock = nullptr;
+	freeListHead = nullptr;
+	current = nullptr;
+	currentBlockEnd = nullptr;
+}
+
+void* MultiBlockPoolAllocator::reallocate(void* ptr, uintptr size)
+{
+	if (!ptr)
+		return allocate(size);
+	if (!size)
+	{
+		release(ptr);
+		return nullptr;
+	}
+
+	XAssert(size <= elementSize);
+	return ptr;
+}
+
+bool MultiBlockPoolAllocator::tryReallocateInplace(void* ptr, uintptr size)
+{
+	XAssert(ptr);
+	return size <= elementSize;
+}
+
+
+// VirtualMemoryBlockLinearAllocator ///////////////////////////////////////////////////////////////
+
+bool VirtualMemoryBlockLinearAllocator::commitUpTo(uintptr requiredCommittedSize)
+{
+	XAssert(block);
+	if (requiredCommittedSize > reservedSize)
+	{
+		XAssertUnreachableCode(); // Reserved range exhausted.
+		return false;
+	}
+
+	const uintptr newCommittedSize = min<uintptr>(alignUp<uintptr>(requiredCommittedSize, CommitGranularity), reservedSize);
+	if (!VirtualMemory::Commit(block + committedSize, newCommittedSize - committedSize))
+		return false;
+
+	committedSize = newCommittedSize;
+	return true;
+}
+
+void VirtualMemoryBlockLinearAllocator::initialize(uintptr reservedSize)
+{
+	XAssert(!block);
+	this->reservedSize = alignUp<uintptr>(reservedSize, CommitGranularity);
+	block = (byte*)VirtualMemory::Reserve(this->reservedSize);
+	XAssert(block);
+}
+
+void VirtualMemoryBlockLinearAllocator::destroy()
+{
+	if (block)
+		VirtualMemory::Release(block, reservedSize);
+
+	block = nullptr;
+	reservedSize = 0;
+	committedSize = 0;
+	allocatedSize = 0;
+	lastAllocationOffset = uintptr(-1);
+}
+
+void* VirtualMemoryBlockLinearAllocator::reallocate(void* ptr, uintptr size)
+{
+	if (!ptr)
+		return allocate(size);
+	if (!size)
+	{
+		release(ptr);
+		return nullptr;
+	}
+	if (tryReallocateInplace(ptr, size))
+		return ptr;
+
+	const uintptr offset = uintptr((byte*)ptr - block);
+	XAssert(offset < allocatedSize);
+	const uintptr sizeToCopy = min<uintptr>(size, allocatedSize - offset);
+
+	void* result = allocate(size);
+	if (result)
+		memoryCopy(result, ptr, sizeToCopy);
+	return result;
+}
+
+bool VirtualMemoryBlockLinearAllocator::tryReallocateInplace(void* ptr, uintptr size)
+{
+	XAssert(ptr);
+	const uintptr offset = uintptr((byte*)ptr - block);
+	if (offset != lastAllocationOffset)
+		return false;
+
+	if (offset + size > committedSize)
+	{
+		if (!commitUpTo(offset + size))
+			return false;
+	}
+
+	allocatedSize = offset + size;
+	return true;
+}
+
+void VirtualMemoryBlockLinearAllocator::release(void* ptr)
+{
+	XAssert(ptr);
+	const uintptr offset = uintptr((byte*)ptr - block);
+	XAssert(offset < reservedSize);
+	if (offset == lastAllocationOffset)
+	{
+		allocatedSize = offset;
+		lastAllocationOffset = uintptr(-1);
+	}
+}
+
+void VirtualMemoryBlockLinearAllocator::reset(bool decommit)
+{
+	allocatedSize = 0;
+	lastAllocationOffset = uintptr(-1);
+
+	if (decommit && committedSize)
+	{
+		VirtualMemory::Decommit(block, committedSize);
+		committedSize = 0;
+	}
+}
@@ -20,6 +20,8 @@ namespace XLib
 		AllocatorAdapterBase() = default;
 		~AllocatorAdapterBase() = default;
 
+		void inheritAllocator(const AllocatorAdapterBase& that) {}
+
 		void* allocate(uintptr size) { return AllocatorType::Allocate(size); }
 		void* reallocate(void* ptr, uintptr size) { return AllocatorType::Reallocate(ptr, size); }
 		bool tryReallocateInplace(void* ptr, uintptr size) { return AllocatorType::TryReallocateInplace(ptr, size); }
@@ -34,14 +36,32 @@ namespace XLib
 
 	protected:
 		AllocatorAdapterBase() = default;
+		AllocatorAdapterBase(AllocatorType& allocator) : allocatorInstance(&allocator) {}
 		~AllocatorAdapterBase() = default;
 
-		void* allocate(uintptr size) { return allocatorInstance->allocate(size); }
-		void* reallocate(void* ptr, uintptr size) { return allocatorInstance->reallocate(ptr, size); }
-		bool tryReallocateInplace(void* ptr, uintptr size) { return allocatorInstance->tryReallocateInplace(ptr, size); }
-		void release(void* ptr) { allocatorInstance->release(ptr); }
+		void inheritAllocator(const AllocatorAdapterBase& that) { allocatorInstance = that.allocatorInstance; }
+
+		void* allocate(uintptr size) { XAssert(allocatorInstance); return allocatorInstance->allocate(size); }
+		void* reallocate(void* ptr, uintptr size) { XAssert(allocatorInstance); return allocatorInstance->reallocate(ptr, size); }
+		bool tryReallocateInplace(void* ptr, uintptr size) { XAssert(allocatorInstance); return allocatorInstance->tryReallocateInplace(ptr, size); }
+		void release(void* ptr) { XAssert(allocatorInstance); allocatorInstance->release(ptr); }
 	};
 
+	// Non-static allocator template:
+	//
+	//	class MyAllocator
+	//	{
+	//	public:
+	//		static constexpr bool IsStatic = false;
+	//
+	//		void* allocate(uintptr size);
+	//		void* reallocate(void* ptr, uintptr size);
+	//		bool tryReallocateInplace(void* ptr, uintptr size);
+	//		void release(void* ptr);
+	//	};
+	//
+	// Containers that use non-static allocator take allocator reference in constructor.
+
 
 	////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -58,16 +78,57 @@ namespace XLib
 	// VirtualMemoryBlockPoolAllocator
 
 	// TODO: DefaultHeapAllocator
+	// Default allocator of all containers and dynamic strings.
+	// Routes through overridable function table. Defaults to system heap.
+	//
+	// Until overridden, allocations are served by bootstrap arena: static region with lock-free bump
+	// allocation, so static initialization and early startup can allocate before override and do not
+	// take system heap lock. Arena memory is recognized by address and is always released and
+	// reallocated here, never through overriding allocator. Only when arena is exhausted before
+	// override, system heap is used.
 	class DefaultAllocator abstract final
 	{
+	private:
+		static constexpr uintptr BootstrapArenaSize = 1024 * 1024;
+		static constexpr uint32 BootstrapArenaAlignment = 16;
+
+		using AllocateRoutine = void* (*)(uintptr size, uint32 alignment);
+		using ReleaseRoutine = void (*)(void* ptr);
+		using ReallocateRoutine = void* (*)(void* ptr, uintptr newSize, uint32 newAlignment);
+		using TryReallocateInplaceRoutine = bool (*)(void* ptr, uintptr newSize);
+
+		static AllocateRoutine allocateRoutine;
+		static ReleaseRoutine releaseRoutine;
+		static ReallocateRoutine reallocateRoutine;
+		static TryReallocateInplaceRoutine tryReallocateInplaceRoutine;
+
+		alignas(BootstrapArenaAlignment) static byte bootstrapArena[BootstrapArenaSize];
+		static volatile uint64 bootstrapArenaUsedSize;
+
+		// Set when bootstrap arena is exhausted. System heap memory can not be released through overriding allocator.
+		static bool wasSystemHeapUsedBeforeOverride;
+
+		static inline bool IsBootstrapArenaPtr(const void* ptr) { return uintptr(ptr) - uintptr(bootstrapArena) < BootstrapArenaSize; }
+
+		static void* BootstrapArenaAllocate(uintptr size, uint32 alignment);
+		static void BootstrapArenaRelease(void* ptr);
+		static void* BootstrapArenaReallocate(void* ptr, uintptr newSize, uint32 newAlignment);
+		static bool BootstrapArenaTryReallocateInplace(void* ptr, uintptr newSize);
+
+		static void* BootstrapAllocate(uintptr size, uint32 alignment);
+		static void* BootstrapReallocate(void* ptr, uintptr newSize, uint32 newAlignment);
+
 	public:
-		static void* Allocate(uintptr size, uint32 alignment = 0);
-		static void Release(void* ptr);
-		static void* Reallocate(void* ptr, uintptr newSize, uint32 newAlignment = 0);
-		static bool TryReallocateInplace(void* ptr, uintptr newSize);
+		static constexpr bool IsStatic = true;
+
+		static inline void* Allocate(uintptr size, uint32 alignment = 0) { return allocateRoutine(size, alignment); }
+		static inline void Release(void* ptr);
+		static inline void* Reallocate(void* ptr, uintptr newSize, uint32 newAlignment = 0);
+		static inline bool TryReallocateInplace(void* ptr, uintptr newSize);
 
+		// Allocations made before override stay valid and can be released through `DefaultAllocator` as usual.
 		template <typename AllocatorType>
-		static void Override();
+		static inline void Override();
 	};
 
 	struct SystemHeapAllocator abstract final
@@ -86,23 +147,255 @@ namespace XLib
 
 	};
 
+	// Linear allocators do not track individual allocations. `release` only rolls back the most recent allocation.
+	// `reallocate` grows most recent allocation inplace. Otherwise it allocates new memory and copies
+	// everything up to the end of used space (allocators do not know actual allocation sizes).
+
 	class FixedBlockLinearAllocator : public XLib::NonCopyable
 	{
 	private:
+		byte* block = nullptr;
+		uintptr blockSize = 0;
+		uintptr allocatedSize = 0;
+		uintptr lastAllocationOffset = uintptr(-1);
+
+	public:
+		static constexpr bool IsStatic = false;
+		static constexpr uint32 DefaultAlignment = 16;
+
+	public:
 		FixedBlockLinearAllocator() = default;
+		inline FixedBlockLinearAllocator(void* block, uintptr blockSize) { initialize(block, blockSize); }
 		~FixedBlockLinearAllocator() = default;
 
-		void* allocate(uintptr size, uint32 alignment = 0);
+		void initialize(void* block, uintptr blockSize);
+
+		inline void* allocate(uintptr size, uint32 alignment = 0);
+		void* reallocate(void* ptr, uintptr size);
+		bool tryReallocateInplace(void* ptr, uintptr size);
+		void release(void* ptr);
 		void reset();
+
+		inline void* getBlock() const { return block; }
+		inline uintptr getBlockSize() const { return blockSize; }
+		inline uintptr getAllocatedSize() const { return allocatedSize; }
 	};
 
+	// AKA ArenaAllocator. Blocks are allocated from system heap.
 	class MultiBlockLinearAllocator : public XLib::NonCopyable
 	{
 	private:
+		struct BlockHeader;
+
+		static constexpr uintptr DefaultMinBlockSize = 0x10000;
+
+	private:
+		BlockHeader* currentBlock = nullptr;
+		byte* current = nullptr;
+		byte* currentBlockEnd = nullptr;
+		byte* lastAllocation = nullptr;
+		uintptr minBlockSize = DefaultMinBlockSize;
+
+	private:
+		void* allocateSlowPath(uintptr size, uint32 alignment);
+		const BlockHeader* findBlock(const void* ptr) const;
+
+	public:
+		static constexpr bool IsStatic = false;
+		static constexpr uint32 DefaultAlignment = 16;
+
+	public:
 		MultiBlockLinearAllocator() = default;
-		~MultiBlockLinearAllocator() = default;
+		inline MultiBlockLinearAllocator(uintptr minBlockSize) : minBlockSize(minBlockSize) {}
+		inline ~MultiBlockLinearAllocator() { destroy(); }
+
+		void destroy();
+
+		inline void* allocate(uintptr size, uint32 alignment = 0);
+		void* reallocate(void* ptr, uintptr size);
+		bool tryReallocateInplace(void* ptr, uintptr size);
+		void release(void* ptr);
 
-		void* allocate(uintptr size, uint32 alignment = 0);
+		// Keeps most recent block, releases others.
 		void reset();
 	};
+
+	// Fixed size elements. Blocks are allocated from system heap and are never released until `destroy`.
+	class MultiBlockPoolAllocator : public XLib::NonCopyable
+	{
+	private:
+		struct BlockHeader;
+		struct FreeElement { FreeElement* next; };
+
+	private:
+		BlockHeader* currentBlock = nullptr;
+		FreeElement* freeListHead = nullptr;
+		byte* current = nullptr;
+		byte* currentBlockEnd = nullptr;
+		uint32 elementSize = 0;
+		uint32 elementsPerBlock = 0;
+
+	private:
+		void* allocateSlowPath();
+
+	public:
+		static constexpr bool IsStatic = false;
+
+	public:
+		MultiBlockPoolAllocator() = default;
+		inline MultiBlockPoolAllocator(uint32 elementSize, uint32 elementsPerBlock) { initialize(elementSize, elementsPerBlock); }
+		inline ~MultiBlockPoolAllocator() { destroy(); }
+
+		void initialize(uint32 elementSize, uint32 elementsPerBlock);
+		void destroy();
+
+		inline void* allocate(uintptr size = 0);
+		void* reallocate(void* ptr, uintptr size);
+		bool tryReallocateInplace(void* ptr, uintptr size);
+		inline void release(void* ptr);
+
+		inline uint32 getElementSize() const { return elementSize; }
+	};
+
+	// Reserves address space range up front and commits pages as allocation pointer advances.
+	// Allocations never move, so `reallocate` of most recent allocation is always inplace while reservation lasts.
+	class VirtualMemoryBlockLinearAllocator : public XLib::NonCopyable
+	{
+	private:
+		static constexpr uintptr CommitGranularity = 0x10000;
+
+	private:
+		byte* block = nullptr;
+		uintptr reservedSize = 0;
+		uintptr committedSize = 0;
+		uintptr allocatedSize = 0;
+		uintptr lastAllocationOffset = uintptr(-1);
+
+	private:
+		bool commitUpTo(uintptr requiredCommittedSize);
+
+	public:
+		static constexpr bool IsStatic = false;
+		static constexpr uint32 DefaultAlignment = 16;
+
+	public:
+		VirtualMemoryBlockLinearAllocator() = default;
+		inline ~VirtualMemoryBlockLinearAllocator() { destroy(); }
+
+		void initialize(uintptr reservedSize);
+		void destroy();
+
+		inline void* allocate(uintptr size, uint32 alignment = 0);
+		void* reallocate(void* ptr, uintptr size);
+		bool tryReallocateInplace(void* ptr, uintptr size);
+		void release(void* ptr);
+
+		void reset(bool decommit = false);
+
+		inline uintptr getAllocatedSize() const { return allocatedSize; }
+		inline uintptr getCommittedSize() const { return committedSize; }
+	};
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+
+namespace XLib
+{
+	inline void DefaultAllocator::Release(void* ptr)
+	{
+		if (IsBootstrapArenaPtr(ptr))
+			BootstrapArenaRelease(ptr);
+		else
+			releaseRoutine(ptr);
+	}
+
+	inline void* DefaultAllocator::Reallocate(void* ptr, uintptr newSize, uint32 newAlignment)
+	{
+		if (IsBootstrapArenaPtr(ptr))
+			return BootstrapArenaReallocate(ptr, newSize, newAlignment);
+		return reallocateRoutine(ptr, newSize, newAlignment);
+	}
+
+	inline bool DefaultAllocator::TryReallocateInplace(void* ptr, uintptr newSize)
+	{
+		if (IsBootstrapArenaPtr(ptr))
+			return BootstrapArenaTryReallocateInplace(ptr, newSize);
+		return tryReallocateInplaceRoutine(ptr, newSize);
+	}
+
+	template <typename AllocatorType>
+	inline void DefaultAllocator::Override()
+	{
+		// Bootstrap arena was exhausted before override and system heap memory is live. Increase `BootstrapArenaSize`.
+		XAssert(!wasSystemHeapUsedBeforeOverride);
+		allocateRoutine = &AllocatorType::Allocate;
+		releaseRoutine = &AllocatorType::Release;
+		reallocateRoutine = &AllocatorType::Reallocate;
+		tryReallocateInplaceRoutine = &AllocatorType::TryReallocateInplace;
+	}
+
+	inline void* FixedBlockLinearAllocator::allocate(const uintptr size, const uint32 alignment)
+	{
+		const uintptr offset = alignUp<uintptr>(allocatedSize, alignment ? alignment : DefaultAlignment);
+		if (offset + size > blockSize)
+			return nullptr; // Out of memory. Caller decides if this is fatal.
+
+		allocatedSize = offset + size;
+		lastAllocationOffset = offset;
+		return block + offset;
+	}
+
+	inline void* MultiBlockLinearAllocator::allocate(const uintptr size, const uint32 alignment)
+	{
+		byte* result = (byte*)alignUp<uintptr>(uintptr(current), alignment ? alignment : DefaultAlignment);
+		if (!current || result + size > currentBlockEnd)
+			return allocateSlowPath(size, alignment);
+
+		current = result + size;
+		lastAllocation = result;
+		return result;
+	}
+
+	inline void* MultiBlockPoolAllocator::allocate(const uintptr size)
+	{
+		XAssert(size <= elementSize);
+
+		if (freeListHead)
+		{
+			FreeElement* result = freeListHead;
+			freeListHead = result->next;
+			return result;
+		}
+
+		if (!current || current + elementSize > currentBlockEnd)
+			return allocateSlowPath();
+
+		void* result = current;
+		current += elementSize;
+		return result;
+	}
+
+	inline void MultiBlockPoolAllocator::release(void* ptr)
+	{
+		XAssert(ptr);
+		FreeElement* element = (FreeElement*)ptr;
+		element->next = freeListHead;
+		freeListHead = element;
+	}
+
+	inline void* VirtualMemoryBlockLinearAllocator::allocate(const uintptr size, const uint32 alignment)
+	{
+		const uintptr offset = alignUp<uintptr>(allocatedSize, alignment ? alignment : DefaultAlignment);
+		if (offset + size > committedSize)
+		{
+			if (!commitUpTo(offset + size))
+				return nullptr;
+		}
+
+		allocatedSize = offset + size;
+		lastAllocationOffset = offset;
+		return block + offset;
+	}
+}
\ No newline at end of file
@@ -1,151 +1,83 @@
+#include <intrin.h>
+#include <immintrin.h>
+
 #include "XLib.CRC.h"
+#include "XLib.System.Threading.Atomics.h"
 
 using namespace XLib;
 
-// TODO: All this incorrect. Should be revisited.
-
+// CRC-8/SMBUS: polynomial 0x07, MSB first.
 static const uint8 CRC8Table[256] =
 {
-	0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97,
-	0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
-	0x43, 0x72, 0x21, 0x10, 0x87, 0xB6, 0xE5, 0xD4,
-	0xFA, 0xCB, 0x98, 0xA9, 0x3E, 0x0F, 0x5C, 0x6D,
-	0x86, 0xB7, 0xE4, 0xD5, 0x42, 0x73, 0x20, 0x11,
-	0x3F, 0x0E, 0x5D, 0x6C, 0xFB, 0xCA, 0x99, 0xA8,
-	0xC5, 0xF4, 0xA7, 0x96, 0x01, 0x30, 0x63, 0x52,
-	0x7C, 0x4D, 0x1E, 0x2F, 0xB8, 0x89, 0xDA, 0xEB,
-	0x3D, 0x0C, 0x5F, 0x6E, 0xF9, 0xC8, 0x9B, 0xAA,
-	0x84, 0xB5, 0xE6, 0xD7, 0x40, 0x71, 0x22, 0x13,
-	0x7E, 0x4F, 0x1C, 0x2D, 0xBA, 0x8B, 0xD8, 0xE9,
-	0xC7, 0xF6, 0xA5, 0x94, 0x03, 0x32, 0x61, 0x50,
-	0xBB, 0x8A, 0xD9, 0xE8, 0x7F, 0x4E, 0x1D, 0x2C,
-	0x02, 0x33, 0x60, 0x51, 0xC6, 0xF7, 0xA4, 0x95,
-	0xF8, 0xC9, 0x9A, 0xAB, 0x3C, 0x0D, 0x5E, 0x6F,
-	0x41, 0x70, 0x23, 0x12, 0x85, 0xB4, 0xE7, 0xD6,
-	0x7A, 0x4B, 0x18, 0x29, 0xBE, 0x8F, 0xDC, 0xED,
-	0xC3, 0xF2, 0xA1, 0x90, 0x07, 0x36, 0x65, 0x54,
-	0x39, 0x08, 0x5B, 0x6A, 0xFD, 0xCC, 0x9F, 0xAE,
-	0x80, 0xB1, 0xE2, 0xD3, 0x44, 0x75, 0x26, 0x17,
-	0xFC, 0xCD, 0x9E, 0xAF, 0x38, 0x09, 0x5A, 0x6B,
-	0x45, 0x74, 0x27, 0x16, 0x81, 0xB0, 0xE3, 0xD2,
-	0xBF, 0x8E, 0xDD, 0xEC, 0x7B, 0x4A, 0x19, 0x28,
-	0x06, 0x37, 0x64, 0x55, 0xC2, 0xF3, 0xA0, 0x91,
-	0x47, 0x76, 0x25, 0x14, 0x83, 0xB2, 0xE1, 0xD0,
-	0xFE, 0xCF, 0x9C, 0xAD, 0x3A, 0x0B, 0x58, 0x69,
-	0x04, 0x35, 0x66, 0x57, 0xC0, 0xF1, 0xA2, 0x93,
-	0xBD, 0x8C, 0xDF, 0xEE, 0x79, 0x48, 0x1B, 0x2A,
-	0xC1, 0xF0, 0xA3, 0x92, 0x05, 0x34, 0x67, 0x56,
-	0x78, 0x49, 0x1A, 0x2B, 0xBC, 0x8D, 0xDE, 0xEF,
-	0x82, 0xB3, 0xE0, 0xD1, 0x46, 0x77, 0x24, 0x15,
-	0x3B, 0x0A, 0x59, 0x68, 0xFF, 0xCE, 0x9D, 0xAC,
+	0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+	0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+	0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65,
+	0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+	0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5,
+	0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+	0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85,
+	0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+	0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2,
+	0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+	0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2,
+	0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+	0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32,
+	0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+	0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42,
+	0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+	0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C,
+	0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+	0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC,
+	0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+	0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C,
+	0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+	0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C,
+	0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+	0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B,
+	0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+	0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B,
+	0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+	0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB,
+	0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+	0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB,
+	0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3,
 };
 
+// CRC-16/ARC: polynomial 0x8005, reflected (0xA001).
 static const uint16 CRC16Table[256] =
 {
-	0x0000, 0x1189, 0x2312, 0x329B, 0x4624, 0x57AD, 0x6536, 0x74BF,
-	0x8C48, 0x9DC1, 0xAF5A, 0xBED3, 0xCA6C, 0xDBE5, 0xE97E, 0xF8F7,
-	0x0919, 0x1890, 0x2A0B, 0x3B82, 0x4F3D, 0x5EB4, 0x6C2F, 0x7DA6,
-	0x8551, 0x94D8, 0xA643, 0xB7CA, 0xC375, 0xD2FC, 0xE067, 0xF1EE,
-	0x1232, 0x03BB, 0x3120, 0x20A9, 0x5416, 0x459F, 0x7704, 0x668D,
-	0x9E7A, 0x8FF3, 0xBD68, 0xACE1, 0xD85E, 0xC9D7, 0xFB4C, 0xEAC5,
-	0x1B2B, 0x0AA2, 0x3839, 0x29B0, 0x5D0F, 0x4C86, 0x7E1D, 0x6F94,
-	0x9763, 0x86EA, 0xB471, 0xA5F8, 0xD147, 0xC0CE, 0xF255, 0xE3DC,
-	0x2464, 0x35ED, 0x0776, 0x16FF, 0x6240, 0x73C9, 0x4152, 0x50DB,
-	0xA82C, 0xB9A5, 0x8B3E, 0x9AB7, 0xEE08, 0xFF81, 0xCD1A, 0xDC93,
-	0x2D7D, 0x3CF4, 0x0E6F, 0x1FE6, 0x6B59, 0x7AD0, 0x484B, 0x59C2,
-	0xA135, 0xB0BC, 0x8227, 0x93AE, 0xE711, 0xF698, 0xC403, 0xD58A,
-	0x3656, 0x27DF, 0x1544, 0x04CD, 0x7072, 0x61FB, 0x5360, 0x42E9,
-	0xBA1E, 0xAB97, 0x990C, 0x8885, 0xFC3A, 0xEDB3, 0xDF28, 0xCEA1,
-	0x3F4F, 0x2EC6, 0x1C5D, 0x0DD4, 0x796B, 0x68E2, 0x5A79, 0x4BF0,
-	0xB307, 0xA28E, 0x9015, 0x819C, 0xF523, 0xE4AA, 0xD631, 0xC7B8,
-	0x48C8, 0x5941, 0x6BDA, 0x7A53, 0x0EEC, 0x1F65, 0x2DFE, 0x3C77,
-	0xC480, 0xD509, 0xE792, 0xF61B, 0x82A4, 0x932D, 0xA1B6, 0xB03F,
-	0x41D1, 0x5058, 0x62C3, 0x734A, 0x07F5, 0x167C, 0x24E7, 0x356E,
-	0xCD99, 0xDC10, 0xEE8B, 0xFF02, 0x8BBD, 0x9A34, 0xA8AF, 0xB926,
-	0x5AFA, 0x4B73, 0x79E8, 0x6861, 0x1CDE, 0x0D57, 0x3FCC, 0x2E45,
-	0xD6B2, 0xC73B, 0xF5A0, 0xE429, 0x9096, 0x811F, 0xB384, 0xA20D,
-	0x53E3, 0x426A, 0x70F1, 0x6178, 0x15C7, 0x044E, 0x36D5, 0x275C,
-	0xDFAB, 0xCE22, 0xFCB9, 0xED30, 0x998F, 0x8806, 0xBA9D, 0xAB14,
-	0x6CAC, 0x7D25, 0x4FBE, 0x5E37, 0x2A88, 0x3B01, 0x099A, 0x1813,
-	0xE0E4, 0xF16D, 0xC3F6, 0xD27F, 0xA6C0, 0xB749, 0x85D2, 0x945B,
-	0x65B5, 0x743C, 0x46A7, 0x572E, 0x2391, 0x3218, 0x0083, 0x110A,
-	0xE9FD, 0xF874, 0xCAEF, 0xDB66, 0xAFD9, 0xBE50, 0x8CCB, 0x9D42,
-	0x7E9E, 0x6F17, 0x5D8C, 0x4C05, 0x38BA, 0x2933, 0x1BA8, 0x0A21,
-	0xF2D6, 0xE35F, 0xD1C4, 0xC04D, 0xB4F2, 0xA57B, 0x97E0, 0x8669,
-	0x7787, 0x660E, 0x5495, 0x451C, 0x31A3, 0x202A, 0x12B1, 0x0338,
-	0xFBCF, 0xEA46, 0xD8DD, 0xC954, 0xBDEB, 0xAC62, 0x9EF9, 0x8F70,
-};
-
-static const uint32 CRC32Table[256] =
-{
-	0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
-	0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91,
-	0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
-	0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
-	0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B,
-	0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
-	0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
-	0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D,
-	0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
-	0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D, 0x91646C97, 0xE6635C01,
-	0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E, 0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457,
-	0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
-	0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB,
-	0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
-	0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
-	0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81, 0xB7BD5C3B, 0xC0BA6CAD,
-	0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683,
-	0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
-	0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7,
-	0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5,
-	0xD6D6A3E8, 0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
-	0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF, 0x4669BE79,
-	0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F,
-	0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
-	0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713,
-	0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21,
-	0x86D3D2D4, 0xF1D4E242, 0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
-	0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
-	0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB,
-	0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
-	0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF,
-	0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D,
-};
-
-static const uint64 CRC64Table[256] =
-{
-	0x0000000000000000, 0xB32E4CBE03A75F6F, 0xF4843657A840A05B, 0x47AA7AE9ABE7FF34, 0x7BD0C384FF8F5E33, 0xC8FE8F3AFC28015C, 0x8F54F5D357CFFE68, 0x3C7AB96D5468A107,
-	0xF7A18709FF1EBC66, 0x448FCBB7FCB9E309, 0x0325B15E575E1C3D, 0xB00BFDE054F94352, 0x8C71448D0091E255, 0x3F5F08330336BD3A, 0x78F572DAA8D1420E, 0xCBDB3E64AB761D61,
-	0x7D9BA13851336649, 0xCEB5ED8652943926, 0x891F976FF973C612, 0x3A31DBD1FAD4997D, 0x064B62BCAEBC387A, 0xB5652E02AD1B6715, 0xF2CF54EB06FC9821, 0x41E11855055BC74E,
-	0x8A3A2631AE2DDA2F, 0x39146A8FAD8A8540, 0x7EBE1066066D7A74, 0xCD905CD805CA251B, 0xF1EAE5B551A2841C, 0x42C4A90B5205DB73, 0x056ED3E2F9E22447, 0xB6409F5CFA457B28,
-	0xFB374270A266CC92, 0x48190ECEA1C193FD, 0x0FB374270A266CC9, 0xBC9D3899098133A6, 0x80E781F45DE992A1, 0x33C9CD4A5E4ECDCE, 0x7463B7A3F5A932FA, 0xC74DFB1DF60E6D95,
-	0x0C96C5795D7870F4, 0xBFB889C75EDF2F9B, 0xF812F32EF538D0AF, 0x4B3CBF90F69F8FC0, 0x774606FDA2F72EC7, 0xC4684A43A15071A8, 0x83C230AA0AB78E9C, 0x30EC7C140910D1F3,
-	0x86ACE348F355AADB, 0x3582AFF6F0F2F5B4, 0x7228D51F5B150A80, 0xC10699A158B255EF, 0xFD7C20CC0CDAF4E8, 0x4E526C720F7DAB87, 0x09F8169BA49A54B3, 0xBAD65A25A73D0BDC,
-	0x710D64410C4B16BD, 0xC22328FF0FEC49D2, 0x85895216A40BB6E6, 0x36A71EA8A7ACE989, 0x0ADDA7C5F3C4488E, 0xB9F3EB7BF06317E1, 0xFE5991925B84E8D5, 0x4D77DD2C5823B7BA,
-	0x64B62BCAEBC387A1, 0xD7986774E864D8CE, 0x90321D9D438327FA, 0x231C512340247895, 0x1F66E84E144CD992, 0xAC48A4F017EB86FD, 0xEBE2DE19BC0C79C9, 0x58CC92A7BFAB26A6,
-	0x9317ACC314DD3BC7, 0x2039E07D177A64A8, 0x67939A94BC9D9B9C, 0xD4BDD62ABF3AC4F3, 0xE8C76F47EB5265F4, 0x5BE923F9E8F53A9B, 0x1C4359104312C5AF, 0xAF6D15AE40B59AC0,
-	0x192D8AF2BAF0E1E8, 0xAA03C64CB957BE87, 0xEDA9BCA512B041B3, 0x5E87F01B11171EDC, 0x62FD4976457FBFDB, 0xD1D305C846D8E0B4, 0x96797F21ED3F1F80, 0x2557339FEE9840EF,
-	0xEE8C0DFB45EE5D8E, 0x5DA24145464902E1, 0x1A083BACEDAEFDD5, 0xA9267712EE09A2BA, 0x955CCE7FBA6103BD, 0x267282C1B9C65CD2, 0x61D8F8281221A3E6, 0xD2F6B4961186FC89,
-	0x9F8169BA49A54B33, 0x2CAF25044A02145C, 0x6B055FEDE1E5EB68, 0xD82B1353E242B407, 0xE451AA3EB62A1500, 0x577FE680B58D4A6F, 0x10D59C691E6AB55B, 0xA3FBD0D71DCDEA34,
-	0x6820EEB3B6BBF755, 0xDB0EA20DB51CA83A, 0x9CA4D8E41EFB570E, 0x2F8A945A1D5C0861, 0x13F02D374934A966, 0xA0DE61894A93F609, 0xE7741B60E174093D, 0x545A57DEE2D35652,
-	0xE21AC88218962D7A, 0x5134843C1B317215, 0x169EFED5B0D68D21, 0xA5B0B26BB371D24E, 0x99CA0B06E7197349, 0x2AE447B8E4BE2C26, 0x6D4E3D514F59D312, 0xDE6071EF4CFE8C7D,
-	0x15BB4F8BE788911C, 0xA6950335E42FCE73, 0xE13F79DC4FC83147, 0x521135624C6F6E28, 0x6E6B8C0F1807CF2F, 0xDD45C0B11BA09040, 0x9AEFBA58B0476F74, 0x29C1F6E6B3E0301B,
-	0xC96C5795D7870F42, 0x7A421B2BD420502D, 0x3DE861C27FC7AF19, 0x8EC62D7C7C60F076, 0xB2BC941128085171, 0x0192D8AF2BAF0E1E, 0x4638A2468048F12A, 0xF516EEF883EFAE45,
-	0x3ECDD09C2899B324, 0x8DE39C222B3EEC4B, 0xCA49E6CB80D9137F, 0x7967AA75837E4C10, 0x451D1318D716ED17, 0xF6335FA6D4B1B278, 0xB199254F7F564D4C, 0x02B769F17CF11223,
-	0xB4F7F6AD86B4690B, 0x07D9BA1385133664, 0x4073C0FA2EF4C950, 0xF35D8C442D53963F, 0xCF273529793B3738, 0x7C0979977A9C6857, 0x3BA3037ED17B9763, 0x888D4FC0D2DCC80C,
-	0x435671A479AAD56D, 0xF0783D1A7A0D8A02, 0xB7D247F3D1EA7536, 0x04FC0B4DD24D2A59, 0x3886B22086258B5E, 0x8BA8FE9E8582D431, 0xCC0284772E652B05, 0x7F2CC8C92DC2746A,
-	0x325B15E575E1C3D0, 0x8175595B76469CBF, 0xC6DF23B2DDA1638B, 0x75F16F0CDE063CE4, 0x498BD6618A6E9DE3, 0xFAA59ADF89C9C28C, 0xBD0FE036222E3DB8, 0x0E21AC88218962D7,
-	0xC5FA92EC8AFF7FB6, 0x76D4DE52895820D9, 0x317EA4BB22BFDFED, 0x8250E80521188082, 0xBE2A516875702185, 0x0D041DD676D77EEA, 0x4AAE673FDD3081DE, 0xF9802B81DE97DEB1,
-	0x4FC0B4DD24D2A599, 0xFCEEF8632775FAF6, 0xBB44828A8C9205C2, 0x086ACE348F355AAD, 0x34107759DB5DFBAA, 0x873E3BE7D8FAA4C5, 0xC094410E731D5BF1, 0x73BA0DB070BA049E,
-	0xB86133D4DBCC19FF, 0x0B4F7F6AD86B4690, 0x4CE50583738CB9A4, 0xFFCB493D702BE6CB, 0xC3B1F050244347CC, 0x709FBCEE27E418A3, 0x3735C6078C03E797, 0x841B8AB98FA4B8F8,
-	0xADDA7C5F3C4488E3, 0x1EF430E13FE3D78C, 0x595E4A08940428B8, 0xEA7006B697A377D7, 0xD60ABFDBC3CBD6D0, 0x6524F365C06C89BF, 0x228E898C6B8B768B, 0x91A0C532682C29E4,
-	0x5A7BFB56C35A3485, 0xE955B7E8C0FD6BEA, 0xAEFFCD016B1A94DE, 0x1DD181BF68BDCBB1, 0x21AB38D23CD56AB6, 0x9285746C3F7235D9, 0xD52F0E859495CAED, 0x6601423B97329582,
-	0xD041DD676D77EEAA, 0x636F91D96ED0B1C5, 0x24C5EB30C5374EF1, 0x97EBA78EC690119E, 0xAB911EE392F8B099, 0x18BF525D915FEFF6, 0x5F1528B43AB810C2, 0xEC3B640A391F4FAD,
-	0x27E05A6E926952CC, 0x94CE16D091CE0DA3, 0xD3646C393A29F297, 0x604A2087398EADF8, 0x5C3099EA6DE60CFF, 0xEF1ED5546E415390, 0xA8B4AFBDC5A6ACA4, 0x1B9AE303C601F3CB,
-	0x56ED3E2F9E224471, 0xE5C372919D851B1E, 0xA26908783662E42A, 0x114744C635C5BB45, 0x2D3DFDAB61AD1A42, 0x9E13B115620A452D, 0xD9B9CBFCC9EDBA19, 0x6A978742CA4AE576,
-	0xA14CB926613CF817, 0x1262F598629BA778, 0x55C88F71C97C584C, 0xE6E6C3CFCADB0723, 0xDA9C7AA29EB3A624, 0x69B2361C9D14F94B, 0x2E184CF536F3067F, 0x9D36004B35545910,
-	0x2B769F17CF112238, 0x9858D3A9CCB67D57, 0xDFF2A94067518263, 0x6CDCE5FE64F6DD0C, 0x50A65C93309E7C0B, 0xE388102D33392364, 0xA4226AC498DEDC50, 0x170C267A9B79833F,
-	0xDCD7181E300F9E5E, 0x6FF954A033A8C131, 0x28532E49984F3E05, 0x9B7D62F79BE8616A, 0xA707DB9ACF80C06D, 0x14299724CC279F02, 0x5383EDCD67C06036, 0xE0ADA17364673F59,
+	0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+	0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+	0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+	0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+	0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+	0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+	0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+	0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+	0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+	0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+	0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+	0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+	0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+	0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+	0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+	0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+	0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+	0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+	0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+	0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+	0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+	0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+	0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+	0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+	0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+	0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+	0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+	0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+	0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+	0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+	0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+	0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040,
 };
 
 uint8 CRC8::Compute(const void* data, uintptr size, uint8 seed)
@@ -167,31 +99,298 @@ uint16 CRC16::Compute(const void* data, uintptr size, uint16 seed)
 	const uint8* current = (const uint8*)data;
 	const uint8* end = current + size;
 	for (; current < end; current++)
-		crc = (crc << 8) ^ CRC16Table[uint8((crc >> 8) ^ *current)];
+		crc = (crc >> 8) ^ CRC16Table[uint8(crc ^ *current)];
 
 	return crc;
 }
 
+namespace
+{
+	// Reflected CRC parameters. Fold constants are `x^(D+63) mod P` and `x^(D-1) mod P` multiplied
+	// by `x` and bit-reflected to 64 bits (`D` is fold distance in bits): folding 128-bit block
+	// by `D` bits is then two carry-less 64x64 multiplications (see "Fast CRC Computation for
+	// Generic Polynomials Using PCLMULQDQ Instruction", Intel).
+
+	struct CRC32Desc
+	{
+		using CRCType = uint32;
+		static constexpr uint32 ReflectedPoly = 0xEDB8'8320;
+		static constexpr uint64 FoldBy4Lo = 0x653D'9822'0000'0000;
+		static constexpr uint64 FoldBy4Hi = 0xCAD3'8E8F'0000'0000;
+		static constexpr uint64 FoldBy1Lo = 0x6567'3B46'0000'0000;
+		static constexpr uint64 FoldBy1Hi = 0x9BA5'4C6F'0000'0000;
+	};
+
+	struct CRC32CDesc
+	{
+		using CRCType = uint32;
+		static constexpr uint32 ReflectedPoly = 0x82F6'3B78;
+	};
+
+	struct CRC64Desc
+	{
+		using CRCType = uint64;
+		static constexpr uint64 ReflectedPoly = 0xC96C'5795'D787'0F42;
+		static constexpr uint64 FoldBy4Lo = 0x6AE3'EFBB'9DD4'41F3;
+		static constexpr uint64 FoldBy4Hi = 0x081F'6054'A784'2DF4;
+		static constexpr uint64 FoldBy1Lo = 0xE05D'D497'CA39'3AE4;
+		static constexpr uint64 FoldBy1Hi = 0xDABE'95AF'C787'5F40;
+	};
+
+	// Values passed around here are raw CRC register values (without initial and final inversion).
+	template <typename CRCDesc>
+	class ReflectedCRC abstract final
+	{
+	public:
+		using CRCType = typename CRCDesc::CRCType;
+
+	private:
+		static constexpr uint32 CRCBitCount = sizeof(CRCType) * 8;
+
+		// `tables[k][b]` is CRC of byte `b` followed by `k` zero bytes.
+		struct SliceBy8Tables
+		{
+			CRCType tables[8][256];
+		};
+
+		static constexpr SliceBy8Tables GenerateSliceBy8Tables()
+		{
+			SliceBy8Tables result = {};
+			for (uint32 i = 0; i < 256; i++)
+			{
+				CRCType crc = CRCType(i);
+				for (uint32 j = 0; j < 8; j++)
+					crc = (crc & 1) ? (crc >> 1) ^ CRCDesc::ReflectedPoly : crc >> 1;
+				result.tables[0][i] = crc;
+			}
+			for (uint32 k = 1; k < 8; k++)
+			{
+				for (uint32 i = 0; i < 256; i++)
+				{
+					const CRCType prevCRC = result.tables[k - 1][i];
+					result.tables[k][i] = (prevCRC >> 8) ^ result.tables[0][uint8(prevCRC)];
+				}
+			}
+			return result;
+		}
+
+		static constexpr SliceBy8Tables Tables = GenerateSliceBy8Tables();
+
+	public:
+		static CRCType Update(CRCType crc, const uint8* data, uintptr size)
+		{
+			const CRCType (&t)[8][256] = Tables.tables;
+
+			for (; size > 0 && (uintptr(data) & 7) != 0; size--, data++)
+				crc = (crc >> 8) ^ t[0][uint8(crc) ^ *data];
+
+			for (; size >= 8; size -= 8, data += 8)
+			{
+				const uint64 x = *(const uint64*)data ^ uint64(crc);
+				crc =
+					t[7][uint8(x >>  0)] ^ t[6][uint8(x >>  8)] ^ t[5][uint8(x >> 16)] ^ t[4][uint8(x >> 24)] ^
+					t[3][uint8(x >> 32)] ^ t[2][uint8(x >> 40)] ^ t[1][uint8(x >> 48)] ^ t[0][uint8(x >> 56)];
+			}
+
+			for (; size > 0; size--, data++)
+				crc = (crc >> 8) ^ t[0][uint8(crc) ^ *data];
+
+			return crc;
+		}
+
+		// Polynomial product modulo P. Bit-reflected, so `x^0` is the top bit.
+		static constexpr CRCType Multiply(CRCType a, CRCType b)
+		{
+			CRCType result = 0;
+			for (CRCType mask = CRCType(1) << (CRCBitCount - 1); mask != 0; mask >>= 1)
+			{
+				if (a & mask)
+					result ^= b;
+				b = (b & 1) ? (b >> 1) ^ CRCDesc::ReflectedPoly : b >> 1;
+			}
+			return result;
+		}
+
+		// Appending zero byte to message multiplies its CRC by `x^8`. Initial and final inversions
+		// cancel out in combination, so this works on final CRC values as well.
+		static CRCType Combine(CRCType crcA, CRCType crcB, uint64 sizeB)
+		{
+			CRCType shift = CRCType(1) << (CRCBitCount - 1);	// x^0
+			CRCType power = CRCType(1) << (CRCBitCount - 1 - 8);	// x^8
+			for (; sizeB; sizeB >>= 1)
+			{
+				if (sizeB & 1)
+					shift = Multiply(shift, power);
+				power = Multiply(power, power);
+			}
+			return Multiply(shift, crcA) ^ crcB;
+		}
+	};
+
+	inline __m128i FoldCLMUL(__m128i block, __m128i foldConstants, __m128i nextBlock)
+	{
+		const __m128i lo = _mm_clmulepi64_si128(block, foldConstants, 0x00);
+		const __m128i hi = _mm_clmulepi64_si128(block, foldConstants, 0x11);
+		return _mm_xor_si128(_mm_xor_si128(lo, hi), nextBlock);
+	}
+
+	template <typename CRCDesc>
+	typename CRCDesc::CRCType UpdateCLMUL(typename CRCDesc::CRCType crc, const uint8* data, uintptr size)
+	{
+		using CRC = ReflectedCRC<CRCDesc>;
+
+		if (size < 64)
+			return CRC::Update(crc, data, size);
+
+		// CRC register is XORed into first message bytes. From now on only remainder matters.
+		__m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)data), _mm_cvtsi64_si128(sint64(crc)));
+		__m128i x1 = _mm_loadu_si128((const __m128i*)(data + 16));
+		__m128i x2 = _mm_loadu_si128((const __m128i*)(data + 32));
+		__m128i x3 = _mm_loadu_si128((const __m128i*)(data + 48));
+		data += 64;
+		size -= 64;
+
+		const __m128i foldBy4 = _mm_set_epi64x(sint64(CRCDesc::FoldBy4Hi), sint64(CRCDesc::FoldBy4Lo));
+		for (; size >= 64; size -= 64, data += 64)
+		{
+			x0 = FoldCLMUL(x0, foldBy4, _mm_loadu_si128((const __m128i*)data));
+			x1 = FoldCLMUL(x1, foldBy4, _mm_loadu_si128((const __m128i*)(data + 16)));
+			x2 = FoldCLMUL(x2, foldBy4, _mm_loadu_si128((const __m128i*)(data + 32)));
+			x3 = FoldCLMUL(x3, foldBy4, _mm_loadu_si128((const __m128i*)(data + 48)));
+		}
+
+		const __m128i foldBy1 = _mm_set_epi64x(sint64(CRCDesc::FoldBy1Hi), sint64(CRCDesc::FoldBy1Lo));
+		x0 = FoldCLMUL(x0, foldBy1, x1);
+		x0 = FoldCLMUL(x0, foldBy1, x2);
+		x0 = FoldCLMUL(x0, foldBy1, x3);
+		for (; size >= 16; size -= 16, data += 16)
+			x0 = FoldCLMUL(x0, foldBy1, _mm_loadu_si128((const __m128i*)data));
+
+		// Folded block has the same remainder as all data processed so far.
+		alignas(16) uint8 foldedBlock[16];
+		_mm_store_si128((__m128i*)foldedBlock, x0);
+		crc = CRC::Update(0, foldedBlock, sizeof(foldedBlock));
+
+		return CRC::Update(crc, data, size);
+	}
+
+	uint32 UpdateCRC32CSSE42(uint32 crc, const uint8* data, uintptr size)
+	{
+		for (; size > 0 && (uintptr(data) & 7) != 0; size--, data++)
+			crc = _mm_crc32_u8(crc, *data);
+
+		uint64 crc64 = crc;
+		for (; size >= 8; size -= 8, data += 8)
+			crc64 = _mm_crc32_u64(crc64, *(const uint64*)data);
+		crc = uint32(crc64);
+
+		for (; size > 0; size--, data++)
+			crc = _mm_crc32_u8(crc, *data);
+
+		return crc;
+	}
+
+	using UpdateCRC32Func = uint32(*)(uint32 crc, const uint8* data, uintptr size);
+	using UpdateCRC64Func = uint64(*)(uint64 crc, const uint8* data, uintptr size);
+
+	bool IsPCLMULQDQSupported()
+	{
+		int cpuInfo[4] = {};
+		__cpuid(cpuInfo, 1);
+		return (cpuInfo[2] & (1 << 1)) != 0;
+	}
+
+	bool IsSSE42Supported()
+	{
+		int cpuInfo[4] = {};
+		__cpuid(cpuInfo, 1);
+		return (cpuInfo[2] & (1 << 20)) != 0;
+	}
+
+	struct UpdateFuncs
+	{
+		UpdateCRC32Func crc32;
+		UpdateCRC32Func crc32c;
+		UpdateCRC64Func crc64;
+	};
+
+	const UpdateFuncs TableUpdateFuncs =
+	{
+		ReflectedCRC<CRC32Desc>::Update,
+		ReflectedCRC<CRC32CDesc>::Update,
+		ReflectedCRC<CRC64Desc>::Update,
+	};
+
+	const UpdateFuncs HardwareUpdateFuncs =
+	{
+		UpdateCLMUL<CRC32Desc>,
+		UpdateCRC32CSSE42,
+		UpdateCLMUL<CRC64Desc>,
+	};
+
+	const UpdateFuncs& GetDefaultUpdateFuncs()
+	{
+		static const UpdateFuncs defaultUpdateFuncs =
+		{
+			IsPCLMULQDQSupported() ? HardwareUpdateFuncs.crc32 : TableUpdateFuncs.crc32,
+			IsSSE42Supported() ? HardwareUpdateFuncs.crc32c : TableUpdateFuncs.crc32c,
+			IsPCLMULQDQSupported() ? HardwareUpdateFuncs.crc64 : TableUpdateFuncs.crc64,
+		};
+		return defaultUpdateFuncs;
+	}
+
+	// Null until `CRC::SetImplementation` selects something other than default.
+	Atomic<const UpdateFuncs*> currentUpdateFuncs;
+
+	inline const UpdateFuncs& GetUpdateFuncs()
+	{
+		const UpdateFuncs* updateFuncs = currentUpdateFuncs.loadAcquire();
+		return updateFuncs ? *updateFuncs : GetDefaultUpdateFuncs();
+	}
+}
+
+void CRC::SetImplementation(CRCImplementation implementation)
+{
+	XAssert(implementation != CRCImplementation::Hardware || IsHardwareImplementationSupported());
+	const UpdateFuncs* updateFuncs = nullptr;
+	if (implementation == CRCImplementation::Table)
+		updateFuncs = &TableUpdateFuncs;
+	else if (implementation == CRCImplementation::Hardware)
+		updateFuncs = &HardwareUpdateFuncs;
+	currentUpdateFuncs.storeRelease(updateFuncs);
+}
+
+bool CRC::IsHardwareImplementationSupported()
+{
+	return IsPCLMULQDQSupported() && IsSSE42Supported();
+}
+
 uint32 CRC32::Compute(const void* data, uintptr size, uint32 seed)
 {
-	uint32 crc = seed ^ 0xFFFF'FFFF;
+	return GetUpdateFuncs().crc32(seed ^ 0xFFFF'FFFF, (const uint8*)data, size) ^ 0xFFFF'FFFF;
+}
 
-	const uint8* current = (const uint8*)data;
-	const uint8* end = current + size;
-	for (; current < end; current++)
-		crc = (crc >> 8) ^ CRC32Table[uint8(crc) ^ *current];
+uint32 CRC32::Combine(uint32 crcA, uint32 crcB, uint64 sizeB)
+{
+	return ReflectedCRC<CRC32Desc>::Combine(crcA, crcB, sizeB);
+}
 
-	return crc ^ 0xFFFF'FFFF;
+uint32 CRC32C::Compute(const void* data, uintptr size, uint32 seed)
+{
+	return GetUpdateFuncs().crc32c(seed ^ 0xFFFF'FFFF, (const uint8*)data, size) ^ 0xFFFF'FFFF;
 }
 
-uint64 CRC64::Compute(const void* data, uintptr size, uint64 seed)
+uint32 CRC32C::Combine(uint32 crcA, uint32 crcB, uint64 sizeB)
 {
-	uint64 crc = seed ^ 0xFFFF'FFFF'FFFF'FFFF;
+	return ReflectedCRC<CRC32CDesc>::Combine(crcA, crcB, sizeB);
+}
 
-	const uint8* current = (const uint8*)data;
-	const uint8* end = current + size;
-	for (; current < end; current++)
-		crc = (crc >> 8) ^ CRC64Table[uint8(crc) ^ *current];
+uint64 CRC64::Compute(const void* data, uintptr size, uint64 seed)
+{
+	return GetUpdateFuncs().crc64(seed ^ 0xFFFF'FFFF'FFFF'FFFF, (const uint8*)data, size) ^ 0xFFFF'FFFF'FFFF'FFFF;
+}
 
-	return crc ^ 0xFFFF'FFFF'FFFF'FFFF;
+uint64 CRC64::Combine(uint64 crcA, uint64 crcB, uint64 sizeB)
+{
+	return ReflectedCRC<CRC64Desc>::Combine(crcA, crcB, sizeB);
 }
@@ -2,19 +2,40 @@
 
 #include "XLib.h"
 
-// TODO: implement standart algorithms
-
 //	| Algorithm       | Polynomial         | XorIn              | XorOut             | RefIn | RefOut | Check(123456789)   |
 //	+-----------------+--------------------+--------------------+--------------------+-------+--------+--------------------+
+//	| CRC-8/SMBUS     | 0x07               | 0x00               | 0x00               |   -   |   -    | 0xF4               |
+//	| CRC-16/ARC      | 0x8005             | 0x0000             | 0x0000             |   +   |   +    | 0xBB3D             |
 //	| CRC-32/zlib     | 0x04C11DB7         | 0xFFFFFFFF         | 0xFFFFFFFF         |   +   |   +    | 0xCBF43926         |
+//	| CRC-32C         | 0x1EDC6F41         | 0xFFFFFFFF         | 0xFFFFFFFF         |   +   |   +    | 0xE3069283         |
 //	| CRC-32/POSIX    | 0x04C11DB7         | 0x00000000         | 0xFFFFFFFF         |   -   |   -    | 0x765E7680         |
 //	| CRC-64/ECMA182  | 0x42F0E1EBA9EA3693 | 0x0000000000000000 | 0x0000000000000000 |   -   |   -    | 0x6C40DF5F0B497347 |
 //	| CRC-64/XZ       | 0x42F0E1EBA9EA3693 | 0xFFFFFFFFFFFFFFFF | 0xFFFFFFFFFFFFFFFF |   +   |   +    | 0x995DC9BBDF1939FA |
 //	| CRC-64/ISO      | 0x000000000000001B | 0xFFFFFFFFFFFFFFFF | 0xFFFFFFFFFFFFFFFF |   +   |   +    | 0xB90956C775A41001 |
 
+// CRC32, CRC32C and CRC64 use PCLMULQDQ folding (SSE4.2 `crc32` instruction for CRC32C) when
+// supported by CPU and slice-by-8 tables otherwise. Implementation is selected on first use.
+// `Combine(crcA, crcB, sizeB)` gives checksum of concatenation of A and B, so large blobs can be
+// checksummed in parallel chunks.
+
 namespace XLib
 {
-	class CRC8
+	enum class CRCImplementation : uint8
+	{
+		Default = 0,	// Fastest supported by CPU for each algorithm.
+		Table,			// Slice-by-8 tables.
+		Hardware,		// PCLMULQDQ folding for CRC32 and CRC64, SSE4.2 `crc32` for CRC32C.
+	};
+
+	class CRC abstract final
+	{
+	public:
+		// Meant for tests and benchmarks. Hardware implementation should be supported by CPU.
+		static void SetImplementation(CRCImplementation implementation);
+		static bool IsHardwareImplementationSupported();
+	};
+
+	class CRC8 // CRC-8/SMBUS
 	{
 	private:
 		uint8 value = 0;
@@ -32,7 +53,7 @@ namespace XLib
 		static inline uint8 Compute(const Type& data) { return Compute(&data, sizeof(data)); }
 	};
 
-	class CRC16
+	class CRC16 // CRC-16/ARC
 	{
 	private:
 		uint16 value = 0;
@@ -57,6 +78,26 @@ namespace XLib
 
 	public:
 		static uint32 Compute(const void* data, uintptr size, uint32 seed = 0);
+		static uint32 Combine(uint32 crcA, uint32 crcB, uint64 sizeB);
+
+		inline void process(const void* data, uintptr size) { value = Compute(data, size, value); }
+		inline uint32 getValue() { return value; }
+		inline void reset() { value = 0; }
+
+		template <typename Type>
+		inline void process(const Type& data) { process(&data, sizeof(data)); }
+		template <typename Type>
+		static inline uint32 Compute(const Type& data) { return Compute(&data, sizeof(data)); }
+	};
+
+	class CRC32C // CRC-32C (Castagnoli)
+	{
+	private:
+		uint32 value = 0;
+
+	public:
+		static uint32 Compute(const void* data, uintptr size, uint32 seed = 0);
+		static uint32 Combine(uint32 crcA, uint32 crcB, uint64 sizeB);
 
 		inline void process(const void* data, uintptr size) { value = Compute(data, size, value); }
 		inline uint32 getValue() { return value; }
@@ -75,6 +116,7 @@ namespace XLib
 
 	public:
 		static uint64 Compute(const void* data, uintptr size, uint64 seed = 0);
+		static uint64 Combine(uint64 crcA, uint64 crcB, uint64 sizeB);
 
 		inline void process(const void* data, uintptr size) { value = Compute(data, size, value); }
 		inline uint64 getValue() { return value; }
@@ -272,11 +272,25 @@ void VirtualStringWriter::write(const char* data, uintptr length)
 	bufferOffset += lengthU32;
 }
 
+char* VirtualStringWriter::reserve(uintptr length)
+{
+	XAssert(maxBufferSize > 1); // Effectively checks if object is initialized.
+
+	if (length >= maxBufferSize - bufferOffset)
+		return nullptr;
+
+	const uint32 requiredBufferSize = bufferOffset + uint32(length) + 1;
+	if (bufferSize < requiredBufferSize)
+		growBufferExponentially(requiredBufferSize);
+
+	return buffer + bufferOffset;
+}
+
 void VirtualStringWriter::write(const char* cstr)
 {
 	const char* srcIt = cstr;
 	char* bufferIt = buffer + bufferOffset;
-	char* bufferEnd = buffer + bufferSize - 1;
+	char* bufferEnd = bufferSize ? buffer + bufferSize - 1 : buffer; // Empty string may have no buffer yet.
 
 	while (*srcIt)
 	{
@@ -385,3 +399,20 @@ FileCharStreamWriter& XLib::GetStdErrStream()
 
 	return StdErrStream;
 }
+
+FileCharStreamWriter& XLib::GetThreadStdOutStream()
+{
+	// Destructor flushes remaining output on thread exit.
+	thread_local FileCharStreamWriter ThreadStdOutStream;
+
+	if (!ThreadStdOutStream.isOpen())
+		ThreadStdOutStream.open(GetStdOutFileHandle(), 0x10000);
+
+	return ThreadStdOutStream;
+}
+
+bool XLib::IsStdOutConsole()
+{
+	static const bool isConsole = File::IsConsole(GetStdOutFileHandle());
+	return isConsole;
+}
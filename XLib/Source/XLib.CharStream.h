@@ -19,6 +19,12 @@ namespace XLib
 	//	put(char c)
 	//	write(const char* data, uintptr length)
 	//	write(const char* cstr)
+	//	reserve(uintptr length) -> char* (optional)
+	//	commit(uintptr length) (optional)
+
+	// `CharStreamWriter::reserve(length)` returns span of at least `length` chars to be written to
+	// directly, or null if writer can not provide it. Call to `commit(length)` with actual number of
+	// chars written (not greater than reserved) must follow before any other writer call.
 
 	// Char stream can not contain NUL characters.
 	// For char stream reader NUL character is considered end-of-stream.
@@ -95,6 +101,9 @@ namespace XLib
 		inline void put(char c);
 		void write(const char* data, uintptr length);
 		void write(const char* cstr);
+
+		inline char* reserve(uintptr length) { return length <= bufferSize - bufferOffset ? buffer + bufferOffset : nullptr; }
+		inline void commit(uintptr length) { bufferOffset += length; }
 	};
 
 
@@ -150,6 +159,9 @@ namespace XLib
 		inline void put(char c);
 		void write(const char* data, uintptr length);
 		void write(const char* cstr);
+
+		inline char* reserve(uintptr length);
+		inline void commit(uintptr length);
 	};
 
 
@@ -181,6 +193,9 @@ namespace XLib
 		inline void put(char c);
 		void write(const char* data, uintptr length);
 		void write(const char* cstr);
+
+		char* reserve(uintptr length);
+		inline void commit(uintptr length) { bufferOffset += uint32(length); }
 	};
 
 
@@ -226,6 +241,16 @@ namespace XLib
 	FileCharStreamReader& GetStdInStream();
 	FileCharStreamWriter& GetStdOutStream();
 	FileCharStreamWriter& GetStdErrStream();
+
+	// Per-thread stdout stream with 64 KiB buffer. Flushed when buffer is full, on explicit `flush`
+	// and on thread exit. Not synchronized with `GetStdOutStream`, so output of different threads
+	// is interleaved in large chunks.
+	FileCharStreamWriter& GetThreadStdOutStream();
+
+	// `FmtPrintStdOut` writes to thread stdout stream. When stdout is console every print is flushed
+	// right away, so progress is seen as it happens. When it is redirected to file or pipe, output is
+	// flushed in large chunks.
+	bool IsStdOutConsole();
 }
 
 
@@ -261,6 +286,22 @@ inline void XLib::FileCharStreamWriter::put(char c)
 		flush();
 }
 
+inline char* XLib::FileCharStreamWriter::reserve(uintptr length)
+{
+	if (length > bufferSize)
+		return nullptr;
+	if (length > bufferSize - bufferOffset)
+		flush();
+	return buffer + bufferOffset;
+}
+
+inline void XLib::FileCharStreamWriter::commit(uintptr length)
+{
+	bufferOffset += uint32(length);
+	if (bufferOffset == bufferSize)
+		flush();
+}
+
 inline void XLib::VirtualStringWriter::put(char c)
 {
 	const uint32 requiredBufferSize = bufferOffset + 2;
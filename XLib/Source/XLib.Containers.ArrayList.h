@@ -21,7 +21,7 @@
 
 namespace XLib
 {
-	template <typename Type, typename CounterType = uint32, bool IsSafe = true, typename AllocatorType = SystemHeapAllocator>
+	template <typename Type, typename CounterType = uint32, bool IsSafe = true, typename AllocatorType = DefaultAllocator>
 	class ArrayList :
 		private AllocatorAdapterBase<AllocatorType>,
 		public NonCopyable
@@ -43,6 +43,7 @@ namespace XLib
 
 	public:
 		ArrayList() = default;
+		inline ArrayList(AllocatorType& allocator) : AllocatorBase(allocator) {}
 		inline ~ArrayList() { destroy(); }
 
 		inline ArrayList(ArrayList&& that);
@@ -124,7 +125,7 @@ namespace XLib
 	};
 
 
-	template <typename Type, uintptr InplaceCapacity, typename CounterType = uint32, bool IsSafe = true, typename AllocatorType = SystemHeapAllocator>
+	template <typename Type, uintptr InplaceCapacity, typename CounterType = uint32, bool IsSafe = true, typename AllocatorType = DefaultAllocator>
 	class ExpandableInplaceArrayList :
 		private AllocatorAdapterBase<AllocatorType>,
 		public NonCopyable
@@ -167,7 +168,7 @@ namespace XLib
 	};
 
 
-	template <typename Type, uintptr SegmentSize, uintptr InplaceSegmentTableSize = 1, bool IsSafe = true, typename AllocatorType = SystemHeapAllocator>
+	template <typename Type, uintptr SegmentSize, uintptr InplaceSegmentTableSize = 1, bool IsSafe = true, typename AllocatorType = DefaultAllocator>
 	class FixedSegmentedArrayList :
 		private AllocatorAdapterBase<AllocatorType>,
 		public NonCopyable
@@ -182,7 +183,7 @@ namespace XLib
 	};
 
 
-	template <typename Type, uint8 MinCapacityLog2, uint8 MaxCapacityLog2, bool IsSafe = true, typename AllocatorType = SystemHeapAllocator>
+	template <typename Type, uint8 MinCapacityLog2, uint8 MaxCapacityLog2, bool IsSafe = true, typename AllocatorType = DefaultAllocator>
 	class FixedLogSegmentedArrayList :
 		private AllocatorAdapterBase<AllocatorType>,
 		public NonCopyable
@@ -317,12 +318,29 @@ namespace XLib
 		buffer = newBuffer;
 	}
 
+	template <typename Type, typename CounterType, bool IsSafe, typename AllocatorType>
+	inline ArrayList<Type, CounterType, IsSafe, AllocatorType>::
+		ArrayList(ArrayList&& that)
+	{
+		AllocatorBase::inheritAllocator(that);
+
+		buffer = that.buffer;
+		capacity = that.capacity;
+		size = that.size;
+
+		that.buffer = nullptr;
+		that.capacity = 0;
+		that.size = 0;
+	}
+
 	template <typename Type, typename CounterType, bool IsSafe, typename AllocatorType>
 	inline auto ArrayList<Type, CounterType, IsSafe, AllocatorType>::
 		operator = (ArrayList&& that) -> void
 	{
 		destroy();
 
+		AllocatorBase::inheritAllocator(that);
+
 		buffer = that.buffer;
 		capacity = that.capacity;
 		size = that.size;
@@ -381,7 +399,7 @@ namespace XLib
 		XAssert(!isEmpty());
 
 		const CounterType elementIndex = size - 1;
-		Type element = asRValue(buffer[elementIndex]);
+		Type element = AsRValue(buffer[elementIndex]);
 		XDestruct(buffer[elementIndex]);
 		size--;
 		return element;
@@ -482,7 +500,7 @@ namespace XLib
 	{
 		XAssert(!isEmpty());
 		size--;
-		return asRValue(buffer[size]);
+		return AsRValue(buffer[size]);
 	}
 
 	template <typename Type, uintptr Capacity, typename CounterType, bool IsSafe>
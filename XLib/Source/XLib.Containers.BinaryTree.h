@@ -1,6 +1,7 @@
 #pragma once
 
 #include "XLib.h"
+#include "XLib.Allocation.h"
 #include "XLib.Containers.AVLTreeLogic.h"
 #include "XLib.NonCopyable.h"
 
@@ -12,8 +13,10 @@ namespace XLib
 	// FlatBinaryTreeMap ///////////////////////////////////////////////////////////////////////////
 
 	// 8 bytes of aux data per element. 2^20 elements max.
-	template <typename Key, typename Value>
-	class FlatBinaryTreeMap : public XLib::NonCopyable
+	template <typename Key, typename Value, typename AllocatorType = DefaultAllocator>
+	class FlatBinaryTreeMap :
+		private AllocatorAdapterBase<AllocatorType>,
+		public XLib::NonCopyable
 	{
 	public:
 		struct KeyValuePair
@@ -23,6 +26,8 @@ namespace XLib
 		};
 
 	private:
+		using AllocatorBase = AllocatorAdapterBase<AllocatorType>;
+
 		class NodeAdapter;
 		using TreeLogic = AVLTreeLogic<NodeAdapter>;
 
@@ -43,6 +48,7 @@ namespace XLib
 
 	public:
 		FlatBinaryTreeMap() = default;
+		inline FlatBinaryTreeMap(AllocatorType& allocator) : AllocatorBase(allocator) {}
 		~FlatBinaryTreeMap() = default;
 
 		inline Iterator find(const Key& key) const;
@@ -61,10 +67,10 @@ namespace XLib
 		inline Iterator end() const;
 	};
 
-	template <typename Key, typename Value>
-	class FlatBinaryTreeMap<Key, Value>::Iterator
+	template <typename Key, typename Value, typename AllocatorType>
+	class FlatBinaryTreeMap<Key, Value, AllocatorType>::Iterator
 	{
-		template <typename Key, typename Value>
+		template <typename Key, typename Value, typename AllocatorType>
 		friend class FlatBinaryTreeMap;
 
 	private:
@@ -185,8 +191,8 @@ namespace XLib
 {
 	// FlatBinaryTreeMap::NodeAdapter //////////////////////////////////////////////////////////////
 
-	template <typename Key, typename Value>
-	class FlatBinaryTreeMap<Key, Value>::NodeAdapter
+	template <typename Key, typename Value, typename AllocatorType>
+	class FlatBinaryTreeMap<Key, Value, AllocatorType>::NodeAdapter
 	{
 	private:
 		Entry* entries;
@@ -216,30 +222,30 @@ namespace XLib
 		inline NodeAdapter(Entry* entries, uint32 entryCount) : entries(entries), entryCount(entryCount) { XAssert(entryCount < NodeRefMask); }
 	};
 
-	template <typename Key, typename Value>
-	inline auto FlatBinaryTreeMap<Key, Value>::NodeAdapter::getNodeParent(NodeRef node) const -> NodeRef
+	template <typename Key, typename Value, typename AllocatorType>
+	inline auto FlatBinaryTreeMap<Key, Value, AllocatorType>::NodeAdapter::getNodeParent(NodeRef node) const -> NodeRef
 	{
 		XAssert(node < entryCount);
 		return NodeRef(entries[node].aux & NodeRefMask);
 	}
 
-	template <typename Key, typename Value>
-	inline auto FlatBinaryTreeMap<Key, Value>::NodeAdapter::getNodeChild(NodeRef node, uint8 childIndex) const -> NodeRef
+	template <typename Key, typename Value, typename AllocatorType>
+	inline auto FlatBinaryTreeMap<Key, Value, AllocatorType>::NodeAdapter::getNodeChild(NodeRef node, uint8 childIndex) const -> NodeRef
 	{
 		XAssert(childIndex < 2);
 		XAssert(node < entryCount);
 		return NodeRef((entries[node].aux >> (childIndex * 20 + 20)) & NodeRefMask);
 	}
 
-	template <typename Key, typename Value>
-	inline auto FlatBinaryTreeMap<Key, Value>::NodeAdapter::getNodeBalanceFactor(NodeRef node) const -> sint8
+	template <typename Key, typename Value, typename AllocatorType>
+	inline auto FlatBinaryTreeMap<Key, Value, AllocatorType>::NodeAdapter::getNodeBalanceFactor(NodeRef node) const -> sint8
 	{
 		XAssert(node < entryCount);
 		return NodeRef(((entries[node].aux >> 60) & 3) - 1);
 	}
 
-	template <typename Key, typename Value>
-	inline void FlatBinaryTreeMap<Key, Value>::NodeAdapter::setNodeParent(NodeRef node, NodeRef parentToSet)
+	template <typename Key, typename Value, typename AllocatorType>
+	inline void FlatBinaryTreeMap<Key, Value, AllocatorType>::NodeAdapter::setNodeParent(NodeRef node, NodeRef parentToSet)
 	{
 		XAssert(node < entryCount);
 		XAssert(parentToSet < entryCount || parentToSet == ZeroNodeRef);
@@ -247,8 +253,8 @@ namespace XLib
 		entries[node].aux |= parentToSet;
 	}
 
-	template <typename Key, typename Value>
-	inline void FlatBinaryTreeMap<Key, Value>::NodeAdapter::setNodeChild(NodeRef node, uint8 childIndex, NodeRef childToSet)
+	template <typename Key, typename Value, typename AllocatorType>
+	inline void FlatBinaryTreeMap<Key, Value, AllocatorType>::NodeAdapter::setNodeChild(NodeRef node, uint8 childIndex, NodeRef childToSet)
 	{
 		XAssert(childIndex < 2);
 		XAssert(node < entryCount);
@@ -258,8 +264,8 @@ namespace XLib
 		entries[node].aux |= childToSet << offset;
 	}
 
-	template <typename Key, typename Value>
-	inline void FlatBinaryTreeMap<Key, Value>::NodeAdapter::setNodeBalanceFactor(NodeRef node, sint8 balanceFactor)
+	template <typename Key, typename Value, typename AllocatorType>
+	inline void FlatBinaryTreeMap<Key, Value, AllocatorType>::NodeAdapter::setNodeBalanceFactor(NodeRef node, sint8 balanceFactor)
 	{
 		XAssert(node < entryCount);
 		XAssert(balanceFactor >= -1 && balanceFactor <= +1);
@@ -267,8 +273,8 @@ namespace XLib
 		entries[node].aux |= uint64(balanceFactor + 1) << 60;
 	}
 
-	template <typename Key, typename Value>
-	inline void FlatBinaryTreeMap<Key, Value>::NodeAdapter::
+	template <typename Key, typename Value, typename AllocatorType>
+	inline void FlatBinaryTreeMap<Key, Value, AllocatorType>::NodeAdapter::
 		setNodeFull(NodeRef node, NodeRef parent, NodeRef leftChild, NodeRef rightChild, sint8 balanceFactor)
 	{
 		XAssert(node < entryCount);
@@ -287,8 +293,8 @@ namespace XLib
 
 	// FlatBinaryTreeMap ///////////////////////////////////////////////////////////////////////////
 
-	template <typename Key, typename Value>
-	inline auto FlatBinaryTreeMap<Key, Value>::find(const Key& key) const -> Iterator
+	template <typename Key, typename Value, typename AllocatorType>
+	inline auto FlatBinaryTreeMap<Key, Value, AllocatorType>::find(const Key& key) const -> Iterator
 	{
 		if (!size)
 			return Iterator();
@@ -302,8 +308,8 @@ namespace XLib
 		return Iterator(this, foundNodeRef);
 	}
 
-	template <typename Key, typename Value>
-	inline auto FlatBinaryTreeMap<Key, Value>::findValue(const Key& key) const -> Value*
+	template <typename Key, typename Value, typename AllocatorType>
+	inline auto FlatBinaryTreeMap<Key, Value, AllocatorType>::findValue(const Key& key) const -> Value*
 	{
 		if (!size)
 			return nullptr;
@@ -317,8 +323,8 @@ namespace XLib
 		return &buffer[foundNodeRef].data.value;
 	}
 
-	template <typename Key, typename Value>
-	inline auto FlatBinaryTreeMap<Key, Value>::begin() const -> Iterator
+	template <typename Key, typename Value, typename AllocatorType>
+	inline auto FlatBinaryTreeMap<Key, Value, AllocatorType>::begin() const -> Iterator
 	{
 		if (!size)
 			return Iterator();
@@ -329,8 +335,8 @@ namespace XLib
 		return Iterator(this, beginNodeRef);
 	}
 
-	template <typename Key, typename Value>
-	inline auto FlatBinaryTreeMap<Key, Value>::end() const -> Iterator
+	template <typename Key, typename Value, typename AllocatorType>
+	inline auto FlatBinaryTreeMap<Key, Value, AllocatorType>::end() const -> Iterator
 	{
 		return Iterator();
 	}
@@ -338,14 +344,14 @@ namespace XLib
 
 	// FlatBinaryTreeMap::Iterator /////////////////////////////////////////////////////////////////
 
-	template <typename Key, typename Value>
-	inline void FlatBinaryTreeMap<Key, Value>::Iterator::operator ++ ()
+	template <typename Key, typename Value, typename AllocatorType>
+	inline void FlatBinaryTreeMap<Key, Value, AllocatorType>::Iterator::operator ++ ()
 	{
 		XAssertUnreachableCode();
 	}
 
-	template <typename Key, typename Value>
-	inline void FlatBinaryTreeMap<Key, Value>::Iterator::operator -- ()
+	template <typename Key, typename Value, typename AllocatorType>
+	inline void FlatBinaryTreeMap<Key, Value, AllocatorType>::Iterator::operator -- ()
 	{
 		XAssertUnreachableCode();
 	}
@@ -1,25 +1,555 @@
 #pragma once
 
+// `FlatHashMap` - open addressing hash map. Keys and values are stored inplace in single allocation.
+//	Slot state is tracked by separate array of control bytes that is probed 16 at a time with SSE2.
+//	Probing is linear, so erase shifts following entries back instead of leaving tombstones.
+
+// TODO: AVX2 32-wide groups?
+// TODO: `FlatHashSet`.
+
+#include <emmintrin.h>
+
 #include "XLib.h"
+#include "XLib.Allocation.h"
 #include "XLib.NonCopyable.h"
+#include "XLib.String.h"
 
 namespace XLib
 {
-	template <typename KeyType, typename ValueType>
-	class FlatHashMap : public NonCopyable
+	class HashMapHashing abstract final
+	{
+	public:
+		static inline uint64 MixU64(uint64 value);
+		static inline uint64 ComputeBytes(const void* data, uintptr size);
+	};
+
+	// Key traits template:
+	//
+	//	class MyKeyTraits abstract final
+	//	{
+	//	public:
+	//		static uint64 Hash(const MyKey& key);
+	//		static uint64 Hash(const SomeOtherKey& key);
+	//		static bool IsEqual(const MyKey& left, const MyKey& right);
+	//		static bool IsEqual(const MyKey& left, const SomeOtherKey& right);
+	//	};
+	//
+	// Hashes of equal keys must be equal for all lookup key types.
+
+	template <typename KeyType>
+	class HashMapKeyTraits abstract final
+	{
+	public:
+		static inline uint64 Hash(const KeyType& key) { return HashMapHashing::MixU64(uint64(key)); }
+		static inline bool IsEqual(const KeyType& left, const KeyType& right) { return left == right; }
+	};
+
+	template <>
+	class HashMapKeyTraits<StringViewASCII> abstract final
+	{
+	public:
+		static inline uint64 Hash(const StringViewASCII& key) { return HashMapHashing::ComputeBytes(key.getData(), key.getLength()); }
+		static inline bool IsEqual(const StringViewASCII& left, const StringViewASCII& right) { return String::IsEqual(left, right); }
+	};
+
+	template <typename AllocatorType>
+	class HashMapKeyTraits<DynamicString<charASCII, AllocatorType>> abstract final
 	{
 	private:
-		struct Entry
+		using KeyType = DynamicString<charASCII, AllocatorType>;
+
+	public:
+		static inline uint64 Hash(const KeyType& key) { return HashMapHashing::ComputeBytes(key.getData(), key.getLength()); }
+		static inline uint64 Hash(const StringViewASCII& key) { return HashMapHashing::ComputeBytes(key.getData(), key.getLength()); }
+		static inline bool IsEqual(const KeyType& left, const KeyType& right) { return String::IsEqual(left.getView(), right.getView()); }
+		static inline bool IsEqual(const KeyType& left, const StringViewASCII& right) { return String::IsEqual(left.getView(), right); }
+	};
+
+
+	template <typename KeyType, typename ValueType,
+		typename KeyTraits = HashMapKeyTraits<KeyType>, typename AllocatorType = DefaultAllocator>
+	class FlatHashMap :
+		private AllocatorAdapterBase<AllocatorType>,
+		public NonCopyable
+	{
+	public:
+		struct KeyValuePair
 		{
 			KeyType key;
 			ValueType value;
 		};
 
+	private:
+		using AllocatorBase = AllocatorAdapterBase<AllocatorType>;
+
+		class Group;
+
+		static constexpr uint32 GroupSize = 16;
+		static constexpr uint32 MinCapacity = GroupSize;
+		static constexpr uint32 InvalidSlot = uint32(-1);
+
+		static constexpr uint8 CtrlEmpty = 0x80;
+
+		// Max load factor is 3/4. Probing is linear so clusters grow faster than with quadratic probing.
+		static inline uint32 CalculateGrowthLimit(uint32 capacity) { return capacity - capacity / 4; }
+		static inline uint32 CalculateCtrlBytesSize(uint32 capacity) { return alignUp<uint32>(capacity + GroupSize - 1, GroupSize); }
+
+		static inline uint32 H1(uint64 hash) { return uint32(hash >> 7); }
+		static inline uint8 H2(uint64 hash) { return uint8(hash & 0x7F); }
+
+	private:
+		uint8* ctrlBytes = nullptr;
+		KeyValuePair* slots = nullptr;
+		uint32 capacity = 0;
+		uint32 size = 0;
+
+	private:
+		inline void setCtrl(uint32 slot, uint8 ctrl);
+
+		template <typename LookupKeyType>
+		inline uint32 findSlot(const LookupKeyType& key, uint64 hash) const;
+		inline uint32 findEmptySlot(uint64 hash) const;
+
+		inline void rehash(uint32 newCapacity);
+		inline void ensureCapacityForInsert();
+		inline void eraseSlot(uint32 slot);
+
+	public:
+		class Iterator;
+
 	public:
 		FlatHashMap() = default;
-		~FlatHashMap() = default;
+		inline FlatHashMap(AllocatorType& allocator) : AllocatorBase(allocator) {}
+		inline ~FlatHashMap() { destroy(); }
+
+		inline FlatHashMap(FlatHashMap&& that);
+		inline void operator = (FlatHashMap&& that);
+
+		inline void destroy();
 
 		inline bool insert(const KeyType& key, const ValueType& value);
-		inline ValueType* find(const KeyType& key);
+
+		// Finds existing entry or inserts new one with default constructed value. Key is constructed from lookup key.
+		template <typename LookupKeyType>
+		inline ValueType& findOrInsert(const LookupKeyType& key, bool* outInserted = nullptr);
+
+		template <typename LookupKeyType>
+		inline ValueType* find(const LookupKeyType& key);
+		template <typename LookupKeyType>
+		inline const ValueType* find(const LookupKeyType& key) const;
+
+		template <typename LookupKeyType>
+		inline bool remove(const LookupKeyType& key);
+
+		inline void clear();
+		inline void reserve(uint32 requiredSize);
+
+		inline uint32 getSize() const { return size; }
+		inline uint32 getCapacity() const { return capacity; }
+		inline bool isEmpty() const { return size == 0; }
+
+		inline Iterator begin() const;
+		inline Iterator end() const { return Iterator(this, capacity); }
+	};
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	class FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::Iterator
+	{
+		friend FlatHashMap;
+
+	private:
+		const FlatHashMap* parent = nullptr;
+		uint32 slot = 0;
+
+	private:
+		inline Iterator(const FlatHashMap* parent, uint32 slot) : parent(parent), slot(slot) {}
+
+	public:
+		Iterator() = default;
+		~Iterator() = default;
+
+		inline void operator ++ ();
+
+		inline KeyValuePair& operator * () const { return parent->slots[slot]; }
+		inline KeyValuePair* operator -> () const { return &parent->slots[slot]; }
+		inline bool operator == (const Iterator& that) const { return parent == that.parent && slot == that.slot; }
+		inline bool operator != (const Iterator& that) const { return !this->operator==(that); }
+	};
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+
+namespace XLib
+{
+	// HashMapHashing //////////////////////////////////////////////////////////////////////////////
+
+	inline uint64 HashMapHashing::MixU64(uint64 value)
+	{
+		// SplitMix64 finalizer.
+		value ^= value >> 30;
+		value *= 0xBF58476D1CE4E5B9ull;
+		value ^= value >> 27;
+		value *= 0x94D049BB133111EBull;
+		value ^= value >> 31;
+		return value;
+	}
+
+	inline uint64 HashMapHashing::ComputeBytes(const void* data, uintptr size)
+	{
+		const byte* bytes = (const byte*)data;
+		uint64 hash = 0x9E3779B97F4A7C15ull ^ (uint64(size) * 0xFF51AFD7ED558CCDull);
+
+		while (size >= 8)
+		{
+			uint64 word = 0;
+			memoryCopy(&word, bytes, 8);
+			hash = (hash ^ MixU64(word)) * 0x9E3779B97F4A7C15ull;
+			bytes += 8;
+			size -= 8;
+		}
+
+		if (size > 0)
+		{
+			uint64 word = 0;
+			memoryCopy(&word, bytes, size);
+			hash = (hash ^ MixU64(word)) * 0x9E3779B97F4A7C15ull;
+		}
+
+		return MixU64(hash);
+	}
+
+
+	// FlatHashMap::Group //////////////////////////////////////////////////////////////////////////
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	class FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::Group
+	{
+	private:
+		__m128i ctrl;
+
+	public:
+		inline Group(const uint8* ctrlBytes) : ctrl(_mm_loadu_si128((const __m128i*)ctrlBytes)) {}
+
+		inline uint32 match(uint8 h2) const { return uint32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(char(h2)), ctrl))); }
+		inline uint32 matchEmpty() const { return uint32(_mm_movemask_epi8(ctrl)); }
 	};
+
+
+	// FlatHashMap /////////////////////////////////////////////////////////////////////////////////
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline void FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::setCtrl(const uint32 slot, const uint8 ctrl)
+	{
+		XAssert(slot < capacity);
+		ctrlBytes[slot] = ctrl;
+
+		// First `GroupSize - 1` control bytes are mirrored after the end, so group loads never wrap.
+		if (slot < GroupSize - 1)
+			ctrlBytes[capacity + slot] = ctrl;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	template <typename LookupKeyType>
+	inline uint32 FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::findSlot(const LookupKeyType& key, const uint64 hash) const
+	{
+		if (!size)
+			return InvalidSlot;
+
+		const uint32 slotIndexMask = capacity - 1;
+		const uint8 h2 = H2(hash);
+
+		// There is always at least one empty slot, so this terminates.
+		uint32 groupStartSlot = H1(hash) & slotIndexMask;
+		for (;;)
+		{
+			const Group group(ctrlBytes + groupStartSlot);
+			for (uint32 matchMask = group.match(h2); matchMask; matchMask &= matchMask - 1)
+			{
+				const uint32 slot = (groupStartSlot + countTrailingZeros32(matchMask)) & slotIndexMask;
+				if (KeyTraits::IsEqual(slots[slot].key, key))
+					return slot;
+			}
+
+			// Linear probing with backward shift erase keeps chains contiguous: empty slot ends the chain.
+			if (group.matchEmpty())
+				return InvalidSlot;
+
+			groupStartSlot = (groupStartSlot + GroupSize) & slotIndexMask;
+		}
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline uint32 FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::findEmptySlot(const uint64 hash) const
+	{
+		XAssert(size < capacity);
+
+		const uint32 slotIndexMask = capacity - 1;
+
+		uint32 groupStartSlot = H1(hash) & slotIndexMask;
+		for (;;)
+		{
+			const uint32 emptyMask = Group(ctrlBytes + groupStartSlot).matchEmpty();
+			if (emptyMask)
+				return (groupStartSlot + countTrailingZeros32(emptyMask)) & slotIndexMask;
+
+			groupStartSlot = (groupStartSlot + GroupSize) & slotIndexMask;
+		}
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline void FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::rehash(const uint32 newCapacity)
+	{
+		XAssert(newCapacity >= MinCapacity);
+		XAssert((newCapacity & (newCapacity - 1)) == 0);
+		XAssert(size <= CalculateGrowthLimit(newCapacity));
+
+		uint8* oldCtrlBytes = ctrlBytes;
+		KeyValuePair* oldSlots = slots;
+		const uint32 oldCapacity = capacity;
+
+		const uint32 ctrlBytesSize = CalculateCtrlBytesSize(newCapacity);
+		const uintptr slotsOffset = alignUp<uintptr>(ctrlBytesSize, alignof(KeyValuePair));
+		const uintptr memoryBlockSize = slotsOffset + uintptr(newCapacity) * sizeof(KeyValuePair);
+
+		void* memoryBlock = AllocatorBase::allocate(memoryBlockSize);
+		ctrlBytes = (uint8*)memoryBlock;
+		slots = (KeyValuePair*)(uintptr(memoryBlock) + slotsOffset);
+		capacity = newCapacity;
+
+		memorySet(ctrlBytes, CtrlEmpty, ctrlBytesSize);
+
+		if (!oldCtrlBytes)
+			return;
+
+		for (uint32 oldSlot = 0; oldSlot < oldCapacity; oldSlot++)
+		{
+			if (oldCtrlBytes[oldSlot] & CtrlEmpty)
+				continue;
+
+			KeyValuePair& oldEntry = oldSlots[oldSlot];
+			const uint64 hash = KeyTraits::Hash(oldEntry.key);
+			const uint32 newSlot = findEmptySlot(hash);
+
+			XConstruct(slots[newSlot], AsRValue(oldEntry));
+			XDestruct(oldEntry);
+			setCtrl(newSlot, H2(hash));
+		}
+
+		// Old slots live in the same block as old control bytes.
+		AllocatorBase::release(oldCtrlBytes);
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline void FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::ensureCapacityForInsert()
+	{
+		if (!capacity)
+			rehash(MinCapacity);
+		else if (size + 1 > CalculateGrowthLimit(capacity))
+			rehash(capacity * 2);
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline void FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::eraseSlot(const uint32 slot)
+	{
+		XAssert(slot < capacity);
+		XAssert(!(ctrlBytes[slot] & CtrlEmpty));
+
+		const uint32 slotIndexMask = capacity - 1;
+
+		XDestruct(slots[slot]);
+
+		// Backward shift: pull following chain entries into the hole if it does not move them before their home slot.
+		uint32 holeSlot = slot;
+		for (uint32 nextSlot = (slot + 1) & slotIndexMask; !(ctrlBytes[nextSlot] & CtrlEmpty); nextSlot = (nextSlot + 1) & slotIndexMask)
+		{
+			KeyValuePair& nextEntry = slots[nextSlot];
+			const uint32 homeSlot = H1(KeyTraits::Hash(nextEntry.key)) & slotIndexMask;
+
+			const uint32 nextEntryProbeDistance = (nextSlot - homeSlot) & slotIndexMask;
+			const uint32 holeToNextDistance = (nextSlot - holeSlot) & slotIndexMask;
+			if (nextEntryProbeDistance < holeToNextDistance)
+				continue;
+
+			XConstruct(slots[holeSlot], AsRValue(nextEntry));
+			XDestruct(nextEntry);
+			setCtrl(holeSlot, ctrlBytes[nextSlot]);
+			holeSlot = nextSlot;
+		}
+
+		setCtrl(holeSlot, CtrlEmpty);
+		size--;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::FlatHashMap(FlatHashMap&& that)
+	{
+		AllocatorBase::inheritAllocator(that);
+
+		ctrlBytes = that.ctrlBytes;
+		slots = that.slots;
+		capacity = that.capacity;
+		size = that.size;
+
+		that.ctrlBytes = nullptr;
+		that.slots = nullptr;
+		that.capacity = 0;
+		that.size = 0;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline void FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::operator = (FlatHashMap&& that)
+	{
+		destroy();
+
+		AllocatorBase::inheritAllocator(that);
+
+		ctrlBytes = that.ctrlBytes;
+		slots = that.slots;
+		capacity = that.capacity;
+		size = that.size;
+
+		that.ctrlBytes = nullptr;
+		that.slots = nullptr;
+		that.capacity = 0;
+		that.size = 0;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline void FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::destroy()
+	{
+		if (ctrlBytes)
+		{
+			clear();
+			AllocatorBase::release(ctrlBytes);
+		}
+
+		ctrlBytes = nullptr;
+		slots = nullptr;
+		capacity = 0;
+		size = 0;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline bool FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::insert(const KeyType& key, const ValueType& value)
+	{
+		const uint64 hash = KeyTraits::Hash(key);
+		if (findSlot(key, hash) != InvalidSlot)
+			return false;
+
+		ensureCapacityForInsert();
+
+		const uint32 slot = findEmptySlot(hash);
+		KeyValuePair& entry = slots[slot];
+		XConstruct(entry.key, key);
+		XConstruct(entry.value, value);
+		setCtrl(slot, H2(hash));
+		size++;
+
+		return true;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	template <typename LookupKeyType>
+	inline ValueType& FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::findOrInsert(const LookupKeyType& key, bool* outInserted)
+	{
+		const uint64 hash = KeyTraits::Hash(key);
+		const uint32 existingSlot = findSlot(key, hash);
+		if (existingSlot != InvalidSlot)
+		{
+			if (outInserted)
+				*outInserted = false;
+			return slots[existingSlot].value;
+		}
+
+		ensureCapacityForInsert();
+
+		const uint32 slot = findEmptySlot(hash);
+		KeyValuePair& entry = slots[slot];
+		XConstruct(entry.key, key);
+		XConstruct(entry.value);
+		setCtrl(slot, H2(hash));
+		size++;
+
+		if (outInserted)
+			*outInserted = true;
+		return entry.value;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	template <typename LookupKeyType>
+	inline ValueType* FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::find(const LookupKeyType& key)
+	{
+		const uint32 slot = findSlot(key, KeyTraits::Hash(key));
+		return slot == InvalidSlot ? nullptr : &slots[slot].value;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	template <typename LookupKeyType>
+	inline const ValueType* FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::find(const LookupKeyType& key) const
+	{
+		const uint32 slot = findSlot(key, KeyTraits::Hash(key));
+		return slot == InvalidSlot ? nullptr : &slots[slot].value;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	template <typename LookupKeyType>
+	inline bool FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::remove(const LookupKeyType& key)
+	{
+		const uint32 slot = findSlot(key, KeyTraits::Hash(key));
+		if (slot == InvalidSlot)
+			return false;
+
+		eraseSlot(slot);
+		return true;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline void FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::clear()
+	{
+		if (!ctrlBytes)
+			return;
+
+		for (uint32 slot = 0; slot < capacity; slot++)
+		{
+			if (!(ctrlBytes[slot] & CtrlEmpty))
+				XDestruct(slots[slot]);
+		}
+
+		memorySet(ctrlBytes, CtrlEmpty, CalculateCtrlBytesSize(capacity));
+		size = 0;
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline void FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::reserve(const uint32 requiredSize)
+	{
+		uint32 newCapacity = max<uint32>(capacity, MinCapacity);
+		while (CalculateGrowthLimit(newCapacity) < requiredSize)
+			newCapacity *= 2;
+
+		if (newCapacity != capacity)
+			rehash(newCapacity);
+	}
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline auto FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::begin() const -> Iterator
+	{
+		Iterator it(this, 0);
+		if (capacity && (ctrlBytes[0] & CtrlEmpty))
+			++it;
+		return it;
+	}
+
+
+	// FlatHashMap::Iterator ///////////////////////////////////////////////////////////////////////
+
+	template <typename KeyType, typename ValueType, typename KeyTraits, typename AllocatorType>
+	inline void FlatHashMap<KeyType, ValueType, KeyTraits, AllocatorType>::Iterator::operator ++ ()
+	{
+		XAssert(slot < parent->capacity);
+		do
+			slot++;
+		while (slot < parent->capacity && (parent->ctrlBytes[slot] & CtrlEmpty));
+	}
 }
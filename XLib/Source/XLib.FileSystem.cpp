@@ -5,6 +5,8 @@
 #include "XLib.FileSystem.h"
 
 #include "XLib.Path.h"
+#include "XLib.System.Threading.h"
+#include "XLib.System.Threading.Atomics.h"
 
 using namespace XLib;
 
@@ -17,6 +19,30 @@ FileSystemOpStatus FileSystem::RemoveFile(const char* pathCStr)
 	return FileSystemOpStatus::Failure;
 }
 
+FileSystemOpStatus FileSystem::RenameFile(const char* srcPathCStr, const char* dstPathCStr, bool replaceExisting)
+{
+	if (MoveFileExA(srcPathCStr, dstPathCStr, replaceExisting ? MOVEFILE_REPLACE_EXISTING : 0))
+		return FileSystemOpStatus::Success;
+
+	// TODO: Do `GetLastError()` and stuff.
+	return FileSystemOpStatus::Failure;
+}
+
+FileSystemOpStatus FileSystem::TouchFile(const char* pathCStr)
+{
+	const HANDLE hFile = CreateFileA(pathCStr, FILE_WRITE_ATTRIBUTES,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return FileSystemOpStatus::Failure;
+
+	FILETIME currentTime = {};
+	GetSystemTimeAsFileTime(&currentTime);
+	const BOOL result = SetFileTime(hFile, nullptr, nullptr, &currentTime);
+	CloseHandle(hFile);
+
+	return result ? FileSystemOpStatus::Success : FileSystemOpStatus::Failure;
+}
+
 #if 0
 FileSystemOpResult<bool> FileSystem::FileExists(const char* pathCStr)
 {
@@ -103,3 +129,119 @@ TimePoint FileSystem::GetFileModificationTime(const char* pathCStr)
 	const uint64 modificationTime = (uint64(winFileAttributeData.ftLastWriteTime.dwHighDateTime) << 32) | uint64(winFileAttributeData.ftLastWriteTime.dwLowDateTime);
 	return TimePoint(modificationTime);
 }
+
+namespace
+{
+	struct FileModificationTimesQuery
+	{
+		const char* const* pathCStrs;
+		TimePoint* resultModTimes;
+		uint32 count;
+		Atomic<uint32> nextIndex;
+	};
+}
+
+static void ProcessFileModificationTimesQuery(FileModificationTimesQuery& query)
+{
+	for (;;)
+	{
+		const uint32 index = query.nextIndex.increment() - 1;
+		if (index >= query.count)
+			break;
+		query.resultModTimes[index] = FileSystem::GetFileModificationTime(query.pathCStrs[index]);
+	}
+}
+
+static uint32 __stdcall FileModificationTimesQueryThreadMain(FileModificationTimesQuery* query)
+{
+	ProcessFileModificationTimesQuery(*query);
+	return 0;
+}
+
+void FileSystem::GetFileModificationTimes(const char* const* pathCStrs, TimePoint* resultModTimes, uint32 count, uint16 threadCount)
+{
+	static constexpr uint16 MaxThreadCount = 64; // Limited by `Thread::WaitAll`.
+	static constexpr uint32 MinFileCountPerThread = 16; // Thread startup is not free.
+
+	if (!threadCount)
+		threadCount = uint16(min<uint32>(Thread::GetLogicalCoreCount() * 2, MaxThreadCount));
+	threadCount = uint16(min<uint32>(threadCount, MaxThreadCount));
+	threadCount = uint16(min<uint32>(threadCount, count / MinFileCountPerThread));
+
+	FileModificationTimesQuery query = {};
+	query.pathCStrs = pathCStrs;
+	query.resultModTimes = resultModTimes;
+	query.count = count;
+	query.nextIndex.store(0);
+
+	// Calling thread is one of the workers.
+	Thread threads[MaxThreadCount];
+	const uint16 extraThreadCount = threadCount > 1 ? threadCount - 1 : 0;
+	for (uint16 i = 0; i < extraThreadCount; i++)
+		threads[i].create(&FileModificationTimesQueryThreadMain, &query);
+
+	ProcessFileModificationTimesQuery(query);
+
+	if (extraThreadCount)
+		Thread::WaitAll(threads, extraThreadCount);
+}
+
+static FileSystemOpStatus EnumerateFilesRecursiveImpl(InplaceStringASCIIx2048& dirPath, FileSystemEnumerationCallback callback, void* context)
+{
+	const uint16 dirPathLength = dirPath.getLength();
+	dirPath.append('*');
+
+	WIN32_FIND_DATAA winFindData = {};
+	const HANDLE hFind = FindFirstFileExA(dirPath.getCStr(), FindExInfoBasic, &winFindData, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+	dirPath.truncate(dirPathLength);
+	if (hFind == INVALID_HANDLE_VALUE)
+		return GetLastError() == ERROR_FILE_NOT_FOUND ? FileSystemOpStatus::Success : FileSystemOpStatus::Failure;
+
+	FileSystemOpStatus status = FileSystemOpStatus::Success;
+	do
+	{
+		const StringViewASCII fileName = StringViewASCII::FromCStr(winFindData.cFileName);
+		if (fileName == StringViewASCII::FromCStr(".") || fileName == StringViewASCII::FromCStr(".."))
+			continue;
+
+		if (dirPathLength + fileName.getLength() + 2 > InplaceStringASCIIx2048::GetMaxLength())
+		{
+			status = FileSystemOpStatus::Failure;
+			continue;
+		}
+
+		dirPath.append(fileName);
+
+		if (winFindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			dirPath.append('\\');
+			if (EnumerateFilesRecursiveImpl(dirPath, callback, context) != FileSystemOpStatus::Success)
+				status = FileSystemOpStatus::Failure;
+		}
+		else
+		{
+			FileSystemEnumeratedFile file = {};
+			file.path = dirPath;
+			file.size = (uint64(winFindData.nFileSizeHigh) << 32) | uint64(winFindData.nFileSizeLow);
+			file.modificationTime = (uint64(winFindData.ftLastWriteTime.dwHighDateTime) << 32) | uint64(winFindData.ftLastWriteTime.dwLowDateTime);
+			callback(context, file);
+		}
+
+		dirPath.truncate(dirPathLength);
+	}
+	while (FindNextFileA(hFind, &winFindData));
+
+	FindClose(hFind);
+	return status;
+}
+
+FileSystemOpStatus FileSystem::EnumerateFilesRecursive(const char* dirPathCStr, FileSystemEnumerationCallback callback, void* context)
+{
+	InplaceStringASCIIx2048 dirPath;
+	Path::MakeAbsolute(dirPathCStr, dirPath);
+	Path::AddTrailingDirectorySeparator(dirPath);
+	if (dirPath.isFull())
+		return FileSystemOpStatus::Failure;
+
+	return EnumerateFilesRecursiveImpl(dirPath, callback, context);
+}
@@ -33,6 +33,15 @@ namespace XLib
 		FileSystemOpStatus status;
 	};
 
+	struct FileSystemEnumeratedFile
+	{
+		StringViewASCII path; // Valid only during callback.
+		uint64 size;
+		TimePoint modificationTime;
+	};
+
+	using FileSystemEnumerationCallback = void(*)(void* context, const FileSystemEnumeratedFile& file);
+
 	class FileSystem abstract final
 	{
 	public:
@@ -50,11 +59,25 @@ namespace XLib
 		static FileSystemOpStatus RemoveFile(const char* pathCStr);
 		static FileSystemOpStatus RemoveDir(const char* pathCStr);
 
+		// Rename is atomic if both paths are on the same volume.
+		static FileSystemOpStatus RenameFile(const char* srcPathCStr, const char* dstPathCStr, bool replaceExisting = false);
+
+		// Sets file modification time to current time.
+		static FileSystemOpStatus TouchFile(const char* pathCStr);
+
 		static FileSystemOpStatus CreateDirSingle(const char* pathCStr);
 		static FileSystemOpStatus CreateDirRecursive(const char* pathCStr);
 		static FileSystemOpStatus CreateDirRecursive(StringViewASCII path);
 
 		static TimePoint GetFileModificationTime(const char* pathCStr);
+
+		// Queries modification times of many files concurrently on a pool of short-lived threads.
+		// Calling thread takes part in the work. InvalidTimePoint is returned for files that can not be queried.
+		// Zero thread count means twice the logical core count, as the work is I/O bound.
+		static void GetFileModificationTimes(const char* const* pathCStrs, TimePoint* resultModTimes, uint32 count, uint16 threadCount = 0);
+
+		// Size and modification time come from directory listing, so files are not opened.
+		static FileSystemOpStatus EnumerateFilesRecursive(const char* dirPathCStr, FileSystemEnumerationCallback callback, void* context);
 	};
 }
 
@@ -7,27 +7,51 @@ static const char HexCharLUT[] = "0123456789ABCDEF";
 template <typename UIntT>
 static inline FmtFormatResult FmtFormatDecUXX(UIntT value, char* buffer, uint8 bufferSize, uint8 lzWidth)
 {
-	char internalBuffer[24];
-	lzWidth = min<uint8>(lzWidth, countOf(internalBuffer));
-
-	uint8 digitCount = 0;
-	do
+	static constexpr uint64 Pow10LUT[] =
 	{
-		internalBuffer[digitCount] = value % 10 + '0';
-		value /= 10;
-		digitCount++;
-	} while (value);
+		1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+		10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+		1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull,
+	};
 
-	for (; digitCount < lzWidth; digitCount++)
-		internalBuffer[digitCount] = '0';
+	uint8 digitCount = 1;
+	while (digitCount < countOf(Pow10LUT) && uint64(value) >= Pow10LUT[digitCount])
+		digitCount++;
 
-	if (digitCount > bufferSize)
+	const uint8 charCount = max<uint8>(digitCount, lzWidth);
+	if (charCount > bufferSize)
 		return FmtFormatResult { FmtFormatStatus::OutputBufferOverflow, 0 };
 
-	for (uint8 i = 0, j = digitCount - 1; i < digitCount; i++, j--)
-		buffer[i] = internalBuffer[j];
+	// Digits are written right to left, two at a time.
+	char* it = buffer + charCount;
+	while (value >= 100)
+	{
+		const char* pair = Internal::FmtDecDigitPairsLUT + uint32(value % 100) * 2;
+		value /= 100;
+		it -= 2;
+		it[0] = pair[0];
+		it[1] = pair[1];
+	}
+	if (value >= 10)
+	{
+		const char* pair = Internal::FmtDecDigitPairsLUT + uint32(value) * 2;
+		it -= 2;
+		it[0] = pair[0];
+		it[1] = pair[1];
+	}
+	else
+	{
+		it--;
+		*it = char('0' + value);
+	}
+
+	while (it != buffer)
+	{
+		it--;
+		*it = '0';
+	}
 
-	return FmtFormatResult { FmtFormatStatus::Success, digitCount };
+	return FmtFormatResult { FmtFormatStatus::Success, charCount };
 }
 
 template <typename SIntT, typename UIntT>
@@ -66,27 +90,116 @@ static inline FmtFormatResult FmtFormatDecSXX(SIntT value, char* buffer, uint8 b
 template <typename UIntT>
 static inline FmtFormatResult FmtFormatHexXX(UIntT value, char* buffer, uint8 bufferSize, uint8 lzWidth)
 {
-	char internalBuffer[16];
-	lzWidth = min<uint8>(lzWidth, countOf(internalBuffer));
+	uint8 digitCount = 1;
+	for (UIntT i = value >> 4; i; i >>= 4)
+		digitCount++;
 
-	uint8 digitCount = 0;
-	do
+	const uint8 charCount = max<uint8>(digitCount, lzWidth);
+	if (charCount > bufferSize)
+		return FmtFormatResult { FmtFormatStatus::OutputBufferOverflow, 0 };
+
+	char* it = buffer + charCount;
+	for (uint8 i = 0; i < digitCount; i++)
 	{
-		internalBuffer[digitCount] = HexCharLUT[value & 0xF];
+		it--;
+		*it = HexCharLUT[value & 0xF];
 		value >>= 4;
-		digitCount++;
-	} while (value);
+	}
 
-	for (; digitCount < lzWidth; digitCount++)
-		internalBuffer[digitCount] = '0';
+	while (it != buffer)
+	{
+		it--;
+		*it = '0';
+	}
 
-	if (digitCount > bufferSize)
-		return FmtFormatResult { FmtFormatStatus::OutputBufferOverflow, 0 };
+	return FmtFormatResult { FmtFormatStatus::Success, charCount };
+}
+
+// Parse functions consume longest digit run (up to 255 chars) and report its length, so callers
+// check `parsedCharCount` to require whole input to be number.
+
+template <typename UIntT>
+static inline FmtParseResult FmtParseDecUXX(const char* chars, uintptr charCount, UIntT& resultValue)
+{
+	const uintptr maxCharCount = min<uintptr>(charCount, 255);
+
+	UIntT value = 0;
+	bool overflow = false;
+	uintptr i = 0;
+	for (; i < maxCharCount && Char::IsDigit(chars[i]); i++)
+	{
+		const UIntT digit = UIntT(chars[i] - '0');
+		overflow |= value > (UIntT(-1) - digit) / 10;
+		value = UIntT(value * 10 + digit);
+	}
+
+	if (i == 0)
+		return FmtParseResult { FmtParseStatus::InvalidFormat, 0 };
+	if (overflow)
+		return FmtParseResult { FmtParseStatus::OutOfRange, uint8(i) };
+
+	resultValue = value;
+	return FmtParseResult { FmtParseStatus::Success, uint8(i) };
+}
+
+template <typename SIntT, typename UIntT>
+static inline FmtParseResult FmtParseDecSXX(const char* chars, uintptr charCount, SIntT& resultValue, bool allowPlus)
+{
+	uint8 signCharCount = 0;
+	bool isNegative = false;
+	if (charCount > 0 && (chars[0] == '-' || (allowPlus && chars[0] == '+')))
+	{
+		isNegative = chars[0] == '-';
+		signCharCount = 1;
+	}
+
+	UIntT absValue = 0;
+	FmtParseResult result = FmtParseDecUXX<UIntT>(chars + signCharCount, min<uintptr>(charCount - signCharCount, 254), absValue);
+	if (result.status == FmtParseStatus::InvalidFormat)
+		return result;
+	result.parsedCharCount += signCharCount;
+
+	// Magnitude of minimal value is one more than of maximal.
+	const UIntT maxAbsValue = UIntT(UIntT(-1) >> 1) + (isNegative ? 1 : 0);
+	if (result.status == FmtParseStatus::OutOfRange || absValue > maxAbsValue)
+		return FmtParseResult { FmtParseStatus::OutOfRange, result.parsedCharCount };
+
+	resultValue = isNegative ? SIntT(UIntT(0) - absValue) : SIntT(absValue);
+	return result;
+}
+
+template <typename UIntT>
+static inline FmtParseResult FmtParseHexXX(const char* chars, uintptr charCount, UIntT& resultValue)
+{
+	const uintptr maxCharCount = min<uintptr>(charCount, 255);
+
+	UIntT value = 0;
+	bool overflow = false;
+	uintptr i = 0;
+	for (; i < maxCharCount; i++)
+	{
+		const char c = chars[i];
+		uint8 digit = 0;
+		if (c >= '0' && c <= '9')
+			digit = c - '0';
+		else if (c >= 'A' && c <= 'F')
+			digit = c - 'A' + 10;
+		else if (c >= 'a' && c <= 'f')
+			digit = c - 'a' + 10;
+		else
+			break;
+
+		overflow |= (value >> (sizeof(UIntT) * 8 - 4)) != 0;
+		value = UIntT((value << 4) | digit);
+	}
 
-	for (uint8 i = 0, j = digitCount - 1; i < digitCount; i++, j--)
-		buffer[i] = internalBuffer[j];
+	if (i == 0)
+		return FmtParseResult { FmtParseStatus::InvalidFormat, 0 };
+	if (overflow)
+		return FmtParseResult { FmtParseStatus::OutOfRange, uint8(i) };
 
-	return FmtFormatResult { FmtFormatStatus::Success, digitCount };
+	resultValue = value;
+	return FmtParseResult { FmtParseStatus::Success, uint8(i) };
 }
 
 
@@ -153,3 +266,66 @@ FmtFormatResult XLib::FmtFormatHex64(uint64 value, char* buffer, uint8 bufferSiz
 {
 	return FmtFormatHexXX<uint64>(value, buffer, bufferSize, lzWidth);
 }
+
+
+FmtParseResult XLib::FmtParseDecU8(const char* chars, uintptr charCount, uint8& resultValue)
+{
+	return FmtParseDecUXX<uint8>(chars, charCount, resultValue);
+}
+
+FmtParseResult XLib::FmtParseDecU16(const char* chars, uintptr charCount, uint16& resultValue)
+{
+	return FmtParseDecUXX<uint16>(chars, charCount, resultValue);
+}
+
+FmtParseResult XLib::FmtParseDecU32(const char* chars, uintptr charCount, uint32& resultValue)
+{
+	return FmtParseDecUXX<uint32>(chars, charCount, resultValue);
+}
+
+FmtParseResult XLib::FmtParseDecU64(const char* chars, uintptr charCount, uint64& resultValue)
+{
+	return FmtParseDecUXX<uint64>(chars, charCount, resultValue);
+}
+
+
+FmtParseResult XLib::FmtParseDecS8(const char* chars, uintptr charCount, sint8& resultValue, bool allowPlus)
+{
+	return FmtParseDecSXX<sint8, uint8>(chars, charCount, resultValue, allowPlus);
+}
+
+FmtParseResult XLib::FmtParseDecS16(const char* chars, uintptr charCount, sint16& resultValue, bool allowPlus)
+{
+	return FmtParseDecSXX<sint16, uint16>(chars, charCount, resultValue, allowPlus);
+}
+
+FmtParseResult XLib::FmtParseDecS32(const char* chars, uintptr charCount, sint32& resultValue, bool allowPlus)
+{
+	return FmtParseDecSXX<sint32, uint32>(chars, charCount, resultValue, allowPlus);
+}
+
+FmtParseResult XLib::FmtParseDecS64(const char* chars, uintptr charCount, sint64& resultValue, bool allowPlus)
+{
+	return FmtParseDecSXX<sint64, uint64>(chars, charCount, resultValue, allowPlus);
+}
+
+
+FmtParseResult XLib::FmtParseHex8(const char* chars, uintptr charCount, uint8& resultValue)
+{
+	return FmtParseHexXX<uint8>(chars, charCount, resultValue);
+}
+
+FmtParseResult XLib::FmtParseHex16(const char* chars, uintptr charCount, uint16& resultValue)
+{
+	return FmtParseHexXX<uint16>(chars, charCount, resultValue);
+}
+
+FmtParseResult XLib::FmtParseHex32(const char* chars, uintptr charCount, uint32& resultValue)
+{
+	return FmtParseHexXX<uint32>(chars, charCount, resultValue);
+}
+
+FmtParseResult XLib::FmtParseHex64(const char* chars, uintptr charCount, uint64& resultValue)
+{
+	return FmtParseHexXX<uint64>(chars, charCount, resultValue);
+}
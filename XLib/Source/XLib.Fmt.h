@@ -21,6 +21,13 @@ namespace XLib
 		Exp,
 	};
 
+	namespace Internal
+	{
+		inline constexpr char FmtDecDigitPairsLUT[] =
+			"0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+			"5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+	}
+
 	// Fmt format //////////////////////////////////////////////////////////////////////////////////
 
 	enum class FmtFormatStatus : uint8
@@ -50,6 +57,10 @@ namespace XLib
 	FmtFormatResult FmtFormatHex32(uint32 value, char* buffer, uint8 bufferSize, uint8 lzWidth = 6);
 	FmtFormatResult FmtFormatHex64(uint64 value, char* buffer, uint8 bufferSize, uint8 lzWidth = 8);
 
+	// `prec` limits number of significant digits (correctly rounded). In fixed mode it is number of
+	// fraction digits instead, and fraction is padded with zeros up to it. Zero gives shortest digits
+	// that parse back to the same value. Generic mode uses exponent notation outside of [1e-6, 1e21).
+	// `lzWidth` is minimal total char count, leading zeros are inserted after sign.
 	// TODO: show plus?
 	FmtFormatResult FmtFormatDecFP32(float32 value, char* buffer, uint8 bufferSize, uint8 prec, FmtFPMode mode = FmtFPMode::Generic, uint8 lzWidth = 0);
 	FmtFormatResult FmtFormatDecFP64(float64 value, char* buffer, uint8 bufferSize, uint8 prec, FmtFPMode mode = FmtFPMode::Generic, uint8 lzWidth = 0);
@@ -61,6 +72,7 @@ namespace XLib
 	{
 		Success = 0,
 		OutOfRange,
+		InvalidFormat,
 	};
 
 	struct FmtParseResult
@@ -84,6 +96,8 @@ namespace XLib
 	FmtParseResult FmtParseHex32(const char* chars, uintptr charCount, uint32& resultValue);
 	FmtParseResult FmtParseHex64(const char* chars, uintptr charCount, uint64& resultValue);
 
+	// Correctly rounded. Accepts `[+-]digits[.digits][(e|E)[+-]digits]`, `inf` and `nan`, up to 255
+	// characters. Overflow gives infinity with `OutOfRange` status.
 	FmtParseResult FmtParseDecFP32(const char* chars, uintptr charCount, float32& resultValue);
 	FmtParseResult FmtParseDecFP64(const char* chars, uintptr charCount, float64& resultValue);
 
@@ -112,18 +126,65 @@ namespace XLib
 	// Fmt get /////////////////////////////////////////////////////////////////////////////////////
 
 	//void FmtGetDecU32();
-	//void FmtGetDecFP32();
-	//void FmtGetDecFP64();
+	// Reads characters that may belong to number, then parses them. Returns false if not all of
+	// them were parsed or value is out of range.
+	template <typename CharStreamReader> inline bool FmtGetDecFP32(CharStreamReader& reader, float32& resultValue);
+	template <typename CharStreamReader> inline bool FmtGetDecFP64(CharStreamReader& reader, float64& resultValue);
 	template <typename CharStreamReader> inline void FmtGetLine(CharStreamReader& reader, VirtualStringRefASCII resultString);
 	template <typename CharStreamReader> inline void FmtSkipToNewLine(CharStreamReader& reader);
 	template <typename CharStreamReader> inline void FmtSkipWhitespaces(CharStreamReader& reader);
 
 
+	// Fmt format string ///////////////////////////////////////////////////////////////////////////
+
+	enum class FmtArgType : uint8
+	{
+		Default = 0,
+		Hex,	// `x`, integers only.
+		Fixed,	// `f`, floats only.
+		Exp,	// `e`, floats only.
+	};
+
+	struct FmtArgSpec
+	{
+		uint16 literalOffset; // Literal text preceding argument.
+		uint16 literalLength;
+		uint8 width;
+		uint8 prec;
+		FmtArgType type;
+		bool zeroPad;
+	};
+
+	// Format string parsed at compile time. Placeholder is `{}` or `{:[0][width][.prec][x|f|e]}`,
+	// `{{` and `}}` are literal braces. Width is total field width and pads with spaces (numbers are
+	// right aligned, strings left aligned), `0` pads numbers with zeros after sign instead. Precision
+	// is number of fraction digits for `f` and number of significant digits otherwise.
+	template <uintptr Size>
+	struct FmtFormatString
+	{
+		static constexpr uint16 MaxArgCount = uint16(Size / 2 + 1);
+
+		char literalChars[Size] = {};
+		FmtArgSpec argSpecs[MaxArgCount] = {};
+		uint16 argCount = 0;
+		uint16 trailingLiteralOffset = 0;
+		uint16 trailingLiteralLength = 0;
+		uint16 literalCharCount = 0;
+
+		consteval FmtFormatString(const char (&string)[Size]);
+	};
+
+
 	// Fmt print ///////////////////////////////////////////////////////////////////////////////////
 
+	// Writers that implement `reserve` / `commit` get whole print formatted straight into their
+	// buffer: maximum output length is computed first (it is compile-time constant unless strings are
+	// printed), then all arguments are written into single reserved span.
+
 	template <typename CharStreamWriter, typename ... FmtArgs>
 	inline void FmtPrint(CharStreamWriter& writer, const FmtArgs& ... args);
 
+	// Prints to `GetThreadStdOutStream`, see `IsStdOutConsole` for when it is flushed.
 	template <typename ... FmtArgs>
 	inline void FmtPrintStdOut(const FmtArgs& ... fmtArgs);
 
@@ -136,6 +197,15 @@ namespace XLib
 	template <typename ... FmtArgs>
 	inline void FmtPrintStr(VirtualStringRefASCII string, const FmtArgs& ... fmtArgs);
 
+	template <FmtFormatString Format, typename CharStreamWriter, typename ... FmtArgs>
+	inline void FmtPrintF(CharStreamWriter& writer, const FmtArgs& ... args);
+
+	template <FmtFormatString Format, typename ... FmtArgs>
+	inline void FmtPrintFStdOut(const FmtArgs& ... fmtArgs);
+
+	template <FmtFormatString Format, typename ... FmtArgs>
+	inline void FmtPrintFStr(VirtualStringRefASCII string, const FmtArgs& ... fmtArgs);
+
 
 	// Fmt print arguments /////////////////////////////////////////////////////////////////////////
 
@@ -285,6 +355,9 @@ namespace XLib
 	template <typename CharStreamWriter> inline void FmtPrintArgPut(CharStreamWriter& writer, FmtArgHex16 arg)	{ FmtPutHex16(writer, arg.value, arg.lzWidth); }
 	template <typename CharStreamWriter> inline void FmtPrintArgPut(CharStreamWriter& writer, FmtArgHex32 arg)	{ FmtPutHex32(writer, arg.value, arg.lzWidth); }
 	template <typename CharStreamWriter> inline void FmtPrintArgPut(CharStreamWriter& writer, FmtArgHex64 arg)	{ FmtPutHex64(writer, arg.value, arg.lzWidth); }
+
+	template <typename CharStreamWriter> inline void FmtPrintArgPut(CharStreamWriter& writer, FmtArgFP32 arg)	{ FmtPutDecFP32(writer, arg.value); }
+	template <typename CharStreamWriter> inline void FmtPrintArgPut(CharStreamWriter& writer, FmtArgFP64 arg)	{ FmtPutDecFP64(writer, arg.value); }
 }
 
 
@@ -390,6 +463,87 @@ inline void XLib::FmtPutHex64(CharStreamWriter& writer, uint64 value, uint8 lzWi
 }
 
 
+template <typename CharStreamWriter>
+inline void XLib::FmtPutDecFP32(CharStreamWriter& writer, float32 value)
+{
+	char buffer[32];
+	const FmtFormatResult formatResult = FmtFormatDecFP32(value, buffer, sizeof(buffer), 0);
+	writer.write(buffer, formatResult.formattedCharCount);
+}
+
+template <typename CharStreamWriter>
+inline void XLib::FmtPutDecFP64(CharStreamWriter& writer, float64 value)
+{
+	char buffer[32];
+	const FmtFormatResult formatResult = FmtFormatDecFP64(value, buffer, sizeof(buffer), 0);
+	writer.write(buffer, formatResult.formattedCharCount);
+}
+
+
+namespace XLib::Internal
+{
+	template <typename CharStreamReader>
+	inline uint8 FmtGetFPChars(CharStreamReader& reader, char* buffer, uint8 bufferSize)
+	{
+		uint8 charCount = 0;
+		bool dotFound = false;
+		bool exponentFound = false;
+		bool isWord = false;
+
+		while (charCount < bufferSize && !reader.isEndOfStream())
+		{
+			const char c = reader.peek();
+			const char prevC = charCount > 0 ? buffer[charCount - 1] : 0;
+
+			bool accept = false;
+			if (isWord)
+				accept = Char::IsLetter(c);
+			else if (Char::IsDigit(c))
+				accept = true;
+			else if (c == '+' || c == '-')
+				accept = charCount == 0 || prevC == 'e' || prevC == 'E';
+			else if (c == '.')
+				accept = !dotFound && !exponentFound;
+			else if (c == 'e' || c == 'E')
+				accept = !exponentFound && (Char::IsDigit(prevC) || prevC == '.');
+			else if (c == 'i' || c == 'n')
+			{
+				// `inf` or `nan`.
+				accept = charCount == 0 || prevC == '+' || prevC == '-';
+				isWord = accept;
+			}
+
+			if (!accept)
+				break;
+
+			dotFound |= c == '.';
+			exponentFound |= !isWord && (c == 'e' || c == 'E');
+			buffer[charCount] = reader.get();
+			charCount++;
+		}
+		return charCount;
+	}
+}
+
+template <typename CharStreamReader>
+inline bool XLib::FmtGetDecFP32(CharStreamReader& reader, float32& resultValue)
+{
+	char buffer[255];
+	const uint8 charCount = Internal::FmtGetFPChars(reader, buffer, sizeof(buffer));
+	const FmtParseResult parseResult = FmtParseDecFP32(buffer, charCount, resultValue);
+	return parseResult.status == FmtParseStatus::Success && parseResult.parsedCharCount == charCount;
+}
+
+template <typename CharStreamReader>
+inline bool XLib::FmtGetDecFP64(CharStreamReader& reader, float64& resultValue)
+{
+	char buffer[255];
+	const uint8 charCount = Internal::FmtGetFPChars(reader, buffer, sizeof(buffer));
+	const FmtParseResult parseResult = FmtParseDecFP64(buffer, charCount, resultValue);
+	return parseResult.status == FmtParseStatus::Success && parseResult.parsedCharCount == charCount;
+}
+
+
 template <typename CharStreamReader>
 inline void XLib::FmtSkipToNewLine(CharStreamReader& reader)
 {
@@ -405,25 +559,357 @@ inline void XLib::FmtSkipWhitespaces(CharStreamReader& reader)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace XLib::Internal
+{
+	// Not defined. Calling it from `consteval` code makes compilation fail.
+	void FmtFormatStringSyntaxError(const char* message);
+}
+
+template <uintptr Size>
+consteval XLib::FmtFormatString<Size>::FmtFormatString(const char (&string)[Size])
+{
+	uint16 literalBegin = 0;
+	uintptr i = 0;
+	const uintptr length = (Size > 0 && string[Size - 1] == 0) ? Size - 1 : Size;
+
+	while (i < length)
+	{
+		const char c = string[i];
+		if ((c == '{' || c == '}') && i + 1 < length && string[i + 1] == c)
+		{
+			literalChars[literalCharCount++] = c;
+			i += 2;
+			continue;
+		}
+		if (c == '}')
+			Internal::FmtFormatStringSyntaxError("unmatched '}'");
+		if (c != '{')
+		{
+			literalChars[literalCharCount++] = c;
+			i++;
+			continue;
+		}
+
+		FmtArgSpec& spec = argSpecs[argCount++];
+		spec.literalOffset = literalBegin;
+		spec.literalLength = literalCharCount - literalBegin;
+		literalBegin = literalCharCount;
+
+		i++;
+		if (i < length && string[i] == ':')
+		{
+			i++;
+			if (i < length && string[i] == '0')
+			{
+				spec.zeroPad = true;
+				i++;
+			}
+			uint32 width = 0;
+			for (; i < length && string[i] >= '0' && string[i] <= '9'; i++)
+				width = width * 10 + (string[i] - '0');
+			if (i < length && string[i] == '.')
+			{
+				i++;
+				uint32 prec = 0;
+				for (; i < length && string[i] >= '0' && string[i] <= '9'; i++)
+					prec = prec * 10 + (string[i] - '0');
+				if (prec == 0 || prec > 255)
+					Internal::FmtFormatStringSyntaxError("invalid precision");
+				spec.prec = uint8(prec);
+			}
+			if (width > 255)
+				Internal::FmtFormatStringSyntaxError("width is too large");
+			spec.width = uint8(width);
+
+			if (i < length && string[i] == 'x')
+				spec.type = FmtArgType::Hex;
+			else if (i < length && string[i] == 'f')
+				spec.type = FmtArgType::Fixed;
+			else if (i < length && string[i] == 'e')
+				spec.type = FmtArgType::Exp;
+			if (spec.type != FmtArgType::Default)
+				i++;
+		}
+		if (i >= length || string[i] != '}')
+			Internal::FmtFormatStringSyntaxError("invalid placeholder");
+		i++;
+	}
+
+	trailingLiteralOffset = literalBegin;
+	trailingLiteralLength = literalCharCount - literalBegin;
+}
+
+
+// Fmt print argument span handlers ////////////////////////////////////////////////////////////////
+// `FmtArgMaxLength` gives upper bound of chars written by `FmtArgFormat`.
+
+namespace XLib::Internal
+{
+	inline constexpr FmtArgSpec FmtDefaultArgSpec = {};
+
+	inline char* FmtPadArg(char* begin, char* end, const FmtArgSpec& spec, bool alignLeft)
+	{
+		const uintptr length = end - begin;
+		if (spec.width <= length)
+			return end;
+
+		const uintptr paddingLength = spec.width - length;
+		if (!alignLeft)
+		{
+			for (uintptr i = length; i > 0; i--)
+				begin[i - 1 + paddingLength] = begin[i - 1];
+			end = begin;
+		}
+		for (uintptr i = 0; i < paddingLength; i++)
+			end[i] = ' ';
+		return begin + spec.width;
+	}
+
+	template <typename IntT>
+	inline uintptr FmtIntArgMaxLength(const FmtArgSpec& spec)
+	{
+		constexpr bool IsSigned = IntT(-1) < IntT(0);
+		constexpr uintptr MaxDecLength = (sizeof(IntT) == 1 ? 3 : (sizeof(IntT) == 2 ? 5 : (sizeof(IntT) == 4 ? 10 : 20))) + (IsSigned ? 1 : 0);
+		constexpr uintptr MaxHexLength = sizeof(IntT) * 2;
+		return max<uintptr>(spec.type == FmtArgType::Hex ? MaxHexLength : MaxDecLength, spec.width);
+	}
+
+	template <typename IntT>
+	inline char* FmtIntArgFormat(char* out, const FmtArgSpec& spec, IntT value)
+	{
+		const uint8 bufferSize = uint8(FmtIntArgMaxLength<IntT>(spec));
+		const uint8 lzWidth = spec.zeroPad ? spec.width : 0;
+
+		FmtFormatResult result = {};
+		if (spec.type == FmtArgType::Hex)
+		{
+			if constexpr (sizeof(IntT) == 1)		result = FmtFormatHex8(uint8(value), out, bufferSize, lzWidth);
+			else if constexpr (sizeof(IntT) == 2)	result = FmtFormatHex16(uint16(value), out, bufferSize, lzWidth);
+			else if constexpr (sizeof(IntT) == 4)	result = FmtFormatHex32(uint32(value), out, bufferSize, lzWidth);
+			else									result = FmtFormatHex64(uint64(value), out, bufferSize, lzWidth);
+		}
+		else if constexpr (IntT(-1) < IntT(0))
+		{
+			// Sign is included in width.
+			const uint8 digitsLZWidth = (value < 0 && lzWidth > 0) ? lzWidth - 1 : lzWidth;
+			if constexpr (sizeof(IntT) == 1)		result = FmtFormatDecS8(sint8(value), out, bufferSize, digitsLZWidth);
+			else if constexpr (sizeof(IntT) == 2)	result = FmtFormatDecS16(sint16(value), out, bufferSize, digitsLZWidth);
+			else if constexpr (sizeof(IntT) == 4)	result = FmtFormatDecS32(sint32(value), out, bufferSize, digitsLZWidth);
+			else									result = FmtFormatDecS64(sint64(value), out, bufferSize, digitsLZWidth);
+		}
+		else
+		{
+			if constexpr (sizeof(IntT) == 1)		result = FmtFormatDecU8(uint8(value), out, bufferSize, lzWidth);
+			else if constexpr (sizeof(IntT) == 2)	result = FmtFormatDecU16(uint16(value), out, bufferSize, lzWidth);
+			else if constexpr (sizeof(IntT) == 4)	result = FmtFormatDecU32(uint32(value), out, bufferSize, lzWidth);
+			else									result = FmtFormatDecU64(uint64(value), out, bufferSize, lzWidth);
+		}
+		return FmtPadArg(out, out + result.formattedCharCount, spec, false);
+	}
+
+	inline uintptr FmtFPArgMaxLength(const FmtArgSpec& spec)
+	{
+		// Shortest and precision limited generic notation take up to 25 chars, fixed notation may
+		// take all 255 chars format functions support.
+		return spec.type == FmtArgType::Fixed ? 255 : min<uintptr>(32 + spec.width, 255);
+	}
+
+	template <typename FloatT>
+	inline char* FmtFPArgFormat(char* out, const FmtArgSpec& spec, FloatT value)
+	{
+		const uint8 bufferSize = uint8(FmtFPArgMaxLength(spec));
+		const uint8 lzWidth = spec.zeroPad ? spec.width : 0;
+		const FmtFPMode mode =
+			spec.type == FmtArgType::Fixed ? FmtFPMode::Fixed : (spec.type == FmtArgType::Exp ? FmtFPMode::Exp : FmtFPMode::Generic);
+
+		FmtFormatResult result = {};
+		if constexpr (sizeof(FloatT) == 4)
+			result = FmtFormatDecFP32(value, out, bufferSize, spec.prec, mode, lzWidth);
+		else
+			result = FmtFormatDecFP64(value, out, bufferSize, spec.prec, mode, lzWidth);
+		return FmtPadArg(out, out + result.formattedCharCount, spec, false);
+	}
+
+	inline char* FmtStringArgFormat(char* out, const FmtArgSpec& spec, const char* data, uintptr length)
+	{
+		for (uintptr i = 0; i < length; i++)
+			out[i] = data[i];
+		return FmtPadArg(out, out + length, spec, true);
+	}
+
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, char arg)						{ return max<uintptr>(1, spec.width); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, signed char arg)					{ return max<uintptr>(1, spec.width); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, unsigned char arg)				{ return max<uintptr>(1, spec.width); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, signed short int arg)			{ return FmtIntArgMaxLength<signed short int>(spec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, unsigned short int arg)			{ return FmtIntArgMaxLength<unsigned short int>(spec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, signed int arg)					{ return FmtIntArgMaxLength<signed int>(spec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, unsigned int arg)				{ return FmtIntArgMaxLength<unsigned int>(spec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, signed long int arg)				{ return FmtIntArgMaxLength<signed long int>(spec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, unsigned long int arg)			{ return FmtIntArgMaxLength<unsigned long int>(spec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, signed long long int arg)		{ return FmtIntArgMaxLength<signed long long int>(spec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, unsigned long long int arg)		{ return FmtIntArgMaxLength<unsigned long long int>(spec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, float arg)						{ return FmtFPArgMaxLength(spec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, double arg)						{ return FmtFPArgMaxLength(spec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, const char* arg)					{ return max<uintptr>(XLib::String::GetCStrLength(arg), spec.width); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec& spec, StringViewASCII arg)				{ return max<uintptr>(arg.getLength(), spec.width); }
+
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, char arg)					{ *out = arg; return FmtPadArg(out, out + (arg ? 1 : 0), spec, true); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, signed char arg)			{ return FmtArgFormat(out, spec, char(arg)); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, unsigned char arg)			{ return FmtArgFormat(out, spec, char(arg)); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, signed short int arg)		{ return FmtIntArgFormat(out, spec, arg); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, unsigned short int arg)	{ return FmtIntArgFormat(out, spec, arg); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, signed int arg)			{ return FmtIntArgFormat(out, spec, arg); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, unsigned int arg)			{ return FmtIntArgFormat(out, spec, arg); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, signed long int arg)		{ return FmtIntArgFormat(out, spec, arg); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, unsigned long int arg)		{ return FmtIntArgFormat(out, spec, arg); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, signed long long int arg)	{ return FmtIntArgFormat(out, spec, arg); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, unsigned long long int arg){ return FmtIntArgFormat(out, spec, arg); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, float arg)					{ return FmtFPArgFormat(out, spec, arg); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, double arg)				{ return FmtFPArgFormat(out, spec, arg); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, const char* arg)			{ return FmtStringArgFormat(out, spec, arg, XLib::String::GetCStrLength(arg)); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec& spec, StringViewASCII arg)		{ return FmtStringArgFormat(out, spec, arg.getData(), arg.getLength()); }
+
+	// Explicit argument structs carry their own formatting options, spec is ignored.
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgDecU8 arg)		{ return max<uintptr>(3, arg.lzWidth); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgDecU16 arg)		{ return max<uintptr>(5, arg.lzWidth); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgDecU32 arg)		{ return max<uintptr>(10, arg.lzWidth); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgDecU64 arg)		{ return max<uintptr>(20, arg.lzWidth); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgDecS8 arg)		{ return max<uintptr>(3, arg.lzWidth) + 1; }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgDecS16 arg)		{ return max<uintptr>(5, arg.lzWidth) + 1; }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgDecS32 arg)		{ return max<uintptr>(10, arg.lzWidth) + 1; }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgDecS64 arg)		{ return max<uintptr>(20, arg.lzWidth) + 1; }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgHex8 arg)		{ return max<uintptr>(2, arg.lzWidth); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgHex16 arg)		{ return max<uintptr>(4, arg.lzWidth); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgHex32 arg)		{ return max<uintptr>(8, arg.lzWidth); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgHex64 arg)		{ return max<uintptr>(16, arg.lzWidth); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgFP32 arg)		{ return FmtFPArgMaxLength(FmtDefaultArgSpec); }
+	inline uintptr FmtArgMaxLength(const FmtArgSpec&, FmtArgFP64 arg)		{ return FmtFPArgMaxLength(FmtDefaultArgSpec); }
+
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgDecU8 arg)	{ return out + FmtFormatDecU8(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgDecU16 arg)	{ return out + FmtFormatDecU16(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgDecU32 arg)	{ return out + FmtFormatDecU32(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgDecU64 arg)	{ return out + FmtFormatDecU64(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgDecS8 arg)	{ return out + FmtFormatDecS8(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth, arg.showPlus).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgDecS16 arg)	{ return out + FmtFormatDecS16(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth, arg.showPlus).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgDecS32 arg)	{ return out + FmtFormatDecS32(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth, arg.showPlus).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgDecS64 arg)	{ return out + FmtFormatDecS64(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth, arg.showPlus).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgHex8 arg)		{ return out + FmtFormatHex8(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgHex16 arg)	{ return out + FmtFormatHex16(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgHex32 arg)	{ return out + FmtFormatHex32(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgHex64 arg)	{ return out + FmtFormatHex64(arg.value, out, uint8(FmtArgMaxLength(FmtDefaultArgSpec, arg)), arg.lzWidth).formattedCharCount; }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgFP32 arg)		{ return FmtFPArgFormat(out, FmtDefaultArgSpec, arg.value); }
+	inline char* FmtArgFormat(char* out, const FmtArgSpec&, FmtArgFP64 arg)		{ return FmtFPArgFormat(out, FmtDefaultArgSpec, arg.value); }
+
+	template <typename CharStreamWriter>
+	concept FmtSpanCharStreamWriter = requires(CharStreamWriter writer)
+	{
+		{ writer.reserve(uintptr(0)) } -> IsTypeEqual<char*>;
+		writer.commit(uintptr(0));
+	};
+
+	template <auto Format, uint16 ArgIndex>
+	inline uintptr FmtArgsMaxLength() { return 0; }
+
+	template <auto Format, uint16 ArgIndex, typename FmtArg, typename ... FmtArgs>
+	inline uintptr FmtArgsMaxLength(const FmtArg& arg, const FmtArgs& ... args)
+	{
+		return FmtArgMaxLength(Format.argSpecs[ArgIndex], arg) + FmtArgsMaxLength<Format, ArgIndex + 1>(args ...);
+	}
+
+	template <auto Format, uint16 LiteralOffset, uint16 LiteralLength>
+	inline char* FmtCopyLiteral(char* out)
+	{
+		for (uint16 i = 0; i < LiteralLength; i++)
+			out[i] = Format.literalChars[LiteralOffset + i];
+		return out + LiteralLength;
+	}
+
+	template <auto Format, uint16 ArgIndex>
+	inline char* FmtFormatArgs(char* out)
+	{
+		return FmtCopyLiteral<Format, Format.trailingLiteralOffset, Format.trailingLiteralLength>(out);
+	}
+
+	template <auto Format, uint16 ArgIndex, typename FmtArg, typename ... FmtArgs>
+	inline char* FmtFormatArgs(char* out, const FmtArg& arg, const FmtArgs& ... args)
+	{
+		static constexpr FmtArgSpec Spec = Format.argSpecs[ArgIndex];
+		out = FmtCopyLiteral<Format, Spec.literalOffset, Spec.literalLength>(out);
+		out = FmtArgFormat(out, Spec, arg);
+		return FmtFormatArgs<Format, ArgIndex + 1>(out, args ...);
+	}
+
+	// Fallback for writers that can not reserve span. Only strings can be longer than buffer, and
+	// they are longer than any width then.
+	template <typename CharStreamWriter, typename FmtArg>
+	inline void FmtPutArg(CharStreamWriter& writer, const FmtArgSpec& spec, const FmtArg& arg)
+	{
+		char buffer[256];
+		if (FmtArgMaxLength(spec, arg) <= sizeof(buffer))
+		{
+			const char* end = FmtArgFormat(buffer, spec, arg);
+			writer.write(buffer, end - buffer);
+		}
+		else
+			FmtPrintArgPut(writer, arg);
+	}
+
+	template <auto Format, uint16 ArgIndex, typename CharStreamWriter>
+	inline void FmtPutArgs(CharStreamWriter& writer)
+	{
+		if constexpr (Format.trailingLiteralLength > 0)
+			writer.write(Format.literalChars + Format.trailingLiteralOffset, Format.trailingLiteralLength);
+	}
+
+	template <auto Format, uint16 ArgIndex, typename CharStreamWriter, typename FmtArg, typename ... FmtArgs>
+	inline void FmtPutArgs(CharStreamWriter& writer, const FmtArg& arg, const FmtArgs& ... args)
+	{
+		static constexpr FmtArgSpec Spec = Format.argSpecs[ArgIndex];
+		if constexpr (Spec.literalLength > 0)
+			writer.write(Format.literalChars + Spec.literalOffset, Spec.literalLength);
+		FmtPutArg(writer, Spec, arg);
+		FmtPutArgs<Format, ArgIndex + 1>(writer, args ...);
+	}
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename CharStreamWriter, typename ... FmtArgs>
 inline void XLib::FmtPrint(CharStreamWriter& writer, const FmtArgs& ... args)
 {
+	if constexpr (Internal::FmtSpanCharStreamWriter<CharStreamWriter>)
+	{
+		const uintptr maxLength = (uintptr(0) + ... + Internal::FmtArgMaxLength(Internal::FmtDefaultArgSpec, args));
+		if (char* span = writer.reserve(maxLength))
+		{
+			char* end = span;
+			((end = Internal::FmtArgFormat(end, Internal::FmtDefaultArgSpec, args)), ...);
+			writer.commit(end - span);
+			return;
+		}
+	}
+
 	((void)FmtPrintArgPut(writer, args), ...);
 }
 
 template <typename ... FmtArgs>
 inline void XLib::FmtPrintStdOut(const FmtArgs& ... fmtArgs)
 {
-	FileCharStreamWriter& stdOutStream = GetStdOutStream();
+	FileCharStreamWriter& stdOutStream = GetThreadStdOutStream();
 	FmtPrint(stdOutStream, fmtArgs ...);
-	stdOutStream.flush();
+	if (IsStdOutConsole())
+		stdOutStream.flush();
 }
 
 template <typename ... FmtArgs>
 inline void XLib::FmtPrintStdErr(const FmtArgs& ... fmtArgs)
 {
+	// Whatever this thread printed to stdout so far should go before error.
+	GetThreadStdOutStream().flush();
+
 	FileCharStreamWriter& stdErrStream = GetStdErrStream();
 	FmtPrint(stdErrStream, fmtArgs ...);
 	stdErrStream.flush();
@@ -446,3 +932,39 @@ inline void XLib::FmtPrintStr(VirtualStringRefASCII string, const FmtArgs& ... f
 	FmtPrint(stringWriter, fmtArgs ...);
 	stringWriter.flush();
 }
+
+template <XLib::FmtFormatString Format, typename CharStreamWriter, typename ... FmtArgs>
+inline void XLib::FmtPrintF(CharStreamWriter& writer, const FmtArgs& ... args)
+{
+	static_assert(Format.argCount == sizeof...(FmtArgs), "Format string placeholder count does not match argument count");
+
+	if constexpr (Internal::FmtSpanCharStreamWriter<CharStreamWriter>)
+	{
+		const uintptr maxLength = Format.literalCharCount + Internal::FmtArgsMaxLength<Format, 0>(args ...);
+		if (char* span = writer.reserve(maxLength))
+		{
+			char* end = Internal::FmtFormatArgs<Format, 0>(span, args ...);
+			writer.commit(end - span);
+			return;
+		}
+	}
+
+	Internal::FmtPutArgs<Format, 0>(writer, args ...);
+}
+
+template <XLib::FmtFormatString Format, typename ... FmtArgs>
+inline void XLib::FmtPrintFStdOut(const FmtArgs& ... fmtArgs)
+{
+	FileCharStreamWriter& stdOutStream = GetThreadStdOutStream();
+	FmtPrintF<Format>(stdOutStream, fmtArgs ...);
+	if (IsStdOutConsole())
+		stdOutStream.flush();
+}
+
+template <XLib::FmtFormatString Format, typename ... FmtArgs>
+inline void XLib::FmtPrintFStr(VirtualStringRefASCII string, const FmtArgs& ... fmtArgs)
+{
+	VirtualStringWriter stringWriter(string);
+	FmtPrintF<Format>(stringWriter, fmtArgs ...);
+	stringWriter.flush();
+}
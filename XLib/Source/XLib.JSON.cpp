@@ -1,12 +1,93 @@
+#include <intrin.h>
+#include <immintrin.h>
+
+#include "XLib.Allocation.h"
+#include "XLib.Containers.HashMap.h"
 #include "XLib.Fmt.h"
 
 #include "XLib.JSON.h"
 
 using namespace XLib;
 
+namespace
+{
+	using ClassifyTextBlockFunc = void(*)(const char* block, uint64& whitespace, uint64& doubleQuotes, uint64& stringSpecialChars);
+
+	void ClassifyTextBlockSSE2(const char* block, uint64& whitespace, uint64& doubleQuotes, uint64& stringSpecialChars)
+	{
+		whitespace = 0;
+		doubleQuotes = 0;
+		stringSpecialChars = 0;
+
+		for (uint32 i = 0; i < 64; i += 16)
+		{
+			const __m128i chars = _mm_loadu_si128((const __m128i*)(block + i));
+
+			// '\t', '\n', '\v', '\f', '\r' are 9..13.
+			const __m128i charsMinusTab = _mm_sub_epi8(chars, _mm_set1_epi8(9));
+			const __m128i isWhitespace = _mm_or_si128(
+				_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')),
+				_mm_cmpeq_epi8(_mm_min_epu8(charsMinusTab, _mm_set1_epi8(4)), charsMinusTab));
+
+			// Signed comparison: both 0..31 and 128..255 are less than 32.
+			const __m128i isStringSpecialChar = _mm_or_si128(
+				_mm_cmpeq_epi8(chars, _mm_set1_epi8('\\')),
+				_mm_cmplt_epi8(chars, _mm_set1_epi8(0x20)));
+
+			whitespace |= uint64(uint32(_mm_movemask_epi8(isWhitespace))) << i;
+			doubleQuotes |= uint64(uint32(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\"'))))) << i;
+			stringSpecialChars |= uint64(uint32(_mm_movemask_epi8(isStringSpecialChar))) << i;
+		}
+	}
+
+	void ClassifyTextBlockAVX2(const char* block, uint64& whitespace, uint64& doubleQuotes, uint64& stringSpecialChars)
+	{
+		whitespace = 0;
+		doubleQuotes = 0;
+		stringSpecialChars = 0;
+
+		for (uint32 i = 0; i < 64; i += 32)
+		{
+			const __m256i chars = _mm256_loadu_si256((const __m256i*)(block + i));
+
+			const __m256i charsMinusTab = _mm256_sub_epi8(chars, _mm256_set1_epi8(9));
+			const __m256i isWhitespace = _mm256_or_si256(
+				_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')),
+				_mm256_cmpeq_epi8(_mm256_min_epu8(charsMinusTab, _mm256_set1_epi8(4)), charsMinusTab));
+
+			const __m256i isStringSpecialChar = _mm256_or_si256(
+				_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\\')),
+				_mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), chars));
+
+			whitespace |= uint64(uint32(_mm256_movemask_epi8(isWhitespace))) << i;
+			doubleQuotes |= uint64(uint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\"'))))) << i;
+			stringSpecialChars |= uint64(uint32(_mm256_movemask_epi8(isStringSpecialChar))) << i;
+		}
+	}
+
+	ClassifyTextBlockFunc SelectClassifyTextBlockFunc()
+	{
+		int cpuInfo[4] = {};
+		__cpuid(cpuInfo, 0);
+		if (cpuInfo[0] < 7)
+			return ClassifyTextBlockSSE2;
+
+		__cpuid(cpuInfo, 1);
+		const bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+		const bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+			return ClassifyTextBlockSSE2;
+
+		__cpuidex(cpuInfo, 7, 0);
+		const bool avx2 = (cpuInfo[1] & (1 << 5)) != 0;
+		return avx2 ? ClassifyTextBlockAVX2 : ClassifyTextBlockSSE2;
+	}
+}
+
 inline bool IsIdentifierStartCharacter(char c) { return Char::IsLetter(c) || c == '_'; }
 inline bool IsIdentifierPartCharacter(char c) { return Char::IsLetterOrDigit(c) || c == '_'; }
 inline bool IsNumberStartCharacter(char c) { return Char::IsDigit(c) || c == '+' || c == '-' || c == '.'; }
+inline bool IsNumberPartCharacter(char c) { return IsNumberStartCharacter(c) || c == 'e' || c == 'E'; }
 
 enum class JSONReader::State : uint8
 {
@@ -20,11 +101,161 @@ enum class JSONReader::State : uint8
 	EndOfDocumentReached,
 };
 
+void JSONString::unescape(char* result)
+{
+	char* resultIt = result;
+	for (uintptr i = 0; i < string.getLength(); i++)
+	{
+		char c = string[i];
+		if (c == '\\')
+		{
+			i++;
+			XAssert(i < string.getLength());
+			switch (string[i])
+			{
+				case 'b':	c = '\b'; break;
+				case 'f':	c = '\f'; break;
+				case 'n':	c = '\n'; break;
+				case 'r':	c = '\r'; break;
+				case 't':	c = '\t'; break;
+				default:	c = string[i]; break; // '"', '\\', '/'
+			}
+		}
+		*resultIt = c;
+		resultIt++;
+	}
+	XAssert(uintptr(resultIt - result) == unescapedLength);
+}
+
+const JSONReader::TextBlockMasks& JSONReader::getBlockMasks(const char* blockBegin)
+{
+	XAssert(blockBegin >= textBegin && blockBegin < textEnd);
+	XAssert((blockBegin - textBegin) % 64 == 0);
+
+	if (blockBegin == indexedBlockBegin)
+		return indexedBlockMasks;
+
+	static const ClassifyTextBlockFunc classifyTextBlock = SelectClassifyTextBlockFunc();
+
+	uint64 whitespace = 0;
+	uint64 doubleQuotes = 0;
+	uint64 stringSpecialChars = 0;
+
+	if (textEnd - blockBegin >= 64)
+	{
+		classifyTextBlock(blockBegin, whitespace, doubleQuotes, stringSpecialChars);
+	}
+	else
+	{
+		// Last block is padded with spaces, so there is nothing to find past the end.
+		char paddedBlock[64];
+		memorySet(paddedBlock, ' ', sizeof(paddedBlock));
+		memoryCopy(paddedBlock, blockBegin, textEnd - blockBegin);
+		classifyTextBlock(paddedBlock, whitespace, doubleQuotes, stringSpecialChars);
+	}
+
+	indexedBlockBegin = blockBegin;
+	indexedBlockMasks.nonWhitespace = ~whitespace;
+	indexedBlockMasks.doubleQuotes = doubleQuotes;
+	indexedBlockMasks.stringSpecialChars = stringSpecialChars;
+	return indexedBlockMasks;
+}
+
+const char* JSONReader::findNonWhitespace(const char* from)
+{
+	if (from == textEnd || !Char::IsWhitespace(*from))
+		return from;
+
+	const uintptr fromOffset = from - textBegin;
+	const char* blockBegin = textBegin + (fromOffset & ~uintptr(63));
+	uint64 fromMask = ~uint64(0) << (fromOffset & 63);
+
+	for (; blockBegin < textEnd; blockBegin += 64)
+	{
+		const uint64 nonWhitespace = getBlockMasks(blockBegin).nonWhitespace & fromMask;
+		if (nonWhitespace)
+			return blockBegin + countTrailingZeros64(nonWhitespace);
+		fromMask = ~uint64(0);
+	}
+	return textEnd;
+}
+
+const char* JSONReader::findPlainStringEnd(const char* from)
+{
+	const uintptr fromOffset = from - textBegin;
+	const char* blockBegin = textBegin + (fromOffset & ~uintptr(63));
+	uint64 fromMask = ~uint64(0) << (fromOffset & 63);
+
+	for (; blockBegin < textEnd; blockBegin += 64)
+	{
+		const TextBlockMasks& masks = getBlockMasks(blockBegin);
+		const uint64 doubleQuotes = masks.doubleQuotes & fromMask;
+		const uint64 beforeDoubleQuoteMask = (doubleQuotes & (0 - doubleQuotes)) - 1; // All ones if there is no quote.
+		if (masks.stringSpecialChars & fromMask & beforeDoubleQuoteMask)
+			return nullptr;
+		if (doubleQuotes)
+			return blockBegin + countTrailingZeros64(doubleQuotes);
+		fromMask = ~uint64(0);
+	}
+	return nullptr;
+}
+
+void JSONReader::advanceLineCounter(const char* position) const
+{
+	XAssert(position >= textBegin && position <= textEnd);
+
+	if (lineCounterPosition > position)
+	{
+		lineCounterPosition = textBegin;
+		lineCounterLineBegin = textBegin;
+		lineCounterLineIndex = 0;
+		lineCounterColumnIndex = 0;
+	}
+	if (lineCounterPosition == position)
+		return;
+
+	const char* it = lineCounterPosition;
+	for (; position - it >= 16; it += 16)
+	{
+		const __m128i chars = _mm_loadu_si128((const __m128i*)it);
+		uint32 newLines = uint32(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\n'))));
+		while (newLines)
+		{
+			lineCounterLineBegin = it + countTrailingZeros32(newLines) + 1;
+			lineCounterLineIndex++;
+			newLines &= newLines - 1;
+		}
+	}
+	for (; it != position; it++)
+	{
+		if (*it == '\n')
+		{
+			lineCounterLineBegin = it + 1;
+			lineCounterLineIndex++;
+		}
+	}
+
+	// Column counts chars except '\r'.
+	const char* columnCountBegin = lineCounterPosition;
+	if (lineCounterLineBegin > lineCounterPosition)
+	{
+		columnCountBegin = lineCounterLineBegin;
+		lineCounterColumnIndex = 0;
+	}
+	for (const char* columnIt = columnCountBegin; columnIt != position; columnIt++)
+	{
+		if (*columnIt != '\r')
+			lineCounterColumnIndex++;
+	}
+
+	lineCounterPosition = position;
+}
+
 bool JSONReader::tryConsumeChar(char c)
 {
-	if (charsReader.peek() != c)
+	if (peekChar() != c || isEndOfText())
 		return false;
-	charsReader.get();
+	current++;
 	return true;
 }
 
@@ -32,28 +263,28 @@ bool JSONReader::skipWhitespaceAndComments()
 {
 	for (;;)
 	{
-		FmtSkipWhitespaces(charsReader);
+		current = findNonWhitespace(current);
 
-		if (charsReader.peek() != '/')
+		if (peekChar() != '/')
 			break;
 
-		if (charsReader.peek(1) == '/')
+		if (peekNextChar() == '/')
 		{
-			FmtSkipToNewLine(charsReader);
+			while (!isEndOfText() && getChar() != '\n')
+			{ }
 		}
-		else if (charsReader.peek(1) == '*')
+		else if (peekNextChar() == '*')
 		{
-			charsReader.get();
-			charsReader.get();
+			current += 2;
 
 			for(;;)
 			{
-				if (charsReader.get() == '*' && charsReader.peek() == '/')
+				if (getChar() == '*' && peekChar() == '/')
 				{
-					charsReader.get();
+					current++;
 					break;
 				}
-				if (charsReader.isEndOfStream())
+				if (isEndOfText())
 				{
 					errorCode = JSONErrorCode::UnexpectedEndOfFile;
 					return false;
@@ -69,34 +300,45 @@ bool JSONReader::skipWhitespaceAndComments()
 
 bool JSONReader::parseString(JSONString& result)
 {
-	const char openingDoubleQuote = charsReader.get();
-	XAssert(openingDoubleQuote == '\"');
+	XAssert(peekChar() == '\"');
+	current++;
 
-	const char* stringBeginPtr = charsReader.getCurrentPtr();
+	const char* stringBeginPtr = current;
+
+	// Fast path: string without escapes and special chars is just span up to closing quote.
+	if (const char* plainStringEndPtr = findPlainStringEnd(stringBeginPtr))
+	{
+		current = plainStringEndPtr + 1;
+
+		result.string = StringViewASCII(stringBeginPtr, plainStringEndPtr);
+		result.unescapedLength = plainStringEndPtr - stringBeginPtr;
+		result.isEscaped = false;
+		return true;
+	}
 
 	uintptr unescapedLength = 0;
 	bool isEscaped = false;
 	for (;;)
 	{
-		if (charsReader.isEndOfStream())
+		if (isEndOfText())
 		{
 			errorCode = JSONErrorCode::UnexpectedEndOfFile;
 			return false;
 		}
 
-		const char c = charsReader.peek();
+		const char c = peekChar();
 
 		if (c == '\"')
 			break;
 
 		if (c == '\\')
 		{
-			charsReader.get();
+			current++;
 
-			const char e = charsReader.peek();
+			const char e = peekChar();
 			if (e == '\"' || e == '\\' || e == '/' || e == 'b' || e == 'f' || e == 'n' || e == 'r' || e == 't')
 			{
-				charsReader.get();
+				current++;
 			}
 			else if (e == 'u')
 			{
@@ -123,16 +365,16 @@ bool JSONReader::parseString(JSONString& result)
 		}
 		else
 		{
-			charsReader.get();
+			current++;
 		}
 
 		unescapedLength++;
 	}
 
-	const char* stringEndPtr = charsReader.getCurrentPtr();
+	const char* stringEndPtr = current;
 
-	const char closingDoubleQuote = charsReader.get();
-	XAssert(closingDoubleQuote == '\"');
+	XAssert(peekChar() == '\"');
+	current++;
 
 	result.string = StringViewASCII(stringBeginPtr, stringEndPtr);
 	result.unescapedLength = unescapedLength;
@@ -145,12 +387,12 @@ bool JSONReader::parseString(JSONString& result)
 
 bool JSONReader::parseIdentifier(StringViewASCII& result)
 {
-	const char* identifierBeginPtr = charsReader.getCurrentPtr();
-	const char identifierStartChar = charsReader.get();
-	XAssert(IsIdentifierStartCharacter(identifierStartChar));
-	while (IsIdentifierPartCharacter(charsReader.peek()))
-		charsReader.get();
-	const char* identifierEndPtr = charsReader.getCurrentPtr();
+	const char* identifierBeginPtr = current;
+	XAssert(IsIdentifierStartCharacter(peekChar()));
+	current++;
+	while (current != textEnd && IsIdentifierPartCharacter(*current))
+		current++;
+	const char* identifierEndPtr = current;
 
 	result = StringViewASCII(identifierBeginPtr, identifierEndPtr);
 	return true;
@@ -158,13 +400,47 @@ bool JSONReader::parseIdentifier(StringViewASCII& result)
 
 bool JSONReader::parseNumber(JSONNumber& result)
 {
-	XAssertNotImplemented();
-	return false;
+	XAssert(IsNumberStartCharacter(peekChar()));
+
+	// Token is taken greedily and then should be consumed by number parser completely,
+	// so things like `1.2.3` or `1e` are rejected instead of being split.
+	const char* numberBeginPtr = current;
+	bool isIntegral = true;
+	while (current != textEnd && IsNumberPartCharacter(*current))
+	{
+		isIntegral &= Char::IsDigit(*current) || *current == '+' || *current == '-';
+		current++;
+	}
+	const uintptr numberLength = current - numberBeginPtr;
+
+	if (numberLength > 255)
+	{
+		errorCode = JSONErrorCode::InvalidValueFormat;
+		return false;
+	}
+
+	const FmtParseResult floatingPointParseResult = FmtParseDecFP64(numberBeginPtr, numberLength, result.floatingPoint);
+	if (floatingPointParseResult.status != FmtParseStatus::Success || floatingPointParseResult.parsedCharCount != numberLength)
+	{
+		errorCode = JSONErrorCode::InvalidValueFormat;
+		return false;
+	}
+
+	// Integers that do not fit `sint64` are still valid numbers, just without exact integer value.
+	result.integer = 0;
+	result.isInteger = false;
+	if (isIntegral)
+	{
+		const FmtParseResult integerParseResult = FmtParseDecS64(numberBeginPtr, numberLength, result.integer, true);
+		result.isInteger = integerParseResult.status == FmtParseStatus::Success && integerParseResult.parsedCharCount == numberLength;
+	}
+
+	return true;
 }
 
 bool JSONReader::parseKey(JSONString& result)
 {
-	const char c = charsReader.peek();
+	const char c = peekChar();
 	if (c == '\"')
 	{
 		if (!parseString(result))
@@ -191,7 +467,7 @@ bool JSONReader::parseKey(JSONString& result)
 
 bool JSONReader::parseLiteralValue(JSONValue& result)
 {
-	const char c = charsReader.peek();
+	const char c = peekChar();
 	if (c == '\"')
 	{
 		if (!parseString(result.string))
@@ -249,7 +525,7 @@ bool JSONReader::consumeCommaAndSkipToNextElementOrPrepareScopeClose()
 	const bool isRootScope = nestingStackSize == 0;
 	if (isRootScope)
 	{
-		if (!charsReader.isEndOfStream())
+		if (!isEndOfText())
 		{
 			errorCode = JSONErrorCode::UnexpectedTextAfterRootElement;
 			return false;
@@ -260,7 +536,7 @@ bool JSONReader::consumeCommaAndSkipToNextElementOrPrepareScopeClose()
 
 	// Not root scope.
 
-	if (charsReader.isEndOfStream())
+	if (isEndOfText())
 	{
 		errorCode = JSONErrorCode::UnexpectedEndOfFile;
 		return false;
@@ -273,7 +549,7 @@ bool JSONReader::consumeCommaAndSkipToNextElementOrPrepareScopeClose()
 	XAssert(nestingStackSize > 0 && nestingStackSize <= 64);
 	const bool currentScopeIsArray = nestingStackBits.isSet(nestingStackSize - 1);
 
-	if (charsReader.peek() == (currentScopeIsArray ? ']' : '}'))
+	if (peekChar() == (currentScopeIsArray ? ']' : '}'))
 		state = currentScopeIsArray ? State::PendingArrayScopeEnd : State::PendingObjectScopeEnd;
 	else if (commaConsumed)
 		state = currentScopeIsArray ? State::PendingValue : State::PendingKey;
@@ -293,7 +569,16 @@ bool JSONReader::openDocument(const char* text, uintptr length)
 	state = State::Undefined;
 	errorCode = JSONErrorCode::Success;
 
-	charsReader.open(text, length);
+	textBegin = text;
+	textEnd = text + length;
+	current = text;
+
+	indexedBlockBegin = nullptr;
+	lineCounterPosition = text;
+	lineCounterLineBegin = text;
+	lineCounterLineIndex = 0;
+	lineCounterColumnIndex = 0;
+
 	if (!skipWhitespaceAndComments())
 		return false;
 
@@ -306,7 +591,7 @@ bool JSONReader::readKey(JSONString& result)
 	XAssert(errorCode == JSONErrorCode::Success);
 	XAssert(state == State::PendingKey);
 
-	if (charsReader.isEndOfStream())
+	if (isEndOfText())
 	{
 		errorCode = JSONErrorCode::UnexpectedEndOfFile;
 		return false;
@@ -315,7 +600,7 @@ bool JSONReader::readKey(JSONString& result)
 		return false;
 	if (!skipWhitespaceAndComments())
 		return false;
-	if (charsReader.isEndOfStream())
+	if (isEndOfText())
 	{
 		errorCode = JSONErrorCode::UnexpectedEndOfFile;
 		return false;
@@ -337,19 +622,19 @@ bool JSONReader::readValue(JSONValue& result)
 	XAssert(errorCode == JSONErrorCode::Success);
 	XAssert(state == State::PendingValue);
 
-	if (charsReader.isEndOfStream())
+	if (isEndOfText())
 	{
 		errorCode = JSONErrorCode::UnexpectedEndOfFile;
 		return false;
 	}
 
-	if (charsReader.peek() == '{')
+	if (peekChar() == '{')
 	{
 		result.type = JSONValueType::Object;
 		state = State::PendingObjectScopeBegin;
 		return true;
 	}
-	if (charsReader.peek() == '[')
+	if (peekChar() == '[')
 	{
 		result.type = JSONValueType::Array;
 		state = State::PendingArrayScopeBegin;
@@ -375,13 +660,13 @@ bool JSONReader::openObject()
 	nestingStackBits.reset(nestingStackSize);
 	nestingStackSize++;
 
-	const char leftCurlyBracket = charsReader.get();
-	XAssert(leftCurlyBracket == '{');
+	XAssert(peekChar() == '{');
+	current++;
 
 	if (!skipWhitespaceAndComments())
 		return false;
 
-	state = charsReader.peek() == '}' ? State::PendingObjectScopeEnd : State::PendingKey;
+	state = peekChar() == '}' ? State::PendingObjectScopeEnd : State::PendingKey;
 	return true;
 }
 
@@ -394,8 +679,8 @@ bool JSONReader::closeObject()
 	XAssert(!nestingStackBits.isSet(nestingStackSize - 1));
 	nestingStackSize--;
 
-	const char rightCurlyBracket = charsReader.get();
-	XAssert(rightCurlyBracket == '}');
+	XAssert(peekChar() == '}');
+	current++;
 
 	return consumeCommaAndSkipToNextElementOrPrepareScopeClose();
 }
@@ -413,13 +698,13 @@ bool JSONReader::openArray()
 	nestingStackBits.set(nestingStackSize);
 	nestingStackSize++;
 
-	const char leftSquareBracket = charsReader.get();
-	XAssert(leftSquareBracket == '[');
+	XAssert(peekChar() == '[');
+	current++;
 
 	if (!skipWhitespaceAndComments())
 		return false;
 
-	state = charsReader.peek() == ']' ? State::PendingArrayScopeEnd : State::PendingValue;
+	state = peekChar() == ']' ? State::PendingArrayScopeEnd : State::PendingValue;
 	return true;
 }
 
@@ -432,8 +717,8 @@ bool JSONReader::closeArray()
 	XAssert(nestingStackBits.isSet(nestingStackSize - 1));
 	nestingStackSize--;
 
-	const char rightSquareBracket = charsReader.get();
-	XAssert(rightSquareBracket == ']');
+	XAssert(peekChar() == ']');
+	current++;
 
 	return consumeCommaAndSkipToNextElementOrPrepareScopeClose();
 }
@@ -482,6 +767,25 @@ bool JSONReader::isInsideRootScope() const
 	return nestingStackSize == 0;
 }
 
+uint32 JSONReader::getLineNumer() const
+{
+	advanceLineCounter(current);
+	return lineCounterLineIndex + 1;
+}
+
+uint32 JSONReader::getColumnNumer() const
+{
+	advanceLineCounter(current);
+	return lineCounterColumnIndex + 1;
+}
+
+void JSONReader::getLineColumnNumbers(uintptr offset, uint32& resultLineNumber, uint32& resultColumnNumber) const
+{
+	advanceLineCounter(textBegin + offset);
+	resultLineNumber = lineCounterLineIndex + 1;
+	resultColumnNumber = lineCounterColumnIndex + 1;
+}
+
 const char* XLib::JSONErrorCodeToString(JSONErrorCode code)
 {
 	switch (code)
@@ -502,3 +806,445 @@ const char* XLib::JSONErrorCodeToString(JSONErrorCode code)
 	XAssertUnreachableCode();
 	return "INVALID_ERROR_CODE";
 }
+
+
+// JSONDocument ////////////////////////////////////////////////////////////////////////////////////
+
+struct JSONDocument::Node
+{
+	uint64 keyHash;
+	uint32 keyOffset;
+	uint32 keyLength;
+	union
+	{
+		struct
+		{
+			union
+			{
+				uint32 stringOffset;
+				uint32 descendantCount;
+				uint32 boolean;
+			};
+			union
+			{
+				uint32 stringLength;
+				uint32 childCount;
+			};
+		};
+		float64 floatingPoint;
+		sint64 integer;
+	};
+	uint32 textOffset;
+	JSONValueType type;
+	uint8 flags;
+};
+
+namespace
+{
+	// Decoded strings are addressed by offset from tape end, so their offsets survive tape growth.
+	constexpr uint8 NodeFlagKeyIsDecoded = 0x01;
+	constexpr uint8 NodeFlagStringIsDecoded = 0x02;
+	constexpr uint8 NodeFlagIsLastChild = 0x04;
+	constexpr uint8 NodeFlagNumberIsInteger = 0x08;
+	constexpr uint8 NodeFlagHasMemberIndex = 0x10;
+
+	constexpr uint32 TapeMinCapacity = 0x1000;
+
+	// Below this linear scan over children is about as fast as hash lookup.
+	constexpr uint32 MemberIndexMinChildCount = 16;
+
+	// Member index is hash table of child node indices with load factor at most 1/2. Zero is empty
+	// slot, as root is never a child. It occupies whole nodes, so its size follows from child count.
+	inline uint32 GetMemberIndexSlotCount(uint32 childCount)
+	{
+		uint32 slotCount = 32;
+		while (slotCount < childCount * 2)
+			slotCount *= 2;
+		return slotCount;
+	}
+}
+
+inline JSONDocument::Node& JSONDocument::getNode(uint32 index) const
+{
+	XAssert(index < nodeCount);
+	return ((Node*)tape)[index];
+}
+
+inline StringViewASCII JSONDocument::getStoredString(uint32 offset, uint32 length, bool isDecoded) const
+{
+	const char* data = isDecoded ? (const char*)tape + tapeCapacity - offset : text + offset;
+	return StringViewASCII(data, length);
+}
+
+void JSONDocument::growTape(uintptr requiredFreeSpace)
+{
+	const uintptr nodesSize = uintptr(nodeCount) * sizeof(Node);
+	const uintptr requiredCapacity = nodesSize + decodedStringsSize + requiredFreeSpace;
+	if (requiredCapacity <= tapeCapacity)
+		return;
+
+	uintptr newCapacity = max<uintptr>(tapeCapacity * 2, TapeMinCapacity);
+	while (newCapacity < requiredCapacity)
+		newCapacity *= 2;
+	XAssert(newCapacity <= uint32(-1));
+
+	byte* newTape = (byte*)SystemHeapAllocator::Allocate(newCapacity);
+	if (tape)
+	{
+		memoryCopy(newTape, tape, nodesSize);
+		memoryCopy(newTape + newCapacity - decodedStringsSize, tape + tapeCapacity - decodedStringsSize, decodedStringsSize);
+		SystemHeapAllocator::Release(tape);
+	}
+
+	tape = newTape;
+	tapeCapacity = uint32(newCapacity);
+}
+
+uint32 JSONDocument::allocateNode()
+{
+	growTape(sizeof(Node));
+
+	const uint32 nodeIndex = nodeCount;
+	nodeCount++;
+
+	Node& node = getNode(nodeIndex);
+	memorySet(&node, 0, sizeof(Node));
+	return nodeIndex;
+}
+
+StringViewASCII JSONDocument::storeString(JSONString string, uint32& resultOffset, bool& resultIsDecoded)
+{
+	if (!string.isEscaped)
+	{
+		resultOffset = uint32(string.string.getData() - text);
+		resultIsDecoded = false;
+		return string.string;
+	}
+
+	growTape(string.unescapedLength);
+	decodedStringsSize += uint32(string.unescapedLength);
+
+	char* decodedString = (char*)tape + tapeCapacity - decodedStringsSize;
+	string.unescape(decodedString);
+
+	resultOffset = decodedStringsSize;
+	resultIsDecoded = true;
+	return StringViewASCII(decodedString, string.unescapedLength);
+}
+
+bool JSONDocument::parseValue(const JSONString* key)
+{
+	const uint32 textOffset = uint32(reader.getOffset());
+
+	JSONValue value = {};
+	if (!reader.readValue(value))
+		return false;
+
+	// Strings are stored before node is referenced, as storing may grow tape.
+	uint32 keyOffset = 0;
+	uint64 keyHash = 0;
+	bool keyIsDecoded = false;
+	if (key)
+	{
+		const StringViewASCII storedKey = storeString(*key, keyOffset, keyIsDecoded);
+		if (keyHashFunc)
+			keyHash = keyHashFunc(storedKey);
+	}
+
+	uint32 stringOffset = 0;
+	bool stringIsDecoded = false;
+	if (value.type == JSONValueType::String)
+		storeString(value.string, stringOffset, stringIsDecoded);
+
+	const uint32 nodeIndex = allocateNode();
+	{
+		Node& node = getNode(nodeIndex);
+		node.keyHash = keyHash;
+		node.keyOffset = keyOffset;
+		node.keyLength = key ? uint32(key->unescapedLength) : 0;
+		node.textOffset = textOffset;
+		node.type = value.type;
+		node.flags = (keyIsDecoded ? NodeFlagKeyIsDecoded : 0) | (stringIsDecoded ? NodeFlagStringIsDecoded : 0);
+
+		if (value.type == JSONValueType::String)
+		{
+			node.stringOffset = stringOffset;
+			node.stringLength = uint32(value.string.unescapedLength);
+		}
+		else if (value.type == JSONValueType::Number)
+		{
+			if (value.number.isInteger)
+			{
+				node.integer = value.number.integer;
+				node.flags |= NodeFlagNumberIsInteger;
+			}
+			else
+				node.floatingPoint = value.number.floatingPoint;
+		}
+		else if (value.type == JSONValueType::Boolean)
+			node.boolean = value.boolean ? 1 : 0;
+	}
+
+	if (value.type != JSONValueType::Object && value.type != JSONValueType::Array)
+		return true;
+
+	const bool isObject = value.type == JSONValueType::Object;
+	if (!(isObject ? reader.openObject() : reader.openArray()))
+		return false;
+
+	uint32 childCount = 0;
+	uint32 lastChildIndex = 0;
+	while (!(isObject ? reader.isEndOfObject() : reader.isEndOfArray()))
+	{
+		lastChildIndex = nodeCount;
+
+		if (isObject)
+		{
+			JSONString memberKey = {};
+			if (!reader.readKey(memberKey))
+				return false;
+			if (!parseValue(&memberKey))
+				return false;
+		}
+		else
+		{
+			if (!parseValue(nullptr))
+				return false;
+		}
+
+		childCount++;
+	}
+
+	if (!(isObject ? reader.closeObject() : reader.closeArray()))
+		return false;
+
+	if (childCount > 0)
+		getNode(lastChildIndex).flags |= NodeFlagIsLastChild;
+
+	if (isObject && childCount >= MemberIndexMinChildCount)
+		buildMemberIndex(nodeIndex, childCount);
+
+	Node& node = getNode(nodeIndex);
+	node.descendantCount = nodeCount - nodeIndex - 1;
+	node.childCount = childCount;
+	return true;
+}
+
+void JSONDocument::buildMemberIndex(uint32 objectNodeIndex, uint32 childCount)
+{
+	const uint32 slotCount = GetMemberIndexSlotCount(childCount);
+	const uint32 indexNodeCount = uint32(divRoundUp<uintptr>(slotCount * sizeof(uint32), sizeof(Node)));
+
+	growTape(indexNodeCount * sizeof(Node));
+	const uint32 indexBeginNodeIndex = nodeCount;
+	nodeCount += indexNodeCount;
+
+	uint32* slots = (uint32*)&getNode(indexBeginNodeIndex);
+	memorySet(slots, 0, indexNodeCount * sizeof(Node));
+
+	// Children are still contiguous subtrees between object node and index.
+	uint32 childIndex = objectNodeIndex + 1;
+	for (uint32 i = 0; i < childCount; i++)
+	{
+		const Node& child = getNode(childIndex);
+		const uint64 keyHash = keyHashFunc ? child.keyHash :
+			computeKeyHash(getStoredString(child.keyOffset, child.keyLength, (child.flags & NodeFlagKeyIsDecoded) != 0));
+
+		uint32 slot = uint32(keyHash) & (slotCount - 1);
+		while (slots[slot])
+			slot = (slot + 1) & (slotCount - 1);
+		slots[slot] = childIndex;
+
+		const bool hasDescendants = child.type == JSONValueType::Object || child.type == JSONValueType::Array;
+		childIndex += 1 + (hasDescendants ? child.descendantCount : 0);
+	}
+	XAssert(childIndex == indexBeginNodeIndex);
+
+	getNode(objectNodeIndex).flags |= NodeFlagHasMemberIndex;
+}
+
+uint64 JSONDocument::computeKeyHash(StringViewASCII key) const
+{
+	return keyHashFunc ? keyHashFunc(key) : HashMapHashing::ComputeBytes(key.getData(), key.getLength());
+}
+
+bool JSONDocument::parse(const char* text, uintptr length, KeyHashFunc keyHashFunc)
+{
+	XAssert(length < uint32(-1));
+
+	this->text = text;
+	this->keyHashFunc = keyHashFunc;
+	nodeCount = 0;
+	decodedStringsSize = 0;
+
+	// Tape is usually about as large as text, so start there to skip most regrowths.
+	if (tapeCapacity < length)
+		growTape(length);
+
+	if (!reader.openDocument(text, length))
+		return false;
+	if (!parseValue(nullptr))
+	{
+		nodeCount = 0;
+		return false;
+	}
+
+	XAssert(reader.isEndOfDocument());
+	return true;
+}
+
+void JSONDocument::destroy()
+{
+	if (tape)
+		SystemHeapAllocator::Release(tape);
+
+	text = nullptr;
+	tape = nullptr;
+	tapeCapacity = 0;
+	nodeCount = 0;
+	decodedStringsSize = 0;
+	keyHashFunc = nullptr;
+}
+
+JSONDocument::Element JSONDocument::getRoot() const
+{
+	return nodeCount > 0 ? Element(this, 0) : Element();
+}
+
+inline const JSONDocument::Node& JSONDocument::Element::getNode() const
+{
+	XAssert(document);
+	return document->getNode(nodeIndex);
+}
+
+JSONValueType JSONDocument::Element::getType() const
+{
+	return getNode().type;
+}
+
+StringViewASCII JSONDocument::Element::getString() const
+{
+	const Node& node = getNode();
+	XAssert(node.type == JSONValueType::String);
+	return document->getStoredString(node.stringOffset, node.stringLength, (node.flags & NodeFlagStringIsDecoded) != 0);
+}
+
+float64 JSONDocument::Element::getNumber() const
+{
+	const Node& node = getNode();
+	XAssert(node.type == JSONValueType::Number);
+	return (node.flags & NodeFlagNumberIsInteger) ? float64(node.integer) : node.floatingPoint;
+}
+
+bool JSONDocument::Element::getInteger(sint64& result) const
+{
+	const Node& node = getNode();
+	XAssert(node.type == JSONValueType::Number);
+	if (!(node.flags & NodeFlagNumberIsInteger))
+		return false;
+	result = node.integer;
+	return true;
+}
+
+bool JSONDocument::Element::getBoolean() const
+{
+	const Node& node = getNode();
+	XAssert(node.type == JSONValueType::Boolean);
+	return node.boolean != 0;
+}
+
+uint32 JSONDocument::Element::getChildCount() const
+{
+	const Node& node = getNode();
+	XAssert(node.type == JSONValueType::Object || node.type == JSONValueType::Array);
+	return node.childCount;
+}
+
+JSONDocument::Element JSONDocument::Element::getFirstChild() const
+{
+	return getChildCount() > 0 ? Element(document, nodeIndex + 1) : Element();
+}
+
+JSONDocument::Element JSONDocument::Element::getNextSibling() const
+{
+	const Node& node = getNode();
+	if (nodeIndex == 0 || (node.flags & NodeFlagIsLastChild) != 0)
+		return Element();
+
+	const bool hasDescendants = node.type == JSONValueType::Object || node.type == JSONValueType::Array;
+	return Element(document, nodeIndex + 1 + (hasDescendants ? node.descendantCount : 0));
+}
+
+const uint32* JSONDocument::Element::getMemberIndex(uint32& resultSlotCount) const
+{
+	const Node& node = getNode();
+	XAssert(node.type == JSONValueType::Object);
+	if (!(node.flags & NodeFlagHasMemberIndex))
+		return nullptr;
+
+	resultSlotCount = GetMemberIndexSlotCount(node.childCount);
+	const uint32 indexNodeCount = uint32(divRoundUp<uintptr>(resultSlotCount * sizeof(uint32), sizeof(Node)));
+	return (const uint32*)&document->getNode(nodeIndex + 1 + node.descendantCount - indexNodeCount);
+}
+
+JSONDocument::Element JSONDocument::Element::findMember(uint64 keyHash) const
+{
+	XAssert(document && document->keyHashFunc);
+
+	uint32 slotCount = 0;
+	if (const uint32* slots = getMemberIndex(slotCount))
+	{
+		for (uint32 slot = uint32(keyHash) & (slotCount - 1); slots[slot]; slot = (slot + 1) & (slotCount - 1))
+		{
+			if (document->getNode(slots[slot]).keyHash == keyHash)
+				return Element(document, slots[slot]);
+		}
+		return Element();
+	}
+
+	for (Element member = getFirstChild(); member.isValid(); member = member.getNextSibling())
+	{
+		if (member.getNode().keyHash == keyHash)
+			return member;
+	}
+	return Element();
+}
+
+JSONDocument::Element JSONDocument::Element::findMember(StringViewASCII key) const
+{
+	uint32 slotCount = 0;
+	if (const uint32* slots = getMemberIndex(slotCount))
+	{
+		const uint64 keyHash = document->computeKeyHash(key);
+		for (uint32 slot = uint32(keyHash) & (slotCount - 1); slots[slot]; slot = (slot + 1) & (slotCount - 1))
+		{
+			const Element member(document, slots[slot]);
+			if (member.getKey() == key)
+				return member;
+		}
+		return Element();
+	}
+
+	for (Element member = getFirstChild(); member.isValid(); member = member.getNextSibling())
+	{
+		if (member.getKey() == key)
+			return member;
+	}
+	return Element();
+}
+
+StringViewASCII JSONDocument::Element::getKey() const
+{
+	const Node& node = getNode();
+	return document->getStoredString(node.keyOffset, node.keyLength, (node.flags & NodeFlagKeyIsDecoded) != 0);
+}
+
+uint64 JSONDocument::Element::getKeyHash() const
+{
+	return getNode().keyHash;
+}
+
+uint32 JSONDocument::Element::getTextOffset() const
+{
+	return getNode().textOffset;
+}
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "XLib.h"
-#include "XLib.CharStream.h"
 #include "XLib.Containers.BitArray.h"
 #include "XLib.NonCopyable.h"
 #include "XLib.String.h"
@@ -46,11 +45,9 @@ namespace XLib
 
 	struct JSONNumber
 	{
-		union
-		{
-			float64 floatingPoint;
-			sint64 integet;
-		};
+		float64 floatingPoint;	// Always valid. Nearest to source text.
+		sint64 integer;			// Valid if `isInteger`.
+		bool isInteger;			// No fraction and exponent and fits `sint64`.
 	};
 
 	struct JSONValue
@@ -65,33 +62,55 @@ namespace XLib
 		JSONValueType type;
 	};
 
+	// Reader classifies text in 64-byte blocks with SIMD (whitespace, double quotes and chars that
+	// need special handling inside strings) as cursor advances, so whitespace runs and plain strings
+	// are skipped by bit scans instead of char by char. Strings with escapes take char-by-char path,
+	// so escaped quotes never have to be told apart in masks.
+	// Line and column numbers are not tracked during parsing. They are computed when requested,
+	// incrementally from previous query, so callers should remember offsets and ask for line/column
+	// only when reporting error.
+
 	class JSONReader : public NonCopyable
 	{
 	private:
 		enum class State : uint8;
 
-		class CharsReader : public XLib::LineColumnTrackingCharStreamReaderWrapper<XLib::MemoryCharStreamReader>
+		struct TextBlockMasks
 		{
-		private:
-			using Base = XLib::LineColumnTrackingCharStreamReaderWrapper<XLib::MemoryCharStreamReader>;
-
-		private:
-			XLib::MemoryCharStreamReader innerMemoryReader;
-
-		public:
-			inline CharsReader() : Base(innerMemoryReader) {}
-			inline void open(const char* data, uintptr length) { innerMemoryReader.open(data, length); }
-			inline const char* getCurrentPtr() const { return innerMemoryReader.getCurrentPtr(); }
+			uint64 nonWhitespace;
+			uint64 doubleQuotes;
+			uint64 stringSpecialChars; // '\\', control chars and non-ASCII chars.
 		};
 
 	private:
-		CharsReader charsReader;
+		const char* textBegin = nullptr;
+		const char* textEnd = nullptr;
+		const char* current = nullptr;
+
+		const char* indexedBlockBegin = nullptr;
+		TextBlockMasks indexedBlockMasks = {};
+
+		mutable const char* lineCounterPosition = nullptr;
+		mutable const char* lineCounterLineBegin = nullptr;
+		mutable uint32 lineCounterLineIndex = 0;
+		mutable uint32 lineCounterColumnIndex = 0;
+
 		InplaceBitArray<64> nestingStackBits; // Each bit is one nested scope. 0 - object, 1 - array.
 		uint8 nestingStackSize = 0;
 		State state = State(0);
 		JSONErrorCode errorCode = JSONErrorCode::Success;
 
 	private:
+		inline bool isEndOfText() const { return current == textEnd || *current == 0; }
+		inline char peekChar() const { return current != textEnd ? *current : 0; }
+		inline char peekNextChar() const { return (current != textEnd && *current != 0 && current + 1 != textEnd) ? current[1] : 0; }
+		inline char getChar() { return (current != textEnd && *current != 0) ? *current++ : 0; }
+
+		const TextBlockMasks& getBlockMasks(const char* blockBegin);
+		const char* findNonWhitespace(const char* from);
+		const char* findPlainStringEnd(const char* from); // Returns null if string needs char by char parsing.
+		void advanceLineCounter(const char* position) const;
+
 		bool tryConsumeChar(char c);
 		bool skipWhitespaceAndComments();
 
@@ -128,9 +147,116 @@ namespace XLib
 		bool isInsideRootScope() const;
 
 		inline JSONErrorCode getErrorCode() const { return errorCode; }
-		inline uint32 getLineNumer() const { return charsReader.getLineNumber(); }
-		inline uint32 getColumnNumer() const { return charsReader.getColumnNumber(); }
-		//inline uintptr getOffset() const { return charsReader.getOffset(); }
+		inline uintptr getOffset() const { return current - textBegin; }
+
+		// Line and column numbers are 1-based. Cheapest when queried in increasing offset order.
+		uint32 getLineNumer() const;
+		uint32 getColumnNumer() const;
+		void getLineColumnNumbers(uintptr offset, uint32& resultLineNumber, uint32& resultColumnNumber) const;
+	};
+
+	// Optional DOM on top of `JSONReader`. Whole document is parsed into single tape buffer: nodes
+	// grow from its front, decoded escaped strings grow from its back. Every value is one node and
+	// object/array node is directly followed by subtrees of its children, so child count is O(1) and
+	// next sibling is found by skipping subtree. Object members store key and its hash computed with
+	// function given to `parse`, so callers can look members up by precomputed hash. Objects with many
+// members also get open addressing index of their children right after last child subtree, so
+// lookups in them do not scan all members.
+	// Strings without escapes point straight into source text, which should outlive document.
+
+	class JSONDocument : public NonCopyable
+	{
+	public:
+		using KeyHashFunc = uint64(*)(StringViewASCII key);
+
+		class Element;
+
+	private:
+		struct Node;
+
+	private:
+		JSONReader reader;
+		const char* text = nullptr;
+		byte* tape = nullptr;
+		uint32 tapeCapacity = 0;
+		uint32 nodeCount = 0;
+		uint32 decodedStringsSize = 0;
+		KeyHashFunc keyHashFunc = nullptr;
+
+	private:
+		void growTape(uintptr requiredFreeSpace);
+		uint32 allocateNode();
+		StringViewASCII storeString(JSONString string, uint32& resultOffset, bool& resultIsDecoded);
+		bool parseValue(const JSONString* key);
+		void buildMemberIndex(uint32 objectNodeIndex, uint32 childCount);
+
+		uint64 computeKeyHash(StringViewASCII key) const;
+
+		Node& getNode(uint32 index) const;
+		StringViewASCII getStoredString(uint32 offset, uint32 length, bool isDecoded) const;
+
+	public:
+		JSONDocument() = default;
+		inline ~JSONDocument() { destroy(); }
+
+		// On failure `getErrorCode` and `getLineNumer`/`getColumnNumer` describe error.
+		bool parse(const char* text, uintptr length, KeyHashFunc keyHashFunc = nullptr);
+		void destroy();
+
+		Element getRoot() const;
+		inline uint32 getNodeCount() const { return nodeCount; } // Includes nodes taken by member indices.
+
+		inline JSONErrorCode getErrorCode() const { return reader.getErrorCode(); }
+		inline uint32 getLineNumer() const { return reader.getLineNumer(); }
+		inline uint32 getColumnNumer() const { return reader.getColumnNumer(); }
+		inline void getLineColumnNumbers(uintptr offset, uint32& resultLineNumber, uint32& resultColumnNumber) const { reader.getLineColumnNumbers(offset, resultLineNumber, resultColumnNumber); }
+	};
+
+	class JSONDocument::Element
+	{
+		friend JSONDocument;
+
+	private:
+		const JSONDocument* document = nullptr;
+		uint32 nodeIndex = 0;
+
+	private:
+		inline Element(const JSONDocument* document, uint32 nodeIndex) : document(document), nodeIndex(nodeIndex) {}
+		const Node& getNode() const;
+		const uint32* getMemberIndex(uint32& resultSlotCount) const; // Null if object has no member index.
+
+	public:
+		Element() = default;
+
+		inline bool isValid() const { return document != nullptr; }
+
+		JSONValueType getType() const;
+		inline bool isObject() const { return getType() == JSONValueType::Object; }
+		inline bool isArray() const { return getType() == JSONValueType::Array; }
+		inline bool isString() const { return getType() == JSONValueType::String; }
+		inline bool isNumber() const { return getType() == JSONValueType::Number; }
+		inline bool isBoolean() const { return getType() == JSONValueType::Boolean; }
+		inline bool isNull() const { return getType() == JSONValueType::Null; }
+
+		StringViewASCII getString() const;
+		float64 getNumber() const;
+		bool getInteger(sint64& result) const; // False if number has fraction or exponent or does not fit `sint64`.
+		bool getBoolean() const;
+
+		// Object or array.
+		uint32 getChildCount() const;
+		Element getFirstChild() const;		// Invalid element if there are no children.
+		Element getNextSibling() const;		// Invalid element after last child.
+
+		// Object members. Invalid element if not found.
+		Element findMember(uint64 keyHash) const; // Document should be parsed with key hash function.
+		Element findMember(StringViewASCII key) const;
+
+		StringViewASCII getKey() const; // Empty if element is not object member.
+		uint64 getKeyHash() const;
+
+		// Offset of value in source text. Pass to `JSONDocument::getLineColumnNumbers` to report errors.
+		uint32 getTextOffset() const;
 	};
 
 	const char* JSONErrorCodeToString(JSONErrorCode code);
@@ -61,45 +61,47 @@ namespace XLib
 	// NOTE: Buffer size includes null terminator (so max length is equal to buffer size minus 1).
 	// NOTE: `VirtualStringInterface::setLength()` does not reallocate buffer, so sufficient buffer space should be allocated prior to calling.
 
+	// Interface implementations are stateless. Single static instance per string type is shared by
+	// all references, and string itself is passed to every call.
 	template <typename CharType>
 	class VirtualStringInterface abstract
 	{
 	public:
-		virtual uint32 getMaxBufferSize() const = 0;
-		virtual uint32 getBufferSize() const = 0;
-		virtual void growBuffer(uint32 minRequiredBufferSize) const = 0;
-		virtual char* getBuffer() const = 0;
+		virtual uint32 getMaxBufferSize(void* stringPtr) const = 0;
+		virtual uint32 getBufferSize(void* stringPtr) const = 0;
+		virtual void growBuffer(void* stringPtr, uint32 minRequiredBufferSize) const = 0;
+		virtual CharType* getBuffer(void* stringPtr) const = 0;
 
-		virtual uint32 getLength() const = 0;
-		virtual void setLength(uint32 length) const = 0;
-
-		inline uint32 getMaxLength() const;
-		inline void growBufferToFitLength(uint32 minRequiredLength) const;
+		virtual uint32 getLength(void* stringPtr) const = 0;
+		virtual void setLength(void* stringPtr, uint32 length) const = 0;
 	};
 
 	template <typename CharType>
 	class VirtualStringRef
 	{
 	private:
-		void* vtable;
+		const VirtualStringInterface<CharType>* stringInterface = nullptr;
 		void* stringPtr = nullptr;
 
 	public:
 		VirtualStringRef() = default;
 		~VirtualStringRef() = default;
 
-		inline uint32 getMaxBufferSize() const { return ((VirtualStringInterface<CharType>*)this)->getMaxBufferSize(); }
-		inline uint32 getBufferSize() const { return ((VirtualStringInterface<CharType>*)this)->getBufferSize(); }
-		inline void growBuffer(uint32 minRequiredBufferSize) const { ((VirtualStringInterface<CharType>*)this)->growBuffer(minRequiredBufferSize); }
-		inline CharType* getBuffer() const { return ((VirtualStringInterface<CharType>*)this)->getBuffer(); }
+		inline VirtualStringRef(const VirtualStringInterface<CharType>* stringInterface, void* stringPtr) :
+			stringInterface(stringInterface), stringPtr(stringPtr) {}
 
-		inline uint32 getLength() const { return ((VirtualStringInterface<CharType>*)this)->getLength(); }
-		inline void setLength(uint32 length) const { ((VirtualStringInterface<CharType>*)this)->setLength(length); }
+		inline uint32 getMaxBufferSize() const { return stringInterface->getMaxBufferSize(stringPtr); }
+		inline uint32 getBufferSize() const { return stringInterface->getBufferSize(stringPtr); }
+		inline void growBuffer(uint32 minRequiredBufferSize) const { stringInterface->growBuffer(stringPtr, minRequiredBufferSize); }
+		inline CharType* getBuffer() const { return stringInterface->getBuffer(stringPtr); }
 
-		inline uint32 getMaxLength() const { return ((VirtualStringInterface<CharType>*)this)->getMaxLength(); }
-		inline void growBufferToFitLength(uint32 minRequiredLength) const { ((VirtualStringInterface<CharType>*)this)->growBufferToFitLength(minRequiredLength); }
+		inline uint32 getLength() const { return stringInterface->getLength(stringPtr); }
+		inline void setLength(uint32 length) const { stringInterface->setLength(stringPtr, length); }
+
+		inline uint32 getMaxLength() const;
+		inline void growBufferToFitLength(uint32 minRequiredLength) const { growBuffer(minRequiredLength + 1); }
 
-		inline bool isValid() const { return vtable && stringPtr; }
+		inline bool isValid() const { return stringInterface && stringPtr; }
 	};
 
 	template <typename CharType>
@@ -188,7 +190,7 @@ namespace XLib
 	};
 
 
-	template <typename CharType, typename AllocatorType = SystemHeapAllocator>
+	template <typename CharType, typename AllocatorType = DefaultAllocator>
 	class DynamicString : private AllocatorAdapterBase<AllocatorType>
 	{
 	private:
@@ -206,6 +208,7 @@ namespace XLib
 
 	public:
 		DynamicString() = default;
+		inline DynamicString(AllocatorType& allocator) : AllocatorBase(allocator) {}
 		~DynamicString();
 
 		inline DynamicString(DynamicString&& that);
@@ -369,19 +372,13 @@ inline constexpr XLib::StringView<CharType> XLib::StringView<CharType>::FromCStr
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename CharType>
-inline uint32 XLib::VirtualStringInterface<CharType>::getMaxLength() const
+inline uint32 XLib::VirtualStringRef<CharType>::getMaxLength() const
 { 
 	const uint32 maxBufferSize = getMaxBufferSize();
 	XAssert(maxBufferSize > 0);
 	return maxBufferSize - 1;
 }
 
-template <typename CharType>
-inline void XLib::VirtualStringInterface<CharType>::growBufferToFitLength(uint32 minRequiredLength) const
-{
-	growBuffer(minRequiredLength + 1);
-}
-
 
 // InplaceString ///////////////////////////////////////////////////////////////////////////////////
 
@@ -389,20 +386,24 @@ template <typename CharType, uint16 BufferSize>
 class XLib::InplaceString<CharType, BufferSize>::VirtualRef : public XLib::VirtualStringInterface<CharType>
 {
 private:
-	InplaceString<CharType, BufferSize>* stringPtr;
+	using StringType = InplaceString<CharType, BufferSize>;
 
 public:
-	VirtualRef(InplaceString<CharType, BufferSize>* stringPtr) : stringPtr(stringPtr) {}
+	static const VirtualRef Instance;
 
-	virtual uint32 getMaxBufferSize() const override { return BufferSize; }
-	virtual uint32 getBufferSize() const override { return BufferSize; }
-	virtual void growBuffer(uint32 minRequiredBufferSize) const override { XAssert(minRequiredBufferSize <= BufferSize); }
-	virtual CharType* getBuffer() const { return stringPtr->buffer; }
+public:
+	virtual uint32 getMaxBufferSize(void* stringPtr) const override { return BufferSize; }
+	virtual uint32 getBufferSize(void* stringPtr) const override { return BufferSize; }
+	virtual void growBuffer(void* stringPtr, uint32 minRequiredBufferSize) const override { XAssert(minRequiredBufferSize <= BufferSize); }
+	virtual CharType* getBuffer(void* stringPtr) const override { return ((StringType*)stringPtr)->buffer; }
 
-	virtual uint32 getLength() const override { return stringPtr->length; }
-	virtual void setLength(uint32 length) const { return stringPtr->setLength(length); }
+	virtual uint32 getLength(void* stringPtr) const override { return ((StringType*)stringPtr)->length; }
+	virtual void setLength(void* stringPtr, uint32 length) const override { ((StringType*)stringPtr)->setLength(length); }
 };
 
+template <typename CharType, uint16 BufferSize>
+const typename XLib::InplaceString<CharType, BufferSize>::VirtualRef XLib::InplaceString<CharType, BufferSize>::VirtualRef::Instance;
+
 template <typename CharType, uint16 BufferSize>
 inline XLib::InplaceString<CharType, BufferSize>::InplaceString()
 {
@@ -462,9 +463,7 @@ inline void XLib::InplaceString<CharType, BufferSize>::setLength(uint32 length)
 template <typename CharType, uint16 BufferSize>
 inline XLib::VirtualStringRef<CharType> XLib::InplaceString<CharType, BufferSize>::getVirtualRef()
 {
-	VirtualRef virtualRef(this);
-	static_assert(sizeof(VirtualRef) == sizeof(XLib::VirtualStringRef<CharType>));
-	return (XLib::VirtualStringRef<CharType>&)virtualRef;
+	return XLib::VirtualStringRef<CharType>(&VirtualRef::Instance, this);
 }
 
 template <typename CharType, uint16 BufferSize>
@@ -492,20 +491,30 @@ template <typename CharType, typename AllocatorType>
 class XLib::DynamicString<CharType, AllocatorType>::VirtualRef : public XLib::VirtualStringInterface<CharType>
 {
 private:
-	DynamicString<CharType, AllocatorType>* stringPtr;
+	using StringType = DynamicString<CharType, AllocatorType>;
 
 public:
-	VirtualRef(DynamicString<CharType, AllocatorType>* stringPtr) : stringPtr(stringPtr) {}
+	static const VirtualRef Instance;
 
-	virtual uint32 getMaxBufferSize() const override { return uint32(-1); }
-	virtual uint32 getBufferSize() const override { return stringPtr->bufferSize; }
-	virtual void growBuffer(uint32 minRequiredBufferSize) const override { stringPtr->growBuffer(minRequiredBufferSize); }
-	virtual CharType* getBuffer() const { return stringPtr->buffer; }
+public:
+	virtual uint32 getMaxBufferSize(void* stringPtr) const override { return uint32(-1); }
+	virtual uint32 getBufferSize(void* stringPtr) const override { return ((StringType*)stringPtr)->bufferSize; }
+	virtual void growBuffer(void* stringPtr, uint32 minRequiredBufferSize) const override { ((StringType*)stringPtr)->growBuffer(minRequiredBufferSize); }
+	virtual CharType* getBuffer(void* stringPtr) const override { return ((StringType*)stringPtr)->buffer; }
 
-	virtual uint32 getLength() const override { return stringPtr->length; }
-	virtual void setLength(uint32 length) const { return stringPtr->setLength(length); }
+	virtual uint32 getLength(void* stringPtr) const override { return ((StringType*)stringPtr)->length; }
+	virtual void setLength(void* stringPtr, uint32 length) const override { ((StringType*)stringPtr)->setLength(length); }
 };
 
+template <typename CharType, typename AllocatorType>
+const typename XLib::DynamicString<CharType, AllocatorType>::VirtualRef XLib::DynamicString<CharType, AllocatorType>::VirtualRef::Instance;
+
+template <typename CharType, typename AllocatorType>
+inline XLib::VirtualStringRef<CharType> XLib::DynamicString<CharType, AllocatorType>::getVirtualRef()
+{
+	return XLib::VirtualStringRef<CharType>(&VirtualRef::Instance, this);
+}
+
 template <typename CharType, typename AllocatorType>
 inline XLib::DynamicString<CharType, AllocatorType>::~DynamicString()
 {
@@ -519,6 +528,8 @@ inline XLib::DynamicString<CharType, AllocatorType>::~DynamicString()
 template <typename CharType, typename AllocatorType>
 inline XLib::DynamicString<CharType, AllocatorType>::DynamicString(DynamicString&& that)
 {
+	AllocatorBase::inheritAllocator(that);
+
 	buffer = that.buffer;
 	bufferSize = that.bufferSize;
 	length = that.length;
@@ -528,12 +539,26 @@ inline XLib::DynamicString<CharType, AllocatorType>::DynamicString(DynamicString
 	that.length = 0;
 }
 
+template <typename CharType, typename AllocatorType>
+inline XLib::DynamicString<CharType, AllocatorType>::DynamicString(const StringView<CharType>& that)
+{
+	append(that);
+}
+
+template <typename CharType, typename AllocatorType>
+inline XLib::DynamicString<CharType, AllocatorType>::DynamicString(const CharType* thatCStr)
+{
+	append(StringView<CharType>::FromCStr(thatCStr));
+}
+
 template <typename CharType, typename AllocatorType>
 inline auto XLib::DynamicString<CharType, AllocatorType>::operator = (DynamicString&& that) -> DynamicString&
 {
 	if (buffer)
 		AllocatorBase::release(buffer);
 
+	AllocatorBase::inheritAllocator(that);
+
 	buffer = that.buffer;
 	bufferSize = that.bufferSize;
 	length = that.length;
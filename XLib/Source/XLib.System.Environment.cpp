@@ -46,6 +46,18 @@ void Environment::GetCurrentPath(VirtualStringRefASCII resultPath)
 	Path::AddTrailingDirectorySeparator(resultPath);
 }
 
+void Environment::GetExecutableFilePath(VirtualStringRefASCII resultPath)
+{
+	char internalBuffer[4096];
+	const DWORD length = GetModuleFileNameA(nullptr, internalBuffer, countOf(internalBuffer));
+	XAssert(length > 0 && length < countOf(internalBuffer));
+
+	resultPath.growBufferToFitLength(length);
+	const uint32 resultLength = min<uint32>(length, resultPath.getMaxBufferSize());
+	resultPath.setLength(resultLength);
+	memoryCopy(resultPath.getBuffer(), internalBuffer, resultLength);
+}
+
 const char* Environment::GetCommandLineCStr()
 {
 	return ::GetCommandLineA();
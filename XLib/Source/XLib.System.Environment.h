@@ -9,6 +9,7 @@ namespace XLib
 	{
 	public:
 		static void GetCurrentPath(VirtualStringRefASCII resultPath);
+		static void GetExecutableFilePath(VirtualStringRefASCII resultPath);
 		static const char* GetCommandLineCStr();
 	};
 }
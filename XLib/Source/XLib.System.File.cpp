@@ -110,6 +110,12 @@ uint64 File::GetSize(FileHandle fileHandle)
 	return size.QuadPart;
 }
 
+bool File::IsConsole(FileHandle fileHandle)
+{
+	XAssert(fileHandle != FileHandle::Zero);
+	return GetFileType(HANDLE(fileHandle)) == FILE_TYPE_CHAR;
+}
+
 uint64 File::GetPosition(FileHandle fileHandle)
 {
 	XAssert(fileHandle != FileHandle::Zero);
@@ -179,6 +185,47 @@ void File::close()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+bool MappedFile::open(const char* name)
+{
+	close();
+
+	const HANDLE hFile = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0 || uint64(fileSize.QuadPart) > uintptr(-1))
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	// View keeps mapping object alive, so both handles can be closed right away.
+	const HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(hFile);
+	if (!hMapping)
+		return false;
+
+	const void* view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(hMapping);
+	if (!view)
+		return false;
+
+	data = view;
+	size = uint64(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data)
+		UnmapViewOfFile(data);
+	data = nullptr;
+	size = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 static HANDLE StdIn = NULL;
 static HANDLE StdOut = NULL;
 static HANDLE StdErr = NULL;
@@ -53,6 +53,8 @@ namespace XLib
 		static uint64 GetPosition(FileHandle fileHandle);
 		static uint64 SetPosition(FileHandle fileHandle, sint64 offset, FileOffsetOrigin origin = FileOffsetOrigin::Begin);
 
+		static bool IsConsole(FileHandle fileHandle); // False for files and pipes.
+
 	private:
 		FileHandle handle = FileHandle::Zero;
 
@@ -78,6 +80,26 @@ namespace XLib
 		inline FileHandle getHandle() { return handle; }
 	};
 
+	// Read-only view of whole file. File can not be replaced or deleted while it is mapped.
+	class MappedFile : public NonCopyable
+	{
+	private:
+		const void* data = nullptr;
+		uint64 size = 0;
+
+	public:
+		MappedFile() = default;
+		inline ~MappedFile() { close(); }
+
+		// Fails for empty files.
+		bool open(const char* name);
+		void close();
+
+		inline const void* getData() const { return data; }
+		inline uint64 getSize() const { return size; }
+		inline bool isOpen() const { return data != nullptr; }
+	};
+
 	FileHandle GetStdInFileHandle();
 	FileHandle GetStdOutFileHandle();
 	FileHandle GetStdErrFileHandle();
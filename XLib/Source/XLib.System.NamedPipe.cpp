@@ -13,11 +13,11 @@ void NamedPipe::destroy()
 	}
 }
 
-bool NamedPipe::create(const char* name, uint32 outBufferSize, uint32 inBufferSize)
+bool NamedPipe::create(const char* name, uint32 outBufferSize, uint32 inBufferSize, bool overlapped)
 {
 	destroy();
 
-	HANDLE _handle = CreateNamedPipeA(name, PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+	HANDLE _handle = CreateNamedPipeA(name, PIPE_ACCESS_DUPLEX | (overlapped ? FILE_FLAG_OVERLAPPED : 0),
 		PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
 		PIPE_UNLIMITED_INSTANCES, outBufferSize, inBufferSize, 0, nullptr);
 	if (_handle != INVALID_HANDLE_VALUE)
@@ -35,7 +35,8 @@ bool NamedPipe::connect()
 {
 	XAssert(isInitialized());
 
-	if (!ConnectNamedPipe(handle, nullptr))
+	// Client might have connected between `create` and `connect`.
+	if (!ConnectNamedPipe(handle, nullptr) && GetLastError() != ERROR_PIPE_CONNECTED)
 	{
 		//Debug::LogLastSystemError(SysErrorDbgMsgFmt);
 		return false;
@@ -62,10 +63,12 @@ bool NamedPipe::asyncConnect(DispatchedAsyncTask& task, NamedPipeConnectedHandle
 	return true;
 }
 
-bool NamedPipe::open(const char* name)
+bool NamedPipe::open(const char* name, bool overlapped)
 {
+	destroy();
+
 	HANDLE _handle = CreateFileA(name, GENERIC_READ | GENERIC_WRITE,
-		0, nullptr, OPEN_EXISTING, 0, nullptr);
+		0, nullptr, OPEN_EXISTING, overlapped ? FILE_FLAG_OVERLAPPED : 0, nullptr);
 	if (_handle == INVALID_HANDLE_VALUE)
 		return false;
 
@@ -80,16 +83,75 @@ void NamedPipe::cancelIO()
 
 bool NamedPipe::read(void* buffer, uint32 size)
 {
-	DWORD readSize = 0;
-	BOOL result = ReadFile(handle, buffer, size, &readSize, nullptr);
-	return result != 0;
+	// Byte mode pipe can return less than requested.
+	uint32 totalReadSize = 0;
+	while (totalReadSize < size)
+	{
+		DWORD readSize = 0;
+		if (!ReadFile(handle, (byte*)buffer + totalReadSize, size - totalReadSize, &readSize, nullptr) || readSize == 0)
+			return false;
+		totalReadSize += readSize;
+	}
+	return true;
+}
+
+bool NamedPipe::read(void* buffer, uint32 size, uint32 timeoutMs)
+{
+	HANDLE event = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	if (!event)
+		return false;
+
+	const ULONGLONG deadlineMs = GetTickCount64() + timeoutMs;
+	bool result = true;
+
+	uint32 totalReadSize = 0;
+	while (totalReadSize < size)
+	{
+		OVERLAPPED overlapped = {};
+		overlapped.hEvent = event;
+
+		DWORD readSize = 0;
+		if (!ReadFile(handle, (byte*)buffer + totalReadSize, size - totalReadSize, nullptr, &overlapped) &&
+			GetLastError() != ERROR_IO_PENDING)
+		{
+			result = false;
+			break;
+		}
+
+		const ULONGLONG currentTimeMs = GetTickCount64();
+		const DWORD waitTimeMs = currentTimeMs < deadlineMs ? DWORD(deadlineMs - currentTimeMs) : 0;
+		if (WaitForSingleObject(event, waitTimeMs) != WAIT_OBJECT_0)
+		{
+			// `overlapped` is on stack, so read has to be finished before returning.
+			CancelIoEx(handle, &overlapped);
+			GetOverlappedResult(handle, &overlapped, &readSize, TRUE);
+			result = false;
+			break;
+		}
+
+		if (!GetOverlappedResult(handle, &overlapped, &readSize, FALSE) || readSize == 0)
+		{
+			result = false;
+			break;
+		}
+		totalReadSize += readSize;
+	}
+
+	CloseHandle(event);
+	return result;
 }
 
 bool NamedPipe::write(const void* buffer, uint32 size)
 {
-	DWORD writtenSize = 0;
-	BOOL result = WriteFile(handle, buffer, size, &writtenSize, nullptr);
-	return result != 0;
+	uint32 totalWrittenSize = 0;
+	while (totalWrittenSize < size)
+	{
+		DWORD writtenSize = 0;
+		if (!WriteFile(handle, (const byte*)buffer + totalWrittenSize, size - totalWrittenSize, &writtenSize, nullptr) || writtenSize == 0)
+			return false;
+		totalWrittenSize += writtenSize;
+	}
+	return true;
 }
 
 bool NamedPipe::asyncRead(void* buffer, uint32 size, DispatchedAsyncTask& task,
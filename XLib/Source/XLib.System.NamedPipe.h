@@ -21,17 +21,21 @@ namespace XLib
 		void destroy();
 
 		// server
-		bool create(const char* name, uint32 outBufferSize = 4096, uint32 inBufferSize = 4096);
+		// Pipe created with `overlapped = false` can only be used with blocking calls. Blocking calls on
+		// single handle are serialized by the system, so such pipe should not be read and written concurrently.
+		bool create(const char* name, uint32 outBufferSize = 4096, uint32 inBufferSize = 4096, bool overlapped = true);
 		bool connect();
 		bool asyncConnect(DispatchedAsyncTask& task, NamedPipeConnectedHandler handler, uintptr key = 0);
 
 		// client
-		bool open(const char* name);
+		// Pipe opened with `overlapped = true` can only be read with timeout.
+		bool open(const char* name, bool overlapped = false);
 
 		// global
 		void cancelIO();
-		bool read(void* buffer, uint32 size);
-		bool write(const void* buffer, uint32 size);
+		bool read(void* buffer, uint32 size); // Blocks until whole buffer is read.
+		bool read(void* buffer, uint32 size, uint32 timeoutMs); // Overlapped pipes only. Returns false on timeout.
+		bool write(const void* buffer, uint32 size); // Blocks until whole buffer is written.
 		bool asyncRead(void* buffer, uint32 size, DispatchedAsyncTask& task,
 			TransferCompletedHandler handler, uintptr key = 0);
 		bool asyncWrite(const void* buffer, uint32 size, DispatchedAsyncTask& task,
@@ -0,0 +1,99 @@
+#include <Windows.h>
+
+#include "XLib.System.Process.h"
+#include "XLib.String.h"
+
+using namespace XLib;
+
+static HANDLE GetKillOnCloseJobObject()
+{
+	// Job handle is never closed explicitly. It is closed by the system when process exits,
+	// which terminates all processes assigned to the job.
+	static const HANDLE job = []() -> HANDLE
+	{
+		HANDLE job = CreateJobObjectA(nullptr, nullptr);
+		if (!job)
+			return nullptr;
+
+		JOBOBJECT_EXTENDED_LIMIT_INFORMATION limitInfo = {};
+		limitInfo.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+		if (!SetInformationJobObject(job, JobObjectExtendedLimitInformation, &limitInfo, sizeof(limitInfo)))
+		{
+			CloseHandle(job);
+			return nullptr;
+		}
+		return job;
+	}();
+	return job;
+}
+
+bool Process::create(const char* commandLineCStr, bool killOnParentExit)
+{
+	destroy();
+
+	// `CreateProcessA` may modify command line buffer.
+	char commandLineBuffer[4096];
+	const uintptr commandLineLength = String::GetCStrLength(commandLineCStr);
+	if (commandLineLength >= countOf(commandLineBuffer))
+		return false;
+	memoryCopy(commandLineBuffer, commandLineCStr, commandLineLength + 1);
+
+	HANDLE job = nullptr;
+	if (killOnParentExit)
+	{
+		job = GetKillOnCloseJobObject();
+		if (!job)
+			return false;
+	}
+
+	STARTUPINFOA startupInfo = {};
+	startupInfo.cb = sizeof(startupInfo);
+	PROCESS_INFORMATION processInfo = {};
+
+	// Process is started suspended, so it can't spawn anything before it is assigned to the job.
+	const DWORD creationFlags = killOnParentExit ? CREATE_SUSPENDED : 0;
+	if (!CreateProcessA(nullptr, commandLineBuffer, nullptr, nullptr, FALSE, creationFlags, nullptr, nullptr, &startupInfo, &processInfo))
+		return false;
+
+	if (killOnParentExit)
+	{
+		if (!AssignProcessToJobObject(job, processInfo.hProcess))
+		{
+			TerminateProcess(processInfo.hProcess, 1);
+			CloseHandle(processInfo.hThread);
+			CloseHandle(processInfo.hProcess);
+			return false;
+		}
+		ResumeThread(processInfo.hThread);
+	}
+
+	CloseHandle(processInfo.hThread);
+	handle = processInfo.hProcess;
+	return true;
+}
+
+void Process::terminate(uint32 exitCode)
+{
+	XAssert(handle);
+	TerminateProcess(handle, exitCode);
+}
+
+bool Process::isRunning()
+{
+	return handle && WaitForSingleObject(handle, 0) == WAIT_TIMEOUT;
+}
+
+bool Process::getExitCode(uint32& resultExitCode)
+{
+	XAssert(handle);
+	DWORD exitCode = 0;
+	if (!GetExitCodeProcess(handle, &exitCode) || exitCode == STILL_ACTIVE)
+		return false;
+	resultExitCode = exitCode;
+	return true;
+}
+
+uint32 Process::GetCurrentId()
+{
+	return GetCurrentProcessId();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "XLib.h"
+#include "XLib.System.Threading.h"
+
+namespace XLib
+{
+	class Process : public WaitableBase
+	{
+	public:
+		Process() = default;
+		~Process() = default;
+
+		// Command line is passed to the system as is (first argument should be executable path).
+		// Child inherits current directory and environment. If `killOnParentExit` is set, child is
+		// terminated by the system when calling process exits (even abnormally).
+		bool create(const char* commandLineCStr, bool killOnParentExit = false);
+		void terminate(uint32 exitCode = 1);
+
+		bool isRunning();
+		bool getExitCode(uint32& resultExitCode);
+
+		static uint32 GetCurrentId();
+	};
+}
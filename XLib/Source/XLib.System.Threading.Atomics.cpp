@@ -15,6 +15,16 @@ uint32 Atomics::Core<sizeof(uint32)>::And(volatile uint32* target, uint32 value)
 uint32 Atomics::Core<sizeof(uint32)>::Or(volatile uint32* target, uint32 value) { return InterlockedOr((volatile LONG*)target, value); }
 uint32 Atomics::Core<sizeof(uint32)>::Xor(volatile uint32* target, uint32 value) { return InterlockedXor((volatile LONG*)target, value); }
 
+uint64 Atomics::Core<sizeof(uint64)>::Add(volatile uint64* target, uint64 value) { return InterlockedAdd64((volatile LONG64*)target, value); }
+uint64 Atomics::Core<sizeof(uint64)>::Sub(volatile uint64* target, uint64 value) { return InterlockedAdd64((volatile LONG64*)target, -sint64(value)); }
+uint64 Atomics::Core<sizeof(uint64)>::Exchange(volatile uint64* target, uint64 value) { return InterlockedExchange64((volatile LONG64*)target, value); }
+uint64 Atomics::Core<sizeof(uint64)>::Increment(volatile uint64* target) { return InterlockedIncrement64((volatile LONG64*)target); }
+uint64 Atomics::Core<sizeof(uint64)>::Decrement(volatile uint64* target) { return InterlockedDecrement64((volatile LONG64*)target); }
+bool Atomics::Core<sizeof(uint64)>::CompareExchange(volatile uint64* target, uint64 comparand, uint64 exchange) { return _InterlockedCompareExchange64((volatile LONG64*)target, exchange, comparand) == comparand; }
+uint64 Atomics::Core<sizeof(uint64)>::And(volatile uint64* target, uint64 value) { return InterlockedAnd64((volatile LONG64*)target, value); }
+uint64 Atomics::Core<sizeof(uint64)>::Or(volatile uint64* target, uint64 value) { return InterlockedOr64((volatile LONG64*)target, value); }
+uint64 Atomics::Core<sizeof(uint64)>::Xor(volatile uint64* target, uint64 value) { return InterlockedXor64((volatile LONG64*)target, value); }
+
 uint16 Atomics::Core<sizeof(uint16)>::Increment(volatile uint16* target) { return InterlockedIncrement16((volatile SHORT*)target); }
 uint16 Atomics::Core<sizeof(uint16)>::Decrement(volatile uint16* target) { return InterlockedDecrement16((volatile SHORT*)target); }
 bool Atomics::Core<sizeof(uint16)>::CompareExchange(volatile uint16* target, uint16 comparand, uint16 exchange) { return _InterlockedCompareExchange16((volatile SHORT*)target, exchange, comparand) == comparand; }
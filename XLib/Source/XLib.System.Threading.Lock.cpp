@@ -0,0 +1,115 @@
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+#endif
+
+#include <emmintrin.h>
+
+#include "XLib.System.Threading.Lock.h"
+
+using namespace XLib;
+
+namespace
+{
+	// Roughly a couple of microseconds. Most critical sections guarded by these locks are shorter.
+	constexpr uint32 LockSpinCount = 128;
+}
+
+// AddressWait /////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+
+void AddressWait::Wait(volatile uint32* address, uint32 comparand)
+{
+	WaitOnAddress(address, &comparand, sizeof(uint32), INFINITE);
+}
+
+void AddressWait::WakeOne(volatile uint32* address)
+{
+	WakeByAddressSingle((void*)address);
+}
+
+void AddressWait::WakeAll(volatile uint32* address)
+{
+	WakeByAddressAll((void*)address);
+}
+
+#else
+
+void AddressWait::Wait(volatile uint32* address, uint32 comparand)
+{
+	syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, comparand, nullptr, nullptr, 0);
+}
+
+void AddressWait::WakeOne(volatile uint32* address)
+{
+	syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+void AddressWait::WakeAll(volatile uint32* address)
+{
+	syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#endif
+
+
+// Lock ////////////////////////////////////////////////////////////////////////////////////////////
+
+void Lock::lockContended()
+{
+	for (uint32 i = 0; i < LockSpinCount; i++)
+	{
+		_mm_pause();
+
+		const uint32 currentState = state.value;
+		if (currentState == 0 && state.compareExchange(0, 1))
+			return;
+		if (currentState == 2)
+			break; // Somebody is already parked, no point to keep spinning.
+	}
+
+	// Lock is taken in "2" state because we can't know if there are other waiters left.
+	while (state.exchange(2) != 0)
+		AddressWait::Wait(&state.value, 2);
+}
+
+
+// TicketLock //////////////////////////////////////////////////////////////////////////////////////
+
+void TicketLock::waitForTicket(const uint32 ticket)
+{
+	// Only next in line spins. Others park straight away, as they have to wait for at least one
+	// whole critical section anyway.
+	for (uint32 i = 0; i < LockSpinCount; i++)
+	{
+		const uint32 distance = (ticket - state.value) & ServingTicketMask;
+		if (distance == 0)
+			return;
+		if (distance > 1)
+			break;
+		_mm_pause();
+	}
+
+	for (;;)
+	{
+		const uint32 currentState = state.value;
+		if ((currentState & ServingTicketMask) == ticket)
+			return;
+
+		if (currentState & ParkedWaitersFlag)
+			AddressWait::Wait(&state.value, currentState);
+		else if (state.compareExchange(currentState, currentState | ParkedWaitersFlag))
+			AddressWait::Wait(&state.value, currentState | ParkedWaitersFlag);
+	}
+}
+
+void TicketLock::wakeWaiters()
+{
+	// Waiters can't be woken selectively, so all of them recheck their tickets.
+	AddressWait::WakeAll(&state.value);
+}
@@ -6,27 +6,97 @@
 
 namespace XLib
 {
-	class ScopedLock;
+	// Thin wrapper over WaitOnAddress / futex.
+	class AddressWait abstract final
+	{
+	public:
+		// Parks calling thread while `*address == comparand`. Can return spuriously.
+		static void Wait(volatile uint32* address, uint32 comparand);
+		static void WakeOne(volatile uint32* address);
+		static void WakeAll(volatile uint32* address);
+	};
 
+	// Word-sized mutex. Spins for a short while and then parks on lock word.
+	// Not fair: unlocking thread or spinning newcomer can take the lock before woken waiter.
 	class Lock
 	{
 	private:
-		Atomic<uint32> value;
+		// 0 - free, 1 - locked, 2 - locked and there might be parked waiters.
+		Atomic<uint32> state;
+
+		void lockContended();
 
 	public:
-		inline Lock() : value(0) {}
+		inline Lock() : state(0) {}
 
-		inline void lock() { while (!value.compareExchange(1, 0)) {} }
-		inline void unlock() { value.store(0); }
+		inline void lock() { if (!state.compareExchange(0, 1)) lockContended(); }
+		inline bool tryLock() { return state.compareExchange(0, 1); }
+		inline void unlock() { if (state.exchange(0) == 2) AddressWait::WakeOne(&state.value); }
 	};
 
+	// Word-sized FIFO-fair mutex. Waiters are served strictly in order of arrival.
+	// Slower than `Lock` under contention (every handoff has to wake exact waiter), so should be
+	// used only where starvation is an issue.
+	class TicketLock
+	{
+	private:
+		// Bits 0..14 - ticket being served, bit 15 - there might be parked waiters,
+		// bits 16..31 - next ticket to be issued. Tickets are compared modulo 2^15.
+		static constexpr uint32 ServingTicketMask = 0x7FFF;
+		static constexpr uint32 ParkedWaitersFlag = 0x8000;
+		static constexpr uint32 NextTicketShift = 16;
+
+		Atomic<uint32> state;
+
+		void waitForTicket(uint32 ticket);
+		void wakeWaiters();
+
+	public:
+		inline TicketLock() : state(0) {}
+
+		inline void lock();
+		inline void unlock();
+	};
+
+	template <typename LockType = Lock>
 	class ScopedLock : public NonCopyable
 	{
 	private:
-		Lock &lock;
+		LockType &lock;
 
 	public:
-		inline ScopedLock(Lock& _lock) : lock(_lock) { lock.lock(); }
+		inline ScopedLock(LockType& _lock) : lock(_lock) { lock.lock(); }
 		inline ~ScopedLock() { lock.unlock(); }
 	};
-}
\ No newline at end of file
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+
+namespace XLib
+{
+	inline void TicketLock::lock()
+	{
+		const uint32 ticket = ((state.add(1 << NextTicketShift) >> NextTicketShift) - 1) & ServingTicketMask;
+		if ((state.value & ServingTicketMask) != ticket)
+			waitForTicket(ticket);
+	}
+
+	inline void TicketLock::unlock()
+	{
+		// Only owner advances serving ticket, but next ticket and parked flag can change concurrently.
+		for (;;)
+		{
+			const uint32 currentState = state.value;
+			const uint32 newState = (currentState & ~(ServingTicketMask | ParkedWaitersFlag)) |
+				((currentState + 1) & ServingTicketMask);
+			if (state.compareExchange(currentState, newState))
+			{
+				if (currentState & ParkedWaitersFlag)
+					wakeWaiters();
+				return;
+			}
+		}
+	}
+}
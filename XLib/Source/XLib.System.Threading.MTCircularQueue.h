@@ -1,5 +1,7 @@
 #pragma once
 
+#include <emmintrin.h>
+
 #include "XLib.h"
 #include "XLib.NonCopyable.h"
 #include "XLib.System.Threading.Atomics.h"
@@ -9,23 +11,69 @@
 
 namespace XLib
 {
+	// Bounded lock-free MPMC ring (D. Vyukov). Every cell carries sequence number that tells whether
+	// it is free for producer of current lap or ready for consumer. Producers and consumers only
+	// contend on their own position counter, which live on separate cache lines.
+	template <typename Type, uint32 capacityLog2>
+	class MTBoundedQueue_MPMC : public NonCopyable
+	{
+	private:
+		static constexpr uint32 size = 1 << capacityLog2;
+		static constexpr uint32 mask = size - 1;
+
+		struct Cell
+		{
+			Atomic<uint32> sequence;
+			Type value;
+		};
+
+	private:
+		__declspec(align(64)) Cell cells[size];
+		__declspec(align(64)) Atomic<uint32> enqueuePosition = 0;
+		__declspec(align(64)) Atomic<uint32> dequeuePosition = 0;
+
+	public:
+		inline MTBoundedQueue_MPMC() { initialize(); }
+		~MTBoundedQueue_MPMC() = default;
+
+		// Not thread safe.
+		inline void initialize();
+
+		inline bool tryEnqueue(const Type& value);
+		inline bool tryDequeue(Type& value);
+
+		// Return number of elements actually enqueued/dequeued. Elements are placed contiguously
+		// and in order (single position update for the whole batch).
+		inline uint32 tryEnqueueBulk(const Type* values, uint32 count);
+		inline uint32 tryDequeueBulk(Type* values, uint32 maxCount);
+
+		// Approximate under contention.
+		inline uint32 getSize() const { return enqueuePosition.value - dequeuePosition.value; }
+		inline bool isEmpty() const { return getSize() == 0; }
+		inline bool isFull() const { return getSize() >= size; }
+
+		static constexpr uint32 GetCapacity() { return size; }
+	};
+
+	// Blocking wrapper over `MTBoundedQueue_MPMC`. Waiting side spins first (spin budget adapts to
+	// how long waits took recently) and only then parks on event.
 	template <typename Type, uint32 capacityLog2, uint32 spinCount = 1000>
 	class MTCircularQueue_MPMC : public NonCopyable
 	{
 		static_assert(spinCount != 0, "MTCircularQueue spinCount can't be 0");
 
 	private:
-		static constexpr uint32 size = 1 << capacityLog2;
+		MTBoundedQueue_MPMC<Type, capacityLog2> queue;
+
+		Event notFullEvent, notEmptyEvent;
+		__declspec(align(64)) Atomic<uint32> waitingProducerCount = 0;
+		Atomic<uint32> waitingConsumerCount = 0;
+		volatile uint32 adaptiveSpinCount = spinCount / 4;
 
 	private:
-		Type buffer[size];
-		Event frontEvent, backEvent;
-		Atomic<uint32> frontIdx = 0;
-		Atomic<uint32> backIdx = 0;
-		volatile uint32 readyFrontIdx = 0;
-		volatile uint32 readyBackIdx = 0;
-		Atomic<uint16> waitingFrontCount = 0;
-		Atomic<uint16> waitingBackCount = 0;
+		static inline void SpinWait(uint32 iteration);
+		inline uint32 getSpinLimit() const;
+		inline void updateSpinStats(uint32 spinsUsed, bool parked);
 
 	public:
 		MTCircularQueue_MPMC() = default;
@@ -36,9 +84,14 @@ namespace XLib
 		inline void enqueue(const Type& value);
 		inline Type dequeue();
 
-		inline uint32 getSize() { return frontIdx.value - backIdx.value; }
-		inline bool isEmpty() { return frontIdx.value == backIdx.value; }
-		inline bool isFull() { return frontIdx.value - backIdx.value >= size; }
+		inline bool tryEnqueue(const Type& value);
+		inline bool tryDequeue(Type& value);
+		inline uint32 tryEnqueueBulk(const Type* values, uint32 count);
+		inline uint32 tryDequeueBulk(Type* values, uint32 maxCount);
+
+		inline uint32 getSize() const { return queue.getSize(); }
+		inline bool isEmpty() const { return queue.isEmpty(); }
+		inline bool isFull() const { return queue.isFull(); }
 	};
 
 	template <typename Type, uint32 capacityLog2, uint32 spinCount = 1000>
@@ -77,111 +130,307 @@ namespace XLib
 
 namespace XLib
 {
-	template <typename Type, uint32 capacityLog2, uint32 spinCount>
-	inline void MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::initialize()
+	// MTBoundedQueue_MPMC /////////////////////////////////////////////////////////////////////////
+
+	template <typename Type, uint32 capacityLog2>
+	inline void MTBoundedQueue_MPMC<Type, capacityLog2>::initialize()
+	{
+		for (uint32 i = 0; i < size; i++)
+			cells[i].sequence.value = i;
+		enqueuePosition.value = 0;
+		dequeuePosition.value = 0;
+	}
+
+	template <typename Type, uint32 capacityLog2>
+	inline bool MTBoundedQueue_MPMC<Type, capacityLog2>::tryEnqueue(const Type& value)
+	{
+		uint32 position = enqueuePosition.load();
+		Cell* cell = nullptr;
+		for (;;)
+		{
+			cell = &cells[position & mask];
+			const sint32 delta = sint32(cell->sequence.loadAcquire() - position);
+			if (delta == 0)
+			{
+				if (enqueuePosition.compareExchange(position, position + 1))
+					break;
+			}
+			else if (delta < 0)
+				return false; // Full.
+
+			position = enqueuePosition.load();
+		}
+
+		cell->value = value;
+		cell->sequence.storeRelease(position + 1);
+		return true;
+	}
+
+	template <typename Type, uint32 capacityLog2>
+	inline bool MTBoundedQueue_MPMC<Type, capacityLog2>::tryDequeue(Type& value)
 	{
-		frontIdx.value = 0;
-		backIdx.value = 0;
-		readyFrontIdx = 0;
-		readyBackIdx = 0;
-		waitingFrontCount.value = 0;
-		waitingBackCount.value = 0;
+		uint32 position = dequeuePosition.load();
+		Cell* cell = nullptr;
+		for (;;)
+		{
+			cell = &cells[position & mask];
+			const sint32 delta = sint32(cell->sequence.loadAcquire() - (position + 1));
+			if (delta == 0)
+			{
+				if (dequeuePosition.compareExchange(position, position + 1))
+					break;
+			}
+			else if (delta < 0)
+				return false; // Empty.
 
-		frontEvent.initialize(false);
-		backEvent.initialize(false);
+			position = dequeuePosition.load();
+		}
+
+		value = cell->value;
+		cell->sequence.storeRelease(position + size);
+		return true;
 	}
 
-	template <typename Type, uint32 capacityLog2, uint32 spinCount>
-	inline void MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::enqueue(const Type& value)
+	template <typename Type, uint32 capacityLog2>
+	inline uint32 MTBoundedQueue_MPMC<Type, capacityLog2>::tryEnqueueBulk(const Type* values, const uint32 count)
 	{
+		// Cell that is free for current lap can only become busy after position moves past it, so
+		// if CAS succeeds, all counted cells are still free.
+		uint32 position = enqueuePosition.load();
+		uint32 claimedCount = 0;
 		for (;;)
 		{
-			const uint32 lastLocalReadyBackIdx = readyBackIdx;
-			for (sint32 spin = 0; spin < spinCount; spin++)
+			claimedCount = 0;
+			while (claimedCount < count)
 			{
-				const uint32 localFrontIdx = frontIdx.load();
-				const uint32 localReadyBackIdx = readyBackIdx;
-				if (localFrontIdx - localReadyBackIdx < size)
-				{
-					if (frontIdx.compareExchange(localFrontIdx + 1, localFrontIdx))
-					{
-						buffer[localFrontIdx % size] = value;
-
-						while (readyFrontIdx != localFrontIdx) {}
-						readyFrontIdx++;
-
-						if (waitingBackCount.load())
-							backEvent.set();
-
-						return;
-					}
-					spin = -1;
-				}
-				if (lastLocalReadyBackIdx != localReadyBackIdx)
-				{
-					spin = -1;
-					lastLocalReadyBackIdx = localReadyBackIdx;
-				}
+				const uint32 cellPosition = position + claimedCount;
+				if (cells[cellPosition & mask].sequence.loadAcquire() != cellPosition)
+					break;
+				claimedCount++;
 			}
 
-			frontEvent.reset();
-			waitingFrontCount.increment();
-			if (lastLocalReadyBackIdx != readyBackIdx)
+			if (!claimedCount)
 			{
-				frontEvent.set();
-				waitingFrontCount.decrement();
+				const uint32 currentPosition = enqueuePosition.load();
+				if (currentPosition == position)
+					return 0; // Full.
+				position = currentPosition;
 				continue;
 			}
 
-			frontEvent.wait();
-			waitingFrontCount.decrement();
+			if (enqueuePosition.compareExchange(position, position + claimedCount))
+				break;
+			position = enqueuePosition.load();
 		}
+
+		for (uint32 i = 0; i < claimedCount; i++)
+		{
+			Cell& cell = cells[(position + i) & mask];
+			cell.value = values[i];
+			cell.sequence.storeRelease(position + i + 1);
+		}
+		return claimedCount;
 	}
 
-	template <typename Type, uint32 capacityLog2, uint32 spinCount>
-	inline Type MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::dequeue()
+	template <typename Type, uint32 capacityLog2>
+	inline uint32 MTBoundedQueue_MPMC<Type, capacityLog2>::tryDequeueBulk(Type* values, const uint32 maxCount)
 	{
+		uint32 position = dequeuePosition.load();
+		uint32 claimedCount = 0;
 		for (;;)
 		{
-			const uint32 lastLocalReadyFrontIdx = readyFrontIdx;
-			for (sint32 spin = 0; spin < spinCount; spin++)
+			claimedCount = 0;
+			while (claimedCount < maxCount)
 			{
-				const uint32 localBackIdx = backIdx.load();
-				const uint32 localReadyFrontIdx = readyFrontIdx;
-				if (localReadyFrontIdx - localBackIdx > 0)
-				{
-					if (backIdx.compareExchange(localBackIdx + 1, localBackIdx))
-					{
-						Type result = buffer[localBackIdx % size];
-
-						while (readyBackIdx != localBackIdx) {}
-						readyBackIdx++;
-
-						if (waitingFrontCount.load())
-							frontEvent.set();
-
-						return result;
-					}
-					spin = -1;
-				}
-				if (lastLocalReadyFrontIdx != localReadyFrontIdx)
-				{
-					spin = -1;
-					lastLocalReadyFrontIdx = localReadyFrontIdx;
-				}
+				const uint32 cellPosition = position + claimedCount;
+				if (cells[cellPosition & mask].sequence.loadAcquire() != cellPosition + 1)
+					break;
+				claimedCount++;
 			}
 
-			backEvent.reset();
-			waitingBackCount.increment();
-			if (lastLocalReadyFrontIdx != readyFrontIdx)
+			if (!claimedCount)
 			{
-				backEvent.set();
-				waitingBackCount.decrement();
+				const uint32 currentPosition = dequeuePosition.load();
+				if (currentPosition == position)
+					return 0; // Empty.
+				position = currentPosition;
 				continue;
 			}
 
-			backEvent.wait();
-			waitingBackCount.decrement();
+			if (dequeuePosition.compareExchange(position, position + claimedCount))
+				break;
+			position = dequeuePosition.load();
+		}
+
+		for (uint32 i = 0; i < claimedCount; i++)
+		{
+			Cell& cell = cells[(position + i) & mask];
+			values[i] = cell.value;
+			cell.sequence.storeRelease(position + i + size);
+		}
+		return claimedCount;
+	}
+
+
+	// MTCircularQueue_MPMC ////////////////////////////////////////////////////////////////////////
+
+	template <typename Type, uint32 capacityLog2, uint32 spinCount>
+	inline void MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::SpinWait(const uint32 iteration)
+	{
+		// Exponential backoff up to 64 pauses.
+		const uint32 pauseCount = 1 << min<uint32>(iteration, 6);
+		for (uint32 i = 0; i < pauseCount; i++)
+			_mm_pause();
+	}
+
+	template <typename Type, uint32 capacityLog2, uint32 spinCount>
+	inline uint32 MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::getSpinLimit() const
+	{
+		return min<uint32>(adaptiveSpinCount * 2 + 16, spinCount);
+	}
+
+	template <typename Type, uint32 capacityLog2, uint32 spinCount>
+	inline void MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::updateSpinStats(const uint32 spinsUsed, const bool parked)
+	{
+		// Racy on purpose: this is only a heuristic.
+		const uint32 current = adaptiveSpinCount;
+		if (parked)
+			adaptiveSpinCount = current / 2;
+		else
+			adaptiveSpinCount = uint32(sint32(current) + (sint32(spinsUsed) - sint32(current)) / 8);
+	}
+
+	template <typename Type, uint32 capacityLog2, uint32 spinCount>
+	inline void MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::initialize()
+	{
+		queue.initialize();
+		waitingProducerCount.value = 0;
+		waitingConsumerCount.value = 0;
+		adaptiveSpinCount = spinCount / 4;
+
+		notFullEvent.initialize(false, false);
+		notEmptyEvent.initialize(false, false);
+	}
+
+	template <typename Type, uint32 capacityLog2, uint32 spinCount>
+	inline bool MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::tryEnqueue(const Type& value)
+	{
+		if (!queue.tryEnqueue(value))
+			return false;
+
+		// Element publication should be visible before waiting count is read.
+		Atomics::FenceFull();
+		if (waitingConsumerCount.load())
+			notEmptyEvent.set();
+		return true;
+	}
+
+	template <typename Type, uint32 capacityLog2, uint32 spinCount>
+	inline bool MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::tryDequeue(Type& value)
+	{
+		if (!queue.tryDequeue(value))
+			return false;
+
+		Atomics::FenceFull();
+		if (waitingProducerCount.load())
+			notFullEvent.set();
+		return true;
+	}
+
+	template <typename Type, uint32 capacityLog2, uint32 spinCount>
+	inline uint32 MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::tryEnqueueBulk(const Type* values, const uint32 count)
+	{
+		const uint32 enqueuedCount = queue.tryEnqueueBulk(values, count);
+		if (enqueuedCount)
+		{
+			Atomics::FenceFull();
+			if (waitingConsumerCount.load())
+				notEmptyEvent.set();
+		}
+		return enqueuedCount;
+	}
+
+	template <typename Type, uint32 capacityLog2, uint32 spinCount>
+	inline uint32 MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::tryDequeueBulk(Type* values, const uint32 maxCount)
+	{
+		const uint32 dequeuedCount = queue.tryDequeueBulk(values, maxCount);
+		if (dequeuedCount)
+		{
+			Atomics::FenceFull();
+			if (waitingProducerCount.load())
+				notFullEvent.set();
+		}
+		return dequeuedCount;
+	}
+
+	template <typename Type, uint32 capacityLog2, uint32 spinCount>
+	inline void MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::enqueue(const Type& value)
+	{
+		const uint32 spinLimit = getSpinLimit();
+		for (uint32 spin = 0; spin < spinLimit; spin++)
+		{
+			if (tryEnqueue(value))
+			{
+				updateSpinStats(spin, false);
+				return;
+			}
+			SpinWait(spin);
+		}
+
+		updateSpinStats(spinLimit, true);
+
+		for (;;)
+		{
+			// Register as waiter before last attempt, so consumer that frees slot after this attempt
+			// sees us and sets the event.
+			waitingProducerCount.increment();
+			const bool enqueued = tryEnqueue(value);
+			if (!enqueued)
+				notFullEvent.wait();
+			waitingProducerCount.decrement();
+
+			if (enqueued)
+			{
+				// Event is auto-reset, so wakes could be merged. Pass it on to next waiter.
+				if (waitingProducerCount.load() && !queue.isFull())
+					notFullEvent.set();
+				return;
+			}
+		}
+	}
+
+	template <typename Type, uint32 capacityLog2, uint32 spinCount>
+	inline Type MTCircularQueue_MPMC<Type, capacityLog2, spinCount>::dequeue()
+	{
+		Type result;
+
+		const uint32 spinLimit = getSpinLimit();
+		for (uint32 spin = 0; spin < spinLimit; spin++)
+		{
+			if (tryDequeue(result))
+			{
+				updateSpinStats(spin, false);
+				return result;
+			}
+			SpinWait(spin);
+		}
+
+		updateSpinStats(spinLimit, true);
+
+		for (;;)
+		{
+			waitingConsumerCount.increment();
+			const bool dequeued = tryDequeue(result);
+			if (!dequeued)
+				notEmptyEvent.wait();
+			waitingConsumerCount.decrement();
+
+			if (dequeued)
+			{
+				if (waitingConsumerCount.load() && !queue.isEmpty())
+					notEmptyEvent.set();
+				return result;
+			}
 		}
 	}
 }
@@ -0,0 +1,130 @@
+#include <emmintrin.h>
+
+#include "XLib.System.Threading.ReadersWriterLock.h"
+#include "XLib.System.Threading.Lock.h"
+
+using namespace XLib;
+
+namespace
+{
+	constexpr uint32 ReadersWriterLockSpinCount = 128;
+}
+
+void ReadersWriterLock::readerLockContended()
+{
+	for (uint32 i = 0;; i++)
+	{
+		const uint32 currentState = state.value;
+		if (!(currentState & (WriterFlag | WriterPendingFlag)))
+		{
+			if (state.compareExchange(currentState, currentState + 1))
+				return;
+			continue;
+		}
+
+		if (i < ReadersWriterLockSpinCount)
+			_mm_pause();
+		else
+			waitForStateChange(currentState);
+	}
+}
+
+void ReadersWriterLock::writerLockContended()
+{
+	for (uint32 i = 0;; i++)
+	{
+		const uint32 currentState = state.value;
+		if ((currentState & ~(ParkedWaitersFlag | WriterPendingFlag)) == 0)
+		{
+			// Pending flag is dropped. Other waiting writers will set it again.
+			if (state.compareExchange(currentState, (currentState & ParkedWaitersFlag) | WriterFlag))
+				return;
+			continue;
+		}
+
+		if (!(currentState & WriterPendingFlag))
+		{
+			state.compareExchange(currentState, currentState | WriterPendingFlag);
+			continue;
+		}
+
+		if (i < ReadersWriterLockSpinCount)
+			_mm_pause();
+		else
+			waitForStateChange(currentState);
+	}
+}
+
+void ReadersWriterLock::upgradeableReaderLockContended()
+{
+	for (uint32 i = 0;; i++)
+	{
+		const uint32 currentState = state.value;
+		if (!(currentState & (WriterFlag | UpgradeableReaderFlag | WriterPendingFlag)))
+		{
+			if (state.compareExchange(currentState, currentState | UpgradeableReaderFlag))
+				return;
+			continue;
+		}
+
+		if (i < ReadersWriterLockSpinCount)
+			_mm_pause();
+		else
+			waitForStateChange(currentState);
+	}
+}
+
+void ReadersWriterLock::upgrade()
+{
+	// Upgradeable reader flag keeps other writers and upgraders out, so we only wait for plain
+	// readers to leave. Pending flag stops new ones from coming in meanwhile.
+	for (uint32 i = 0;; i++)
+	{
+		const uint32 currentState = state.value;
+		XAssert(currentState & UpgradeableReaderFlag);
+
+		if ((currentState & ReaderCountMask) == 0)
+		{
+			if (state.compareExchange(currentState, (currentState & ParkedWaitersFlag) | WriterFlag))
+				return;
+			continue;
+		}
+
+		if (!(currentState & WriterPendingFlag))
+		{
+			state.compareExchange(currentState, currentState | WriterPendingFlag);
+			continue;
+		}
+
+		if (i < ReadersWriterLockSpinCount)
+			_mm_pause();
+		else
+			waitForStateChange(currentState);
+	}
+}
+
+void ReadersWriterLock::waitForStateChange(const uint32 observedState)
+{
+	// Parked flag should be set before parking, so whoever changes state next knows to wake us.
+	if (observedState & ParkedWaitersFlag)
+		AddressWait::Wait(&state.value, observedState);
+	else if (state.compareExchange(observedState, observedState | ParkedWaitersFlag))
+		AddressWait::Wait(&state.value, observedState | ParkedWaitersFlag);
+}
+
+void ReadersWriterLock::releaseFlags(const uint32 flags)
+{
+	for (;;)
+	{
+		const uint32 currentState = state.value;
+		XAssert((currentState & flags) == flags);
+
+		if (state.compareExchange(currentState, currentState & ~(flags | ParkedWaitersFlag)))
+		{
+			// Waiters can wait for different things, so all of them recheck the state.
+			if (currentState & ParkedWaitersFlag)
+				AddressWait::WakeAll(&state.value);
+			return;
+		}
+	}
+}
@@ -4,41 +4,51 @@
 #include "XLib.NonCopyable.h"
 #include "XLib.System.Threading.Atomics.h"
 
+// Word-sized readers-writer lock. Waiters spin for a short while and then park on lock word.
+// Writers are preferred: as soon as writer is waiting, new readers are not let in.
+//
+// Upgradeable reader coexists with plain readers, but excludes writers and other upgradeable
+// readers. It can be atomically upgraded to writer (no one else can write in between), which allows
+// "read, decide, modify" patterns without dropping the lock.
+
 namespace XLib
 {
 	class ScopedReaderLock;
 	class ScopedWriterLock;
+	class ScopedUpgradeableReaderLock;
 
 	class ReadersWriterLock : public NonCopyable
 	{
 		friend ScopedReaderLock;
 		friend ScopedWriterLock;
+		friend ScopedUpgradeableReaderLock;
 
 	private:
-		static constexpr uint32 writerLockMask = 1 << 31;
+		static constexpr uint32 WriterFlag = 1 << 31;
+		static constexpr uint32 UpgradeableReaderFlag = 1 << 30;
+		static constexpr uint32 WriterPendingFlag = 1 << 29;
+		static constexpr uint32 ParkedWaitersFlag = 1 << 28;
+		static constexpr uint32 ReaderCountMask = ParkedWaitersFlag - 1;
 
-		Atomic<uint32> lock;
+		Atomic<uint32> state;
 
-		inline void readerLock()
-		{
-			if (lock.increment() >= writerLockMask)
-				while (lock.load() & writerLockMask) {}
-		}
-		inline void writerLock()
-		{
-			while (!lock.compareExchange(writerLockMask, 0)) {}
-		}
-		inline void readerUnlock()
-		{
-			lock.decrement();
-		}
-		inline void writerUnlock()
-		{
-			lock.sub(writerLockMask);
-		}
+	private:
+		void readerLockContended();
+		void writerLockContended();
+		void upgradeableReaderLockContended();
+		void waitForStateChange(uint32 observedState);
+		void releaseFlags(uint32 flags);
+
+		inline void readerLock();
+		inline void readerUnlock();
+		inline void writerLock();
+		inline void writerUnlock() { releaseFlags(WriterFlag); }
+		inline void upgradeableReaderLock();
+		inline void upgradeableReaderUnlock() { releaseFlags(UpgradeableReaderFlag); }
+		void upgrade();
 
 	public:
-		inline ReadersWriterLock() : lock(0) {}
+		inline ReadersWriterLock() : state(0) {}
 	};
 
 	class ScopedReaderLock : public NonCopyable
@@ -60,4 +70,61 @@ namespace XLib
 		inline ScopedWriterLock(ReadersWriterLock& _lock) : lock(_lock) { lock.writerLock(); }
 		inline ~ScopedWriterLock() { lock.writerUnlock(); }
 	};
-}
\ No newline at end of file
+
+	class ScopedUpgradeableReaderLock : public NonCopyable
+	{
+	private:
+		ReadersWriterLock &lock;
+		bool upgraded;
+
+	public:
+		inline ScopedUpgradeableReaderLock(ReadersWriterLock& _lock) : lock(_lock), upgraded(false) { lock.upgradeableReaderLock(); }
+		inline ~ScopedUpgradeableReaderLock() { upgraded ? lock.writerUnlock() : lock.upgradeableReaderUnlock(); }
+
+		// Waits for plain readers to leave. Lock is held exclusively until the end of scope.
+		inline void upgrade() { XAssert(!upgraded); lock.upgrade(); upgraded = true; }
+	};
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DEFINITION //////////////////////////////////////////////////////////////////////////////////////
+
+namespace XLib
+{
+	inline void ReadersWriterLock::readerLock()
+	{
+		const uint32 currentState = state.value;
+		if ((currentState & (WriterFlag | WriterPendingFlag)) ||
+			!state.compareExchange(currentState, currentState + 1))
+		{
+			readerLockContended();
+		}
+	}
+
+	inline void ReadersWriterLock::readerUnlock()
+	{
+		const uint32 newState = state.decrement();
+		XAssert((newState & ReaderCountMask) != ReaderCountMask);
+
+		// Last reader out lets waiting writer (or upgrader) in.
+		if ((newState & ReaderCountMask) == 0 && (newState & ParkedWaitersFlag))
+			releaseFlags(0);
+	}
+
+	inline void ReadersWriterLock::writerLock()
+	{
+		if (!state.compareExchange(0, WriterFlag))
+			writerLockContended();
+	}
+
+	inline void ReadersWriterLock::upgradeableReaderLock()
+	{
+		const uint32 currentState = state.value;
+		if ((currentState & (WriterFlag | UpgradeableReaderFlag | WriterPendingFlag)) ||
+			!state.compareExchange(currentState, currentState | UpgradeableReaderFlag))
+		{
+			upgradeableReaderLockContended();
+		}
+	}
+}
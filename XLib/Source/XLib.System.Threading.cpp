@@ -51,6 +51,7 @@ void Thread::resume() { ResumeThread(handle); }
 
 void Thread::Sleep(uint32 milliseconds) { ::Sleep(milliseconds); }
 void Thread::YieldExecution() { ::SwitchToThread(); }
+uint32 Thread::GetLogicalCoreCount() { return GetActiveProcessorCount(ALL_PROCESSOR_GROUPS); }
 
 bool WaitableBase::wait()
 {
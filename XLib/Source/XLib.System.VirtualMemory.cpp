@@ -0,0 +1,88 @@
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "XLib.System.VirtualMemory.h"
+
+using namespace XLib;
+
+#ifdef _WIN32
+
+uintptr VirtualMemory::GetPageSize()
+{
+	SYSTEM_INFO systemInfo = {};
+	GetSystemInfo(&systemInfo);
+	return systemInfo.dwPageSize;
+}
+
+void* VirtualMemory::Allocate(uintptr size)
+{
+	return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+void* VirtualMemory::Reserve(uintptr size)
+{
+	return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool VirtualMemory::Commit(void* block, uintptr size)
+{
+	XAssert(block);
+	return VirtualAlloc(block, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
+void VirtualMemory::Decommit(void* block, uintptr size)
+{
+	XAssert(block);
+	VirtualFree(block, size, MEM_DECOMMIT);
+}
+
+void VirtualMemory::Release(void* block, uintptr size)
+{
+	XAssert(block);
+	VirtualFree(block, 0, MEM_RELEASE);
+}
+
+#else
+
+uintptr VirtualMemory::GetPageSize()
+{
+	return uintptr(sysconf(_SC_PAGESIZE));
+}
+
+void* VirtualMemory::Allocate(uintptr size)
+{
+	void* block = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return block == MAP_FAILED ? nullptr : block;
+}
+
+void* VirtualMemory::Reserve(uintptr size)
+{
+	void* block = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return block == MAP_FAILED ? nullptr : block;
+}
+
+bool VirtualMemory::Commit(void* block, uintptr size)
+{
+	XAssert(block);
+	return mprotect(block, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void VirtualMemory::Decommit(void* block, uintptr size)
+{
+	XAssert(block);
+	// Drop physical pages and make range inaccessible again. Address range stays reserved.
+	madvise(block, size, MADV_DONTNEED);
+	mprotect(block, size, PROT_NONE);
+}
+
+void VirtualMemory::Release(void* block, uintptr size)
+{
+	XAssert(block);
+	munmap(block, size);
+}
+
+#endif
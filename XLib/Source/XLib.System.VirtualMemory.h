@@ -2,11 +2,20 @@
 
 #include "XLib.h"
 
-struct VirtualMemory abstract final
+// NOTE: All sizes and addresses passed to `Commit`/`Decommit` should be page aligned.
+// NOTE: `Release` takes size of entire reserved range (POSIX `munmap` needs it).
+
+namespace XLib
 {
-	static void* Allocate(uintptr size);
-	static void Release();
-	static void* Reserve(uintptr size);
-	static void Commit(void* block, uintptr size);
-	static void Decomit();
-};
\ No newline at end of file
+	class VirtualMemory abstract final
+	{
+	public:
+		static uintptr GetPageSize();
+
+		static void* Allocate(uintptr size); // Reserve and commit.
+		static void* Reserve(uintptr size);
+		static bool Commit(void* block, uintptr size);
+		static void Decommit(void* block, uintptr size);
+		static void Release(void* block, uintptr size);
+	};
+}